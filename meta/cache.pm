@@ -0,0 +1,198 @@
+#!/usr/bin/perl
+#
+# Copyright (c) 2014 Microsoft Open Technologies, Inc.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License"); you may
+#    not use this file except in compliance with the License. You may obtain
+#    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+#
+#    THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+#    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+#    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+#    FOR A PARTICULAR PURPOSE, MERCHANTABILITY OR NON-INFRINGEMENT.
+#
+#    See the Apache Version 2.0 License for specific language governing
+#    permissions and limitations under the License.
+#
+#    Microsoft would like to thank the following companies for their review and
+#    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+#    Dell Products, L.P., Facebook, Inc., Marvell International Ltd.
+#
+# @file    cache.pm
+#
+# @brief   This module defines SAI Metadata Parser cache
+#
+# Parse results of single header XML file are stored in cache directory and
+# reused while the key computed from the XML content, parser sources and
+# given context (like defines from previously processed headers) stays the
+# same.
+#
+
+package cache;
+
+use strict;
+use warnings;
+use diagnostics;
+
+use Digest::SHA;
+use Storable qw(nstore retrieve);
+use Time::HiRes qw(time);
+use utils;
+
+require Exporter;
+
+our $CACHE_DIR = ".parsecache";
+
+my $toolsHash = undef;
+
+my @STEP_TIMES = ();
+
+my %CACHE_STATS = (
+        hits         => 0,
+        misses       => 0,
+        loadseconds  => 0,
+        parseseconds => 0,
+        );
+
+my %PARSE_TIMES = ();
+
+sub GetToolsHash
+{
+    return $toolsHash if defined $toolsHash;
+
+    my $sha = Digest::SHA->new(1);
+
+    for my $file (sort ("parse.pl", glob("*.pm")))
+    {
+        $sha->addfile($file);
+    }
+
+    $toolsHash = $sha->hexdigest;
+
+    return $toolsHash;
+}
+
+sub GetCacheKey
+{
+    my ($file, @context) = @_;
+
+    my $sha = Digest::SHA->new(1);
+
+    $sha->add(GetToolsHash());
+    $sha->addfile($file);
+    $sha->add($_) for @context;
+
+    return $sha->hexdigest;
+}
+
+sub CacheLoad
+{
+    my ($name, $key) = @_;
+
+    my $path = "$CACHE_DIR/$name.cache";
+
+    return undef if not -f $path;
+
+    my $start = time;
+
+    my $entry = eval { retrieve($path) };
+
+    $CACHE_STATS{loadseconds} += time - $start;
+
+    if (not defined $entry or ref $entry ne "HASH" or not defined $entry->{key})
+    {
+        LogInfo "ignoring corrupted cache file $path";
+        return undef;
+    }
+
+    return undef if $entry->{key} ne $key;
+
+    $CACHE_STATS{hits}++;
+
+    return $entry->{data};
+}
+
+sub CacheStore
+{
+    my ($name, $key, $data) = @_;
+
+    mkdir $CACHE_DIR if not -d $CACHE_DIR;
+
+    my $path = "$CACHE_DIR/$name.cache";
+
+    # write to temporary file first, so interrupted run will not leave
+    # partial cache file behind
+
+    eval
+    {
+        nstore({ key => $key, data => $data }, "$path.tmp");
+
+        rename "$path.tmp", $path or die "rename failed: $!";
+    };
+
+    # cache is optimization only, don't fail the build
+
+    LogInfo "failed to store cache file $path: $@" if $@;
+}
+
+sub CacheMiss
+{
+    my ($name, $seconds) = @_;
+
+    $CACHE_STATS{misses}++;
+    $CACHE_STATS{parseseconds} += $seconds;
+
+    $PARSE_TIMES{$name} = $seconds;
+}
+
+sub TimeStep
+{
+    my ($name, $sub) = @_;
+
+    my $start = time;
+
+    $sub->();
+
+    push @STEP_TIMES, [ $name, time - $start ];
+}
+
+sub PrintGenerationTimes
+{
+    my $total = 0;
+
+    $total += $_->[1] for @STEP_TIMES;
+
+    $total = 1e-9 if $total == 0;
+
+    LogInfo sprintf("metadata generated in %.3f s", $total);
+
+    LogInfo sprintf("  xml files: %d parsed in %.3f s, %d loaded from cache in %.3f s",
+        $CACHE_STATS{misses}, $CACHE_STATS{parseseconds},
+        $CACHE_STATS{hits}, $CACHE_STATS{loadseconds});
+
+    my @slowest = (sort { $PARSE_TIMES{$b} <=> $PARSE_TIMES{$a} or $a cmp $b } keys %PARSE_TIMES)[0..4];
+
+    for my $name (grep { defined } @slowest)
+    {
+        LogInfo sprintf("    %-46s %8.3f s", $name, $PARSE_TIMES{$name});
+    }
+
+    for my $step (sort { $b->[1] <=> $a->[1] or $a->[0] cmp $b->[0] } @STEP_TIMES)
+    {
+        my ($name, $seconds) = @$step;
+
+        last if $seconds < 0.001;
+
+        LogInfo sprintf("  %-48s %8.3f s %5.1f%%", $name, $seconds, 100 * $seconds / $total);
+    }
+}
+
+BEGIN
+{
+    our @ISA    = qw(Exporter);
+    our @EXPORT = qw/
+    GetCacheKey CacheLoad CacheStore CacheMiss TimeStep PrintGenerationTimes
+    /;
+}
+
+1;
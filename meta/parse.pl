@@ -39,6 +39,8 @@ use style;
 use test;
 use serialize;
 use cap;
+use cache;
+use Time::HiRes qw(time);
 
 our $XMLDIR = "xml";
 our $INCLUDE_DIR = "../inc/";
@@ -94,13 +96,14 @@ my %ATTR_TAGS = (
         );
 
 my %options = ();
-getopts("dsASl", \%options);
+getopts("dsASlC", \%options);
 
 our $optionPrintDebug        = 1 if defined $options{d};
 our $optionDisableAspell     = 1 if defined $options{A};
 our $optionUseXmlSimple      = 1 if defined $options{s};
 our $optionDisableStyleCheck = 1 if defined $options{S};
 our $optionShowLogCaller     = 1 if defined $options{l};
+our $optionDisableCache      = 1 if defined $options{C};
 
 # LOGGING FUNCTIONS HELPERS
 
@@ -5175,13 +5178,132 @@ sub CreateSourcePragmaPop
     WriteSource "#pragma GCC diagnostic pop";
 }
 
+#
+# Parse single header XML into empty tables, and return them. Defines from
+# previously processed headers stay visible, since enum initializers and
+# range tags may refer to them.
+#
+sub ParseXmlFile
+{
+    my $file = shift;
+
+    my %definesBefore = %SAI_DEFINES;
+
+    my $errorsBefore = $errors;
+    my $warningsBefore = $warnings;
+
+    local %SAI_ENUMS = ();
+    local %METADATA = ();
+    local %NOTIFICATIONS = ();
+    local %ALL_STRUCTS = ();
+    local %SAI_DEFINES = %SAI_DEFINES;
+    local %EXTRA_RANGE_DEFINES = ();
+    local %EXTENSIONS_ENUMS = ();
+    local %PRIMITIVE_TYPES = ();
+    local %FUNCTION_DEF = ();
+    local %GLOBAL_APIS = ();
+    local %SAI_ENUMS_CUSTOM_RANGES = ();
+    local %ATTR_TO_CALLBACK = ();
+    local @ALL_ENUMS = ();
+
+    ProcessXmlFile($file);
+
+    my %defines = map { $_ => $SAI_DEFINES{$_} }
+        grep { not defined $definesBefore{$_} or $definesBefore{$_} ne $SAI_DEFINES{$_} } keys %SAI_DEFINES;
+
+    my %parsed = (
+            clean                   => ($errors == $errorsBefore and $warnings == $warningsBefore),
+            SAI_ENUMS               => { %SAI_ENUMS },
+            METADATA                => { %METADATA },
+            NOTIFICATIONS           => { %NOTIFICATIONS },
+            ALL_STRUCTS             => { %ALL_STRUCTS },
+            SAI_DEFINES             => \%defines,
+            EXTRA_RANGE_DEFINES     => { %EXTRA_RANGE_DEFINES },
+            EXTENSIONS_ENUMS        => { %EXTENSIONS_ENUMS },
+            PRIMITIVE_TYPES         => { %PRIMITIVE_TYPES },
+            FUNCTION_DEF            => { %FUNCTION_DEF },
+            GLOBAL_APIS             => { %GLOBAL_APIS },
+            SAI_ENUMS_CUSTOM_RANGES => { %SAI_ENUMS_CUSTOM_RANGES },
+            ATTR_TO_CALLBACK        => { %ATTR_TO_CALLBACK },
+            ALL_ENUMS               => [ @ALL_ENUMS ],
+            );
+
+    return \%parsed;
+}
+
+sub MergeParsedXmlFile
+{
+    my $parsed = shift;
+
+    for my $enum (sort keys %{ $parsed->{SAI_ENUMS} })
+    {
+        if (defined $SAI_ENUMS{$enum})
+        {
+            LogError "duplicated enum $enum";
+            next;
+        }
+
+        $SAI_ENUMS{$enum} = $parsed->{SAI_ENUMS}{$enum};
+    }
+
+    my %tables = (
+            METADATA                => \%METADATA,
+            NOTIFICATIONS           => \%NOTIFICATIONS,
+            ALL_STRUCTS             => \%ALL_STRUCTS,
+            SAI_DEFINES             => \%SAI_DEFINES,
+            EXTRA_RANGE_DEFINES     => \%EXTRA_RANGE_DEFINES,
+            EXTENSIONS_ENUMS        => \%EXTENSIONS_ENUMS,
+            PRIMITIVE_TYPES         => \%PRIMITIVE_TYPES,
+            FUNCTION_DEF            => \%FUNCTION_DEF,
+            GLOBAL_APIS             => \%GLOBAL_APIS,
+            SAI_ENUMS_CUSTOM_RANGES => \%SAI_ENUMS_CUSTOM_RANGES,
+            ATTR_TO_CALLBACK        => \%ATTR_TO_CALLBACK,
+            );
+
+    for my $table (keys %tables)
+    {
+        my $ref = $parsed->{$table};
+
+        @{ $tables{$table} }{ keys %$ref } = values %$ref;
+    }
+
+    push @ALL_ENUMS, @{ $parsed->{ALL_ENUMS} };
+}
+
 sub ProcessXmlFiles
 {
     for my $file (GetSaiXmlFiles($XMLDIR))
     {
+        # header is parsed again when its content, parser sources or
+        # defines from headers processed before it change
+
+        my $defines = join ",", map { "$_=$SAI_DEFINES{$_}" } sort keys %SAI_DEFINES;
+
+        my $key = GetCacheKey("$XMLDIR/$file", $defines);
+
+        my $parsed = (defined $optionDisableCache) ? undef : CacheLoad($file, $key);
+
+        if (defined $parsed)
+        {
+            LogDebug "Using cached $file";
+
+            MergeParsedXmlFile($parsed);
+            next;
+        }
+
         LogInfo "Processing $file";
 
-        ProcessXmlFile("$XMLDIR/$file");
+        my $start = time;
+
+        $parsed = ParseXmlFile("$XMLDIR/$file");
+
+        CacheMiss($file, time - $start);
+
+        # files with errors or warnings are always parsed, so they are reported on each run
+
+        CacheStore($file, $key, $parsed) if $parsed->{clean} and not defined $optionDisableCache;
+
+        MergeParsedXmlFile($parsed);
     }
 }
 
@@ -5528,122 +5650,124 @@ sub CreateDefineMaxConditionsLen
 # MAIN
 #
 
-LoadCapabilities();
+TimeStep("LoadCapabilities", \&LoadCapabilities);
 
-ExtractApiToObjectMap();
+TimeStep("ExtractApiToObjectMap", \&ExtractApiToObjectMap);
 
-ExtractStatsFunctionMap();
+TimeStep("ExtractStatsFunctionMap", \&ExtractStatsFunctionMap);
 
-ExtractUnionsInfo();
+TimeStep("ExtractUnionsInfo", \&ExtractUnionsInfo);
 
-CheckHeadersStyle() if not defined $optionDisableStyleCheck;
+TimeStep("CheckHeadersStyle", \&CheckHeadersStyle) if not defined $optionDisableStyleCheck;
 
-GetStructLists();
+TimeStep("GetStructLists", \&GetStructLists);
 
-PopulateValueTypes();
+TimeStep("PopulateValueTypes", \&PopulateValueTypes);
 
-ProcessXmlFiles();
+TimeStep("ProcessXmlFiles", \&ProcessXmlFiles);
 
-MergeExtensionsEnums();
+TimeStep("MergeExtensionsEnums", \&MergeExtensionsEnums);
 
-CreateObjectTypeMap();
+TimeStep("CreateObjectTypeMap", \&CreateObjectTypeMap);
 
-ExtractObjectTypeBulkMap();
+TimeStep("ExtractObjectTypeBulkMap", \&ExtractObjectTypeBulkMap);
 
-WriteHeaderHeader();
+TimeStep("WriteHeaderHeader", \&WriteHeaderHeader);
 
-ProcessSaiStatus();
+TimeStep("ProcessSaiStatus", \&ProcessSaiStatus);
 
-ProcessExtraRangeDefines();
+TimeStep("ProcessExtraRangeDefines", \&ProcessExtraRangeDefines);
 
-CreateSourceIncludes();
+TimeStep("CreateSourceIncludes", \&CreateSourceIncludes);
 
-CreateSourcePragmaPush();
+TimeStep("CreateSourcePragmaPush", \&CreateSourcePragmaPush);
 
-CreateDeclareEveryEntryMacro();
+TimeStep("CreateDeclareEveryEntryMacro", \&CreateDeclareEveryEntryMacro);
 
-CreateMetadataHeaderAndSource();
+TimeStep("CreateMetadataHeaderAndSource", \&CreateMetadataHeaderAndSource);
 
-CreateMetadata();
+TimeStep("CreateMetadata", \&CreateMetadata);
 
-CreateMetadataForAttributes();
+TimeStep("CreateMetadataForAttributes", \&CreateMetadataForAttributes);
 
-CreateDefineMaxConditionsLen();
+TimeStep("CreateDefineMaxConditionsLen", \&CreateDefineMaxConditionsLen);
 
-CreateEnumHelperMethods();
+TimeStep("CreateEnumHelperMethods", \&CreateEnumHelperMethods);
 
-ProcessNonObjectIdObjects();
+TimeStep("ProcessNonObjectIdObjects", \&ProcessNonObjectIdObjects);
 
-CreateOtherStructs();
+TimeStep("CreateOtherStructs", \&CreateOtherStructs);
 
-CreateStructNonObjectId();
+TimeStep("CreateStructNonObjectId", \&CreateStructNonObjectId);
 
-CreateApis();
+TimeStep("CreateApis", \&CreateApis);
 
-CreateApisStruct();
+TimeStep("CreateApisStruct", \&CreateApisStruct);
 
-CreateGlobalApis();
+TimeStep("CreateGlobalApis", \&CreateGlobalApis);
 
-CreateGlobalFunctions();
+TimeStep("CreateGlobalFunctions", \&CreateGlobalFunctions);
 
-CreateGenericQuadApi();
+TimeStep("CreateGenericQuadApi", \&CreateGenericQuadApi);
 
-CreateGenericStatsApi();
+TimeStep("CreateGenericStatsApi", \&CreateGenericStatsApi);
 
-CreateGenericQuadBulkApi();
+TimeStep("CreateGenericQuadBulkApi", \&CreateGenericQuadBulkApi);
 
-CreateApisQuery();
+TimeStep("CreateApisQuery", \&CreateApisQuery);
 
-CreateGlobalApisQuery();
+TimeStep("CreateGlobalApisQuery", \&CreateGlobalApisQuery);
 
-CreateObjectInfo();
+TimeStep("CreateObjectInfo", \&CreateObjectInfo);
 
-CreateListOfAllAttributes();
+TimeStep("CreateListOfAllAttributes", \&CreateListOfAllAttributes);
 
-CheckCapabilities();
+TimeStep("CheckCapabilities", \&CheckCapabilities);
 
-CheckApiStructNames();
+TimeStep("CheckApiStructNames", \&CheckApiStructNames);
 
-CheckApiDefines();
+TimeStep("CheckApiDefines", \&CheckApiDefines);
 
-CheckAttributeValueUnion();
+TimeStep("CheckAttributeValueUnion", \&CheckAttributeValueUnion);
 
-CheckStatEnum();
+TimeStep("CheckStatEnum", \&CheckStatEnum);
 
-CheckObjectTypeStatitics();
+TimeStep("CheckObjectTypeStatitics", \&CheckObjectTypeStatitics);
 
-CheckAllEnumsEndings();
+TimeStep("CheckAllEnumsEndings", \&CheckAllEnumsEndings);
 
-CreateNotificationStruct();
+TimeStep("CreateNotificationStruct", \&CreateNotificationStruct);
 
-CreateNotificationEnum();
+TimeStep("CreateNotificationEnum", \&CreateNotificationEnum);
 
-CreateNotificationNames();
+TimeStep("CreateNotificationNames", \&CreateNotificationNames);
 
-CreateSwitchNotificationAttributesList();
+TimeStep("CreateSwitchNotificationAttributesList", \&CreateSwitchNotificationAttributesList);
 
-CreateSwitchNotificationsUpdateMethods();
+TimeStep("CreateSwitchNotificationsUpdateMethods", \&CreateSwitchNotificationsUpdateMethods);
 
-CreateSwitchPointersStruct();
+TimeStep("CreateSwitchPointersStruct", \&CreateSwitchPointersStruct);
 
-CreateSwitchPointersEnum();
+TimeStep("CreateSwitchPointersEnum", \&CreateSwitchPointersEnum);
 
-CreateSwitchPointersAttributesList();
+TimeStep("CreateSwitchPointersAttributesList", \&CreateSwitchPointersAttributesList);
 
-CreateSerializeMethods();
+TimeStep("CreateSerializeMethods", \&CreateSerializeMethods);
 
-CreateSaiSwigGetApiHelperFunctions();
+TimeStep("CreateSaiSwigGetApiHelperFunctions", \&CreateSaiSwigGetApiHelperFunctions);
 
-CreateSaiSwigApiStructs();
+TimeStep("CreateSaiSwigApiStructs", \&CreateSaiSwigApiStructs);
 
-WriteHeaderFotter();
+TimeStep("WriteHeaderFotter", \&WriteHeaderFotter);
 
-CreateSourcePragmaPop();
+TimeStep("CreateSourcePragmaPop", \&CreateSourcePragmaPop);
 
 # Test Section
 
-CreateTests();
+TimeStep("CreateTests", \&CreateTests);
+
+TimeStep("WriteLoggerVariables", \&WriteLoggerVariables);
 
-WriteLoggerVariables();
+TimeStep("WriteMetaDataFiles", \&WriteMetaDataFiles);
 
-WriteMetaDataFiles();
+PrintGenerationTimes();
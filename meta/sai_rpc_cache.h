@@ -0,0 +1,782 @@
+/**
+ * Copyright (c) 2021 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABILITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc., Marvell International Ltd.
+ *
+ * @file    sai_rpc_cache.h
+ *
+ * @brief   This module defines warm restartable attribute cache of RPC server
+ *
+ * Attribute values returned by get RPCs are kept in a memory mapped file,
+ * keyed by (object id, attribute id). After RPC server restart get RPCs of
+ * objects which survived on the switch are answered from the file, which
+ * costs one existence check per object instead of one switch read per
+ * attribute.
+ *
+ * Every object and every object type has a generation number, values
+ * stored under older generation are stale. Set or remove of an object
+ * bumps its generation, invalidating object type bumps generation of all
+ * objects of that type. After restart cache epoch is increased, entries of
+ * previous epoch are used only after switch is known to survive restart.
+ * First hit on such entry asks validator whether its object still exists
+ * on the switch, the answer holds for all values of the object until next
+ * restart. Values stored as epoch only (read only values owned by the
+ * switch) are never used after restart.
+ *
+ * Cache is disabled unless file is given, either by environment variable
+ * read on first use or by explicit open() before first use:
+ *
+ *   SAI_RPC_CACHE_FILE=<path>  cache file
+ */
+
+#ifndef __SAI_RPC_CACHE_H_
+#define __SAI_RPC_CACHE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include <sai.h>
+}
+
+#define SAI_RPC_CACHE_MAGIC 0x4548434143435052ULL /* "RPCCACHE" */
+
+/**
+ * @brief Increase when layout of header or slot changes
+ */
+#define SAI_RPC_CACHE_FORMAT_VERSION 1
+
+/**
+ * @brief Number of hash slots, must be power of two
+ */
+#define SAI_RPC_CACHE_SLOTS (1 << 18)
+
+/**
+ * @brief Size of value arena, file is sparse so only used part takes memory
+ */
+#define SAI_RPC_CACHE_ARENA_SIZE (64 << 20)
+
+/**
+ * @brief Reserved attribute ids of generation slots
+ */
+#define SAI_RPC_CACHE_OBJECT_GENERATION (-1)
+
+#define SAI_RPC_CACHE_TYPE_GENERATION (-2)
+
+/**
+ * @brief Slot flag of value valid only in epoch it was stored in
+ */
+#define SAI_RPC_CACHE_FLAG_EPOCH_ONLY 0x1
+
+typedef enum _sai_rpc_cache_slot_state_t
+{
+    SAI_RPC_CACHE_SLOT_EMPTY,
+
+    SAI_RPC_CACHE_SLOT_VALID,
+
+    SAI_RPC_CACHE_SLOT_DELETED,
+
+} sai_rpc_cache_slot_state_t;
+
+/**
+ * @brief Header at the beginning of cache file
+ */
+typedef struct _sai_rpc_cache_header_t
+{
+    uint64_t magic;
+
+    uint32_t format_version;
+
+    uint32_t sai_api_version;
+
+    uint64_t slot_count;
+
+    uint64_t arena_size;
+
+    uint64_t arena_used;
+
+    /**
+     * @brief Valid and deleted slots, empty slots terminate probing
+     */
+    uint64_t used_slots;
+
+    sai_object_id_t switch_id;
+
+    /**
+     * @brief Incremented each time file is opened
+     */
+    uint32_t epoch;
+
+    /**
+     * @brief Set while cache is modified, nonzero on open means crash
+     */
+    uint32_t dirty;
+
+} sai_rpc_cache_header_t;
+
+/**
+ * @brief Single hash slot, either attribute value or generation number
+ */
+typedef struct _sai_rpc_cache_slot_t
+{
+    uint64_t oid;
+
+    int32_t attr_id;
+
+    uint32_t state;
+
+    /**
+     * @brief Epoch in which entry was last validated
+     */
+    uint32_t epoch;
+
+    uint32_t length;
+
+    uint64_t offset;
+
+    /**
+     * @brief Value generation for generation slots, object generation at store time otherwise
+     */
+    uint32_t generation;
+
+    uint32_t type_generation;
+
+    int32_t object_type;
+
+    /**
+     * @brief SAI_RPC_CACHE_FLAG_* of value slots
+     */
+    uint32_t flags;
+
+} sai_rpc_cache_slot_t;
+
+/**
+ * @brief Check that object of values stored before restart still exists
+ *
+ * Called without cache lock held, once per object and epoch, with the
+ * attribute of the first lookup. Returns false when object is gone.
+ */
+typedef bool (*sai_rpc_cache_validate_fn)(
+        sai_object_type_t object_type,
+        sai_object_id_t oid,
+        sai_attr_id_t attr_id);
+
+class sai_rpc_cache
+{
+    public:
+
+        static sai_rpc_cache& instance()
+        {
+            static sai_rpc_cache cache(getenv("SAI_RPC_CACHE_FILE"));
+
+            return cache;
+        }
+
+        explicit sai_rpc_cache(
+                const char *path = NULL):
+            m_header(NULL),
+            m_slots(NULL),
+            m_arena(NULL),
+            m_size(0),
+            m_trust_previous(false),
+            m_validate(NULL),
+            m_hits(0),
+            m_misses(0)
+        {
+            open(path);
+        }
+
+        ~sai_rpc_cache()
+        {
+            if (m_header)
+            {
+                munmap(m_header, m_size);
+            }
+        }
+
+        sai_rpc_cache(const sai_rpc_cache&) = delete;
+        sai_rpc_cache& operator=(const sai_rpc_cache&) = delete;
+
+        /**
+         * @brief Map cache file, ignored when cache is already enabled
+         */
+        bool open(
+                const char *path)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_header)
+            {
+                map(path);
+            }
+
+            return m_header != NULL;
+        }
+
+        bool enabled() const
+        {
+            return m_header != NULL;
+        }
+
+        /**
+         * @brief Get cached value, false if value is missing or stale
+         */
+        bool lookup(
+                sai_object_type_t object_type,
+                sai_object_id_t oid,
+                sai_attr_id_t attr_id,
+                std::string &value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (!m_header)
+            {
+                return false;
+            }
+
+            sai_rpc_cache_slot_t *slot = find((uint64_t)oid, (int32_t)attr_id, false);
+
+            if (!slot || !current(*slot, object_type))
+            {
+                m_misses++;
+                return false;
+            }
+
+            if (slot->epoch == m_header->epoch)
+            {
+                value.assign(m_arena + slot->offset, slot->length);
+
+                m_hits++;
+                return true;
+            }
+
+            // written before restart, used if object still exists on switch
+
+            if ((slot->flags & SAI_RPC_CACHE_FLAG_EPOCH_ONLY) || !m_trust_previous)
+            {
+                m_misses++;
+                return false;
+            }
+
+            if (!m_validated.count((uint64_t)oid))
+            {
+                sai_rpc_cache_validate_fn validate = m_validate;
+
+                if (!validate)
+                {
+                    m_misses++;
+                    return false;
+                }
+
+                lock.unlock();
+
+                bool valid = validate(object_type, oid, attr_id);
+
+                lock.lock();
+
+                if (!valid)
+                {
+                    // drop all values of the object, not only this one
+
+                    bump_locked((uint64_t)oid, SAI_RPC_CACHE_OBJECT_GENERATION);
+
+                    m_misses++;
+                    return false;
+                }
+
+                m_validated.insert((uint64_t)oid);
+
+                // slot could be moved or invalidated while unlocked
+
+                slot = find((uint64_t)oid, (int32_t)attr_id, false);
+
+                if (!slot || !current(*slot, object_type))
+                {
+                    m_misses++;
+                    return false;
+                }
+            }
+
+            slot->epoch = m_header->epoch;
+
+            value.assign(m_arena + slot->offset, slot->length);
+
+            m_hits++;
+            return true;
+        }
+
+        /**
+         * @brief Store value, epoch only value is dropped on next restart
+         */
+        void store(
+                sai_object_type_t object_type,
+                sai_object_id_t oid,
+                sai_attr_id_t attr_id,
+                const std::string &value,
+                bool epoch_only = false)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_header)
+            {
+                return;
+            }
+
+            modify_begin();
+
+            if (!reserve(value.size()))
+            {
+                reset_locked(m_header->switch_id);
+            }
+
+            sai_rpc_cache_slot_t *slot = find((uint64_t)oid, (int32_t)attr_id, true);
+
+            if (slot && m_header->arena_used + value.size() <= m_header->arena_size)
+            {
+                memcpy(m_arena + m_header->arena_used, value.data(), value.size());
+
+                slot->offset = m_header->arena_used;
+                slot->length = (uint32_t)value.size();
+                slot->epoch = m_header->epoch;
+                slot->object_type = object_type;
+                slot->generation = generation((uint64_t)oid, SAI_RPC_CACHE_OBJECT_GENERATION);
+                slot->type_generation = generation((uint64_t)object_type, SAI_RPC_CACHE_TYPE_GENERATION);
+                slot->flags = epoch_only ? SAI_RPC_CACHE_FLAG_EPOCH_ONLY : 0;
+
+                m_header->arena_used += value.size();
+            }
+
+            modify_end();
+        }
+
+        /**
+         * @brief Drop all values of given object (set or remove)
+         */
+        void invalidate_object(
+                sai_object_id_t oid)
+        {
+            bump(oid, SAI_RPC_CACHE_OBJECT_GENERATION);
+        }
+
+        /**
+         * @brief Drop all values of objects of given type
+         */
+        void invalidate_object_type(
+                sai_object_type_t object_type)
+        {
+            bump((uint64_t)object_type, SAI_RPC_CACHE_TYPE_GENERATION);
+        }
+
+        /**
+         * @brief Drop everything, used on switch cold boot
+         */
+        void reset(
+                sai_object_id_t switch_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_header)
+            {
+                return;
+            }
+
+            modify_begin();
+            reset_locked(switch_id);
+            modify_end();
+        }
+
+        sai_object_id_t switch_id() const
+        {
+            return m_header ? m_header->switch_id : SAI_NULL_OBJECT_ID;
+        }
+
+        /**
+         * @brief Allow values written before restart to be used
+         *
+         * Set once it is known that switch survived the restart (warm boot
+         * or connecting to existing switch), until then such values miss.
+         */
+        void trust_previous(
+                bool trust)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_trust_previous = trust;
+        }
+
+        /**
+         * @brief Set validator of values written before restart, without it such values miss
+         */
+        void set_validator(
+                sai_rpc_cache_validate_fn validate)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_validate = validate;
+        }
+
+        uint32_t epoch() const
+        {
+            return m_header ? m_header->epoch : 0;
+        }
+
+        uint64_t hits() const
+        {
+            return m_hits;
+        }
+
+        uint64_t misses() const
+        {
+            return m_misses;
+        }
+
+    private:
+
+        void map(
+                const char *path)
+        {
+            if (!path || !*path)
+            {
+                return;
+            }
+
+            m_size = sizeof(sai_rpc_cache_header_t) +
+                sizeof(sai_rpc_cache_slot_t) * SAI_RPC_CACHE_SLOTS +
+                SAI_RPC_CACHE_ARENA_SIZE;
+
+            int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+
+            if (fd < 0)
+            {
+                fprintf(stderr, "sai_rpc_cache: failed to open %s, cache disabled\n", path);
+                return;
+            }
+
+            struct stat st;
+
+            bool fresh = fstat(fd, &st) != 0 || (size_t)st.st_size != m_size;
+
+            if (fresh && ftruncate(fd, (off_t)m_size) != 0)
+            {
+                fprintf(stderr, "sai_rpc_cache: failed to resize %s, cache disabled\n", path);
+                close(fd);
+                return;
+            }
+
+            void *addr = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            close(fd);
+
+            if (addr == MAP_FAILED)
+            {
+                fprintf(stderr, "sai_rpc_cache: failed to map %s, cache disabled\n", path);
+                return;
+            }
+
+            m_header = (sai_rpc_cache_header_t*)addr;
+            m_slots = (sai_rpc_cache_slot_t*)(m_header + 1);
+            m_arena = (char*)(m_slots + SAI_RPC_CACHE_SLOTS);
+
+            if (fresh ||
+                    m_header->magic != SAI_RPC_CACHE_MAGIC ||
+                    m_header->format_version != SAI_RPC_CACHE_FORMAT_VERSION ||
+                    m_header->sai_api_version != (uint32_t)SAI_API_VERSION ||
+                    m_header->slot_count != SAI_RPC_CACHE_SLOTS ||
+                    m_header->arena_size != SAI_RPC_CACHE_ARENA_SIZE ||
+                    m_header->dirty)
+            {
+                memset(m_header, 0, sizeof(sai_rpc_cache_header_t));
+
+                m_header->magic = SAI_RPC_CACHE_MAGIC;
+                m_header->format_version = SAI_RPC_CACHE_FORMAT_VERSION;
+                m_header->sai_api_version = (uint32_t)SAI_API_VERSION;
+                m_header->slot_count = SAI_RPC_CACHE_SLOTS;
+                m_header->arena_size = SAI_RPC_CACHE_ARENA_SIZE;
+
+                reset_locked(SAI_NULL_OBJECT_ID);
+            }
+
+            m_header->epoch++;
+        }
+
+        static uint64_t hash(
+                uint64_t oid,
+                int32_t attr_id)
+        {
+            uint64_t h = oid ^ ((uint64_t)(uint32_t)attr_id * 0x9e3779b97f4a7c15ULL);
+
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebULL;
+            h ^= h >> 31;
+
+            return h;
+        }
+
+        /**
+         * @brief Find slot by key, when insert is true return empty slot for new key
+         */
+        sai_rpc_cache_slot_t* find(
+                uint64_t oid,
+                int32_t attr_id,
+                bool insert)
+        {
+            const uint64_t mask = SAI_RPC_CACHE_SLOTS - 1;
+
+            sai_rpc_cache_slot_t *deleted = NULL;
+
+            for (uint64_t idx = hash(oid, attr_id) & mask, probe = 0; probe < SAI_RPC_CACHE_SLOTS; idx = (idx + 1) & mask, probe++)
+            {
+                sai_rpc_cache_slot_t *slot = &m_slots[idx];
+
+                if (slot->state == SAI_RPC_CACHE_SLOT_EMPTY)
+                {
+                    if (!insert)
+                    {
+                        return NULL;
+                    }
+
+                    if (!deleted)
+                    {
+                        if (m_header->used_slots >= SAI_RPC_CACHE_SLOTS - 1)
+                        {
+                            return NULL;
+                        }
+
+                        m_header->used_slots++;
+                    }
+
+                    slot = deleted ? deleted : slot;
+
+                    memset(slot, 0, sizeof(sai_rpc_cache_slot_t));
+
+                    slot->oid = oid;
+                    slot->attr_id = attr_id;
+                    slot->state = SAI_RPC_CACHE_SLOT_VALID;
+
+                    return slot;
+                }
+
+                if (slot->state == SAI_RPC_CACHE_SLOT_DELETED)
+                {
+                    deleted = deleted ? deleted : slot;
+                    continue;
+                }
+
+                if (slot->oid == oid && slot->attr_id == attr_id)
+                {
+                    return slot;
+                }
+            }
+
+            return NULL;
+        }
+
+        uint32_t generation(
+                uint64_t key,
+                int32_t kind)
+        {
+            sai_rpc_cache_slot_t *slot = find(key, kind, false);
+
+            return slot ? slot->generation : 0;
+        }
+
+        bool current(
+                const sai_rpc_cache_slot_t &slot,
+                sai_object_type_t object_type)
+        {
+            return slot.object_type == object_type &&
+                slot.generation == generation(slot.oid, SAI_RPC_CACHE_OBJECT_GENERATION) &&
+                slot.type_generation == generation((uint64_t)object_type, SAI_RPC_CACHE_TYPE_GENERATION);
+        }
+
+        void bump(
+                uint64_t key,
+                int32_t kind)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_header)
+            {
+                return;
+            }
+
+            bump_locked(key, kind);
+        }
+
+        void bump_locked(
+                uint64_t key,
+                int32_t kind)
+        {
+            modify_begin();
+
+            sai_rpc_cache_slot_t *slot = find(key, kind, true);
+
+            if (slot)
+            {
+                slot->generation++;
+            }
+            else
+            {
+                // no room to record invalidation, everything must go
+
+                reset_locked(m_header->switch_id);
+            }
+
+            modify_end();
+        }
+
+        /**
+         * @brief Make room for value, compacting arena and slots if needed
+         */
+        bool reserve(
+                size_t length)
+        {
+            if (m_header->arena_used + length <= m_header->arena_size &&
+                    m_header->used_slots < SAI_RPC_CACHE_SLOTS / 4 * 3)
+            {
+                return true;
+            }
+
+            std::vector<sai_rpc_cache_slot_t> live;
+
+            std::vector<char> values;
+
+            std::unordered_set<uint64_t> referenced;
+
+            for (uint64_t idx = 0; idx < SAI_RPC_CACHE_SLOTS; idx++)
+            {
+                sai_rpc_cache_slot_t slot = m_slots[idx];
+
+                if (slot.state != SAI_RPC_CACHE_SLOT_VALID)
+                {
+                    continue;
+                }
+
+                if (slot.attr_id >= 0)
+                {
+                    if (!current(slot, (sai_object_type_t)slot.object_type) ||
+                            ((slot.flags & SAI_RPC_CACHE_FLAG_EPOCH_ONLY) && slot.epoch != m_header->epoch))
+                    {
+                        continue;
+                    }
+
+                    uint64_t offset = values.size();
+
+                    values.insert(values.end(), m_arena + slot.offset, m_arena + slot.offset + slot.length);
+
+                    slot.offset = offset;
+
+                    referenced.insert(slot.oid);
+                }
+
+                live.push_back(slot);
+            }
+
+            // object generation without any value is not needed, starting
+            // over from zero only makes older (already dropped) values stale
+
+            for (size_t idx = 0; idx < live.size(); )
+            {
+                if (live[idx].attr_id == SAI_RPC_CACHE_OBJECT_GENERATION && !referenced.count(live[idx].oid))
+                {
+                    live[idx] = live.back();
+                    live.pop_back();
+                    continue;
+                }
+
+                idx++;
+            }
+
+            memset(m_slots, 0, sizeof(sai_rpc_cache_slot_t) * SAI_RPC_CACHE_SLOTS);
+
+            m_header->used_slots = 0;
+
+            for (auto &slot: live)
+            {
+                sai_rpc_cache_slot_t *dst = find(slot.oid, slot.attr_id, true);
+
+                *dst = slot;
+            }
+
+            memcpy(m_arena, values.data(), values.size());
+
+            m_header->arena_used = values.size();
+
+            return m_header->arena_used + length <= m_header->arena_size &&
+                m_header->used_slots < SAI_RPC_CACHE_SLOTS / 4 * 3;
+        }
+
+        void reset_locked(
+                sai_object_id_t switch_id)
+        {
+            memset(m_slots, 0, sizeof(sai_rpc_cache_slot_t) * SAI_RPC_CACHE_SLOTS);
+
+            m_header->used_slots = 0;
+            m_header->arena_used = 0;
+            m_header->switch_id = switch_id;
+
+            m_validated.clear();
+        }
+
+        void modify_begin()
+        {
+            m_header->dirty = 1;
+        }
+
+        void modify_end()
+        {
+            m_header->dirty = 0;
+        }
+
+        std::mutex m_mutex;
+
+        sai_rpc_cache_header_t *m_header;
+
+        sai_rpc_cache_slot_t *m_slots;
+
+        char *m_arena;
+
+        size_t m_size;
+
+        bool m_trust_previous;
+
+        sai_rpc_cache_validate_fn m_validate;
+
+        /**
+         * @brief Objects of previous epoch values found on switch in this epoch
+         */
+        std::unordered_set<uint64_t> m_validated;
+
+        uint64_t m_hits;
+
+        uint64_t m_misses;
+};
+
+#endif // __SAI_RPC_CACHE_H_
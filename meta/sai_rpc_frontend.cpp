@@ -23,8 +23,11 @@
  */
 
 #include <arpa/inet.h>
+#include <inttypes.h>
 
 #include "sai_rpc.h"
+#include "sai_rpc_stats.h"
+#include "sai_rpc_cache.h"
 
 extern "C" {
 #include "saimetadata.h"
@@ -32,6 +35,15 @@ extern "C" {
 
 #include <iostream>
 #include <cstring>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
 
 using namespace ::sai;
 
@@ -869,6 +881,576 @@ static void sai_thrift_nat_type_t_parse(
     *nat_type = (sai_nat_type_t)thrift_nat_type;
 }
 
+#ifndef SAI_THRIFT_HOSTIF_PACKET_RING_SIZE
+#define SAI_THRIFT_HOSTIF_PACKET_RING_SIZE 4096
+#endif
+
+#define SAI_THRIFT_HOSTIF_PACKET_MAX_SIZE 16384
+#define SAI_THRIFT_HOSTIF_PACKET_MAX_ATTRS 16
+
+/**
+ * @brief Bounded ring buffering packet event notifications
+ *
+ * Slots are preallocated and reused, so the notification path only copies
+ * the packet into an existing buffer. When the ring is full, new packets are
+ * dropped and counted instead of blocking the SAI notification thread.
+ * Clients drain the ring in batches through sai_thrift_recv_hostif_packets().
+ */
+class sai_thrift_hostif_packet_ring
+{
+    public:
+
+        sai_thrift_hostif_packet_ring(
+                size_t size):
+            m_slots(size),
+            m_head(0),
+            m_count(0),
+            m_rx_queued(0),
+            m_rx_dropped(0),
+            m_rx_packets(0),
+            m_rx_bytes(0),
+            m_tx_packets(0),
+            m_tx_bytes(0),
+            m_tx_errors(0),
+            m_last_rx_packets(0),
+            m_last_tx_packets(0),
+            m_last_time(std::chrono::steady_clock::now())
+        {
+        }
+
+        /**
+         * @brief Copy packet into next free slot, called from notification context
+         */
+        void push(
+                sai_object_id_t switch_id,
+                sai_size_t buffer_size,
+                const void *buffer,
+                uint32_t attr_count,
+                const sai_attribute_t *attr_list)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_count == m_slots.size())
+            {
+                m_rx_dropped++;
+                return;
+            }
+
+            auto &slot = m_slots[(m_head + m_count) % m_slots.size()];
+
+            const uint8_t *data = static_cast<const uint8_t *>(buffer);
+
+            slot.switch_id = switch_id;
+            slot.data.assign(data, data + buffer_size);
+            slot.attrs.clear();
+
+            for (uint32_t i = 0; i < attr_count; i++)
+            {
+                const auto md = sai_metadata_get_attr_metadata(SAI_OBJECT_TYPE_HOSTIF_PACKET, attr_list[i].id);
+
+                // only primitive attributes can be copied without deep copy of lists
+
+                if (md != NULL && md->isprimitive)
+                {
+                    slot.attrs.push_back(attr_list[i]);
+                }
+            }
+
+            m_count++;
+            m_rx_queued++;
+        }
+
+        /**
+         * @brief Move up to max_packets packets from ring into Thrift list
+         */
+        void drain(
+                std::vector<sai_thrift_hostif_packet_t> &thrift_packets,
+                size_t max_packets)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            size_t count = std::min(max_packets, m_count);
+
+            thrift_packets.reserve(thrift_packets.size() + count);
+
+            for (size_t n = 0; n < count; n++)
+            {
+                auto &slot = m_slots[m_head];
+
+                thrift_packets.emplace_back();
+
+                to_thrift(slot.switch_id, slot.data.size(), slot.data.data(),
+                        (uint32_t)slot.attrs.size(), slot.attrs.data(), thrift_packets.back());
+
+                m_head = (m_head + 1) % m_slots.size();
+                m_count--;
+            }
+        }
+
+        /**
+         * @brief Convert single packet to Thrift format and account it as received
+         */
+        void to_thrift(
+                sai_object_id_t switch_id,
+                sai_size_t buffer_size,
+                const void *buffer,
+                uint32_t attr_count,
+                const sai_attribute_t *attr_list,
+                sai_thrift_hostif_packet_t &thrift_packet)
+        {
+            thrift_packet.switch_id = switch_id;
+            thrift_packet.data.assign(static_cast<const char *>(buffer), buffer_size);
+
+            for (uint32_t i = 0; i < attr_count; i++)
+            {
+                sai_thrift_attribute_t thrift_attr;
+
+                try
+                {
+                    convert_attr_sai_to_thrift(SAI_OBJECT_TYPE_HOSTIF_PACKET, attr_list[i], thrift_attr);
+                }
+                catch (const sai_thrift_exception &)
+                {
+                    // attribute type not representable in Thrift (e.g. timespec), skip it
+                    continue;
+                }
+
+                thrift_packet.attr_list.push_back(thrift_attr);
+            }
+
+            m_rx_packets++;
+            m_rx_bytes += buffer_size;
+        }
+
+        void tx_account(
+                sai_status_t status,
+                size_t buffer_size)
+        {
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                m_tx_errors++;
+                return;
+            }
+
+            m_tx_packets++;
+            m_tx_bytes += buffer_size;
+        }
+
+        /**
+         * @brief Fill statistics, rates are computed since previous call
+         */
+        void stats(
+                sai_thrift_hostif_packet_stats_t &thrift_stats)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto now = std::chrono::steady_clock::now();
+
+            double interval = std::chrono::duration<double>(now - m_last_time).count();
+
+            uint64_t rx_packets = m_rx_packets;
+            uint64_t tx_packets = m_tx_packets;
+
+            thrift_stats.rx_queued = m_rx_queued;
+            thrift_stats.rx_dropped = m_rx_dropped;
+            thrift_stats.rx_packets = rx_packets;
+            thrift_stats.rx_bytes = m_rx_bytes;
+            thrift_stats.tx_packets = tx_packets;
+            thrift_stats.tx_bytes = m_tx_bytes;
+            thrift_stats.tx_errors = m_tx_errors;
+            thrift_stats.rx_pending = (int32_t)m_count;
+            thrift_stats.rx_capacity = (int32_t)m_slots.size();
+            thrift_stats.interval = interval;
+            thrift_stats.rx_pps = interval > 0 ? (double)(rx_packets - m_last_rx_packets) / interval : 0;
+            thrift_stats.tx_pps = interval > 0 ? (double)(tx_packets - m_last_tx_packets) / interval : 0;
+
+            m_last_rx_packets = rx_packets;
+            m_last_tx_packets = tx_packets;
+            m_last_time = now;
+        }
+
+    private:
+
+        struct slot_t
+        {
+            sai_object_id_t switch_id;
+
+            std::vector<uint8_t> data;
+
+            std::vector<sai_attribute_t> attrs;
+        };
+
+        std::mutex m_mutex;
+
+        std::vector<slot_t> m_slots;
+
+        size_t m_head;
+
+        size_t m_count;
+
+        uint64_t m_rx_queued;
+
+        uint64_t m_rx_dropped;
+
+        std::atomic<uint64_t> m_rx_packets;
+
+        std::atomic<uint64_t> m_rx_bytes;
+
+        std::atomic<uint64_t> m_tx_packets;
+
+        std::atomic<uint64_t> m_tx_bytes;
+
+        std::atomic<uint64_t> m_tx_errors;
+
+        uint64_t m_last_rx_packets;
+
+        uint64_t m_last_tx_packets;
+
+        std::chrono::steady_clock::time_point m_last_time;
+};
+
+static sai_thrift_hostif_packet_ring gHostifPacketRing(SAI_THRIFT_HOSTIF_PACKET_RING_SIZE);
+
+/**
+ * @brief Packet event notification, buffers packet in the ring
+ */
+static void sai_thrift_on_packet_event(
+        sai_object_id_t switch_id,
+        sai_size_t buffer_size,
+        const void *buffer,
+        uint32_t attr_count,
+        const sai_attribute_t *attr_list)
+{
+    gHostifPacketRing.push(switch_id, buffer_size, buffer, attr_count, attr_list);
+}
+
+static sai_object_id_t gHostifPacketRingSwitchId = SAI_NULL_OBJECT_ID;
+
+/**
+ * @brief Attach packet ring to switch packet event notification
+ *
+ * Called as soon as switch is known to the server, so packets received
+ * before first drain are buffered in the ring.
+ */
+static void sai_thrift_hostif_packet_ring_attach(
+        sai_object_id_t switch_id)
+{
+    if (switch_id == SAI_NULL_OBJECT_ID || switch_id == gHostifPacketRingSwitchId)
+    {
+        return;
+    }
+
+    sai_switch_api_t *switch_api;
+
+    sai_status_t status = sai_api_query(SAI_API_SWITCH, (void **)&switch_api);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return;
+    }
+
+    sai_attribute_t attr;
+
+    attr.id = SAI_SWITCH_ATTR_PACKET_EVENT_NOTIFY;
+    attr.value.ptr = (sai_pointer_t)&sai_thrift_on_packet_event;
+
+    status = switch_api->set_switch_attribute(switch_id, &attr);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        SAI_META_LOG_ERROR("failed to set packet event notification on switch 0x%" PRIx64, switch_id);
+        return;
+    }
+
+    gHostifPacketRingSwitchId = switch_id;
+}
+
+/**
+ * @brief Detach packet ring, notification is gone together with switch
+ */
+static void sai_thrift_hostif_packet_ring_detach()
+{
+    gHostifPacketRingSwitchId = SAI_NULL_OBJECT_ID;
+}
+
+/**
+ * @brief Check if attribute is read only switch attribute clients discover switch with
+ *
+ * Those (default VLAN, CPU port, port list and so on) only change when
+ * switch is initialized or ports are created or removed. They are cached
+ * for current epoch only and dropped on any of those events.
+ */
+static bool sai_thrift_cache_is_discovery(
+        sai_object_type_t object_type,
+        sai_attr_id_t attr_id)
+{
+    if (object_type != SAI_OBJECT_TYPE_SWITCH)
+    {
+        return false;
+    }
+
+    switch (attr_id)
+    {
+        case SAI_SWITCH_ATTR_NUMBER_OF_ACTIVE_PORTS:
+        case SAI_SWITCH_ATTR_PORT_LIST:
+        case SAI_SWITCH_ATTR_CPU_PORT:
+        case SAI_SWITCH_ATTR_DEFAULT_VLAN_ID:
+        case SAI_SWITCH_ATTR_DEFAULT_STP_INST_ID:
+        case SAI_SWITCH_ATTR_DEFAULT_VIRTUAL_ROUTER_ID:
+        case SAI_SWITCH_ATTR_DEFAULT_1Q_BRIDGE_ID:
+        case SAI_SWITCH_ATTR_DEFAULT_TRAP_GROUP:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Check if attribute value can be served from attribute cache
+ *
+ * Values given on create or by set RPC are cached, those do not change
+ * behind the server. Other read only values are owned by the switch (like
+ * oper status or counters) and are always read from SAI.
+ */
+static bool sai_thrift_cache_is_cacheable(
+        sai_object_type_t object_type,
+        sai_attr_id_t attr_id)
+{
+    const sai_attr_metadata_t *md = sai_metadata_get_attr_metadata(object_type, attr_id);
+
+    if (md == NULL || md->iscallback)
+    {
+        return false;
+    }
+
+    if (!md->iscreateonly && !md->iscreateandset && !sai_thrift_cache_is_discovery(object_type, attr_id))
+    {
+        return false;
+    }
+
+    // lane list is needed to map ports to front panel
+
+    return md->isprimitive ||
+        md->attrvaluetype == SAI_ATTR_VALUE_TYPE_OBJECT_LIST ||
+        md->attrvaluetype == SAI_ATTR_VALUE_TYPE_UINT32_LIST;
+}
+
+/**
+ * @brief Check that object of values cached before restart still exists on switch
+ *
+ * Called once per object. Attribute is read with empty lists, buffer
+ * overflow also proves object exists.
+ */
+static bool sai_thrift_cache_validate(
+        sai_object_type_t object_type,
+        sai_object_id_t oid,
+        sai_attr_id_t attr_id)
+{
+    static std::once_flag once;
+
+    std::call_once(once, []()
+    {
+        static sai_apis_t apis;
+
+        sai_metadata_apis_query(sai_api_query, &apis);
+    });
+
+    const sai_object_type_info_t *info = sai_metadata_get_object_type_info(object_type);
+
+    if (info == NULL || info->isnonobjectid)
+    {
+        return false;
+    }
+
+    sai_object_meta_key_t meta_key;
+
+    memset(&meta_key, 0, sizeof(meta_key));
+
+    meta_key.objecttype = object_type;
+    meta_key.objectkey.key.object_id = oid;
+
+    sai_attribute_t attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.id = attr_id;
+
+    sai_status_t status = info->get(&meta_key, 1, &attr);
+
+    return status == SAI_STATUS_SUCCESS || status == SAI_STATUS_BUFFER_OVERFLOW;
+}
+
+static std::string sai_thrift_cache_serialize(
+        const sai_thrift_attribute_t &thrift_attr)
+{
+    std::shared_ptr<apache::thrift::transport::TMemoryBuffer> buffer(new apache::thrift::transport::TMemoryBuffer());
+
+    apache::thrift::protocol::TBinaryProtocol protocol(buffer);
+
+    thrift_attr.write(&protocol);
+
+    return buffer->getBufferAsString();
+}
+
+static bool sai_thrift_cache_deserialize(
+        const std::string &value,
+        sai_thrift_attribute_t &thrift_attr)
+{
+    try
+    {
+        std::shared_ptr<apache::thrift::transport::TMemoryBuffer> buffer(new apache::thrift::transport::TMemoryBuffer(
+                    reinterpret_cast<uint8_t *>(const_cast<char *>(value.data())), (uint32_t)value.size(), apache::thrift::transport::TMemoryBuffer::OBSERVE));
+
+        apache::thrift::protocol::TBinaryProtocol protocol(buffer);
+
+        thrift_attr.read(&protocol);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Serve get attribute RPC from cache, only when all attributes are cached
+ */
+static bool sai_thrift_cache_get(
+        sai_object_type_t object_type,
+        sai_object_id_t oid,
+        const std::vector<sai_thrift_attribute_t> &thrift_attr_list,
+        std::vector<sai_thrift_attribute_t> &thrift_attr_list_out)
+{
+    sai_rpc_cache &cache = sai_rpc_cache::instance();
+
+    if (!cache.enabled() || thrift_attr_list.empty())
+    {
+        return false;
+    }
+
+    std::vector<sai_thrift_attribute_t> cached(thrift_attr_list.size());
+
+    std::string value;
+
+    for (size_t i = 0; i < thrift_attr_list.size(); i++)
+    {
+        const sai_thrift_attribute_t &requested = thrift_attr_list[i];
+
+        if (!sai_thrift_cache_is_cacheable(object_type, requested.id) ||
+                !cache.lookup(object_type, oid, requested.id, value) ||
+                !sai_thrift_cache_deserialize(value, cached[i]))
+        {
+            return false;
+        }
+
+        // let SAI report buffer overflow when caller list is too small
+
+        sai_attr_value_type_t value_type = sai_metadata_get_attr_metadata(object_type, requested.id)->attrvaluetype;
+
+        if ((value_type == SAI_ATTR_VALUE_TYPE_OBJECT_LIST &&
+                    cached[i].value.objlist.idlist.size() > (size_t)requested.value.objlist.count) ||
+                (value_type == SAI_ATTR_VALUE_TYPE_UINT32_LIST &&
+                    cached[i].value.u32list.uint32list.size() > (size_t)requested.value.u32list.count))
+        {
+            return false;
+        }
+    }
+
+    thrift_attr_list_out.insert(thrift_attr_list_out.end(), cached.begin(), cached.end());
+
+    return true;
+}
+
+static void sai_thrift_cache_put(
+        sai_object_type_t object_type,
+        sai_object_id_t oid,
+        const std::vector<sai_thrift_attribute_t> &thrift_attr_list)
+{
+    sai_rpc_cache &cache = sai_rpc_cache::instance();
+
+    if (!cache.enabled())
+    {
+        return;
+    }
+
+    for (const auto &thrift_attr: thrift_attr_list)
+    {
+        if (sai_thrift_cache_is_cacheable(object_type, thrift_attr.id))
+        {
+            cache.store(object_type, oid, thrift_attr.id, sai_thrift_cache_serialize(thrift_attr),
+                    sai_thrift_cache_is_discovery(object_type, thrift_attr.id));
+        }
+    }
+}
+
+static void sai_thrift_cache_object_set(
+        sai_object_id_t oid)
+{
+    sai_rpc_cache::instance().invalidate_object(oid);
+}
+
+static void sai_thrift_cache_object_removed(
+        sai_object_id_t oid)
+{
+    sai_rpc_cache::instance().invalidate_object(oid);
+}
+
+/**
+ * @brief Port created or removed, port list and port count of switch changed
+ */
+static void sai_thrift_cache_ports_changed()
+{
+    sai_rpc_cache &cache = sai_rpc_cache::instance();
+
+    cache.invalidate_object(cache.switch_id());
+}
+
+/**
+ * @brief Keep cached values only if switch survived restart
+ *
+ * That is when the same switch is warm recovered or RPC server only
+ * connects to already initialized switch, otherwise switch is cold booted
+ * and everything cached before is invalid. Surviving values are still
+ * validated against the switch on first use, discovery values of the
+ * switch are read again either way.
+ */
+static void sai_thrift_cache_switch_created(
+        sai_object_id_t oid,
+        const std::vector<sai_thrift_attribute_t> &thrift_attr_list)
+{
+    sai_rpc_cache &cache = sai_rpc_cache::instance();
+
+    bool survived = false;
+
+    for (const auto &thrift_attr: thrift_attr_list)
+    {
+        if ((thrift_attr.id == SAI_SWITCH_ATTR_INIT_SWITCH && !thrift_attr.value.booldata) ||
+                (thrift_attr.id == SAI_SWITCH_ATTR_WARM_RECOVER && thrift_attr.value.booldata))
+        {
+            survived = true;
+        }
+    }
+
+    if (survived && cache.switch_id() == oid)
+    {
+        cache.invalidate_object(oid);
+        cache.set_validator(sai_thrift_cache_validate);
+        cache.trust_previous(true);
+        return;
+    }
+
+    cache.trust_previous(false);
+    cache.reset(oid);
+}
+
+static void sai_thrift_cache_switch_removed()
+{
+    sai_rpc_cache::instance().trust_previous(false);
+    sai_rpc_cache::instance().reset(SAI_NULL_OBJECT_ID);
+}
+
 // including it here we never have to modify the generated file
 #include "sai_rpc_server.cpp"
 
@@ -883,13 +1465,15 @@ class sai_rpcHandlerFrontend:
             const sai_thrift_attr_id_t attr_id,
             const int32_t attr_type) override
     {
+        SAI_RPC_STATS_SCOPE("sai_thrift_object_type_get_availability");
+
         sai_attribute_t attr;
         attr.id = attr_id;
         attr.value.s32 = attr_type;
         uint32_t attr_count = 1;
         uint64_t count = 0;
 
-        sai_object_type_get_availability(switch_id, (sai_object_type_t)object_type, attr_count, &attr, &count);
+        SAI_RPC_SAI_CALL(sai_object_type_get_availability(switch_id, (sai_object_type_t)object_type, attr_count, &attr, &count));
         return count;
     }
 
@@ -899,6 +1483,8 @@ class sai_rpcHandlerFrontend:
     sai_thrift_object_type_t sai_thrift_object_type_query(
             const sai_thrift_object_id_t object_id) override
     {
+        SAI_RPC_STATS_SCOPE("sai_thrift_object_type_query");
+
         return sai_object_type_query(object_id);
     }
 
@@ -908,6 +1494,8 @@ class sai_rpcHandlerFrontend:
     sai_thrift_object_id_t sai_thrift_switch_id_query(
             const sai_thrift_object_id_t object_id) override
     {
+        SAI_RPC_STATS_SCOPE("sai_thrift_switch_id_query");
+
         return sai_switch_id_query(object_id);
     }
 
@@ -916,7 +1504,9 @@ class sai_rpcHandlerFrontend:
      */
     sai_thrift_status_t sai_thrift_api_uninitialize(void) override
     {
-        return sai_api_uninitialize();
+        SAI_RPC_STATS_SCOPE("sai_thrift_api_uninitialize");
+
+        return SAI_RPC_SAI_CALL(sai_api_uninitialize());
     }
 
     /**
@@ -929,6 +1519,8 @@ class sai_rpcHandlerFrontend:
             const sai_thrift_attr_id_t attr_id,
             const int32_t caps_count) override
     {
+        SAI_RPC_STATS_SCOPE("sai_thrift_query_attribute_enum_values_capability");
+
         if (!caps_count)
         {
             return;
@@ -941,11 +1533,11 @@ class sai_rpcHandlerFrontend:
         enum_values_capability.list = caps_list.data();
         enum_values_capability.count = caps_count;
 
-        sai_status_t status = sai_query_attribute_enum_values_capability(
+        sai_status_t status = SAI_RPC_SAI_CALL(sai_query_attribute_enum_values_capability(
                 (sai_object_id_t)switch_id,
                 (sai_object_type_t)object_type,
                 (sai_attr_id_t)attr_id,
-                &enum_values_capability);
+                &enum_values_capability));
 
         if (status == SAI_STATUS_SUCCESS)
         {
@@ -955,6 +1547,184 @@ class sai_rpcHandlerFrontend:
             }
         }
     }
+
+    /**
+     * @brief Thrift wrapper for batched sai_send_hostif_packet() SAI function
+     *
+     * Each packet is sent independently, status for each packet is returned
+     * in the same order as packets were provided.
+     */
+    void sai_thrift_send_hostif_packets(
+            std::vector<sai_thrift_status_t> &thrift_statuses,
+            const sai_thrift_object_id_t hostif_id,
+            const std::vector<sai_thrift_hostif_packet_t> &packets) override
+    {
+        SAI_RPC_STATS_SCOPE("sai_thrift_send_hostif_packets");
+
+        sai_hostif_api_t *hostif_api;
+
+        sai_status_t status = sai_api_query(SAI_API_HOSTIF, (void **)&hostif_api);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            sai_thrift_exception e;
+            e.status = status;
+            throw e;
+        }
+
+        thrift_statuses.reserve(packets.size());
+
+        std::vector<sai_attribute_t> attr_list;
+
+        for (const auto &packet: packets)
+        {
+            attr_list.resize(packet.attr_list.size());
+
+            try
+            {
+                for (size_t i = 0; i < packet.attr_list.size(); i++)
+                {
+                    convert_attr_thrift_to_sai(SAI_OBJECT_TYPE_HOSTIF_PACKET, packet.attr_list[i], &attr_list[i]);
+                }
+
+                status = SAI_RPC_SAI_CALL(hostif_api->send_hostif_packet(
+                        hostif_id,
+                        packet.data.size(),
+                        packet.data.data(),
+                        (uint32_t)attr_list.size(),
+                        attr_list.data()));
+            }
+            catch (const sai_thrift_exception &e)
+            {
+                status = e.status;
+            }
+
+            gHostifPacketRing.tx_account(status, packet.data.size());
+
+            thrift_statuses.push_back(status);
+        }
+    }
+
+    /**
+     * @brief Thrift wrapper for batched sai_recv_hostif_packet() SAI function
+     *
+     * When hostif_id is NULL object ID, packets are drained from the ring
+     * filled by packet event notification, otherwise given host interface is
+     * polled until it has no more packets or max_packets is reached.
+     */
+    void sai_thrift_recv_hostif_packets(
+            std::vector<sai_thrift_hostif_packet_t> &thrift_packets,
+            const sai_thrift_object_id_t hostif_id,
+            const int32_t max_packets) override
+    {
+        SAI_RPC_STATS_SCOPE("sai_thrift_recv_hostif_packets");
+
+        if (max_packets <= 0)
+        {
+            return;
+        }
+
+        if (hostif_id == SAI_NULL_OBJECT_ID)
+        {
+            gHostifPacketRing.drain(thrift_packets, (size_t)max_packets);
+
+            return;
+        }
+
+        sai_hostif_api_t *hostif_api;
+
+        sai_status_t status = sai_api_query(SAI_API_HOSTIF, (void **)&hostif_api);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            sai_thrift_exception e;
+            e.status = status;
+            throw e;
+        }
+
+        std::vector<uint8_t> buffer(SAI_THRIFT_HOSTIF_PACKET_MAX_SIZE);
+
+        sai_attribute_t attr_list[SAI_THRIFT_HOSTIF_PACKET_MAX_ATTRS];
+
+        for (int32_t n = 0; n < max_packets; n++)
+        {
+            sai_size_t buffer_size = buffer.size();
+            uint32_t attr_count = SAI_THRIFT_HOSTIF_PACKET_MAX_ATTRS;
+
+            status = SAI_RPC_SAI_CALL(hostif_api->recv_hostif_packet(hostif_id, &buffer_size, buffer.data(), &attr_count, attr_list));
+
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                // no more packets pending on this host interface
+                break;
+            }
+
+            thrift_packets.emplace_back();
+
+            gHostifPacketRing.to_thrift(switch_id, buffer_size, buffer.data(), attr_count, attr_list, thrift_packets.back());
+        }
+    }
+
+    /**
+     * @brief Get hostif packet path statistics including packets per second
+     */
+    void sai_thrift_get_hostif_packet_stats(
+            sai_thrift_hostif_packet_stats_t &thrift_stats) override
+    {
+        gHostifPacketRing.stats(thrift_stats);
+    }
+
+    /**
+     * @brief Get per RPC call counters and latency percentiles
+     */
+    void sai_thrift_get_rpc_stats(
+            std::vector<sai_thrift_rpc_stats_t> &thrift_stats,
+            const bool clear) override
+    {
+        for (const auto &s: sai_rpc_stats::instance().snapshot(clear))
+        {
+            sai_thrift_rpc_stats_t stats;
+
+            stats.name = s.name;
+            stats.calls = (int64_t)s.calls;
+            stats.errors = (int64_t)s.errors;
+            stats.sai_calls = (int64_t)s.sai_calls;
+            stats.total_ns = (int64_t)s.total_ns;
+            stats.sai_ns = (int64_t)s.sai_ns;
+            stats.p50_ns = (int64_t)s.p50_ns;
+            stats.p90_ns = (int64_t)s.p90_ns;
+            stats.p99_ns = (int64_t)s.p99_ns;
+            stats.p999_ns = (int64_t)s.p999_ns;
+            stats.max_ns = (int64_t)s.max_ns;
+            stats.sai_p50_ns = (int64_t)s.sai_p50_ns;
+            stats.sai_p99_ns = (int64_t)s.sai_p99_ns;
+            stats.conversion_p50_ns = (int64_t)s.conversion_p50_ns;
+            stats.conversion_p99_ns = (int64_t)s.conversion_p99_ns;
+
+            thrift_stats.push_back(stats);
+        }
+    }
+
+    /**
+     * @brief Get per RPC statistics formatted as text table
+     */
+    void sai_thrift_dump_rpc_stats(
+            std::string &text) override
+    {
+        text = sai_rpc_stats::instance().dump();
+    }
+
+    /**
+     * @brief Enable per call trace and set periodic dump interval (0 disables)
+     */
+    void sai_thrift_set_rpc_stats_config(
+            const bool trace,
+            const int32_t dump_interval) override
+    {
+        sai_rpc_stats::instance().set_trace(trace);
+
+        sai_rpc_stats::instance().set_dump_interval(dump_interval > 0 ? (uint32_t)dump_interval : 0);
+    }
 };
 
 static pthread_mutex_t cookie_mutex;
@@ -968,6 +1738,9 @@ static void *sai_thrift_rpc_server_thread(void *arg)
 {
     int port = *(int *)arg;
 
+    // switch may be already created by application, start buffering packets now
+    sai_thrift_hostif_packet_ring_attach(gSwitchId);
+
     std::shared_ptr<sai_rpcHandlerFrontend> handler(new sai_rpcHandlerFrontend());
     std::shared_ptr<TProcessor> processor(new sai_rpcProcessor(handler));
     std::shared_ptr<TServerTransport> serverTransport(new TServerSocket(port));
@@ -1046,4 +1819,12 @@ extern "C" {
 
         return status;
     }
+
+    /**
+     * @brief Enable attribute cache backed by given file, before server is started
+     */
+    int sai_thrift_rpc_cache_open(const char *path)
+    {
+        return sai_rpc_cache::instance().open(path) ? 0 : -1;
+    }
 }
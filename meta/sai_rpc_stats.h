@@ -0,0 +1,648 @@
+/**
+ * Copyright (c) 2021 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABILITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc., Marvell International Ltd.
+ *
+ * @file    sai_rpc_stats.h
+ *
+ * @brief   This module defines per RPC call counters and latency histograms
+ *
+ * Shared by the generated RPC server frontend and the handwritten
+ * saithrift server. Each RPC opens a scope with SAI_RPC_STATS_SCOPE, SAI
+ * calls made inside that scope are accounted separately, so time spent on
+ * Thrift conversion is total time minus SAI time.
+ *
+ * Environment variables read on first use:
+ *
+ *   SAI_RPC_STATS_TRACE=1            print every call with its latency
+ *   SAI_RPC_STATS_DUMP_INTERVAL=<s>  dump statistics table to stderr every s seconds
+ */
+
+#ifndef __SAI_RPC_STATS_H_
+#define __SAI_RPC_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <sai.h>
+}
+
+/**
+ * @brief Number of bits used for sub buckets in each power of two range
+ *
+ * With 4 bits each recorded value is within 1/16 of its bucket bound.
+ */
+#define SAI_RPC_HISTOGRAM_SUB_BUCKET_BITS 4
+
+#define SAI_RPC_HISTOGRAM_SUB_BUCKETS (1ULL << SAI_RPC_HISTOGRAM_SUB_BUCKET_BITS)
+
+#define SAI_RPC_HISTOGRAM_BUCKETS (SAI_RPC_HISTOGRAM_SUB_BUCKETS * (65 - SAI_RPC_HISTOGRAM_SUB_BUCKET_BITS))
+
+/**
+ * @brief Log-linear latency histogram in nanoseconds (HDR style)
+ *
+ * Values below 2 * SUB_BUCKETS are counted exactly, above that every power
+ * of two range is split into SUB_BUCKETS linear buckets. Recording is lock
+ * free, so histogram can be read by dump thread while RPC thread records.
+ */
+class sai_rpc_histogram
+{
+    public:
+
+        sai_rpc_histogram()
+        {
+            reset();
+        }
+
+        void record(
+                uint64_t value)
+        {
+            m_buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t max = m_max.load(std::memory_order_relaxed);
+
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /**
+         * @brief Get value at given percentile (0..100), bucket upper bound is returned
+         */
+        uint64_t percentile(
+                double percent) const
+        {
+            uint64_t count = m_count.load(std::memory_order_relaxed);
+
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            uint64_t rank = (uint64_t)((double)count * percent / 100.0 + 0.5);
+
+            if (rank == 0)
+            {
+                rank = 1;
+            }
+
+            uint64_t seen = 0;
+
+            for (size_t idx = 0; idx < SAI_RPC_HISTOGRAM_BUCKETS; idx++)
+            {
+                seen += m_buckets[idx].load(std::memory_order_relaxed);
+
+                if (seen >= rank)
+                {
+                    uint64_t bound = upper_bound(idx);
+
+                    uint64_t max = m_max.load(std::memory_order_relaxed);
+
+                    return bound < max ? bound : max;
+                }
+            }
+
+            return m_max.load(std::memory_order_relaxed);
+        }
+
+        uint64_t count() const
+        {
+            return m_count.load(std::memory_order_relaxed);
+        }
+
+        uint64_t sum() const
+        {
+            return m_sum.load(std::memory_order_relaxed);
+        }
+
+        uint64_t max() const
+        {
+            return m_max.load(std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            for (size_t idx = 0; idx < SAI_RPC_HISTOGRAM_BUCKETS; idx++)
+            {
+                m_buckets[idx].store(0, std::memory_order_relaxed);
+            }
+
+            m_count.store(0, std::memory_order_relaxed);
+            m_sum.store(0, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+
+        static size_t index(
+                uint64_t value)
+        {
+            if (value < 2 * SAI_RPC_HISTOGRAM_SUB_BUCKETS)
+            {
+                return (size_t)value;
+            }
+
+            unsigned int msb = 63 - (unsigned int)__builtin_clzll(value);
+
+            unsigned int shift = msb - SAI_RPC_HISTOGRAM_SUB_BUCKET_BITS;
+
+            uint64_t sub = (value >> shift) - SAI_RPC_HISTOGRAM_SUB_BUCKETS;
+
+            return (size_t)(2 * SAI_RPC_HISTOGRAM_SUB_BUCKETS + (shift - 1) * SAI_RPC_HISTOGRAM_SUB_BUCKETS + sub);
+        }
+
+        static uint64_t upper_bound(
+                size_t idx)
+        {
+            if (idx < 2 * SAI_RPC_HISTOGRAM_SUB_BUCKETS)
+            {
+                return (uint64_t)idx;
+            }
+
+            uint64_t shift = (idx - 2 * SAI_RPC_HISTOGRAM_SUB_BUCKETS) / SAI_RPC_HISTOGRAM_SUB_BUCKETS + 1;
+
+            uint64_t sub = (idx - 2 * SAI_RPC_HISTOGRAM_SUB_BUCKETS) % SAI_RPC_HISTOGRAM_SUB_BUCKETS;
+
+            return ((SAI_RPC_HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+        }
+
+        std::atomic<uint64_t> m_buckets[SAI_RPC_HISTOGRAM_BUCKETS];
+
+        std::atomic<uint64_t> m_count;
+
+        std::atomic<uint64_t> m_sum;
+
+        std::atomic<uint64_t> m_max;
+};
+
+/**
+ * @brief Statistics of single RPC method
+ */
+typedef struct _sai_rpc_method_stats_t
+{
+    std::string name;
+
+    std::atomic<uint64_t> calls;
+
+    std::atomic<uint64_t> errors;
+
+    std::atomic<uint64_t> sai_calls;
+
+    /**
+     * @brief Whole RPC handler time
+     */
+    sai_rpc_histogram total;
+
+    /**
+     * @brief Time spent inside SAI API calls made by the handler
+     */
+    sai_rpc_histogram sai;
+
+    /**
+     * @brief Handler time outside SAI (Thrift conversion, bookkeeping)
+     */
+    sai_rpc_histogram conversion;
+
+} sai_rpc_method_stats_t;
+
+/**
+ * @brief Point in time copy of single RPC method statistics
+ */
+typedef struct _sai_rpc_method_snapshot_t
+{
+    std::string name;
+
+    uint64_t calls;
+
+    uint64_t errors;
+
+    uint64_t sai_calls;
+
+    uint64_t total_ns;
+
+    uint64_t sai_ns;
+
+    uint64_t p50_ns;
+
+    uint64_t p90_ns;
+
+    uint64_t p99_ns;
+
+    uint64_t p999_ns;
+
+    uint64_t max_ns;
+
+    uint64_t sai_p50_ns;
+
+    uint64_t sai_p99_ns;
+
+    uint64_t conversion_p50_ns;
+
+    uint64_t conversion_p99_ns;
+
+} sai_rpc_method_snapshot_t;
+
+/**
+ * @brief Registry of all RPC method statistics
+ */
+class sai_rpc_stats
+{
+    public:
+
+        static sai_rpc_stats& instance()
+        {
+            static sai_rpc_stats stats;
+
+            return stats;
+        }
+
+        /**
+         * @brief Get (or create) statistics of given method, pointer stays valid
+         */
+        sai_rpc_method_stats_t* method(
+                const char *name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto &stats = m_methods[name];
+
+            if (!stats)
+            {
+                stats.reset(new sai_rpc_method_stats_t());
+
+                stats->name = name;
+                stats->calls = 0;
+                stats->errors = 0;
+                stats->sai_calls = 0;
+            }
+
+            return stats.get();
+        }
+
+        bool trace() const
+        {
+            return m_trace.load(std::memory_order_relaxed);
+        }
+
+        void set_trace(
+                bool enable)
+        {
+            m_trace.store(enable, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get statistics of all methods which were called at least once
+         */
+        std::vector<sai_rpc_method_snapshot_t> snapshot(
+                bool clear)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            std::vector<sai_rpc_method_snapshot_t> snapshots;
+
+            for (auto &kvp: m_methods)
+            {
+                sai_rpc_method_stats_t &stats = *kvp.second;
+
+                if (stats.calls == 0)
+                {
+                    continue;
+                }
+
+                sai_rpc_method_snapshot_t s;
+
+                s.name = stats.name;
+                s.calls = stats.calls;
+                s.errors = stats.errors;
+                s.sai_calls = stats.sai_calls;
+                s.total_ns = stats.total.sum();
+                s.sai_ns = stats.sai.sum();
+                s.p50_ns = stats.total.percentile(50);
+                s.p90_ns = stats.total.percentile(90);
+                s.p99_ns = stats.total.percentile(99);
+                s.p999_ns = stats.total.percentile(99.9);
+                s.max_ns = stats.total.max();
+                s.sai_p50_ns = stats.sai.percentile(50);
+                s.sai_p99_ns = stats.sai.percentile(99);
+                s.conversion_p50_ns = stats.conversion.percentile(50);
+                s.conversion_p99_ns = stats.conversion.percentile(99);
+
+                snapshots.push_back(s);
+
+                if (clear)
+                {
+                    stats.calls = 0;
+                    stats.errors = 0;
+                    stats.sai_calls = 0;
+                    stats.total.reset();
+                    stats.sai.reset();
+                    stats.conversion.reset();
+                }
+            }
+
+            return snapshots;
+        }
+
+        /**
+         * @brief Format statistics as text table, latencies in microseconds
+         */
+        std::string dump()
+        {
+            auto snapshots = snapshot(false);
+
+            std::string text;
+
+            char line[512];
+
+            snprintf(line, sizeof(line), "%-56s %10s %8s %10s %10s %10s %10s %10s %10s %10s\n",
+                    "method", "calls", "errors", "p50", "p90", "p99", "p99.9", "max", "sai%", "sai_p50");
+
+            text += line;
+
+            for (auto &s: snapshots)
+            {
+                double sai_share = s.total_ns ? 100.0 * (double)s.sai_ns / (double)s.total_ns : 0.0;
+
+                snprintf(line, sizeof(line), "%-56s %10llu %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %9.1f%% %10.1f\n",
+                        s.name.c_str(),
+                        (unsigned long long)s.calls,
+                        (unsigned long long)s.errors,
+                        (double)s.p50_ns / 1000.0,
+                        (double)s.p90_ns / 1000.0,
+                        (double)s.p99_ns / 1000.0,
+                        (double)s.p999_ns / 1000.0,
+                        (double)s.max_ns / 1000.0,
+                        sai_share,
+                        (double)s.sai_p50_ns / 1000.0);
+
+                text += line;
+            }
+
+            return text;
+        }
+
+        /**
+         * @brief Start periodic dump to stderr, zero interval stops it
+         */
+        void set_dump_interval(
+                uint32_t seconds)
+        {
+            stop_dump_thread();
+
+            if (seconds == 0)
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_dump_mutex);
+
+            m_dump_interval = seconds;
+            m_dump_run = true;
+            m_dump_thread = std::thread(&sai_rpc_stats::dump_thread, this);
+        }
+
+    private:
+
+        sai_rpc_stats():
+            m_trace(false),
+            m_dump_interval(0),
+            m_dump_run(false)
+        {
+            const char *trace_env = getenv("SAI_RPC_STATS_TRACE");
+
+            if (trace_env && atoi(trace_env) > 0)
+            {
+                m_trace = true;
+            }
+
+            const char *interval_env = getenv("SAI_RPC_STATS_DUMP_INTERVAL");
+
+            if (interval_env && atoi(interval_env) > 0)
+            {
+                set_dump_interval((uint32_t)atoi(interval_env));
+            }
+        }
+
+        ~sai_rpc_stats()
+        {
+            stop_dump_thread();
+        }
+
+        void stop_dump_thread()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_dump_mutex);
+
+                m_dump_run = false;
+            }
+
+            m_dump_cv.notify_all();
+
+            if (m_dump_thread.joinable())
+            {
+                m_dump_thread.join();
+            }
+        }
+
+        void dump_thread()
+        {
+            std::unique_lock<std::mutex> lock(m_dump_mutex);
+
+            while (m_dump_run)
+            {
+                m_dump_cv.wait_for(lock, std::chrono::seconds(m_dump_interval));
+
+                if (!m_dump_run)
+                {
+                    break;
+                }
+
+                std::string text = dump();
+
+                fprintf(stderr, "SAI RPC statistics:\n%s", text.c_str());
+            }
+        }
+
+        std::mutex m_mutex;
+
+        std::map<std::string, std::unique_ptr<sai_rpc_method_stats_t>> m_methods;
+
+        std::atomic<bool> m_trace;
+
+        std::mutex m_dump_mutex;
+
+        std::condition_variable m_dump_cv;
+
+        std::thread m_dump_thread;
+
+        uint32_t m_dump_interval;
+
+        bool m_dump_run;
+};
+
+/**
+ * @brief Measures single RPC call, records statistics on destruction
+ *
+ * Active timer is kept per thread, so SAI calls made from helper functions
+ * are accounted to the RPC which called them.
+ */
+class sai_rpc_timer
+{
+    public:
+
+        sai_rpc_timer(
+                sai_rpc_method_stats_t *stats):
+            m_stats(stats),
+            m_prev(current()),
+            m_start(std::chrono::steady_clock::now()),
+            m_sai_ns(0),
+            m_failed(false)
+        {
+            current() = this;
+
+            if (sai_rpc_stats::instance().trace())
+            {
+                fprintf(stderr, "SAI RPC: %s(): Called.\n", m_stats->name.c_str());
+            }
+        }
+
+        ~sai_rpc_timer()
+        {
+            uint64_t total = elapsed(m_start);
+
+            uint64_t sai = m_sai_ns < total ? m_sai_ns : total;
+
+            bool failed = m_failed || std::uncaught_exception();
+
+            m_stats->calls.fetch_add(1, std::memory_order_relaxed);
+
+            if (failed)
+            {
+                m_stats->errors.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            m_stats->total.record(total);
+            m_stats->sai.record(sai);
+            m_stats->conversion.record(total - sai);
+
+            current() = m_prev;
+
+            if (sai_rpc_stats::instance().trace())
+            {
+                fprintf(stderr, "SAI RPC: %s(): Exited%s, total %.1f us, sai %.1f us.\n",
+                        m_stats->name.c_str(), failed ? " with error" : "",
+                        (double)total / 1000.0, (double)sai / 1000.0);
+            }
+        }
+
+        void sai_begin()
+        {
+            m_sai_start = std::chrono::steady_clock::now();
+        }
+
+        sai_status_t sai_end(
+                sai_status_t status)
+        {
+            m_sai_ns += elapsed(m_sai_start);
+
+            m_stats->sai_calls.fetch_add(1, std::memory_order_relaxed);
+
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                m_failed = true;
+            }
+
+            return status;
+        }
+
+        static sai_rpc_timer*& current()
+        {
+            static thread_local sai_rpc_timer *timer = nullptr;
+
+            return timer;
+        }
+
+    private:
+
+        static uint64_t elapsed(
+                std::chrono::steady_clock::time_point since)
+        {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+
+            return ns > 0 ? (uint64_t)ns : 0;
+        }
+
+        sai_rpc_method_stats_t *m_stats;
+
+        sai_rpc_timer *m_prev;
+
+        std::chrono::steady_clock::time_point m_start;
+
+        std::chrono::steady_clock::time_point m_sai_start;
+
+        uint64_t m_sai_ns;
+
+        bool m_failed;
+};
+
+/**
+ * @brief Account SAI API call to the RPC being executed on this thread
+ */
+template<typename F>
+static inline sai_status_t sai_rpc_sai_call(
+        F call)
+{
+    sai_rpc_timer *timer = sai_rpc_timer::current();
+
+    if (timer == nullptr)
+    {
+        return call();
+    }
+
+    timer->sai_begin();
+
+    return timer->sai_end(call());
+}
+
+/**
+ * @brief Open statistics scope of RPC method, must be first statement of handler
+ */
+#define SAI_RPC_STATS_SCOPE(name) \
+    static sai_rpc_method_stats_t *sai_rpc_method_stats_ = sai_rpc_stats::instance().method(name); \
+    sai_rpc_timer sai_rpc_timer_(sai_rpc_method_stats_)
+
+/**
+ * @brief Wrap SAI API call, so its time is accounted as SAI time
+ */
+#define SAI_RPC_SAI_CALL(call) sai_rpc_sai_call([&]() { return (call); })
+
+#endif /** __SAI_RPC_STATS_H_ */
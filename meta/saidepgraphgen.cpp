@@ -24,10 +24,15 @@
 
 #include <iostream>
 #include <map>
+#include <queue>
 #include <set>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 extern "C" {
 #include "saimetadata.h"
@@ -36,20 +41,174 @@ extern "C" {
 // node name
 #define NN(x) (sai_metadata_get_enum_value_short_name(&sai_metadata_enum_sai_object_type_t,(x)))
 
+/*
+ * Single dependency: object of type "from" must exist before object of type
+ * "to" can be created (and "to" must be removed before "from"), since "to"
+ * is referencing "from" by attribute or struct member.
+ */
+typedef struct _edge_t
+{
+    sai_object_type_t from;
+
+    sai_object_type_t to;
+
+    // NULL when dependency comes from non object id struct member
+    const sai_attr_metadata_t* md;
+
+    // NULL when dependency comes from attribute
+    const sai_struct_member_info_t* sm;
+
+    // dot edge attributes
+    std::string style;
+
+} edge_t;
+
+#define KIND_MANDATORY      (1 << 0)
+#define KIND_CREATE_ONLY    (1 << 1)
+#define KIND_CREATE_AND_SET (1 << 2)
+#define KIND_READ_ONLY      (1 << 3)
+#define KIND_KEY            (1 << 4)
+#define KIND_LIST           (1 << 5)
+#define KIND_STRUCT         (1 << 6)
+
+typedef struct _kind_name_t
+{
+    const char* name;
+
+    int kind;
+
+} kind_name_t;
+
+static const kind_name_t kind_names[] = {
+    { "mandatory",      KIND_MANDATORY },
+    { "create_only",    KIND_CREATE_ONLY },
+    { "create_and_set", KIND_CREATE_AND_SET },
+    { "read_only",      KIND_READ_ONLY },
+    { "key",            KIND_KEY },
+    { "list",           KIND_LIST },
+    { "struct",         KIND_STRUCT },
+};
+
 static std::set<sai_object_type_t> source;
 static std::set<sai_object_type_t> target;
 
+static std::vector<edge_t> edges;
+
+// object types selected by root and depth, all when empty
+static std::set<sai_object_type_t> selected;
+
 static bool show_switch_links = false;
 static bool show_read_only_links = false;
 static bool show_extensions = false;
 
+static bool reverse = false;
+static bool json = false;
+static int depth = -1;
+static int kinds = 0;
+static sai_object_type_t root = SAI_OBJECT_TYPE_NULL;
+
+static int get_kind(
+        _In_ const sai_attr_metadata_t* md,
+        _In_ const sai_struct_member_info_t* sm)
+{
+    if (md == NULL)
+    {
+        return KIND_STRUCT;
+    }
+
+    int kind = 0;
+
+    if (SAI_HAS_FLAG_MANDATORY_ON_CREATE(md->flags))
+    {
+        kind |= KIND_MANDATORY;
+    }
+
+    if (SAI_HAS_FLAG_CREATE_ONLY(md->flags))
+    {
+        kind |= KIND_CREATE_ONLY;
+    }
+
+    if (SAI_HAS_FLAG_CREATE_AND_SET(md->flags))
+    {
+        kind |= KIND_CREATE_AND_SET;
+    }
+
+    if (SAI_HAS_FLAG_READ_ONLY(md->flags))
+    {
+        kind |= KIND_READ_ONLY;
+    }
+
+    if (SAI_HAS_FLAG_KEY(md->flags))
+    {
+        kind |= KIND_KEY;
+    }
+
+    switch (md->attrvaluetype)
+    {
+        case SAI_ATTR_VALUE_TYPE_OBJECT_LIST:
+        case SAI_ATTR_VALUE_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
+        case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+            kind |= KIND_LIST;
+            break;
+
+        default:
+            break;
+    }
+
+    return kind;
+}
+
+static bool is_link_shown(
+        _In_ sai_object_type_t from,
+        _In_ sai_object_type_t to,
+        _In_ const sai_attr_metadata_t* md,
+        _In_ const sai_struct_member_info_t* sm)
+{
+    if (md == NULL)
+    {
+        if (to >= SAI_OBJECT_TYPE_MAX && !show_extensions)
+        {
+            return false;
+        }
+
+        if (from == SAI_OBJECT_TYPE_SWITCH && !show_switch_links)
+        {
+            // skip switch dependency since switch
+            // is used everywhere and will pollute graph
+            return false;
+        }
+    }
+    else if (SAI_HAS_FLAG_READ_ONLY(md->flags) && !show_read_only_links)
+    {
+        // skip attributes that are read only
+        return false;
+    }
+
+    return kinds == 0 || (get_kind(md, sm) & kinds) != 0;
+}
+
+static void add_edge(
+        _In_ sai_object_type_t from,
+        _In_ sai_object_type_t to,
+        _In_ const sai_attr_metadata_t* md,
+        _In_ const sai_struct_member_info_t* sm,
+        _In_ const std::string& style)
+{
+    edge_t edge;
+
+    edge.from = from;
+    edge.to = to;
+    edge.md = md;
+    edge.sm = sm;
+    edge.style = style;
+
+    edges.push_back(edge);
+}
+
 static void process_object_type_attributes(
         _In_ const sai_attr_metadata_t* const* const meta_attr_list,
         _In_ sai_object_type_t current_object_type)
 {
-    std::set<sai_object_type_t> otset;
-    std::set<sai_object_type_t> rotset;
-
     for (int i = 0; meta_attr_list[i] != NULL; ++i)
     {
         const sai_attr_metadata_t* meta = meta_attr_list[i];
@@ -60,31 +219,14 @@ static void process_object_type_attributes(
             continue;
         }
 
-        bool ro = SAI_HAS_FLAG_READ_ONLY(meta->flags);
-
-        if (ro && !show_read_only_links)
-        {
-            // skip attributes that are read only
-            continue;
-        }
-
         std::string style;
 
-        switch (meta->attrvaluetype)
+        if (get_kind(meta, NULL) & KIND_LIST)
         {
-            case SAI_ATTR_VALUE_TYPE_OBJECT_LIST:
-            case SAI_ATTR_VALUE_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
-            case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
-
-                // we can miss some objects if same object can be set
-                // as list in one attribute and as single object in
-                // another attribute
-                style = "style=bold";
-
-                break;
-
-            default:
-                break;
+            // we can miss some objects if same object can be set
+            // as list in one attribute and as single object in
+            // another attribute
+            style = "style=bold";
         }
 
         // this attribute supports objects
@@ -95,48 +237,196 @@ static void process_object_type_attributes(
             style += " samehead=" + std::string(meta->attridname);
         }
 
+        if (SAI_HAS_FLAG_READ_ONLY(meta->flags))
+        {
+            style = "[ " + style + " color=\"red\" ]";
+        }
+        else
+        {
+            style = "[ " + style + " color=\"0.650 0.700 0.700\"]";
+        }
+
         for (uint32_t j = 0; j < meta->allowedobjecttypeslength; j++)
         {
             sai_object_type_t ot = meta->allowedobjecttypes[j];
 
-            if (otset.find(ot) != otset.end())
+            if (is_link_shown(ot, current_object_type, meta, NULL))
             {
-                // node was already defined
-                continue;
+                add_edge(ot, current_object_type, meta, NULL, style);
             }
+        }
+    }
+}
 
-            const char* current = NN(current_object_type);
-            const char* dep = NN(ot);
+static void process_object_types()
+{
+    for (int idx = 1; sai_metadata_all_object_type_infos[idx]; ++idx)
+    {
+        const sai_attr_metadata_t* const* const meta = sai_metadata_all_object_type_infos[idx]->attrmetadata;
+
+        process_object_type_attributes(meta, sai_metadata_all_object_type_infos[idx]->objecttype);
+    }
+}
+
+static void process_nonobjectid_connections()
+{
+    const char* c = "[color=\"0.650 0.700 0.700\", style = dashed, penwidth=2]";
 
-            if (ro)
+    for (size_t idx = 1 ; sai_metadata_all_object_type_infos[idx]; ++idx)
+    {
+        const sai_object_type_info_t* oi =  sai_metadata_all_object_type_infos[idx];
+
+        if (!oi->isnonobjectid)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < oi->structmemberscount; ++j)
+        {
+            const sai_struct_member_info_t* sm = oi->structmembers[j];
+
+            if (sm->membervaluetype == SAI_ATTR_VALUE_TYPE_OBJECT_ID)
             {
-                if (rotset.find(ot) != rotset.end())
+                for (size_t k = 0; k < sm->allowedobjecttypeslength; ++k)
                 {
-                    continue;
-                }
+                    sai_object_type_t ot = sm->allowedobjecttypes[k];
 
-                rotset.insert(ot);
-                std::cout << dep << " -> " << current << " [ " << style << " color=\"red\" ];\n";
-                continue;
+                    if (is_link_shown(ot, oi->objecttype, NULL, sm))
+                    {
+                        add_edge(ot, oi->objecttype, NULL, sm, c);
+                    }
+                }
+            }
+            else if (sm->isvlan && is_link_shown(SAI_OBJECT_TYPE_VLAN, oi->objecttype, NULL, sm))
+            {
+                add_edge(SAI_OBJECT_TYPE_VLAN, oi->objecttype, NULL, sm, c);
             }
+        }
+    }
+}
 
-            std::cout << dep << " -> " << current << " [ " << style << " color=\"0.650 0.700 0.700\"];\n";
+static bool is_selected(
+        _In_ sai_object_type_t ot)
+{
+    return selected.empty() || selected.find(ot) != selected.end();
+}
+
+/*
+ * Breadth first walk from root up to given depth. Forward walk follows
+ * dependencies of the root (objects it references), reverse walk uses
+ * reverse graph members to follow objects that reference the root.
+ */
+static void select_object_types()
+{
+    if (root == SAI_OBJECT_TYPE_NULL)
+    {
+        return;
+    }
+
+    std::map<sai_object_type_t, std::vector<sai_object_type_t> > deps;
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        deps[edges[i].to].push_back(edges[i].from);
+    }
 
-            otset.insert(ot);
+    std::queue<std::pair<sai_object_type_t, int> > queue;
 
-            source.insert(ot);
-            target.insert(current_object_type);
+    selected.insert(root);
+    queue.push(std::make_pair(root, 0));
+
+    while (!queue.empty())
+    {
+        sai_object_type_t ot = queue.front().first;
+        int level = queue.front().second;
+
+        queue.pop();
+
+        if (depth >= 0 && level >= depth)
+        {
+            continue;
+        }
+
+        std::vector<sai_object_type_t> next;
+
+        if (reverse)
+        {
+            const sai_object_type_info_t* info = sai_metadata_get_object_type_info(ot);
+
+            for (size_t i = 0; info && i < info->revgraphmemberscount; ++i)
+            {
+                const sai_rev_graph_member_t* rm = info->revgraphmembers[i];
+
+                if (is_link_shown(rm->objecttype, rm->depobjecttype, rm->attrmetadata, rm->structmember))
+                {
+                    next.push_back(rm->depobjecttype);
+                }
+            }
+        }
+        else
+        {
+            next = deps[ot];
+        }
+
+        for (size_t i = 0; i < next.size(); ++i)
+        {
+            if (selected.find(next[i]) != selected.end())
+            {
+                continue;
+            }
+
+            selected.insert(next[i]);
+            queue.push(std::make_pair(next[i], level + 1));
         }
     }
 }
 
-static void process_object_types()
+static void print_edges()
 {
-    for (int idx = 1; sai_metadata_all_object_type_infos[idx]; ++idx)
+    std::set<std::pair<sai_object_type_t, sai_object_type_t> > printed;
+    std::set<std::pair<sai_object_type_t, sai_object_type_t> > roprinted;
+
+    for (size_t i = 0; i < edges.size(); ++i)
     {
-        const sai_attr_metadata_t* const* const meta = sai_metadata_all_object_type_infos[idx]->attrmetadata;
+        const edge_t& e = edges[i];
 
-        process_object_type_attributes(meta, sai_metadata_all_object_type_infos[idx]->objecttype);
+        if (!is_selected(e.from) || !is_selected(e.to))
+        {
+            continue;
+        }
+
+        std::pair<sai_object_type_t, sai_object_type_t> link = std::make_pair(e.to, e.from);
+
+        if (e.md && printed.find(link) != printed.end())
+        {
+            // node was already defined
+            continue;
+        }
+
+        if (e.md && SAI_HAS_FLAG_READ_ONLY(e.md->flags))
+        {
+            if (roprinted.find(link) != roprinted.end())
+            {
+                continue;
+            }
+
+            roprinted.insert(link);
+        }
+        else if (e.md)
+        {
+            printed.insert(link);
+
+            source.insert(e.from);
+            target.insert(e.to);
+        }
+
+        std::cout << NN(e.from) << " -> " << NN(e.to) << " " << e.style << ";\n";
+    }
+
+    if (is_selected(SAI_OBJECT_TYPE_SWITCH) && is_selected(SAI_OBJECT_TYPE_PORT))
+    {
+        std::cout << NN(SAI_OBJECT_TYPE_SWITCH) << " -> " << NN(SAI_OBJECT_TYPE_PORT)
+            << " [dir=\"none\", color=\"red\", peripheries = 2, penwidth=2.0 , style  = dashed ];\n";
     }
 }
 
@@ -146,6 +436,11 @@ static void process_colors()
     {
         sai_object_type_t ot = sai_metadata_all_object_type_infos[idx]->objecttype;
 
+        if (!is_selected(ot))
+        {
+            continue;
+        }
+
         bool is_source = source.find(ot) != source.end();
         bool is_target = target.find(ot) != target.end();
 
@@ -180,7 +475,7 @@ static void process_colors()
     {
         const sai_object_type_info_t* oi =  sai_metadata_all_object_type_infos[idx];
 
-        if (!oi->isnonobjectid)
+        if (!oi->isnonobjectid || !is_selected(oi->objecttype))
         {
             continue;
         }
@@ -192,20 +487,80 @@ static void process_colors()
 
         std::cout << NN(oi->objecttype) << " [color=plum, shape = rect];\n";
     }
+
+    if (is_selected(SAI_OBJECT_TYPE_SWITCH))
+    {
+        std::cout << NN(SAI_OBJECT_TYPE_SWITCH) << " [color=orange, shape = parallelogram, peripheries = 2];\n";
+    }
+
+    if (is_selected(SAI_OBJECT_TYPE_PORT))
+    {
+        std::cout << NN(SAI_OBJECT_TYPE_PORT) << " [color=gold, shape = diamond, peripheries=2];\n";
+    }
 }
 
-#define PRINT_NN(x,y,c)\
-    std::cout << NN(SAI_OBJECT_TYPE_ ## x) << " -> " << NN(SAI_OBJECT_TYPE_ ## y) << c;
+static void print_dot()
+{
+    std::cout << "digraph \"SAI Object Dependency Graph\" {\n";
+    std::cout << "size=\"30,12\"; ratio = fill;\n";
+    std::cout << "node [style=filled];\n";
 
-static void process_nonobjectid_connections()
+    print_edges();
+
+    process_colors();
+
+    std::cout << "}\n";
+}
+
+static std::string json_kinds(
+        _In_ int kind)
 {
-    const char* c = " [color=\"0.650 0.700 0.700\", style = dashed, penwidth=2];\n";
+    std::string list;
 
-    for (size_t idx = 1 ; sai_metadata_all_object_type_infos[idx]; ++idx)
+    for (size_t i = 0; i < sizeof(kind_names)/sizeof(kind_names[0]); ++i)
     {
-        const sai_object_type_info_t* oi =  sai_metadata_all_object_type_infos[idx];
+        if ((kind & kind_names[i].kind) == 0)
+        {
+            continue;
+        }
 
-        if (!oi->isnonobjectid)
+        list += (list.empty() ? "\"" : ", \"") + std::string(kind_names[i].name) + "\"";
+    }
+
+    return "[" + list + "]";
+}
+
+/*
+ * Adjacency list in JSON format. Each node lists object types it depends on
+ * (must be created before it), and each dependency names attribute or struct
+ * member introducing it, so creation and removal order can be computed
+ * without parsing dot output.
+ */
+static void print_json()
+{
+    std::map<sai_object_type_t, std::vector<size_t> > deps;
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (is_selected(edges[i].from) && is_selected(edges[i].to))
+        {
+            deps[edges[i].to].push_back(i);
+        }
+    }
+
+    std::cout << "{\n";
+    std::cout << "  \"root\": " << (root == SAI_OBJECT_TYPE_NULL ? "null" : "\"" + std::string(NN(root)) + "\"") << ",\n";
+    std::cout << "  \"reverse\": " << (reverse ? "true" : "false") << ",\n";
+    std::cout << "  \"depth\": " << depth << ",\n";
+    std::cout << "  \"nodes\": [";
+
+    bool first = true;
+
+    for (size_t idx = 1; sai_metadata_all_object_type_infos[idx]; ++idx)
+    {
+        const sai_object_type_info_t* oi = sai_metadata_all_object_type_infos[idx];
+
+        if (!is_selected(oi->objecttype))
         {
             continue;
         }
@@ -215,58 +570,164 @@ static void process_nonobjectid_connections()
             continue;
         }
 
-        for (size_t j = 0; j < oi->structmemberscount; ++j)
+        std::cout << (first ? "\n" : ",\n");
+
+        first = false;
+
+        std::cout << "    {\n";
+        std::cout << "      \"name\": \"" << NN(oi->objecttype) << "\",\n";
+        std::cout << "      \"objecttype\": \"" << oi->objecttypename << "\",\n";
+        std::cout << "      \"isnonobjectid\": " << (oi->isnonobjectid ? "true" : "false") << ",\n";
+        std::cout << "      \"dependencies\": [";
+
+        const std::vector<size_t>& list = deps[oi->objecttype];
+
+        for (size_t i = 0; i < list.size(); ++i)
         {
-            const sai_struct_member_info_t* sm = oi->structmembers[j];
+            const edge_t& e = edges[list[i]];
 
-            if (sm->membervaluetype == SAI_ATTR_VALUE_TYPE_OBJECT_ID)
+            std::cout << (i ? ",\n" : "\n");
+            std::cout << "        { \"objecttype\": \"" << NN(e.from) << "\", ";
+
+            if (e.md)
             {
-                for (size_t k = 0; k < sm->allowedobjecttypeslength; ++k)
-                {
-                    sai_object_type_t ot = sm->allowedobjecttypes[k];
+                std::cout << "\"attribute\": \"" << e.md->attridname << "\", ";
+            }
+            else
+            {
+                std::cout << "\"member\": \"" << e.sm->membername << "\", ";
+            }
 
-                    if (ot == SAI_OBJECT_TYPE_SWITCH && !show_switch_links)
-                    {
-                        // skip switch dependency since switch
-                        // is used everywhere and will pollute graph
-                        continue;
-                    }
+            std::cout << "\"kinds\": " << json_kinds(get_kind(e.md, e.sm)) << " }";
+        }
 
-                    std::cout << NN(ot) << " -> " << NN(oi->objecttype) << c;
-                }
-            }
-            else if (sm->isvlan)
+        std::cout << (list.empty() ? "]\n" : "\n      ]\n");
+        std::cout << "    }";
+    }
+
+    std::cout << "\n  ]\n";
+    std::cout << "}\n";
+}
+
+static sai_object_type_t parse_object_type(
+        _In_ const char* name)
+{
+    const sai_enum_metadata_t* em = &sai_metadata_enum_sai_object_type_t;
+
+    for (size_t i = 0; i < em->valuescount; ++i)
+    {
+        if (strcmp(name, em->valuesnames[i]) == 0 || strcmp(name, em->valuesshortnames[i]) == 0)
+        {
+            return (sai_object_type_t)em->values[i];
+        }
+    }
+
+    std::cerr << "unknown object type: " << name << "\n";
+
+    exit(EXIT_FAILURE);
+}
+
+static int parse_kinds(
+        _In_ const char* list)
+{
+    int result = 0;
+
+    std::stringstream ss(list);
+    std::string name;
+
+    while (std::getline(ss, name, ','))
+    {
+        size_t i = 0;
+
+        for (; i < sizeof(kind_names)/sizeof(kind_names[0]); ++i)
+        {
+            if (name == kind_names[i].name)
             {
-                std::cout << NN(SAI_OBJECT_TYPE_VLAN) << " -> " << NN(oi->objecttype) << c;
+                break;
             }
         }
+
+        if (i == sizeof(kind_names)/sizeof(kind_names[0]))
+        {
+            std::cerr << "unknown attribute kind: " << name << "\n";
+
+            exit(EXIT_FAILURE);
+        }
+
+        result |= kind_names[i].kind;
     }
 
-    PRINT_NN(SWITCH, PORT, "[dir=\"none\", color=\"red\", peripheries = 2, penwidth=2.0 , style  = dashed ];\n");
+    return result;
+}
+
+static void usage(
+        _In_ const char* name)
+{
+    std::cerr << "usage: " << name << " [-s] [-r] [-e] [-t object_type [-d depth] [-R]] [-k kinds] [-j]\n\n";
+    std::cerr << "    -s    show switch links\n";
+    std::cerr << "    -r    show read only links\n";
+    std::cerr << "    -e    show extensions\n";
+    std::cerr << "    -t    only show object types reachable from given object type (PORT or SAI_OBJECT_TYPE_PORT)\n";
+    std::cerr << "    -d    limit -t walk to given depth\n";
+    std::cerr << "    -R    walk objects which are using -t object type instead of its dependencies\n";
+    std::cerr << "    -k    only show links of given attribute kinds, comma separated list of:\n";
+    std::cerr << "          mandatory, create_only, create_and_set, read_only, key, list, struct\n";
+    std::cerr << "    -j    print JSON adjacency list instead of dot graph\n";
 }
 
 int main(int argc, char** argv)
 {
-    for (int i = 1; i < argc; ++i)
+    int opt;
+
+    while ((opt = getopt(argc, argv, "sret:d:Rk:jh")) != -1)
     {
-        show_switch_links       |= strcmp(argv[i], "-s") == 0;
-        show_read_only_links    |= strcmp(argv[i], "-r") == 0;
-        show_extensions         |= strcmp(argv[i], "-e") == 0;
+        switch (opt)
+        {
+            case 's': show_switch_links = true; break;
+            case 'r': show_read_only_links = true; break;
+            case 'e': show_extensions = true; break;
+            case 't': root = parse_object_type(optarg); break;
+            case 'd': depth = atoi(optarg); break;
+            case 'R': reverse = true; break;
+            case 'k': kinds = parse_kinds(optarg); break;
+            case 'j': json = true; break;
+
+            case 'h':
+                usage(argv[0]);
+                return EXIT_SUCCESS;
+
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
     }
 
-    std::cout << "digraph \"SAI Object Dependency Graph\" {\n";
-    std::cout << "size=\"30,12\"; ratio = fill;\n";
-    std::cout << "node [style=filled];\n";
+    if (kinds & KIND_READ_ONLY)
+    {
+        show_read_only_links = true;
+    }
+
+    if ((depth >= 0 || reverse) && root == SAI_OBJECT_TYPE_NULL)
+    {
+        std::cerr << "-d and -R require -t\n";
+
+        return EXIT_FAILURE;
+    }
 
     process_object_types();
 
     process_nonobjectid_connections();
 
-    process_colors();
+    select_object_types();
 
-    std::cout << NN(SAI_OBJECT_TYPE_SWITCH) << " [color=orange, shape = parallelogram, peripheries = 2];\n";
-    std::cout << NN(SAI_OBJECT_TYPE_PORT) << " [color=gold, shape = diamond, peripheries=2];\n";
+    if (json)
+    {
+        print_json();
+    }
+    else
+    {
+        print_dot();
+    }
 
-    std::cout << "}\n";
     return 0;
 }
@@ -23,6 +23,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <string.h>
 #include <sai.h>
 #include "saimetadatautils.h"
@@ -610,6 +612,726 @@ bool sai_metadata_is_validonly_met(
     return false;
 }
 
+static size_t sai_metadata_get_object_type_info_index(
+        _In_ sai_object_type_t object_type)
+{
+    if (object_type > SAI_OBJECT_TYPE_NULL && object_type < SAI_OBJECT_TYPE_MAX)
+    {
+        return (size_t)object_type;
+    }
+
+    size_t idx = SAI_OBJECT_TYPE_MAX;
+
+    for (; sai_metadata_all_object_type_infos[idx]; idx++)
+    {
+        if (sai_metadata_all_object_type_infos[idx]->objecttype == object_type)
+        {
+            return idx;
+        }
+    }
+
+    return 0;
+}
+
+#define SAI_METADATA_LAYER_NONE ((uint32_t)-1)
+
+#define SAI_METADATA_DEP_NONE   0
+#define SAI_METADATA_DEP_HARD   1
+#define SAI_METADATA_DEP_SOFT   2
+
+/*
+ * Soft dependency comes from attribute which can be set after create, so it
+ * can be dropped to break object types loop.
+ */
+static int sai_metadata_get_rev_graph_member_dep(
+        _In_ const sai_rev_graph_member_t* rm)
+{
+    const sai_attr_metadata_t* md = rm->attrmetadata;
+
+    if (md == NULL)
+    {
+        return SAI_METADATA_DEP_HARD;
+    }
+
+    if (SAI_HAS_FLAG_READ_ONLY(md->flags))
+    {
+        return SAI_METADATA_DEP_NONE;
+    }
+
+    if (SAI_HAS_FLAG_CREATE_AND_SET(md->flags) && !SAI_HAS_FLAG_MANDATORY_ON_CREATE(md->flags))
+    {
+        return SAI_METADATA_DEP_SOFT;
+    }
+
+    return SAI_METADATA_DEP_HARD;
+}
+
+typedef struct _sai_metadata_scc_t
+{
+    uint32_t* index;
+
+    uint32_t* lowlink;
+
+    uint32_t* stack;
+
+    bool* onstack;
+
+    uint32_t* component;
+
+    uint32_t counter;
+
+    uint32_t depth;
+
+} sai_metadata_scc_t;
+
+/*
+ * Tarjan's strongly connected components, object types in the same
+ * component form a loop.
+ */
+static void sai_metadata_scc_visit(
+        _Inout_ sai_metadata_scc_t* scc,
+        _In_ size_t idx)
+{
+    scc->index[idx] = scc->lowlink[idx] = ++scc->counter;
+    scc->stack[scc->depth++] = (uint32_t)idx;
+    scc->onstack[idx] = true;
+
+    const sai_object_type_info_t* info = sai_metadata_all_object_type_infos[idx];
+
+    size_t i = 0;
+
+    for (; i < info->revgraphmemberscount; i++)
+    {
+        const sai_rev_graph_member_t* rm = info->revgraphmembers[i];
+
+        size_t dep = sai_metadata_get_object_type_info_index(rm->depobjecttype);
+
+        if (dep == 0 || sai_metadata_get_rev_graph_member_dep(rm) == SAI_METADATA_DEP_NONE)
+        {
+            continue;
+        }
+
+        if (scc->index[dep] == 0)
+        {
+            sai_metadata_scc_visit(scc, dep);
+
+            if (scc->lowlink[dep] < scc->lowlink[idx])
+            {
+                scc->lowlink[idx] = scc->lowlink[dep];
+            }
+        }
+        else if (scc->onstack[dep] && scc->index[dep] < scc->lowlink[idx])
+        {
+            scc->lowlink[idx] = scc->index[dep];
+        }
+    }
+
+    if (scc->lowlink[idx] != scc->index[idx])
+    {
+        return;
+    }
+
+    uint32_t member;
+
+    do
+    {
+        member = scc->stack[--scc->depth];
+
+        scc->onstack[member] = false;
+        scc->component[member] = (uint32_t)idx;
+    }
+    while (member != idx);
+}
+
+/*
+ * Mark object types which still depend on some object type without assigned
+ * layer. Soft dependencies inside loop are ignored.
+ */
+static void sai_metadata_mark_blocked_object_types(
+        _In_ const uint32_t *layers,
+        _In_ const uint32_t *component,
+        _Inout_ bool *blocked,
+        _In_ size_t count)
+{
+    size_t idx = 1;
+
+    memset(blocked, 0, count * sizeof(bool));
+
+    for (; idx < count; idx++)
+    {
+        if (layers[idx] != SAI_METADATA_LAYER_NONE)
+        {
+            continue;
+        }
+
+        const sai_object_type_info_t* info = sai_metadata_all_object_type_infos[idx];
+
+        size_t i = 0;
+
+        for (; i < info->revgraphmemberscount; i++)
+        {
+            const sai_rev_graph_member_t* rm = info->revgraphmembers[i];
+
+            size_t dep = sai_metadata_get_object_type_info_index(rm->depobjecttype);
+
+            if (dep == 0 || dep == idx)
+            {
+                continue;
+            }
+
+            switch (sai_metadata_get_rev_graph_member_dep(rm))
+            {
+                case SAI_METADATA_DEP_HARD:
+                    blocked[dep] = true;
+                    break;
+
+                case SAI_METADATA_DEP_SOFT:
+                    blocked[dep] |= component[dep] != component[idx];
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+sai_status_t sai_metadata_get_object_type_layers(
+        _Inout_ uint32_t *count,
+        _Out_ sai_object_type_t *object_types,
+        _Out_ uint32_t *layers)
+{
+    if (count == NULL)
+    {
+        SAI_META_LOG_ERROR("count is NULL");
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    size_t infos = 1;
+
+    while (sai_metadata_all_object_type_infos[infos])
+    {
+        infos++;
+    }
+
+    if (*count < infos - 1 || object_types == NULL || layers == NULL)
+    {
+        *count = (uint32_t)(infos - 1);
+        return SAI_STATUS_BUFFER_OVERFLOW;
+    }
+
+    sai_metadata_scc_t scc;
+
+    scc.index = calloc(infos, sizeof(uint32_t));
+    scc.lowlink = calloc(infos, sizeof(uint32_t));
+    scc.stack = calloc(infos, sizeof(uint32_t));
+    scc.onstack = calloc(infos, sizeof(bool));
+    scc.component = calloc(infos, sizeof(uint32_t));
+    scc.counter = 0;
+    scc.depth = 0;
+
+    uint32_t* otlayers = malloc(infos * sizeof(uint32_t));
+    bool* blocked = malloc(infos * sizeof(bool));
+
+    sai_status_t status = SAI_STATUS_NO_MEMORY;
+
+    if (scc.index && scc.lowlink && scc.stack && scc.onstack && scc.component && otlayers && blocked)
+    {
+        size_t idx = 1;
+
+        for (; idx < infos; idx++)
+        {
+            if (scc.index[idx] == 0)
+            {
+                sai_metadata_scc_visit(&scc, idx);
+            }
+
+            otlayers[idx] = SAI_METADATA_LAYER_NONE;
+        }
+
+        status = SAI_STATUS_SUCCESS;
+
+        uint32_t layer = 0;
+        size_t assigned = 0;
+
+        for (; assigned < infos - 1; layer++)
+        {
+            sai_metadata_mark_blocked_object_types(otlayers, scc.component, blocked, infos);
+
+            size_t ready = 0;
+
+            for (idx = 1; idx < infos; idx++)
+            {
+                if (otlayers[idx] == SAI_METADATA_LAYER_NONE && !blocked[idx])
+                {
+                    otlayers[idx] = layer;
+                    ready++;
+                }
+            }
+
+            if (ready == 0)
+            {
+                SAI_META_LOG_ERROR("object types can't be layered, loop on mandatory or create only attributes");
+
+                status = SAI_STATUS_FAILURE;
+                break;
+            }
+
+            assigned += ready;
+        }
+
+        uint32_t i = 0;
+        uint32_t l = 0;
+
+        for (; status == SAI_STATUS_SUCCESS && l < layer; l++)
+        {
+            for (idx = 1; idx < infos; idx++)
+            {
+                if (otlayers[idx] == l)
+                {
+                    object_types[i] = sai_metadata_all_object_type_infos[idx]->objecttype;
+                    layers[i] = l;
+                    i++;
+                }
+            }
+        }
+
+        if (status == SAI_STATUS_SUCCESS)
+        {
+            *count = i;
+        }
+    }
+
+    free(scc.index);
+    free(scc.lowlink);
+    free(scc.stack);
+    free(scc.onstack);
+    free(scc.component);
+    free(otlayers);
+    free(blocked);
+
+    return status;
+}
+
+typedef struct _sai_metadata_oid_index_t
+{
+    sai_object_id_t oid;
+
+    uint32_t index;
+
+} sai_metadata_oid_index_t;
+
+typedef struct _sai_metadata_deps_t
+{
+    const sai_metadata_oid_index_t* oids;
+
+    uint32_t oids_count;
+
+    uint32_t count;
+
+    uint32_t capacity;
+
+    /* object "to" references object "from" */
+
+    uint32_t* from;
+
+    uint32_t* to;
+
+} sai_metadata_deps_t;
+
+static int sai_metadata_oid_index_cmp(
+        _In_ const void* a,
+        _In_ const void* b)
+{
+    const sai_metadata_oid_index_t* ia = (const sai_metadata_oid_index_t*)a;
+    const sai_metadata_oid_index_t* ib = (const sai_metadata_oid_index_t*)b;
+
+    if (ia->oid < ib->oid)
+    {
+        return -1;
+    }
+
+    if (ia->oid > ib->oid)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+static sai_status_t sai_metadata_add_dep(
+        _Inout_ sai_metadata_deps_t* deps,
+        _In_ sai_object_id_t oid,
+        _In_ uint32_t to)
+{
+    if (oid == SAI_NULL_OBJECT_ID)
+    {
+        return SAI_STATUS_SUCCESS;
+    }
+
+    sai_metadata_oid_index_t key;
+
+    key.oid = oid;
+    key.index = 0;
+
+    const sai_metadata_oid_index_t* found = bsearch(&key, deps->oids, deps->oids_count,
+            sizeof(sai_metadata_oid_index_t), sai_metadata_oid_index_cmp);
+
+    if (found == NULL || found->index == to)
+    {
+        /* object is outside of set, or object is referencing itself */
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    if (deps->count == deps->capacity)
+    {
+        uint32_t capacity = deps->capacity ? 2 * deps->capacity : 64;
+
+        uint32_t* from_list = realloc(deps->from, capacity * sizeof(uint32_t));
+
+        if (from_list == NULL)
+        {
+            return SAI_STATUS_NO_MEMORY;
+        }
+
+        deps->from = from_list;
+
+        uint32_t* to_list = realloc(deps->to, capacity * sizeof(uint32_t));
+
+        if (to_list == NULL)
+        {
+            return SAI_STATUS_NO_MEMORY;
+        }
+
+        deps->to = to_list;
+        deps->capacity = capacity;
+    }
+
+    deps->from[deps->count] = found->index;
+    deps->to[deps->count] = to;
+    deps->count++;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t sai_metadata_add_list_deps(
+        _Inout_ sai_metadata_deps_t* deps,
+        _In_ const sai_object_list_t* list,
+        _In_ uint32_t to)
+{
+    uint32_t i = 0;
+
+    for (; list->list != NULL && i < list->count; i++)
+    {
+        sai_status_t status = sai_metadata_add_dep(deps, list->list[i], to);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t sai_metadata_add_object_deps(
+        _Inout_ sai_metadata_deps_t* deps,
+        _In_ const sai_object_meta_key_t* meta_key,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t* attr_list,
+        _In_ uint32_t to)
+{
+    const sai_object_type_info_t* info = sai_metadata_get_object_type_info(meta_key->objecttype);
+
+    if (info == NULL)
+    {
+        SAI_META_LOG_ERROR("invalid object type %d", meta_key->objecttype);
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    size_t j = 0;
+
+    for (; info->isnonobjectid && j < info->structmemberscount; j++)
+    {
+        const sai_struct_member_info_t* sm = info->structmembers[j];
+
+        if (sm->membervaluetype == SAI_ATTR_VALUE_TYPE_OBJECT_ID && sm->getoid != NULL)
+        {
+            status = sai_metadata_add_dep(deps, sm->getoid(meta_key), to);
+
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                return status;
+            }
+        }
+    }
+
+    uint32_t i = 0;
+
+    for (; attr_list != NULL && i < attr_count; i++)
+    {
+        const sai_attr_metadata_t* md = sai_metadata_get_attr_metadata(meta_key->objecttype, attr_list[i].id);
+
+        if (md == NULL || md->allowedobjecttypeslength == 0)
+        {
+            continue;
+        }
+
+        const sai_attribute_value_t* value = &attr_list[i].value;
+
+        switch (md->attrvaluetype)
+        {
+            case SAI_ATTR_VALUE_TYPE_OBJECT_ID:
+                status = sai_metadata_add_dep(deps, value->oid, to);
+                break;
+
+            case SAI_ATTR_VALUE_TYPE_OBJECT_LIST:
+                status = sai_metadata_add_list_deps(deps, &value->objlist, to);
+                break;
+
+            case SAI_ATTR_VALUE_TYPE_ACL_FIELD_DATA_OBJECT_ID:
+                status = value->aclfield.enable ? sai_metadata_add_dep(deps, value->aclfield.data.oid, to) : SAI_STATUS_SUCCESS;
+                break;
+
+            case SAI_ATTR_VALUE_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
+                status = value->aclfield.enable ? sai_metadata_add_list_deps(deps, &value->aclfield.data.objlist, to) : SAI_STATUS_SUCCESS;
+                break;
+
+            case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_ID:
+                status = value->aclaction.enable ? sai_metadata_add_dep(deps, value->aclaction.parameter.oid, to) : SAI_STATUS_SUCCESS;
+                break;
+
+            case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+                status = value->aclaction.enable ? sai_metadata_add_list_deps(deps, &value->aclaction.parameter.objlist, to) : SAI_STATUS_SUCCESS;
+                break;
+
+            default:
+                break;
+        }
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/*
+ * Longest path layering (Kahn's algorithm), so each object is placed in
+ * first wave after all objects it references.
+ */
+static sai_status_t sai_metadata_layer_objects(
+        _In_ uint32_t object_count,
+        _In_ const sai_metadata_deps_t* deps,
+        _Out_ uint32_t *wave_list,
+        _Out_ uint32_t *wave_count)
+{
+    uint32_t* indegree = calloc((size_t)object_count + 1, sizeof(uint32_t));
+    uint32_t* offsets = calloc((size_t)object_count + 1, sizeof(uint32_t));
+    uint32_t* edges = malloc(((size_t)deps->count + 1) * sizeof(uint32_t));
+    uint32_t* queue = malloc(((size_t)object_count + 1) * sizeof(uint32_t));
+
+    sai_status_t status = SAI_STATUS_NO_MEMORY;
+
+    if (indegree != NULL && offsets != NULL && edges != NULL && queue != NULL)
+    {
+        uint32_t i = 0;
+
+        for (i = 0; i < deps->count; i++)
+        {
+            indegree[deps->to[i]]++;
+            offsets[deps->from[i] + 1]++;
+        }
+
+        for (i = 0; i < object_count; i++)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+
+        for (i = 0; i < deps->count; i++)
+        {
+            edges[offsets[deps->from[i]]++] = deps->to[i];
+        }
+
+        /* filling moved each offset to the end of its range */
+
+        for (i = object_count; i > 0; i--)
+        {
+            offsets[i] = offsets[i - 1];
+        }
+
+        offsets[0] = 0;
+
+        uint32_t head = 0;
+        uint32_t tail = 0;
+
+        for (i = 0; i < object_count; i++)
+        {
+            wave_list[i] = 0;
+
+            if (indegree[i] == 0)
+            {
+                queue[tail++] = i;
+            }
+        }
+
+        *wave_count = object_count ? 1 : 0;
+
+        while (head < tail)
+        {
+            uint32_t from = queue[head++];
+
+            uint32_t e = offsets[from];
+
+            for (; e < offsets[from + 1]; e++)
+            {
+                uint32_t to = edges[e];
+
+                if (wave_list[to] < wave_list[from] + 1)
+                {
+                    wave_list[to] = wave_list[from] + 1;
+
+                    if (wave_list[to] + 1 > *wave_count)
+                    {
+                        *wave_count = wave_list[to] + 1;
+                    }
+                }
+
+                if (--indegree[to] == 0)
+                {
+                    queue[tail++] = to;
+                }
+            }
+        }
+
+        status = SAI_STATUS_SUCCESS;
+
+        if (tail != object_count)
+        {
+            SAI_META_LOG_ERROR("%u of %u objects can't be ordered, objects reference each other in a loop", object_count - tail, object_count);
+
+            status = SAI_STATUS_FAILURE;
+        }
+    }
+
+    free(indegree);
+    free(offsets);
+    free(edges);
+    free(queue);
+
+    return status;
+}
+
+sai_status_t sai_metadata_get_object_waves(
+        _In_ uint32_t object_count,
+        _In_ const sai_object_meta_key_t *meta_key_list,
+        _In_ const uint32_t *attr_count_list,
+        _In_ const sai_attribute_t **attr_list,
+        _Out_ uint32_t *wave_list,
+        _Out_ uint32_t *order,
+        _Out_ uint32_t *wave_count)
+{
+    if (meta_key_list == NULL || attr_count_list == NULL || attr_list == NULL || wave_list == NULL || wave_count == NULL)
+    {
+        SAI_META_LOG_ERROR("one of parameters is NULL");
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    sai_metadata_oid_index_t* oids = malloc(((size_t)object_count + 1) * sizeof(sai_metadata_oid_index_t));
+
+    if (oids == NULL)
+    {
+        return SAI_STATUS_NO_MEMORY;
+    }
+
+    uint32_t oids_count = 0;
+    uint32_t i = 0;
+
+    for (; i < object_count; i++)
+    {
+        if (sai_metadata_is_object_type_oid(meta_key_list[i].objecttype))
+        {
+            oids[oids_count].oid = meta_key_list[i].objectkey.key.object_id;
+            oids[oids_count].index = i;
+            oids_count++;
+        }
+    }
+
+    qsort(oids, oids_count, sizeof(sai_metadata_oid_index_t), sai_metadata_oid_index_cmp);
+
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    for (i = 1; i < oids_count; i++)
+    {
+        if (oids[i].oid == oids[i - 1].oid)
+        {
+            SAI_META_LOG_ERROR("object 0x%" PRIx64 " is duplicated", oids[i].oid);
+
+            status = SAI_STATUS_INVALID_PARAMETER;
+            break;
+        }
+    }
+
+    sai_metadata_deps_t deps;
+
+    memset(&deps, 0, sizeof(deps));
+
+    deps.oids = oids;
+    deps.oids_count = oids_count;
+
+    for (i = 0; status == SAI_STATUS_SUCCESS && i < object_count; i++)
+    {
+        status = sai_metadata_add_object_deps(&deps, &meta_key_list[i], attr_count_list[i], attr_list[i], i);
+    }
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        status = sai_metadata_layer_objects(object_count, &deps, wave_list, wave_count);
+    }
+
+    if (status == SAI_STATUS_SUCCESS && order != NULL)
+    {
+        /* stable counting sort by wave */
+
+        uint32_t* offsets = calloc((size_t)*wave_count + 1, sizeof(uint32_t));
+
+        if (offsets == NULL)
+        {
+            status = SAI_STATUS_NO_MEMORY;
+        }
+        else
+        {
+            for (i = 0; i < object_count; i++)
+            {
+                offsets[wave_list[i] + 1]++;
+            }
+
+            for (i = 0; i < *wave_count; i++)
+            {
+                offsets[i + 1] += offsets[i];
+            }
+
+            for (i = 0; i < object_count; i++)
+            {
+                order[offsets[wave_list[i]]++] = i;
+            }
+
+            free(offsets);
+        }
+    }
+
+    free(oids);
+    free(deps.from);
+    free(deps.to);
+
+    return status;
+}
+
 sai_api_version_t sai_metadata_query_api_version(void)
 {
     return SAI_API_VERSION;
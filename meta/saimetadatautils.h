@@ -222,6 +222,69 @@ extern bool sai_metadata_is_validonly_met(
         _In_ uint32_t attr_count,
         _In_ const sai_attribute_t *attr_list);
 
+/**
+ * @brief Gets object types layered in creation order.
+ *
+ * Object types are layered topologically based on reverse graph members,
+ * which are built from object id and object list attributes (respecting
+ * allowed object types) and from non object id struct members. Objects of
+ * types from layer N can only reference objects of types from layers lower
+ * than N, so all objects from single layer can be created in parallel (for
+ * example by single bulk call per object type) once all lower layers are
+ * created, and removed in reverse layer order.
+ *
+ * Read only attributes are not considered as dependencies. Object type
+ * referencing itself is not considered as dependency, objects of such type
+ * need to be ordered by sai_metadata_get_object_waves. When object types
+ * form a loop, dependencies coming from create and set attributes which are
+ * not mandatory on create are dropped from loop, those attributes need to be
+ * set after all objects are created.
+ *
+ * @param[inout] count Size of object_types and layers arrays. On return
+ * contains number of object types.
+ * @param[out] object_types Object types sorted by layer.
+ * @param[out] layers Layer of corresponding object type.
+ *
+ * @return #SAI_STATUS_SUCCESS on success, #SAI_STATUS_BUFFER_OVERFLOW if
+ * arrays are too small, #SAI_STATUS_FAILURE if object types can't be layered.
+ */
+extern sai_status_t sai_metadata_get_object_type_layers(
+        _Inout_ uint32_t *count,
+        _Out_ sai_object_type_t *object_types,
+        _Out_ uint32_t *layers);
+
+/**
+ * @brief Gets creation waves for given set of objects.
+ *
+ * Objects are ordered by object ids referenced from their attributes and
+ * from non object id struct members of their keys. Object ids which don't
+ * belong to any object from given set are considered already existing.
+ * Objects from single wave don't reference each other, so they can be
+ * created by bulk calls once all previous waves are created, and removed in
+ * reverse wave order.
+ *
+ * @param[in] object_count Number of objects.
+ * @param[in] meta_key_list Object meta keys. For object id object types,
+ * object id must be unique.
+ * @param[in] attr_count_list Number of attributes for each object.
+ * @param[in] attr_list Attributes for each object.
+ * @param[out] wave_list Wave of each object.
+ * @param[out] order Object indexes sorted by wave, can be NULL.
+ * @param[out] wave_count Number of waves.
+ *
+ * @return #SAI_STATUS_SUCCESS on success, #SAI_STATUS_INVALID_PARAMETER if
+ * object id is duplicated, #SAI_STATUS_FAILURE if objects reference each
+ * other in a loop.
+ */
+extern sai_status_t sai_metadata_get_object_waves(
+        _In_ uint32_t object_count,
+        _In_ const sai_object_meta_key_t *meta_key_list,
+        _In_ const uint32_t *attr_count_list,
+        _In_ const sai_attribute_t **attr_list,
+        _Out_ uint32_t *wave_list,
+        _Out_ uint32_t *order,
+        _Out_ uint32_t *wave_count);
+
 /**
  * @brief Metadata query API version.
  *
@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) 2021 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABILITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc., Marvell International Ltd.
+ *
+ * @file    sairpccachetest.cpp
+ *
+ * @brief   This module defines SAI RPC attribute cache test
+ */
+
+#include "sai_rpc_cache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#define ASSERT_TRUE(x,fmt,...)                              \
+    if (!(x)){                                              \
+        fprintf(stderr,                                     \
+                "ASSERT TRUE FAILED(%s:%d): %s: " fmt "\n", \
+                __func__, __LINE__, #x, ##__VA_ARGS__);     \
+        exit(1);}
+
+#define TEST_PORT_OID       0x1000000000001ULL
+#define TEST_PORT_OID_2     0x1000000000002ULL
+#define TEST_SWITCH_OID     0x21000000000000ULL
+
+static std::string g_path;
+
+static int g_validate_calls;
+
+static bool validate_exists(
+        sai_object_type_t object_type,
+        sai_object_id_t oid,
+        sai_attr_id_t attr_id)
+{
+    g_validate_calls++;
+
+    return oid == TEST_PORT_OID || oid == TEST_SWITCH_OID;
+}
+
+static void test_disabled()
+{
+    sai_rpc_cache cache(NULL);
+
+    ASSERT_TRUE(!cache.enabled(), "cache without file should be disabled");
+
+    ASSERT_TRUE(!cache.open(""), "empty path should not enable cache");
+
+    std::string value;
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "9100");
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "disabled cache should miss");
+}
+
+static void test_hit_miss()
+{
+    unlink(g_path.c_str());
+
+    sai_rpc_cache cache(g_path.c_str());
+
+    ASSERT_TRUE(cache.enabled(), "failed to open %s", g_path.c_str());
+
+    std::string value;
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "empty cache should miss");
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "9100");
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "stored value should hit");
+    ASSERT_TRUE(value == "9100", "got %s", value.c_str());
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_ADMIN_STATE, value), "other attribute should miss");
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, value), "other object should miss");
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_VLAN, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "other object type should miss");
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "1514");
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "overwritten value should hit");
+    ASSERT_TRUE(value == "1514", "got %s", value.c_str());
+
+    ASSERT_TRUE(cache.hits() == 2, "hits %" PRIu64, cache.hits());
+    ASSERT_TRUE(cache.misses() == 4, "misses %" PRIu64, cache.misses());
+}
+
+static void test_invalidate()
+{
+    unlink(g_path.c_str());
+
+    sai_rpc_cache cache(g_path.c_str());
+
+    std::string value;
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "9100");
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, "9100");
+
+    // set
+
+    cache.invalidate_object(TEST_PORT_OID);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "set object should miss");
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, value), "other object should hit");
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "1514");
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "value stored after set should hit");
+    ASSERT_TRUE(value == "1514", "got %s", value.c_str());
+
+    // remove
+
+    cache.invalidate_object(TEST_PORT_OID_2);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, value), "removed object should miss");
+
+    // whole object type
+
+    cache.invalidate_object_type(SAI_OBJECT_TYPE_PORT);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "invalidated object type should miss");
+
+    // cold boot
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "9100");
+
+    cache.reset(SAI_NULL_OBJECT_ID);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "reset cache should miss");
+}
+
+static void test_persist_reload()
+{
+    unlink(g_path.c_str());
+
+    uint32_t epoch;
+
+    {
+        sai_rpc_cache cache(g_path.c_str());
+
+        cache.reset(TEST_SWITCH_OID);
+
+        cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, "9100");
+        cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_ADMIN_STATE, "true");
+        cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, "9100");
+        cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_ADMIN_STATE, "true");
+
+        cache.store(SAI_OBJECT_TYPE_VLAN, 0x26000000000001ULL, SAI_VLAN_ATTR_VLAN_ID, "10");
+
+        cache.invalidate_object(0x26000000000001ULL);
+
+        epoch = cache.epoch();
+    }
+
+    sai_rpc_cache cache(g_path.c_str());
+
+    ASSERT_TRUE(cache.epoch() == epoch + 1, "epoch %u after %u", cache.epoch(), epoch);
+    ASSERT_TRUE(cache.switch_id() == TEST_SWITCH_OID, "switch id not persisted");
+
+    std::string value;
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "previous value should miss until trusted");
+
+    cache.trust_previous(true);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "previous value should miss without validator");
+
+    cache.set_validator(validate_exists);
+
+    g_validate_calls = 0;
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "validated value should hit");
+    ASSERT_TRUE(value == "9100", "got %s", value.c_str());
+    ASSERT_TRUE(g_validate_calls == 1, "validator called %d times", g_validate_calls);
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_MTU, value), "revalidated value should hit");
+    ASSERT_TRUE(g_validate_calls == 1, "value should be validated only once, called %d times", g_validate_calls);
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID, SAI_PORT_ATTR_ADMIN_STATE, value), "value of validated object should hit");
+    ASSERT_TRUE(value == "true", "got %s", value.c_str());
+    ASSERT_TRUE(g_validate_calls == 1, "object should be validated only once, called %d times", g_validate_calls);
+
+    // object is gone from switch
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, value), "value of missing object should miss");
+    ASSERT_TRUE(g_validate_calls == 2, "validator called %d times", g_validate_calls);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_ADMIN_STATE, value), "other value of missing object should miss");
+    ASSERT_TRUE(g_validate_calls == 2, "missing object should be validated only once, called %d times", g_validate_calls);
+
+    cache.set_validator(NULL);
+
+    cache.store(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, "1514");
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_PORT, TEST_PORT_OID_2, SAI_PORT_ATTR_MTU, value), "value stored in current epoch should hit");
+    ASSERT_TRUE(value == "1514", "got %s", value.c_str());
+
+    // invalidation before restart survives it
+
+    cache.set_validator(validate_exists);
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_VLAN, 0x26000000000001ULL, SAI_VLAN_ATTR_VLAN_ID, value), "value invalidated before restart should miss");
+}
+
+static void test_epoch_only()
+{
+    unlink(g_path.c_str());
+
+    {
+        sai_rpc_cache cache(g_path.c_str());
+
+        cache.reset(TEST_SWITCH_OID);
+
+        std::string value;
+
+        cache.store(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_PORT_LIST, "ports", true);
+        cache.store(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_SRC_MAC_ADDRESS, "mac");
+
+        ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_PORT_LIST, value), "epoch only value should hit in its epoch");
+        ASSERT_TRUE(value == "ports", "got %s", value.c_str());
+
+        // port created or removed, or switch initialized again
+
+        cache.invalidate_object(TEST_SWITCH_OID);
+
+        ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_PORT_LIST, value), "invalidated epoch only value should miss");
+
+        cache.store(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_PORT_LIST, "ports", true);
+        cache.store(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_SRC_MAC_ADDRESS, "mac");
+    }
+
+    sai_rpc_cache cache(g_path.c_str());
+
+    std::string value;
+
+    cache.trust_previous(true);
+    cache.set_validator(validate_exists);
+
+    g_validate_calls = 0;
+
+    ASSERT_TRUE(!cache.lookup(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_PORT_LIST, value), "epoch only value should miss after restart");
+    ASSERT_TRUE(g_validate_calls == 0, "epoch only value should not be validated, called %d times", g_validate_calls);
+
+    ASSERT_TRUE(cache.lookup(SAI_OBJECT_TYPE_SWITCH, TEST_SWITCH_OID, SAI_SWITCH_ATTR_SRC_MAC_ADDRESS, value), "other value should survive restart");
+    ASSERT_TRUE(value == "mac", "got %s", value.c_str());
+    ASSERT_TRUE(g_validate_calls == 1, "validator called %d times", g_validate_calls);
+}
+
+int main()
+{
+    const char *tmpdir = getenv("TMPDIR");
+
+    g_path = std::string(tmpdir ? tmpdir : "/tmp") + "/sairpccachetest." + std::to_string(getpid());
+
+    test_disabled();
+
+    test_hit_miss();
+
+    test_invalidate();
+
+    test_persist_reload();
+
+    test_epoch_only();
+
+    unlink(g_path.c_str());
+
+    return 0;
+}
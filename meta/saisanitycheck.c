@@ -21,10 +21,19 @@
  *
  * @brief   Defines SAI metadata sanity check
  */
+
+/* clock_gettime, sysconf and pthreads are not part of ANSI C */
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
 #include <alloca.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <sai.h>
 #include <saiversion.h>
 #include "saimetadatautils.h"
@@ -43,14 +52,47 @@ bool debug = false;
 
 defined_attr_t* defined_attributes = NULL;
 
+pthread_mutex_t defined_attributes_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Checks sharded across worker threads (see run_shards) log into their
+ * shard and assert by recording the failure and jumping out of the shard,
+ * shards are then replayed in order, so output is the same as in serial run.
+ */
+
+typedef struct _shard_t {
+
+    char* output;       /* stream id ('1' or '2') followed by text, per log line */
+
+    size_t length;
+
+    size_t capacity;
+
+    char* failure;
+
+    jmp_buf env;
+
+} shard_t;
+
+__thread shard_t* current_shard = NULL;
+
+void meta_log(
+        _In_ FILE* stream,
+        _In_ const char* format,
+        ...) __attribute__ ((format (printf, 2, 3)));
+
+void meta_assert_fail(
+        _In_ const char* format,
+        ...) __attribute__ ((format (printf, 1, 2), noreturn));
+
 #define META_LOG_DEBUG(format, ...)\
-    if (debug) { printf("DEBUG: " format "\n", ##__VA_ARGS__); }
+    if (debug) { meta_log(stdout, "DEBUG: " format "\n", ##__VA_ARGS__); }
 
 #define META_LOG_WARN(format, ...)\
-    fprintf(stderr, "WARN: " format "\n", ##__VA_ARGS__);
+    meta_log(stderr, "WARN: " format "\n", ##__VA_ARGS__);
 
 #define META_LOG_INFO(format, ...)\
-    fprintf(stderr, "INFO: " format "\n", ##__VA_ARGS__);
+    meta_log(stderr, "INFO: " format "\n", ##__VA_ARGS__);
 
 #define META_LOG_ENTER() \
     META_LOG_DEBUG(":> %s", __FUNCTION__);
@@ -66,10 +108,9 @@ defined_attr_t* defined_attributes = NULL;
 
 #define META_ASSERT_FAIL(format, ...)                       \
 {                                                           \
-    fprintf(stderr,                                         \
+    meta_assert_fail(                                       \
             " ASSERT FAILED (on line %d): " format "\n",    \
             __LINE__, ##__VA_ARGS__);                       \
-    exit(1);                                                \
 }
 
 #define META_MD_ASSERT_FAIL(md, format, ...)\
@@ -97,6 +138,249 @@ defined_attr_t* defined_attributes = NULL;
 #define EXTENSION_OBJECT_TYPE_COUNT (SAI_OBJECT_TYPE_EXTENSIONS_RANGE_END - SAI_OBJECT_TYPE_EXTENSIONS_RANGE_START)
 #define TOTAL_OBJECT_TYPE_COUNT (EXTENSION_OBJECT_TYPE_COUNT + SAI_OBJECT_TYPE_MAX)
 
+#define SHARD_LINE_MAX 1024
+
+void shard_append(
+        _Inout_ shard_t* shard,
+        _In_ char stream,
+        _In_ const char* line)
+{
+    size_t len = strlen(line);
+
+    if (shard->length + len + 2 > shard->capacity)
+    {
+        size_t capacity = 2 * shard->capacity + len + 2 + SHARD_LINE_MAX;
+
+        char* output = (char*)realloc(shard->output, capacity);
+
+        if (output == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+
+        shard->output = output;
+        shard->capacity = capacity;
+    }
+
+    shard->output[shard->length++] = stream;
+
+    memcpy(shard->output + shard->length, line, len + 1);
+
+    shard->length += len + 1;
+}
+
+void meta_log(
+        _In_ FILE* stream,
+        _In_ const char* format,
+        ...)
+{
+    char line[SHARD_LINE_MAX];
+
+    va_list args;
+
+    va_start(args, format);
+
+    if (current_shard == NULL)
+    {
+        vfprintf(stream, format, args);
+        va_end(args);
+        return;
+    }
+
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    shard_append(current_shard, (stream == stderr) ? '2' : '1', line);
+}
+
+void meta_assert_fail(
+        _In_ const char* format,
+        ...)
+{
+    char line[SHARD_LINE_MAX];
+
+    va_list args;
+
+    va_start(args, format);
+
+    if (current_shard == NULL)
+    {
+        vfprintf(stderr, format, args);
+        va_end(args);
+        exit(1);
+    }
+
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    current_shard->failure = strdup(line);
+
+    longjmp(current_shard->env, 1);
+}
+
+/*
+ * Shard runner, runs fn(0) .. fn(count - 1) on worker threads, unless
+ * running serial. Main thread is one of the workers.
+ */
+
+typedef void (*shard_fn_t)(
+        _In_ size_t index);
+
+typedef struct _shard_runner_t {
+
+    shard_t* shards;
+
+    size_t count;
+
+    size_t next;
+
+    shard_fn_t fn;
+
+} shard_runner_t;
+
+bool serial = false;
+
+size_t jobs = 0;
+
+void run_shard(
+        _Inout_ shard_runner_t* runner,
+        _In_ size_t index)
+{
+    shard_t* shard = &runner->shards[index];
+
+    current_shard = shard;
+
+    if (setjmp(shard->env) == 0)
+    {
+        runner->fn(index);
+    }
+
+    current_shard = NULL;
+}
+
+void* shard_worker(
+        _In_ void* arg)
+{
+    shard_runner_t* runner = (shard_runner_t*)arg;
+
+    while (true)
+    {
+        size_t index = __sync_fetch_and_add(&runner->next, 1);
+
+        if (index >= runner->count)
+        {
+            break;
+        }
+
+        run_shard(runner, index);
+    }
+
+    return NULL;
+}
+
+void run_shards(
+        _In_ size_t count,
+        _In_ shard_fn_t fn)
+{
+    size_t threads = (jobs < count) ? jobs : count;
+
+    size_t i = 0;
+
+    if (serial || threads <= 1)
+    {
+        for (; i < count; ++i)
+        {
+            fn(i);
+        }
+
+        return;
+    }
+
+    shard_runner_t runner;
+
+    runner.shards = (shard_t*)calloc(count, sizeof(shard_t));
+    runner.count = count;
+    runner.next = 0;
+    runner.fn = fn;
+
+    pthread_t* tids = (pthread_t*)calloc(threads, sizeof(pthread_t));
+
+    if (runner.shards == NULL || tids == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    size_t started = 0;
+
+    for (; started < threads - 1; ++started)
+    {
+        if (pthread_create(&tids[started], NULL, shard_worker, &runner) != 0)
+        {
+            break;
+        }
+    }
+
+    shard_worker(&runner);
+
+    for (i = 0; i < started; ++i)
+    {
+        pthread_join(tids[i], NULL);
+    }
+
+    free(tids);
+
+    /* replay in shard order and stop on first failure, as serial run would */
+
+    for (i = 0; i < count; ++i)
+    {
+        shard_t* shard = &runner.shards[i];
+
+        size_t pos = 0;
+
+        while (pos < shard->length)
+        {
+            const char* line = shard->output + pos + 1;
+
+            fputs(line, (shard->output[pos] == '2') ? stderr : stdout);
+
+            pos += strlen(line) + 2;
+        }
+
+        if (shard->failure != NULL)
+        {
+            fflush(stdout);
+            fputs(shard->failure, stderr);
+            exit(1);
+        }
+
+        free(shard->output);
+    }
+
+    free(runner.shards);
+}
+
+double now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+size_t object_type_infos_count()
+{
+    size_t i = 1;
+
+    for (; sai_metadata_all_object_type_infos[i] != NULL; ++i)
+    {
+    }
+
+    return i - 1;
+}
+
 bool is_extensions_enum(
         _In_ const sai_enum_metadata_t* emd)
 {
@@ -2367,11 +2651,30 @@ void check_attr_reverse_graph(
     }
 }
 
+void define_attr(
+        _In_ const sai_attr_metadata_t* md)
+{
+    META_LOG_ENTER();
+
+    defined_attr_t *p = (defined_attr_t*)malloc(sizeof(defined_attr_t));
+
+    p->metadata = md;
+    p->next = defined_attributes;
+
+    defined_attributes = p;
+}
+
 void check_if_attr_was_already_defined(
         _In_ const sai_attr_metadata_t* md)
 {
     META_LOG_ENTER();
 
+    bool defined = false;
+
+    /* list is shared by attribute shards, don't assert while holding lock */
+
+    pthread_mutex_lock(&defined_attributes_mutex);
+
     const defined_attr_t *p = defined_attributes;
 
     while (p)
@@ -2381,12 +2684,25 @@ void check_if_attr_was_already_defined(
             if (p->metadata->objecttype == md->objecttype &&
                     p->metadata->attrid == md->attrid)
             {
-                META_MD_ASSERT_FAIL(md, "attribute was already declared");
+                defined = true;
+                break;
             }
         }
 
         p = p->next;
     }
+
+    if (!defined)
+    {
+        define_attr(md);
+    }
+
+    pthread_mutex_unlock(&defined_attributes_mutex);
+
+    if (defined)
+    {
+        META_MD_ASSERT_FAIL(md, "attribute was already declared");
+    }
 }
 
 void check_attr_acl_capability(
@@ -2405,19 +2721,6 @@ void check_attr_acl_capability(
     }
 }
 
-void define_attr(
-        _In_ const sai_attr_metadata_t* md)
-{
-    META_LOG_ENTER();
-
-    defined_attr_t *p = (defined_attr_t*)malloc(sizeof(defined_attr_t));
-
-    p->metadata = md;
-    p->next = defined_attributes;
-
-    defined_attributes = p;
-}
-
 void check_attr_acl_field_or_action(
         _In_ const sai_attr_metadata_t* md)
 {
@@ -3517,8 +3820,6 @@ void check_single_attribute(
     check_attr_mixed_condition(md);
     check_attr_mixed_validonly(md);
     check_attr_condition_relaxed(md);
-
-    define_attr(md);
 }
 
 void check_single_object_type_attributes(
@@ -4008,171 +4309,476 @@ sai_object_type_t idx2ot(
     META_ASSERT_FAIL("invalid index: %d", idx);
 }
 
-void list_loop(
-        _In_ const sai_object_type_info_t* info,
-        _In_ const sai_object_type_t *visited,
-        _In_ const uint32_t *attributes,
-        _In_ int levelidx,
-        _In_ int level)
-{
-    META_LOG_ENTER();
+/*
+ * Object type dependency graph.
+ *
+ * Built once from all object type infos and shared by loop and connectivity
+ * checks. Nodes are object type indexes (ot2idx), edges of node n are
+ * edges[offsets[n]] .. edges[offsets[n + 1] - 1]. Each edge is flagged with
+ * the checks which should follow it, since loop check and connectivity
+ * check don't consider the same attributes.
+ */
 
-    META_LOG_WARN("LOOP DETECTED on object type: %s",
-            sai_metadata_get_object_type_name(info->objecttype));
+#define GRAPH_EDGE_LOOP         (1 << 0)
+#define GRAPH_EDGE_CONNECTED    (1 << 1)
 
-    for (; levelidx < level; ++levelidx)
-    {
-        sai_object_type_t ot = visited[levelidx];
+typedef struct _graph_edge_t {
 
-        const char* ot_name = sai_metadata_get_object_type_name(ot);
+    uint32_t to;
 
-        const sai_attr_metadata_t* m = sai_metadata_get_attr_metadata(ot, attributes[levelidx]);
+    uint32_t flags;
 
-        META_LOG_WARN(" %s: %s", ot_name, m->attridname);
+    /*
+     * Attribute or struct member introducing this edge, both are NULL on
+     * reverse graph edges.
+     */
+
+    const sai_attr_metadata_t* md;
+
+    const sai_struct_member_info_t* sm;
+
+} graph_edge_t;
+
+typedef struct _object_graph_t {
+
+    size_t nodescount;
+
+    size_t edgescount;
+
+    size_t* offsets;
+
+    graph_edge_t* edges;
+
+} object_graph_t;
+
+object_graph_t object_graph;
+
+bool graph_is_known_loop(
+        _In_ const sai_attr_metadata_t* m)
+{
+    if (m->objecttype == SAI_OBJECT_TYPE_SRV6_SIDLIST)
+    {
+        if (m->attrid == SAI_SRV6_SIDLIST_ATTR_NEXT_HOP_ID)
+        {
+            return true;
+        }
     }
 
-    META_LOG_WARN(" -> %s", sai_metadata_get_object_type_name(info->objecttype));
+    if (m->objecttype == SAI_OBJECT_TYPE_PORT)
+    {
+        if (m->attrid == SAI_PORT_ATTR_EGRESS_MIRROR_SESSION ||
+                m->attrid == SAI_PORT_ATTR_INGRESS_MIRROR_SESSION ||
+                m->attrid == SAI_PORT_ATTR_EGRESS_BLOCK_PORT_LIST ||
+                m->attrid == SAI_PORT_ATTR_INGRESS_SAMPLE_MIRROR_SESSION ||
+                m->attrid == SAI_PORT_ATTR_EGRESS_SAMPLE_MIRROR_SESSION)
+        {
+            return true;
+        }
+    }
 
-    if (level >= 0)
+    if (m->objecttype == SAI_OBJECT_TYPE_SCHEDULER_GROUP &&
+            m->attrid == SAI_SCHEDULER_GROUP_ATTR_PARENT_NODE)
     {
-        META_ASSERT_FAIL("LOOP is detected, we can't have loops in graph, please fix attributes");
+        return true;
     }
+
+    return false;
 }
 
-void check_objects_for_loops_recursive(
-        _In_ const sai_object_type_info_t* info,
-        _Inout_ sai_object_type_t *visited,
-        _Inout_ uint32_t *attributes,
-        _In_ int level)
+size_t graph_add_edges(
+        _Inout_ graph_edge_t* edges,
+        _In_ size_t count,
+        _In_ const sai_object_type_t* objecttypes,
+        _In_ size_t objecttypeslength,
+        _In_ uint32_t flags,
+        _In_ const sai_attr_metadata_t* md,
+        _In_ const sai_struct_member_info_t* sm)
 {
-    META_LOG_ENTER();
-
-    visited[level] = info->objecttype;
-
-    int levelidx = 0;
+    size_t i = 0;
 
-    for (; levelidx < level; ++levelidx)
+    for (; i < objecttypeslength; ++i)
     {
-        if (visited[levelidx] == info->objecttype)
+        if (edges != NULL)
         {
-            /* object type is already defined, so we have a loop */
+            graph_edge_t* e = &edges[count];
 
-            list_loop(info, visited, attributes, levelidx, level);
-
-            return;
+            e->to = ot2idx(objecttypes[i]);
+            e->flags = flags;
+            e->md = md;
+            e->sm = sm;
         }
+
+        count++;
     }
 
+    return count;
+}
+
+/*
+ * Fills edges of single object type starting at edges[count] and returns
+ * new count, edges can be NULL to only count them.
+ */
+size_t graph_node_edges(
+        _In_ const sai_object_type_info_t* info,
+        _Inout_ graph_edge_t* edges,
+        _In_ size_t count)
+{
+    META_LOG_ENTER();
+
     const sai_attr_metadata_t* const* meta = info->attrmetadata;
 
     META_ASSERT_NOT_NULL(meta);
 
     size_t idx = 0;
 
-    /* iterate all attributes on non object id type */
-
     for (; meta[idx] != NULL; ++idx)
     {
         const sai_attr_metadata_t* m = meta[idx];
 
-        META_ASSERT_NOT_NULL(m);
-
-        if (SAI_HAS_FLAG_READ_ONLY(m->flags))
-        {
-            /* skip read only attributes since with those we will have loops for sure */
-
-            continue;
-        }
+        uint32_t flags = 0;
 
-        /* skip known loops */
+        /*
+         * Read only attributes are skipped for loops, since with those we
+         * will have loops for sure.
+         */
 
-        if (m->objecttype == SAI_OBJECT_TYPE_SRV6_SIDLIST)
+        if (!SAI_HAS_FLAG_READ_ONLY(m->flags) && !graph_is_known_loop(m))
         {
-            if (m->attrid == SAI_SRV6_SIDLIST_ATTR_NEXT_HOP_ID)
-            {
-                continue;
-            }
+            flags |= GRAPH_EDGE_LOOP;
         }
 
-        if (m->objecttype == SAI_OBJECT_TYPE_PORT)
+        if (m->isoidattribute && (m->iscreateonly || m->iscreateandset))
         {
-            if (m->attrid == SAI_PORT_ATTR_EGRESS_MIRROR_SESSION ||
-                    m->attrid == SAI_PORT_ATTR_INGRESS_MIRROR_SESSION ||
-                    m->attrid == SAI_PORT_ATTR_EGRESS_BLOCK_PORT_LIST ||
-                    m->attrid == SAI_PORT_ATTR_INGRESS_SAMPLE_MIRROR_SESSION ||
-                    m->attrid == SAI_PORT_ATTR_EGRESS_SAMPLE_MIRROR_SESSION)
-            {
-                continue;
-            }
+            flags |= GRAPH_EDGE_CONNECTED;
         }
 
-        if (m->objecttype == SAI_OBJECT_TYPE_SCHEDULER_GROUP &&
-                m->attrid == SAI_SCHEDULER_GROUP_ATTR_PARENT_NODE)
+        if (flags == 0)
         {
             continue;
         }
 
-        attributes[level] = m->attrid;
+        count = graph_add_edges(edges, count, m->allowedobjecttypes, m->allowedobjecttypeslength, flags, m, NULL);
+    }
 
-        size_t j = 0;
+    for (idx = 0; idx < info->structmemberscount; ++idx)
+    {
+        const sai_struct_member_info_t* sm = info->structmembers[idx];
 
-        for (; j < m->allowedobjecttypeslength; ++j)
-        {
-            const sai_object_type_info_t* next = sai_metadata_get_object_type_info(m->allowedobjecttypes[j]);
+        uint32_t flags = GRAPH_EDGE_CONNECTED;
 
-            check_objects_for_loops_recursive(next, visited, attributes, level + 1);
+        if (info->isnonobjectid && sm->membervaluetype == SAI_ATTR_VALUE_TYPE_OBJECT_ID)
+        {
+            flags |= GRAPH_EDGE_LOOP;
         }
+
+        count = graph_add_edges(edges, count, sm->allowedobjecttypes, sm->allowedobjecttypeslength, flags, NULL, sm);
     }
 
-    /* iterate for struct members on non object id object types */
+    for (idx = 0; idx < info->revgraphmemberscount; ++idx)
+    {
+        const sai_rev_graph_member_t* rgm = info->revgraphmembers[idx];
+
+        count = graph_add_edges(edges, count, &rgm->depobjecttype, 1, GRAPH_EDGE_CONNECTED, NULL, NULL);
+    }
+
+    return count;
+}
 
-    if (info->isnonobjectid)
+void build_object_graph()
+{
+    META_LOG_ENTER();
+
+    object_graph_t* g = &object_graph;
+
+    size_t i = 1;
+
+    for (; sai_metadata_all_object_type_infos[i] != NULL; ++i)
     {
-        size_t j = 0;
+    }
 
-        for (; j < info->structmemberscount; ++j)
+    g->nodescount = i;
+    g->offsets = (size_t*)calloc(g->nodescount + 1, sizeof(size_t));
+
+    META_ASSERT_NOT_NULL(g->offsets);
+
+    /* first pass only counts edges */
+
+    size_t count = 0;
+
+    for (i = 1; i < g->nodescount; ++i)
+    {
+        count = graph_node_edges(sai_metadata_all_object_type_infos[i], NULL, count);
+    }
+
+    g->edgescount = count;
+    g->edges = (graph_edge_t*)calloc(count + 1, sizeof(graph_edge_t));
+
+    META_ASSERT_NOT_NULL(g->edges);
+
+    count = 0;
+
+    for (i = 1; i < g->nodescount; ++i)
+    {
+        g->offsets[i] = count;
+
+        count = graph_node_edges(sai_metadata_all_object_type_infos[i], g->edges, count);
+    }
+
+    g->offsets[g->nodescount] = count;
+
+    for (i = 0; i < count; ++i)
+    {
+        META_ASSERT_TRUE(g->edges[i].to > 0 && g->edges[i].to < g->nodescount, "edge to invalid object type index %u", g->edges[i].to);
+    }
+
+    META_LOG_DEBUG("object graph: %zu nodes, %zu edges", g->nodescount, g->edgescount);
+}
+
+const char* graph_node_name(
+        _In_ uint32_t node)
+{
+    return sai_metadata_get_object_type_name(idx2ot(node));
+}
+
+typedef struct _tarjan_t {
+
+    const object_graph_t* g;
+
+    uint32_t next;
+
+    uint32_t* index;        /* visit order + 1, 0 when not visited */
+
+    uint32_t* lowlink;
+
+    uint32_t* component;    /* strongly connected component + 1 */
+
+    uint32_t components;
+
+    bool* onstack;
+
+    uint32_t* stack;
+
+    size_t stacksize;
+
+} tarjan_t;
+
+void tarjan_visit(
+        _Inout_ tarjan_t* t,
+        _In_ uint32_t node)
+{
+    t->next++;
+    t->index[node] = t->next;
+    t->lowlink[node] = t->next;
+
+    t->stack[t->stacksize++] = node;
+    t->onstack[node] = true;
+
+    size_t e = t->g->offsets[node];
+
+    for (; e < t->g->offsets[node + 1]; ++e)
+    {
+        const graph_edge_t* edge = &t->g->edges[e];
+
+        if ((edge->flags & GRAPH_EDGE_LOOP) == 0)
         {
-            const sai_struct_member_info_t *m = info->structmembers[j];
+            continue;
+        }
 
-            if (m->membervaluetype != SAI_ATTR_VALUE_TYPE_OBJECT_ID)
+        if (t->index[edge->to] == 0)
+        {
+            tarjan_visit(t, edge->to);
+
+            if (t->lowlink[edge->to] < t->lowlink[node])
             {
-                continue;
+                t->lowlink[node] = t->lowlink[edge->to];
             }
+        }
+        else if (t->onstack[edge->to] && t->index[edge->to] < t->lowlink[node])
+        {
+            t->lowlink[node] = t->index[edge->to];
+        }
+    }
 
-            size_t k = 0;
+    if (t->lowlink[node] != t->index[node])
+    {
+        return;
+    }
 
-            for (; k < m->allowedobjecttypeslength; k++)
-            {
-                const sai_object_type_info_t* next = sai_metadata_get_object_type_info(m->allowedobjecttypes[k]);
+    /* node is root of component, pop it */
+
+    t->components++;
+
+    uint32_t member;
+
+    do
+    {
+        member = t->stack[--t->stacksize];
+
+        t->onstack[member] = false;
+        t->component[member] = t->components;
+    }
+    while (member != node);
+}
+
+/*
+ * Finds shortest loop through edge (from -> edge->to) inside single strongly
+ * connected component, and lists object types and attributes on its path.
+ */
+void list_loop(
+        _In_ const object_graph_t* g,
+        _In_ const uint32_t* component,
+        _In_ uint32_t from,
+        _In_ const graph_edge_t* loopedge)
+{
+    META_LOG_ENTER();
+
+    const graph_edge_t** parent = (const graph_edge_t**)calloc(g->nodescount, sizeof(graph_edge_t*));
+    uint32_t* parentnode = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+    const graph_edge_t** path = (const graph_edge_t**)calloc(g->nodescount + 1, sizeof(graph_edge_t*));
+    uint32_t* pathnode = (uint32_t*)calloc(g->nodescount + 1, sizeof(uint32_t));
+
+    META_ASSERT_TRUE(parent && parentnode && queue && path && pathnode, "out of memory");
+
+    size_t head = 0;
+    size_t tail = 0;
+
+    queue[tail++] = loopedge->to;
+    parent[loopedge->to] = loopedge;
+    parentnode[loopedge->to] = from;
+
+    while (head < tail && parent[from] == NULL)
+    {
+        uint32_t node = queue[head++];
+
+        size_t e = g->offsets[node];
+
+        for (; e < g->offsets[node + 1]; ++e)
+        {
+            const graph_edge_t* edge = &g->edges[e];
 
-                check_objects_for_loops_recursive(next, visited, attributes, level + 1);
+            if ((edge->flags & GRAPH_EDGE_LOOP) == 0 ||
+                    component[edge->to] != component[from] ||
+                    parent[edge->to] != NULL)
+            {
+                continue;
             }
+
+            parent[edge->to] = edge;
+            parentnode[edge->to] = node;
+            queue[tail++] = edge->to;
         }
     }
 
-    /* clear level on exit */
+    META_ASSERT_NOT_NULL(parent[from]);
+
+    /* walk back from "from" to itself */
+
+    size_t len = 0;
+    uint32_t node = from;
+
+    do
+    {
+        path[len] = parent[node];
+        pathnode[len] = parentnode[node];
+        len++;
+
+        node = parentnode[node];
+    }
+    while (node != from && len <= g->nodescount);
+
+    META_LOG_WARN("LOOP DETECTED on object type: %s", graph_node_name(from));
 
-    visited[level] = SAI_OBJECT_TYPE_NULL;
-    attributes[level] = 0;
+    while (len-- > 0)
+    {
+        const graph_edge_t* edge = path[len];
+
+        META_LOG_WARN(" %s: %s", graph_node_name(pathnode[len]),
+                edge->md ? edge->md->attridname : edge->sm->membername);
+    }
+
+    META_LOG_WARN(" -> %s", graph_node_name(from));
+
+    free(parent);
+    free(parentnode);
+    free(queue);
+    free(path);
+    free(pathnode);
 }
 
 void check_objects_for_loops()
 {
     META_LOG_ENTER();
 
-    sai_object_type_t visited_objects[TOTAL_OBJECT_TYPE_COUNT];
-    uint32_t visited_attributes[TOTAL_OBJECT_TYPE_COUNT];
+    const object_graph_t* g = &object_graph;
 
-    size_t i = 1;
+    tarjan_t t;
 
-    for (; sai_metadata_all_object_type_infos[i] != NULL; ++i)
+    memset(&t, 0, sizeof(t));
+
+    t.g = g;
+    t.index = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+    t.lowlink = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+    t.component = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+    t.onstack = (bool*)calloc(g->nodescount, sizeof(bool));
+    t.stack = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
+
+    META_ASSERT_TRUE(t.index && t.lowlink && t.component && t.onstack && t.stack, "out of memory");
+
+    uint32_t node = 1;
+
+    for (; node < g->nodescount; ++node)
     {
-        const sai_object_type_info_t* info = sai_metadata_all_object_type_infos[i];
+        if (t.index[node] == 0)
+        {
+            tarjan_visit(&t, node);
+        }
+    }
+
+    /*
+     * Every loop edge with both ends in the same component (including self
+     * loop) is part of a cycle, report each cyclic component once.
+     */
+
+    bool* reported = (bool*)calloc((size_t)t.components + 1, sizeof(bool));
+
+    META_ASSERT_NOT_NULL(reported);
+
+    size_t loops = 0;
+
+    for (node = 1; node < g->nodescount; ++node)
+    {
+        size_t e = g->offsets[node];
+
+        for (; e < g->offsets[node + 1]; ++e)
+        {
+            const graph_edge_t* edge = &g->edges[e];
+
+            if ((edge->flags & GRAPH_EDGE_LOOP) == 0 ||
+                    t.component[edge->to] != t.component[node] ||
+                    reported[t.component[node]])
+            {
+                continue;
+            }
+
+            reported[t.component[node]] = true;
+
+            list_loop(g, t.component, node, edge);
+
+            loops++;
+        }
+    }
 
-        memset(visited_objects, 0, TOTAL_OBJECT_TYPE_COUNT * sizeof(sai_object_type_t));
-        memset(visited_attributes, 0, TOTAL_OBJECT_TYPE_COUNT * sizeof(uint32_t));
+    free(reported);
+    free(t.index);
+    free(t.lowlink);
+    free(t.component);
+    free(t.onstack);
+    free(t.stack);
 
-        check_objects_for_loops_recursive(info, visited_objects, visited_attributes, 0);
+    if (loops)
+    {
+        META_ASSERT_FAIL("%zu LOOP(s) detected, we can't have loops in graph, please fix attributes", loops);
     }
 }
 
@@ -5123,86 +5729,54 @@ void check_backward_comparibility_defines()
     META_ASSERT_TRUE(bind == SAI_ACL_BIND_POINT_TYPE_ROUTER_INTERFACE, "not equal");
 }
 
-void helper_check_graph_connected(
-        _In_ sai_object_type_t ot,
-        _Inout_ sai_object_type_t *visited)
+void check_graph_connected()
 {
     META_LOG_ENTER();
 
-    if (visited[ot2idx(ot)] == ot)
-    {
-        return;
-    }
-
-    visited[ot2idx(ot)] = ot;
-
-    const sai_object_type_info_t *oi = sai_metadata_get_object_type_info(ot);
-
-    size_t i = 0;
-
-    /* check all attributes */
+    /*
+     * Check if all objects are used and are not "disconnected" from the graph.
+     */
 
-    for (; i < oi->attrmetadatalength; ++i)
-    {
-        const sai_attr_metadata_t *md = oi->attrmetadata[i];
+    const object_graph_t* g = &object_graph;
 
-        if (!md->isoidattribute)
-        {
-            continue;
-        }
+    bool* visited = (bool*)calloc(g->nodescount, sizeof(bool));
+    uint32_t* queue = (uint32_t*)calloc(g->nodescount, sizeof(uint32_t));
 
-        if (!(md->iscreateonly || md->iscreateandset))
-        {
-            continue;
-        }
+    META_ASSERT_TRUE(visited && queue, "out of memory");
 
-        size_t j = 0;
+    size_t head = 0;
+    size_t tail = 0;
 
-        for (;j < md->allowedobjecttypeslength; ++j)
-        {
-            helper_check_graph_connected(md->allowedobjecttypes[j], visited);
-        }
-    }
+    queue[tail++] = ot2idx(SAI_OBJECT_TYPE_PORT);
+    visited[queue[0]] = true;
 
-    for (i = 0; i < oi->structmemberscount; ++i)
+    while (head < tail)
     {
-        const sai_struct_member_info_t *sm = oi->structmembers[i];
+        uint32_t node = queue[head++];
 
-        size_t j = 0;
+        size_t e = g->offsets[node];
 
-        for (;j < sm->allowedobjecttypeslength; ++j)
+        for (; e < g->offsets[node + 1]; ++e)
         {
-            helper_check_graph_connected(sm->allowedobjecttypes[j], visited);
-        }
-    }
+            const graph_edge_t* edge = &g->edges[e];
 
-    for (i = 0; i < oi->revgraphmemberscount; ++i)
-    {
-        const sai_rev_graph_member_t *rgm = oi->revgraphmembers[i];
+            if ((edge->flags & GRAPH_EDGE_CONNECTED) == 0 || visited[edge->to])
+            {
+                continue;
+            }
 
-        helper_check_graph_connected(rgm->depobjecttype, visited);
+            visited[edge->to] = true;
+            queue[tail++] = edge->to;
+        }
     }
-}
-
-void check_graph_connected()
-{
-    META_LOG_ENTER();
-
-    /*
-     * Check if all objects are used and are not "disconnected" from the graph.
-     */
-
-    sai_object_type_t visited[TOTAL_OBJECT_TYPE_COUNT];
 
-    memset(visited, 0, TOTAL_OBJECT_TYPE_COUNT * sizeof(sai_object_type_t));
-
-    helper_check_graph_connected(SAI_OBJECT_TYPE_PORT, visited);
+    free(queue);
 
     uint32_t i = 1;
 
     for (; sai_metadata_all_object_type_infos[i] != NULL; ++i)
     {
-        if (visited[i] == sai_metadata_all_object_type_infos[i]->objecttype)
+        if (visited[i])
         {
             continue;
         }
@@ -5233,6 +5807,85 @@ void check_graph_connected()
         META_ASSERT_FAIL("object %s is disconnected from graph",
                 sai_metadata_all_object_type_infos[i]->objecttypename);
     }
+
+    free(visited);
+}
+
+void check_object_type_layers()
+{
+    META_LOG_ENTER();
+
+    /*
+     * Check if creation order can be computed for all object types, and
+     * each object type is in higher layer than object types which it
+     * references by mandatory or create only attribute, or by struct member.
+     */
+
+    uint32_t count = 0;
+
+    META_ASSERT_TRUE(sai_metadata_get_object_type_layers(&count, NULL, NULL) == SAI_STATUS_BUFFER_OVERFLOW,
+            "expected buffer overflow");
+
+    sai_object_type_t* object_types = (sai_object_type_t*)calloc(count, sizeof(sai_object_type_t));
+    uint32_t* layers = (uint32_t*)calloc(count, sizeof(uint32_t));
+    uint32_t* otlayers = (uint32_t*)calloc(count + 1, sizeof(uint32_t));
+
+    META_ASSERT_TRUE(object_types && layers && otlayers, "out of memory");
+
+    uint32_t infos = count;
+
+    META_ASSERT_TRUE(sai_metadata_get_object_type_layers(&count, object_types, layers) == SAI_STATUS_SUCCESS,
+            "failed to get object type layers");
+
+    META_ASSERT_TRUE(count == infos, "expected all %u object types to be layered, got %u", infos, count);
+
+    uint32_t i = 0;
+
+    for (; i < count; ++i)
+    {
+        otlayers[ot2idx(object_types[i])] = layers[i];
+    }
+
+    for (i = 1; sai_metadata_all_object_type_infos[i] != NULL; ++i)
+    {
+        const sai_object_type_info_t* info = sai_metadata_all_object_type_infos[i];
+
+        size_t j = 0;
+
+        for (; j < info->revgraphmemberscount; ++j)
+        {
+            const sai_rev_graph_member_t* rm = info->revgraphmembers[j];
+
+            const sai_attr_metadata_t* md = rm->attrmetadata;
+
+            if (rm->depobjecttype == rm->objecttype)
+            {
+                continue;
+            }
+
+            if (md != NULL && !SAI_HAS_FLAG_MANDATORY_ON_CREATE(md->flags) && !SAI_HAS_FLAG_CREATE_ONLY(md->flags))
+            {
+                continue;
+            }
+
+            uint32_t layer = otlayers[ot2idx(rm->objecttype)];
+            uint32_t deplayer = otlayers[ot2idx(rm->depobjecttype)];
+
+            if (deplayer > layer)
+            {
+                continue;
+            }
+
+            META_ASSERT_FAIL("%s (layer %u) is used by %s (layer %u) on %s, expected higher layer",
+                    info->objecttypename, layer,
+                    sai_metadata_get_object_type_name(rm->depobjecttype), deplayer,
+                    md ? md->attridname : rm->structmember->membername);
+        }
+    }
+
+    free(object_types);
+    free(layers);
+    free(otlayers);
 }
 
 void check_get_attr_metadata()
@@ -5499,28 +6152,30 @@ void check_defines()
     META_ASSERT_TRUE(SAI_METADATA_SWITCH_NOTIFY_ATTR_COUNT >= 15, "there must be at least 15 notifications defined");
 }
 
+void check_object_type_attributes_shard(
+        _In_ size_t index)
+{
+    check_single_object_type_attributes(sai_metadata_all_object_type_infos[index + 1]->attrmetadata);
+}
+
 void check_object_type_attributes()
 {
     META_LOG_ENTER();
 
-    size_t i = 1;
+    run_shards(object_type_infos_count(), check_object_type_attributes_shard);
+}
 
-    for (; sai_metadata_all_object_type_infos[i]; i++)
-    {
-        check_single_object_type_attributes(sai_metadata_all_object_type_infos[i]->attrmetadata);
-    }
+void check_all_object_infos_shard(
+        _In_ size_t index)
+{
+    check_single_object_info(sai_metadata_all_object_type_infos[index + 1]);
 }
 
 void check_all_object_infos()
 {
     META_LOG_ENTER();
 
-    size_t i = 1;
-
-    for (; sai_metadata_all_object_type_infos[i] != NULL; ++i)
-    {
-        check_single_object_info(sai_metadata_all_object_type_infos[i]);
-    }
+    run_shards(object_type_infos_count(), check_all_object_infos_shard);
 }
 
 void check_ignored_attributes()
@@ -5784,20 +6439,21 @@ void check_single_enum(
     check_enum_object_type(emd);
 }
 
-void check_all_enums()
+void check_all_enums_shard(
+        _In_ size_t index)
 {
-    META_LOG_ENTER();
+    const sai_enum_metadata_t* emd = sai_metadata_all_enums[index];
 
-    size_t i = 0;
+    META_LOG_DEBUG("enum: %s", emd->name);
 
-    for (; i < sai_metadata_all_enums_count; ++i)
-    {
-        const sai_enum_metadata_t* emd = sai_metadata_all_enums[i];
+    check_single_enum(emd);
+}
 
-        META_LOG_DEBUG("enum: %s", emd->name);
+void check_all_enums()
+{
+    META_LOG_ENTER();
 
-        check_single_enum(emd);
-    }
+    run_shards(sai_metadata_all_enums_count, check_all_enums_shard);
 
     check_single_enum(&sai_metadata_enum_sai_global_api_type_t);
     check_single_enum(&sai_metadata_enum_sai_switch_notification_type_t);
@@ -6058,60 +6714,174 @@ void check_object_type_index()
     }
 }
 
+/*
+ * All checks in run order, checks over all object types and enums shard
+ * their work with run_shards.
+ */
+
+typedef struct _sanity_check_t {
+
+    const char* name;
+
+    void (*fn)(void);
+
+    double ms;
+
+} sanity_check_t;
+
+#define SANITY_CHECK(x) { #x, x, 0 }
+
+sanity_check_t sanity_checks[] = {
+    SANITY_CHECK(check_all_enums_name_pointers),
+    SANITY_CHECK(check_all_enums_values),
+    SANITY_CHECK(check_enums_ignore_values),
+    SANITY_CHECK(check_sai_status),
+    SANITY_CHECK(check_object_type_index),
+    SANITY_CHECK(check_object_type),
+    SANITY_CHECK(check_attr_by_object_type),
+    SANITY_CHECK(check_object_type_attributes),
+    SANITY_CHECK(check_object_infos),
+    SANITY_CHECK(check_stat_enums),
+    SANITY_CHECK(check_attr_sorted_by_id_name),
+    SANITY_CHECK(check_non_object_id_object_types),
+    SANITY_CHECK(check_non_object_id_object_attrs),
+    SANITY_CHECK(build_object_graph),
+    SANITY_CHECK(check_objects_for_loops),
+    SANITY_CHECK(check_null_object_id),
+    SANITY_CHECK(check_read_only_attributes),
+    SANITY_CHECK(check_mixed_object_list_types),
+    SANITY_CHECK(check_vlan_attributes),
+    SANITY_CHECK(check_switch_create_only_objects),
+    SANITY_CHECK(check_switch_attributes),
+    SANITY_CHECK(check_reverse_graph_for_non_object_id),
+    SANITY_CHECK(check_acl_table_fields_and_acl_entry_fields),
+    SANITY_CHECK(check_acl_entry_actions),
+    SANITY_CHECK(check_backward_comparibility_defines),
+    SANITY_CHECK(check_graph_connected),
+    SANITY_CHECK(check_object_type_layers),
+    SANITY_CHECK(check_get_attr_metadata),
+    SANITY_CHECK(check_get_attr_metadata_custom_range),
+    SANITY_CHECK(check_acl_user_defined_field),
+    SANITY_CHECK(check_label_size),
+    SANITY_CHECK(check_switch_notify_list),
+    SANITY_CHECK(check_switch_pointers_list),
+    SANITY_CHECK(check_defines),
+    SANITY_CHECK(check_all_object_infos),
+    SANITY_CHECK(check_ignored_attributes),
+    SANITY_CHECK(check_all_enums),
+    SANITY_CHECK(check_sai_version),
+    SANITY_CHECK(check_max_conditions_len),
+    SANITY_CHECK(check_object_type_extension_max_value),
+    SANITY_CHECK(check_global_apis),
+    SANITY_CHECK(check_struct_and_union_size),
+    SANITY_CHECK(check_declare_entry_macro),
+    SANITY_CHECK(check_json_type_size),
+    SANITY_CHECK(check_custom_range_attributes),
+    SANITY_CHECK(check_attr_get_outside_range),
+    SANITY_CHECK(check_api_extensions),
+    { NULL, NULL, 0 }
+};
+
+int sanity_check_cmp(
+        _In_ const void* a,
+        _In_ const void* b)
+{
+    const sanity_check_t* ca = *(const sanity_check_t* const*)a;
+    const sanity_check_t* cb = *(const sanity_check_t* const*)b;
+
+    if (ca->ms > cb->ms)
+        return -1;
+
+    if (ca->ms < cb->ms)
+        return 1;
+
+    return strcmp(ca->name, cb->name);
+}
+
+void print_check_times(
+        _In_ double total)
+{
+    size_t count = sizeof(sanity_checks)/sizeof(sanity_checks[0]) - 1;
+
+    const sanity_check_t** sorted = (const sanity_check_t**)calloc(count, sizeof(sanity_check_t*));
+
+    META_ASSERT_NOT_NULL(sorted);
+
+    size_t i = 0;
+
+    for (; i < count; ++i)
+    {
+        sorted[i] = &sanity_checks[i];
+    }
+
+    qsort(sorted, count, sizeof(sanity_check_t*), sanity_check_cmp);
+
+    printf("\n %-48s %10s\n", "check", "time [ms]");
+
+    for (i = 0; i < count; ++i)
+    {
+        printf(" %-48s %10.3f\n", sorted[i]->name, sorted[i]->ms);
+    }
+
+    printf(" %-48s %10.3f (%zu checks, %s)\n", "total", total, count,
+            (serial || jobs <= 1) ? "serial" : "parallel");
+
+    free(sorted);
+}
+
 int main(int argc, char **argv)
 {
-    debug = (argc > 1);
+    int arg = 1;
+
+    for (; arg < argc; ++arg)
+    {
+        if (strcmp(argv[arg], "--serial") == 0)
+        {
+            serial = true;
+        }
+        else if (strncmp(argv[arg], "--jobs=", 7) == 0)
+        {
+            jobs = (size_t)strtoul(argv[arg] + 7, NULL, 10);
+        }
+        else
+        {
+            /* any other argument enables debug */
+
+            debug = true;
+        }
+    }
+
+    if (jobs == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        jobs = (cpus > 0) ? (size_t)cpus : 1;
+    }
 
     SAI_META_LOG_ENTER();
 
-    check_all_enums_name_pointers();
-    check_all_enums_values();
-    check_enums_ignore_values();
-    check_sai_status();
-    check_object_type_index();
-    check_object_type();
-    check_attr_by_object_type();
-    check_object_type_attributes();
-    check_object_infos();
-    check_stat_enums();
-    check_attr_sorted_by_id_name();
-    check_non_object_id_object_types();
-    check_non_object_id_object_attrs();
-    check_objects_for_loops();
-    check_null_object_id();
-    check_read_only_attributes();
-    check_mixed_object_list_types();
-    check_vlan_attributes();
-    check_switch_create_only_objects();
-    check_switch_attributes();
-    check_reverse_graph_for_non_object_id();
-    check_acl_table_fields_and_acl_entry_fields();
-    check_acl_entry_actions();
-    check_backward_comparibility_defines();
-    check_graph_connected();
-    check_get_attr_metadata();
-    check_get_attr_metadata_custom_range();
-    check_acl_user_defined_field();
-    check_label_size();
-    check_switch_notify_list();
-    check_switch_pointers_list();
-    check_defines();
-    check_all_object_infos();
-    check_ignored_attributes();
-    check_all_enums();
-    check_sai_version();
-    check_max_conditions_len();
-    check_object_type_extension_max_value();
-    check_global_apis();
-    check_struct_and_union_size();
-    check_declare_entry_macro();
-    check_json_type_size();
-    check_custom_range_attributes();
-    check_attr_get_outside_range();
-    check_api_extensions();
+    double start = now_ms();
+
+    size_t i = 0;
+
+    for (; sanity_checks[i].name != NULL; ++i)
+    {
+        double checkstart = now_ms();
+
+        sanity_checks[i].fn();
+
+        sanity_checks[i].ms = now_ms() - checkstart;
+    }
+
+    double total = now_ms() - start;
 
     SAI_META_LOG_DEBUG("log test");
 
+    print_check_times(total);
+
+    printf("\n object graph: %zu object types, %zu edges\n",
+            object_graph.nodescount - 1, object_graph.edgescount);
+
     printf("\n [ %s ]\n\n", sai_metadata_get_status_name(SAI_STATUS_SUCCESS));
 
     SAI_META_LOG_EXIT();
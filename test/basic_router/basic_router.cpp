@@ -26,6 +26,7 @@
 #include <vector>
 #include <map>
 #include <thread>
+#include <chrono>
 
 
 #include <stdint.h>
@@ -48,6 +49,8 @@
 #include "nexthopgrp_mgr.h"
 #include "nexthop_mgr.h"
 #include "fdb_mgr.h"
+#include "rib_loader.h"
+#include "route_bench.h"
 #include "basic_router.h"
 
 
@@ -58,6 +61,14 @@ using ::testing::InitGoogleTest;
 #define PANEL_PORT_VLAN_START   1024
 #define MAX_PORT                256
 #define MAX_TEST                4
+#define BULK_ROUTE_COUNT        100000
+#define BULK_ROUTE_CHUNK_SIZE   1000
+#define IPV6_ROUTE_COUNT        65536
+#define VRF_COUNT               4
+#define VRF_ROUTE_COUNT         16384
+#define FLAP_ROUTE_COUNT        100000
+#define RIB_ROUTE_COUNT         1000000
+#define FDB_SCALE_COUNT         131072
 
 /*--------------------------------------------------------*/
 //definition of the api tables
@@ -72,16 +83,7 @@ sai_route_api_t* sai_route_api;
 sai_next_hop_api_t* sai_next_hop_api;
 sai_next_hop_group_api_t* sai_next_hop_group_api;
 sai_fdb_api_t* sai_fdb_api;
-
-sai_switch_notification_t plat_switch_notification_handlers =
-{
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL,
-    NULL
-};
+sai_bridge_api_t* sai_bridge_api;
 
 /*--------------------------------------------------------*/
 //Profile Services
@@ -108,7 +110,7 @@ int test_profile_get_next_value(
     return -1;
 }
 
-const service_method_table_t test_services =
+const sai_service_method_table_t test_services =
 {
     test_profile_get_value,
     test_profile_get_next_value
@@ -118,6 +120,7 @@ const service_method_table_t test_services =
 // Global variables
 MacAddress mac;
 
+sai_object_id_t g_switch_id = SAI_NULL_OBJECT_ID;
 sai_object_id_t g_vr_id;
 unsigned int g_testcount = MAX_TEST;
 
@@ -126,6 +129,8 @@ IpAddress   g_ipAddr[MAX_PORT];
 IpAddress   g_ipMask[MAX_PORT];
 MacAddress  g_macAddr[MAX_PORT];
 sai_object_id_t g_rif_id[MAX_PORT];
+sai_object_id_t g_vlan_id[MAX_PORT];
+sai_object_id_t g_bridge_port_id[MAX_PORT];
 MacAddress  g_dst_mac[MAX_PORT];
 
 NextHopMgr* nexthop_mgr;
@@ -141,16 +146,21 @@ std::vector<sai_object_id_t> vlan_member_list;
 static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
                                    int port_count,
                                    const sai_object_id_t *port_list,
+                                   const sai_object_id_t *bridge_port_list,
                                    const MacAddress mac,
                                    const IpAddress ipaddr,
                                    const IpAddress ipmask,
+                                   sai_object_id_t &vlan_id,
                                    sai_object_id_t &rif_id)
 {
+    sai_attribute_t vlan_attr;
+    vlan_attr.id = SAI_VLAN_ATTR_VLAN_ID;
+    vlan_attr.value.u16 = vlanid;
 
     LOGG(TEST_INFO, SETL3, "sai_vlan_api->create_vlan, create vlan %hu.\n", vlanid);
-    sai_status_t status = sai_vlan_api->create_vlan(vlanid);
+    sai_status_t status = sai_vlan_api->create_vlan(&vlan_id, g_switch_id, 1, &vlan_attr);
 
-    if (status != SAI_STATUS_SUCCESS && status != SAI_STATUS_ITEM_ALREADY_EXISTS)
+    if (status != SAI_STATUS_SUCCESS)
     {
         LOGG(TEST_ERR, SETL3, "fail to create vlan %hu. status=0x%x\n", vlanid, -status);
         return false;
@@ -162,20 +172,22 @@ static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
     
     for (int i = 0; i < port_count; ++i)
     {
+        member_attrs.clear();
+
         member_attr.id = SAI_VLAN_MEMBER_ATTR_VLAN_ID;
-        member_attr.value.u16 = vlanid;
+        member_attr.value.oid = vlan_id;
         member_attrs.push_back(member_attr);
         
-        member_attr.id = SAI_VLAN_MEMBER_ATTR_PORT_ID;
-        member_attr.value.oid =  port_list[i];
+        member_attr.id = SAI_VLAN_MEMBER_ATTR_BRIDGE_PORT_ID;
+        member_attr.value.oid = bridge_port_list[i];
         member_attrs.push_back(member_attr);
 
-        member_attr.id = SAI_VLAN_MEMBER_ATTR_TAGGING_MODE;
-        member_attr.value.s32 = SAI_VLAN_PORT_UNTAGGED;
+        member_attr.id = SAI_VLAN_MEMBER_ATTR_VLAN_TAGGING_MODE;
+        member_attr.value.s32 = SAI_VLAN_TAGGING_MODE_UNTAGGED;
         member_attrs.push_back(member_attr);
 
         LOGG(TEST_INFO, SETL3, "sai_vlan_api->create_vlan_member, with vlan %d.\n", vlanid);
-        status = sai_vlan_api->create_vlan_member(&vlan_member_id, member_attrs.size(), member_attrs.data());
+        status = sai_vlan_api->create_vlan_member(&vlan_member_id, g_switch_id, member_attrs.size(), member_attrs.data());
         if (status != SAI_STATUS_SUCCESS)
         {
             LOGG(TEST_ERR, SETL3, "fail to create member vlan %hu. status=0x%x\n",  vlanid, -status);
@@ -218,11 +230,11 @@ static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
     rif_attrs.push_back(rif_attr);
 
     rif_attr.id = SAI_ROUTER_INTERFACE_ATTR_VLAN_ID;
-    rif_attr.value.u16 = vlanid;
+    rif_attr.value.oid = vlan_id;
     rif_attrs.push_back(rif_attr);
 
     LOGG(TEST_INFO, SETL3, "sai_rif_api->create_router_interface\n");
-    status = sai_rif_api->create_router_interface(&rif_id, rif_attrs.size(), rif_attrs.data());
+    status = sai_rif_api->create_router_interface(&rif_id, g_switch_id, rif_attrs.size(), rif_attrs.data());
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -239,16 +251,18 @@ static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
     LOGG(TEST_DEBUG, SETL3, "router_interface created, rif_id 0x%lx\n", rif_id);
 
     // add interface ip to l3 host table
-    LOGG(TEST_INFO, SETL3, "sai_route_api->create_route, SAI_ROUTE_ATTR_PACKET_ACTION, SAI_PACKET_ACTION_TRAP\n");
-    sai_unicast_route_entry_t unicast_route_entry;
-    unicast_route_entry.vr_id = g_vr_id;
-    unicast_route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    unicast_route_entry.destination.addr.ip4 = ipaddr.addr();
-    unicast_route_entry.destination.mask.ip4 = 0xffffffff;
+    LOGG(TEST_INFO, SETL3, "sai_route_api->create_route_entry, SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION, SAI_PACKET_ACTION_TRAP\n");
+    sai_route_entry_t route_entry;
+    memset(&route_entry, 0, sizeof(route_entry));
+    route_entry.switch_id = g_switch_id;
+    route_entry.vr_id = g_vr_id;
+    route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    route_entry.destination.addr.ip4 = ipaddr.addr();
+    route_entry.destination.mask.ip4 = 0xffffffff;
     sai_attribute_t route_attr;
-    route_attr.id = SAI_ROUTE_ATTR_PACKET_ACTION;
+    route_attr.id = SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION;
     route_attr.value.s32 = SAI_PACKET_ACTION_TRAP;
-    status = sai_route_api->create_route(&unicast_route_entry, 1, &route_attr);
+    status = sai_route_api->create_route_entry(&route_entry, 1, &route_attr);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -258,14 +272,14 @@ static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
 
     // by default, drop all the traffic destined to the the ip subnet.
     // if we learn some of the neighbors, add them explicitly to the l3 host table.
-    LOGG(TEST_INFO, SETL3, "sai_route_api->create_route, SAI_ROUTE_ATTR_PACKET_ACTION, SAI_PACKET_ACTION_DROP\n");
-    unicast_route_entry.vr_id = g_vr_id;
-    unicast_route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    unicast_route_entry.destination.addr.ip4 = ipaddr.addr() & ipmask.addr();
-    unicast_route_entry.destination.mask.ip4 = ipmask.addr();
-    route_attr.id = SAI_ROUTE_ATTR_PACKET_ACTION;
+    LOGG(TEST_INFO, SETL3, "sai_route_api->create_route_entry, SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION, SAI_PACKET_ACTION_DROP\n");
+    route_entry.vr_id = g_vr_id;
+    route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    route_entry.destination.addr.ip4 = ipaddr.addr() & ipmask.addr();
+    route_entry.destination.mask.ip4 = ipmask.addr();
+    route_attr.id = SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION;
     route_attr.value.s32 = SAI_PACKET_ACTION_DROP;
-    status = sai_route_api->create_route(&unicast_route_entry, 1, &route_attr);
+    status = sai_route_api->create_route_entry(&route_entry, 1, &route_attr);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -276,6 +290,123 @@ static bool setup_one_l3_interface(sai_vlan_id_t vlanid,
     return true;
 }
 
+//Trap packets of the given type to cpu, through the default host interface table entry
+static bool trap_to_cpu(sai_hostif_trap_type_t trap_type, const char *name)
+{
+    std::vector<sai_attribute_t> trap_attrs;
+    sai_attribute_t trap_attr;
+    sai_object_id_t trap_id;
+
+    trap_attr.id = SAI_HOSTIF_TRAP_ATTR_TRAP_TYPE;
+    trap_attr.value.s32 = trap_type;
+    trap_attrs.push_back(trap_attr);
+
+    trap_attr.id = SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION;
+    trap_attr.value.s32 = SAI_PACKET_ACTION_TRAP;
+    trap_attrs.push_back(trap_attr);
+
+    LOGG(TEST_INFO, SETL3, "sai_hif_api->create_hostif_trap SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION, %s\n", name);
+    sai_status_t status = sai_hif_api->create_hostif_trap(&trap_id, g_switch_id, trap_attrs.size(), trap_attrs.data());
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, SETL3, "fail to trap %s packets to cpu. status=0x%x\n", name, -status);
+        return false;
+    }
+
+    LOGG(TEST_DEBUG, SETL3, "set %s \n", name);
+    return true;
+}
+
+//Bridge port of each port on the default .1Q bridge, created when the switch has none
+static bool get_bridge_ports(sai_uint32_t port_count,
+                             const sai_object_id_t *port_list,
+                             sai_object_id_t *bridge_port_list)
+{
+    sai_attribute_t attr;
+    sai_status_t status;
+
+    attr.id = SAI_SWITCH_ATTR_DEFAULT_1Q_BRIDGE_ID;
+    status = sai_switch_api->get_switch_attribute(g_switch_id, 1, &attr);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, SETL3, "fail to get SAI_SWITCH_ATTR_DEFAULT_1Q_BRIDGE_ID %d", -status);
+        return false;
+    }
+
+    sai_object_id_t bridge_id = attr.value.oid;
+    std::vector<sai_object_id_t> bridge_ports(port_count);
+
+    attr.id = SAI_BRIDGE_ATTR_PORT_LIST;
+    attr.value.objlist.count = (uint32_t)bridge_ports.size();
+    attr.value.objlist.list = bridge_ports.data();
+    status = sai_bridge_api->get_bridge_attribute(bridge_id, 1, &attr);
+
+    if (status == SAI_STATUS_BUFFER_OVERFLOW)
+    {
+        bridge_ports.resize(attr.value.objlist.count);
+        attr.value.objlist.list = bridge_ports.data();
+        status = sai_bridge_api->get_bridge_attribute(bridge_id, 1, &attr);
+    }
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, SETL3, "fail to get SAI_BRIDGE_ATTR_PORT_LIST %d", -status);
+        return false;
+    }
+
+    bridge_ports.resize(attr.value.objlist.count);
+
+    std::map<sai_object_id_t, sai_object_id_t> port2bridge_port;
+
+    for (size_t i = 0; i < bridge_ports.size(); i++)
+    {
+        attr.id = SAI_BRIDGE_PORT_ATTR_PORT_ID;
+
+        // not a port type bridge port
+        if (sai_bridge_api->get_bridge_port_attribute(bridge_ports[i], 1, &attr) == SAI_STATUS_SUCCESS)
+        {
+            port2bridge_port[attr.value.oid] = bridge_ports[i];
+        }
+    }
+
+    for (sai_uint32_t i = 0; i < port_count; i++)
+    {
+        std::map<sai_object_id_t, sai_object_id_t>::const_iterator it = port2bridge_port.find(port_list[i]);
+
+        if (it != port2bridge_port.end())
+        {
+            bridge_port_list[i] = it->second;
+            continue;
+        }
+
+        std::vector<sai_attribute_t> bp_attrs;
+
+        attr.id = SAI_BRIDGE_PORT_ATTR_TYPE;
+        attr.value.s32 = SAI_BRIDGE_PORT_TYPE_PORT;
+        bp_attrs.push_back(attr);
+
+        attr.id = SAI_BRIDGE_PORT_ATTR_PORT_ID;
+        attr.value.oid = port_list[i];
+        bp_attrs.push_back(attr);
+
+        attr.id = SAI_BRIDGE_PORT_ATTR_ADMIN_STATE;
+        attr.value.booldata = true;
+        bp_attrs.push_back(attr);
+
+        LOGG(TEST_INFO, SETL3, "sai_bridge_api->create_bridge_port for port 0x%lx\n", port_list[i]);
+        status = sai_bridge_api->create_bridge_port(&bridge_port_list[i], g_switch_id, bp_attrs.size(), bp_attrs.data());
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, SETL3, "fail to create bridge port for port 0x%lx. status=0x%x\n", port_list[i], -status);
+            return false;
+        }
+    }
+
+    return true;
+}
 
 bool basic_router_setup()
 {
@@ -286,7 +417,7 @@ bool basic_router_setup()
 
     sai_attribute_t attr;
     attr.id = SAI_SWITCH_ATTR_PORT_NUMBER;
-    status = sai_switch_api->get_switch_attribute(1, &attr);
+    status = sai_switch_api->get_switch_attribute(g_switch_id, 1, &attr);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -308,7 +439,7 @@ bool basic_router_setup()
     attr.id = SAI_SWITCH_ATTR_PORT_LIST;
     attr.value.objlist.count = port_count;
     attr.value.objlist.list = port_list;
-    status = sai_switch_api->get_switch_attribute(1, &attr);
+    status = sai_switch_api->get_switch_attribute(g_switch_id, 1, &attr);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -316,6 +447,17 @@ bool basic_router_setup()
         return false;
     }
 
+    if (port_count > MAX_PORT)
+    {
+        port_count = MAX_PORT;
+        g_testcount = port_count;
+    }
+
+    if (!get_bridge_ports(port_count, port_list, g_bridge_port_id))
+    {
+        return false;
+    }
+
    
     unsigned int i = 0;
     sai_object_id_t vlan_member_id;
@@ -337,88 +479,17 @@ bool basic_router_setup()
         }
         vlan_member_list.pop_back();
     }
-    LOGG(TEST_INFO, SETL3, "sai_hif_api->set_trap_attribute SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION, TTL_ERROR\n");
-    attr.id = SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION;
-    attr.value.s32 = SAI_PACKET_ACTION_TRAP;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_TTL_ERROR, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to trap ttl=1 packets to cpu. status=0x%x\n", -status);
-        return false;
-    }
-    attr.id = SAI_HOSTIF_TRAP_ATTR_TRAP_CHANNEL;
-    attr.value.s32 = SAI_HOSTIF_TRAP_CHANNEL_NETDEV;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_TTL_ERROR, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to set trap channel for SAI_HOSTIF_TRAP_ID_TTL_ERROR. status=0x%x\n", -status);
-        return false;
-    }
-    LOGG(TEST_DEBUG, SETL3, "set SAI_HOSTIF_TRAP_ID_TTL_ERROR \n");
-
-
-    LOGG(TEST_INFO, SETL3, "sai_hif_api->set_trap_attribute SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION, ARP_REQUEST\n");
-    attr.id = SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION;
-    attr.value.s32 = SAI_PACKET_ACTION_TRAP;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_ARP_REQUEST, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to trap arp request packets to cpu. status=0x%x\n", -status);
-        return false;
-    }
-    attr.id = SAI_HOSTIF_TRAP_ATTR_TRAP_CHANNEL;
-    attr.value.s32 = SAI_HOSTIF_TRAP_CHANNEL_NETDEV;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_ARP_REQUEST, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to set trap channel for SAI_HOSTIF_TRAP_ID_ARP_REQUEST. status=0x%x\n", -status);
-        return false;
-    }
-    LOGG(TEST_DEBUG, SETL3, "set SAI_HOSTIF_TRAP_ID_ARP_REQUEST \n");
-
-
-    LOGG(TEST_INFO, SETL3, "sai_hif_api->set_trap_attribute SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION, ARP_RESPONSE\n");
-    attr.id = SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION;
-    attr.value.s32 = SAI_PACKET_ACTION_TRAP;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_ARP_RESPONSE, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to trap arp reply packets to cpu. status=0x%x\n", -status);
-        return false;
-    }
-    attr.id = SAI_HOSTIF_TRAP_ATTR_TRAP_CHANNEL;
-    attr.value.s32 = SAI_HOSTIF_TRAP_CHANNEL_NETDEV;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_ARP_RESPONSE, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to set trap channel for SAI_HOSTIF_TRAP_ID_ARP_RESPONSE. status=0x%x\n", -status);
-        return false;
-    }
-    LOGG(TEST_DEBUG, SETL3, "set SAI_HOSTIF_TRAP_ID_ARP_RESPONSE \n");
-
-
-    LOGG(TEST_INFO, SETL3, "sai_hif_api->set_trap_attribute SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION, LLDP\n");
-    attr.id = SAI_HOSTIF_TRAP_ATTR_PACKET_ACTION;
-    attr.value.s32 = SAI_PACKET_ACTION_TRAP;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_LLDP, &attr);
-    if (status != SAI_STATUS_SUCCESS)
-    {
-        LOGG(TEST_ERR, SETL3, "fail to trap lldp packets to cpu. status=0x%x\n", -status);
-        return false;
-    }
-    attr.id = SAI_HOSTIF_TRAP_ATTR_TRAP_CHANNEL;
-    attr.value.s32 = SAI_HOSTIF_TRAP_CHANNEL_NETDEV;
-    status = sai_hif_api->set_trap_attribute(SAI_HOSTIF_TRAP_ID_LLDP, &attr);
-    if (status != SAI_STATUS_SUCCESS)
+    if (!trap_to_cpu(SAI_HOSTIF_TRAP_TYPE_TTL_ERROR, "TTL_ERROR") ||
+            !trap_to_cpu(SAI_HOSTIF_TRAP_TYPE_ARP_REQUEST, "ARP_REQUEST") ||
+            !trap_to_cpu(SAI_HOSTIF_TRAP_TYPE_ARP_RESPONSE, "ARP_RESPONSE") ||
+            !trap_to_cpu(SAI_HOSTIF_TRAP_TYPE_LLDP, "LLDP"))
     {
-        LOGG(TEST_ERR, SETL3, "fail to set trap channel for SAI_HOSTIF_TRAP_ID_LLDP. status=0x%x\n", -status);
         return false;
     }
-    LOGG(TEST_DEBUG, SETL3, "set SAI_HOSTIF_TRAP_ID_LLDP \n");
 
 
     LOGG(TEST_INFO, SETL3, "sai_vr_api->create_virtual_router\n");
-    status = sai_vr_api->create_virtual_router(&g_vr_id, 0, NULL);
+    status = sai_vr_api->create_virtual_router(&g_vr_id, g_switch_id, 0, NULL);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -436,7 +507,7 @@ bool basic_router_setup()
 
 
     LOGG(TEST_INFO, SETL3, "for each port, sai_port_api->set_port_attribute SAI_PORT_ATTR_ADMIN_STATE true\n");
-    LOGG(TEST_INFO, SETL3, "for each port, sai_port_api->set_port_attribute, SAI_PORT_ATTR_FDB_LEARNING, SAI_PORT_LEARN_MODE_HW\n");
+    LOGG(TEST_INFO, SETL3, "for each port, sai_bridge_api->set_bridge_port_attribute, SAI_BRIDGE_PORT_ATTR_FDB_LEARNING_MODE, SAI_BRIDGE_PORT_FDB_LEARNING_MODE_HW\n");
 
     for (i = 0; i < port_count; i++)
     {
@@ -450,9 +521,9 @@ bool basic_router_setup()
             return false;
         }
 
-        attr.id = SAI_PORT_ATTR_FDB_LEARNING;
-        attr.value.s32 = SAI_PORT_LEARN_MODE_HW;
-        status = sai_port_api->set_port_attribute(port_list[i], &attr);
+        attr.id = SAI_BRIDGE_PORT_ATTR_FDB_LEARNING_MODE;
+        attr.value.s32 = SAI_BRIDGE_PORT_FDB_LEARNING_MODE_HW;
+        status = sai_bridge_api->set_bridge_port_attribute(g_bridge_port_id[i], &attr);
 
         if (status != SAI_STATUS_SUCCESS)
         {
@@ -480,6 +551,7 @@ bool basic_router_setup()
              g_macAddr[i].to_string().c_str()
             );
         std::vector<sai_object_id_t> port_objlist;
+        std::vector<sai_object_id_t> bridge_port_objlist;
         long unsigned int vlanid;
         sai_attribute_t attr;
         std::vector<sai_attribute_t> attr_list;
@@ -488,9 +560,10 @@ bool basic_router_setup()
         vlanid = PANEL_PORT_VLAN_START + i + 1;
 
         port_objlist.push_back(port_list[i]);
+        bridge_port_objlist.push_back(g_bridge_port_id[i]);
 
-        if (!setup_one_l3_interface(vlanid, port_objlist.size(), port_objlist.data(),
-                                    g_macAddr[i], g_ipAddr[i], g_ipMask[i], g_rif_id[i]))
+        if (!setup_one_l3_interface(vlanid, port_objlist.size(), port_objlist.data(), bridge_port_objlist.data(),
+                                    g_macAddr[i], g_ipAddr[i], g_ipMask[i], g_vlan_id[i], g_rif_id[i]))
         {
             LOGG(TEST_ERR, SETL3, "fail to setup l3 interface for %s\n", g_intfAlias[i].c_str());
             return false;
@@ -503,17 +576,18 @@ bool basic_router_setup()
         attr.value.s32 = SAI_HOSTIF_TYPE_NETDEV;
         attr_list.push_back(attr);
 
-        attr.id = SAI_HOSTIF_ATTR_RIF_OR_PORT_ID;
+        attr.id = SAI_HOSTIF_ATTR_OBJ_ID;
         attr.value.oid = port_list[i];
         attr_list.push_back(attr);
 
         attr.id = SAI_HOSTIF_ATTR_NAME;
-        strncpy((char *)&attr.value.chardata, g_intfAlias[i].c_str(), HOSTIF_NAME_SIZE);
+        strncpy((char *)&attr.value.chardata, g_intfAlias[i].c_str(), SAI_HOSTIF_NAME_SIZE - 1);
+        attr.value.chardata[SAI_HOSTIF_NAME_SIZE - 1] = '\0';
         attr_list.push_back(attr);
 
         LOGG(TEST_INFO, SETL3, "sai_hif_api->create_hostif name %s\n", g_intfAlias[i].c_str());
         sai_object_id_t hif_id;
-        status = sai_hif_api->create_hostif(&hif_id, attr_list.size(), attr_list.data());
+        status = sai_hif_api->create_hostif(&hif_id, g_switch_id, attr_list.size(), attr_list.data());
 
         if (status != SAI_STATUS_SUCCESS)
         {
@@ -522,7 +596,7 @@ bool basic_router_setup()
             return false;
         }
 
-        if (!SAI_OID_TYPE_CHECK(hif_id, SAI_OBJECT_TYPE_HOST_INTERFACE))
+        if (!SAI_OID_TYPE_CHECK(hif_id, SAI_OBJECT_TYPE_HOSTIF))
         {
             LOGG(TEST_ERR, SETL3, "host interface oid generated is not the right type\n");
             return false;
@@ -543,12 +617,14 @@ bool basic_router_setup()
 
     for (i = 0; i < g_testcount; i++)
     {
-        if (! fdb_mgr->Add(g_dst_mac[i], PANEL_PORT_VLAN_START + i + 1,
-                           SAI_FDB_ENTRY_STATIC, port_list[i], SAI_PACKET_ACTION_FORWARD))
+        // bv_id is the vlan object of the interface, the entry points to
+        // the bridge port of the panel port
+        if (! fdb_mgr->Add(g_dst_mac[i], g_vlan_id[i],
+                           SAI_FDB_ENTRY_TYPE_STATIC, g_bridge_port_id[i], SAI_PACKET_ACTION_FORWARD))
         {
 
-            LOGG(TEST_ERR, SETL3, "fail to create sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-                 g_dst_mac[i].to_string().c_str(), PANEL_PORT_VLAN_START + i + 1);
+            LOGG(TEST_ERR, SETL3, "fail to create sai_fdb_entry {mac %-15s vlan_id %hu bv_id 0x%lx bridge_port_id 0x%lx}\n",
+                 g_dst_mac[i].to_string().c_str(), PANEL_PORT_VLAN_START + i + 1, g_vlan_id[i], g_bridge_port_id[i]);
             return false;
         }
     }
@@ -572,7 +648,7 @@ protected:
 
         LOGG(TEST_INFO, FRAMEWORK, "sai_api_initialize\n");
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_api_initialize(0, (service_method_table_t *)&test_services));
+                  sai_api_initialize(0, &test_services));
 
         LOGG(TEST_INFO, FRAMEWORK, "sai_api_query SAI_API_SWITCH, SAI_API_PORT, ...\n");
         //query API methods of all types
@@ -597,7 +673,7 @@ protected:
         ASSERT_TRUE(sai_rif_api != NULL);
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_api_query(SAI_API_HOST_INTERFACE, (void**)&sai_hif_api));
+                  sai_api_query(SAI_API_HOSTIF, (void**)&sai_hif_api));
         ASSERT_TRUE(sai_hif_api != NULL);
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
@@ -621,49 +697,56 @@ protected:
                                 (void**)&sai_fdb_api));
         ASSERT_TRUE(sai_fdb_api != NULL);
 
+        ASSERT_EQ(SAI_STATUS_SUCCESS,
+                  sai_api_query(SAI_API_BRIDGE,
+                                (void**)&sai_bridge_api));
+        ASSERT_TRUE(sai_bridge_api != NULL);
+
 
         LOGG(TEST_INFO, FRAMEWORK, "sai_log_set SAI_API_SWITCH, SAI_API_PORT, ...\n");
         //set log
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_SWITCH, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_SWITCH, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_PORT, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_PORT, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_VLAN, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_VLAN, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_VIRTUAL_ROUTER, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_VIRTUAL_ROUTER, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_ROUTER_INTERFACE, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_ROUTER_INTERFACE, SAI_LOG_LEVEL_DEBUG));
 
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_HOST_INTERFACE, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_HOSTIF, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_NEIGHBOR, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_NEIGHBOR, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_ROUTE, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_ROUTE, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_NEXT_HOP, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_NEXT_HOP, SAI_LOG_LEVEL_DEBUG));
 
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_log_set(SAI_API_NEXT_HOP_GROUP, SAI_LOG_DEBUG));
+                  sai_log_set(SAI_API_NEXT_HOP_GROUP, SAI_LOG_LEVEL_DEBUG));
 
 
-        LOGG(TEST_INFO, FRAMEWORK, "sai_switch_api->initialize_switch \n");
-        ASSERT_TRUE(sai_switch_api->initialize_switch);
-        ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_switch_api->initialize_switch(0, "0xb850", "",
-                          &plat_switch_notification_handlers));
+        sai_attribute_t     attr;
+
+        attr.id = SAI_SWITCH_ATTR_INIT_SWITCH;
+        attr.value.booldata = true;
 
+        LOGG(TEST_INFO, FRAMEWORK, "sai_switch_api->create_switch \n");
+        ASSERT_TRUE(sai_switch_api->create_switch != NULL);
+        ASSERT_EQ(SAI_STATUS_SUCCESS,
+                  sai_switch_api->create_switch(&g_switch_id, 1, &attr));
 
-        sai_attribute_t     attr;
 
         attr.id = SAI_SWITCH_ATTR_SRC_MAC_ADDRESS;
         memcpy(attr.value.mac, mac.to_bytes(), 6);
@@ -672,7 +755,7 @@ protected:
         LOGG(TEST_INFO, FRAMEWORK, "sai_switch_api->set_switch_attribute SAI_SWITCH_ATTR_SRC_MAC_ADDRESS %s\n",
              mac.to_string().c_str());
         ASSERT_EQ(SAI_STATUS_SUCCESS,
-                  sai_switch_api->set_switch_attribute(&attr));
+                  sai_switch_api->set_switch_attribute(g_switch_id, &attr));
 
         LOGG(TEST_INFO, FRAMEWORK, "Create neighbor_mgr, nexthopgrp_mgr and route_mgr\n");
 
@@ -832,9 +915,9 @@ static void route_adding()
     nexthops = IpAddresses("172.16.20.22");
     ASSERT_TRUE(route_mgr->Add(prefix, nexthops));
 
-    LOGG(TEST_INFO, TESTCASE, "--- add 3rd route, \"0.0.0.0\" as nexthop---\n");
+    LOGG(TEST_INFO, TESTCASE, "--- add 3rd route, blackhole---\n");
     prefix = IpPrefix("182.30.31.199/24");
-    nexthops = IpAddresses("0.0.0.0");
+    nexthops = IpAddresses();
     ASSERT_TRUE(route_mgr->Add(prefix, nexthops));
 
 
@@ -872,7 +955,7 @@ static void route_removing()
     prefix = IpPrefix("192.168.0.0/16");
     ASSERT_TRUE(route_mgr->Del(prefix));
 
-    LOGG(TEST_INFO, TESTCASE, "--- remove route 182.30.31.199/24 with nexthop as \"0.0.0.0\" ---\n");
+    LOGG(TEST_INFO, TESTCASE, "--- remove route 182.30.31.199/24 blackhole ---\n");
     prefix = IpPrefix("182.30.31.199/24");
     ASSERT_TRUE(route_mgr->Del(prefix));
 
@@ -909,20 +992,480 @@ TEST_F(saiUnitTest, route_unittest)
     neighbor_mgr->Show();
 }
 
+static void route_bulk_test()
+{
+    neighbor_adding();
+
+    RouteBatch routes;
+    std::vector<IpPrefix> prefixes;
+    IpAddresses nexthops[3];
+    char prefixStr[32];
+
+    nexthops[0] = IpAddresses("192.168.1.1");
+    nexthops[1] = IpAddresses("192.168.2.1,192.169.3.1");
+    nexthops[2] = IpAddresses();
+
+    for (uint32_t i = 0; i < BULK_ROUTE_COUNT; i++)
+    {
+        snprintf(prefixStr, sizeof(prefixStr), "10.%u.%u.%u/32", (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF);
+        routes.push_back(std::make_pair(IpPrefix(prefixStr), nexthops[i % 3]));
+        prefixes.push_back(routes.back().first);
+    }
+
+    route_mgr->SetBulkChunkSize(BULK_ROUTE_CHUNK_SIZE);
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add %u routes, %u per chunk ---\n", BULK_ROUTE_COUNT, BULK_ROUTE_CHUNK_SIZE);
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+    route_mgr->ShowECMP();
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add the same routes again, updated through set ---\n");
+    routes.resize(BULK_ROUTE_CHUNK_SIZE);
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk remove %u routes ---\n", BULK_ROUTE_COUNT);
+    ASSERT_TRUE(route_mgr->DelBatch(prefixes));
+    route_mgr->ShowECMP();
+
+    route_mgr->SetBulkChunkSize(ROUTE_BULK_CHUNK_SIZE_DEFAULT);
+}
+
+TEST_F(saiUnitTest, route_bulk_unittest)
+{
+    route_bulk_test();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+static void route_ipv6_test()
+{
+    RouteBatch routes;
+    std::vector<IpPrefix> prefixes;
+    IpAddresses nexthops[3];
+    char prefixStr[64];
+
+    LOGG(TEST_INFO, TESTCASE, "--- add IPv6 neighbor entries fc00::1 and fc00::2 ---\n");
+    ASSERT_TRUE(neighbor_mgr->Add(IpAddress("fc00::1"), g_dst_mac[0], g_intfAlias[0], g_rif_id[0]));
+    ASSERT_TRUE(neighbor_mgr->Add(IpAddress("fc00::2"), g_dst_mac[1], g_intfAlias[1], g_rif_id[1]));
+    neighbor_mgr->Show();
+
+    nexthops[0] = IpAddresses("fc00::1");
+    nexthops[1] = IpAddresses("fc00::1,fc00::2");
+    nexthops[2] = IpAddresses();
+
+    for (uint32_t i = 0; i < IPV6_ROUTE_COUNT; i++)
+    {
+        snprintf(prefixStr, sizeof(prefixStr), "2001:db8:%x:%x::/64", i >> 16, i & 0xFFFF);
+        routes.push_back(std::make_pair(IpPrefix(prefixStr), nexthops[i % 3]));
+        prefixes.push_back(routes.back().first);
+    }
+
+    LOGG(TEST_INFO, TESTCASE, "--- add IPv6 covering route 2001:db8::/32 and default route ::/0 ---\n");
+    ASSERT_TRUE(route_mgr->Add(IpPrefix("2001:db8::/32"), nexthops[1]));
+    ASSERT_TRUE(route_mgr->Add(IpPrefix("::/0"), nexthops[2]));
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add %u IPv6 /64 routes ---\n", IPV6_ROUTE_COUNT);
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+    route_mgr->ShowECMP();
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk remove %u IPv6 /64 routes ---\n", IPV6_ROUTE_COUNT);
+    ASSERT_TRUE(route_mgr->DelBatch(prefixes));
+
+    ASSERT_TRUE(route_mgr->Del(IpPrefix("2001:db8::/32")));
+    ASSERT_TRUE(route_mgr->Del(IpPrefix("::/0")));
+    route_mgr->Show();
+}
+
+TEST_F(saiUnitTest, route_ipv6_unittest)
+{
+    route_ipv6_test();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+static void route_multi_vrf_test(sai_object_id_t *vr_ids)
+{
+    RouteBatch routes;
+    char prefixStr[32];
+
+    for (int v = 0; v < VRF_COUNT; v++)
+    {
+        LOGG(TEST_INFO, SETL3, "sai_vr_api->create_virtual_router\n");
+        ASSERT_EQ(SAI_STATUS_SUCCESS, sai_vr_api->create_virtual_router(&vr_ids[v], g_switch_id, 0, NULL));
+    }
+
+    // the same prefixes in every VRF, dropped in the extra VRFs which have
+    // no neighbors of their own
+    for (uint32_t i = 0; i < VRF_ROUTE_COUNT; i++)
+    {
+        snprintf(prefixStr, sizeof(prefixStr), "172.%u.%u.0/24", 16 + (i >> 8), i & 0xFF);
+        routes.push_back(std::make_pair(IpPrefix(prefixStr), IpAddresses()));
+    }
+
+    neighbor_adding();
+
+    LOGG(TEST_INFO, TESTCASE, "--- nexthop 192.168.1.1 is not resolved outside the default VRF ---\n");
+    ASSERT_FALSE(route_mgr->Add(vr_ids[0], IpPrefix("10.1.0.0/16"), IpAddresses("192.168.1.1")));
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add %u routes in %u VRFs ---\n", VRF_ROUTE_COUNT, VRF_COUNT + 1);
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+
+    for (int v = 0; v < VRF_COUNT; v++)
+    {
+        ASSERT_TRUE(route_mgr->AddBatch(vr_ids[v], routes));
+    }
+
+    LOGG(TEST_INFO, TESTCASE, "--- same prefix, different nexthop in the default VRF ---\n");
+    routes.resize(1);
+    routes[0].second = IpAddresses("192.168.2.1,192.169.3.1");
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+    route_mgr->ShowECMP();
+
+    LOGG(TEST_INFO, TESTCASE, "--- remove route %s in the first VRF only ---\n", routes[0].first.to_string().c_str());
+    ASSERT_TRUE(route_mgr->Del(vr_ids[0], routes[0].first));
+}
+
+TEST_F(saiUnitTest, route_multi_vrf_unittest)
+{
+    sai_object_id_t vr_ids[VRF_COUNT];
+
+    route_multi_vrf_test(vr_ids);
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    route_mgr->ShowECMP();
+
+    for (int v = 0; v < VRF_COUNT; v++)
+    {
+        LOGG(TEST_INFO, SETL3, "sai_vr_api->remove_virtual_router\n");
+        ASSERT_EQ(SAI_STATUS_SUCCESS, sai_vr_api->remove_virtual_router(vr_ids[v]));
+    }
+}
+
+static void route_flap_test()
+{
+    neighbor_adding();
+
+    RouteBatch routes;
+    std::vector<IpPrefix> prefixes;
+    IpAddresses nexthops("192.168.2.1,192.169.3.1,24.58.202.118");
+    IpAddresses degraded("192.168.2.1,192.169.3.1");
+    char prefixStr[32];
+
+    for (uint32_t i = 0; i < FLAP_ROUTE_COUNT; i++)
+    {
+        snprintf(prefixStr, sizeof(prefixStr), "%u.%u.%u.0/24", 20 + (i >> 16), (i >> 8) & 0xFF, i & 0xFF);
+        routes.push_back(std::make_pair(IpPrefix(prefixStr), nexthops));
+        prefixes.push_back(routes.back().first);
+    }
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add %u routes sharing one ECMP group ---\n", FLAP_ROUTE_COUNT);
+    ASSERT_TRUE(route_mgr->AddBatch(routes));
+    route_mgr->ShowECMP();
+
+    const NextHopGrpEntry *nhgEntry = nexthopgrp_mgr->GetNextHopGrpEntry(nexthops);
+    ASSERT_TRUE(nhgEntry != NULL);
+    ASSERT_EQ(1u, nhgEntry->refCount);
+    sai_object_id_t nhg_id = nhgEntry->nhg_id;
+
+    LOGG(TEST_INFO, TESTCASE, "--- nexthop 24.58.202.118 goes down ---\n");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(route_mgr->ChangeNextHops(nexthops, degraded));
+    double downMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    nhgEntry = nexthopgrp_mgr->GetNextHopGrpEntry(degraded);
+    ASSERT_TRUE(nhgEntry != NULL);
+    ASSERT_EQ(nhg_id, nhgEntry->nhg_id);
+    ASSERT_EQ(2u, nhgEntry->members.size());
+
+    LOGG(TEST_INFO, TESTCASE, "--- nexthop 24.58.202.118 comes back ---\n");
+    start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(route_mgr->ChangeNextHops(degraded, nexthops));
+    double upMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(3u, nexthopgrp_mgr->GetNextHopGrpEntry(nexthops)->members.size());
+
+    LOGG(TEST_INFO, TESTCASE, "--- flap converged for %u routes: down %.3f ms, up %.3f ms ---\n",
+         FLAP_ROUTE_COUNT, downMs, upMs);
+
+    LOGG(TEST_INFO, TESTCASE, "--- the group is shared, the routes are moved to a new group ---\n");
+    ASSERT_TRUE(nexthopgrp_mgr->Add(nexthops));
+    start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(route_mgr->ChangeNextHops(nexthops, degraded));
+    double moveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_TRUE(nexthopgrp_mgr->GetNextHopGrpEntry(degraded)->nhg_id != nhg_id);
+    ASSERT_TRUE(nexthopgrp_mgr->Del(nexthops));
+    ASSERT_TRUE(nexthopgrp_mgr->GetNextHopGrpEntry(nexthops) == NULL);
+
+    LOGG(TEST_INFO, TESTCASE, "--- moved %u routes in %.3f ms ---\n", FLAP_ROUTE_COUNT, moveMs);
+
+    ASSERT_TRUE(route_mgr->DelBatch(prefixes));
+    ASSERT_TRUE(nexthopgrp_mgr->GetNextHopGrpEntry(degraded) == NULL);
+}
+
+TEST_F(saiUnitTest, route_flap_unittest)
+{
+    route_flap_test();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+// full table sized RIB dump, unless BASIC_ROUTER_RIB names one to load
+static void route_rib_load_test()
+{
+    neighbor_adding();
+
+    std::string path;
+    const char *rib = getenv("BASIC_ROUTER_RIB");
+    char tmpl[] = "/tmp/basic_router_rib_XXXXXX";
+
+    if (rib)
+    {
+        path = rib;
+    }
+    else
+    {
+        const char *nexthops[] =
+        {
+            "192.168.1.1",
+            "192.168.2.1,192.169.3.1",
+            "192.168.2.1,192.169.3.1,24.58.202.118",
+            RIB_NEXTHOP_DROP,
+        };
+
+        int fd = mkstemp(tmpl);
+        ASSERT_TRUE(fd >= 0);
+
+        FILE *fp = fdopen(fd, "w");
+        ASSERT_TRUE(fp != NULL);
+
+        fprintf(fp, "# prefix nexthop[,nexthop...]\n");
+
+        for (uint32_t i = 0; i < RIB_ROUTE_COUNT; i++)
+        {
+            fprintf(fp, "%u.%u.%u.0/24 %s\n", 20 + (i >> 16), (i >> 8) & 0xFF, i & 0xFF, nexthops[i % 4]);
+        }
+
+        fclose(fp);
+        path = tmpl;
+    }
+
+    RibLoader loader(route_mgr);
+    RibLoadStats stats;
+
+    LOGG(TEST_INFO, TESTCASE, "--- load RIB %s ---\n", path.c_str());
+    bool ok = loader.Load(path, stats);
+    RibLoader::Show(stats);
+
+    if (!rib)
+    {
+        unlink(tmpl);
+        ASSERT_EQ((size_t)RIB_ROUTE_COUNT, stats.routes);
+    }
+
+    ASSERT_TRUE(ok);
+    route_mgr->ShowECMP();
+}
+
+TEST_F(saiUnitTest, route_rib_load_unittest)
+{
+    route_rib_load_test();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+// profile from BASIC_ROUTER_CHURN ("routes=..,updates=..,rate=.."), the
+// JSON report goes to BASIC_ROUTER_CHURN_JSON when it is set
+static void route_churn_bench()
+{
+    neighbor_adding();
+
+    ChurnProfile profile;
+    ChurnResult result;
+    const char *env = getenv("BASIC_ROUTER_CHURN");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    RouteBench bench(route_mgr, neighbor_mgr);
+
+    LOGG(TEST_INFO, TESTCASE, "--- churn %u updates over %u routes ---\n", profile.updates, profile.routes);
+    bool ok = bench.Run(profile, result);
+    RouteBench::Show(result);
+
+    std::string json = RouteBench::ToJson(profile, result);
+    const char *jsonPath = getenv("BASIC_ROUTER_CHURN_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        LOGG(TEST_INFO, TESTCASE, "%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+}
+
+TEST_F(saiUnitTest, route_churn_bench)
+{
+    route_churn_bench();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+// routes arriving before their neighbors wait in NeighborMgr and are
+// programmed by the neighbor batch which resolves them
+static void neighbor_resolution_test()
+{
+    NeighborBatch neighbors;
+    NeighborEntry nbEntry;
+    IpAddresses single("192.168.1.1");
+    IpAddresses ecmp("192.168.2.1,192.169.3.1");
+
+    LOGG(TEST_INFO, TESTCASE, "--- add routes before their neighbors ---\n");
+    ASSERT_FALSE(route_mgr->Add(IpPrefix("10.10.0.0/16"), single));
+    ASSERT_FALSE(route_mgr->Add(IpPrefix("10.11.0.0/16"), single));
+    ASSERT_EQ(2u, route_mgr->GetPendingCount());
+    ASSERT_TRUE(neighbor_mgr->GetPending(g_vr_id, IpAddress("192.168.1.1")) != NULL);
+
+    LOGG(TEST_INFO, TESTCASE, "--- ECMP route with one nexthop resolved ---\n");
+    ASSERT_TRUE(neighbor_mgr->Add(IpAddress("192.168.2.1"), g_dst_mac[2], g_intfAlias[2], g_rif_id[2]));
+    ASSERT_TRUE(route_mgr->Add(IpPrefix("10.12.0.0/16"), ecmp));
+    ASSERT_TRUE(nexthopgrp_mgr->GetNextHopGrpEntry(ecmp) == NULL);
+    ASSERT_TRUE(neighbor_mgr->GetPending(g_vr_id, IpAddress("192.169.3.1")) != NULL);
+
+    LOGG(TEST_INFO, TESTCASE, "--- resolve the remaining neighbors in one batch ---\n");
+    nbEntry.macAddr = g_dst_mac[0];
+    nbEntry.intfAlias = g_intfAlias[0];
+    nbEntry.rif_id = g_rif_id[0];
+    neighbors.push_back(std::make_pair(IpAddress("192.168.1.1"), nbEntry));
+
+    nbEntry.macAddr = g_dst_mac[3];
+    nbEntry.intfAlias = g_intfAlias[3];
+    nbEntry.rif_id = g_rif_id[3];
+    neighbors.push_back(std::make_pair(IpAddress("192.169.3.1"), nbEntry));
+
+    ASSERT_TRUE(neighbor_mgr->AddBatch(g_vr_id, neighbors));
+    route_mgr->ShowECMP();
+
+    ASSERT_EQ(0u, route_mgr->GetPendingCount());
+    ASSERT_TRUE(neighbor_mgr->GetPending(g_vr_id, IpAddress("192.168.1.1")) == NULL);
+    ASSERT_TRUE(neighbor_mgr->GetPending(g_vr_id, IpAddress("192.169.3.1")) == NULL);
+
+    const NextHopGrpEntry *nhgEntry = nexthopgrp_mgr->GetNextHopGrpEntry(ecmp);
+    ASSERT_TRUE(nhgEntry != NULL);
+    ASSERT_EQ(2u, nhgEntry->members.size());
+
+    LOGG(TEST_INFO, TESTCASE, "--- a waiting route which is removed stops waiting ---\n");
+    ASSERT_FALSE(route_mgr->Add(IpPrefix("10.13.0.0/16"), IpAddresses("10.99.0.1")));
+    ASSERT_TRUE(route_mgr->Del(IpPrefix("10.13.0.0/16")));
+    ASSERT_EQ(0u, route_mgr->GetPendingCount());
+    ASSERT_TRUE(neighbor_mgr->GetPending(g_vr_id, IpAddress("10.99.0.1")) == NULL);
+}
+
+TEST_F(saiUnitTest, neighbor_resolution_unittest)
+{
+    neighbor_resolution_test();
+
+    ASSERT_TRUE(route_mgr->EraseAll());
+    ASSERT_TRUE(neighbor_mgr->EraseAll());
+    neighbor_mgr->Show();
+}
+
+// spread over the VLAN/port pairs of the static entries the setup made
+static void fdb_scale_test()
+{
+    std::vector<FdbEntry> entries;
+    std::vector<FdbKey> keys;
+    std::vector<FdbEntry> pairs;
+    size_t baseline = fdb_mgr->Size();
+
+    for (unsigned int i = 0; i < g_testcount; i++)
+    {
+        const FdbEntry *fdbEntry = fdb_mgr->GetFdbEntry(g_dst_mac[i], g_vlan_id[i]);
+        ASSERT_TRUE(fdbEntry != NULL);
+        pairs.push_back(*fdbEntry);
+    }
+
+    for (uint32_t i = 0; i < FDB_SCALE_COUNT; i++)
+    {
+        uint8_t mac[6] = { 0x00, 0x10, 0x00, (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i };
+        FdbEntry fdbEntry = pairs[i % pairs.size()];
+
+        fdbEntry.macAddr = MacAddress(mac);
+        entries.push_back(fdbEntry);
+        keys.push_back(FdbKey(fdbEntry.macAddr, fdbEntry.bv_id));
+    }
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk add %u fdb entries ---\n", FDB_SCALE_COUNT);
+    ASSERT_TRUE(fdb_mgr->AddBatch(entries));
+    ASSERT_EQ(baseline + FDB_SCALE_COUNT, fdb_mgr->Size());
+    ASSERT_TRUE(fdb_mgr->GetFdbEntry(entries[7].macAddr, entries[7].bv_id) != NULL);
+
+    LOGG(TEST_INFO, TESTCASE, "--- flush port 0x%lx ---\n", pairs[0].port_id);
+    size_t before = fdb_mgr->Size();
+    ASSERT_TRUE(fdb_mgr->Flush(pairs[0].port_id, SAI_NULL_OBJECT_ID));
+    ASSERT_TRUE(fdb_mgr->Size() < before);
+    ASSERT_TRUE(fdb_mgr->GetFdbEntry(entries[0].macAddr, entries[0].bv_id) == NULL);
+
+    if (pairs.size() > 1)
+    {
+        LOGG(TEST_INFO, TESTCASE, "--- flush bv_id 0x%lx ---\n", pairs[1].bv_id);
+        before = fdb_mgr->Size();
+        ASSERT_TRUE(fdb_mgr->Flush(SAI_NULL_OBJECT_ID, pairs[1].bv_id));
+        ASSERT_TRUE(fdb_mgr->Size() < before);
+        ASSERT_TRUE(fdb_mgr->GetFdbEntry(entries[1].macAddr, entries[1].bv_id) == NULL);
+    }
+
+    LOGG(TEST_INFO, TESTCASE, "--- bulk remove the remaining entries ---\n");
+    ASSERT_TRUE(fdb_mgr->DelBatch(keys));
+
+    // the flushes took the setup entries of the two pairs as well
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        ASSERT_TRUE(fdb_mgr->Add(pairs[i].macAddr, pairs[i].bv_id, pairs[i].type,
+                                 pairs[i].port_id, pairs[i].pkt_action));
+    }
+
+    ASSERT_EQ(baseline, fdb_mgr->Size());
+    fdb_mgr->Show();
+}
+
+TEST_F(saiUnitTest, fdb_scale_unittest)
+{
+    fdb_scale_test();
+}
+
 static void tearup_tests(void)
 {
 
     int i = 1;
     fdb_mgr->Show();
-    fdb_mgr->Del(g_dst_mac[i], PANEL_PORT_VLAN_START + i + 1);
+    fdb_mgr->Del(g_dst_mac[i], g_vlan_id[i]);
     fdb_mgr->Show();
 
     fdb_mgr->EraseAll();
     fdb_mgr->Show();
 
-    LOGG(TEST_INFO, FRAMEWORK, "sai_switch_api->shutdown_switch\n");
-    ASSERT_TRUE(sai_switch_api->shutdown_switch);
-    sai_switch_api->shutdown_switch(false);
+    LOGG(TEST_INFO, FRAMEWORK, "sai_switch_api->remove_switch\n");
+    ASSERT_TRUE(sai_switch_api->remove_switch != NULL);
+    sai_switch_api->remove_switch(g_switch_id);
 }
 
 
@@ -27,3 +27,102 @@ extern "C" {
 }
 
 #define SAI_OID_TYPE_CHECK(oid, type)         (sai_object_type_query(oid) == type)
+
+#include <functional>
+#include <utility>
+#include "ip.h"
+
+extern sai_object_id_t g_vr_id;
+
+// keys of the VRF aware tables
+struct VrfIpAddress
+{
+    sai_object_id_t vr_id;
+    IpAddress ip;
+
+    VrfIpAddress(sai_object_id_t vr, const IpAddress &addr) : vr_id(vr), ip(addr) {}
+
+    bool operator<(const VrfIpAddress &o) const
+    {
+        return (vr_id != o.vr_id) ? (vr_id < o.vr_id) : (ip < o.ip);
+    }
+
+    bool operator==(const VrfIpAddress &o) const
+    {
+        return (vr_id == o.vr_id && ip == o.ip);
+    }
+};
+
+struct VrfIpPrefix
+{
+    sai_object_id_t vr_id;
+    IpPrefix prefix;
+
+    VrfIpPrefix(sai_object_id_t vr, const IpPrefix &pfx) : vr_id(vr), prefix(pfx) {}
+
+    bool operator==(const VrfIpPrefix &o) const
+    {
+        return (vr_id == o.vr_id && prefix == o.prefix);
+    }
+};
+
+typedef std::pair<sai_object_id_t, IpAddresses> VrfNextHops;
+
+namespace std
+{
+template<> struct hash<VrfIpAddress>
+{
+    size_t operator()(const VrfIpAddress &key) const
+    {
+        return key.ip.hash() ^ (size_t)(key.vr_id * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+template<> struct hash<VrfNextHops>
+{
+    size_t operator()(const VrfNextHops &key) const
+    {
+        return key.second.hash() ^ (size_t)(key.first * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+template<> struct hash<VrfIpPrefix>
+{
+    size_t operator()(const VrfIpPrefix &key) const
+    {
+        return key.prefix.hash() ^ (size_t)(key.vr_id * 0x9e3779b97f4a7c15ULL);
+    }
+};
+}
+
+inline void copy_ip_address(sai_ip_address_t &saiAddr, const IpAddress &ip)
+{
+    if (ip.isV4())
+    {
+        saiAddr.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+        saiAddr.addr.ip4 = ip.addr();
+    }
+    else
+    {
+        saiAddr.addr_family = SAI_IP_ADDR_FAMILY_IPV6;
+        memcpy(saiAddr.addr.ip6, ip.v6addr(), sizeof(saiAddr.addr.ip6));
+    }
+}
+
+inline void copy_ip_prefix(sai_ip_prefix_t &saiPrefix, const IpPrefix &prefix)
+{
+    IpAddress mask = prefix.Mask();
+
+    if (prefix.isV4())
+    {
+        saiPrefix.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+        saiPrefix.addr.ip4 = prefix.Addr().addr();
+        saiPrefix.mask.ip4 = mask.addr();
+    }
+    else
+    {
+        saiPrefix.addr_family = SAI_IP_ADDR_FAMILY_IPV6;
+        memcpy(saiPrefix.addr.ip6, prefix.Addr().v6addr(), sizeof(saiPrefix.addr.ip6));
+        memcpy(saiPrefix.mask.ip6, mask.v6addr(), sizeof(saiPrefix.mask.ip6));
+    }
+}
@@ -39,23 +39,120 @@
 
 extern sai_fdb_api_t* sai_fdb_api;
 
+extern sai_object_id_t g_switch_id;
+
+static void fill_fdb_entry(const MacAddress &macAddr, sai_object_id_t bv_id, sai_fdb_entry_t &saifdbent)
+{
+    memset(&saifdbent, 0, sizeof(saifdbent));
+
+    saifdbent.switch_id = g_switch_id;
+    memcpy(saifdbent.mac_address, macAddr.to_bytes(), sizeof(sai_mac_t));
+    saifdbent.bv_id = bv_id;
+}
+
+static void fill_fdb_attrs(const FdbEntry &fdbEntry, sai_attribute_t *fdbattrs)
+{
+    fdbattrs[0].id = SAI_FDB_ENTRY_ATTR_TYPE;
+    fdbattrs[0].value.s32 = fdbEntry.type;
+    fdbattrs[1].id = SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID;
+    fdbattrs[1].value.oid = fdbEntry.port_id;
+    fdbattrs[2].id = SAI_FDB_ENTRY_ATTR_PACKET_ACTION;
+    fdbattrs[2].value.s32 = fdbEntry.pkt_action;
+}
+
+static bool bulk_not_available(sai_status_t status)
+{
+    return (status == SAI_STATUS_NOT_IMPLEMENTED ||
+            status == SAI_STATUS_NOT_SUPPORTED);
+}
+
+static bool fdb_entry_less(const FdbEntry *a, const FdbEntry *b)
+{
+    if (a->bv_id != b->bv_id)
+    {
+        return a->bv_id < b->bv_id;
+    }
+
+    return memcmp(a->macAddr.to_bytes(), b->macAddr.to_bytes(), 6) < 0;
+}
+
+FdbMgr::FdbMgr()
+{
+    m_bulkChunkSize = FDB_BULK_CHUNK_SIZE_DEFAULT;
+}
+
+void FdbMgr::SetBulkChunkSize(uint32_t chunkSize)
+{
+    m_bulkChunkSize = chunkSize ? chunkSize : 1;
+}
+
+size_t FdbMgr::Size() const
+{
+    return m_FdbTable.size();
+}
+
+void FdbMgr::InsertEntry(const FdbEntry &fdbEntry)
+{
+    FdbKey key(fdbEntry.macAddr, fdbEntry.bv_id);
+
+    m_FdbTable[key] = fdbEntry;
+    m_PortIndex[fdbEntry.port_id].insert(key);
+    m_BvIndex[fdbEntry.bv_id].insert(key);
+}
+
+void FdbMgr::EraseEntry(FdbTable::iterator it)
+{
+    FdbIndex::iterator itport = m_PortIndex.find(it->second.port_id);
+
+    if (itport != m_PortIndex.end())
+    {
+        itport->second.erase(it->first);
+
+        if (itport->second.empty())
+        {
+            m_PortIndex.erase(itport);
+        }
+    }
+
+    FdbIndex::iterator itbv = m_BvIndex.find(it->second.bv_id);
+
+    if (itbv != m_BvIndex.end())
+    {
+        itbv->second.erase(it->first);
+
+        if (itbv->second.empty())
+        {
+            m_BvIndex.erase(itbv);
+        }
+    }
+
+    m_FdbTable.erase(it);
+}
+
 void FdbMgr::Show()
 {
     const FdbEntry* fdbEntry;
     MacAddress mac;
-    std::vector<FdbEntry>::iterator it;
+    std::vector<const FdbEntry*> sorted;
+
+    for (FdbTable::const_iterator it = m_FdbTable.begin(); it != m_FdbTable.end(); ++it)
+    {
+        sorted.push_back(&it->second);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), fdb_entry_less);
 
     LOGG(TEST_DEBUG, FDB, "\t--- --- --- --- --- --- Fdb Entry Table --- --- --- --- --- --- \n");
-    LOGG(TEST_DEBUG, FDB, "\t{%-20s %-10s} {%-10s %-14s %-10s}\n", "mac", "valn_id", "type", "port id", "pkt act");
+    LOGG(TEST_DEBUG, FDB, "\t{%-20s %-14s} {%-10s %-14s %-10s}\n", "mac", "bv_id", "type", "port id", "pkt act");
 
-    for (it = m_FdbVector.begin(); it != m_FdbVector.end(); ++it)
+    for (size_t i = 0; i < sorted.size(); i++)
     {
-        fdbEntry = &(*it);
+        fdbEntry = sorted[i];
         mac = fdbEntry->macAddr;
-        LOGG(TEST_DEBUG, FDB, "\t{%-20s %-10hu} {%-10s 0x%-12lx %-10s}\n",
+        LOGG(TEST_DEBUG, FDB, "\t{%-20s 0x%-12lx} {%-10s 0x%-12lx %-10s}\n",
              mac.to_string().c_str(),
-             fdbEntry->vlan_id,
-             (fdbEntry->type == SAI_FDB_ENTRY_STATIC) ? "STATIC" : "DYNAMIC",
+             fdbEntry->bv_id,
+             (fdbEntry->type == SAI_FDB_ENTRY_TYPE_STATIC) ? "STATIC" : "DYNAMIC",
              fdbEntry->port_id,
              (fdbEntry->pkt_action == SAI_PACKET_ACTION_FORWARD) ? "FORWARD" :
              (fdbEntry->pkt_action == SAI_PACKET_ACTION_DROP) ? "DROP" :
@@ -66,7 +163,7 @@ void FdbMgr::Show()
 }
 
 bool FdbMgr::Add( MacAddress macAddr,
-                  sai_uint32_t vlan_id,
+                  sai_object_id_t bv_id,
                   sai_int32_t type,
                   sai_object_id_t port_id,
                   sai_int32_t pkt_action)
@@ -74,23 +171,19 @@ bool FdbMgr::Add( MacAddress macAddr,
     FdbEntry fdbEntry;
 
     fdbEntry.macAddr = macAddr;
-    fdbEntry.vlan_id = vlan_id;
+    fdbEntry.bv_id = bv_id;
     fdbEntry.type = type;
     fdbEntry.port_id = port_id;
     fdbEntry.pkt_action = pkt_action;
 
-    LOGG(TEST_INFO, FDB, "lookup fdb_entry {mac %-15s vlan_id %hu} \n",
-         macAddr.to_string().c_str(), vlan_id);
+    LOGG(TEST_INFO, FDB, "lookup fdb_entry {mac %-15s bv_id 0x%lx} \n",
+         macAddr.to_string().c_str(), bv_id);
 
-    for (std::vector<FdbEntry>::iterator it = m_FdbVector.begin();
-            it != m_FdbVector.end(); ++it)
+    if (m_FdbTable.find(FdbKey(macAddr, bv_id)) != m_FdbTable.end())
     {
-        if (it->macAddr == macAddr && it->vlan_id == vlan_id )
-        {
-            LOGG(TEST_DEBUG, FDB, "fdb_entry {mac %-15s vlan_id %hu} already exists\n",
-                 macAddr.to_string().c_str(), vlan_id);
-            return true;
-        }
+        LOGG(TEST_DEBUG, FDB, "fdb_entry {mac %-15s bv_id 0x%lx} already exists\n",
+             macAddr.to_string().c_str(), bv_id);
+        return true;
     }
 
     sai_status_t status;
@@ -98,124 +191,339 @@ bool FdbMgr::Add( MacAddress macAddr,
     sai_fdb_entry_t saifdbent;
     sai_attribute_t fdbattrs[3];
 
-    fdbattrs[0].id = SAI_FDB_ENTRY_ATTR_TYPE;
-    fdbattrs[0].value.s32 = type;
-    fdbattrs[1].id = SAI_FDB_ENTRY_ATTR_PORT_ID;
-    fdbattrs[1].value.oid = port_id;
-    fdbattrs[2].id = SAI_FDB_ENTRY_ATTR_PACKET_ACTION;
-    fdbattrs[2].value.s32 = pkt_action;
-
-    memcpy(saifdbent.mac_address, macAddr.to_bytes(), sizeof(sai_mac_t));
-    saifdbent.vlan_id = vlan_id;
+    fill_fdb_entry(macAddr, bv_id, saifdbent);
+    fill_fdb_attrs(fdbEntry, fdbattrs);
 
-    LOGG(TEST_INFO, FDB, "create sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-         macAddr.to_string().c_str(), saifdbent.vlan_id);
+    LOGG(TEST_INFO, FDB, "create sai_fdb_entry {mac %-15s bv_id 0x%lx}\n",
+         macAddr.to_string().c_str(), bv_id);
     status = sai_fdb_api->create_fdb_entry(&saifdbent, 3, fdbattrs);
 
     if (status != SAI_STATUS_SUCCESS)
     {
-        LOGG(TEST_ERR, FDB, "fail to create sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-             macAddr.to_string().c_str(), saifdbent.vlan_id);
+        LOGG(TEST_ERR, FDB, "fail to create sai_fdb_entry {mac %-15s bv_id 0x%lx}\n",
+             macAddr.to_string().c_str(), bv_id);
         return false;
     }
 
-    m_FdbVector.push_back(fdbEntry);
+    InsertEntry(fdbEntry);
 
     return true;
 }
 
 bool FdbMgr::Del(MacAddress macAddr,
-                 sai_uint32_t vlan_id)
+                 sai_object_id_t bv_id)
 {
     sai_status_t status;
     sai_fdb_entry_t saifdbent;
 
+    FdbTable::iterator it = m_FdbTable.find(FdbKey(macAddr, bv_id));
 
-    std::vector<FdbEntry>::iterator it;
-
-    for (it = m_FdbVector.begin(); it != m_FdbVector.end(); ++it)
-    {
-        if ((it->macAddr == macAddr) && (it->vlan_id == vlan_id))
-        {
-            break;
-        }
-    }
-
-    if (it == m_FdbVector.end() )
+    if (it == m_FdbTable.end())
     {
-        LOGG(TEST_DEBUG, FDB, "fdb_entry {mac %-15s vlan_id %hu} does not exist\n",
-             macAddr.to_string().c_str(), vlan_id);
+        LOGG(TEST_DEBUG, FDB, "fdb_entry {mac %-15s bv_id 0x%lx} does not exist\n",
+             macAddr.to_string().c_str(), bv_id);
 
         return true;
     }
 
-    memcpy(saifdbent.mac_address, macAddr.to_bytes(), sizeof(sai_mac_t));
-    saifdbent.vlan_id = it->vlan_id;
+    fill_fdb_entry(macAddr, bv_id, saifdbent);
 
-    LOGG(TEST_INFO, FDB, "remove sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-         macAddr.to_string().c_str(), saifdbent.vlan_id);
+    LOGG(TEST_INFO, FDB, "remove sai_fdb_entry {mac %-15s bv_id 0x%lx}\n",
+         macAddr.to_string().c_str(), bv_id);
 
     status = sai_fdb_api->remove_fdb_entry(&saifdbent);
 
     if (status != SAI_STATUS_SUCCESS)
     {
-        LOGG(TEST_ERR, FDB, "fail to remove sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-             macAddr.to_string().c_str(), saifdbent.vlan_id);
+        LOGG(TEST_ERR, FDB, "fail to remove sai_fdb_entry {mac %-15s bv_id 0x%lx}\n",
+             macAddr.to_string().c_str(), bv_id);
 
         return false;
     }
 
-    m_FdbVector.erase(it);
+    EraseEntry(it);
 
     return true;
 }
 
-bool FdbMgr::EraseAll()
+bool FdbMgr::AddBatch(const std::vector<FdbEntry> &entries)
 {
-    sai_status_t status;
-    sai_fdb_entry_t saifdbent;
-    MacAddress macAddr;
+    std::vector<sai_fdb_entry_t> saifdbents;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrPtrs;
+    std::vector<sai_status_t> statuses;
+    std::vector<const FdbEntry*> pending;
+    std::unordered_set<FdbKey> chunkKeys;
+    size_t pos = 0;
+    size_t failures = 0;
+
+    LOGG(TEST_INFO, FDB, "sai_fdb_api->create_fdb_entries %zu entries, %u entries per call\n",
+         entries.size(), m_bulkChunkSize);
+
+    while (pos < entries.size())
+    {
+        saifdbents.clear();
+        pending.clear();
+        chunkKeys.clear();
+
+        for (; pos < entries.size() && pending.size() < m_bulkChunkSize; pos++)
+        {
+            FdbKey key(entries[pos].macAddr, entries[pos].bv_id);
 
-    std::vector<FdbEntry>::const_iterator it;
+            // existing entries are kept, as in Add()
+            if (m_FdbTable.find(key) != m_FdbTable.end() || !chunkKeys.insert(key).second)
+            {
+                continue;
+            }
 
-    for (it = m_FdbVector.begin(); it != m_FdbVector.end(); it++)
+            sai_fdb_entry_t saifdbent;
+            fill_fdb_entry(entries[pos].macAddr, entries[pos].bv_id, saifdbent);
+
+            saifdbents.push_back(saifdbent);
+            pending.push_back(&entries[pos]);
+        }
+
+        uint32_t count = (uint32_t)pending.size();
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        attrs.resize(3 * count);
+        attrCounts.assign(count, 3);
+        attrPtrs.resize(count);
+        statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            fill_fdb_attrs(*pending[i], &attrs[3 * i]);
+            attrPtrs[i] = &attrs[3 * i];
+        }
+
+        sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+        if (sai_fdb_api->create_fdb_entries)
+        {
+            status = sai_fdb_api->create_fdb_entries(count, saifdbents.data(),
+                     attrCounts.data(), attrPtrs.data(),
+                     SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                     statuses.data());
+        }
+
+        if (bulk_not_available(status))
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                statuses[i] = sai_fdb_api->create_fdb_entry(&saifdbents[i], 3, attrPtrs[i]);
+            }
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (statuses[i] != SAI_STATUS_SUCCESS)
+            {
+                MacAddress mac = pending[i]->macAddr;
+                LOGG(TEST_ERR, FDB, "fail to create sai_fdb_entry {mac %-15s bv_id 0x%lx} status=0x%x\n",
+                     mac.to_string().c_str(), pending[i]->bv_id, -statuses[i]);
+                failures++;
+                continue;
+            }
+
+            InsertEntry(*pending[i]);
+        }
+    }
+
+    return (failures == 0);
+}
+
+bool FdbMgr::DelBatch(const std::vector<FdbKey> &keys)
+{
+    std::vector<sai_fdb_entry_t> saifdbents;
+    std::vector<FdbTable::iterator> pending;
+    std::vector<sai_status_t> statuses;
+    std::unordered_set<FdbKey> chunkKeys;
+    size_t pos = 0;
+    size_t failures = 0;
+
+    LOGG(TEST_INFO, FDB, "sai_fdb_api->remove_fdb_entries %zu entries, %u entries per call\n",
+         keys.size(), m_bulkChunkSize);
+
+    while (pos < keys.size())
     {
-        macAddr = it->macAddr;
-        memcpy(saifdbent.mac_address, macAddr.to_bytes(), sizeof(sai_mac_t));
-        saifdbent.vlan_id = it->vlan_id;
+        saifdbents.clear();
+        pending.clear();
+        chunkKeys.clear();
+
+        for (; pos < keys.size() && pending.size() < m_bulkChunkSize; pos++)
+        {
+            FdbTable::iterator it = m_FdbTable.find(keys[pos]);
+
+            if (it == m_FdbTable.end() || !chunkKeys.insert(keys[pos]).second)
+            {
+                continue;
+            }
+
+            sai_fdb_entry_t saifdbent;
+            fill_fdb_entry(keys[pos].macAddr, keys[pos].bv_id, saifdbent);
 
-        LOGG(TEST_INFO, FDB, "remove sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-             macAddr.to_string().c_str(), saifdbent.vlan_id);
+            saifdbents.push_back(saifdbent);
+            pending.push_back(it);
+        }
+
+        uint32_t count = (uint32_t)pending.size();
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
 
-        status = sai_fdb_api->remove_fdb_entry(&saifdbent);
+        sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
 
-        if (status != SAI_STATUS_SUCCESS)
+        if (sai_fdb_api->remove_fdb_entries)
         {
-            LOGG(TEST_ERR, FDB, "fail to remove sai_fdb_entry {mac %-15s vlan_id %hu}\n",
-                 macAddr.to_string().c_str(), saifdbent.vlan_id);
-            return false;
+            status = sai_fdb_api->remove_fdb_entries(count, saifdbents.data(),
+                     SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                     statuses.data());
+        }
+
+        if (bulk_not_available(status))
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                statuses[i] = sai_fdb_api->remove_fdb_entry(&saifdbents[i]);
+            }
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (statuses[i] != SAI_STATUS_SUCCESS)
+            {
+                MacAddress mac = pending[i]->first.macAddr;
+                LOGG(TEST_ERR, FDB, "fail to remove sai_fdb_entry {mac %-15s bv_id 0x%lx} status=0x%x\n",
+                     mac.to_string().c_str(), pending[i]->first.bv_id, -statuses[i]);
+                failures++;
+                continue;
+            }
+
+            EraseEntry(pending[i]);
         }
     }
 
-    m_FdbVector.clear();
-    return true;
+    return (failures == 0);
 }
 
-const FdbEntry* FdbMgr::GetFdbEntry(const MacAddress &mac, const sai_uint32_t &vlan_id) const
+bool FdbMgr::Flush(sai_object_id_t port_id, sai_object_id_t bv_id)
 {
-    std::vector<FdbEntry>::const_iterator it;
+    std::vector<FdbKey> keys;
+    sai_attribute_t attrs[3];
+    uint32_t count = 0;
+
+    // the smaller index bucket has every matching entry
+    const std::unordered_set<FdbKey> *bucket = NULL;
+
+    if (port_id != SAI_NULL_OBJECT_ID)
+    {
+        FdbIndex::const_iterator it = m_PortIndex.find(port_id);
+        bucket = (it == m_PortIndex.end()) ? NULL : &it->second;
 
-    for (it = m_FdbVector.begin(); it != m_FdbVector.end(); ++it)
+        attrs[count].id = SAI_FDB_FLUSH_ATTR_BRIDGE_PORT_ID;
+        attrs[count++].value.oid = port_id;
+    }
+
+    if (bv_id != SAI_NULL_OBJECT_ID)
     {
-        if ((it->macAddr == mac) && (it->vlan_id == vlan_id))
+        FdbIndex::const_iterator it = m_BvIndex.find(bv_id);
+
+        if (it == m_BvIndex.end())
+        {
+            bucket = NULL;
+        }
+        else if (port_id == SAI_NULL_OBJECT_ID || (bucket && it->second.size() < bucket->size()))
         {
-            break;
+            bucket = &it->second;
         }
+
+        attrs[count].id = SAI_FDB_FLUSH_ATTR_BV_ID;
+        attrs[count++].value.oid = bv_id;
     }
 
-    if (it != m_FdbVector.end())
+    attrs[count].id = SAI_FDB_FLUSH_ATTR_ENTRY_TYPE;
+    attrs[count++].value.s32 = SAI_FDB_FLUSH_ENTRY_TYPE_ALL;
+
+    if (port_id == SAI_NULL_OBJECT_ID && bv_id == SAI_NULL_OBJECT_ID)
+    {
+        for (FdbTable::const_iterator it = m_FdbTable.begin(); it != m_FdbTable.end(); ++it)
+        {
+            keys.push_back(it->first);
+        }
+    }
+    else if (bucket)
+    {
+        for (std::unordered_set<FdbKey>::const_iterator it = bucket->begin(); it != bucket->end(); ++it)
+        {
+            const FdbEntry &fdbEntry = m_FdbTable.find(*it)->second;
+
+            if ((port_id == SAI_NULL_OBJECT_ID || fdbEntry.port_id == port_id) &&
+                    (bv_id == SAI_NULL_OBJECT_ID || fdbEntry.bv_id == bv_id))
+            {
+                keys.push_back(*it);
+            }
+        }
+    }
+
+    LOGG(TEST_INFO, FDB, "sai_fdb_api->flush_fdb_entries port_id 0x%lx bv_id 0x%lx, %zu entries\n",
+         port_id, bv_id, keys.size());
+
+    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+    if (sai_fdb_api->flush_fdb_entries)
+    {
+        status = sai_fdb_api->flush_fdb_entries(g_switch_id, count, attrs);
+    }
+
+    if (bulk_not_available(status))
+    {
+        return DelBatch(keys);
+    }
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, FDB, "fail to flush fdb entries port_id 0x%lx bv_id 0x%lx status=0x%x\n",
+             port_id, bv_id, -status);
+        return false;
+    }
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        EraseEntry(m_FdbTable.find(keys[i]));
+    }
+
+    return true;
+}
+
+bool FdbMgr::EraseAll()
+{
+    std::vector<FdbKey> keys;
+
+    for (FdbTable::const_iterator it = m_FdbTable.begin(); it != m_FdbTable.end(); ++it)
+    {
+        keys.push_back(it->first);
+    }
+
+    return DelBatch(keys);
+}
+
+const FdbEntry* FdbMgr::GetFdbEntry(const MacAddress &mac, const sai_object_id_t &bv_id) const
+{
+    FdbTable::const_iterator it = m_FdbTable.find(FdbKey(mac, bv_id));
+
+    if (it != m_FdbTable.end())
     {
-        return &(*it);
+        return &it->second;
     }
     else
     {
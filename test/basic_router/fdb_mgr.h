@@ -21,6 +21,8 @@
  */
 #pragma once
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <saitypes.h>
 #include <saifdb.h>
@@ -30,29 +32,86 @@
 #include "mac.h"
 #include "basic_router.h"
 
+#define FDB_BULK_CHUNK_SIZE_DEFAULT     4096
+
+struct FdbKey
+{
+    MacAddress macAddr;
+    sai_object_id_t bv_id;
+
+    FdbKey() : bv_id(SAI_NULL_OBJECT_ID) {}
+    FdbKey(const MacAddress &mac, sai_object_id_t bv) : macAddr(mac), bv_id(bv) {}
+
+    bool operator==(const FdbKey &o) const
+    {
+        return bv_id == o.bv_id && macAddr == o.macAddr;
+    }
+};
+
+namespace std
+{
+template<> struct hash<FdbKey>
+{
+    size_t operator()(const FdbKey &key) const
+    {
+        uint64_t mac = 0;
+
+        memcpy(&mac, key.macAddr.to_bytes(), 6);
+
+        return std::hash<uint64_t>()(mac ^ (key.bv_id * 0x9e3779b97f4a7c15ULL));
+    }
+};
+}
+
 struct FdbEntry
 {
     MacAddress macAddr;
-    sai_uint32_t vlan_id;
+    sai_object_id_t bv_id;          // VLAN or bridge
     sai_int32_t type;
-    sai_object_id_t port_id;
+    sai_object_id_t port_id;        // bridge port
     sai_int32_t pkt_action;
 };
 
+typedef std::unordered_map<FdbKey, FdbEntry> FdbTable;
+
+// port_id or bv_id -> the keys of its entries
+typedef std::unordered_map<sai_object_id_t, std::unordered_set<FdbKey> > FdbIndex;
+
 class FdbMgr
 {
-    std::vector<FdbEntry> m_FdbVector;
+    FdbTable m_FdbTable;
+    FdbIndex m_PortIndex;
+    FdbIndex m_BvIndex;
+
+    uint32_t m_bulkChunkSize;
+
+    void InsertEntry(const FdbEntry &fdbEntry);
+    void EraseEntry(FdbTable::iterator it);
 
 public:
+    FdbMgr();
+
     bool Add(MacAddress macAddr,
-             sai_uint32_t vlan_id,
+             sai_object_id_t bv_id,
              sai_int32_t type,
              sai_object_id_t port_id,
              sai_int32_t pkt_action);
     bool Del(MacAddress macAddr,
-             sai_uint32_t vlan_id);
+             sai_object_id_t bv_id);
+
+    // create_fdb_entries()/remove_fdb_entries(), m_bulkChunkSize entries per
+    // call; false when any entry failed
+    bool AddBatch(const std::vector<FdbEntry> &entries);
+    bool DelBatch(const std::vector<FdbKey> &keys);
+
+    // flush_fdb_entries() of static and dynamic entries on a bridge port,
+    // a VLAN/bridge or both; SAI_NULL_OBJECT_ID matches any
+    bool Flush(sai_object_id_t port_id, sai_object_id_t bv_id);
+
+    void SetBulkChunkSize(uint32_t chunkSize);
+    size_t Size() const;
     bool EraseAll();
     void Show();
 
-    const FdbEntry* GetFdbEntry(const MacAddress &, const sai_uint32_t &) const;
+    const FdbEntry* GetFdbEntry(const MacAddress &, const sai_object_id_t &) const;
 };
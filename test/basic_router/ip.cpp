@@ -20,6 +20,7 @@
  *
  */
 #include <arpa/inet.h>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 
@@ -27,17 +28,41 @@
 
 IpAddress::IpAddress(const std::string &ipstr)
 {
-    if (inet_pton(AF_INET, ipstr.c_str(), &m_addr) != 1)
+    memset(m_ip.v6, 0, sizeof(m_ip.v6));
+
+    m_family = (ipstr.find(':') == std::string::npos) ? AF_INET : AF_INET6;
+
+    if (inet_pton(m_family, ipstr.c_str(), m_ip.v6) != 1)
     {
         std::string errmsg = "cannot convert " + ipstr + " to ip address";
         throw std::invalid_argument(errmsg);
     }
 }
 
+// murmur3 64-bit finalizer
+static inline uint64_t mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+size_t IpAddress::hash() const
+{
+    uint64_t lo = ((uint64_t)m_ip.words[1] << 32) | m_ip.words[0];
+    uint64_t hi = ((uint64_t)m_ip.words[3] << 32) | m_ip.words[2];
+
+    return (size_t)mix64(lo ^ mix64(hi ^ m_family));
+}
+
 const std::string IpAddress::to_string() const
 {
-    char str[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &m_addr, str, INET_ADDRSTRLEN);
+    char str[INET6_ADDRSTRLEN];
+    inet_ntop(m_family, m_ip.v6, str, INET6_ADDRSTRLEN);
     std::string addrstr(str);
     return addrstr;
 }
@@ -98,45 +123,125 @@ bool IpAddresses::operator<(const IpAddresses &o) const
     return (m_addrSet < o.m_addrSet);
 }
 
+size_t IpAddresses::hash() const
+{
+    size_t h = m_addrSet.size();
+
+    for (std::set<IpAddress>::const_iterator it = m_addrSet.begin(); it != m_addrSet.end(); ++it)
+    {
+        h = h * 31 + it->hash();
+    }
+
+    return h;
+}
+
+IpPrefix::IpPrefix(const IpAddress &addr, int maskLen)
+{
+    if (maskLen < 0 || maskLen > addr.bitLength())
+    {
+        std::string errmsg = "cannot convert " + addr.to_string() + " to ip prefix";
+        throw std::invalid_argument(errmsg);
+    }
+
+    m_addr = addr;
+    m_maskLen = (uint8_t)maskLen;
+
+    IpAddress mask = Mask();
+    uint8_t bytes[16];
+
+    for (int i = 0; i < 16; i++)
+    {
+        bytes[i] = addr.v6addr()[i] & mask.v6addr()[i];
+    }
+
+    if (addr.isV4())
+    {
+        uint32_t v4;
+        memcpy(&v4, bytes, sizeof(v4));
+        m_addr = IpAddress(v4);
+    }
+    else
+    {
+        m_addr = IpAddress(bytes);
+    }
+}
+
 IpPrefix::IpPrefix(
     const std::string &prefix)
 {
     size_t pos = prefix.find('/');
     std::string ipStr = prefix.substr(0, pos);
+    IpAddress addr;
 
-    if (ipStr.empty())
+    if (!ipStr.empty())
     {
-        m_addr = 0;
+        addr = IpAddress(ipStr);
     }
-    else
+
+    std::string maskStr = prefix.substr(pos + 1);
+
+    *this = IpPrefix(addr, std::stoi(maskStr));
+}
+
+IpAddress IpPrefix::Mask() const
+{
+    uint8_t bytes[16] = {0};
+
+    for (int i = 0; i < m_maskLen; i++)
     {
-        m_addr = IpAddress(ipStr);
+        bytes[i / 8] |= (uint8_t)(0x80 >> (i % 8));
     }
 
-    std::string maskStr = prefix.substr(pos + 1);
-    m_maskLen = std::stoi(maskStr);
+    if (m_addr.isV4())
+    {
+        uint32_t v4;
+        memcpy(&v4, bytes, sizeof(v4));
+        return IpAddress(v4);
+    }
+
+    return IpAddress(bytes);
+}
 
-    if (m_maskLen < 0 || m_maskLen > 32)
+int IpPrefix::CommonLength(const IpPrefix &o) const
+{
+    int maxLen = std::min(m_maskLen, o.m_maskLen);
+    int len = 0;
+
+    if (m_addr.family() != o.m_addr.family())
     {
-        std::string errmsg = "cannot convert " + ipStr + " to ip prefix";
-        throw std::invalid_argument(errmsg);
+        return 0;
+    }
+
+    // whole bytes first, then the bits of the first differing byte
+    while (len + 8 <= maxLen && m_addr.v6addr()[len / 8] == o.m_addr.v6addr()[len / 8])
+    {
+        len += 8;
     }
 
-    m_mask = htonl(((uint64_t)0xFFFFFFFF << (32 - m_maskLen)) & 0xFFFFFFFF);
+    while (len < maxLen && m_addr.bit(len) == o.m_addr.bit(len))
+    {
+        len++;
+    }
+
+    return len;
 }
 
 bool IpPrefix::operator<(const IpPrefix &o) const
 {
-    uint64_t addrmask = ((uint64_t)m_addr.addr()) << 32 | m_mask.addr();
-    uint64_t o_addrmask = ((uint64_t)o.m_addr.addr()) << 32 | o.m_mask.addr();
-
-    if (addrmask < o_addrmask)
-        return true;
+    if (m_addr != o.m_addr)
+    {
+        return m_addr < o.m_addr;
+    }
 
-    return false;
+    return m_maskLen < o.m_maskLen;
 }
 
 const std::string IpPrefix::to_string() const
 {
-    return (m_addr.to_string() + "/" + m_mask.to_string());
+    if (!m_addr.isV4())
+    {
+        return (m_addr.to_string() + "/" + std::to_string(m_maskLen));
+    }
+
+    return (m_addr.to_string() + "/" + Mask().to_string());
 }
@@ -22,40 +22,103 @@
 #pragma once
 
 #include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <functional>
 #include <string>
 #include <set>
 #include "log.h"
 
+// IPv4 or IPv6 address, always in network order; an IPv4 address only
+// uses the first 4 bytes and the rest is kept zeroed so that the key can
+// be compared and hashed as a whole
 class IpAddress
 {
 public:
-    IpAddress() : m_addr(0) {}
-    IpAddress(uint32_t addr)
+    IpAddress() : m_family(AF_INET)
     {
-        m_addr = addr;
+        memset(m_ip.v6, 0, sizeof(m_ip.v6));
     }
+
+    IpAddress(uint32_t addr) : m_family(AF_INET)
+    {
+        memset(m_ip.v6, 0, sizeof(m_ip.v6));
+        m_ip.v4 = addr;
+    }
+
+    IpAddress(const uint8_t *v6addr) : m_family(AF_INET6)
+    {
+        memcpy(m_ip.v6, v6addr, sizeof(m_ip.v6));
+    }
+
     IpAddress(const std::string &ipstr);
 
     // the address is in network order
     uint32_t addr() const
     {
-        return m_addr;
+        return m_ip.v4;
+    }
+
+    const uint8_t *v6addr() const
+    {
+        return m_ip.v6;
+    }
+
+    bool isV4() const
+    {
+        return m_family == AF_INET;
+    }
+
+    int family() const
+    {
+        return m_family;
+    }
+
+    int bitLength() const
+    {
+        return isV4() ? 32 : 128;
+    }
+
+    // bit 0 is the most significant bit of the address
+    int bit(int i) const
+    {
+        return (m_ip.v6[i / 8] >> (7 - i % 8)) & 1;
     }
 
     bool operator<(const IpAddress &o) const
     {
-        return (m_addr < o.m_addr);
+        if (m_family != o.m_family)
+        {
+            return m_family < o.m_family;
+        }
+
+        return memcmp(m_ip.v6, o.m_ip.v6, sizeof(m_ip.v6)) < 0;
     }
 
     bool operator==(const IpAddress &o) const
     {
-        return (m_addr == o.m_addr);
+        return (m_family == o.m_family &&
+                memcmp(m_ip.v6, o.m_ip.v6, sizeof(m_ip.v6)) == 0);
     }
 
+    bool operator!=(const IpAddress &o) const
+    {
+        return !(*this == o);
+    }
+
+    size_t hash() const;
+
     const std::string to_string() const;
 
 private:
-    uint32_t m_addr;
+    union
+    {
+        uint32_t v4;
+        uint32_t words[4];
+        uint8_t v6[16];
+    } m_ip;
+
+    uint8_t m_family;
 };
 
 class IpAddresses
@@ -68,6 +131,11 @@ public:
 
     void add(const std::string &ipstr);
 
+    void add(const IpAddress &ip)
+    {
+        m_addrSet.insert(ip);
+    }
+
     bool operator<(const IpAddresses &o) const;
 
     bool operator==(const IpAddresses &o) const
@@ -85,6 +153,8 @@ public:
         return m_addrSet.size();
     }
 
+    size_t hash() const;
+
     const std::string to_string() const;
 
     const std::set<IpAddress> &AddrSet() const
@@ -99,7 +169,10 @@ private:
 class IpPrefix
 {
 public:
-    IpPrefix() : m_addr(0), m_mask(0), m_maskLen(0) {}
+    IpPrefix() : m_maskLen(0) {}
+
+    // host bits of addr are cleared
+    IpPrefix(const IpAddress &addr, int maskLen);
 
     IpPrefix(const std::string &);
 
@@ -110,16 +183,18 @@ public:
         return m_addr;
     }
 
-    IpAddress Mask() const
-    {
-        return m_mask;
-    }
+    IpAddress Mask() const;
 
     int MaskLen() const
     {
         return m_maskLen;
     }
 
+    bool isV4() const
+    {
+        return m_addr.isV4();
+    }
+
     uint32_t SubnetSize() const
     {
         uint32_t i = 1;
@@ -132,11 +207,54 @@ public:
         return i;
     }
 
+    // length of the common leading bits, at most the shorter mask length
+    int CommonLength(const IpPrefix &o) const;
+
     bool operator<(const IpPrefix &o) const;
 
+    bool operator==(const IpPrefix &o) const
+    {
+        return (m_maskLen == o.m_maskLen && m_addr == o.m_addr);
+    }
+
+    bool operator!=(const IpPrefix &o) const
+    {
+        return !(*this == o);
+    }
+
+    size_t hash() const
+    {
+        return m_addr.hash() * 31 + m_maskLen;
+    }
+
 private:
     IpAddress m_addr;
-    IpAddress m_mask;
-    int m_maskLen;
+    uint8_t m_maskLen;
+};
+
+namespace std
+{
+template<> struct hash<IpAddress>
+{
+    size_t operator()(const IpAddress &ip) const
+    {
+        return ip.hash();
+    }
+};
+
+template<> struct hash<IpAddresses>
+{
+    size_t operator()(const IpAddresses &ips) const
+    {
+        return ips.hash();
+    }
 };
 
+template<> struct hash<IpPrefix>
+{
+    size_t operator()(const IpPrefix &prefix) const
+    {
+        return prefix.hash();
+    }
+};
+}
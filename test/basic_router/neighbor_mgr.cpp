@@ -30,6 +30,7 @@
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <sstream>
 #include <stdio.h>
 #include <string>
@@ -40,26 +41,157 @@
 extern sai_neighbor_api_t* sai_neighbor_api;
 extern sai_next_hop_api_t* sai_next_hop_api;
 
-NeighborMgr::NeighborMgr(NextHopMgr* nhMgr) : m_nhMgr(nhMgr)
+extern sai_object_id_t g_switch_id;
+
+static void fill_neighbor_entry(const IpAddress &ipAddr, sai_object_id_t rif_id, sai_neighbor_entry_t &sainb)
+{
+    memset(&sainb, 0, sizeof(sainb));
+
+    sainb.switch_id = g_switch_id;
+    sainb.rif_id = rif_id;
+    copy_ip_address(sainb.ip_address, ipAddr);
+}
+
+// a neighbor created without its nexthop is not tracked, take it back out
+static void remove_untracked_neighbor(const IpAddress &ipAddr, const sai_neighbor_entry_t &sainb)
+{
+    LOGG(TEST_INFO, NEIGHBOR, "sai_neighbor_api->remove_neighbor_entry ip %s rif_id 0x%lx \n",
+         ipAddr.to_string().c_str(), sainb.rif_id);
+
+    sai_status_t status = sai_neighbor_api->remove_neighbor_entry(&sainb);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, NEIGHBOR, "fail to remove neighbor ip %s, rc=0x%x\n", ipAddr.to_string().c_str(), -status);
+    }
+}
+
+NeighborMgr::NeighborMgr(NextHopMgr* nhMgr) : m_nhMgr(nhMgr), m_listener(NULL)
+{
+    m_bulkChunkSize = NEIGHBOR_BULK_CHUNK_SIZE_DEFAULT;
+}
+
+void NeighborMgr::SetBulkChunkSize(uint32_t chunkSize)
+{
+    m_bulkChunkSize = chunkSize ? chunkSize : 1;
+}
+
+void NeighborMgr::SetListener(NeighborListener* listener)
+{
+    m_listener = listener;
+}
+
+void NeighborMgr::WaitForRoute(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpPrefix &prefix)
+{
+    m_pending[VrfIpAddress(vr_id, ipAddr)].routes.insert(prefix);
+}
+
+void NeighborMgr::WaitForNextHops(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpAddresses &nexthops)
+{
+    m_pending[VrfIpAddress(vr_id, ipAddr)].nexthopSets.insert(nexthops);
+}
+
+void NeighborMgr::CancelRoute(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpPrefix &prefix)
+{
+    std::unordered_map<VrfIpAddress, PendingResolution>::iterator it = m_pending.find(VrfIpAddress(vr_id, ipAddr));
+
+    if (it == m_pending.end())
+    {
+        return;
+    }
+
+    it->second.routes.erase(prefix);
+
+    if (it->second.routes.empty() && it->second.nexthopSets.empty())
+    {
+        m_pending.erase(it);
+    }
+}
+
+void NeighborMgr::CancelNextHops(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpAddresses &nexthops)
 {
+    std::unordered_map<VrfIpAddress, PendingResolution>::iterator it = m_pending.find(VrfIpAddress(vr_id, ipAddr));
+
+    if (it == m_pending.end())
+    {
+        return;
+    }
+
+    it->second.nexthopSets.erase(nexthops);
+
+    if (it->second.routes.empty() && it->second.nexthopSets.empty())
+    {
+        m_pending.erase(it);
+    }
+}
+
+const PendingResolution* NeighborMgr::GetPending(sai_object_id_t vr_id, const IpAddress &ipAddr) const
+{
+    std::unordered_map<VrfIpAddress, PendingResolution>::const_iterator it = m_pending.find(VrfIpAddress(vr_id, ipAddr));
+
+    if (it != m_pending.end())
+    {
+        return &it->second;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+void NeighborMgr::Resolve(sai_object_id_t vr_id, const std::vector<IpAddress> &ipAddrs)
+{
+    PendingResolution resolved;
+
+    for (size_t i = 0; i < ipAddrs.size(); i++)
+    {
+        std::unordered_map<VrfIpAddress, PendingResolution>::iterator it = m_pending.find(VrfIpAddress(vr_id, ipAddrs[i]));
+
+        if (it == m_pending.end())
+        {
+            continue;
+        }
+
+        resolved.routes.insert(it->second.routes.begin(), it->second.routes.end());
+        resolved.nexthopSets.insert(it->second.nexthopSets.begin(), it->second.nexthopSets.end());
+        m_pending.erase(it);
+    }
+
+    if (!m_listener || (resolved.routes.empty() && resolved.nexthopSets.empty()))
+    {
+        return;
+    }
+
+    LOGG(TEST_INFO, NEIGHBOR, "%zu neighbors resolve %zu routes and %zu nexthop sets\n",
+         ipAddrs.size(), resolved.routes.size(), resolved.nexthopSets.size());
+
+    m_listener->OnNeighborsResolved(vr_id, resolved);
 }
 
 void NeighborMgr::Show()
 {
-    std::map<IpAddress, NeighborEntry>::const_iterator it;
+    std::unordered_map<VrfIpAddress, NeighborEntry>::const_iterator it;
+    std::map<VrfIpAddress, const NeighborEntry*> sorted;
+    std::map<VrfIpAddress, const NeighborEntry*>::const_iterator itsorted;
     const NeighborEntry* nbentry;
     MacAddress mac;
 
+    for (it = m_ip2NbrMap.begin(); it != m_ip2NbrMap.end(); it++)
+    {
+        sorted.insert(std::make_pair(it->first, &it->second));
+    }
+
 
     LOGG(TEST_DEBUG, NEIGHBOR, "\t--- --- --- --- --- --- Neighbor Entry Table --- --- --- --- --- --- \n");
-    LOGG(TEST_DEBUG, NEIGHBOR, "\t%-15s %-20s  via %-10s %-14s %-14s\n", "station", "mac_addr", "intf", "rif_id", "next_hop_id");
+    LOGG(TEST_DEBUG, NEIGHBOR, "\t%-14s %-15s %-20s  via %-10s %-14s %-14s\n", "vr_id", "station", "mac_addr", "intf", "rif_id", "next_hop_id");
 
-    for (it = m_ip2NbrMap.begin(); it != m_ip2NbrMap.end(); it++)
+    for (itsorted = sorted.begin(); itsorted != sorted.end(); itsorted++)
     {
-        nbentry = &it->second;
+        nbentry = itsorted->second;
         mac =  nbentry->macAddr;
-        LOGG(TEST_DEBUG, NEIGHBOR, "\t%-15s %-20s  via %-10s 0x%-12lx 0x%-12lx\n",
-             it->first.to_string().c_str(),
+        LOGG(TEST_DEBUG, NEIGHBOR, "\t0x%-12lx %-15s %-20s  via %-10s 0x%-12lx 0x%-12lx\n",
+             itsorted->first.vr_id,
+             itsorted->first.ip.to_string().c_str(),
              mac.to_string().c_str(),
              nbentry->intfAlias.c_str(),
              nbentry->rif_id,
@@ -74,6 +206,44 @@ bool NeighborMgr::Add(IpAddress ipAddr,
                       MacAddress macAddr,
                       std::string intfAlias,
                       sai_object_id_t rif_id)
+{
+    return Add(g_vr_id, ipAddr, macAddr, intfAlias, rif_id);
+}
+
+bool NeighborMgr::AddNextHop(sai_object_id_t vr_id, const IpAddress &ipAddr, NeighborEntry &nbEntry)
+{
+    MacAddress macAddr = nbEntry.macAddr;
+
+    LOGG(TEST_INFO, NEIGHBOR, "sai_next_hop_api->create_next_hop IPaddr[%s] MACaddr[%s] Interface[%s] rif_id[0x%lx]\n",
+         ipAddr.to_string().c_str(),  macAddr.to_string().c_str(), nbEntry.intfAlias.c_str(), nbEntry.rif_id);
+
+    if (!m_nhMgr->Add(vr_id, ipAddr, macAddr, nbEntry.intfAlias, nbEntry.rif_id))
+    {
+        LOGG(TEST_ERR, NEIGHBOR, "fail to add next_hop_id\n");
+        return false;
+    }
+
+    const NextHopEntry *nhEntry = m_nhMgr->GetNextHopEntry(vr_id, ipAddr);
+
+    if (!nhEntry)
+    {
+        LOGG(TEST_ERR, NEIGHBOR, "fail to retrieve next_hop_id\n");
+        return false;
+    }
+
+    nbEntry.nhid = nhEntry->nhid;
+    LOGG(TEST_DEBUG, NEIGHBOR, "next_hop_id 0x%lx\n", nbEntry.nhid);
+
+    m_ip2NbrMap[VrfIpAddress(vr_id, ipAddr)] = nbEntry;
+
+    return true;
+}
+
+bool NeighborMgr::Add(sai_object_id_t vr_id,
+                      IpAddress ipAddr,
+                      MacAddress macAddr,
+                      std::string intfAlias,
+                      sai_object_id_t rif_id)
 {
     sai_status_t status;
 
@@ -82,16 +252,14 @@ bool NeighborMgr::Add(IpAddress ipAddr,
     NeighborEntry nbEntry;
     nbEntry.macAddr = macAddr;
     nbEntry.intfAlias = intfAlias;
-    std::map<IpAddress, NeighborEntry>::iterator itnb = m_ip2NbrMap.find(ipAddr);
+    nbEntry.rif_id = rif_id;
 
     //Write to the ASIC
     // add new neighbor
-    sainb.rif_id = rif_id;
-    sainb.ip_address.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    sainb.ip_address.addr.ip4 = ipAddr.addr();
+    fill_neighbor_entry(ipAddr, rif_id, sainb);
 
     sai_attribute_t rif_attr;
-    rif_attr.id = SAI_NEIGHBOR_ATTR_DST_MAC_ADDRESS;
+    rif_attr.id = SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS;
     memcpy(rif_attr.value.mac, macAddr.to_bytes(), 6);
 
     LOGG(TEST_INFO, NEIGHBOR, "sai_neighbor_api->create_neighbor_entry IPaddr[%s] MACaddr[%s] Interface[%s] rif_id[0x%lx]\n",
@@ -106,41 +274,114 @@ bool NeighborMgr::Add(IpAddress ipAddr,
         return false;
     }
 
-    LOGG(TEST_INFO, NEIGHBOR, "sai_next_hop_api->create_next_hop IPaddr[%s] MACaddr[%s] Interface[%s] rif_id[0x%lx]\n",
-         ipAddr.to_string().c_str(),  macAddr.to_string().c_str(), intfAlias.c_str(), rif_id);
-
-    sai_object_id_t nhid;
-
-    if (!m_nhMgr->Add(ipAddr, macAddr, intfAlias, rif_id))
+    if (!AddNextHop(vr_id, ipAddr, nbEntry))
     {
-        LOGG(TEST_ERR, NEIGHBOR, "fail to add next_hop_id\n");
+        remove_untracked_neighbor(ipAddr, sainb);
         return false;
     }
 
-    const NextHopEntry *nhEntry = m_nhMgr->GetNextHopEntry(ipAddr);
+    Resolve(vr_id, std::vector<IpAddress>(1, ipAddr));
 
-    if (!nhEntry)
+    return true;
+}
+
+bool NeighborMgr::AddBatch(sai_object_id_t vr_id, const NeighborBatch &neighbors)
+{
+    std::vector<sai_neighbor_entry_t> entries;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrPtrs;
+    std::vector<sai_status_t> statuses;
+    std::vector<IpAddress> added;
+    size_t pos = 0;
+    size_t failures = 0;
+
+    LOGG(TEST_INFO, NEIGHBOR, "sai_neighbor_api->create_neighbor_entries vr_id 0x%lx %zu neighbors, %u per call\n",
+         vr_id, neighbors.size(), m_bulkChunkSize);
+
+    while (pos < neighbors.size())
     {
-        LOGG(TEST_ERR, NEIGHBOR, "fail to retrieve next_hop_id\n");
-        return false;
-    }
+        size_t start = pos;
+        size_t end = std::min(neighbors.size(), pos + m_bulkChunkSize);
+        uint32_t count = (uint32_t)(end - start);
 
-    nhid = nhEntry->nhid;
-    LOGG(TEST_DEBUG, NEIGHBOR, "next_hop_id 0x%lx\n", nhid);
+        entries.resize(count);
+        attrs.resize(count);
+        attrCounts.assign(count, 1);
+        attrPtrs.resize(count);
+        statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
 
-    nbEntry.rif_id = rif_id;
-    nbEntry.nhid = nhid;
-    m_ip2NbrMap[ipAddr] = nbEntry;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const NeighborEntry &nbEntry = neighbors[start + i].second;
 
-    return true;
+            fill_neighbor_entry(neighbors[start + i].first, nbEntry.rif_id, entries[i]);
+
+            attrs[i].id = SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS;
+            memcpy(attrs[i].value.mac, nbEntry.macAddr.to_bytes(), 6);
+            attrPtrs[i] = &attrs[i];
+        }
+
+        pos = end;
+
+        sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+        if (sai_neighbor_api->create_neighbor_entries)
+        {
+            status = sai_neighbor_api->create_neighbor_entries(count, entries.data(),
+                     attrCounts.data(), attrPtrs.data(),
+                     SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                     statuses.data());
+        }
+
+        if (status == SAI_STATUS_NOT_IMPLEMENTED || status == SAI_STATUS_NOT_SUPPORTED)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                statuses[i] = sai_neighbor_api->create_neighbor_entry(&entries[i], 1, attrPtrs[i]);
+            }
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const IpAddress &ipAddr = neighbors[start + i].first;
+            NeighborEntry nbEntry = neighbors[start + i].second;
+
+            if (statuses[i] != SAI_STATUS_SUCCESS)
+            {
+                LOGG(TEST_ERR, NEIGHBOR, "fail to create neighbor %s, rc=0x%x\n",
+                     ipAddr.to_string().c_str(), -statuses[i]);
+                failures++;
+                continue;
+            }
+
+            if (!AddNextHop(vr_id, ipAddr, nbEntry))
+            {
+                remove_untracked_neighbor(ipAddr, entries[i]);
+                failures++;
+                continue;
+            }
+
+            added.push_back(ipAddr);
+        }
+    }
+
+    Resolve(vr_id, added);
+
+    return (failures == 0);
 }
 
 bool NeighborMgr::Del(IpAddress ipAddr)
+{
+    return Del(g_vr_id, ipAddr);
+}
+
+bool NeighborMgr::Del(sai_object_id_t vr_id, IpAddress ipAddr)
 {
     sai_status_t status;
     sai_neighbor_entry_t sainb;
 
-    const NeighborEntry *nbEntry = NeighborMgr::GetNeighborEntry(ipAddr);
+    const NeighborEntry *nbEntry = NeighborMgr::GetNeighborEntry(vr_id, ipAddr);
 
     if (!nbEntry)
     {
@@ -148,16 +389,14 @@ bool NeighborMgr::Del(IpAddress ipAddr)
         return true;
     }
 
-    if (!m_nhMgr->Del(ipAddr))
+    if (!m_nhMgr->Del(vr_id, ipAddr))
     {
         LOGG(TEST_INFO, NEIGHBOR, "fail to remove nexthop\n");
         return false;
     }
 
 
-    sainb.rif_id = nbEntry->rif_id;
-    sainb.ip_address.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    sainb.ip_address.addr.ip4 = ipAddr.addr();
+    fill_neighbor_entry(ipAddr, nbEntry->rif_id, sainb);
 
     LOGG(TEST_INFO, NEIGHBOR, "sai_neighbor_api->remove_neighbor_entry ip %s rif_id 0x%lx \n",
          ipAddr.to_string().c_str(), nbEntry->rif_id);
@@ -170,17 +409,17 @@ bool NeighborMgr::Del(IpAddress ipAddr)
         return false;
     }
 
-    m_ip2NbrMap.erase(ipAddr);
+    m_ip2NbrMap.erase(VrfIpAddress(vr_id, ipAddr));
     return true;
 }
 
 bool NeighborMgr::EraseAll()
 {
-    std::map<IpAddress, NeighborEntry>::iterator itnb;
-
-    for (itnb = m_ip2NbrMap.begin(); itnb != m_ip2NbrMap.end(); ++itnb)
+    while (!m_ip2NbrMap.empty())
     {
-        if (!NeighborMgr::Del(itnb->first))
+        VrfIpAddress key = m_ip2NbrMap.begin()->first;
+
+        if (!NeighborMgr::Del(key.vr_id, key.ip))
         {
             return false;
         }
@@ -191,7 +430,12 @@ bool NeighborMgr::EraseAll()
 
 const NeighborEntry* NeighborMgr::GetNeighborEntry(const IpAddress &ip) const
 {
-    std::map<IpAddress, NeighborEntry>::const_iterator it = m_ip2NbrMap.find(ip);
+    return GetNeighborEntry(g_vr_id, ip);
+}
+
+const NeighborEntry* NeighborMgr::GetNeighborEntry(sai_object_id_t vr_id, const IpAddress &ip) const
+{
+    std::unordered_map<VrfIpAddress, NeighborEntry>::const_iterator it = m_ip2NbrMap.find(VrfIpAddress(vr_id, ip));
 
     if (it != m_ip2NbrMap.end())
     {
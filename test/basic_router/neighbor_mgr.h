@@ -22,7 +22,10 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <sainexthop.h>
 
 #include "log.h"
@@ -32,6 +35,8 @@
 
 class NextHopMgr;
 
+#define NEIGHBOR_BULK_CHUNK_SIZE_DEFAULT    1024
+
 struct NeighborEntry
 {
     MacAddress macAddr;
@@ -40,22 +45,76 @@ struct NeighborEntry
     sai_object_id_t rif_id;
 };
 
+// nhid is filled in by NeighborMgr
+typedef std::vector<std::pair<IpAddress, NeighborEntry> > NeighborBatch;
+
+// what is waiting on a neighbor: routes which could not be programmed at
+// all, and nexthop sets programmed without it
+struct PendingResolution
+{
+    std::unordered_set<IpPrefix> routes;
+    std::unordered_set<IpAddresses> nexthopSets;
+};
+
+class NeighborListener
+{
+public:
+    virtual ~NeighborListener() {}
+
+    // once per Add()/AddBatch(), with everything that waited on the new
+    // neighbors; the waits are dropped before the call
+    virtual void OnNeighborsResolved(sai_object_id_t vr_id, const PendingResolution &resolved) = 0;
+};
+
 class NeighborMgr
 {
-    std::map<IpAddress, NeighborEntry> m_ip2NbrMap;
+    std::unordered_map<VrfIpAddress, NeighborEntry> m_ip2NbrMap;
     NextHopMgr* m_nhMgr;
 
+    // pending resolution index, keyed by the nexthop waited for
+    std::unordered_map<VrfIpAddress, PendingResolution> m_pending;
+    NeighborListener* m_listener;
+
+    uint32_t m_bulkChunkSize;
+
+    bool AddNextHop(sai_object_id_t vr_id, const IpAddress &ipAddr, NeighborEntry &nbEntry);
+    void Resolve(sai_object_id_t vr_id, const std::vector<IpAddress> &ipAddrs);
+
 public:
     NeighborMgr(NextHopMgr* nhMgr);
 
+    bool Add(sai_object_id_t vr_id,
+             IpAddress ipAddr,
+             MacAddress macAddr,
+             std::string intfAlias,
+             sai_object_id_t rif_id
+            );
+    bool Del(sai_object_id_t vr_id, IpAddress ipAddr);
+
+    // neighbors in the default VRF (g_vr_id)
     bool Add(IpAddress ipAddr,
              MacAddress macAddr,
              std::string intfAlias,
              sai_object_id_t rif_id
             );
     bool Del(IpAddress ipAddr);
+
+    // create_neighbor_entries() in chunks, then one resolution round for
+    // all the neighbors added
+    bool AddBatch(sai_object_id_t vr_id, const NeighborBatch &neighbors);
+
+    void SetListener(NeighborListener* listener);
+
+    void WaitForRoute(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpPrefix &prefix);
+    void CancelRoute(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpPrefix &prefix);
+    void WaitForNextHops(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpAddresses &nexthops);
+    void CancelNextHops(sai_object_id_t vr_id, const IpAddress &ipAddr, const IpAddresses &nexthops);
+    const PendingResolution* GetPending(sai_object_id_t vr_id, const IpAddress &ipAddr) const;
+
+    void SetBulkChunkSize(uint32_t chunkSize);
     bool EraseAll();
     void Show();
 
+    const NeighborEntry* GetNeighborEntry(sai_object_id_t vr_id, const IpAddress &) const;
     const NeighborEntry* GetNeighborEntry(const IpAddress &) const;
 };
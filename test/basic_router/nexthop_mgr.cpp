@@ -30,6 +30,7 @@
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <sstream>
 #include <stdio.h>
 #include <string>
@@ -39,22 +40,32 @@
 
 extern sai_next_hop_api_t* sai_next_hop_api;
 
+extern sai_object_id_t g_switch_id;
+
 void NextHopMgr::Show()
 {
-    std::map<IpAddress, NextHopEntry>::const_iterator it;
+    std::unordered_map<VrfIpAddress, NextHopEntry>::const_iterator it;
+    std::map<VrfIpAddress, const NextHopEntry*> sorted;
+    std::map<VrfIpAddress, const NextHopEntry*>::const_iterator itsorted;
     const NextHopEntry* nhEntry;
     MacAddress mac;
 
+    for (it = m_ip2NextHopMap.begin(); it != m_ip2NextHopMap.end(); it++)
+    {
+        sorted.insert(std::make_pair(it->first, &it->second));
+    }
+
 
     LOGG(TEST_DEBUG, NEXTHOP, "\t--- --- --- --- --- --- NextHop Entry Table --- --- --- --- --- --- \n");
-    LOGG(TEST_DEBUG, NEXTHOP, "\t%-15s %-20s  via %-10s %-14s %-14s\n", "station", "mac_addr", "intf", "rif_id", "next_hop_id");
+    LOGG(TEST_DEBUG, NEXTHOP, "\t%-14s %-15s %-20s  via %-10s %-14s %-14s\n", "vr_id", "station", "mac_addr", "intf", "rif_id", "next_hop_id");
 
-    for (it = m_ip2NextHopMap.begin(); it != m_ip2NextHopMap.end(); it++)
+    for (itsorted = sorted.begin(); itsorted != sorted.end(); itsorted++)
     {
-        nhEntry = &it->second;
+        nhEntry = itsorted->second;
         mac =  nhEntry->macAddr;
-        LOGG(TEST_DEBUG, NEXTHOP, "\t%-15s %-20s  via %-10s 0x%-12lx 0x%-12lx\n",
-             it->first.to_string().c_str(),
+        LOGG(TEST_DEBUG, NEXTHOP, "\t0x%-12lx %-15s %-20s  via %-10s 0x%-12lx 0x%-12lx\n",
+             itsorted->first.vr_id,
+             itsorted->first.ip.to_string().c_str(),
              mac.to_string().c_str(),
              nhEntry->intfAlias.c_str(),
              nhEntry->rif_id,
@@ -65,7 +76,8 @@ void NextHopMgr::Show()
 
 }
 
-bool NextHopMgr::Add(IpAddress ipAddr,
+bool NextHopMgr::Add(sai_object_id_t vr_id,
+                     IpAddress ipAddr,
                      MacAddress macAddr,
                      std::string intfAlias,
                      sai_object_id_t rif_id)
@@ -82,7 +94,7 @@ bool NextHopMgr::Add(IpAddress ipAddr,
     NextHopEntry nhEntry;
     nhEntry.macAddr = macAddr;
     nhEntry.intfAlias = intfAlias;
-    std::map<IpAddress, NextHopEntry>::iterator itnh = m_ip2NextHopMap.find(ipAddr);
+    std::unordered_map<VrfIpAddress, NextHopEntry>::iterator itnh = m_ip2NextHopMap.find(VrfIpAddress(vr_id, ipAddr));
 
     if (itnh != m_ip2NextHopMap.end())
     {
@@ -99,13 +111,12 @@ bool NextHopMgr::Add(IpAddress ipAddr,
 
     sai_attribute_t nhattrs[3];
     nhattrs[0].id = SAI_NEXT_HOP_ATTR_TYPE;
-    nhattrs[0].value.u64 = SAI_NEXT_HOP_IP;
+    nhattrs[0].value.s32 = SAI_NEXT_HOP_TYPE_IP;
     nhattrs[1].id = SAI_NEXT_HOP_ATTR_IP;
-    nhattrs[1].value.ipaddr.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    nhattrs[1].value.ipaddr.addr.ip4 = ipAddr.addr();
+    copy_ip_address(nhattrs[1].value.ipaddr, ipAddr);
     nhattrs[2].id = SAI_NEXT_HOP_ATTR_ROUTER_INTERFACE_ID;
     nhattrs[2].value.oid = rif_id;
-    status = sai_next_hop_api->create_next_hop(&nhid, 3, nhattrs);
+    status = sai_next_hop_api->create_next_hop(&nhid, g_switch_id, 3, nhattrs);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -124,17 +135,17 @@ bool NextHopMgr::Add(IpAddress ipAddr,
 
     nhEntry.rif_id = rif_id;
     nhEntry.nhid = nhid;
-    m_ip2NextHopMap[ipAddr] = nhEntry;
+    m_ip2NextHopMap[VrfIpAddress(vr_id, ipAddr)] = nhEntry;
 
     return true;
 }
 
-bool NextHopMgr::Del(IpAddress ipAddr)
+bool NextHopMgr::Del(sai_object_id_t vr_id, IpAddress ipAddr)
 {
     sai_status_t status;
     sai_object_id_t nhid;
 
-    const NextHopEntry *nhEntry = NextHopMgr::GetNextHopEntry(ipAddr);
+    const NextHopEntry *nhEntry = NextHopMgr::GetNextHopEntry(vr_id, ipAddr);
 
     if (!nhEntry)
     {
@@ -154,17 +165,17 @@ bool NextHopMgr::Del(IpAddress ipAddr)
         return false;
     }
 
-    m_ip2NextHopMap.erase(ipAddr);
+    m_ip2NextHopMap.erase(VrfIpAddress(vr_id, ipAddr));
     return true;
 }
 
 bool NextHopMgr::EraseAll()
 {
-    std::map<IpAddress, NextHopEntry>::iterator itnh;
-
-    for (itnh = m_ip2NextHopMap.begin(); itnh != m_ip2NextHopMap.end(); ++itnh)
+    while (!m_ip2NextHopMap.empty())
     {
-        if (!NextHopMgr::Del(itnh->first))
+        VrfIpAddress key = m_ip2NextHopMap.begin()->first;
+
+        if (!NextHopMgr::Del(key.vr_id, key.ip))
         {
             return false;
         }
@@ -173,9 +184,9 @@ bool NextHopMgr::EraseAll()
     return true;
 }
 
-const NextHopEntry* NextHopMgr::GetNextHopEntry(const IpAddress &ip) const
+const NextHopEntry* NextHopMgr::GetNextHopEntry(sai_object_id_t vr_id, const IpAddress &ip) const
 {
-    std::map<IpAddress, NextHopEntry>::const_iterator it = m_ip2NextHopMap.find(ip);
+    std::unordered_map<VrfIpAddress, NextHopEntry>::const_iterator it = m_ip2NextHopMap.find(VrfIpAddress(vr_id, ip));
 
     if (it != m_ip2NextHopMap.end())
     {
@@ -23,7 +23,7 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <sainexthop.h>
 
 #include "log.h"
@@ -41,17 +41,18 @@ struct NextHopEntry
 
 class NextHopMgr
 {
-    std::map<IpAddress, NextHopEntry> m_ip2NextHopMap;
+    std::unordered_map<VrfIpAddress, NextHopEntry> m_ip2NextHopMap;
 
 public:
-    bool Add(IpAddress ipAddr,
+    bool Add(sai_object_id_t vr_id,
+             IpAddress ipAddr,
              MacAddress macAddr,
              std::string intfAlias,
              sai_object_id_t rif_id
             );
-    bool Del(IpAddress ipAddr);
+    bool Del(sai_object_id_t vr_id, IpAddress ipAddr);
     bool EraseAll();
     void Show();
 
-    const NextHopEntry* GetNextHopEntry(const IpAddress &) const;
+    const NextHopEntry* GetNextHopEntry(sai_object_id_t vr_id, const IpAddress &) const;
 };
@@ -41,138 +41,393 @@
 
 extern sai_next_hop_group_api_t* sai_next_hop_group_api;
 
+extern sai_object_id_t g_switch_id;
+
 NextHopGrpMgr::NextHopGrpMgr(NeighborMgr* neighborMgr) : m_neighborMgr(neighborMgr)
 {
 }
 
 void NextHopGrpMgr::Show()
 {
-    std::map<IpAddresses, NextHopGrpEntry>::const_iterator it;
+    NextHopGrpTable::const_iterator it;
+    std::map<VrfNextHops, const NextHopGrpEntry*> sorted;
+    std::map<VrfNextHops, const NextHopGrpEntry*>::const_iterator itsorted;
     const NextHopGrpEntry* nhgEntry;
 
+    for (it = m_ips2NextHGMap.begin(); it != m_ips2NextHGMap.end(); it++)
+    {
+        sorted.insert(std::make_pair(it->first, &it->second));
+    }
+
     LOGG(TEST_DEBUG, NXTHG, "\t--- --- --- --- --- --- NextHopGroup Entry Table --- --- --- --- --- --- \n");
-    LOGG(TEST_DEBUG, NXTHG, "\t%-14s    %s\n", "next_hop_grp_id", "nexthops");
+    LOGG(TEST_DEBUG, NXTHG, "\t%-14s %-14s %-8s %-8s    %s\n", "vr_id", "next_hop_grp_id", "refcnt", "members", "nexthops");
 
-    for (it = m_ips2NextHGMap.begin(); it != m_ips2NextHGMap.end(); it++)
+    for (itsorted = sorted.begin(); itsorted != sorted.end(); itsorted++)
     {
-        nhgEntry = &it->second;
+        nhgEntry = itsorted->second;
 
-        LOGG(TEST_DEBUG, NXTHG, "\t0x%-12lx     %s\n",
+        LOGG(TEST_DEBUG, NXTHG, "\t0x%-12lx 0x%-12lx %-8u %-8zu     %s\n",
+             itsorted->first.first,
              nhgEntry->nhg_id,
-             it->first.to_string().c_str());
+             nhgEntry->refCount,
+             nhgEntry->members.size(),
+             itsorted->first.second.to_string().c_str());
     }
 
     LOGG(TEST_DEBUG, NXTHG, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- ---- \n");
 }
 
-bool NextHopGrpMgr::Add(IpAddresses nextHops)
+bool NextHopGrpMgr::AddMembers(sai_object_id_t vr_id, NextHopGrpEntry &nhgEntry, const std::vector<IpAddress> &nextHops)
 {
-    sai_status_t status;
-    NextHopGrpEntry nhgEntry;
-    nhgEntry.nextHops = nextHops;
+    std::vector<IpAddress> ips;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrPtrs;
+    std::vector<sai_object_id_t> memberIds;
+    std::vector<sai_status_t> statuses;
+    sai_attribute_t attr;
+    bool ret = true;
+
+    for (size_t i = 0; i < nextHops.size(); i++)
+    {
+        const NeighborEntry *nbEntry = m_neighborMgr->GetNeighborEntry(vr_id, nextHops[i]);
 
-    std::map<IpAddresses, NextHopGrpEntry>::iterator itnhg = m_ips2NextHGMap.find(nextHops);
+        if (!nbEntry)
+        {
+            LOGG(TEST_ERR, NXTHG, "fail to find the neighbor entry for nexthop %s\n", nextHops[i].to_string().c_str());
+            continue;
+        }
 
-    //create Next Hop Group
-    sai_object_id_t nhg_id;
-    std::vector<sai_object_id_t> nhids;
+        ips.push_back(nextHops[i]);
 
-    std::set<IpAddress> addrset = nextHops.AddrSet();
+        attr.id = SAI_NEXT_HOP_GROUP_MEMBER_ATTR_NEXT_HOP_GROUP_ID;
+        attr.value.oid = nhgEntry.nhg_id;
+        attrs.push_back(attr);
 
-    std::vector<sai_attribute_t> nhg_attrs;
-    sai_attribute_t nhg_attr;
+        attr.id = SAI_NEXT_HOP_GROUP_MEMBER_ATTR_NEXT_HOP_ID;
+        attr.value.oid = nbEntry->nhid;
+        attrs.push_back(attr);
+    }
 
-    //walkthrough the nexthops
-    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    uint32_t count = (uint32_t)ips.size();
+
+    if (count == 0)
     {
-        const NeighborEntry *nbEntry = m_neighborMgr->GetNeighborEntry(*itnh);
+        return ret;
+    }
 
-        if (!nbEntry)
+    attrCounts.assign(count, 2);
+    attrPtrs.resize(count);
+    memberIds.assign(count, SAI_NULL_OBJECT_ID);
+    statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        attrPtrs[i] = &attrs[2 * i];
+    }
+
+    LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->create_next_hop_group_members nhg_id 0x%lx count %u\n",
+         nhgEntry.nhg_id, count);
+
+    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+    if (sai_next_hop_group_api->create_next_hop_group_members)
+    {
+        status = sai_next_hop_group_api->create_next_hop_group_members(g_switch_id, count,
+                 attrCounts.data(), attrPtrs.data(),
+                 SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                 memberIds.data(), statuses.data());
+    }
+
+    if (status == SAI_STATUS_NOT_IMPLEMENTED || status == SAI_STATUS_NOT_SUPPORTED)
+    {
+        for (uint32_t i = 0; i < count; i++)
         {
-            LOGG(TEST_ERR, NXTHG, "fail to find the neighbor entry for nexthop %s\n", itnh->to_string().c_str());
+            statuses[i] = sai_next_hop_group_api->create_next_hop_group_member(&memberIds[i], g_switch_id,
+                          2, attrPtrs[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, NXTHG, "fail to add nexthop %s to group 0x%lx. status=0x%x\n",
+                 ips[i].to_string().c_str(), nhgEntry.nhg_id, -statuses[i]);
+            ret = false;
             continue;
         }
 
-        nhg_id = nbEntry->nhid;
-        nhids.push_back(nbEntry->nhid);
+        nhgEntry.members[ips[i]] = memberIds[i];
     }
 
-    //nexthops contain 0 neighbors
-    if (nhids.size() == 0)
+    return ret;
+}
+
+bool NextHopGrpMgr::RemoveMembers(NextHopGrpEntry &nhgEntry, const std::vector<IpAddress> &nextHops)
+{
+    std::vector<IpAddress> ips;
+    std::vector<sai_object_id_t> memberIds;
+    std::vector<sai_status_t> statuses;
+    bool ret = true;
+
+    for (size_t i = 0; i < nextHops.size(); i++)
     {
-        LOGG(TEST_DEBUG, NXTHG, "cannot find the any of nexthops %s in the neighbor table\n", nextHops.to_string().c_str());
-        return false;
+        std::map<IpAddress, sai_object_id_t>::const_iterator it = nhgEntry.members.find(nextHops[i]);
+
+        if (it == nhgEntry.members.end())
+        {
+            continue;
+        }
+
+        ips.push_back(it->first);
+        memberIds.push_back(it->second);
     }
 
-    if (nhids.size() > 1)
+    uint32_t count = (uint32_t)ips.size();
+
+    if (count == 0)
     {
-        nhg_attr.id = SAI_NEXT_HOP_GROUP_ATTR_TYPE;
-        nhg_attr.value.s32 = SAI_NEXT_HOP_GROUP_ECMP;
-        nhg_attrs.push_back(nhg_attr);
+        return ret;
+    }
 
-        nhg_attr.id = SAI_NEXT_HOP_GROUP_ATTR_NEXT_HOP_LIST;
-        nhg_attr.value.objlist.count = nhids.size();
-        nhg_attr.value.objlist.list = nhids.data();
-        nhg_attrs.push_back(nhg_attr);
+    statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
 
-        LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->create_next_hop_group %s\n",  nextHops.to_string().c_str());
-        status = sai_next_hop_group_api->create_next_hop_group(&nhg_id, nhg_attrs.size(), nhg_attrs.data());
+    LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->remove_next_hop_group_members nhg_id 0x%lx count %u\n",
+         nhgEntry.nhg_id, count);
 
-        if (status != SAI_STATUS_SUCCESS)
+    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+    if (sai_next_hop_group_api->remove_next_hop_group_members)
+    {
+        status = sai_next_hop_group_api->remove_next_hop_group_members(count, memberIds.data(),
+                 SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                 statuses.data());
+    }
+
+    if (status == SAI_STATUS_NOT_IMPLEMENTED || status == SAI_STATUS_NOT_SUPPORTED)
+    {
+        for (uint32_t i = 0; i < count; i++)
         {
-            LOGG(TEST_ERR, NXTHG, "fail to create ECMP group for %s. status=0x%x\n", nextHops.to_string().c_str(), -status);
-            return false;
+            statuses[i] = sai_next_hop_group_api->remove_next_hop_group_member(memberIds[i]);
         }
+    }
 
-        if (!SAI_OID_TYPE_CHECK(nhg_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP))
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (statuses[i] != SAI_STATUS_SUCCESS)
         {
-            LOGG(TEST_ERR, NXTHG, "next hop group oid generated is not the right type\n");
-            return false;
+            LOGG(TEST_ERR, NXTHG, "fail to remove nexthop %s from group 0x%lx. status=0x%x\n",
+                 ips[i].to_string().c_str(), nhgEntry.nhg_id, -statuses[i]);
+            ret = false;
+            continue;
         }
 
-        nhgEntry.nhg_id = nhg_id;
+        nhgEntry.members.erase(ips[i]);
+    }
+
+    return ret;
+}
+
+bool NextHopGrpMgr::Add(IpAddresses nextHops)
+{
+    return Add(g_vr_id, nextHops);
+}
 
-        LOGG(TEST_DEBUG, NXTHG, "create ECMP groupnexthops %s nhg_id 0x%lx\n",
-             nextHops.to_string().c_str(), nhg_id);
+bool NextHopGrpMgr::Add(sai_object_id_t vr_id, IpAddresses nextHops)
+{
+    sai_status_t status;
+    NextHopGrpTable::iterator itnhg = m_ips2NextHGMap.find(VrfNextHops(vr_id, nextHops));
+
+    if (itnhg != m_ips2NextHGMap.end())
+    {
+        itnhg->second.refCount++;
+        return true;
     }
 
+    NextHopGrpEntry nhgEntry;
+    nhgEntry.nextHops = nextHops;
+    nhgEntry.refCount = 1;
+
+    //create Next Hop Group
+    sai_object_id_t nhg_id;
+    sai_attribute_t nhg_attr;
+
+    nhg_attr.id = SAI_NEXT_HOP_GROUP_ATTR_TYPE;
+    nhg_attr.value.s32 = SAI_NEXT_HOP_GROUP_TYPE_ECMP;
+
+    LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->create_next_hop_group %s\n",  nextHops.to_string().c_str());
+    status = sai_next_hop_group_api->create_next_hop_group(&nhg_id, g_switch_id, 1, &nhg_attr);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, NXTHG, "fail to create ECMP group for %s. status=0x%x\n", nextHops.to_string().c_str(), -status);
+        return false;
+    }
+
+    if (!SAI_OID_TYPE_CHECK(nhg_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP))
+    {
+        LOGG(TEST_ERR, NXTHG, "next hop group oid generated is not the right type\n");
+        return false;
+    }
+
+    nhgEntry.nhg_id = nhg_id;
+
+    //walkthrough the nexthops
+    std::vector<IpAddress> ips(nextHops.AddrSet().begin(), nextHops.AddrSet().end());
+
+    AddMembers(vr_id, nhgEntry, ips);
+
+    //nexthops contain 0 neighbors
+    if (nhgEntry.members.empty())
+    {
+        LOGG(TEST_DEBUG, NXTHG, "cannot find the any of nexthops %s in the neighbor table\n", nextHops.to_string().c_str());
+        sai_next_hop_group_api->remove_next_hop_group(nhg_id);
+        return false;
+    }
+
+    LOGG(TEST_DEBUG, NXTHG, "create ECMP groupnexthops %s nhg_id 0x%lx\n",
+         nextHops.to_string().c_str(), nhg_id);
+
     //insert this entry to the internal data structure
-    m_ips2NextHGMap[nextHops] = nhgEntry;
+    m_ips2NextHGMap[VrfNextHops(vr_id, nextHops)] = nhgEntry;
     return true;
 }
 
+bool NextHopGrpMgr::Update(sai_object_id_t vr_id, const IpAddresses &oldNextHops, const IpAddresses &newNextHops)
+{
+    NextHopGrpTable::iterator itnhg = m_ips2NextHGMap.find(VrfNextHops(vr_id, oldNextHops));
+
+    if (itnhg == m_ips2NextHGMap.end())
+    {
+        LOGG(TEST_ERR, NXTHG, "cannot find nexthop group %s\n", oldNextHops.to_string().c_str());
+        return false;
+    }
+
+    if (m_ips2NextHGMap.find(VrfNextHops(vr_id, newNextHops)) != m_ips2NextHGMap.end())
+    {
+        LOGG(TEST_ERR, NXTHG, "nexthop group %s already exists\n", newNextHops.to_string().c_str());
+        return false;
+    }
+
+    const std::set<IpAddress> &oldSet = oldNextHops.AddrSet();
+    const std::set<IpAddress> &newSet = newNextHops.AddrSet();
+    std::vector<IpAddress> added;
+    std::vector<IpAddress> removed;
+
+    std::set_difference(newSet.begin(), newSet.end(), oldSet.begin(), oldSet.end(), std::back_inserter(added));
+    std::set_difference(oldSet.begin(), oldSet.end(), newSet.begin(), newSet.end(), std::back_inserter(removed));
+
+    NextHopGrpEntry nhgEntry = itnhg->second;
+
+    LOGG(TEST_INFO, NXTHG, "update nhg_id 0x%lx %s -> %s, +%zu -%zu members\n",
+         nhgEntry.nhg_id, oldNextHops.to_string().c_str(), newNextHops.to_string().c_str(),
+         added.size(), removed.size());
+
+    // add before remove, the group never goes empty on a member swap
+    bool ret = AddMembers(vr_id, nhgEntry, added);
+    ret = RemoveMembers(nhgEntry, removed) && ret;
+
+    nhgEntry.nextHops = newNextHops;
+
+    m_ips2NextHGMap.erase(itnhg);
+    m_ips2NextHGMap[VrfNextHops(vr_id, newNextHops)] = nhgEntry;
+
+    return ret;
+}
+
+bool NextHopGrpMgr::Refresh(sai_object_id_t vr_id, const IpAddresses &nextHops)
+{
+    NextHopGrpTable::iterator itnhg = m_ips2NextHGMap.find(VrfNextHops(vr_id, nextHops));
+
+    if (itnhg == m_ips2NextHGMap.end())
+    {
+        LOGG(TEST_ERR, NXTHG, "cannot find nexthop group %s\n", nextHops.to_string().c_str());
+        return false;
+    }
+
+    NextHopGrpEntry &nhgEntry = itnhg->second;
+    const std::set<IpAddress> &addrset = nextHops.AddrSet();
+    std::vector<IpAddress> missing;
+
+    for (std::set<IpAddress>::const_iterator it = addrset.begin(); it != addrset.end(); ++it)
+    {
+        if (nhgEntry.members.find(*it) == nhgEntry.members.end() &&
+                m_neighborMgr->GetNeighborEntry(vr_id, *it))
+        {
+            missing.push_back(*it);
+        }
+    }
+
+    LOGG(TEST_INFO, NXTHG, "refresh nhg_id 0x%lx %s, +%zu members\n",
+         nhgEntry.nhg_id, nextHops.to_string().c_str(), missing.size());
+
+    return AddMembers(vr_id, nhgEntry, missing);
+}
+
 bool NextHopGrpMgr::Del(IpAddresses nextHops)
+{
+    return Del(g_vr_id, nextHops);
+}
+
+bool NextHopGrpMgr::Del(sai_object_id_t vr_id, IpAddresses nextHops)
 {
     sai_object_id_t nhg_id;
     sai_status_t status;
 
-    const NextHopGrpEntry *nhgEntry = NextHopGrpMgr::GetNextHopGrpEntry(nextHops);
+    NextHopGrpTable::iterator itnhg = m_ips2NextHGMap.find(VrfNextHops(vr_id, nextHops));
 
-    if (!nhgEntry)
+    if (itnhg == m_ips2NextHGMap.end())
     {
         return false;
     }
 
-    nhg_id = nhgEntry->nhg_id;
+    NextHopGrpEntry &nhgEntry = itnhg->second;
+
+    if (--nhgEntry.refCount > 0)
+    {
+        return true;
+    }
+
+    nhg_id = nhgEntry.nhg_id;
+
+    std::vector<IpAddress> ips;
 
-    LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->sai_remove_next_hop_group nhg_id 0x%lx \n", nhg_id);
+    for (std::map<IpAddress, sai_object_id_t>::const_iterator it = nhgEntry.members.begin(); it != nhgEntry.members.end(); ++it)
+    {
+        ips.push_back(it->first);
+    }
+
+    if (!RemoveMembers(nhgEntry, ips))
+    {
+        nhgEntry.refCount++;
+        return false;
+    }
+
+    LOGG(TEST_INFO, NXTHG, "sai_next_hop_group_api->remove_next_hop_group nhg_id 0x%lx\n", nhg_id);
 
     status = sai_next_hop_group_api->remove_next_hop_group(nhg_id);
 
     if (status != SAI_STATUS_SUCCESS)
     {
-        LOGG(TEST_ERR, ROUTE, "failed to remove nhg_id 0x%lx rc=0x%x\n", nhg_id, -status);
+        LOGG(TEST_ERR, NXTHG, "fail to remove ECMP group 0x%lx. status=0x%x\n", nhg_id, -status);
+        nhgEntry.refCount++;
         return false;
     }
 
-    m_ips2NextHGMap.erase(nextHops);
+    m_ips2NextHGMap.erase(itnhg);
 
     return true;
 }
 
 const NextHopGrpEntry* NextHopGrpMgr::GetNextHopGrpEntry(const IpAddresses &ips) const
 {
-    std::map<IpAddresses, NextHopGrpEntry>::const_iterator it = m_ips2NextHGMap.find(ips);
+    return GetNextHopGrpEntry(g_vr_id, ips);
+}
+
+const NextHopGrpEntry* NextHopGrpMgr::GetNextHopGrpEntry(sai_object_id_t vr_id, const IpAddresses &ips) const
+{
+    NextHopGrpTable::const_iterator it = m_ips2NextHGMap.find(VrfNextHops(vr_id, ips));
 
     if (it != m_ips2NextHGMap.end())
     {
@@ -183,4 +438,3 @@ const NextHopGrpEntry* NextHopGrpMgr::GetNextHopGrpEntry(const IpAddresses &ips)
         return NULL;
     }
 }
-
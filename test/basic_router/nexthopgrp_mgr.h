@@ -24,6 +24,8 @@
 #include <set>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 extern "C"
 {
@@ -41,22 +43,44 @@ struct NextHopGrpEntry
 {
     IpAddresses nextHops;
     sai_object_id_t nhg_id;
+    uint32_t refCount;
+    std::map<IpAddress, sai_object_id_t> members;   // nexthop -> group member id
 };
 
+// keyed by the member set, which IpAddresses keeps sorted and deduplicated
+typedef std::unordered_map<VrfNextHops, NextHopGrpEntry> NextHopGrpTable;
+
 class NextHopGrpMgr
 {
 
     NeighborMgr* m_neighborMgr;
 
-    std::map<IpAddresses, NextHopGrpEntry> m_ips2NextHGMap;
+    NextHopGrpTable m_ips2NextHGMap;
+
+    bool AddMembers(sai_object_id_t vr_id, NextHopGrpEntry &nhgEntry, const std::vector<IpAddress> &nextHops);
+    bool RemoveMembers(NextHopGrpEntry &nhgEntry, const std::vector<IpAddress> &nextHops);
 
 public:
     NextHopGrpMgr(NeighborMgr* neighborMgr);
 
+    // Add takes a reference on the group and creates it for the first
+    // user, Del drops one and removes the group with the last user
+    bool Add(sai_object_id_t vr_id, IpAddresses nextHops);
+    bool Del(sai_object_id_t vr_id, IpAddresses nextHops);
+
+    // change the members of an existing group in place; the group keeps its
+    // oid and its users, so routes pointing to it are not touched
+    bool Update(sai_object_id_t vr_id, const IpAddresses &oldNextHops, const IpAddresses &newNextHops);
+
+    // add the members resolved since the group was created
+    bool Refresh(sai_object_id_t vr_id, const IpAddresses &nextHops);
+
+    // groups in the default VRF (g_vr_id)
     bool Add(IpAddresses nextHops);
     bool Del(IpAddresses nextHops);
+
     void Show();
 
+    const NextHopGrpEntry* GetNextHopGrpEntry(sai_object_id_t vr_id, const IpAddresses &) const;
     const NextHopGrpEntry* GetNextHopGrpEntry(const IpAddresses &) const;
 };
-
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include "prefix_trie.h"
+
+bool PrefixTrie::Insert(const IpPrefix &prefix)
+{
+    Node **link = Root(prefix);
+
+    while (*link)
+    {
+        Node *node = *link;
+        int common = node->prefix.CommonLength(prefix);
+
+        if (common < node->prefix.MaskLen())
+        {
+            // prefix diverges inside this node, split it
+            Node *branch;
+
+            if (common == prefix.MaskLen())
+            {
+                branch = new Node(prefix, true);
+                branch->child[node->prefix.Addr().bit(common)] = node;
+            }
+            else
+            {
+                branch = new Node(IpPrefix(prefix.Addr(), common), false);
+                branch->child[node->prefix.Addr().bit(common)] = node;
+                branch->child[prefix.Addr().bit(common)] = new Node(prefix, true);
+            }
+
+            *link = branch;
+            m_size++;
+            return true;
+        }
+
+        if (node->prefix.MaskLen() == prefix.MaskLen())
+        {
+            if (node->present)
+            {
+                return false;
+            }
+
+            node->present = true;
+            m_size++;
+            return true;
+        }
+
+        link = &node->child[prefix.Addr().bit(node->prefix.MaskLen())];
+    }
+
+    *link = new Node(prefix, true);
+    m_size++;
+
+    return true;
+}
+
+bool PrefixTrie::Erase(const IpPrefix &prefix)
+{
+    if (!Erase(Root(prefix), prefix))
+    {
+        return false;
+    }
+
+    m_size--;
+
+    return true;
+}
+
+bool PrefixTrie::Erase(Node **link, const IpPrefix &prefix)
+{
+    Node *node = *link;
+
+    if (!node ||
+            node->prefix.MaskLen() > prefix.MaskLen() ||
+            node->prefix.CommonLength(prefix) < node->prefix.MaskLen())
+    {
+        return false;
+    }
+
+    if (node->prefix.MaskLen() == prefix.MaskLen())
+    {
+        if (!node->present)
+        {
+            return false;
+        }
+
+        node->present = false;
+    }
+    else if (!Erase(&node->child[prefix.Addr().bit(node->prefix.MaskLen())], prefix))
+    {
+        return false;
+    }
+
+    Compact(link);
+
+    return true;
+}
+
+// drop a node that no longer holds a prefix and has less than two children
+void PrefixTrie::Compact(Node **link)
+{
+    Node *node = *link;
+
+    if (node->present || (node->child[0] && node->child[1]))
+    {
+        return;
+    }
+
+    *link = node->child[0] ? node->child[0] : node->child[1];
+
+    delete node;
+}
+
+void PrefixTrie::Clear()
+{
+    Free(m_root[0]);
+    Free(m_root[1]);
+
+    m_root[0] = m_root[1] = NULL;
+    m_size = 0;
+}
+
+void PrefixTrie::Free(Node *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    Free(node->child[0]);
+    Free(node->child[1]);
+
+    delete node;
+}
+
+void PrefixTrie::Walk(std::vector<IpPrefix> &prefixes) const
+{
+    prefixes.reserve(prefixes.size() + m_size);
+
+    Walk(m_root[0], prefixes);
+    Walk(m_root[1], prefixes);
+}
+
+void PrefixTrie::Walk(const Node *node, std::vector<IpPrefix> &prefixes) const
+{
+    if (!node)
+    {
+        return;
+    }
+
+    if (node->present)
+    {
+        prefixes.push_back(node->prefix);
+    }
+
+    Walk(node->child[0], prefixes);
+    Walk(node->child[1], prefixes);
+}
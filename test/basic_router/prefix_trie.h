@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <vector>
+
+#include "ip.h"
+
+// Path compressed binary trie of IPv4 and IPv6 prefixes. Lookups go through
+// the managers' hash tables; the trie only keeps the prefixes in order, so
+// that tables can be dumped and torn down in address order (a covering
+// prefix before the more specific ones) without sorting.
+class PrefixTrie
+{
+    struct Node
+    {
+        IpPrefix prefix;
+        bool present;
+        Node *child[2];
+
+        Node(const IpPrefix &p, bool inTable) : prefix(p), present(inTable)
+        {
+            child[0] = child[1] = NULL;
+        }
+    };
+
+    Node *m_root[2];        // IPv4, IPv6
+    size_t m_size;
+
+    PrefixTrie(const PrefixTrie &);
+    PrefixTrie &operator=(const PrefixTrie &);
+
+    Node **Root(const IpPrefix &prefix)
+    {
+        return &m_root[prefix.isV4() ? 0 : 1];
+    }
+
+    bool Erase(Node **link, const IpPrefix &prefix);
+    void Compact(Node **link);
+    void Free(Node *node);
+    void Walk(const Node *node, std::vector<IpPrefix> &prefixes) const;
+
+public:
+    PrefixTrie() : m_size(0)
+    {
+        m_root[0] = m_root[1] = NULL;
+    }
+
+    ~PrefixTrie()
+    {
+        Clear();
+    }
+
+    // return false when the prefix is already there
+    bool Insert(const IpPrefix &prefix);
+    bool Erase(const IpPrefix &prefix);
+    void Clear();
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    // IPv4 prefixes first, then IPv6, each in address order
+    void Walk(std::vector<IpPrefix> &prefixes) const;
+};
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "rib_loader.h"
+#include "route_mgr.h"
+
+// bounded queue between the parser threads and the programming thread
+class RibBatchQueue
+{
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<RouteBatch> m_batches;
+    size_t m_depth;
+    unsigned m_producers;
+
+public:
+    RibBatchQueue(size_t depth, unsigned producers) : m_depth(depth), m_producers(producers)
+    {
+    }
+
+    void Push(RouteBatch &batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (m_batches.size() >= m_depth)
+        {
+            m_notFull.wait(lock);
+        }
+
+        m_batches.push_back(RouteBatch());
+        m_batches.back().swap(batch);
+        m_notEmpty.notify_one();
+    }
+
+    void ProducerDone()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_producers--;
+        m_notEmpty.notify_all();
+    }
+
+    // false once every producer is done and the queue is drained
+    bool Pop(RouteBatch &batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (m_batches.empty() && m_producers > 0)
+        {
+            m_notEmpty.wait(lock);
+        }
+
+        if (m_batches.empty())
+        {
+            return false;
+        }
+
+        batch.swap(m_batches.front());
+        m_batches.pop_front();
+        m_notFull.notify_one();
+
+        return true;
+    }
+};
+
+struct RibSlice
+{
+    const char *begin;
+    const char *end;
+    size_t routes;
+    size_t parseErrors;
+    std::chrono::steady_clock::time_point done;
+};
+
+static bool is_space(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r');
+}
+
+static void parse_slice(RibSlice *slice, const char *base, size_t batchSize, RibBatchQueue *queue)
+{
+    RouteBatch batch;
+    IpPrefix prefix;
+    IpAddresses nexthops;
+    const char *line = slice->begin;
+
+    batch.reserve(batchSize);
+
+    while (line < slice->end)
+    {
+        const char *eol = (const char *)memchr(line, '\n', slice->end - line);
+
+        if (!eol)
+        {
+            eol = slice->end;
+        }
+
+        try
+        {
+            if (RibLoader::ParseLine(line, eol, prefix, nexthops))
+            {
+                batch.push_back(std::make_pair(prefix, nexthops));
+                slice->routes++;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LOGG(TEST_ERR, RIB, "skip line at offset %zu: %s\n", (size_t)(line - base), e.what());
+            slice->parseErrors++;
+        }
+
+        if (batch.size() >= batchSize)
+        {
+            queue->Push(batch);
+            batch.reserve(batchSize);
+        }
+
+        line = eol + 1;
+    }
+
+    if (!batch.empty())
+    {
+        queue->Push(batch);
+    }
+
+    slice->done = std::chrono::steady_clock::now();
+    queue->ProducerDone();
+}
+
+RibLoader::RibLoader(RouteMgr* routeMgr, unsigned parsers, size_t queueDepth)
+{
+    m_routeMgr = routeMgr;
+    m_parsers = parsers ? parsers : std::thread::hardware_concurrency();
+    m_parsers = m_parsers ? m_parsers : 1;
+    m_batchSize = ROUTE_BULK_CHUNK_SIZE_DEFAULT;
+    m_queueDepth = queueDepth ? queueDepth : 1;
+}
+
+void RibLoader::SetBatchSize(size_t batchSize)
+{
+    m_batchSize = batchSize ? batchSize : 1;
+}
+
+bool RibLoader::ParseLine(const char *begin, const char *end, IpPrefix &prefix, IpAddresses &nexthops)
+{
+    const char *hash = (const char *)memchr(begin, '#', end - begin);
+
+    if (hash)
+    {
+        end = hash;
+    }
+
+    while (begin < end && is_space(*begin))
+    {
+        begin++;
+    }
+
+    while (end > begin && is_space(end[-1]))
+    {
+        end--;
+    }
+
+    if (begin == end)
+    {
+        return false;
+    }
+
+    const char *sep = begin;
+
+    while (sep < end && !is_space(*sep))
+    {
+        sep++;
+    }
+
+    const char *nh = sep;
+
+    while (nh < end && is_space(*nh))
+    {
+        nh++;
+    }
+
+    if (nh == end)
+    {
+        throw std::invalid_argument("no nexthop for " + std::string(begin, sep));
+    }
+
+    prefix = IpPrefix(std::string(begin, sep));
+
+    if (std::string(nh, end) == RIB_NEXTHOP_DROP)
+    {
+        nexthops = IpAddresses();
+    }
+    else
+    {
+        nexthops = IpAddresses(std::string(nh, end));
+    }
+
+    return true;
+}
+
+bool RibLoader::Load(const std::string &path, RibLoadStats &stats)
+{
+    return Load(g_vr_id, path, stats);
+}
+
+bool RibLoader::Load(sai_object_id_t vr_id, const std::string &path, RibLoadStats &stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point parsed = start;
+    struct stat st;
+    struct rusage usage;
+
+    memset(&stats, 0, sizeof(stats));
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        LOGG(TEST_ERR, RIB, "cannot open %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        LOGG(TEST_ERR, RIB, "cannot stat %s: %s\n", path.c_str(), strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const char *base = NULL;
+
+    if (size > 0)
+    {
+        void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (addr == MAP_FAILED)
+        {
+            LOGG(TEST_ERR, RIB, "cannot mmap %s: %s\n", path.c_str(), strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        madvise(addr, size, MADV_SEQUENTIAL);
+        base = (const char *)addr;
+    }
+
+    close(fd);
+
+    // one slice per parser, each one starting right after a newline
+    std::vector<RibSlice> slices;
+    const char *end = base + size;
+    const char *pos = base;
+
+    for (unsigned i = 0; i < m_parsers && pos < end; i++)
+    {
+        RibSlice slice;
+        const char *cut = (i + 1 == m_parsers) ? end : base + size * (i + 1) / m_parsers;
+
+        if (cut < pos)
+        {
+            cut = pos;
+        }
+
+        const char *eol = (const char *)memchr(cut, '\n', end - cut);
+        cut = eol ? eol + 1 : end;
+
+        slice.begin = pos;
+        slice.end = cut;
+        slice.routes = 0;
+        slice.parseErrors = 0;
+        slices.push_back(slice);
+
+        pos = cut;
+    }
+
+    LOGG(TEST_INFO, RIB, "load %s, %zu bytes, %zu parsers, %zu routes per batch\n",
+         path.c_str(), size, slices.size(), m_batchSize);
+
+    RibBatchQueue queue(m_queueDepth, (unsigned)slices.size());
+    std::vector<std::thread> parsers;
+
+    for (size_t i = 0; i < slices.size(); i++)
+    {
+        parsers.push_back(std::thread(parse_slice, &slices[i], base, m_batchSize, &queue));
+    }
+
+    RouteBatch batch;
+
+    while (queue.Pop(batch))
+    {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+
+        if (!m_routeMgr->AddBatch(vr_id, batch))
+        {
+            stats.failedBatches++;
+        }
+
+        stats.programSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+    }
+
+    for (size_t i = 0; i < parsers.size(); i++)
+    {
+        parsers[i].join();
+
+        stats.routes += slices[i].routes;
+        stats.parseErrors += slices[i].parseErrors;
+
+        if (slices[i].done > parsed)
+        {
+            parsed = slices[i].done;
+        }
+    }
+
+    if (base)
+    {
+        munmap((void *)base, size);
+    }
+
+    stats.parseSeconds = std::chrono::duration<double>(parsed - start).count();
+    stats.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        stats.peakRssKb = usage.ru_maxrss;
+    }
+
+    return (stats.parseErrors == 0 && stats.failedBatches == 0);
+}
+
+void RibLoader::Show(const RibLoadStats &stats)
+{
+    LOGG(TEST_INFO, RIB, "\t--- --- --- --- --- --- RIB Load --- --- --- --- --- --- ---\n");
+    LOGG(TEST_INFO, RIB, "\t%-16s %zu (%zu parse errors, %zu failed batches)\n",
+         "routes", stats.routes, stats.parseErrors, stats.failedBatches);
+    LOGG(TEST_INFO, RIB, "\t%-16s %.3f s, %.0f routes/s\n", "parse",
+         stats.parseSeconds, stats.parseSeconds > 0 ? stats.routes / stats.parseSeconds : 0);
+    LOGG(TEST_INFO, RIB, "\t%-16s %.3f s, %.0f routes/s\n", "program",
+         stats.programSeconds, stats.programSeconds > 0 ? stats.routes / stats.programSeconds : 0);
+    LOGG(TEST_INFO, RIB, "\t%-16s %.3f s\n", "total", stats.totalSeconds);
+    LOGG(TEST_INFO, RIB, "\t%-16s %ld KB\n", "peak RSS", stats.peakRssKb);
+    LOGG(TEST_INFO, RIB, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <string>
+
+#include "log.h"
+#include "ip.h"
+#include "basic_router.h"
+
+class RouteMgr;
+
+#define RIB_QUEUE_DEPTH_DEFAULT     8
+
+// nexthop of blackhole routes
+#define RIB_NEXTHOP_DROP            "drop"
+
+struct RibLoadStats
+{
+    size_t routes;              // routes parsed from the file
+    size_t parseErrors;         // lines which are not "prefix nexthop[,nexthop...]"
+    size_t failedBatches;       // batches RouteMgr did not fully program
+    double parseSeconds;        // until the last parser is done
+    double programSeconds;      // spent in RouteMgr::AddBatch()
+    double totalSeconds;
+    long peakRssKb;
+};
+
+// Loads a RIB dump into RouteMgr. The file is mmapped and split into one
+// slice per parser thread, cut at line boundaries. Parsed routes are queued
+// in RouteMgr sized batches; the calling thread programs them while the
+// parsers go on, and blocks the parsers once the queue is full. Slices are
+// not programmed in file order, so a prefix should appear once in the file.
+//
+// One route per line, '#' starts a comment:
+//     10.1.0.0/16 192.168.1.1,192.168.2.1
+//     2001:db8::/32 fc00::1
+//     10.2.0.0/16 drop
+class RibLoader
+{
+    RouteMgr* m_routeMgr;
+    unsigned m_parsers;
+    size_t m_batchSize;
+    size_t m_queueDepth;
+
+public:
+    // parsers == 0 uses one parser per CPU
+    RibLoader(RouteMgr* routeMgr, unsigned parsers = 0, size_t queueDepth = RIB_QUEUE_DEPTH_DEFAULT);
+
+    void SetBatchSize(size_t batchSize);
+
+    bool Load(sai_object_id_t vr_id, const std::string &path, RibLoadStats &stats);
+    bool Load(const std::string &path, RibLoadStats &stats);
+
+    // false for comments and empty lines; throws on a malformed line
+    static bool ParseLine(const char *begin, const char *end, IpPrefix &prefix, IpAddresses &nexthops);
+
+    static void Show(const RibLoadStats &stats);
+};
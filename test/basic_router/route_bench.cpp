@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "route_bench.h"
+#include "route_mgr.h"
+#include "neighbor_mgr.h"
+
+#define CHURN_OP_ADD        "add"
+#define CHURN_OP_WITHDRAW   "withdraw"
+#define CHURN_OP_MODIFY     "modify"
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_us(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(bench_clock::now() - start).count();
+}
+
+// nearest rank over sorted samples
+static double percentile(const std::vector<double> &sorted, double pct)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)(pct / 100.0 * sorted.size() + 0.5);
+
+    rank = rank ? rank - 1 : 0;
+
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+static LatencyStats summarize(std::vector<double> &samples, size_t failures)
+{
+    LatencyStats stats;
+    double sum = 0;
+
+    std::sort(samples.begin(), samples.end());
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        sum += samples[i];
+    }
+
+    stats.count = samples.size();
+    stats.failures = failures;
+    stats.meanUs = samples.empty() ? 0 : sum / samples.size();
+    stats.p50Us = percentile(samples, 50);
+    stats.p90Us = percentile(samples, 90);
+    stats.p99Us = percentile(samples, 99);
+    stats.p999Us = percentile(samples, 99.9);
+    stats.maxUs = samples.empty() ? 0 : samples.back();
+
+    return stats;
+}
+
+// 30.0.0.0/24 upwards, one /24 per index
+static IpPrefix churn_prefix(uint32_t index)
+{
+    char prefixStr[32];
+
+    snprintf(prefixStr, sizeof(prefixStr), "%u.%u.%u.0/24", 30 + (index >> 16), (index >> 8) & 0xFF, index & 0xFF);
+
+    return IpPrefix(prefixStr);
+}
+
+static uint32_t parse_uint(const std::string &key, const std::string &value)
+{
+    char *end = NULL;
+    unsigned long v = strtoul(value.c_str(), &end, 0);
+
+    if (value.empty() || *end != '\0')
+    {
+        throw std::invalid_argument("bad value " + value + " for " + key);
+    }
+
+    return (uint32_t)v;
+}
+
+ChurnProfile::ChurnProfile()
+{
+    routes = 100000;
+    updates = 20000;
+    rate = 0;
+    addWeight = 1;
+    withdrawWeight = 1;
+    modifyWeight = 2;
+    nexthops.push_back(IpAddresses("192.168.1.1"));
+    nexthops.push_back(IpAddresses("192.168.2.1,192.169.3.1"));
+    nexthops.push_back(IpAddresses("192.168.2.1,192.169.3.1,24.58.202.118"));
+    nexthops.push_back(IpAddresses("172.16.20.22"));
+    failedNextHop = IpAddress("192.169.3.1");
+    seed = 1;
+}
+
+void ChurnProfile::Parse(const std::string &profile)
+{
+    std::stringstream ss(profile);
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+
+        size_t eq = item.find('=');
+
+        if (eq == std::string::npos)
+        {
+            throw std::invalid_argument("expect key=value, got " + item);
+        }
+
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+
+        if (key == "routes")
+        {
+            routes = parse_uint(key, value);
+        }
+        else if (key == "updates")
+        {
+            updates = parse_uint(key, value);
+        }
+        else if (key == "rate")
+        {
+            rate = parse_uint(key, value);
+        }
+        else if (key == "add")
+        {
+            addWeight = parse_uint(key, value);
+        }
+        else if (key == "withdraw")
+        {
+            withdrawWeight = parse_uint(key, value);
+        }
+        else if (key == "modify")
+        {
+            modifyWeight = parse_uint(key, value);
+        }
+        else if (key == "seed")
+        {
+            seed = parse_uint(key, value);
+        }
+        else if (key == "fail")
+        {
+            failedNextHop = IpAddress(value);
+        }
+        else if (key == "nexthops")
+        {
+            // ',' separates the keys, the members of a set are joined by '+'
+            std::stringstream sets(value);
+            std::string set;
+
+            nexthops.clear();
+
+            while (std::getline(sets, set, ';'))
+            {
+                std::replace(set.begin(), set.end(), '+', ',');
+                nexthops.push_back(IpAddresses(set));
+            }
+        }
+        else
+        {
+            throw std::invalid_argument("unknown churn profile key " + key);
+        }
+    }
+
+    if (nexthops.empty() || addWeight + withdrawWeight + modifyWeight == 0)
+    {
+        throw std::invalid_argument("churn profile needs nexthops and a non zero update weight");
+    }
+}
+
+RouteBench::RouteBench(RouteMgr* routeMgr, NeighborMgr* neighborMgr)
+{
+    m_routeMgr = routeMgr;
+    m_neighborMgr = neighborMgr;
+}
+
+bool RouteBench::Run(const ChurnProfile &profile, ChurnResult &result)
+{
+    return Run(g_vr_id, profile, result);
+}
+
+bool RouteBench::Run(sai_object_id_t vr_id, const ChurnProfile &profile, ChurnResult &result)
+{
+    std::mt19937 rng(profile.seed);
+    std::vector<IpPrefix> live;
+    std::vector<size_t> liveNextHops;
+    std::vector<double> samples[3];
+    size_t failures[3] = { 0, 0, 0 };
+    const char *names[3] = { CHURN_OP_ADD, CHURN_OP_WITHDRAW, CHURN_OP_MODIFY };
+    uint32_t nextIndex = 0;
+    RouteBatch routes;
+
+    result.ops.clear();
+    result.convergedRoutes = 0;
+    result.convergenceMs = 0;
+    result.converged = false;
+
+    for (; nextIndex < profile.routes; nextIndex++)
+    {
+        size_t nh = nextIndex % profile.nexthops.size();
+
+        routes.push_back(std::make_pair(churn_prefix(nextIndex), profile.nexthops[nh]));
+        live.push_back(routes.back().first);
+        liveNextHops.push_back(nh);
+    }
+
+    LOGG(TEST_INFO, ROUTE, "churn: load %u routes\n", profile.routes);
+
+    bench_clock::time_point start = bench_clock::now();
+
+    if (!m_routeMgr->AddBatch(vr_id, routes))
+    {
+        LOGG(TEST_ERR, ROUTE, "churn: fail to load the initial routes\n");
+        return false;
+    }
+
+    result.loadSeconds = elapsed_us(start) / 1e6;
+    routes.clear();
+
+    LOGG(TEST_INFO, ROUTE, "churn: replay %u updates, rate %u/s\n", profile.updates, profile.rate);
+
+    uint32_t weights = profile.addWeight + profile.withdrawWeight + profile.modifyWeight;
+
+    start = bench_clock::now();
+
+    for (uint32_t i = 0; i < profile.updates; i++)
+    {
+        if (profile.rate)
+        {
+            std::this_thread::sleep_until(start + std::chrono::microseconds((uint64_t)i * 1000000 / profile.rate));
+        }
+
+        uint32_t pick = rng() % weights;
+        int op = (pick < profile.addWeight) ? 0 : (pick < profile.addWeight + profile.withdrawWeight) ? 1 : 2;
+
+        if (live.empty())
+        {
+            op = 0;
+        }
+
+        size_t victim = live.empty() ? 0 : rng() % live.size();
+        size_t nh = rng() % profile.nexthops.size();
+        bool ok = true;
+
+        bench_clock::time_point t = bench_clock::now();
+
+        switch (op)
+        {
+            case 0:
+                {
+                    IpPrefix prefix = churn_prefix(nextIndex++);
+
+                    t = bench_clock::now();
+                    ok = m_routeMgr->Add(vr_id, prefix, profile.nexthops[nh]);
+
+                    if (ok)
+                    {
+                        live.push_back(prefix);
+                        liveNextHops.push_back(nh);
+                    }
+                }
+                break;
+
+            case 1:
+                ok = m_routeMgr->Del(vr_id, live[victim]);
+
+                if (ok)
+                {
+                    live[victim] = live.back();
+                    live.pop_back();
+                    liveNextHops[victim] = liveNextHops.back();
+                    liveNextHops.pop_back();
+                }
+                break;
+
+            default:
+                // always a different nexthop set when there is one
+                if (nh == liveNextHops[victim])
+                {
+                    nh = (nh + 1) % profile.nexthops.size();
+                }
+
+                ok = m_routeMgr->Add(vr_id, live[victim], profile.nexthops[nh]);
+
+                if (ok)
+                {
+                    liveNextHops[victim] = nh;
+                }
+                break;
+        }
+
+        samples[op].push_back(elapsed_us(t));
+
+        if (!ok)
+        {
+            failures[op]++;
+        }
+    }
+
+    result.churnSeconds = elapsed_us(start) / 1e6;
+    result.updatesPerSecond = result.churnSeconds > 0 ? profile.updates / result.churnSeconds : 0;
+
+    size_t totalFailures = 0;
+
+    for (int op = 0; op < 3; op++)
+    {
+        result.ops[names[op]] = summarize(samples[op], failures[op]);
+        totalFailures += failures[op];
+    }
+
+    // neighbor failure: every route using it is reprogrammed before the
+    // neighbor (and its nexthop) can go away
+    LOGG(TEST_INFO, ROUTE, "churn: nexthop %s goes down\n", profile.failedNextHop.to_string().c_str());
+
+    start = bench_clock::now();
+
+    result.converged = m_routeMgr->WithdrawNextHop(vr_id, profile.failedNextHop, result.convergedRoutes);
+
+    if (m_neighborMgr->GetNeighborEntry(vr_id, profile.failedNextHop))
+    {
+        result.converged = m_neighborMgr->Del(vr_id, profile.failedNextHop) && result.converged;
+    }
+
+    result.convergenceMs = elapsed_us(start) / 1e3;
+
+    return (totalFailures == 0 && result.converged);
+}
+
+std::string RouteBench::ToJson(const ChurnProfile &profile, const ChurnResult &result)
+{
+    std::stringstream json;
+    std::map<std::string, LatencyStats>::const_iterator it;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"routes\": " << profile.routes
+         << ", \"updates\": " << profile.updates
+         << ", \"rate\": " << profile.rate
+         << ", \"add\": " << profile.addWeight
+         << ", \"withdraw\": " << profile.withdrawWeight
+         << ", \"modify\": " << profile.modifyWeight
+         << ", \"nexthop_sets\": " << profile.nexthops.size()
+         << ", \"fail\": \"" << profile.failedNextHop.to_string() << "\""
+         << ", \"seed\": " << profile.seed << "},\n";
+    json << "  \"load_seconds\": " << result.loadSeconds << ",\n";
+    json << "  \"churn_seconds\": " << result.churnSeconds << ",\n";
+    json << "  \"updates_per_second\": " << result.updatesPerSecond << ",\n";
+    json << "  \"ops\": {";
+
+    for (it = result.ops.begin(); it != result.ops.end(); it++)
+    {
+        const LatencyStats &s = it->second;
+
+        json << (it == result.ops.begin() ? "\n" : ",\n");
+        json << "    \"" << it->first << "\": {\"count\": " << s.count
+             << ", \"failures\": " << s.failures
+             << ", \"mean_us\": " << s.meanUs
+             << ", \"p50_us\": " << s.p50Us
+             << ", \"p90_us\": " << s.p90Us
+             << ", \"p99_us\": " << s.p99Us
+             << ", \"p999_us\": " << s.p999Us
+             << ", \"max_us\": " << s.maxUs << "}";
+    }
+
+    json << "\n  },\n";
+    json << "  \"convergence\": {\"routes\": " << result.convergedRoutes
+         << ", \"ms\": " << result.convergenceMs
+         << ", \"ok\": " << (result.converged ? "true" : "false") << "}\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void RouteBench::Show(const ChurnResult &result)
+{
+    std::map<std::string, LatencyStats>::const_iterator it;
+
+    LOGG(TEST_INFO, ROUTE, "\t--- --- --- --- --- --- Route Churn --- --- --- --- --- --- ---\n");
+    LOGG(TEST_INFO, ROUTE, "\tload %.3f s, churn %.3f s, %.0f updates/s\n",
+         result.loadSeconds, result.churnSeconds, result.updatesPerSecond);
+    LOGG(TEST_INFO, ROUTE, "\t%-10s %8s %8s %10s %10s %10s %10s %10s\n",
+         "op", "count", "failed", "p50(us)", "p90(us)", "p99(us)", "p99.9(us)", "max(us)");
+
+    for (it = result.ops.begin(); it != result.ops.end(); it++)
+    {
+        const LatencyStats &s = it->second;
+
+        LOGG(TEST_INFO, ROUTE, "\t%-10s %8zu %8zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+             it->first.c_str(), s.count, s.failures, s.p50Us, s.p90Us, s.p99Us, s.p999Us, s.maxUs);
+    }
+
+    LOGG(TEST_INFO, ROUTE, "\tneighbor down: %zu routes converged in %.3f ms%s\n",
+         result.convergedRoutes, result.convergenceMs, result.converged ? "" : " (with failures)");
+    LOGG(TEST_INFO, ROUTE, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "log.h"
+#include "ip.h"
+#include "basic_router.h"
+
+class RouteMgr;
+class NeighborMgr;
+
+// Churn profile, parsed from "key=value,..." (see ChurnProfile::Parse):
+//   routes     routes in the table before the churn starts
+//   updates    route updates replayed
+//   rate       updates per second, 0 replays as fast as RouteMgr goes
+//   add, withdraw, modify
+//              relative weights of the update types
+//   nexthops   nexthop sets the routes are spread over, separated by
+//              ';', with the members of a set joined by '+'
+//   fail       nexthop going down once the churn is done
+//   seed       random seed
+struct ChurnProfile
+{
+    uint32_t routes;
+    uint32_t updates;
+    uint32_t rate;
+    uint32_t addWeight;
+    uint32_t withdrawWeight;
+    uint32_t modifyWeight;
+    std::vector<IpAddresses> nexthops;
+    IpAddress failedNextHop;
+    uint32_t seed;
+
+    ChurnProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+};
+
+struct LatencyStats
+{
+    size_t count;
+    size_t failures;
+    double meanUs;
+    double p50Us;
+    double p90Us;
+    double p99Us;
+    double p999Us;
+    double maxUs;
+};
+
+struct ChurnResult
+{
+    double loadSeconds;             // initial table
+    double churnSeconds;
+    double updatesPerSecond;
+    std::map<std::string, LatencyStats> ops;
+
+    size_t convergedRoutes;         // routes using the failed nexthop
+    double convergenceMs;           // until they are reprogrammed and the neighbor is gone
+    bool converged;
+};
+
+class RouteBench
+{
+    RouteMgr* m_routeMgr;
+    NeighborMgr* m_neighborMgr;
+
+public:
+    RouteBench(RouteMgr* routeMgr, NeighborMgr* neighborMgr);
+
+    // leaves the churned routes in place, minus the failed neighbor
+    bool Run(sai_object_id_t vr_id, const ChurnProfile &profile, ChurnResult &result);
+    bool Run(const ChurnProfile &profile, ChurnResult &result);
+
+    static std::string ToJson(const ChurnProfile &profile, const ChurnResult &result);
+    static void Show(const ChurnResult &result);
+};
@@ -24,9 +24,12 @@ extern "C"
 #define typeof(x) __typeof__(x)
 
 #include <stdio.h>
+#include <string.h>
 #include "sai.h"
 }
 
+#include <future>
+#include <unordered_set>
 #include <vector>
 #include <arpa/inet.h>
 
@@ -40,252 +43,1255 @@ extern sai_next_hop_api_t* sai_next_hop_api;
 extern sai_next_hop_group_api_t* sai_next_hop_group_api;
 extern sai_route_api_t* sai_route_api;
 
-extern sai_object_id_t g_vr_id;
+extern sai_object_id_t g_switch_id;
+
+// one bulk call worth of routes, kept in the contiguous layout
+// create_route_entries() expects
+struct RouteChunk
+{
+    std::vector<size_t> index;      // position of each route in the batch
+    std::vector<sai_route_entry_t> entries;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrPtrs;
+    std::vector<sai_status_t> statuses;
+    std::vector<NextHopSet*> nexthopSets;
+    std::unordered_set<IpPrefix> prefixes;
+
+    void clear()
+    {
+        index.clear();
+        nexthopSets.clear();
+        entries.clear();
+        attrs.clear();
+        attrCounts.clear();
+        attrPtrs.clear();
+        statuses.clear();
+        prefixes.clear();
+    }
+};
+
+static bool is_blackhole(const IpAddresses &nexthops)
+{
+    return (nexthops.size() == 0);
+}
+
+static void fill_route_entry(sai_object_id_t vr_id, const IpPrefix &prefix, sai_route_entry_t &route_entry)
+{
+    memset(&route_entry, 0, sizeof(route_entry));
+
+    route_entry.switch_id = g_switch_id;
+    route_entry.vr_id = vr_id;
+    copy_ip_prefix(route_entry.destination, prefix);
+}
+
+// attributes moving a route from old (NULL for a new route) to nhs, in the
+// order they are to be set: a route being blackholed drops before losing
+// its nexthop, a restored route gets its nexthop before forwarding again.
+// The packet action is only set when it changes.
+static uint32_t fill_route_attrs(const NextHopSet *old, const NextHopSet *nhs, sai_attribute_t *route_attrs)
+{
+    bool drop = is_blackhole(nhs->nextHops);
+    uint32_t count = 0;
+
+    if (old && is_blackhole(old->nextHops) == drop)
+    {
+        route_attrs[0].id = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+        route_attrs[0].value.oid = nhs->nh_id;
+        return 1;
+    }
+
+    if (drop)
+    {
+        route_attrs[count].id = SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION;
+        route_attrs[count++].value.s32 = SAI_PACKET_ACTION_DROP;
+    }
+
+    route_attrs[count].id = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+    route_attrs[count++].value.oid = nhs->nh_id;
+
+    if (!drop)
+    {
+        route_attrs[count].id = SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION;
+        route_attrs[count++].value.s32 = SAI_PACKET_ACTION_FORWARD;
+    }
+
+    return count;
+}
+
+// value of route_attr while the route used nhs
+static void fill_old_route_attr(const NextHopSet *nhs, sai_attribute_t &route_attr)
+{
+    if (route_attr.id == SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION)
+    {
+        route_attr.value.s32 = is_blackhole(nhs->nextHops) ? SAI_PACKET_ACTION_DROP : SAI_PACKET_ACTION_FORWARD;
+    }
+    else
+    {
+        route_attr.value.oid = nhs->nh_id;
+    }
+}
+
+// set the attributes one by one, the ones already set are put back to
+// their old value if a later one fails
+static sai_status_t set_route_attrs(const sai_route_entry_t *route_entry, const NextHopSet *old,
+                                    uint32_t count, const sai_attribute_t *route_attrs)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sai_status_t status = sai_route_api->set_route_entry_attribute(route_entry, &route_attrs[i]);
+
+        if (status == SAI_STATUS_SUCCESS)
+        {
+            continue;
+        }
+
+        while (i-- > 0)
+        {
+            sai_attribute_t route_attr = route_attrs[i];
+            fill_old_route_attr(old, route_attr);
+            sai_route_api->set_route_entry_attribute(route_entry, &route_attr);
+        }
+
+        return status;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static bool bulk_not_available(sai_status_t status)
+{
+    return (status == SAI_STATUS_NOT_IMPLEMENTED ||
+            status == SAI_STATUS_NOT_SUPPORTED);
+}
+
+// runs on the pipeline thread, only touches the chunk
+static sai_status_t create_route_chunk(RouteChunk *chunk)
+{
+    uint32_t count = (uint32_t)chunk->entries.size();
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    if (sai_route_api->create_route_entries)
+    {
+        status = sai_route_api->create_route_entries(count,
+                 chunk->entries.data(),
+                 chunk->attrCounts.data(),
+                 chunk->attrPtrs.data(),
+                 SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                 chunk->statuses.data());
+
+        if (!bulk_not_available(status))
+        {
+            return status;
+        }
+    }
+
+    // no bulk support in this SAI, program the chunk one route at a time
+    for (uint32_t i = 0; i < count; i++)
+    {
+        chunk->statuses[i] = sai_route_api->create_route_entry(&chunk->entries[i], chunk->attrCounts[i], chunk->attrPtrs[i]);
+
+        if (chunk->statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            status = SAI_STATUS_FAILURE;
+        }
+    }
+
+    return status;
+}
+
+static sai_status_t remove_route_chunk(std::vector<sai_route_entry_t> &entries, std::vector<sai_status_t> &statuses)
+{
+    uint32_t count = (uint32_t)entries.size();
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    if (sai_route_api->remove_route_entries)
+    {
+        status = sai_route_api->remove_route_entries(count,
+                 entries.data(),
+                 SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                 statuses.data());
+
+        if (!bulk_not_available(status))
+        {
+            return status;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        statuses[i] = sai_route_api->remove_route_entry(&entries[i]);
+
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            status = SAI_STATUS_FAILURE;
+        }
+    }
+
+    return status;
+}
+
+static sai_status_t set_route_chunk(std::vector<sai_route_entry_t> &entries,
+                                    std::vector<sai_attribute_t> &attrs,
+                                    std::vector<sai_status_t> &statuses)
+{
+    uint32_t count = (uint32_t)entries.size();
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    if (sai_route_api->set_route_entries_attribute)
+    {
+        status = sai_route_api->set_route_entries_attribute(count,
+                 entries.data(),
+                 attrs.data(),
+                 SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                 statuses.data());
+
+        if (!bulk_not_available(status))
+        {
+            return status;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        statuses[i] = sai_route_api->set_route_entry_attribute(&entries[i], &attrs[i]);
+
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            status = SAI_STATUS_FAILURE;
+        }
+    }
+
+    return status;
+}
 
 RouteMgr::RouteMgr(NeighborMgr* neighborMgr, NextHopGrpMgr* nhgMgr)
 {
-    m_neighborMgr = neighborMgr;
-    m_nhgMgr = nhgMgr;
-    // setup black hole
-    IpAddresses ipaddrs("0.0.0.0");
-    m_EcmpGroups[ipaddrs] = 0;
+    m_neighborMgr = neighborMgr;
+    m_nhgMgr = nhgMgr;
+    m_bulkChunkSize = ROUTE_BULK_CHUNK_SIZE_DEFAULT;
+
+    m_neighborMgr->SetListener(this);
+}
+
+RouteMgr::~RouteMgr()
+{
+    m_neighborMgr->SetListener(NULL);
+
+    std::map<sai_object_id_t, NextHopSetTable>::iterator itvr;
+
+    for (itvr = m_NextHopSets.begin(); itvr != m_NextHopSets.end(); itvr++)
+    {
+        for (NextHopSetTable::iterator it = itvr->second.begin(); it != itvr->second.end(); it++)
+        {
+            delete it->second;
+        }
+    }
+}
+
+void RouteMgr::SetBulkChunkSize(uint32_t chunkSize)
+{
+    m_bulkChunkSize = chunkSize ? chunkSize : 1;
+}
+
+size_t RouteMgr::GetPendingCount() const
+{
+    return m_PendingRoutes.size();
+}
+
+void RouteMgr::ParkRoute(sai_object_id_t vr_id, const IpPrefix &prefix, const IpAddresses &nexthops)
+{
+    UnparkRoute(vr_id, prefix);
+
+    const std::set<IpAddress> &addrset = nexthops.AddrSet();
+
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        m_neighborMgr->WaitForRoute(vr_id, *itnh, prefix);
+    }
+
+    m_PendingRoutes[VrfIpPrefix(vr_id, prefix)] = nexthops;
+
+    LOGG(TEST_DEBUG, ROUTE, "route %s waits for nexthops %s\n", prefix.to_string().c_str(), nexthops.to_string().c_str());
+}
+
+void RouteMgr::UnparkRoute(sai_object_id_t vr_id, const IpPrefix &prefix)
+{
+    if (m_PendingRoutes.empty())
+    {
+        return;
+    }
+
+    std::unordered_map<VrfIpPrefix, IpAddresses>::iterator it = m_PendingRoutes.find(VrfIpPrefix(vr_id, prefix));
+
+    if (it == m_PendingRoutes.end())
+    {
+        return;
+    }
+
+    const std::set<IpAddress> &addrset = it->second.AddrSet();
+
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        m_neighborMgr->CancelRoute(vr_id, *itnh, prefix);
+    }
+
+    m_PendingRoutes.erase(it);
+}
+
+// nexthop sets programmed with part of their nexthops are refreshed when
+// the rest get resolved
+void RouteMgr::WatchNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops)
+{
+    const std::set<IpAddress> &addrset = nexthops.AddrSet();
+
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        if (!m_neighborMgr->GetNeighborEntry(vr_id, *itnh))
+        {
+            m_neighborMgr->WaitForNextHops(vr_id, *itnh, nexthops);
+        }
+    }
+}
+
+void RouteMgr::UnwatchNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops)
+{
+    const std::set<IpAddress> &addrset = nexthops.AddrSet();
+
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        m_neighborMgr->CancelNextHops(vr_id, *itnh, nexthops);
+    }
+}
+
+void RouteMgr::InsertRoute(sai_object_id_t vr_id, const IpPrefix &prefix, NextHopSet *nhs)
+{
+    std::pair<RouteTable::iterator, bool> ret = m_Routes.insert(std::make_pair(VrfIpPrefix(vr_id, prefix), nhs));
+
+    if (!ret.second)
+    {
+        MoveRoute(ret.first, nhs);
+        return;
+    }
+
+    nhs->routes.insert(prefix);
+    m_RouteTries[vr_id].Insert(prefix);
+}
+
+// repoint the route to nhs, the caller takes care of the reference counts
+void RouteMgr::MoveRoute(RouteTable::iterator it, NextHopSet *nhs)
+{
+    it->second->routes.erase(it->first.prefix);
+    it->second = nhs;
+    nhs->routes.insert(it->first.prefix);
+}
+
+void RouteMgr::GetRoutes(sai_object_id_t vr_id, const NextHopSet *nhs, std::vector<RouteTable::iterator> &routes)
+{
+    routes.clear();
+    routes.reserve(nhs->routes.size());
+
+    for (std::unordered_set<IpPrefix>::const_iterator it = nhs->routes.begin(); it != nhs->routes.end(); ++it)
+    {
+        routes.push_back(m_Routes.find(VrfIpPrefix(vr_id, *it)));
+    }
+}
+
+void RouteMgr::EraseRoute(RouteTable::iterator it)
+{
+    it->second->routes.erase(it->first.prefix);
+
+    std::map<sai_object_id_t, PrefixTrie>::iterator ittrie = m_RouteTries.find(it->first.vr_id);
+
+    if (ittrie != m_RouteTries.end())
+    {
+        ittrie->second.Erase(it->first.prefix);
+
+        if (ittrie->second.Size() == 0)
+        {
+            m_RouteTries.erase(ittrie);
+        }
+    }
+
+    m_Routes.erase(it);
+}
+
+void RouteMgr::Show()
+{
+    std::vector<IpPrefix> prefixes;
+
+    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- Routes Synced --- --- --- --- --- --- ---\n");
+    LOGG(TEST_DEBUG, ROUTE, "\t%-14s | %-40s | %s\n", "vr_id", "route", "nexthops");
+
+    for (std::map<sai_object_id_t, PrefixTrie>::const_iterator ittrie = m_RouteTries.begin(); ittrie != m_RouteTries.end(); ittrie++)
+    {
+        prefixes.clear();
+        ittrie->second.Walk(prefixes);
+
+        for (size_t i = 0; i < prefixes.size(); i++)
+        {
+            RouteTable::const_iterator it = m_Routes.find(VrfIpPrefix(ittrie->first, prefixes[i]));
+
+            LOGG(TEST_DEBUG, ROUTE, "\t0x%-12lx | %-40s | %s\n",
+                 ittrie->first,
+                 prefixes[i].to_string().c_str(),
+                 it->second->nextHops.to_string().c_str());
+        }
+    }
+
+    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+}
+
+void RouteMgr::ShowECMP()
+{
+    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- ECMP Group Table --- --- --- --- --- --- \n");
+    LOGG(TEST_DEBUG, ROUTE, "\t%-14s | %-40s | %-18s | %s\n", "vr_id", "nexthops", "next_hop_group_id", "routes");
+    std::map<sai_object_id_t, NextHopSetTable>::const_iterator itvr;
+    std::map<IpAddresses, const NextHopSet*> sorted;
+    std::map<IpAddresses, const NextHopSet*>::const_iterator itnhs;
+
+    for (itvr = m_NextHopSets.begin(); itvr != m_NextHopSets.end(); itvr++)
+    {
+        sorted.clear();
+
+        for (NextHopSetTable::const_iterator it = itvr->second.begin(); it != itvr->second.end(); it++)
+        {
+            sorted.insert(std::make_pair(it->first, it->second));
+        }
+
+        for (itnhs = sorted.begin(); itnhs != sorted.end(); itnhs++)
+        {
+            LOGG(TEST_DEBUG, ROUTE, "\t0x%-12lx | %-40s | 0x%-16lx | %u\n",
+                 itvr->first,
+                 itnhs->first.to_string().c_str(),
+                 itnhs->second->nh_id,
+                 itnhs->second->refCount);
+        }
+    }
+
+    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+}
+
+NextHopSet* RouteMgr::AcquireNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops)
+{
+    sai_object_id_t nh_id = SAI_NULL_OBJECT_ID;
+    size_t resolved = 0;
+
+    NextHopSetTable &sets = m_NextHopSets[vr_id];
+    NextHopSetTable::iterator itnhs = sets.find(nexthops);
+
+    if (itnhs != sets.end())
+    {
+        itnhs->second->refCount++;
+        return itnhs->second;
+    }
+
+    if (!is_blackhole(nexthops))
+    {
+        const std::set<IpAddress> &addrset = nexthops.AddrSet();
+
+        for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+        {
+            const NeighborEntry *nbEntry = m_neighborMgr->GetNeighborEntry(vr_id, *itnh);
+
+            if (!nbEntry)
+            {
+                LOGG(TEST_DEBUG, ROUTE, "nexthop %s is not resolved yet\n", itnh->to_string().c_str());
+                continue;
+            }
+
+            nh_id = nbEntry->nhid;
+            resolved++;
+        }
+
+        if (resolved == 0)
+        {
+            LOGG(TEST_DEBUG, ROUTE, "cannot find any of nexthops %s in the neighbor table\n", nexthops.to_string().c_str());
+            return NULL;
+        }
+    }
+
+    if (resolved > 1)
+    {
+        if (!m_nhgMgr->Add(vr_id, nexthops))
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to add nexthop group %s\n", nexthops.to_string().c_str());
+            return NULL;
+        }
+
+        const NextHopGrpEntry *nhgEntry = m_nhgMgr->GetNextHopGrpEntry(vr_id, nexthops);
+
+        if (!nhgEntry)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to retrieve nexthop group %s\n", nexthops.to_string().c_str());
+            m_nhgMgr->Del(vr_id, nexthops);
+            return NULL;
+        }
+
+        nh_id = nhgEntry->nhg_id;
+    }
+
+    NextHopSet *nhs = new NextHopSet;
+    nhs->nextHops = nexthops;
+    nhs->nh_id = nh_id;
+    nhs->refCount = 1;
+
+    sets[nexthops] = nhs;
+
+    if (!is_blackhole(nexthops) && resolved < nexthops.size())
+    {
+        WatchNextHops(vr_id, nexthops);
+    }
+
+    return nhs;
+}
+
+bool RouteMgr::ReleaseNextHops(sai_object_id_t vr_id, NextHopSet *nhs)
+{
+    if (--nhs->refCount > 0)
+    {
+        return true;
+    }
+
+    //On this field, there could be next hop id and next hop group id.
+    //the following handles only next hop group id
+    if (SAI_OID_TYPE_CHECK(nhs->nh_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP))
+    {
+        LOGG(TEST_INFO, ROUTE, "remove nexthopgrp id 0x%lx\n", nhs->nh_id);
+
+        if (!m_nhgMgr->Del(vr_id, nhs->nextHops))
+        {
+            LOGG(TEST_ERR, ROUTE, "failed to remove nexthopgrp id 0x%lx\n", nhs->nh_id);
+            nhs->refCount++;
+            return false;
+        }
+    }
+
+    if (!is_blackhole(nhs->nextHops))
+    {
+        UnwatchNextHops(vr_id, nhs->nextHops);
+    }
+
+    std::map<sai_object_id_t, NextHopSetTable>::iterator itvr = m_NextHopSets.find(vr_id);
+
+    itvr->second.erase(nhs->nextHops);
+
+    if (itvr->second.empty())
+    {
+        m_NextHopSets.erase(itvr);
+    }
+
+    delete nhs;
+
+    return true;
+}
+
+bool RouteMgr::Add(IpPrefix prefix, IpAddresses nexthops)
+{
+    return Add(g_vr_id, prefix, nexthops);
+}
+
+bool RouteMgr::Add(sai_object_id_t vr_id, IpPrefix prefix, IpAddresses nexthops)
+{
+    sai_status_t status;
+    NextHopSet *nhs = AcquireNextHops(vr_id, nexthops);
+
+    if (!nhs)
+    {
+        ParkRoute(vr_id, prefix, nexthops);
+        return false;
+    }
+
+    sai_route_entry_t route_entry;
+    fill_route_entry(vr_id, prefix, route_entry);
+
+    sai_attribute_t route_attrs[ROUTE_ATTR_MAX];
+    uint32_t count;
+
+    RouteTable::iterator it = m_Routes.find(VrfIpPrefix(vr_id, prefix));
+
+    if (it == m_Routes.end())
+    {
+        LOGG(TEST_INFO, ROUTE, "sai_route_api->create_route_entry %s | nexthops %s\n",
+             prefix.to_string().c_str(), nexthops.to_string().c_str());
+
+        count = fill_route_attrs(NULL, nhs, route_attrs);
+        status = sai_route_api->create_route_entry(&route_entry, count, route_attrs);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to create route for %s, nexthop(s) are %s rc=0x%x\n",
+                 prefix.to_string().c_str(),
+                 nexthops.to_string().c_str(), -status);
+            ReleaseNextHops(vr_id, nhs);
+            return false;
+        }
+
+        InsertRoute(vr_id, prefix, nhs);
+    }
+    else
+    {
+        LOGG(TEST_INFO, ROUTE, "sai_route_api->set_route_entry_attribute %s | nexthops %s\n",
+             prefix.to_string().c_str(), nexthops.to_string().c_str());
+
+        count = fill_route_attrs(it->second, nhs, route_attrs);
+        status = set_route_attrs(&route_entry, it->second, count, route_attrs);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to set nexthop(s) %s for route %s, rc=0x%x",
+                 nexthops.to_string().c_str(),
+                 prefix.to_string().c_str(), -status);
+            ReleaseNextHops(vr_id, nhs);
+            return false;
+        }
+
+        NextHopSet *old = it->second;
+        MoveRoute(it, nhs);
+        ReleaseNextHops(vr_id, old);
+    }
+
+    UnparkRoute(vr_id, prefix);
+
+    return true;
+}
+
+size_t RouteMgr::BuildChunk(sai_object_id_t vr_id, const RouteBatch &routes, size_t &pos,
+                            const RouteChunk *inflight, RouteChunk &chunk,
+                            std::vector<size_t> &deferred)
+{
+    size_t failures = 0;
+
+    chunk.clear();
+
+    for (; pos < routes.size() && chunk.index.size() < m_bulkChunkSize; pos++)
+    {
+        const IpPrefix &prefix = routes[pos].first;
+        const IpAddresses &nexthops = routes[pos].second;
+
+        // existing routes are updated through set, and so are prefixes
+        // repeated in the batch, after every chunk is reconciled
+        if (m_Routes.find(VrfIpPrefix(vr_id, prefix)) != m_Routes.end() ||
+                chunk.prefixes.find(prefix) != chunk.prefixes.end() ||
+                (inflight && inflight->prefixes.find(prefix) != inflight->prefixes.end()))
+        {
+            deferred.push_back(pos);
+            continue;
+        }
+
+        // may create the ECMP group, while the previous chunk is programmed
+        NextHopSet *nhs = AcquireNextHops(vr_id, nexthops);
+
+        if (!nhs)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to resolve nexthop(s) %s for route %s\n",
+                 nexthops.to_string().c_str(), prefix.to_string().c_str());
+            ParkRoute(vr_id, prefix, nexthops);
+            failures++;
+            continue;
+        }
+
+        sai_route_entry_t route_entry;
+        fill_route_entry(vr_id, prefix, route_entry);
+
+        sai_attribute_t route_attrs[ROUTE_ATTR_MAX];
+        uint32_t attrCount = fill_route_attrs(NULL, nhs, route_attrs);
+
+        chunk.index.push_back(pos);
+        chunk.nexthopSets.push_back(nhs);
+        chunk.entries.push_back(route_entry);
+        chunk.attrs.insert(chunk.attrs.end(), route_attrs, route_attrs + attrCount);
+        chunk.attrCounts.push_back(attrCount);
+        chunk.prefixes.insert(prefix);
+    }
+
+    size_t count = chunk.entries.size();
+    size_t attrPos = 0;
+
+    chunk.statuses.assign(count, SAI_STATUS_NOT_EXECUTED);
+    chunk.attrPtrs.resize(count);
+
+    // attrs is complete, it is not reallocated anymore
+    for (size_t i = 0; i < count; i++)
+    {
+        chunk.attrPtrs[i] = &chunk.attrs[attrPos];
+        attrPos += chunk.attrCounts[i];
+    }
+
+    return failures;
 }
 
+size_t RouteMgr::ReconcileAddChunk(sai_object_id_t vr_id, const RouteBatch &routes, RouteChunk &chunk)
+{
+    size_t failures = 0;
 
-void RouteMgr::Show()
+    for (size_t i = 0; i < chunk.index.size(); i++)
+    {
+        const IpPrefix &prefix = routes[chunk.index[i]].first;
+        const IpAddresses &nexthops = routes[chunk.index[i]].second;
+
+        if (chunk.statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to create route for %s, nexthop(s) are %s rc=0x%x\n",
+                 prefix.to_string().c_str(),
+                 nexthops.to_string().c_str(), -chunk.statuses[i]);
+            ReleaseNextHops(vr_id, chunk.nexthopSets[i]);
+            failures++;
+            continue;
+        }
+
+        InsertRoute(vr_id, prefix, chunk.nexthopSets[i]);
+        UnparkRoute(vr_id, prefix);
+    }
+
+    return failures;
+}
+
+bool RouteMgr::AddBatch(const RouteBatch &routes)
 {
-    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- Routes Synced --- --- --- --- --- --- ---\n");
-    LOGG(TEST_DEBUG, ROUTE, "\t%-40s | %s\n", "route", "nexthops");
+    return AddBatch(g_vr_id, routes);
+}
+
+bool RouteMgr::AddBatch(sai_object_id_t vr_id, const RouteBatch &routes)
+{
+    RouteChunk chunks[2];
+    RouteChunk *pending = NULL;
+    std::future<sai_status_t> inflight;
+    std::vector<size_t> deferred;
+    size_t pos = 0;
+    size_t failures = 0;
+    int cur = 0;
+
+    LOGG(TEST_INFO, ROUTE, "sai_route_api->create_route_entries vr_id 0x%lx %zu routes, %u routes per call\n",
+         vr_id, routes.size(), m_bulkChunkSize);
 
-    for (RouteTable::const_iterator it = m_Routes.begin(); it != m_Routes.end(); it++)
+    // two chunk pipeline: the next chunk is resolved (ECMP groups created)
+    // and laid out while the previous one is being programmed
+    while (pos < routes.size() || pending)
     {
-        IpPrefix prefix = it->first;
-        LOGG(TEST_DEBUG, ROUTE, "\t%-40s | %s\n",
-             prefix.to_string().c_str(),
-             it->second.to_string().c_str());
+        RouteChunk &chunk = chunks[cur];
+
+        failures += BuildChunk(vr_id, routes, pos, pending, chunk, deferred);
+
+        if (pending)
+        {
+            // per route statuses are what counts, not the overall status
+            inflight.get();
+            failures += ReconcileAddChunk(vr_id, routes, *pending);
+            pending = NULL;
+        }
+
+        if (chunk.entries.empty())
+        {
+            continue;
+        }
+
+        inflight = std::async(std::launch::async, create_route_chunk, &chunk);
+        pending = &chunk;
+        cur ^= 1;
     }
 
-    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+    for (size_t i = 0; i < deferred.size(); i++)
+    {
+        if (!Add(vr_id, routes[deferred[i]].first, routes[deferred[i]].second))
+        {
+            failures++;
+        }
+    }
+
+    LOGG(TEST_INFO, ROUTE, "programmed %zu of %zu routes\n", routes.size() - failures, routes.size());
+
+    return (failures == 0);
 }
 
-void RouteMgr::ShowECMP()
+bool RouteMgr::Del(IpPrefix prefix)
 {
-    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- ECMP Group Table --- --- --- --- --- --- \n");
-    LOGG(TEST_DEBUG, ROUTE, "\t%-40s | %s\n", "nexthops", "next_hop_group_id");
-    std::map<IpAddresses, sai_object_id_t>::iterator itnhg;
+    return Del(g_vr_id, prefix);
+}
+
+bool RouteMgr::Del(sai_object_id_t vr_id, IpPrefix prefix)
+{
+    RouteTable::iterator it;
+    it = m_Routes.find(VrfIpPrefix(vr_id, prefix));
 
-    for (itnhg = m_EcmpGroups.begin(); itnhg != m_EcmpGroups.end(); itnhg++)
+    if (it == m_Routes.end())
     {
-        IpAddresses nexthops = itnhg->first;
-        LOGG(TEST_DEBUG, ROUTE, "\t%-40s | 0x%lx\n",
-             nexthops.to_string().c_str(),
-             itnhg->second);
+        LOGG(TEST_DEBUG, ROUTE, "cannot find route %s in the route table\n", prefix.to_string().c_str());
+        UnparkRoute(vr_id, prefix);
+        return true;
     }
 
-    LOGG(TEST_DEBUG, ROUTE, "\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- -\n");
+
+    LOGG(TEST_INFO, ROUTE, "sai_route_api->remove_route_entry %s \n",
+         prefix.to_string().c_str());
+
+    sai_route_entry_t route_entry;
+    fill_route_entry(vr_id, prefix, route_entry);
+
+    sai_status_t status = sai_route_api->remove_route_entry(&route_entry);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        LOGG(TEST_ERR, ROUTE, "failed to remove route for %s, rc=0x%x\n", prefix.to_string().c_str(), -status);
+        return false;
+    }
+
+
+    NextHopSet *nhs = it->second;
+    EraseRoute(it);
+    UnparkRoute(vr_id, prefix);
+
+    return ReleaseNextHops(vr_id, nhs);
 }
 
-bool RouteMgr::Add(IpPrefix prefix, IpAddresses nexthops)
+bool RouteMgr::DelBatch(const std::vector<IpPrefix> &prefixes)
 {
-    sai_status_t status;
-    sai_object_id_t nhg_id;
-    std::vector<sai_object_id_t> nhids;
+    return DelBatch(g_vr_id, prefixes);
+}
 
-    std::set<IpAddress> addrset = nexthops.AddrSet();
+bool RouteMgr::DelBatch(sai_object_id_t vr_id, const std::vector<IpPrefix> &prefixes)
+{
+    std::vector<sai_route_entry_t> entries;
+    std::vector<RouteTable::iterator> routes;
+    std::vector<sai_status_t> statuses;
+    std::unordered_set<IpPrefix> chunkPrefixes;
+    size_t pos = 0;
+    size_t failures = 0;
 
-    std::vector<sai_attribute_t> nhg_attrs;
-    std::map<IpAddresses, sai_object_id_t>::iterator itnhg = m_EcmpGroups.find(nexthops);
+    LOGG(TEST_INFO, ROUTE, "sai_route_api->remove_route_entries vr_id 0x%lx %zu routes, %u routes per call\n",
+         vr_id, prefixes.size(), m_bulkChunkSize);
 
-    if (itnhg == m_EcmpGroups.end())
+    while (pos < prefixes.size())
     {
-        for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+        entries.clear();
+        routes.clear();
+        chunkPrefixes.clear();
+
+        for (; pos < prefixes.size() && entries.size() < m_bulkChunkSize; pos++)
         {
-            const NeighborEntry *nbEntry = m_neighborMgr->GetNeighborEntry(*itnh);
+            RouteTable::iterator it = m_Routes.find(VrfIpPrefix(vr_id, prefixes[pos]));
 
-            if (!nbEntry)
+            if (it == m_Routes.end())
+            {
+                LOGG(TEST_DEBUG, ROUTE, "cannot find route %s in the route table\n", prefixes[pos].to_string().c_str());
+                UnparkRoute(vr_id, prefixes[pos]);
+                continue;
+            }
+
+            if (!chunkPrefixes.insert(prefixes[pos]).second)
             {
-                LOGG(TEST_ERR, ROUTE, "fail to find the neighbor entry for nexthop %s\n", itnh->to_string().c_str());
                 continue;
             }
 
-            nhg_id = nbEntry->nhid;
-            nhids.push_back(nbEntry->nhid);
+            sai_route_entry_t route_entry;
+            fill_route_entry(vr_id, prefixes[pos], route_entry);
+
+            entries.push_back(route_entry);
+            routes.push_back(it);
         }
 
-        if (nhids.size() == 0)
+        statuses.assign(entries.size(), SAI_STATUS_NOT_EXECUTED);
+
+        if (!entries.empty())
         {
-            LOGG(TEST_DEBUG, ROUTE, "cannot find any of nexthops %s in the neighbor table\n", nexthops.to_string().c_str());
-            return false;
+            remove_route_chunk(entries, statuses);
         }
 
-        if (nhids.size() > 1)
+        for (size_t i = 0; i < routes.size(); i++)
         {
-            if (!m_nhgMgr->Add(nexthops))
+            if (statuses[i] != SAI_STATUS_SUCCESS)
             {
-                LOGG(TEST_ERR, ROUTE, "fail to add nexthop group %s\n", nexthops.to_string().c_str());
-                return false;
+                LOGG(TEST_ERR, ROUTE, "failed to remove route for %s, rc=0x%x\n",
+                     routes[i]->first.prefix.to_string().c_str(), -statuses[i]);
+                failures++;
+                continue;
             }
 
-            const NextHopGrpEntry *nhgEntry = m_nhgMgr->GetNextHopGrpEntry(nexthops);
+            NextHopSet *nhs = routes[i]->second;
+            EraseRoute(routes[i]);
 
-            if (!nhgEntry)
+            if (!ReleaseNextHops(vr_id, nhs))
             {
-                LOGG(TEST_ERR, ROUTE, "fail to retrieve nexthop group %s\n", nexthops.to_string().c_str());
-                return false;
+                failures++;
             }
-
-            nhg_id = nhgEntry->nhg_id;
         }
+    }
+
+    return (failures == 0);
+}
 
-        m_EcmpGroups[nexthops] = nhg_id;
+bool RouteMgr::CanUpdateInPlace(sai_object_id_t vr_id, const NextHopSet *nhs, const IpAddresses &nexthops)
+{
+    size_t resolved = 0;
+    const std::set<IpAddress> &addrset = nexthops.AddrSet();
+
+    if (!SAI_OID_TYPE_CHECK(nhs->nh_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP) || is_blackhole(nexthops))
+    {
+        return false;
     }
-    else
+
+    // the group object may also be held outside of this route table
+    const NextHopGrpEntry *nhgEntry = m_nhgMgr->GetNextHopGrpEntry(vr_id, nhs->nextHops);
+
+    if (!nhgEntry || nhgEntry->refCount != 1 || m_nhgMgr->GetNextHopGrpEntry(vr_id, nexthops))
+    {
+        return false;
+    }
+
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        if (m_neighborMgr->GetNeighborEntry(vr_id, *itnh))
+        {
+            resolved++;
+        }
+    }
+
+    // a single nexthop is programmed as the nexthop itself, not as a group
+    return (resolved > 1);
+}
+
+// bulk set of the routes from old to nhs, m_bulkChunkSize routes per call;
+// one bulk call per attribute, in fill_route_attrs() order
+void RouteMgr::ProgramNextHops(sai_object_id_t vr_id, const std::vector<RouteTable::iterator> &routes,
+                               const NextHopSet *old, const NextHopSet *nhs,
+                               std::vector<sai_status_t> &statuses)
+{
+    std::vector<sai_route_entry_t> entries;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<sai_status_t> chunkStatuses;
+    std::vector<size_t> index;
+
+    sai_attribute_t route_attrs[ROUTE_ATTR_MAX];
+    uint32_t count = fill_route_attrs(old, nhs, route_attrs);
+
+    statuses.assign(routes.size(), SAI_STATUS_NOT_EXECUTED);
+
+    for (size_t pos = 0; pos < routes.size();)
     {
-        nhg_id = m_EcmpGroups[nexthops];
+        size_t start = pos;
+
+        for (; pos < routes.size() && pos - start < m_bulkChunkSize; pos++)
+        {
+            statuses[pos] = SAI_STATUS_SUCCESS;
+        }
+
+        for (uint32_t a = 0; a < count; a++)
+        {
+            entries.clear();
+            index.clear();
+
+            // routes which failed an earlier attribute are left alone
+            for (size_t i = start; i < pos; i++)
+            {
+                if (statuses[i] != SAI_STATUS_SUCCESS)
+                {
+                    continue;
+                }
+
+                sai_route_entry_t route_entry;
+                fill_route_entry(vr_id, routes[i]->first.prefix, route_entry);
+
+                entries.push_back(route_entry);
+                index.push_back(i);
+            }
+
+            if (entries.empty())
+            {
+                break;
+            }
+
+            attrs.assign(entries.size(), route_attrs[a]);
+            chunkStatuses.assign(entries.size(), SAI_STATUS_NOT_EXECUTED);
+            set_route_chunk(entries, attrs, chunkStatuses);
+
+            for (size_t i = 0; i < index.size(); i++)
+            {
+                if (chunkStatuses[i] == SAI_STATUS_SUCCESS)
+                {
+                    continue;
+                }
+
+                statuses[index[i]] = chunkStatuses[i];
+
+                // put back the attributes already set
+                for (uint32_t b = a; b-- > 0;)
+                {
+                    sai_attribute_t route_attr = route_attrs[b];
+                    fill_old_route_attr(old, route_attr);
+                    sai_route_api->set_route_entry_attribute(&entries[i], &route_attr);
+                }
+            }
+        }
     }
+}
+
+void RouteMgr::ResolveNextHops(sai_object_id_t vr_id, NextHopSet *nhs)
+{
+    std::vector<RouteTable::iterator> routes;
+    std::vector<sai_status_t> statuses;
+    size_t resolved = 0;
 
+    if (SAI_OID_TYPE_CHECK(nhs->nh_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP))
+    {
+        m_nhgMgr->Refresh(vr_id, nhs->nextHops);
+        return;
+    }
 
-    sai_unicast_route_entry_t unicast_route_entry;
-    unicast_route_entry.vr_id = g_vr_id;
-    unicast_route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    unicast_route_entry.destination.addr.ip4 = prefix.Addr().addr();
-    unicast_route_entry.destination.mask.ip4 = prefix.Mask().addr();
+    const std::set<IpAddress> &addrset = nhs->nextHops.AddrSet();
 
-    sai_attribute_t route_attr;
+    for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
+    {
+        if (m_neighborMgr->GetNeighborEntry(vr_id, *itnh))
+        {
+            resolved++;
+        }
+    }
 
-    if (nexthops.size() == 1 &&
-            nexthops == IpAddresses("0.0.0.0"))
+    if (resolved < 2)
     {
-        route_attr.id = SAI_ROUTE_ATTR_PACKET_ACTION;
-        route_attr.value.s32 = SAI_PACKET_ACTION_DROP;
+        return;
     }
-    else
+
+    // programmed through its only resolved nexthop so far, move the routes
+    // to a group
+    if (!m_nhgMgr->Add(vr_id, nhs->nextHops))
     {
-        route_attr.id = SAI_ROUTE_ATTR_NEXT_HOP_ID;
-        route_attr.value.oid = nhg_id;
+        LOGG(TEST_ERR, ROUTE, "fail to add nexthop group %s\n", nhs->nextHops.to_string().c_str());
+        return;
     }
 
-    if (m_Routes.find(prefix) == m_Routes.end())
+    const NextHopGrpEntry *nhgEntry = m_nhgMgr->GetNextHopGrpEntry(vr_id, nhs->nextHops);
+
+    if (!nhgEntry)
     {
-        LOGG(TEST_INFO, ROUTE, "sai_route_api->create_route %s | nexthops %s\n",
-             prefix.to_string().c_str(), nexthops.to_string().c_str());
+        LOGG(TEST_ERR, ROUTE, "fail to retrieve nexthop group %s\n", nhs->nextHops.to_string().c_str());
+        m_nhgMgr->Del(vr_id, nhs->nextHops);
+        return;
+    }
 
-        status = sai_route_api->create_route(&unicast_route_entry, 1, &route_attr);
+    nhs->nh_id = nhgEntry->nhg_id;
 
-        if (status != SAI_STATUS_SUCCESS)
+    GetRoutes(vr_id, nhs, routes);
+
+    LOGG(TEST_INFO, ROUTE, "nexthops %s resolved to group 0x%lx, %zu routes\n",
+         nhs->nextHops.to_string().c_str(), nhs->nh_id, routes.size());
+
+    ProgramNextHops(vr_id, routes, nhs, nhs, statuses);
+
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+        if (statuses[i] != SAI_STATUS_SUCCESS)
         {
-            LOGG(TEST_ERR, ROUTE, "fail to create route for %s, nexthop(s) are %s rc=0x%x\n",
-                 prefix.to_string().c_str(),
-                 nexthops.to_string().c_str(), -status);
-            return false;
+            LOGG(TEST_ERR, ROUTE, "fail to set nexthop group 0x%lx for route %s, rc=0x%x\n",
+                 nhs->nh_id, routes[i]->first.prefix.to_string().c_str(), -statuses[i]);
         }
     }
-    else
+}
+
+void RouteMgr::OnNeighborsResolved(sai_object_id_t vr_id, const PendingResolution &resolved)
+{
+    RouteBatch routes;
+
+    std::map<sai_object_id_t, NextHopSetTable>::iterator itvr = m_NextHopSets.find(vr_id);
+
+    for (std::unordered_set<IpAddresses>::const_iterator it = resolved.nexthopSets.begin();
+            itvr != m_NextHopSets.end() && it != resolved.nexthopSets.end(); ++it)
     {
-        LOGG(TEST_INFO, ROUTE, "sai_route_api->set_route_attribute %s | nexthops %s\n",
-             prefix.to_string().c_str(), nexthops.to_string().c_str());
+        NextHopSetTable::iterator itnhs = itvr->second.find(*it);
 
-        status = sai_route_api->set_route_attribute(&unicast_route_entry, &route_attr);
+        if (itnhs != itvr->second.end())
+        {
+            ResolveNextHops(vr_id, itnhs->second);
+        }
+    }
 
-        if (status != SAI_STATUS_SUCCESS)
+    for (std::unordered_set<IpPrefix>::const_iterator it = resolved.routes.begin(); it != resolved.routes.end(); ++it)
+    {
+        std::unordered_map<VrfIpPrefix, IpAddresses>::const_iterator itpending = m_PendingRoutes.find(VrfIpPrefix(vr_id, *it));
+
+        if (itpending == m_PendingRoutes.end())
         {
-            LOGG(TEST_ERR, ROUTE, "fail to set nexthop(s) %s for route %s, rc=0x%x",
-                 nexthops.to_string().c_str(),
-                 prefix.to_string().c_str(), -status);
-            return false;
+            continue;
         }
 
-        return true;
+        routes.push_back(std::make_pair(*it, itpending->second));
+    }
+
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+        UnparkRoute(vr_id, routes[i].first);
     }
 
-    m_Routes[prefix] = nexthops;
+    if (!routes.empty())
+    {
+        LOGG(TEST_INFO, ROUTE, "program %zu routes waiting for neighbors\n", routes.size());
 
-    return true;
+        // routes still not resolvable are parked again
+        AddBatch(vr_id, routes);
+    }
 }
 
-bool RouteMgr::Del(IpPrefix prefix)
+bool RouteMgr::ChangeNextHops(const IpAddresses &oldNexthops, const IpAddresses &newNexthops)
+{
+    return ChangeNextHops(g_vr_id, oldNexthops, newNexthops);
+}
+
+bool RouteMgr::ChangeNextHops(sai_object_id_t vr_id, const IpAddresses &oldNexthops, const IpAddresses &newNexthops)
 {
+    std::vector<RouteTable::iterator> routes;
+    std::vector<sai_status_t> statuses;
+    size_t failures = 0;
 
-    RouteTable::const_iterator it;
-    it = m_Routes.find(prefix);
-    IpAddresses nexthops;
+    std::map<sai_object_id_t, NextHopSetTable>::iterator itvr = m_NextHopSets.find(vr_id);
 
-    if (it == m_Routes.end())
+    if (itvr == m_NextHopSets.end() || itvr->second.find(oldNexthops) == itvr->second.end())
     {
-        LOGG(TEST_DEBUG, ROUTE, "cannot find route %s in the route table\n", prefix.to_string().c_str());
+        LOGG(TEST_DEBUG, ROUTE, "no route uses nexthops %s\n", oldNexthops.to_string().c_str());
         return true;
     }
 
+    NextHopSet *oldNhs = itvr->second[oldNexthops];
 
-    LOGG(TEST_INFO, ROUTE, "sai_route_api->remove_route %s \n",
-         prefix.to_string().c_str());
+    if (oldNexthops == newNexthops)
+    {
+        return true;
+    }
+
+    // in place: the routes keep pointing to the same group
+    if (itvr->second.find(newNexthops) == itvr->second.end() &&
+            CanUpdateInPlace(vr_id, oldNhs, newNexthops))
+    {
+        LOGG(TEST_INFO, ROUTE, "update nexthop group 0x%lx in place, %u routes %s -> %s\n",
+             oldNhs->nh_id, oldNhs->refCount,
+             oldNexthops.to_string().c_str(), newNexthops.to_string().c_str());
 
-    sai_unicast_route_entry_t unicast_route_entry;
-    unicast_route_entry.vr_id = g_vr_id;
-    unicast_route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
-    unicast_route_entry.destination.addr.ip4 = prefix.Addr().addr();
-    unicast_route_entry.destination.mask.ip4 = prefix.Mask().addr();
+        // the manager rekeys the group even if some members failed
+        bool ret = m_nhgMgr->Update(vr_id, oldNexthops, newNexthops);
 
-    sai_status_t status = sai_route_api->remove_route(&unicast_route_entry);
+        UnwatchNextHops(vr_id, oldNexthops);
+        itvr->second.erase(oldNexthops);
+        oldNhs->nextHops = newNexthops;
+        itvr->second[newNexthops] = oldNhs;
+        WatchNextHops(vr_id, newNexthops);
 
-    if (status != SAI_STATUS_SUCCESS)
+        return ret;
+    }
+
+    NextHopSet *newNhs = AcquireNextHops(vr_id, newNexthops);
+
+    if (!newNhs)
     {
-        LOGG(TEST_ERR, ROUTE, "failed to remove route for %s, rc=0x%x\n", prefix.to_string().c_str(), -status);
         return false;
     }
 
+    GetRoutes(vr_id, oldNhs, routes);
 
-    sai_object_id_t nhg_id;
-    nexthops = m_Routes[prefix];
+    LOGG(TEST_INFO, ROUTE, "sai_route_api->set_route_entries_attribute vr_id 0x%lx %zu routes %s -> %s\n",
+         vr_id, routes.size(), oldNexthops.to_string().c_str(), newNexthops.to_string().c_str());
 
-    nhg_id = m_EcmpGroups[nexthops];
+    ProgramNextHops(vr_id, routes, oldNhs, newNhs, statuses);
 
-    //skip the entry for blackhole
-    if (nhg_id == 0)
+    for (size_t i = 0; i < routes.size(); i++)
     {
-        m_Routes.erase(prefix);
-        return true;
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            LOGG(TEST_ERR, ROUTE, "fail to set nexthop(s) %s for route %s, rc=0x%x\n",
+                 newNexthops.to_string().c_str(),
+                 routes[i]->first.prefix.to_string().c_str(), -statuses[i]);
+            failures++;
+            continue;
+        }
+
+        MoveRoute(routes[i], newNhs);
+        newNhs->refCount++;
+        ReleaseNextHops(vr_id, oldNhs);
     }
 
-    //On this field, there could be next hop id and next hop group id.
-    //the following handles only next hop group id
-    if (SAI_OID_TYPE_CHECK(nhg_id, SAI_OBJECT_TYPE_NEXT_HOP_GROUP))
+    ReleaseNextHops(vr_id, newNhs);
+
+    return (failures == 0);
+}
+
+bool RouteMgr::WithdrawNextHop(const IpAddress &nexthop, size_t &routes)
+{
+    return WithdrawNextHop(g_vr_id, nexthop, routes);
+}
+
+bool RouteMgr::WithdrawNextHop(sai_object_id_t vr_id, const IpAddress &nexthop, size_t &routes)
+{
+    std::vector<IpAddresses> affected;
+    bool ret = true;
+
+    routes = 0;
+
+    std::map<sai_object_id_t, NextHopSetTable>::const_iterator itvr = m_NextHopSets.find(vr_id);
+
+    if (itvr == m_NextHopSets.end())
     {
-        LOGG(TEST_INFO, ROUTE, "remove nexthopgrp id 0x%lx\n", nhg_id);
+        return true;
+    }
 
-        if (!m_nhgMgr->Del(nexthops))
+    for (NextHopSetTable::const_iterator it = itvr->second.begin(); it != itvr->second.end(); it++)
+    {
+        if (it->first.AddrSet().count(nexthop))
         {
-            LOGG(TEST_ERR, ROUTE, "failed to remove nexthopgrp id 0x%lx\n", nhg_id);
-            return false;
+            affected.push_back(it->first);
+            routes += it->second->refCount;
         }
     }
 
-    m_EcmpGroups.erase(nexthops);
-    m_Routes.erase(prefix);
+    LOGG(TEST_INFO, ROUTE, "withdraw nexthop %s from %zu nexthop sets, %zu routes\n",
+         nexthop.to_string().c_str(), affected.size(), routes);
 
-    for (it = m_Routes.begin(); it != m_Routes.end(); ++it)
+    for (size_t i = 0; i < affected.size(); i++)
     {
-        if (it->second == nexthops)
+        const std::set<IpAddress> &addrset = affected[i].AddrSet();
+        IpAddresses remaining;
+
+        for (std::set<IpAddress>::const_iterator itnh = addrset.begin(); itnh != addrset.end(); itnh++)
         {
-            break;
+            if (*itnh != nexthop)
+            {
+                remaining.add(*itnh);
+            }
+        }
+
+        if (!ChangeNextHops(vr_id, affected[i], remaining))
+        {
+            ret = false;
         }
     }
 
-    return true;
+    return ret;
 }
 
-
 bool RouteMgr::EraseAll()
 {
-    RouteTable::const_iterator it;
+    std::vector<sai_object_id_t> vrs;
+    std::vector<IpPrefix> prefixes;
+    bool ret = true;
+
+    while (!m_PendingRoutes.empty())
+    {
+        VrfIpPrefix key = m_PendingRoutes.begin()->first;
+        UnparkRoute(key.vr_id, key.prefix);
+    }
+
+    for (std::map<sai_object_id_t, PrefixTrie>::const_iterator it = m_RouteTries.begin(); it != m_RouteTries.end(); ++it)
+    {
+        vrs.push_back(it->first);
+    }
 
-    for (it = m_Routes.begin(); it != m_Routes.end(); ++it)
+    for (size_t i = 0; i < vrs.size(); i++)
     {
-        if (!RouteMgr::Del(it->first))
+        prefixes.clear();
+        m_RouteTries[vrs[i]].Walk(prefixes);
+
+        if (!DelBatch(vrs[i], prefixes))
         {
-            return false;
+            ret = false;
         }
     }
 
-    return true;
+    return ret;
 }
@@ -24,6 +24,10 @@
 #include <set>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 extern "C"
 {
@@ -34,28 +38,112 @@ extern "C"
 
 #include "log.h"
 #include "ip.h"
+#include "prefix_trie.h"
+#include "neighbor_mgr.h"
 #include "basic_router.h"
 
 
-class NeighborMgr;
 class NextHopGrpMgr;
 
-typedef std::map<IpPrefix, IpAddresses> RouteTable;
+// a nexthop set shared by all the routes of a VRF using it; nh_id is the
+// nexthop, the nexthop group or SAI_NULL_OBJECT_ID for blackhole routes,
+// whose nexthop set is empty
+struct NextHopSet
+{
+    IpAddresses nextHops;
+    sai_object_id_t nh_id;
+    uint32_t refCount;
+    std::unordered_set<IpPrefix> routes;    // prefixes of the routes using it
+};
+
+typedef std::unordered_map<VrfIpPrefix, NextHopSet*> RouteTable;
+
+typedef std::unordered_map<IpAddresses, NextHopSet*> NextHopSetTable;
+
+typedef std::vector<std::pair<IpPrefix, IpAddresses> > RouteBatch;
 
-class RouteMgr
+#define ROUTE_BULK_CHUNK_SIZE_DEFAULT   4096
+
+// packet action and nexthop
+#define ROUTE_ATTR_MAX                  2
+
+struct RouteChunk;
+
+class RouteMgr : public NeighborListener
 {
     NeighborMgr* m_neighborMgr;
     NextHopGrpMgr* m_nhgMgr;
 
+    // hashed by (vr_id, prefix); the per VRF tries keep the address order
+    // for Show() and EraseAll()
     RouteTable m_Routes;
+    std::map<sai_object_id_t, PrefixTrie> m_RouteTries;
+
+    std::map<sai_object_id_t, NextHopSetTable> m_NextHopSets;
 
-    std::map<IpAddresses, sai_object_id_t> m_EcmpGroups;
+    // routes none of whose nexthops is resolved, waiting in NeighborMgr
+    std::unordered_map<VrfIpPrefix, IpAddresses> m_PendingRoutes;
+
+    uint32_t m_bulkChunkSize;
+
+    void InsertRoute(sai_object_id_t vr_id, const IpPrefix &prefix, NextHopSet *nhs);
+    void EraseRoute(RouteTable::iterator it);
+    void MoveRoute(RouteTable::iterator it, NextHopSet *nhs);
+    void GetRoutes(sai_object_id_t vr_id, const NextHopSet *nhs, std::vector<RouteTable::iterator> &routes);
+    NextHopSet* AcquireNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops);
+    bool ReleaseNextHops(sai_object_id_t vr_id, NextHopSet *nhs);
+    void ParkRoute(sai_object_id_t vr_id, const IpPrefix &prefix, const IpAddresses &nexthops);
+    void UnparkRoute(sai_object_id_t vr_id, const IpPrefix &prefix);
+    void WatchNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops);
+    void UnwatchNextHops(sai_object_id_t vr_id, const IpAddresses &nexthops);
+    void ResolveNextHops(sai_object_id_t vr_id, NextHopSet *nhs);
+    void ProgramNextHops(sai_object_id_t vr_id, const std::vector<RouteTable::iterator> &routes,
+                         const NextHopSet *old, const NextHopSet *nhs,
+                         std::vector<sai_status_t> &statuses);
+    bool CanUpdateInPlace(sai_object_id_t vr_id, const NextHopSet *nhs, const IpAddresses &nexthops);
+    size_t BuildChunk(sai_object_id_t vr_id, const RouteBatch &routes, size_t &pos,
+                      const RouteChunk *inflight, RouteChunk &chunk,
+                      std::vector<size_t> &deferred);
+    size_t ReconcileAddChunk(sai_object_id_t vr_id, const RouteBatch &routes, RouteChunk &chunk);
 
 public:
     RouteMgr(NeighborMgr* neighborMgr, NextHopGrpMgr* nhgMgr);
+    ~RouteMgr();
 
+    // false when the route cannot be programmed now; a route none of whose
+    // nexthops is resolved is kept and programmed once one of them is.
+    // An empty nexthop set drops the route, in either address family
+    bool Add(sai_object_id_t vr_id, IpPrefix prefix, IpAddresses nexthops);
+    bool Del(sai_object_id_t vr_id, IpPrefix prefix);
+
+    // routes in the default VRF (g_vr_id)
     bool Add(IpPrefix prefix, IpAddresses nexthops);
     bool Del(IpPrefix prefix);
+
+    // program/remove routes with the bulk route API, m_bulkChunkSize routes
+    // per call; statuses are reconciled per route, so the return value only
+    // tells whether every route in the batch succeeded
+    bool AddBatch(sai_object_id_t vr_id, const RouteBatch &routes);
+    bool DelBatch(sai_object_id_t vr_id, const std::vector<IpPrefix> &prefixes);
+    bool AddBatch(const RouteBatch &routes);
+    bool DelBatch(const std::vector<IpPrefix> &prefixes);
+
+    // move every route using oldNexthops to newNexthops. An ECMP group
+    // only used by these routes is updated in place by adding/removing
+    // members, otherwise the routes are repointed with bulk set calls
+    bool ChangeNextHops(sai_object_id_t vr_id, const IpAddresses &oldNexthops, const IpAddresses &newNexthops);
+    bool ChangeNextHops(const IpAddresses &oldNexthops, const IpAddresses &newNexthops);
+
+    // nexthop went down: drop it from every nexthop set of the VRF, routes
+    // left without nexthops are dropped; routes is the number of routes
+    // which used the nexthop
+    bool WithdrawNextHop(sai_object_id_t vr_id, const IpAddress &nexthop, size_t &routes);
+    bool WithdrawNextHop(const IpAddress &nexthop, size_t &routes);
+
+    void OnNeighborsResolved(sai_object_id_t vr_id, const PendingResolution &resolved);
+    size_t GetPendingCount() const;
+
+    void SetBulkChunkSize(uint32_t chunkSize);
     bool EraseAll();
     void Show();
     void ShowECMP();
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// helpers shared by the dataplane model benchmarks
+
+typedef std::vector<std::pair<std::string, std::string> > BenchProfileItems;
+
+// "key=value,..." into its items, throws std::invalid_argument
+inline BenchProfileItems bench_profile_split(const std::string &profile)
+{
+    BenchProfileItems items;
+    std::stringstream ss(profile);
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+
+        size_t eq = item.find('=');
+
+        if (eq == std::string::npos)
+        {
+            throw std::invalid_argument("expect key=value, got " + item);
+        }
+
+        items.push_back(std::make_pair(item.substr(0, eq), item.substr(eq + 1)));
+    }
+
+    return items;
+}
+
+inline uint32_t bench_parse_uint(const std::string &key, const std::string &value)
+{
+    char *end = NULL;
+    unsigned long v = strtoul(value.c_str(), &end, 0);
+
+    if (value.empty() || *end != '\0')
+    {
+        throw std::invalid_argument("bad value " + value + " for " + key);
+    }
+
+    return (uint32_t)v;
+}
+
+inline uint64_t bench_now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+inline uint64_t bench_thread_cpu_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// absolute CLOCK_MONOTONIC deadline, as bench_now_ns() counts
+inline void bench_sleep_until(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+// nearest rank over sorted samples
+inline double bench_percentile(const std::vector<double> &sorted, double pct)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)(pct / 100.0 * sorted.size() + 0.5);
+
+    rank = rank ? rank - 1 : 0;
+
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+struct BenchLatency
+{
+    uint64_t count;
+    double meanUs;
+    double p50Us;
+    double p99Us;
+    double p999Us;
+    double maxUs;
+};
+
+// fixed memory latency histogram, 1us buckets up to maxUs, anything above
+// lands in the last one (max is exact)
+class BenchHistogram
+{
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    double m_sumUs;
+    double m_maxUs;
+
+public:
+    explicit BenchHistogram(uint32_t maxUs = 100000) : m_buckets(maxUs + 1), m_count(0), m_sumUs(0), m_maxUs(0) {}
+
+    void Add(double us)
+    {
+        size_t bucket = us <= 0 ? 0 : std::min((size_t)us, m_buckets.size() - 1);
+
+        m_buckets[bucket]++;
+        m_count++;
+        m_sumUs += us;
+        m_maxUs = std::max(m_maxUs, us);
+    }
+
+    void Clear()
+    {
+        std::fill(m_buckets.begin(), m_buckets.end(), 0);
+        m_count = 0;
+        m_sumUs = 0;
+        m_maxUs = 0;
+    }
+
+    // percentiles are the upper edge of their bucket
+    BenchLatency Summarize() const
+    {
+        static const double pcts[] = { 50, 99, 99.9 };
+        double values[3] = { 0, 0, 0 };
+        BenchLatency lat;
+        uint64_t seen = 0;
+        size_t next = 0;
+
+        for (size_t i = 0; i < m_buckets.size() && next < 3 && m_count; i++)
+        {
+            seen += m_buckets[i];
+
+            while (next < 3 && seen >= (uint64_t)(pcts[next] / 100.0 * m_count + 0.5) && seen)
+            {
+                values[next++] = std::min((double)(i + 1), m_maxUs);
+            }
+        }
+
+        lat.count = m_count;
+        lat.meanUs = m_count ? m_sumUs / m_count : 0;
+        lat.p50Us = values[0];
+        lat.p99Us = values[1];
+        lat.p999Us = values[2];
+        lat.maxUs = m_maxUs;
+
+        return lat;
+    }
+};
+
+// reusable barrier for a fixed set of threads, yields while waiting
+class BenchBarrier
+{
+    uint32_t m_count;
+    std::atomic<uint32_t> m_waiting;
+    std::atomic<uint32_t> m_generation;
+
+public:
+    explicit BenchBarrier(uint32_t count) : m_count(count), m_waiting(0), m_generation(0) {}
+
+    void Wait()
+    {
+        uint32_t generation = m_generation.load();
+
+        if (m_waiting.fetch_add(1) + 1 == m_count)
+        {
+            m_waiting.store(0);
+            m_generation.fetch_add(1);
+            return;
+        }
+
+        while (m_generation.load() == generation)
+        {
+            std::this_thread::yield();
+        }
+    }
+};
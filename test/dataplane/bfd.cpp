@@ -0,0 +1,979 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bfd.h"
+
+#define BFD_BATCH               64
+#define BFD_RX_SLOT_LEN         64
+#define BFD_RX_BATCHES_PER_POLL 64
+#define BFD_SOCKET_BUFFER       (4 * 1024 * 1024)
+
+#define TIMER_TX(index)         ((index) * 2)
+#define TIMER_DETECT(index)     ((index) * 2 + 1)
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+
+    return ntohl(v);
+}
+
+size_t bfd_encode(const BfdControlPacket &pkt, uint8_t *buf, size_t len)
+{
+    if (len < BFD_CONTROL_PACKET_LEN)
+    {
+        return 0;
+    }
+
+    buf[0] = (uint8_t)((pkt.version << 5) | (pkt.diag & 0x1F));
+    buf[1] = (uint8_t)((pkt.state << 6) | (pkt.poll << 5) | (pkt.final << 4) | (pkt.cpi << 3) |
+                       (pkt.auth << 2) | (pkt.demand << 1) | pkt.multipoint);
+    buf[2] = pkt.detectMult;
+    buf[3] = BFD_CONTROL_PACKET_LEN;
+    put32(buf + 4, pkt.myDiscriminator);
+    put32(buf + 8, pkt.yourDiscriminator);
+    put32(buf + 12, pkt.desiredMinTx);
+    put32(buf + 16, pkt.requiredMinRx);
+    put32(buf + 20, pkt.requiredMinEchoRx);
+
+    return BFD_CONTROL_PACKET_LEN;
+}
+
+bool bfd_decode(const uint8_t *buf, size_t len, BfdControlPacket &pkt)
+{
+    if (len < BFD_CONTROL_PACKET_LEN)
+    {
+        return false;
+    }
+
+    pkt.version = buf[0] >> 5;
+    pkt.diag = buf[0] & 0x1F;
+    pkt.state = buf[1] >> 6;
+    pkt.poll = (buf[1] >> 5) & 1;
+    pkt.final = (buf[1] >> 4) & 1;
+    pkt.cpi = (buf[1] >> 3) & 1;
+    pkt.auth = (buf[1] >> 2) & 1;
+    pkt.demand = (buf[1] >> 1) & 1;
+    pkt.multipoint = buf[1] & 1;
+    pkt.detectMult = buf[2];
+    pkt.length = buf[3];
+    pkt.myDiscriminator = get32(buf + 4);
+    pkt.yourDiscriminator = get32(buf + 8);
+    pkt.desiredMinTx = get32(buf + 12);
+    pkt.requiredMinRx = get32(buf + 16);
+    pkt.requiredMinEchoRx = get32(buf + 20);
+
+    // no authentication is configured, so the A bit fails the packet too
+    return pkt.version == BFD_VERSION &&
+           pkt.length >= BFD_CONTROL_PACKET_LEN && pkt.length <= len &&
+           pkt.detectMult != 0 &&
+           !pkt.multipoint &&
+           !pkt.auth &&
+           pkt.myDiscriminator != 0 &&
+           (pkt.yourDiscriminator != 0 ||
+            pkt.state == SAI_BFD_SESSION_STATE_ADMIN_DOWN || pkt.state == SAI_BFD_SESSION_STATE_DOWN);
+}
+
+BfdSessionConfig::BfdSessionConfig()
+{
+    type = SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE;
+    localDiscriminator = 0;
+    remoteDiscriminator = 0;
+    minTx = 0;
+    minRx = 0;
+    multiplier = 0;
+    multihop = false;
+    cbit = false;
+    offloadType = SAI_BFD_SESSION_OFFLOAD_TYPE_NONE;
+}
+
+static sai_status_t parse_attrs(BfdSessionConfig &config,
+                                uint32_t attr_count,
+                                const sai_attribute_t *attr_list,
+                                bool create)
+{
+    uint32_t mandatory = 0;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_BFD_SESSION_ATTR_TYPE:
+            case SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR:
+            case SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR:
+            case SAI_BFD_SESSION_ATTR_MULTIHOP:
+            case SAI_BFD_SESSION_ATTR_CBIT:
+            case SAI_BFD_SESSION_ATTR_OFFLOAD_TYPE:
+            case SAI_BFD_SESSION_ATTR_UDP_SRC_PORT:
+            case SAI_BFD_SESSION_ATTR_HW_LOOKUP_VALID:
+            case SAI_BFD_SESSION_ATTR_VLAN_ID:
+            case SAI_BFD_SESSION_ATTR_VLAN_HEADER_VALID:
+            case SAI_BFD_SESSION_ATTR_BFD_ENCAPSULATION_TYPE:
+            case SAI_BFD_SESSION_ATTR_SRC_IP_ADDRESS:
+            case SAI_BFD_SESSION_ATTR_DST_IP_ADDRESS:
+            case SAI_BFD_SESSION_ATTR_TUNNEL_SRC_IP_ADDRESS:
+            case SAI_BFD_SESSION_ATTR_TUNNEL_DST_IP_ADDRESS:
+            case SAI_BFD_SESSION_ATTR_SRV6_SIDLIST_ID:
+                if (!create)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+
+        switch (attr.id)
+        {
+            case SAI_BFD_SESSION_ATTR_TYPE:
+                if (attr.value.s32 == SAI_BFD_SESSION_TYPE_DEMAND_ACTIVE ||
+                    attr.value.s32 == SAI_BFD_SESSION_TYPE_DEMAND_PASSIVE)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                if (attr.value.s32 != SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE &&
+                    attr.value.s32 != SAI_BFD_SESSION_TYPE_ASYNC_PASSIVE)
+                {
+                    return badValue;
+                }
+                config.type = (sai_bfd_session_type_t)attr.value.s32;
+                mandatory |= 1 << 0;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.localDiscriminator = attr.value.u32;
+                mandatory |= 1 << 1;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.remoteDiscriminator = attr.value.u32;
+                mandatory |= 1 << 2;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_MIN_TX:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.minTx = attr.value.u32;
+                mandatory |= 1 << 3;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_MIN_RX:
+                config.minRx = attr.value.u32;
+                mandatory |= 1 << 4;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_MULTIPLIER:
+                if (attr.value.u8 == 0)
+                {
+                    return badValue;
+                }
+                config.multiplier = attr.value.u8;
+                mandatory |= 1 << 5;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_MULTIHOP:
+                config.multihop = attr.value.booldata;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_CBIT:
+                config.cbit = attr.value.booldata;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_OFFLOAD_TYPE:
+                if (attr.value.s32 < SAI_BFD_SESSION_OFFLOAD_TYPE_NONE ||
+                    attr.value.s32 > SAI_BFD_SESSION_OFFLOAD_TYPE_SUSTENANCE)
+                {
+                    return badValue;
+                }
+                config.offloadType = (sai_bfd_session_offload_type_t)attr.value.s32;
+                break;
+
+            case SAI_BFD_SESSION_ATTR_ECHO_ENABLE:
+                if (attr.value.booldata)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                break;
+
+            case SAI_BFD_SESSION_ATTR_REMOTE_MIN_TX:
+            case SAI_BFD_SESSION_ATTR_REMOTE_MIN_RX:
+            case SAI_BFD_SESSION_ATTR_STATE:
+            case SAI_BFD_SESSION_ATTR_NEGOTIATED_TX:
+            case SAI_BFD_SESSION_ATTR_NEGOTIATED_RX:
+            case SAI_BFD_SESSION_ATTR_LOCAL_DIAG:
+            case SAI_BFD_SESSION_ATTR_REMOTE_DIAG:
+            case SAI_BFD_SESSION_ATTR_REMOTE_MULTIPLIER:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+
+            default:
+                // addressing and encapsulation, the engine has its own socket
+                if (attr.id >= SAI_BFD_SESSION_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    if (create && mandatory != (1 << 6) - 1)
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+BfdEngine::BfdEngine(uint32_t capacity, uint64_t tickNs, uint64_t nowNs) :
+    m_capacity(capacity),
+    m_count(0),
+    m_slowTxUs(BFD_SLOW_TX_INTERVAL_US),
+    m_fd(-1),
+    m_sessions(capacity),
+    m_upCount(0),
+    m_unknownDrops(0),
+    m_rng(0x9e3779b9),
+    m_wheel(capacity * 2, tickNs, nowNs),
+    m_txBuf(BFD_BATCH * BFD_CONTROL_PACKET_LEN),
+    m_txIndex(BFD_BATCH),
+    m_txCount(0),
+    m_rxBuf(BFD_BATCH * BFD_RX_SLOT_LEN),
+    m_notify(NULL),
+    m_notifyCalls(0)
+{
+    memset(&m_peer, 0, sizeof(m_peer));
+
+    m_free.reserve(capacity);
+
+    for (uint32_t i = capacity; i > 0; i--)
+    {
+        m_free.push_back(i - 1);
+    }
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        m_sessions[i].used = false;
+    }
+}
+
+BfdEngine::~BfdEngine()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+bool BfdEngine::Open(const char *addr, uint16_t port)
+{
+    struct sockaddr_in sin;
+    int size = BFD_SOCKET_BUFFER;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1)
+    {
+        return false;
+    }
+
+    m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    // best effort, capped by net.core.[rw]mem_max
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    if (bind(m_fd, (struct sockaddr*)&sin, sizeof(sin)) < 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+uint16_t BfdEngine::GetPort() const
+{
+    struct sockaddr_in sin;
+    socklen_t len = sizeof(sin);
+
+    if (m_fd < 0 || getsockname(m_fd, (struct sockaddr*)&sin, &len) < 0)
+    {
+        return 0;
+    }
+
+    return ntohs(sin.sin_port);
+}
+
+bool BfdEngine::SetPeer(const char *addr, uint16_t port)
+{
+    m_peer.sin_family = AF_INET;
+    m_peer.sin_port = htons(port);
+
+    return inet_pton(AF_INET, addr, &m_peer.sin_addr) == 1;
+}
+
+void BfdEngine::SetNotification(sai_bfd_session_state_change_notification_fn notify)
+{
+    m_notify = notify;
+}
+
+void BfdEngine::SetSlowTxInterval(uint32_t us)
+{
+    m_slowTxUs = us;
+}
+
+// 0 when the peer asked for no packets
+uint32_t BfdEngine::TxIntervalUs(const BfdSession &session) const
+{
+    if (session.heard && session.remoteMinRx == 0)
+    {
+        return 0;
+    }
+
+    if (session.state != SAI_BFD_SESSION_STATE_UP)
+    {
+        return std::max(session.config.minTx, m_slowTxUs);
+    }
+
+    return std::max(session.config.minTx, session.remoteMinRx);
+}
+
+uint64_t BfdEngine::DetectionTimeNs(const BfdSession &session) const
+{
+    return (uint64_t)session.remoteMultiplier * std::max(session.config.minRx, session.remoteMinTx) * 1000;
+}
+
+// RFC 5880 section 6.8.7: 0 to 25% off, 10 to 25% with a multiplier of 1
+uint64_t BfdEngine::Jittered(const BfdSession &session, uint32_t intervalUs)
+{
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+
+    uint32_t minPct = session.config.multiplier == 1 ? 10 : 0;
+    uint32_t pct = minPct + m_rng % (25 - minPct);
+
+    return (uint64_t)intervalUs * (100 - pct) * 10;
+}
+
+void BfdEngine::ScheduleTx(uint32_t index, uint64_t nowNs, bool sooner)
+{
+    BfdSession &session = m_sessions[index];
+    uint32_t intervalUs = TxIntervalUs(session);
+
+    if (intervalUs == 0)
+    {
+        m_wheel.Cancel(TIMER_TX(index));
+        return;
+    }
+
+    uint64_t due = nowNs + Jittered(session, intervalUs);
+
+    if (sooner && m_wheel.IsPending(TIMER_TX(index)) && session.txDueNs <= due)
+    {
+        return;
+    }
+
+    session.txDueNs = due;
+    m_wheel.Schedule(TIMER_TX(index), due);
+}
+
+void BfdEngine::SetState(uint32_t index, sai_bfd_session_state_t state, uint8_t diag)
+{
+    BfdSession &session = m_sessions[index];
+
+    if (session.state == state)
+    {
+        return;
+    }
+
+    if (state == SAI_BFD_SESSION_STATE_UP)
+    {
+        m_upCount++;
+    }
+    else if (session.state == SAI_BFD_SESSION_STATE_UP)
+    {
+        m_upCount--;
+    }
+
+    // the reason for going down is kept until the session is back up
+    session.state = state;
+
+    if (state != SAI_BFD_SESSION_STATE_INIT)
+    {
+        session.localDiag = diag;
+    }
+
+    sai_bfd_session_state_notification_t data;
+
+    data.bfd_session_id = index;
+    data.session_state = state;
+    m_notifications.push_back(data);
+}
+
+sai_status_t BfdEngine::Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list, uint64_t nowNs)
+{
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (m_free.empty())
+    {
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    BfdSessionConfig config;
+    sai_status_t status = parse_attrs(config, attr_count, attr_list, true);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (m_byDiscriminator.find(config.localDiscriminator) != m_byDiscriminator.end())
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    index = m_free.back();
+    m_free.pop_back();
+    m_count++;
+
+    BfdSession &session = m_sessions[index];
+
+    session = BfdSession();
+    session.config = config;
+    session.used = true;
+    session.state = SAI_BFD_SESSION_STATE_DOWN;
+    session.remoteState = SAI_BFD_SESSION_STATE_DOWN;
+    session.remoteMinRx = 1;
+
+    m_byDiscriminator[config.localDiscriminator] = index;
+
+    // passive sessions wait for the peer, active ones start somewhere in
+    // their first interval so they don't go out in lockstep
+    if (config.type == SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE)
+    {
+        session.txDueNs = nowNs + Jittered(session, TxIntervalUs(session)) * (m_rng % 1024) / 1024;
+        m_wheel.Schedule(TIMER_TX(index), session.txDueNs);
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t BfdEngine::Remove(uint32_t index)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    BfdSession &session = m_sessions[index];
+
+    if (session.state == SAI_BFD_SESSION_STATE_UP)
+    {
+        m_upCount--;
+    }
+
+    m_wheel.Cancel(TIMER_TX(index));
+    m_wheel.Cancel(TIMER_DETECT(index));
+    m_byDiscriminator.erase(session.config.localDiscriminator);
+
+    session.used = false;
+    m_free.push_back(index);
+    m_count--;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t BfdEngine::Set(uint32_t index, const sai_attribute_t *attr, uint64_t nowNs)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    BfdSession &session = m_sessions[index];
+    BfdSessionConfig config = session.config;
+    sai_status_t status = parse_attrs(config, 1, attr, false);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    session.config = config;
+
+    // no poll sequence, the new intervals apply from the next packet
+    if (m_wheel.IsPending(TIMER_TX(index)))
+    {
+        ScheduleTx(index, nowNs, true);
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t BfdEngine::Get(uint32_t index, uint32_t attr_count, sai_attribute_t *attr_list) const
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    const BfdSession &session = m_sessions[index];
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        sai_attribute_value_t &value = attr_list[i].value;
+
+        switch (attr_list[i].id)
+        {
+            case SAI_BFD_SESSION_ATTR_TYPE:
+                value.s32 = session.config.type;
+                break;
+            case SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR:
+                value.u32 = session.config.localDiscriminator;
+                break;
+            case SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR:
+                value.u32 = session.config.remoteDiscriminator;
+                break;
+            case SAI_BFD_SESSION_ATTR_MIN_TX:
+                value.u32 = session.config.minTx;
+                break;
+            case SAI_BFD_SESSION_ATTR_MIN_RX:
+                value.u32 = session.config.minRx;
+                break;
+            case SAI_BFD_SESSION_ATTR_MULTIPLIER:
+                value.u8 = session.config.multiplier;
+                break;
+            case SAI_BFD_SESSION_ATTR_MULTIHOP:
+                value.booldata = session.config.multihop;
+                break;
+            case SAI_BFD_SESSION_ATTR_CBIT:
+                value.booldata = session.config.cbit;
+                break;
+            case SAI_BFD_SESSION_ATTR_ECHO_ENABLE:
+                value.booldata = false;
+                break;
+            case SAI_BFD_SESSION_ATTR_OFFLOAD_TYPE:
+                value.s32 = session.config.offloadType;
+                break;
+            case SAI_BFD_SESSION_ATTR_REMOTE_MIN_TX:
+                value.u32 = session.remoteMinTx;
+                break;
+            case SAI_BFD_SESSION_ATTR_REMOTE_MIN_RX:
+                value.u32 = session.remoteMinRx;
+                break;
+            case SAI_BFD_SESSION_ATTR_STATE:
+                value.s32 = session.state;
+                break;
+            case SAI_BFD_SESSION_ATTR_NEGOTIATED_TX:
+                value.u32 = std::max(session.config.minTx, session.remoteMinRx);
+                break;
+            case SAI_BFD_SESSION_ATTR_NEGOTIATED_RX:
+                value.u32 = std::max(session.config.minRx, session.remoteMinTx);
+                break;
+            case SAI_BFD_SESSION_ATTR_LOCAL_DIAG:
+                value.u8 = session.localDiag;
+                break;
+            case SAI_BFD_SESSION_ATTR_REMOTE_DIAG:
+                value.u8 = session.remoteDiag;
+                break;
+            case SAI_BFD_SESSION_ATTR_REMOTE_MULTIPLIER:
+                value.u8 = session.remoteMultiplier;
+                break;
+            default:
+                if (attr_list[i].id < SAI_BFD_SESSION_ATTR_END)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t BfdEngine::GetStats(uint32_t index,
+                                 uint32_t number_of_counters,
+                                 const sai_stat_id_t *counter_ids,
+                                 sai_stats_mode_t mode,
+                                 uint64_t *counters)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if ((number_of_counters && (counter_ids == NULL || counters == NULL)) ||
+        (mode != SAI_STATS_MODE_READ && mode != SAI_STATS_MODE_READ_AND_CLEAR))
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        if (counter_ids[i] >= BFD_SESSION_STAT_COUNT)
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    uint64_t *stat = m_sessions[index].stat;
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        counters[i] = stat[counter_ids[i]];
+
+        if (mode == SAI_STATS_MODE_READ_AND_CLEAR)
+        {
+            stat[counter_ids[i]] = 0;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void BfdEngine::Transmit(uint32_t index)
+{
+    const BfdSession &session = m_sessions[index];
+    BfdControlPacket pkt;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.version = BFD_VERSION;
+    pkt.diag = session.localDiag;
+    pkt.state = (uint8_t)session.state;
+    pkt.cpi = session.config.cbit;
+    pkt.detectMult = session.config.multiplier;
+    pkt.myDiscriminator = session.config.localDiscriminator;
+    pkt.yourDiscriminator = session.config.remoteDiscriminator;
+    pkt.desiredMinTx = session.state == SAI_BFD_SESSION_STATE_UP ?
+                       session.config.minTx : std::max(session.config.minTx, m_slowTxUs);
+    pkt.requiredMinRx = session.config.minRx;
+
+    if (m_txCount == BFD_BATCH)
+    {
+        FlushTx();
+    }
+
+    bfd_encode(pkt, &m_txBuf[m_txCount * BFD_CONTROL_PACKET_LEN], BFD_CONTROL_PACKET_LEN);
+    m_txIndex[m_txCount++] = index;
+}
+
+void BfdEngine::FlushTx()
+{
+    struct mmsghdr msgs[BFD_BATCH];
+    struct iovec iov[BFD_BATCH];
+    uint32_t sent = 0;
+
+    for (uint32_t i = 0; i < m_txCount; i++)
+    {
+        iov[i].iov_base = &m_txBuf[i * BFD_CONTROL_PACKET_LEN];
+        iov[i].iov_len = BFD_CONTROL_PACKET_LEN;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &m_peer;
+        msgs[i].msg_hdr.msg_namelen = sizeof(m_peer);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // a full socket buffer loses the rest of the batch, as a full TX
+    // queue would
+    while (sent < m_txCount && m_fd >= 0)
+    {
+        int n = sendmmsg(m_fd, &msgs[sent], m_txCount - sent, 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        sent += (uint32_t)n;
+    }
+
+    for (uint32_t i = 0; i < sent; i++)
+    {
+        m_sessions[m_txIndex[i]].stat[SAI_BFD_SESSION_STAT_OUT_PACKETS]++;
+    }
+
+    m_txCount = 0;
+}
+
+// RFC 5880 section 6.8.6, from the discriminator lookup on
+void BfdEngine::Receive(const BfdControlPacket &pkt, uint64_t nowNs)
+{
+    std::unordered_map<uint32_t, uint32_t>::const_iterator it = m_byDiscriminator.find(pkt.yourDiscriminator);
+
+    if (it == m_byDiscriminator.end())
+    {
+        m_unknownDrops++;
+        return;
+    }
+
+    uint32_t index = it->second;
+    BfdSession &session = m_sessions[index];
+
+    if (pkt.myDiscriminator != session.config.remoteDiscriminator)
+    {
+        session.stat[SAI_BFD_SESSION_STAT_DROP_PACKETS]++;
+        return;
+    }
+
+    sai_bfd_session_state_t before = session.state;
+    bool heard = session.heard;
+
+    session.stat[SAI_BFD_SESSION_STAT_IN_PACKETS]++;
+    session.heard = true;
+    session.remoteState = pkt.state;
+    session.remoteDiag = pkt.diag;
+    session.remoteMultiplier = pkt.detectMult;
+    session.remoteMinTx = pkt.desiredMinTx;
+    session.remoteMinRx = pkt.requiredMinRx;
+
+    if (pkt.state == SAI_BFD_SESSION_STATE_ADMIN_DOWN)
+    {
+        if (session.state != SAI_BFD_SESSION_STATE_DOWN)
+        {
+            SetState(index, SAI_BFD_SESSION_STATE_DOWN, BFD_DIAG_NEIGHBOR_SIGNALED_DOWN);
+        }
+    }
+    else if (session.state == SAI_BFD_SESSION_STATE_DOWN)
+    {
+        if (pkt.state == SAI_BFD_SESSION_STATE_DOWN)
+        {
+            SetState(index, SAI_BFD_SESSION_STATE_INIT, BFD_DIAG_NONE);
+        }
+        else if (pkt.state == SAI_BFD_SESSION_STATE_INIT)
+        {
+            SetState(index, SAI_BFD_SESSION_STATE_UP, BFD_DIAG_NONE);
+        }
+    }
+    else if (session.state == SAI_BFD_SESSION_STATE_INIT)
+    {
+        if (pkt.state == SAI_BFD_SESSION_STATE_INIT || pkt.state == SAI_BFD_SESSION_STATE_UP)
+        {
+            SetState(index, SAI_BFD_SESSION_STATE_UP, BFD_DIAG_NONE);
+        }
+    }
+    else if (pkt.state == SAI_BFD_SESSION_STATE_DOWN)
+    {
+        SetState(index, SAI_BFD_SESSION_STATE_DOWN, BFD_DIAG_NEIGHBOR_SIGNALED_DOWN);
+    }
+
+    if (session.state == SAI_BFD_SESSION_STATE_DOWN)
+    {
+        m_wheel.Cancel(TIMER_DETECT(index));
+    }
+    else
+    {
+        m_wheel.Schedule(TIMER_DETECT(index), nowNs + DetectionTimeNs(session));
+    }
+
+    // a passive session starts talking, a changed state speeds the next
+    // packet up to the new interval
+    if (!heard || session.state != before || !m_wheel.IsPending(TIMER_TX(index)))
+    {
+        ScheduleTx(index, nowNs, true);
+    }
+}
+
+uint32_t BfdEngine::ReceiveBatch(uint64_t nowNs)
+{
+    struct mmsghdr msgs[BFD_BATCH];
+    struct iovec iov[BFD_BATCH];
+
+    for (uint32_t i = 0; i < BFD_BATCH; i++)
+    {
+        iov[i].iov_base = &m_rxBuf[i * BFD_RX_SLOT_LEN];
+        iov[i].iov_len = BFD_RX_SLOT_LEN;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n = m_fd >= 0 ? recvmmsg(m_fd, msgs, BFD_BATCH, MSG_DONTWAIT, NULL) : -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        BfdControlPacket pkt;
+
+        if (bfd_decode(&m_rxBuf[i * BFD_RX_SLOT_LEN], msgs[i].msg_len, pkt))
+        {
+            Receive(pkt, nowNs);
+        }
+        else
+        {
+            m_unknownDrops++;
+        }
+    }
+
+    return n > 0 ? (uint32_t)n : 0;
+}
+
+uint32_t BfdEngine::Poll(uint64_t nowNs)
+{
+    uint32_t handled = 0;
+
+    for (uint32_t batch = 0; batch < BFD_RX_BATCHES_PER_POLL; batch++)
+    {
+        uint32_t n = ReceiveBatch(nowNs);
+
+        handled += n;
+
+        if (n < BFD_BATCH)
+        {
+            break;
+        }
+    }
+
+    m_expired.clear();
+    m_wheel.Advance(nowNs, m_expired);
+
+    for (size_t i = 0; i < m_expired.size(); i++)
+    {
+        uint32_t index = m_expired[i] / 2;
+        BfdSession &session = m_sessions[index];
+
+        if (!session.used)
+        {
+            continue;
+        }
+
+        if (m_expired[i] == TIMER_TX(index))
+        {
+            m_txLateness.Add((double)(nowNs - std::min(nowNs, session.txDueNs)) / 1000);
+            Transmit(index);
+            ScheduleTx(index, nowNs, false);
+            handled++;
+        }
+        else if (session.state == SAI_BFD_SESSION_STATE_INIT || session.state == SAI_BFD_SESSION_STATE_UP)
+        {
+            SetState(index, SAI_BFD_SESSION_STATE_DOWN, BFD_DIAG_CONTROL_DETECTION_EXPIRED);
+        }
+    }
+
+    if (m_txCount)
+    {
+        FlushTx();
+    }
+
+    if (!m_notifications.empty())
+    {
+        if (m_notify)
+        {
+            m_notify((uint32_t)m_notifications.size(), m_notifications.data());
+        }
+
+        m_notifyCalls++;
+        m_notifications.clear();
+    }
+
+    return handled;
+}
+
+BenchLatency BfdEngine::GetTxLateness() const
+{
+    return m_txLateness.Summarize();
+}
+
+void BfdEngine::ClearTxLateness()
+{
+    m_txLateness.Clear();
+}
+
+uint32_t BfdEngine::Size() const
+{
+    return m_count;
+}
+
+uint32_t BfdEngine::UpCount() const
+{
+    return m_upCount.load();
+}
+
+uint64_t BfdEngine::UnknownDrops() const
+{
+    return m_unknownDrops;
+}
+
+uint64_t BfdEngine::NotifyCalls() const
+{
+    return m_notifyCalls;
+}
+
+const BfdSession* BfdEngine::GetSession(uint32_t index) const
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return NULL;
+    }
+
+    return &m_sessions[index];
+}
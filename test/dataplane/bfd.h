@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+#include "bench_util.h"
+#include "timer_wheel.h"
+
+#define BFD_CONTROL_PACKET_LEN              24
+#define BFD_VERSION                         1
+
+// RFC 5880 section 4.1 diagnostic codes
+#define BFD_DIAG_NONE                       0
+#define BFD_DIAG_CONTROL_DETECTION_EXPIRED  1
+#define BFD_DIAG_NEIGHBOR_SIGNALED_DOWN     3
+
+// RFC 5880 section 6.8.3, TX interval while the session is not up
+#define BFD_SLOW_TX_INTERVAL_US             1000000
+
+#define BFD_SESSION_STAT_COUNT              (SAI_BFD_SESSION_STAT_DROP_PACKETS + 1)
+
+// mandatory section of a control packet, the state field values match
+// sai_bfd_session_state_t
+struct BfdControlPacket
+{
+    uint8_t version;
+    uint8_t diag;
+    uint8_t state;
+    bool poll;
+    bool final;
+    bool cpi;
+    bool auth;
+    bool demand;
+    bool multipoint;
+    uint8_t detectMult;
+    uint8_t length;
+    uint32_t myDiscriminator;
+    uint32_t yourDiscriminator;
+    uint32_t desiredMinTx;          // microseconds
+    uint32_t requiredMinRx;
+    uint32_t requiredMinEchoRx;
+};
+
+// BFD_CONTROL_PACKET_LEN bytes into buf, 0 when it does not fit
+size_t bfd_encode(const BfdControlPacket &pkt, uint8_t *buf, size_t len);
+
+// false when the packet fails the session independent checks of RFC 5880
+// section 6.8.6 (version, length, multiplier, multipoint, discriminators)
+bool bfd_decode(const uint8_t *buf, size_t len, BfdControlPacket &pkt);
+
+// SAI_BFD_SESSION_ATTR_* the engine runs on, the addressing and
+// encapsulation attributes are accepted and ignored
+struct BfdSessionConfig
+{
+    sai_bfd_session_type_t type;
+    uint32_t localDiscriminator;
+    uint32_t remoteDiscriminator;
+    uint32_t minTx;
+    uint32_t minRx;
+    uint8_t multiplier;
+    bool multihop;
+    bool cbit;
+    sai_bfd_session_offload_type_t offloadType;
+
+    BfdSessionConfig();
+};
+
+struct BfdSession
+{
+    BfdSessionConfig config;
+    bool used;
+    bool heard;                     // a valid packet came in since Create
+    sai_bfd_session_state_t state;
+    uint8_t localDiag;
+    uint8_t remoteState;
+    uint8_t remoteDiag;
+    uint8_t remoteMultiplier;
+    uint32_t remoteMinTx;
+    uint32_t remoteMinRx;
+    uint64_t txDueNs;
+    uint64_t stat[BFD_SESSION_STAT_COUNT];
+};
+
+// Software asynchronous mode BFD (RFC 5880/5881) over one UDP socket.
+//
+// Each session owns a TX and a detection timer on a hierarchical timer
+// wheel. Poll() receives a batch of packets with recvmmsg(), fires the due
+// timers, sends the TX batch with sendmmsg() and reports the state changes
+// of the call in one sai_bfd_session_state_change_notification_fn call,
+// whose bfd_session_id carries the session index.
+//
+// Packets are demultiplexed on Your Discriminator, which is always known
+// since SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR is mandatory. Interval
+// changes apply at once instead of through a poll sequence; demand mode,
+// echo and authentication are not modelled. The engine is not thread safe,
+// but UpCount() may be read from any thread.
+class BfdEngine
+{
+    uint32_t m_capacity;
+    uint32_t m_count;
+    uint32_t m_slowTxUs;
+    int m_fd;
+    struct sockaddr_in m_peer;
+
+    std::vector<BfdSession> m_sessions;
+    std::vector<uint32_t> m_free;
+    std::unordered_map<uint32_t, uint32_t> m_byDiscriminator;
+    std::atomic<uint32_t> m_upCount;
+    uint64_t m_unknownDrops;
+    uint32_t m_rng;
+
+    TimerWheel m_wheel;
+    std::vector<uint32_t> m_expired;
+    std::vector<uint8_t> m_txBuf;
+    std::vector<uint32_t> m_txIndex;
+    uint32_t m_txCount;
+    std::vector<uint8_t> m_rxBuf;
+
+    std::vector<sai_bfd_session_state_notification_t> m_notifications;
+    sai_bfd_session_state_change_notification_fn m_notify;
+    uint64_t m_notifyCalls;
+
+    BenchHistogram m_txLateness;
+
+    uint32_t TxIntervalUs(const BfdSession &session) const;
+    uint64_t DetectionTimeNs(const BfdSession &session) const;
+    uint64_t Jittered(const BfdSession &session, uint32_t intervalUs);
+    void ScheduleTx(uint32_t index, uint64_t nowNs, bool sooner);
+    void SetState(uint32_t index, sai_bfd_session_state_t state, uint8_t diag);
+    void Transmit(uint32_t index);
+    void Receive(const BfdControlPacket &pkt, uint64_t nowNs);
+    uint32_t ReceiveBatch(uint64_t nowNs);
+    void FlushTx();
+
+public:
+    BfdEngine(uint32_t capacity, uint64_t tickNs, uint64_t nowNs);
+    ~BfdEngine();
+
+    // binds the UDP socket, port 0 picks a free one
+    bool Open(const char *addr, uint16_t port);
+    uint16_t GetPort() const;
+    bool SetPeer(const char *addr, uint16_t port);
+
+    void SetNotification(sai_bfd_session_state_change_notification_fn notify);
+
+    // RFC 5880 wants at least 1s while the session is not up
+    void SetSlowTxInterval(uint32_t us);
+
+    sai_status_t Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list, uint64_t nowNs);
+    sai_status_t Remove(uint32_t index);
+    sai_status_t Set(uint32_t index, const sai_attribute_t *attr, uint64_t nowNs);
+    sai_status_t Get(uint32_t index, uint32_t attr_count, sai_attribute_t *attr_list) const;
+    sai_status_t GetStats(uint32_t index,
+                          uint32_t number_of_counters,
+                          const sai_stat_id_t *counter_ids,
+                          sai_stats_mode_t mode,
+                          uint64_t *counters);
+
+    // packets received and sent in this call
+    uint32_t Poll(uint64_t nowNs);
+
+    // how late TX timers fired against their due time
+    BenchLatency GetTxLateness() const;
+    void ClearTxLateness();
+
+    uint32_t Size() const;
+    uint32_t UpCount() const;
+    uint64_t UnknownDrops() const;
+    uint64_t NotifyCalls() const;
+    const BfdSession* GetSession(uint32_t index) const;
+};
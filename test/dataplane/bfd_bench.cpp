@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <stdio.h>
+
+#include "bench_util.h"
+#include "bfd_bench.h"
+
+#define BFD_BENCH_LOCAL_ADDR        "127.0.0.1"
+#define BFD_BENCH_REMOTE_DISC_BASE  0x40000000
+
+#define BFD_PHASE_BRING_UP          0
+#define BFD_PHASE_STEADY            1
+#define BFD_PHASE_FAIL              2
+
+BfdProfile::BfdProfile()
+{
+    sessions = 1000;
+    txUs = 50000;
+    mult = 3;
+    seconds = 2;
+    tickUs = 0;
+    slowUs = 100000;
+}
+
+void BfdProfile::Parse(const std::string &profile)
+{
+    BenchProfileItems items = bench_profile_split(profile);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const std::string &key = items[i].first;
+        uint32_t value = bench_parse_uint(key, items[i].second);
+
+        if (key == "sessions")
+        {
+            sessions = value;
+        }
+        else if (key == "tx")
+        {
+            txUs = value;
+        }
+        else if (key == "mult")
+        {
+            mult = value;
+        }
+        else if (key == "seconds")
+        {
+            seconds = value;
+        }
+        else if (key == "tick")
+        {
+            tickUs = value;
+        }
+        else if (key == "slow")
+        {
+            slowUs = value;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown bfd profile key " + key);
+        }
+    }
+
+    if (sessions == 0 || txUs == 0 || mult == 0 || mult > 255 || slowUs == 0)
+    {
+        throw std::invalid_argument("sessions, tx, mult and slow must be non zero, mult at most 255");
+    }
+}
+
+uint32_t BfdProfile::TickUs() const
+{
+    if (tickUs)
+    {
+        return tickUs;
+    }
+
+    return std::min(1000u, std::max(50u, txUs / 16));
+}
+
+BfdBench::BfdBench(BfdEngine* local, BfdEngine* remote) :
+    m_local(local),
+    m_remote(remote)
+{
+}
+
+// the notification callbacks carry no context, so a single Run() at a time
+// keeps its state here
+static std::vector<uint64_t> s_downNs;
+static std::atomic<uint64_t> s_failNs;
+static std::atomic<bool> s_steady;
+static std::atomic<uint32_t> s_flaps;
+static uint64_t s_notifications;
+
+static void count_flaps(uint32_t count, const sai_bfd_session_state_notification_t *data)
+{
+    if (!s_steady.load())
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (data[i].session_state != SAI_BFD_SESSION_STATE_UP)
+        {
+            s_flaps++;
+        }
+    }
+}
+
+static void on_local_state_change(uint32_t count, const sai_bfd_session_state_notification_t *data)
+{
+    uint64_t failNs = s_failNs.load();
+
+    s_notifications += count;
+    count_flaps(count, data);
+
+    if (failNs == 0)
+    {
+        return;
+    }
+
+    uint64_t now = bench_now_ns();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t index = data[i].bfd_session_id;
+
+        if (data[i].session_state == SAI_BFD_SESSION_STATE_DOWN && index < s_downNs.size() && s_downNs[index] == 0)
+        {
+            s_downNs[index] = now;
+        }
+    }
+}
+
+static void on_remote_state_change(uint32_t count, const sai_bfd_session_state_notification_t *data)
+{
+    count_flaps(count, data);
+}
+
+// polls one engine every tick, phase changes are picked up between polls
+struct BfdWorker
+{
+    BfdEngine* engine;
+    uint64_t tickNs;
+    std::atomic<bool> stop;
+    std::atomic<bool> paused;
+    std::atomic<int> phase;
+    std::atomic<int> seen;
+
+    // steady phase
+    uint64_t cpuNs;
+    uint64_t handled;
+    BenchLatency lateness;
+
+    BfdWorker(BfdEngine* e, uint64_t tick) :
+        engine(e), tickNs(tick), stop(false), paused(false), phase(BFD_PHASE_BRING_UP), seen(BFD_PHASE_BRING_UP),
+        cpuNs(0), handled(0), lateness()
+    {
+    }
+
+    void Run()
+    {
+        uint64_t next = bench_now_ns();
+        uint64_t cpuNsNow = 0;
+        uint64_t handledNow = 0;
+        int current = BFD_PHASE_BRING_UP;
+
+        while (!stop.load())
+        {
+            int want = phase.load();
+
+            if (want != current)
+            {
+                if (want == BFD_PHASE_STEADY)
+                {
+                    engine->ClearTxLateness();
+                    cpuNsNow = 0;
+                    handledNow = 0;
+                }
+                else if (current == BFD_PHASE_STEADY)
+                {
+                    lateness = engine->GetTxLateness();
+                    cpuNs = cpuNsNow;
+                    handled = handledNow;
+                }
+
+                current = want;
+                seen.store(current);
+            }
+
+            if (!paused.load())
+            {
+                uint64_t cpu = bench_thread_cpu_ns();
+
+                handledNow += engine->Poll(bench_now_ns());
+                cpuNsNow += bench_thread_cpu_ns() - cpu;
+            }
+
+            // a late wakeup does not make up the lost ticks
+            next = std::max(next + tickNs, bench_now_ns());
+            bench_sleep_until(next);
+        }
+    }
+};
+
+static void set_phase(BfdWorker &a, BfdWorker &b, int phase)
+{
+    a.phase.store(phase);
+    b.phase.store(phase);
+
+    while (a.seen.load() != phase || b.seen.load() != phase)
+    {
+        std::this_thread::yield();
+    }
+}
+
+static bool wait_for(const BfdEngine *engine, uint32_t upCount, uint64_t timeoutNs)
+{
+    uint64_t deadline = bench_now_ns() + timeoutNs;
+
+    while (engine->UpCount() != upCount)
+    {
+        if (bench_now_ns() > deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+static sai_status_t create_session(BfdEngine *engine, uint32_t &index, sai_bfd_session_type_t type,
+                                   uint32_t localDiscriminator, uint32_t remoteDiscriminator,
+                                   const BfdProfile &profile)
+{
+    sai_attribute_t attrs[6];
+
+    attrs[0].id = SAI_BFD_SESSION_ATTR_TYPE;
+    attrs[0].value.s32 = type;
+    attrs[1].id = SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR;
+    attrs[1].value.u32 = localDiscriminator;
+    attrs[2].id = SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR;
+    attrs[2].value.u32 = remoteDiscriminator;
+    attrs[3].id = SAI_BFD_SESSION_ATTR_MIN_TX;
+    attrs[3].value.u32 = profile.txUs;
+    attrs[4].id = SAI_BFD_SESSION_ATTR_MIN_RX;
+    attrs[4].value.u32 = profile.txUs;
+    attrs[5].id = SAI_BFD_SESSION_ATTR_MULTIPLIER;
+    attrs[5].value.u8 = (uint8_t)profile.mult;
+
+    return engine->Create(index, 6, attrs, bench_now_ns());
+}
+
+bool BfdBench::Run(const BfdProfile &profile, BfdBenchResult &result)
+{
+    uint64_t tickNs = (uint64_t)profile.TickUs() * 1000;
+    uint64_t detectNs = (uint64_t)profile.mult * profile.txUs * 1000;
+
+    result = BfdBenchResult();
+    result.detectExpectedMs = (double)detectNs / 1e6;
+
+    if (!m_local->Open(BFD_BENCH_LOCAL_ADDR, 0) || !m_remote->Open(BFD_BENCH_LOCAL_ADDR, 0) ||
+        !m_local->SetPeer(BFD_BENCH_LOCAL_ADDR, m_remote->GetPort()) ||
+        !m_remote->SetPeer(BFD_BENCH_LOCAL_ADDR, m_local->GetPort()))
+    {
+        printf("failed to open bfd sockets on %s\n", BFD_BENCH_LOCAL_ADDR);
+        return false;
+    }
+
+    s_downNs.assign(profile.sessions, 0);
+    s_failNs.store(0);
+    s_steady.store(false);
+    s_flaps.store(0);
+    s_notifications = 0;
+
+    m_local->SetSlowTxInterval(profile.slowUs);
+    m_remote->SetSlowTxInterval(profile.slowUs);
+    m_local->SetNotification(on_local_state_change);
+    m_remote->SetNotification(on_remote_state_change);
+
+    // remote first, so the local packets find their sessions
+    for (uint32_t i = 0; i < profile.sessions; i++)
+    {
+        uint32_t index;
+
+        if (create_session(m_remote, index, SAI_BFD_SESSION_TYPE_ASYNC_PASSIVE,
+                           BFD_BENCH_REMOTE_DISC_BASE + i + 1, i + 1, profile) != SAI_STATUS_SUCCESS)
+        {
+            printf("failed to create remote bfd session %u\n", i);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < profile.sessions; i++)
+    {
+        uint32_t index;
+
+        if (create_session(m_local, index, SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE,
+                           i + 1, BFD_BENCH_REMOTE_DISC_BASE + i + 1, profile) != SAI_STATUS_SUCCESS)
+        {
+            printf("failed to create local bfd session %u\n", i);
+            return false;
+        }
+    }
+
+    BfdWorker local(m_local, tickNs);
+    BfdWorker remote(m_remote, tickNs);
+    std::thread localThread(&BfdWorker::Run, &local);
+    std::thread remoteThread(&BfdWorker::Run, &remote);
+    bool ok = true;
+
+    uint64_t start = bench_now_ns();
+
+    // the slow interval three ways (down, init, up) plus scheduling slack
+    if (!wait_for(m_local, profile.sessions, 4ULL * profile.slowUs * 1000 + 10ULL * 1000000000ULL) ||
+        !wait_for(m_remote, profile.sessions, 1000000000ULL))
+    {
+        printf("only %u local and %u remote of %u bfd sessions came up\n",
+               m_local->UpCount(), m_remote->UpCount(), profile.sessions);
+        ok = false;
+    }
+
+    result.bringUpSeconds = (double)(bench_now_ns() - start) / 1e9;
+
+    if (ok)
+    {
+        set_phase(local, remote, BFD_PHASE_STEADY);
+        s_steady.store(true);
+        start = bench_now_ns();
+
+        std::this_thread::sleep_for(std::chrono::seconds(profile.seconds));
+
+        s_steady.store(false);
+        set_phase(local, remote, BFD_PHASE_FAIL);
+        result.steadySeconds = (double)(bench_now_ns() - start) / 1e9;
+        result.flaps = s_flaps.load();
+
+        // the remote side goes silent, every local session has to time out
+        s_failNs.store(bench_now_ns());
+        remote.paused.store(true);
+
+        wait_for(m_local, 0, 2 * detectNs + 2000000000ULL);
+    }
+
+    local.stop.store(true);
+    remote.stop.store(true);
+    localThread.join();
+    remoteThread.join();
+
+    BfdWorker *workers[2] = { &local, &remote };
+
+    for (int w = 0; w < 2; w++)
+    {
+        double seconds = result.steadySeconds > 0 ? result.steadySeconds : 1;
+
+        result.cpuPercent[w] = (double)workers[w]->cpuNs / 1e9 / seconds * 100;
+        result.cpuPercentPer1k[w] = result.cpuPercent[w] * 1000 / profile.sessions;
+        result.packetsPerSecond[w] = (double)workers[w]->handled / seconds;
+        result.txLateness[w] = workers[w]->lateness;
+    }
+
+    uint64_t failNs = s_failNs.load();
+    double sumMs = 0;
+
+    for (uint32_t i = 0; i < profile.sessions && failNs; i++)
+    {
+        if (s_downNs[i] == 0)
+        {
+            continue;
+        }
+
+        double ms = (double)(s_downNs[i] - failNs) / 1e6;
+
+        result.detectMinMs = result.detected ? std::min(result.detectMinMs, ms) : ms;
+        result.detectMaxMs = std::max(result.detectMaxMs, ms);
+        result.detected++;
+        sumMs += ms;
+    }
+
+    result.detectMeanMs = result.detected ? sumMs / result.detected : 0;
+    result.notifyCalls = m_local->NotifyCalls();
+    result.notifications = s_notifications;
+
+    m_local->SetNotification(NULL);
+    m_remote->SetNotification(NULL);
+
+    return ok && result.flaps == 0 && result.detected == profile.sessions;
+}
+
+static void latency_json(std::stringstream &json, const BenchLatency &lat)
+{
+    json << "{\"count\": " << lat.count
+         << ", \"mean_us\": " << lat.meanUs
+         << ", \"p50_us\": " << lat.p50Us
+         << ", \"p99_us\": " << lat.p99Us
+         << ", \"p999_us\": " << lat.p999Us
+         << ", \"max_us\": " << lat.maxUs << "}";
+}
+
+std::string BfdBench::ToJson(const BfdProfile &profile, const BfdBenchResult &result)
+{
+    static const char *sides[2] = { "local", "remote" };
+    std::stringstream json;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"sessions\": " << profile.sessions
+         << ", \"tx_us\": " << profile.txUs
+         << ", \"mult\": " << profile.mult
+         << ", \"seconds\": " << profile.seconds
+         << ", \"tick_us\": " << profile.TickUs()
+         << ", \"slow_us\": " << profile.slowUs << "},\n";
+    json << "  \"bring_up_seconds\": " << result.bringUpSeconds << ",\n";
+    json << "  \"steady_seconds\": " << result.steadySeconds << ",\n";
+
+    for (int w = 0; w < 2; w++)
+    {
+        json << "  \"" << sides[w] << "\": {\"cpu_percent\": " << result.cpuPercent[w]
+             << ", \"cpu_percent_per_1k_sessions\": " << result.cpuPercentPer1k[w]
+             << ", \"packets_per_second\": " << result.packetsPerSecond[w]
+             << ", \"tx_lateness\": ";
+        latency_json(json, result.txLateness[w]);
+        json << "},\n";
+    }
+
+    json << "  \"flaps\": " << result.flaps << ",\n";
+    json << "  \"detect\": {\"expected_ms\": " << result.detectExpectedMs
+         << ", \"min_ms\": " << result.detectMinMs
+         << ", \"mean_ms\": " << result.detectMeanMs
+         << ", \"max_ms\": " << result.detectMaxMs
+         << ", \"sessions\": " << result.detected << "},\n";
+    json << "  \"notify_calls\": " << result.notifyCalls << ",\n";
+    json << "  \"notifications\": " << result.notifications << "\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void BfdBench::Show(const BfdBenchResult &result)
+{
+    static const char *sides[2] = { "local ", "remote" };
+
+    printf("\t--- --- --- --- --- --- --- BFD --- --- --- --- --- --- ---\n");
+    printf("\tbring up %.3f s, steady %.3f s, %u flaps\n", result.bringUpSeconds, result.steadySeconds, result.flaps);
+
+    for (int w = 0; w < 2; w++)
+    {
+        const BenchLatency &lat = result.txLateness[w];
+
+        printf("\t%s cpu %.2f%% (%.2f%% per 1k sessions), %.0f packets/s\n",
+               sides[w], result.cpuPercent[w], result.cpuPercentPer1k[w], result.packetsPerSecond[w]);
+        printf("\t%s tx lateness mean %.1f us, p50 %.0f us, p99 %.0f us, p99.9 %.0f us, max %.1f us\n",
+               sides[w], lat.meanUs, lat.p50Us, lat.p99Us, lat.p999Us, lat.maxUs);
+    }
+
+    printf("\tdetect %u sessions, expected %.1f ms, min %.1f ms, mean %.1f ms, max %.1f ms\n",
+           result.detected, result.detectExpectedMs, result.detectMinMs, result.detectMeanMs, result.detectMaxMs);
+    printf("\t%llu notifications in %llu calls\n",
+           (unsigned long long)result.notifications, (unsigned long long)result.notifyCalls);
+    printf("\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- ---\n");
+}
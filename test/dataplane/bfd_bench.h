@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "bfd.h"
+
+// BFD profile, parsed from "key=value,..." (see BfdProfile::Parse):
+//   sessions   sessions on each side, the local side is active and the
+//              remote one passive
+//   tx         SAI_BFD_SESSION_ATTR_MIN_TX and MIN_RX, microseconds
+//   mult       SAI_BFD_SESSION_ATTR_MULTIPLIER
+//   seconds    length of the steady phase
+//   tick       timer wheel tick and poll period, microseconds, 0 picks
+//              tx / 16 bounded to [50, 1000]
+//   slow       TX interval while a session is not up, microseconds
+struct BfdProfile
+{
+    uint32_t sessions;
+    uint32_t txUs;
+    uint32_t mult;
+    uint32_t seconds;
+    uint32_t tickUs;
+    uint32_t slowUs;
+
+    BfdProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+
+    uint32_t TickUs() const;
+};
+
+struct BfdBenchResult
+{
+    double bringUpSeconds;
+
+    // steady phase, per engine thread: local, remote
+    double steadySeconds;
+    double cpuPercent[2];
+    double cpuPercentPer1k[2];      // per 1000 sessions
+    double packetsPerSecond[2];     // received plus sent
+    BenchLatency txLateness[2];     // TX timer firing after its due time
+    uint32_t flaps;                 // sessions leaving up, should be 0
+
+    // remote side stops, local sessions time out
+    double detectExpectedMs;
+    double detectMinMs;
+    double detectMeanMs;
+    double detectMaxMs;
+    uint32_t detected;
+    uint64_t notifyCalls;           // local side, all phases
+    uint64_t notifications;
+};
+
+class BfdBench
+{
+    BfdEngine* m_local;
+    BfdEngine* m_remote;
+
+public:
+    // both engines need the profile's session count as capacity and its
+    // tick, Run() opens them on the loopback
+    BfdBench(BfdEngine* local, BfdEngine* remote);
+
+    // leaves the sessions in place
+    bool Run(const BfdProfile &profile, BfdBenchResult &result);
+
+    static std::string ToJson(const BfdProfile &profile, const BfdBenchResult &result);
+    static void Show(const BfdBenchResult &result);
+};
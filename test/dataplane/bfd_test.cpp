@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <map>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "bfd.h"
+#include "bfd_bench.h"
+
+#define NS_PER_MS           1000000ULL
+#define REMOTE_DISC_BASE    1000
+
+static std::vector<sai_bfd_session_state_notification_t> s_notified;
+static uint32_t s_notifyCalls;
+
+static void collect(uint32_t count, const sai_bfd_session_state_notification_t *data)
+{
+    s_notified.insert(s_notified.end(), data, data + count);
+    s_notifyCalls++;
+}
+
+static void fill_attrs(sai_attribute_t *attrs, sai_bfd_session_type_t type,
+                       uint32_t localDiscriminator, uint32_t remoteDiscriminator,
+                       uint32_t minTx, uint32_t minRx, uint8_t mult)
+{
+    attrs[0].id = SAI_BFD_SESSION_ATTR_TYPE;
+    attrs[0].value.s32 = type;
+    attrs[1].id = SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR;
+    attrs[1].value.u32 = localDiscriminator;
+    attrs[2].id = SAI_BFD_SESSION_ATTR_REMOTE_DISCRIMINATOR;
+    attrs[2].value.u32 = remoteDiscriminator;
+    attrs[3].id = SAI_BFD_SESSION_ATTR_MIN_TX;
+    attrs[3].value.u32 = minTx;
+    attrs[4].id = SAI_BFD_SESSION_ATTR_MIN_RX;
+    attrs[4].value.u32 = minRx;
+    attrs[5].id = SAI_BFD_SESSION_ATTR_MULTIPLIER;
+    attrs[5].value.u8 = mult;
+}
+
+static void connect(BfdEngine &a, BfdEngine &b)
+{
+    ASSERT_TRUE(a.Open("127.0.0.1", 0));
+    ASSERT_TRUE(b.Open("127.0.0.1", 0));
+    ASSERT_TRUE(a.SetPeer("127.0.0.1", b.GetPort()));
+    ASSERT_TRUE(b.SetPeer("127.0.0.1", a.GetPort()));
+}
+
+// simulated time, 1ms steps, loopback delivers within the step
+static void run(BfdEngine &a, BfdEngine *b, uint64_t &now, uint64_t untilNs)
+{
+    while (now < untilNs)
+    {
+        now += NS_PER_MS;
+        a.Poll(now);
+
+        if (b)
+        {
+            b->Poll(now);
+        }
+    }
+}
+
+static uint32_t get_u32(const BfdEngine &engine, uint32_t index, sai_attr_id_t id)
+{
+    sai_attribute_t attr;
+
+    attr.id = id;
+    attr.value.u32 = 0;
+    EXPECT_EQ(SAI_STATUS_SUCCESS, engine.Get(index, 1, &attr));
+
+    return attr.value.u32;
+}
+
+static int32_t get_s32(const BfdEngine &engine, uint32_t index, sai_attr_id_t id)
+{
+    sai_attribute_t attr;
+
+    attr.id = id;
+    attr.value.s32 = -1;
+    EXPECT_EQ(SAI_STATUS_SUCCESS, engine.Get(index, 1, &attr));
+
+    return attr.value.s32;
+}
+
+static uint8_t get_u8(const BfdEngine &engine, uint32_t index, sai_attr_id_t id)
+{
+    sai_attribute_t attr;
+
+    attr.id = id;
+    attr.value.u8 = 0xFF;
+    EXPECT_EQ(SAI_STATUS_SUCCESS, engine.Get(index, 1, &attr));
+
+    return attr.value.u8;
+}
+
+TEST(bfd, codec)
+{
+    BfdControlPacket pkt;
+    BfdControlPacket out;
+    uint8_t buf[64];
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.version = BFD_VERSION;
+    pkt.diag = BFD_DIAG_CONTROL_DETECTION_EXPIRED;
+    pkt.state = SAI_BFD_SESSION_STATE_INIT;
+    pkt.final = true;
+    pkt.cpi = true;
+    pkt.detectMult = 3;
+    pkt.myDiscriminator = 0x01020304;
+    pkt.yourDiscriminator = 0xA0B0C0D0;
+    pkt.desiredMinTx = 3300;
+    pkt.requiredMinRx = 50000;
+
+    ASSERT_EQ(0u, bfd_encode(pkt, buf, BFD_CONTROL_PACKET_LEN - 1));
+    ASSERT_EQ((size_t)BFD_CONTROL_PACKET_LEN, bfd_encode(pkt, buf, sizeof(buf)));
+
+    // RFC 5880 section 4.1 layout
+    ASSERT_EQ(0x21, buf[0]);
+    ASSERT_EQ(0x98, buf[1]);
+    ASSERT_EQ(3, buf[2]);
+    ASSERT_EQ(BFD_CONTROL_PACKET_LEN, buf[3]);
+    ASSERT_EQ(0x01, buf[4]);
+    ASSERT_EQ(0xD0, buf[11]);
+
+    ASSERT_TRUE(bfd_decode(buf, BFD_CONTROL_PACKET_LEN, out));
+    ASSERT_EQ(pkt.diag, out.diag);
+    ASSERT_EQ(pkt.state, out.state);
+    ASSERT_TRUE(out.final);
+    ASSERT_TRUE(out.cpi);
+    ASSERT_FALSE(out.poll);
+    ASSERT_EQ(pkt.myDiscriminator, out.myDiscriminator);
+    ASSERT_EQ(pkt.yourDiscriminator, out.yourDiscriminator);
+    ASSERT_EQ(pkt.desiredMinTx, out.desiredMinTx);
+    ASSERT_EQ(pkt.requiredMinRx, out.requiredMinRx);
+
+    // truncated
+    ASSERT_FALSE(bfd_decode(buf, BFD_CONTROL_PACKET_LEN - 1, out));
+
+    std::map<int, uint8_t> bad;
+
+    bad[0] = 0x41;              // version 2
+    bad[1] = 0x99;              // multipoint
+    bad[2] = 0;                 // zero multiplier
+    bad[3] = 20;                // length below the mandatory section
+
+    for (std::map<int, uint8_t>::const_iterator it = bad.begin(); it != bad.end(); ++it)
+    {
+        uint8_t copy[BFD_CONTROL_PACKET_LEN];
+
+        memcpy(copy, buf, sizeof(copy));
+        copy[it->first] = it->second;
+        ASSERT_FALSE(bfd_decode(copy, sizeof(copy), out)) << "byte " << it->first;
+    }
+
+    // authentication is not configured
+    pkt.auth = true;
+    bfd_encode(pkt, buf, sizeof(buf));
+    ASSERT_FALSE(bfd_decode(buf, BFD_CONTROL_PACKET_LEN, out));
+
+    // your discriminator may only be zero while down
+    pkt.auth = false;
+    pkt.yourDiscriminator = 0;
+    bfd_encode(pkt, buf, sizeof(buf));
+    ASSERT_FALSE(bfd_decode(buf, BFD_CONTROL_PACKET_LEN, out));
+
+    pkt.state = SAI_BFD_SESSION_STATE_DOWN;
+    bfd_encode(pkt, buf, sizeof(buf));
+    ASSERT_TRUE(bfd_decode(buf, BFD_CONTROL_PACKET_LEN, out));
+}
+
+TEST(bfd, attributes)
+{
+    BfdEngine engine(2, NS_PER_MS, 0);
+    sai_attribute_t attrs[7];
+    uint32_t index;
+
+    fill_attrs(attrs, SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE, 1, 2, 10000, 10000, 3);
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(index, 5, attrs, 0));
+
+    attrs[0].value.s32 = SAI_BFD_SESSION_TYPE_DEMAND_ACTIVE;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(index, 6, attrs, 0));
+    attrs[0].value.s32 = SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE;
+
+    attrs[5].value.u8 = 0;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 5, engine.Create(index, 6, attrs, 0));
+    attrs[5].value.u8 = 3;
+
+    attrs[6].id = SAI_BFD_SESSION_ATTR_ECHO_ENABLE;
+    attrs[6].value.booldata = true;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + 6, engine.Create(index, 7, attrs, 0));
+
+    attrs[6].id = SAI_BFD_SESSION_ATTR_STATE;
+    attrs[6].value.s32 = SAI_BFD_SESSION_STATE_UP;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0 + 6, engine.Create(index, 7, attrs, 0));
+
+    // addressing is accepted, the engine has its own socket
+    attrs[6].id = SAI_BFD_SESSION_ATTR_UDP_SRC_PORT;
+    attrs[6].value.u32 = 49152;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(index, 7, attrs, 0));
+    ASSERT_EQ(1u, engine.Size());
+
+    uint32_t other;
+
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.Create(other, 6, attrs, 0));
+
+    ASSERT_EQ(SAI_BFD_SESSION_STATE_DOWN, get_s32(engine, index, SAI_BFD_SESSION_ATTR_STATE));
+    ASSERT_EQ(10000u, get_u32(engine, index, SAI_BFD_SESSION_ATTR_MIN_TX));
+    ASSERT_EQ(3, get_u8(engine, index, SAI_BFD_SESSION_ATTR_MULTIPLIER));
+
+    sai_attribute_t attr;
+
+    attr.id = SAI_BFD_SESSION_ATTR_MIN_TX;
+    attr.value.u32 = 3300;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(index, &attr, 0));
+    ASSERT_EQ(3300u, get_u32(engine, index, SAI_BFD_SESSION_ATTR_MIN_TX));
+
+    attr.id = SAI_BFD_SESSION_ATTR_LOCAL_DISCRIMINATOR;
+    attr.value.u32 = 7;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(index, &attr, 0));
+
+    attr.id = SAI_BFD_SESSION_ATTR_NEGOTIATED_TX;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(index, &attr, 0));
+
+    sai_stat_id_t ids[] = { SAI_BFD_SESSION_STAT_IN_PACKETS, SAI_BFD_SESSION_STAT_OUT_PACKETS };
+    uint64_t stat[2];
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(index, 2, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_EQ(0u, stat[0]);
+    ASSERT_EQ(0u, stat[1]);
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(index));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(index));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Get(index, 1, &attr));
+    ASSERT_EQ(0u, engine.Size());
+}
+
+// two engines over the loopback: bring up, negotiation, detection timeout
+// and the peer signalling down on recovery
+TEST(bfd, session_lifecycle)
+{
+    const uint32_t sessions = 64;
+    BfdEngine a(sessions, NS_PER_MS, 0);
+    BfdEngine b(sessions, NS_PER_MS, 0);
+    std::vector<uint32_t> aIndex(sessions);
+    std::vector<uint32_t> bIndex(sessions);
+    sai_attribute_t attrs[6];
+    uint64_t now = 0;
+
+    connect(a, b);
+    a.SetSlowTxInterval(20000);
+    b.SetSlowTxInterval(20000);
+    s_notified.clear();
+    s_notifyCalls = 0;
+    a.SetNotification(collect);
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        // a wants 10ms, b asks for 30ms, so a sends every 30ms
+        fill_attrs(attrs, SAI_BFD_SESSION_TYPE_ASYNC_ACTIVE, i + 1, REMOTE_DISC_BASE + i, 10000, 10000, 3);
+        ASSERT_EQ(SAI_STATUS_SUCCESS, a.Create(aIndex[i], 6, attrs, now));
+
+        fill_attrs(attrs, SAI_BFD_SESSION_TYPE_ASYNC_PASSIVE, REMOTE_DISC_BASE + i, i + 1, 20000, 30000, 5);
+        ASSERT_EQ(SAI_STATUS_SUCCESS, b.Create(bIndex[i], 6, attrs, now));
+    }
+
+    run(a, &b, now, 200 * NS_PER_MS);
+
+    ASSERT_EQ(sessions, a.UpCount());
+    ASSERT_EQ(sessions, b.UpCount());
+    ASSERT_EQ(0u, a.UnknownDrops());
+    ASSERT_EQ(0u, b.UnknownDrops());
+
+    // the passive side went init, so a went straight up, the changes came
+    // in batches
+    ASSERT_EQ(sessions, s_notified.size());
+    ASSERT_LT(s_notifyCalls, s_notified.size());
+
+    std::vector<int> upSeen(sessions, 0);
+
+    for (size_t i = 0; i < s_notified.size(); i++)
+    {
+        ASSERT_LT(s_notified[i].bfd_session_id, sessions);
+
+        if (s_notified[i].session_state == SAI_BFD_SESSION_STATE_UP)
+        {
+            upSeen[s_notified[i].bfd_session_id]++;
+        }
+    }
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(1, upSeen[aIndex[i]]);
+    }
+
+    uint32_t s = aIndex[7];
+
+    ASSERT_EQ(SAI_BFD_SESSION_STATE_UP, get_s32(a, s, SAI_BFD_SESSION_ATTR_STATE));
+    ASSERT_EQ(20000u, get_u32(a, s, SAI_BFD_SESSION_ATTR_REMOTE_MIN_TX));
+    ASSERT_EQ(30000u, get_u32(a, s, SAI_BFD_SESSION_ATTR_REMOTE_MIN_RX));
+    ASSERT_EQ(30000u, get_u32(a, s, SAI_BFD_SESSION_ATTR_NEGOTIATED_TX));
+    ASSERT_EQ(20000u, get_u32(a, s, SAI_BFD_SESSION_ATTR_NEGOTIATED_RX));
+    ASSERT_EQ(5, get_u8(a, s, SAI_BFD_SESSION_ATTR_REMOTE_MULTIPLIER));
+
+    // steady state keeps the negotiated rate, jitter only makes it faster
+    sai_stat_id_t ids[] = { SAI_BFD_SESSION_STAT_OUT_PACKETS, SAI_BFD_SESSION_STAT_IN_PACKETS };
+    uint64_t stat[2];
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, a.GetStats(s, 2, ids, SAI_STATS_MODE_READ_AND_CLEAR, stat));
+    run(a, &b, now, now + 3000 * NS_PER_MS);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, a.GetStats(s, 2, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_GE(stat[0], 100u);
+    ASSERT_LE(stat[0], 134u);
+    ASSERT_GE(stat[1], 150u);
+    ASSERT_LE(stat[1], 200u);
+    ASSERT_EQ(sessions, a.UpCount());
+
+    BenchLatency lateness = a.GetTxLateness();
+
+    ASSERT_GT(lateness.count, 0u);
+    ASSERT_LE(lateness.maxUs, 1000.0);
+
+    // b goes silent, a detects within 5 * 20ms of the last packet
+    s_notified.clear();
+    uint64_t silent = now;
+
+    while (a.UpCount() && now < silent + 200 * NS_PER_MS)
+    {
+        run(a, NULL, now, now + NS_PER_MS);
+
+        for (size_t i = 0; i < s_notified.size(); i++)
+        {
+            ASSERT_EQ(SAI_BFD_SESSION_STATE_DOWN, s_notified[i].session_state);
+        }
+    }
+
+    ASSERT_EQ(0u, a.UpCount());
+    ASSERT_EQ(sessions, s_notified.size());
+    ASSERT_GE(now - silent, 100 * NS_PER_MS - 20 * NS_PER_MS);
+    ASSERT_LE(now - silent, 100 * NS_PER_MS + NS_PER_MS);
+    ASSERT_EQ(BFD_DIAG_CONTROL_DETECTION_EXPIRED, get_u8(a, s, SAI_BFD_SESSION_ATTR_LOCAL_DIAG));
+
+    // b wakes up to a's down packets (one TX interval later) before its
+    // own timers fire
+    run(a, NULL, now, now + 40 * NS_PER_MS);
+    run(a, &b, now, now + NS_PER_MS);
+    ASSERT_EQ(0u, b.UpCount());
+    ASSERT_EQ(BFD_DIAG_NEIGHBOR_SIGNALED_DOWN, get_u8(b, bIndex[7], SAI_BFD_SESSION_ATTR_LOCAL_DIAG));
+    ASSERT_EQ(BFD_DIAG_CONTROL_DETECTION_EXPIRED, get_u8(b, bIndex[7], SAI_BFD_SESSION_ATTR_REMOTE_DIAG));
+
+    run(a, &b, now, now + 200 * NS_PER_MS);
+    ASSERT_EQ(sessions, a.UpCount());
+    ASSERT_EQ(sessions, b.UpCount());
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(SAI_STATUS_SUCCESS, a.Remove(aIndex[i]));
+    }
+
+    ASSERT_EQ(0u, a.UpCount());
+
+    // b hears nothing from the removed sessions
+    run(a, &b, now, now + 200 * NS_PER_MS);
+    ASSERT_EQ(0u, b.UpCount());
+}
+
+// profile from DATAPLANE_BFD_BENCH ("sessions=..,tx=..,seconds=.."), the
+// JSON report goes to DATAPLANE_BFD_BENCH_JSON when it is set
+TEST(bfd, bench)
+{
+    BfdProfile profile;
+    BfdBenchResult result;
+    const char *env = getenv("DATAPLANE_BFD_BENCH");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    uint64_t tickNs = (uint64_t)profile.TickUs() * 1000;
+    BfdEngine local(profile.sessions, tickNs, bench_now_ns());
+    BfdEngine remote(profile.sessions, tickNs, bench_now_ns());
+    BfdBench bench(&local, &remote);
+
+    bool ok = bench.Run(profile, result);
+    BfdBench::Show(result);
+
+    std::string json = BfdBench::ToJson(profile, result);
+    const char *jsonPath = getenv("DATAPLANE_BFD_BENCH_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(profile.sessions, local.Size());
+}
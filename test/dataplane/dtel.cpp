@@ -0,0 +1,1360 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "dtel.h"
+
+#define DTEL_TX_REPORTS             256         // pending per destination
+#define DTEL_GSO_MAX_SEGMENTS       64
+#define DTEL_GSO_MAX_BYTES          65000       // below the IPv4 UDP payload limit
+#define DTEL_CONTROL_LEN            64
+#define DTEL_PREFETCH               16          // observations hashed ahead
+#define DTEL_SOCKET_BUFFER          (4 * 1024 * 1024)
+
+#define NS_PER_SEC                  1000000000ULL
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                 103
+#endif
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    v = htons(v);
+    memcpy(p, &v, 2);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    uint16_t v;
+
+    memcpy(&v, p, 2);
+
+    return ntohs(v);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+
+    return ntohl(v);
+}
+
+static uint16_t ip_checksum(const uint8_t *p, size_t len)
+{
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i < len; i += 2)
+    {
+        sum += get16(p + i);
+    }
+
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return (uint16_t)~sum;
+}
+
+size_t dtel_report_encode(const DtelReport &report, uint8_t *buf)
+{
+    uint8_t *p = buf;
+    uint8_t packet[DTEL_PACKET_LEN];
+
+    p[0] = (uint8_t)(DTEL_REPORT_VERSION << 4 | (report.nextProto & 0xF));
+    p[1] = report.flags & (DTEL_REPORT_DROP | DTEL_REPORT_QUEUE | DTEL_REPORT_FLOW);
+    p[2] = report.hwId & 0x3F;
+    p[3] = 0;
+    put32(p + 4, report.sequence);
+    put32(p + 8, report.ingressTimestamp);
+    p += DTEL_REPORT_HEADER_LEN;
+
+    put32(p, report.switchId);
+    put16(p + 4, report.ingressPort);
+    put16(p + 6, report.egressPort);
+
+    if (report.nextProto == DTEL_NEXT_PROTO_DROP)
+    {
+        p[8] = report.queue;
+        p[9] = report.dropReason;
+        put16(p + 10, 0);
+        put32(p + 12, 0);
+    }
+    else
+    {
+        put32(p + 8, (uint32_t)report.queue << 24 | std::min<uint32_t>(report.queueOccupancy,
+                                                                        DTEL_QUEUE_OCCUPANCY_MAX));
+        put32(p + 12, report.egressTimestamp);
+    }
+
+    p += DTEL_LOCAL_HEADER_LEN;
+
+    // the head is built whole, truncation only cuts it
+    uint8_t *ip = packet + 14;
+    uint8_t *l4 = ip + 20;
+
+    memset(packet, 0, sizeof(packet));
+    put16(packet + 12, 0x0800);
+    ip[0] = 0x45;
+    put16(ip + 2, 28);
+    ip[8] = 64;
+    ip[9] = report.protocol;
+    put32(ip + 12, report.srcIp);
+    put32(ip + 16, report.dstIp);
+    put16(ip + 10, ip_checksum(ip, 20));
+    put16(l4, report.srcPort);
+    put16(l4 + 2, report.dstPort);
+
+    size_t packetLen = std::min<size_t>(report.packetLen, DTEL_PACKET_LEN);
+
+    memcpy(p, packet, packetLen);
+
+    return DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN + packetLen;
+}
+
+bool dtel_report_decode(const uint8_t *buf, size_t len, DtelReport &report)
+{
+    if (len < DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN || len > DTEL_REPORT_MAX_LEN ||
+        buf[0] >> 4 != DTEL_REPORT_VERSION)
+    {
+        return false;
+    }
+
+    const uint8_t *p = buf + DTEL_REPORT_HEADER_LEN;
+
+    report = DtelReport();
+    report.nextProto = buf[0] & 0xF;
+    report.flags = buf[1] & (DTEL_REPORT_DROP | DTEL_REPORT_QUEUE | DTEL_REPORT_FLOW);
+    report.hwId = buf[2] & 0x3F;
+    report.sequence = get32(buf + 4);
+    report.ingressTimestamp = get32(buf + 8);
+    report.switchId = get32(p);
+    report.ingressPort = get16(p + 4);
+    report.egressPort = get16(p + 6);
+    report.queue = p[8];
+
+    if (report.nextProto == DTEL_NEXT_PROTO_DROP)
+    {
+        report.dropReason = p[9];
+    }
+    else if (report.nextProto == DTEL_NEXT_PROTO_SWITCH_LOCAL)
+    {
+        report.queueOccupancy = get32(p + 8) & DTEL_QUEUE_OCCUPANCY_MAX;
+        report.egressTimestamp = get32(p + 12);
+    }
+    else
+    {
+        return false;
+    }
+
+    p += DTEL_LOCAL_HEADER_LEN;
+    report.packetLen = (uint16_t)(len - DTEL_REPORT_HEADER_LEN - DTEL_LOCAL_HEADER_LEN);
+
+    if (report.packetLen == DTEL_PACKET_LEN && get16(p + 12) == 0x0800)
+    {
+        const uint8_t *ip = p + 14;
+
+        report.protocol = ip[9];
+        report.srcIp = get32(ip + 12);
+        report.dstIp = get32(ip + 16);
+        report.srcPort = get16(ip + 20);
+        report.dstPort = get16(ip + 22);
+    }
+
+    return true;
+}
+
+static uint64_t mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+static uint64_t flow_hash(const DtelObservation &obs)
+{
+    uint64_t addrs = (uint64_t)obs.srcIp << 32 | obs.dstIp;
+    uint64_t ports = (uint64_t)obs.srcPort << 24 | (uint64_t)obs.dstPort << 8 | obs.protocol;
+
+    return mix64(addrs ^ mix64(ports));
+}
+
+DtelFlowStateTable::DtelFlowStateTable(uint32_t capacity) :
+    m_epoch(1)
+{
+    uint64_t entries = 2;
+
+    while (entries < capacity)
+    {
+        entries <<= 1;
+    }
+
+    m_entries.resize(entries);
+    memset(m_entries.data(), 0, entries * sizeof(Entry));
+    m_mask = entries / 2 - 1;
+}
+
+bool DtelFlowStateTable::Update(uint64_t hash, uint32_t state)
+{
+    Entry *bucket = &m_entries[(hash & m_mask) * 2];
+    uint32_t signature = (uint32_t)(hash >> 32);
+
+    for (int way = 0; way < 2; way++)
+    {
+        Entry &entry = bucket[way];
+
+        if (entry.epoch == m_epoch && entry.signature == signature)
+        {
+            if (entry.state == state)
+            {
+                return false;
+            }
+
+            entry.state = state;
+            return true;
+        }
+    }
+
+    // the newest flow takes the first way, the older one moves over
+    if (bucket[0].epoch == m_epoch)
+    {
+        bucket[1] = bucket[0];
+    }
+
+    bucket[0].signature = signature;
+    bucket[0].state = state;
+    bucket[0].epoch = m_epoch;
+
+    return true;
+}
+
+void DtelFlowStateTable::Prefetch(uint64_t hash) const
+{
+    __builtin_prefetch(&m_entries[(hash & m_mask) * 2]);
+}
+
+void DtelFlowStateTable::Clear()
+{
+    if (++m_epoch == 0)
+    {
+        memset(m_entries.data(), 0, m_entries.size() * sizeof(Entry));
+        m_epoch = 1;
+    }
+}
+
+uint32_t DtelFlowStateTable::Capacity() const
+{
+    return (uint32_t)m_entries.size();
+}
+
+// first unused slot, the tables only hold a handful of objects
+template <typename T>
+static uint32_t alloc_slot(std::vector<T> &table)
+{
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        if (!table[i].used)
+        {
+            return i;
+        }
+    }
+
+    table.push_back(T());
+
+    return (uint32_t)table.size() - 1;
+}
+
+template <typename T>
+static bool find_slot(const std::vector<T> &table, sai_object_type_t type, sai_object_id_t oid, uint32_t &index)
+{
+    if (dtel_oid_type(oid) != type)
+    {
+        return false;
+    }
+
+    index = dtel_oid_index(oid);
+
+    return index < table.size() && table[index].used;
+}
+
+DtelEngine::DtelEngine(uint32_t flowStateCapacity) :
+    m_fd(-1),
+    m_gso(false),
+    m_dtel(),
+    m_flowState(flowStateCapacity),
+    m_dropState(flowStateCapacity),
+    m_clearCycleNs(0),
+    m_nextClearNs(UINT64_MAX),
+    m_txControl(DTEL_TX_REPORTS * DTEL_CONTROL_LEN),
+    m_counters()
+{
+    memset(m_events, 0, sizeof(m_events));
+}
+
+DtelEngine::~DtelEngine()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+bool DtelEngine::Open(const char *addr, uint16_t port)
+{
+    struct sockaddr_in sin;
+    int size = DTEL_SOCKET_BUFFER;
+    int off = 0;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1)
+    {
+        return false;
+    }
+
+    m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    // best effort, capped by net.core.wmem_max
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    m_gso = setsockopt(m_fd, SOL_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0;
+
+    if (bind(m_fd, (struct sockaddr*)&sin, sizeof(sin)) < 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+sai_status_t DtelEngine::AddQueue(sai_object_id_t queueId, uint16_t port, uint8_t queue)
+{
+    if (queueId == SAI_NULL_OBJECT_ID || queue >= DTEL_QUEUES_PER_PORT)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (m_queues.find(queueId) != m_queues.end())
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    uint32_t slot = (uint32_t)port * DTEL_QUEUES_PER_PORT + queue;
+
+    for (std::unordered_map<sai_object_id_t, uint32_t>::const_iterator it = m_queues.begin();
+         it != m_queues.end(); ++it)
+    {
+        if (it->second == slot)
+        {
+            return SAI_STATUS_ITEM_ALREADY_EXISTS;
+        }
+    }
+
+    m_queues[queueId] = slot;
+
+    if (m_queueSlots.size() <= slot)
+    {
+        m_queueSlots.resize(slot + 1, 0);
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::ParseDtel(DtelConfig &dtel, uint32_t attr_count, const sai_attribute_t *attr_list) const
+{
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_DTEL_ATTR_INT_ENDPOINT_ENABLE:
+                dtel.intEndpoint = attr.value.booldata;
+                break;
+
+            case SAI_DTEL_ATTR_INT_TRANSIT_ENABLE:
+                dtel.intTransit = attr.value.booldata;
+                break;
+
+            case SAI_DTEL_ATTR_POSTCARD_ENABLE:
+                dtel.postcard = attr.value.booldata;
+                break;
+
+            case SAI_DTEL_ATTR_DROP_REPORT_ENABLE:
+                dtel.dropReport = attr.value.booldata;
+                break;
+
+            case SAI_DTEL_ATTR_QUEUE_REPORT_ENABLE:
+                dtel.queueReport = attr.value.booldata;
+                break;
+
+            case SAI_DTEL_ATTR_SWITCH_ID:
+                dtel.switchId = attr.value.u32;
+                break;
+
+            case SAI_DTEL_ATTR_FLOW_STATE_CLEAR_CYCLE:
+                dtel.flowStateClearCycle = attr.value.u16;
+                break;
+
+            case SAI_DTEL_ATTR_LATENCY_SENSITIVITY:
+                // latencies are 32 bit nanoseconds
+                if (attr.value.u8 > 31)
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                dtel.latencySensitivity = attr.value.u8;
+                break;
+
+            case SAI_DTEL_ATTR_SINK_PORT_LIST:
+                if (attr.value.objlist.count && attr.value.objlist.list == NULL)
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                break;
+
+            case SAI_DTEL_ATTR_INT_L4_DSCP:
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::ParseQueueReport(DtelQueueReport &report,
+                                          bool create,
+                                          uint32_t attr_count,
+                                          const sai_attribute_t *attr_list) const
+{
+    bool queue = false;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_DTEL_QUEUE_REPORT_ATTR_QUEUE_ID:
+            {
+                if (!create)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+
+                std::unordered_map<sai_object_id_t, uint32_t>::const_iterator it = m_queues.find(attr.value.oid);
+
+                if (it == m_queues.end())
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+
+                report.queueId = attr.value.oid;
+                report.slot = it->second;
+                queue = true;
+                break;
+            }
+
+            case SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD:
+                report.depthThreshold = attr.value.u32;
+                break;
+
+            case SAI_DTEL_QUEUE_REPORT_ATTR_LATENCY_THRESHOLD:
+                report.latencyThreshold = attr.value.u32;
+                break;
+
+            case SAI_DTEL_QUEUE_REPORT_ATTR_BREACH_QUOTA:
+                report.breachQuota = attr.value.u32;
+                break;
+
+            case SAI_DTEL_QUEUE_REPORT_ATTR_TAIL_DROP:
+                report.tailDrop = attr.value.booldata;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return queue || !create ? SAI_STATUS_SUCCESS : SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+}
+
+sai_status_t DtelEngine::ParseReportSession(DtelReportSession &session,
+                                            uint32_t attr_count,
+                                            const sai_attribute_t *attr_list) const
+{
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_DTEL_REPORT_SESSION_ATTR_SRC_IP:
+                if (attr.value.ipaddr.addr_family == SAI_IP_ADDR_FAMILY_IPV6)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                if (attr.value.ipaddr.addr_family != SAI_IP_ADDR_FAMILY_IPV4)
+                {
+                    return badValue;
+                }
+                session.srcIp = attr.value.ipaddr.addr.ip4;
+                break;
+
+            case SAI_DTEL_REPORT_SESSION_ATTR_DST_IP_LIST:
+            {
+                const sai_ip_address_list_t &list = attr.value.ipaddrlist;
+
+                if (list.count && list.list == NULL)
+                {
+                    return badValue;
+                }
+
+                session.destinations.resize(list.count);
+
+                for (uint32_t j = 0; j < list.count; j++)
+                {
+                    DtelDestination &destination = session.destinations[j];
+
+                    if (list.list[j].addr_family == SAI_IP_ADDR_FAMILY_IPV6)
+                    {
+                        return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                    }
+                    if (list.list[j].addr_family != SAI_IP_ADDR_FAMILY_IPV4)
+                    {
+                        return badValue;
+                    }
+
+                    memset(&destination.dst, 0, sizeof(destination.dst));
+                    destination.dst.sin_family = AF_INET;
+                    destination.dst.sin_addr.s_addr = list.list[j].addr.ip4;
+                    destination.sequence = 0;
+                    destination.pending = 0;
+                }
+                break;
+            }
+
+            case SAI_DTEL_REPORT_SESSION_ATTR_VIRTUAL_ROUTER_ID:
+                break;
+
+            case SAI_DTEL_REPORT_SESSION_ATTR_TRUNCATE_SIZE:
+                session.truncateSize = attr.value.u16;
+                break;
+
+            case SAI_DTEL_REPORT_SESSION_ATTR_UDP_DST_PORT:
+                session.udpDstPort = attr.value.u16;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    uint16_t packetLen = session.truncateSize ? std::min<uint16_t>(session.truncateSize, DTEL_PACKET_LEN)
+                                              : DTEL_PACKET_LEN;
+
+    session.reportLen = DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN + packetLen;
+
+    for (size_t j = 0; j < session.destinations.size(); j++)
+    {
+        DtelDestination &destination = session.destinations[j];
+
+        destination.dst.sin_port = htons(session.udpDstPort);
+        destination.buf.resize(DTEL_TX_REPORTS * DTEL_REPORT_MAX_LEN);
+        destination.tos.resize(DTEL_TX_REPORTS);
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::ParseEvent(DtelEvent &event,
+                                    int &type,
+                                    bool create,
+                                    uint32_t attr_count,
+                                    const sai_attribute_t *attr_list) const
+{
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_DTEL_EVENT_ATTR_TYPE:
+                if (!create)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                if (attr.value.s32 < SAI_DTEL_EVENT_TYPE_FLOW_STATE || attr.value.s32 >= SAI_DTEL_EVENT_TYPE_MAX)
+                {
+                    return badValue;
+                }
+                type = attr.value.s32;
+                break;
+
+            case SAI_DTEL_EVENT_ATTR_REPORT_SESSION:
+                event.hasSession = attr.value.oid != SAI_NULL_OBJECT_ID;
+
+                if (event.hasSession &&
+                    !find_slot(m_sessions, SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, attr.value.oid, event.session))
+                {
+                    return badValue;
+                }
+                break;
+
+            case SAI_DTEL_EVENT_ATTR_DSCP_VALUE:
+                if (attr.value.u8 > 63)
+                {
+                    return badValue;
+                }
+                event.dscp = attr.value.u8;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return type >= 0 || !create ? SAI_STATUS_SUCCESS : SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+}
+
+sai_status_t DtelEngine::ParseIntSession(DtelIntSession &session,
+                                         uint32_t attr_count,
+                                         const sai_attribute_t *attr_list) const
+{
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_DTEL_INT_SESSION_ATTR_MAX_HOP_COUNT:
+                session.maxHopCount = attr.value.u8;
+                break;
+
+            default:
+                // the COLLECT_* selections shape INT headers
+                if (attr.id >= SAI_DTEL_INT_SESSION_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void DtelEngine::SetClearCycle(uint16_t seconds)
+{
+    m_clearCycleNs = (uint64_t)seconds * NS_PER_SEC;
+    m_nextClearNs = seconds ? 0 : UINT64_MAX;
+}
+
+sai_status_t DtelEngine::CreateQueueReport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    DtelQueueReport report = DtelQueueReport();
+    sai_status_t status = ParseQueueReport(report, true, attr_count, attr_list);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (m_queueSlots[report.slot])
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    index = alloc_slot(m_queueReports);
+    m_queueReports[index] = report;
+    m_queueReports[index].used = true;
+    m_queueSlots[report.slot] = index + 1;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::CreateReportSession(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    DtelReportSession session = DtelReportSession();
+    sai_status_t status = ParseReportSession(session, attr_count, attr_list);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    index = alloc_slot(m_sessions);
+    m_sessions[index] = session;
+    m_sessions[index].used = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::CreateEvent(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    DtelEvent event = DtelEvent();
+    int type = -1;
+    sai_status_t status = ParseEvent(event, type, true, attr_count, attr_list);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    // the event type is the index
+    if (m_events[type].used)
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    if (event.hasSession)
+    {
+        m_sessions[event.session].refs++;
+    }
+
+    index = (uint32_t)type;
+    m_events[type] = event;
+    m_events[type].used = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::Create(sai_object_type_t type,
+                                sai_object_id_t &oid,
+                                uint32_t attr_count,
+                                const sai_attribute_t *attr_list)
+{
+    uint32_t index = 0;
+    sai_status_t status;
+
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    switch (type)
+    {
+        case SAI_OBJECT_TYPE_DTEL:
+        {
+            DtelConfig dtel = DtelConfig();
+
+            if (m_dtel.used)
+            {
+                return SAI_STATUS_ITEM_ALREADY_EXISTS;
+            }
+
+            status = ParseDtel(dtel, attr_count, attr_list);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                m_dtel = dtel;
+                m_dtel.used = true;
+                SetClearCycle(m_dtel.flowStateClearCycle);
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT:
+            status = CreateQueueReport(index, attr_count, attr_list);
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_INT_SESSION:
+        {
+            DtelIntSession session = DtelIntSession();
+
+            session.maxHopCount = 8;
+            status = ParseIntSession(session, attr_count, attr_list);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                index = alloc_slot(m_intSessions);
+                m_intSessions[index] = session;
+                m_intSessions[index].used = true;
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_REPORT_SESSION:
+            status = CreateReportSession(index, attr_count, attr_list);
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_EVENT:
+            status = CreateEvent(index, attr_count, attr_list);
+            break;
+
+        default:
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+    }
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        oid = dtel_oid(type, index);
+    }
+
+    return status;
+}
+
+sai_status_t DtelEngine::Remove(sai_object_id_t oid)
+{
+    uint32_t index;
+
+    switch (dtel_oid_type(oid))
+    {
+        case SAI_OBJECT_TYPE_DTEL:
+            if (!m_dtel.used || dtel_oid_index(oid) != 0)
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            m_dtel = DtelConfig();
+            SetClearCycle(0);
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT:
+            if (!find_slot(m_queueReports, SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            m_queueSlots[m_queueReports[index].slot] = 0;
+            m_queueReports[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_INT_SESSION:
+            if (!find_slot(m_intSessions, SAI_OBJECT_TYPE_DTEL_INT_SESSION, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            m_intSessions[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_REPORT_SESSION:
+            if (!find_slot(m_sessions, SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_sessions[index].refs)
+            {
+                return SAI_STATUS_OBJECT_IN_USE;
+            }
+            m_sessions[index] = DtelReportSession();
+            break;
+
+        case SAI_OBJECT_TYPE_DTEL_EVENT:
+            index = dtel_oid_index(oid);
+
+            if (index >= SAI_DTEL_EVENT_TYPE_MAX || !m_events[index].used)
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_events[index].hasSession)
+            {
+                m_sessions[m_events[index].session].refs--;
+            }
+            m_events[index] = DtelEvent();
+            break;
+
+        default:
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t DtelEngine::Set(sai_object_id_t oid, const sai_attribute_t *attr)
+{
+    uint32_t index;
+    sai_status_t status;
+
+    if (attr == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    // parsed into a copy, a bad value changes nothing
+    switch (dtel_oid_type(oid))
+    {
+        case SAI_OBJECT_TYPE_DTEL:
+        {
+            if (!m_dtel.used || dtel_oid_index(oid) != 0)
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            DtelConfig dtel = m_dtel;
+
+            status = ParseDtel(dtel, 1, attr);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                if (dtel.flowStateClearCycle != m_dtel.flowStateClearCycle)
+                {
+                    SetClearCycle(dtel.flowStateClearCycle);
+                }
+                m_dtel = dtel;
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT:
+        {
+            if (!find_slot(m_queueReports, SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            DtelQueueReport report = m_queueReports[index];
+
+            status = ParseQueueReport(report, false, 1, attr);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                m_queueReports[index] = report;
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_INT_SESSION:
+        {
+            if (!find_slot(m_intSessions, SAI_OBJECT_TYPE_DTEL_INT_SESSION, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            DtelIntSession session = m_intSessions[index];
+
+            status = ParseIntSession(session, 1, attr);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                m_intSessions[index] = session;
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_REPORT_SESSION:
+        {
+            if (!find_slot(m_sessions, SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            DtelReportSession session = m_sessions[index];
+
+            status = ParseReportSession(session, 1, attr);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                m_sessions[index] = session;
+            }
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_DTEL_EVENT:
+        {
+            int type = -1;
+
+            index = dtel_oid_index(oid);
+
+            if (index >= SAI_DTEL_EVENT_TYPE_MAX || !m_events[index].used)
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            DtelEvent event = m_events[index];
+
+            status = ParseEvent(event, type, false, 1, attr);
+
+            if (status == SAI_STATUS_SUCCESS)
+            {
+                if (m_events[index].hasSession)
+                {
+                    m_sessions[m_events[index].session].refs--;
+                }
+                if (event.hasSession)
+                {
+                    m_sessions[event.session].refs++;
+                }
+                m_events[index] = event;
+            }
+            break;
+        }
+
+        default:
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+    }
+
+    return status;
+}
+
+static socklen_t put_tx_control(uint8_t *control, int tos, uint16_t segment)
+{
+    struct cmsghdr *cmsg = (struct cmsghdr*)control;
+
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_TOS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &tos, sizeof(int));
+
+    if (segment == 0)
+    {
+        return (socklen_t)CMSG_SPACE(sizeof(int));
+    }
+
+    cmsg = (struct cmsghdr*)(control + CMSG_SPACE(sizeof(int)));
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(uint16_t));
+
+    return (socklen_t)(CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint16_t)));
+}
+
+// a destination's reports all have the session's length and sit back to
+// back, so a run with the same DSCP is a single iovec and, with GSO, a
+// single send
+void DtelEngine::Send(DtelDestination &destination, uint16_t reportLen)
+{
+    struct mmsghdr msgs[DTEL_TX_REPORTS];
+    struct iovec iov[DTEL_TX_REPORTS];
+    uint32_t segments[DTEL_TX_REPORTS];
+    uint32_t count = 0;
+
+    if (m_fd < 0)
+    {
+        destination.pending = 0;
+        return;
+    }
+
+    for (uint32_t r = 0; r < destination.pending; count++)
+    {
+        uint8_t tos = destination.tos[r];
+        uint32_t run = 1;
+
+        while (m_gso && r + run < destination.pending && destination.tos[r + run] == tos &&
+               run < DTEL_GSO_MAX_SEGMENTS && (run + 1) * reportLen <= DTEL_GSO_MAX_BYTES)
+        {
+            run++;
+        }
+
+        struct msghdr &msg = msgs[count].msg_hdr;
+
+        iov[count].iov_base = &destination.buf[(size_t)r * reportLen];
+        iov[count].iov_len = (size_t)run * reportLen;
+        memset(&msgs[count], 0, sizeof(msgs[count]));
+        msg.msg_name = &destination.dst;
+        msg.msg_namelen = sizeof(struct sockaddr_in);
+        msg.msg_iov = &iov[count];
+        msg.msg_iovlen = 1;
+        msg.msg_control = &m_txControl[count * DTEL_CONTROL_LEN];
+        msg.msg_controllen = put_tx_control((uint8_t*)msg.msg_control, tos, (uint16_t)(run > 1 ? reportLen : 0));
+        segments[count] = run;
+        r += run;
+    }
+
+    uint32_t sent = 0;
+
+    while (sent < count)
+    {
+        int n = sendmmsg(m_fd, &msgs[sent], count - sent, 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        sent += (uint32_t)n;
+    }
+
+    // a full socket buffer loses the rest of the batch
+    for (uint32_t i = 0; i < count; i++)
+    {
+        (i < sent ? m_counters.datagrams : m_counters.sendDrops) += segments[i];
+    }
+
+    destination.pending = 0;
+}
+
+void DtelEngine::Emit(const DtelObservation &obs, uint64_t hash, uint8_t flags, sai_dtel_event_type_t type)
+{
+    const DtelEvent &event = m_events[type];
+
+    m_counters.reports++;
+    m_counters.flowReports += (flags & DTEL_REPORT_FLOW) != 0;
+    m_counters.queueReports += (flags & DTEL_REPORT_QUEUE) != 0;
+    m_counters.dropReports += (flags & DTEL_REPORT_DROP) != 0;
+
+    if (!event.hasSession || m_sessions[event.session].destinations.empty() ||
+        m_sessions[event.session].udpDstPort == 0)
+    {
+        m_counters.unrouted++;
+        return;
+    }
+
+    DtelReportSession &session = m_sessions[event.session];
+    DtelDestination &destination = session.destinations[hash % session.destinations.size()];
+    DtelReport report;
+
+    report.nextProto = flags & DTEL_REPORT_DROP ? DTEL_NEXT_PROTO_DROP : DTEL_NEXT_PROTO_SWITCH_LOCAL;
+    report.flags = flags;
+    report.hwId = 0;
+    report.sequence = destination.sequence++;
+    report.ingressTimestamp = (uint32_t)obs.timestampNs;
+    report.switchId = m_dtel.switchId;
+    report.ingressPort = obs.ingressPort;
+    report.egressPort = obs.egressPort;
+    report.queue = obs.queue;
+    report.queueOccupancy = obs.queueDepth;
+    report.egressTimestamp = (uint32_t)(obs.timestampNs + obs.latencyNs);
+    report.dropReason = obs.dropReason;
+    report.packetLen = (uint16_t)(session.reportLen - DTEL_REPORT_HEADER_LEN - DTEL_LOCAL_HEADER_LEN);
+    report.srcIp = obs.srcIp;
+    report.dstIp = obs.dstIp;
+    report.srcPort = obs.srcPort;
+    report.dstPort = obs.dstPort;
+    report.protocol = obs.protocol;
+
+    dtel_report_encode(report, &destination.buf[(size_t)destination.pending * session.reportLen]);
+    destination.tos[destination.pending] = (uint8_t)(event.dscp << 2);
+
+    if (++destination.pending == DTEL_TX_REPORTS)
+    {
+        Send(destination, session.reportLen);
+    }
+}
+
+uint32_t DtelEngine::Process(const DtelObservation *obs, uint32_t count)
+{
+    uint64_t before = m_counters.reports;
+    bool flowReports = m_dtel.used && (m_dtel.postcard || m_dtel.intEndpoint);
+    bool queueReports = m_dtel.used && m_dtel.queueReport;
+    bool dropReports = m_dtel.used && m_dtel.dropReport && m_events[SAI_DTEL_EVENT_TYPE_DROP_REPORT].used;
+    bool breachReports = queueReports && m_events[SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_THRESHOLD_BREACH].used;
+    bool tailDropReports = queueReports && m_events[SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_TAIL_DROP].used;
+    bool reportAll = m_events[SAI_DTEL_EVENT_TYPE_FLOW_REPORT_ALL_PACKETS].used;
+    bool tcpFlag = m_events[SAI_DTEL_EVENT_TYPE_FLOW_TCPFLAG].used;
+    bool flowState = m_events[SAI_DTEL_EVENT_TYPE_FLOW_STATE].used;
+    uint32_t sensitivity = m_dtel.latencySensitivity;
+
+    uint64_t hashes[DTEL_PREFETCH];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // the flow state buckets are cache misses, a group of them is
+        // fetched at once
+        if (i % DTEL_PREFETCH == 0)
+        {
+            for (uint32_t j = 0; j < DTEL_PREFETCH && i + j < count; j++)
+            {
+                hashes[j] = flow_hash(obs[i + j]);
+                m_flowState.Prefetch(hashes[j]);
+            }
+        }
+
+        const DtelObservation &o = obs[i];
+        uint64_t hash = hashes[i % DTEL_PREFETCH];
+        uint8_t flags = 0;
+        sai_dtel_event_type_t type = SAI_DTEL_EVENT_TYPE_MAX;
+
+        if (o.timestampNs >= m_nextClearNs)
+        {
+            // the first observation starts the cycle; a gap of several
+            // cycles clears once
+            if (m_nextClearNs)
+            {
+                m_flowState.Clear();
+                m_dropState.Clear();
+                m_counters.clears++;
+            }
+
+            m_nextClearNs += m_clearCycleNs;
+
+            if (m_nextClearNs <= o.timestampNs)
+            {
+                m_nextClearNs = o.timestampNs + m_clearCycleNs;
+            }
+        }
+
+        uint32_t slot = (uint32_t)o.egressPort * DTEL_QUEUES_PER_PORT + o.queue;
+        DtelQueueReport *queue = queueReports && slot < m_queueSlots.size() && m_queueSlots[slot]
+                                 ? &m_queueReports[m_queueSlots[slot] - 1] : NULL;
+
+        m_counters.observations++;
+
+        if (o.flags & DTEL_OBS_TAIL_DROP)
+        {
+            if (tailDropReports && queue && queue->tailDrop)
+            {
+                flags = DTEL_REPORT_DROP | DTEL_REPORT_QUEUE;
+                type = SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_TAIL_DROP;
+            }
+        }
+        else if (o.dropReason)
+        {
+            if (dropReports && (o.flags & DTEL_OBS_DROP_WATCH))
+            {
+                if (m_dropState.Update(hash, o.dropReason))
+                {
+                    flags = DTEL_REPORT_DROP;
+                    type = SAI_DTEL_EVENT_TYPE_DROP_REPORT;
+                }
+                else
+                {
+                    m_counters.dropSuppressed++;
+                }
+            }
+        }
+        else
+        {
+            if (breachReports && queue)
+            {
+                bool breach = (queue->depthThreshold && o.queueDepth > queue->depthThreshold) ||
+                              (queue->latencyThreshold && o.latencyNs > queue->latencyThreshold);
+
+                if (!breach)
+                {
+                    queue->breached = false;
+                }
+                else
+                {
+                    if (!queue->breached)
+                    {
+                        queue->breached = true;
+                        queue->remaining = queue->breachQuota;
+                    }
+
+                    if (queue->breachQuota == 0 || queue->remaining)
+                    {
+                        queue->remaining -= queue->breachQuota != 0;
+                        flags = DTEL_REPORT_QUEUE;
+                        type = SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_THRESHOLD_BREACH;
+                    }
+                    else
+                    {
+                        m_counters.quotaSuppressed++;
+                    }
+                }
+            }
+
+            if (flowReports && (o.flags & DTEL_OBS_FLOW_WATCH))
+            {
+                sai_dtel_event_type_t flowType = SAI_DTEL_EVENT_TYPE_MAX;
+
+                if (reportAll && (o.flags & DTEL_OBS_REPORT_ALL))
+                {
+                    flowType = SAI_DTEL_EVENT_TYPE_FLOW_REPORT_ALL_PACKETS;
+                }
+                else if (tcpFlag && (o.tcpFlags & (DTEL_TCP_FIN | DTEL_TCP_SYN | DTEL_TCP_RST)))
+                {
+                    flowType = SAI_DTEL_EVENT_TYPE_FLOW_TCPFLAG;
+                }
+                else if (flowState)
+                {
+                    uint64_t ports = (uint64_t)o.ingressPort << 16 | o.egressPort;
+
+                    if (m_flowState.Update(hash, (uint32_t)mix64(ports << 32 | o.latencyNs >> sensitivity)))
+                    {
+                        flowType = SAI_DTEL_EVENT_TYPE_FLOW_STATE;
+                    }
+                    else
+                    {
+                        m_counters.flowSuppressed++;
+                    }
+                }
+
+                if (flowType != SAI_DTEL_EVENT_TYPE_MAX)
+                {
+                    flags |= DTEL_REPORT_FLOW;
+                    type = type == SAI_DTEL_EVENT_TYPE_MAX ? flowType : type;
+                }
+            }
+        }
+
+        if (flags)
+        {
+            Emit(o, hash, flags, type);
+        }
+    }
+
+    for (size_t s = 0; s < m_sessions.size(); s++)
+    {
+        DtelReportSession &session = m_sessions[s];
+
+        for (size_t d = 0; d < session.destinations.size(); d++)
+        {
+            if (session.destinations[d].pending)
+            {
+                Send(session.destinations[d], session.reportLen);
+            }
+        }
+    }
+
+    return (uint32_t)(m_counters.reports - before);
+}
+
+bool DtelEngine::Gso() const
+{
+    return m_gso;
+}
+
+uint32_t DtelEngine::FlowStateCapacity() const
+{
+    return m_flowState.Capacity();
+}
+
+const DtelCounters& DtelEngine::GetCounters() const
+{
+    return m_counters;
+}
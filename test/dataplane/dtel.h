@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+#include "bench_util.h"
+
+// telemetry report (v0.5) layout: a 12 byte report header, a 16 byte
+// switch local or drop header, then the head of the reported packet
+//
+//   report header   ver:4 next proto:4 | d:1 q:1 f:1 rsvd:5 | rsvd:2 hw id:6 |
+//                   rsvd:8 | sequence:32 | ingress timestamp:32
+//   switch local    switch id:32 | ingress port:16 | egress port:16 |
+//                   queue id:8 queue occupancy:24 | egress timestamp:32
+//   drop            switch id:32 | ingress port:16 | egress port:16 |
+//                   queue id:8 drop reason:8 rsvd:16 | rsvd:32
+//   packet          Ethernet, IPv4 and the first 8 bytes of L4
+#define DTEL_REPORT_VERSION                 0
+#define DTEL_REPORT_HEADER_LEN              12
+#define DTEL_LOCAL_HEADER_LEN               16
+#define DTEL_PACKET_LEN                     42
+#define DTEL_REPORT_MAX_LEN                 (DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN + DTEL_PACKET_LEN)
+
+#define DTEL_NEXT_PROTO_ETHERNET            0
+#define DTEL_NEXT_PROTO_DROP                1
+#define DTEL_NEXT_PROTO_SWITCH_LOCAL        2
+
+#define DTEL_REPORT_DROP                    0x80
+#define DTEL_REPORT_QUEUE                   0x40
+#define DTEL_REPORT_FLOW                    0x20
+
+#define DTEL_QUEUE_OCCUPANCY_MAX            0xFFFFFF
+#define DTEL_QUEUES_PER_PORT                32
+
+// DtelObservation::flags
+#define DTEL_OBS_FLOW_WATCH                 0x01    // flow watchlist hit, POSTCARD or INT
+#define DTEL_OBS_REPORT_ALL                 0x02    // its entry reports every packet
+#define DTEL_OBS_DROP_WATCH                 0x04    // drop watchlist hit
+#define DTEL_OBS_TAIL_DROP                  0x08    // the egress queue was full
+
+#define DTEL_TCP_FIN                        0x01
+#define DTEL_TCP_SYN                        0x02
+#define DTEL_TCP_RST                        0x04
+
+// the engine's object ids carry the object type above the index, like
+// the ones a SAI implementation hands out
+inline sai_object_id_t dtel_oid(sai_object_type_t type, uint32_t index)
+{
+    return ((uint64_t)type << 48) | ((uint64_t)index + 1);
+}
+
+inline sai_object_type_t dtel_oid_type(sai_object_id_t oid)
+{
+    return (sai_object_type_t)(oid >> 48);
+}
+
+inline uint32_t dtel_oid_index(sai_object_id_t oid)
+{
+    return (uint32_t)(oid & 0xFFFFFFFFFFFFULL) - 1;
+}
+
+// what the pipeline saw of one packet at its egress queue; addresses and
+// ports in host order
+struct DtelObservation
+{
+    uint64_t timestampNs;           // ingress
+    uint32_t srcIp;
+    uint32_t dstIp;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint16_t ingressPort;
+    uint16_t egressPort;
+    uint32_t queueDepth;            // bytes ahead of the packet
+    uint32_t latencyNs;             // hop latency
+    uint8_t protocol;
+    uint8_t queue;                  // on the egress port
+    uint8_t tcpFlags;
+    uint8_t dropReason;             // non zero when dropped in the pipeline
+    uint8_t flags;                  // DTEL_OBS_*
+};
+
+// one report, as encoded or decoded
+struct DtelReport
+{
+    uint8_t nextProto;
+    uint8_t flags;                  // DTEL_REPORT_*
+    uint8_t hwId;
+    uint32_t sequence;
+    uint32_t ingressTimestamp;
+    uint32_t switchId;
+    uint16_t ingressPort;
+    uint16_t egressPort;
+    uint8_t queue;
+    uint32_t queueOccupancy;
+    uint32_t egressTimestamp;       // switch local
+    uint8_t dropReason;             // drop
+    uint16_t packetLen;             // of the packet head, after truncation
+    uint32_t srcIp;                 // the packet head's, once it is whole
+    uint32_t dstIp;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t protocol;
+};
+
+// the report at buf with packetLen bytes of the packet head, returns its
+// length
+size_t dtel_report_encode(const DtelReport &report, uint8_t *buf);
+
+// false when buf is not a report or is cut inside the report headers
+bool dtel_report_decode(const uint8_t *buf, size_t len, DtelReport &report);
+
+// Flow state, keyed by the flow hash. Two way buckets hold a 32 bit
+// signature and a digest of the state last reported; a miss or a changed
+// digest is reported and recorded, so a collision costs a duplicate report,
+// never a lost one. Clear() bumps an epoch rather than touching the table.
+class DtelFlowStateTable
+{
+    struct Entry
+    {
+        uint32_t signature;
+        uint32_t state;
+        uint32_t epoch;
+    };
+
+    std::vector<Entry> m_entries;
+    uint64_t m_mask;                // of the bucket index
+    uint32_t m_epoch;
+
+public:
+    // capacity rounds up to a power of two
+    explicit DtelFlowStateTable(uint32_t capacity);
+
+    // true when the flow is new or its state changed
+    bool Update(uint64_t hash, uint32_t state);
+    void Prefetch(uint64_t hash) const;
+    void Clear();
+    uint32_t Capacity() const;
+};
+
+// SAI_DTEL_ATTR_*, the one DTEL object
+struct DtelConfig
+{
+    bool used;
+    bool intEndpoint;
+    bool intTransit;
+    bool postcard;
+    bool dropReport;
+    bool queueReport;
+    uint32_t switchId;
+    uint16_t flowStateClearCycle;   // seconds, 0 never clears
+    uint8_t latencySensitivity;     // latency bits ignored by flow state
+};
+
+// SAI_DTEL_QUEUE_REPORT_ATTR_*; thresholds of 0 are off, a quota of 0
+// reports the whole breach
+struct DtelQueueReport
+{
+    bool used;
+    sai_object_id_t queueId;
+    uint32_t slot;                  // port * DTEL_QUEUES_PER_PORT + queue
+    uint32_t depthThreshold;        // bytes
+    uint32_t latencyThreshold;      // ns
+    uint32_t breachQuota;
+    bool tailDrop;
+    bool breached;
+    uint32_t remaining;             // of the quota in this breach
+};
+
+// a DST_IP_LIST address with its report sequence and pending reports
+struct DtelDestination
+{
+    struct sockaddr_in dst;
+    uint32_t sequence;
+    uint32_t pending;
+    std::vector<uint8_t> buf;       // pending reports back to back
+    std::vector<uint8_t> tos;
+};
+
+// SAI_DTEL_REPORT_SESSION_ATTR_*, IPv4 only
+struct DtelReportSession
+{
+    bool used;
+    uint32_t refs;                  // events reporting to it
+    uint32_t srcIp;
+    uint16_t truncateSize;
+    uint16_t udpDstPort;
+    uint16_t reportLen;             // with the truncated packet head
+    std::vector<DtelDestination> destinations;
+};
+
+// SAI_DTEL_INT_SESSION_ATTR_*, held for its oid only
+struct DtelIntSession
+{
+    bool used;
+    uint8_t maxHopCount;
+};
+
+// SAI_DTEL_EVENT_ATTR_*, one per event type
+struct DtelEvent
+{
+    bool used;
+    bool hasSession;
+    uint32_t session;
+    uint8_t dscp;
+};
+
+struct DtelCounters
+{
+    uint64_t observations;
+    uint64_t reports;
+    uint64_t flowReports;           // per report flag, a report can carry several
+    uint64_t queueReports;
+    uint64_t dropReports;
+    uint64_t flowSuppressed;        // unchanged flow state
+    uint64_t dropSuppressed;        // drop already reported for the flow
+    uint64_t quotaSuppressed;       // breaching past the quota
+    uint64_t unrouted;              // event without a report session
+    uint64_t datagrams;
+    uint64_t sendDrops;
+    uint64_t clears;                // flow state clear cycles
+};
+
+// Software DTEL report generator.
+//
+// Process() runs a stream of per-packet queue observations through the
+// DTEL object, queue report and event configuration and emits a report
+// for each packet that triggers at least one event:
+//   - FLOW_STATE for a flow watchlist hit (with POSTCARD or INT_ENDPOINT
+//     enabled) whose state is new to the flow state table: the flow's
+//     ingress and egress ports and its latency shifted right by
+//     LATENCY_SENSITIVITY. The tables are cleared every
+//     FLOW_STATE_CLEAR_CYCLE seconds of observation time, so a long flow
+//     is reported again each cycle. FLOW_REPORT_ALL_PACKETS and
+//     FLOW_TCPFLAG (SYN, FIN or RST) bypass the table.
+//   - QUEUE_REPORT_THRESHOLD_BREACH while a queue's depth or latency is
+//     over its threshold, at most BREACH_QUOTA reports per breach; the
+//     quota rearms once the queue is back under both thresholds.
+//   - QUEUE_REPORT_TAIL_DROP for tail dropped packets of queues with
+//     TAIL_DROP set.
+//   - DROP_REPORT for drop watchlist hits dropped in the pipeline, once
+//     per flow and drop reason per clear cycle.
+// A packet gets one report with the flags of all its events, sent with
+// the report session and DSCP of the most severe one (drop, then queue,
+// then flow). Reports go to one DST_IP_LIST address picked by flow hash,
+// each address with its own sequence, carrying TRUNCATE_SIZE bytes of the
+// packet head (all DTEL_PACKET_LEN when 0); reports of an event without a
+// session, or of a session without addresses or UDP_DST_PORT, are counted
+// as unrouted. A Process() call ends with the reports sent in UDP GSO
+// trains where the kernel has UDP_SEGMENT; without Open() they are
+// encoded and discarded.
+//
+// Queues are registered with AddQueue() to give the QUEUE_ID oids their
+// port and queue number. INT sessions, sink ports and the INT DSCP are
+// accepted but INT transit and sink are not modelled, nor are the report
+// session's source address and virtual router. The engine is not thread
+// safe.
+class DtelEngine
+{
+    int m_fd;
+    bool m_gso;
+
+    DtelConfig m_dtel;
+    std::vector<DtelQueueReport> m_queueReports;
+    std::vector<uint32_t> m_queueSlots;     // slot -> queue report index + 1
+    std::unordered_map<sai_object_id_t, uint32_t> m_queues;    // oid -> slot
+    std::vector<DtelReportSession> m_sessions;
+    std::vector<DtelIntSession> m_intSessions;
+    DtelEvent m_events[SAI_DTEL_EVENT_TYPE_MAX];
+
+    DtelFlowStateTable m_flowState;
+    DtelFlowStateTable m_dropState;
+    uint64_t m_clearCycleNs;
+    uint64_t m_nextClearNs;                 // 0 starts the cycle on the next observation
+
+    std::vector<uint8_t> m_txControl;
+    DtelCounters m_counters;
+
+    void SetClearCycle(uint16_t seconds);
+    void Emit(const DtelObservation &obs, uint64_t hash, uint8_t flags, sai_dtel_event_type_t type);
+    void Send(DtelDestination &destination, uint16_t reportLen);
+
+    sai_status_t ParseDtel(DtelConfig &dtel, uint32_t attr_count, const sai_attribute_t *attr_list) const;
+    sai_status_t ParseQueueReport(DtelQueueReport &report, bool create, uint32_t attr_count,
+                                  const sai_attribute_t *attr_list) const;
+    sai_status_t ParseReportSession(DtelReportSession &session, uint32_t attr_count,
+                                    const sai_attribute_t *attr_list) const;
+    sai_status_t ParseEvent(DtelEvent &event, int &type, bool create, uint32_t attr_count,
+                            const sai_attribute_t *attr_list) const;
+    sai_status_t ParseIntSession(DtelIntSession &session, uint32_t attr_count,
+                                 const sai_attribute_t *attr_list) const;
+
+    sai_status_t CreateQueueReport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateReportSession(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateEvent(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+
+public:
+    // the flow and drop state tables hold flowStateCapacity flows each
+    explicit DtelEngine(uint32_t flowStateCapacity);
+    ~DtelEngine();
+
+    // report socket, port 0 picks a free one
+    bool Open(const char *addr, uint16_t port);
+
+    // a queue the queue reports can name, queue below DTEL_QUEUES_PER_PORT
+    sai_status_t AddQueue(sai_object_id_t queueId, uint16_t port, uint8_t queue);
+
+    // SAI_OBJECT_TYPE_DTEL, _DTEL_QUEUE_REPORT, _DTEL_INT_SESSION,
+    // _DTEL_REPORT_SESSION and _DTEL_EVENT
+    sai_status_t Create(sai_object_type_t type,
+                        sai_object_id_t &oid,
+                        uint32_t attr_count,
+                        const sai_attribute_t *attr_list);
+    sai_status_t Remove(sai_object_id_t oid);
+
+    // CREATE_AND_SET attributes of the DTEL, queue report, report session
+    // and event objects
+    sai_status_t Set(sai_object_id_t oid, const sai_attribute_t *attr);
+
+    // runs the observations in order and sends their reports, returns how
+    // many reports they made
+    uint32_t Process(const DtelObservation *obs, uint32_t count);
+
+    bool Gso() const;
+    uint32_t FlowStateCapacity() const;
+    const DtelCounters& GetCounters() const;
+};
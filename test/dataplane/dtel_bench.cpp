@@ -0,0 +1,634 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/udp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "dtel_bench.h"
+
+#define DTEL_BENCH_ADDR             "127.0.0.1"
+#define DTEL_BENCH_DISCARD_PORT     9           // report port when nothing is sent
+#define DTEL_BENCH_DSCP             8
+#define DTEL_BENCH_SWITCH_ID        1
+#define DTEL_BENCH_SOCKET_BUFFER    (4 * 1024 * 1024)
+#define DTEL_BENCH_DRAIN_MS         1000
+#define DTEL_BENCH_RX_LEN           65536       // room for a GRO train
+
+// a 100G queue drains 12.5 bytes a nanosecond into a 1MB buffer
+#define DTEL_BENCH_BUFFER           (1024 * 1024)
+#define DTEL_BENCH_BASE_LATENCY_NS  500
+#define DTEL_BENCH_CONGEST_ODDS     20000       // a queue congests once in this many of its packets
+#define DTEL_BENCH_RELIEVE_ODDS     500
+#define DTEL_BENCH_STEP             8192
+
+#define NS_PER_SEC                  1000000000ULL
+
+#ifndef UDP_GRO
+#define UDP_GRO                     104
+#endif
+
+DtelProfile::DtelProfile()
+{
+    observations = 20000000;
+    rate = 10000000;
+    flows = 100000;
+    watch = 100;
+    ports = 32;
+    queues = 8;
+    threshold = 256 * 1024;
+    quota = 64;
+    sensitivity = 14;
+    clear = 1;
+    drops = 100;
+    collectors = 2;
+    batch = 256;
+    send = 1;
+}
+
+void DtelProfile::Parse(const std::string &profile)
+{
+    BenchProfileItems items = bench_profile_split(profile);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const std::string &key = items[i].first;
+        uint32_t value = bench_parse_uint(key, items[i].second);
+
+        if (key == "observations")
+        {
+            observations = value;
+        }
+        else if (key == "rate")
+        {
+            rate = value;
+        }
+        else if (key == "flows")
+        {
+            flows = value;
+        }
+        else if (key == "watch")
+        {
+            watch = value;
+        }
+        else if (key == "ports")
+        {
+            ports = value;
+        }
+        else if (key == "queues")
+        {
+            queues = value;
+        }
+        else if (key == "threshold")
+        {
+            threshold = value;
+        }
+        else if (key == "quota")
+        {
+            quota = value;
+        }
+        else if (key == "sensitivity")
+        {
+            sensitivity = value;
+        }
+        else if (key == "clear")
+        {
+            clear = value;
+        }
+        else if (key == "drops")
+        {
+            drops = value;
+        }
+        else if (key == "collectors")
+        {
+            collectors = value;
+        }
+        else if (key == "batch")
+        {
+            batch = value;
+        }
+        else if (key == "send")
+        {
+            send = value;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown dtel profile key " + key);
+        }
+    }
+
+    if (observations == 0 || rate == 0 || flows == 0 || watch > 100 || ports == 0 || ports > 0xFFFF ||
+        queues == 0 || queues > DTEL_QUEUES_PER_PORT || sensitivity > 31 || clear > 0xFFFF || drops > 1000000 ||
+        collectors == 0 || collectors > 254 || batch == 0 || send > 1)
+    {
+        throw std::invalid_argument("observations, rate, flows, ports, queues, collectors and batch must be non "
+                                    "zero, watch at most 100, ports at most 65535, queues at most 32, "
+                                    "sensitivity at most 31, clear at most 65535, drops at most 1000000, "
+                                    "collectors at most 254, send 0 or 1");
+    }
+}
+
+DtelBench::DtelBench(DtelEngine* engine) :
+    m_engine(engine)
+{
+}
+
+// synthetic traffic: skewed flows pinned to ports and queues, each queue
+// a random walk that now and then congests up to a full buffer and tail
+// drops
+class DtelTraffic
+{
+    struct Queue
+    {
+        uint32_t depth;
+        bool congested;
+    };
+
+    const DtelProfile &m_profile;
+    std::vector<Queue> m_queues;
+    uint64_t m_rng;
+    uint64_t m_index;
+
+    uint64_t Next()
+    {
+        m_rng ^= m_rng >> 12;
+        m_rng ^= m_rng << 25;
+        m_rng ^= m_rng >> 27;
+
+        return m_rng * 0x2545F4914F6CDD1DULL;
+    }
+
+public:
+    explicit DtelTraffic(const DtelProfile &profile) :
+        m_profile(profile),
+        m_queues((size_t)profile.ports * profile.queues),
+        m_rng(0x9E3779B97F4A7C15ULL),
+        m_index(0)
+    {
+    }
+
+    void Fill(DtelObservation *obs, uint32_t count)
+    {
+        uint32_t hot = std::max<uint32_t>(m_profile.flows / 5, 1);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            DtelObservation &o = obs[i];
+            uint64_t r = Next();
+            uint32_t f = (r & 0xFF) < 204 ? (uint32_t)((r >> 8) % hot) : (uint32_t)((r >> 8) % m_profile.flows);
+
+            memset(&o, 0, sizeof(o));
+            o.timestampNs = m_index++ * NS_PER_SEC / m_profile.rate;
+            o.srcIp = 0x0A000000 + f;
+            o.dstIp = 0x0A800000 + (uint32_t)(((uint64_t)f * 2654435761U) % m_profile.flows);
+            o.srcPort = (uint16_t)(1024 + f % 60000);
+            o.dstPort = (uint16_t)(443 + f % 4);
+            o.protocol = IPPROTO_TCP;
+            o.ingressPort = (uint16_t)(f % m_profile.ports);
+            o.egressPort = (uint16_t)((f / m_profile.ports + f) % m_profile.ports);
+            o.queue = (uint8_t)(f % m_profile.queues);
+            o.flags = f % 100 < m_profile.watch ? DTEL_OBS_FLOW_WATCH : 0;
+
+            Queue &queue = m_queues[(size_t)o.egressPort * m_profile.queues + o.queue];
+            uint64_t q = Next();
+            uint32_t step = (uint32_t)((q >> 32) % DTEL_BENCH_STEP);
+
+            if (!queue.congested && q % DTEL_BENCH_CONGEST_ODDS == 0)
+            {
+                queue.congested = true;
+            }
+            else if (queue.congested && q % DTEL_BENCH_RELIEVE_ODDS == 0)
+            {
+                queue.congested = false;
+            }
+
+            // congested queues gain a quarter step a packet on average
+            if (!queue.congested)
+            {
+                queue.depth = queue.depth > step ? queue.depth - step : 0;
+            }
+            else if (queue.depth + step * 2 > DTEL_BENCH_BUFFER + DTEL_BENCH_STEP * 3 / 4)
+            {
+                o.flags |= DTEL_OBS_TAIL_DROP;
+            }
+            else
+            {
+                queue.depth = std::min<uint32_t>(queue.depth + step * 2 - DTEL_BENCH_STEP * 3 / 4,
+                                                 DTEL_BENCH_BUFFER);
+            }
+
+            o.queueDepth = queue.depth;
+            o.latencyNs = DTEL_BENCH_BASE_LATENCY_NS + queue.depth * 2 / 25;
+            o.tcpFlags = (q >> 16) % 1000 == 0 ? DTEL_TCP_SYN : 0;
+
+            if (Next() % 1000000 < m_profile.drops && !(o.flags & DTEL_OBS_TAIL_DROP))
+            {
+                o.dropReason = (uint8_t)(1 + r % 4);
+                o.flags |= DTEL_OBS_DROP_WATCH;
+            }
+        }
+    }
+};
+
+// receives and decodes the reports, GRO trains split by segment size
+struct DtelCollectorWorker
+{
+    int fd;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> received;
+    uint64_t decodeErrors;
+
+    explicit DtelCollectorWorker(int sock) :
+        fd(sock), stop(false), received(0), decodeErrors(0)
+    {
+    }
+
+    void Run()
+    {
+        std::vector<uint8_t> buf(DTEL_BENCH_RX_LEN);
+        uint8_t control[64];
+        DtelReport report;
+
+        while (!stop.load())
+        {
+            struct iovec iov;
+            struct msghdr msg;
+
+            iov.iov_base = buf.data();
+            iov.iov_len = buf.size();
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            ssize_t len = recvmsg(fd, &msg, 0);
+
+            if (len <= 0)
+            {
+                continue;
+            }
+
+            size_t segment = (size_t)len;
+
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+            {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+                {
+                    uint16_t value;
+
+                    memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+                    segment = value;
+                }
+            }
+
+            uint64_t count = 0;
+
+            for (size_t off = 0; off < (size_t)len; off += segment, count++)
+            {
+                if (!dtel_report_decode(&buf[off], std::min(segment, (size_t)len - off), report))
+                {
+                    decodeErrors++;
+                }
+            }
+
+            received.store(received.load() + count);
+        }
+    }
+};
+
+// on every loopback address, the report session spreads over 127.0.0.x
+static int open_collector(uint16_t &port)
+{
+    struct sockaddr_in sin;
+    socklen_t sinLen = sizeof(sin);
+    struct timeval tv = { 0, 100000 };
+    int size = DTEL_BENCH_SOCKET_BUFFER;
+    int on = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on));
+
+    if (bind(fd, (struct sockaddr*)&sin, sizeof(sin)) < 0 ||
+        getsockname(fd, (struct sockaddr*)&sin, &sinLen) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    port = ntohs(sin.sin_port);
+
+    return fd;
+}
+
+static bool create(DtelEngine *engine, sai_object_type_t type, sai_object_id_t &oid, uint32_t count,
+                   const sai_attribute_t *attrs)
+{
+    if (engine->Create(type, oid, count, attrs) != SAI_STATUS_SUCCESS)
+    {
+        printf("failed to create dtel object type %d\n", type);
+        return false;
+    }
+
+    return true;
+}
+
+static bool setup(DtelEngine *engine, const DtelProfile &profile, uint16_t port)
+{
+    sai_attribute_t attrs[6];
+    sai_object_id_t oid;
+    sai_object_id_t session;
+    std::vector<sai_ip_address_t> ips(profile.collectors);
+
+    for (uint32_t p = 0; p < profile.ports; p++)
+    {
+        for (uint32_t q = 0; q < profile.queues; q++)
+        {
+            sai_object_id_t queue = dtel_oid(SAI_OBJECT_TYPE_QUEUE, p * profile.queues + q);
+
+            if (engine->AddQueue(queue, (uint16_t)p, (uint8_t)q) != SAI_STATUS_SUCCESS)
+            {
+                return false;
+            }
+        }
+    }
+
+    attrs[0].id = SAI_DTEL_ATTR_POSTCARD_ENABLE;
+    attrs[0].value.booldata = true;
+    attrs[1].id = SAI_DTEL_ATTR_DROP_REPORT_ENABLE;
+    attrs[1].value.booldata = true;
+    attrs[2].id = SAI_DTEL_ATTR_QUEUE_REPORT_ENABLE;
+    attrs[2].value.booldata = true;
+    attrs[3].id = SAI_DTEL_ATTR_SWITCH_ID;
+    attrs[3].value.u32 = DTEL_BENCH_SWITCH_ID;
+    attrs[4].id = SAI_DTEL_ATTR_FLOW_STATE_CLEAR_CYCLE;
+    attrs[4].value.u16 = (uint16_t)profile.clear;
+    attrs[5].id = SAI_DTEL_ATTR_LATENCY_SENSITIVITY;
+    attrs[5].value.u8 = (uint8_t)profile.sensitivity;
+
+    if (!create(engine, SAI_OBJECT_TYPE_DTEL, oid, 6, attrs))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < profile.collectors; i++)
+    {
+        ips[i].addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+        ips[i].addr.ip4 = htonl(INADDR_LOOPBACK + i);
+    }
+
+    attrs[0].id = SAI_DTEL_REPORT_SESSION_ATTR_DST_IP_LIST;
+    attrs[0].value.ipaddrlist.count = profile.collectors;
+    attrs[0].value.ipaddrlist.list = ips.data();
+    attrs[1].id = SAI_DTEL_REPORT_SESSION_ATTR_UDP_DST_PORT;
+    attrs[1].value.u16 = port;
+
+    if (!create(engine, SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, session, 2, attrs))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < profile.ports * profile.queues; i++)
+    {
+        attrs[0].id = SAI_DTEL_QUEUE_REPORT_ATTR_QUEUE_ID;
+        attrs[0].value.oid = dtel_oid(SAI_OBJECT_TYPE_QUEUE, i);
+        attrs[1].id = SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD;
+        attrs[1].value.u32 = profile.threshold;
+        attrs[2].id = SAI_DTEL_QUEUE_REPORT_ATTR_BREACH_QUOTA;
+        attrs[2].value.u32 = profile.quota;
+        attrs[3].id = SAI_DTEL_QUEUE_REPORT_ATTR_TAIL_DROP;
+        attrs[3].value.booldata = true;
+
+        if (!create(engine, SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, 4, attrs))
+        {
+            return false;
+        }
+    }
+
+    // every event but FLOW_REPORT_ALL_PACKETS, which no watchlist entry asks for
+    sai_dtel_event_type_t types[] = { SAI_DTEL_EVENT_TYPE_FLOW_STATE, SAI_DTEL_EVENT_TYPE_FLOW_TCPFLAG,
+                                      SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_THRESHOLD_BREACH,
+                                      SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_TAIL_DROP, SAI_DTEL_EVENT_TYPE_DROP_REPORT };
+
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        attrs[0].id = SAI_DTEL_EVENT_ATTR_TYPE;
+        attrs[0].value.s32 = types[i];
+        attrs[1].id = SAI_DTEL_EVENT_ATTR_REPORT_SESSION;
+        attrs[1].value.oid = session;
+        attrs[2].id = SAI_DTEL_EVENT_ATTR_DSCP_VALUE;
+        attrs[2].value.u8 = DTEL_BENCH_DSCP;
+
+        if (!create(engine, SAI_OBJECT_TYPE_DTEL_EVENT, oid, 3, attrs))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DtelBench::Run(const DtelProfile &profile, DtelBenchResult &result)
+{
+    uint16_t port = DTEL_BENCH_DISCARD_PORT;
+    int fd = -1;
+
+    result = DtelBenchResult();
+
+    if (profile.send)
+    {
+        fd = open_collector(port);
+
+        if (fd < 0 || !m_engine->Open(DTEL_BENCH_ADDR, 0))
+        {
+            printf("failed to open dtel sockets on %s\n", DTEL_BENCH_ADDR);
+
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return false;
+        }
+    }
+
+    result.gso = m_engine->Gso();
+
+    if (!setup(m_engine, profile, port))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    DtelCollectorWorker worker(fd);
+    std::thread collectorThread;
+
+    if (fd >= 0)
+    {
+        collectorThread = std::thread(&DtelCollectorWorker::Run, &worker);
+    }
+
+    DtelTraffic traffic(profile);
+    std::vector<DtelObservation> obs(profile.batch);
+    uint64_t cpuNs = 0;
+
+    // the traffic is made between the timed calls
+    for (uint32_t done = 0; done < profile.observations;)
+    {
+        uint32_t count = std::min(profile.batch, profile.observations - done);
+
+        traffic.Fill(obs.data(), count);
+
+        uint64_t cpu = bench_thread_cpu_ns();
+
+        m_engine->Process(obs.data(), count);
+        cpuNs += bench_thread_cpu_ns() - cpu;
+        done += count;
+    }
+
+    result.counters = m_engine->GetCounters();
+
+    if (fd >= 0)
+    {
+        uint64_t deadline = bench_now_ns() + DTEL_BENCH_DRAIN_MS * 1000000ULL;
+
+        while (worker.received.load() < result.counters.datagrams && bench_now_ns() < deadline)
+        {
+            std::this_thread::yield();
+        }
+
+        worker.stop.store(true);
+        collectorThread.join();
+        close(fd);
+    }
+
+    result.received = worker.received.load();
+    result.decodeErrors = worker.decodeErrors;
+    result.cpuSeconds = (double)cpuNs / 1e9;
+    result.observationsPerSec = cpuNs ? profile.observations / result.cpuSeconds : 0;
+    result.nsPerObservation = (double)cpuNs / profile.observations;
+    result.reportsPerObservation = (double)result.counters.reports / profile.observations;
+    result.trafficSeconds = (double)profile.observations / profile.rate;
+    result.reportsPerSec = result.counters.reports / result.trafficSeconds;
+    result.reportMbps = result.reportsPerSec * (DTEL_REPORT_MAX_LEN + 28) * 8 / 1e6;
+
+    const DtelCounters &c = result.counters;
+
+    // every report routed, and with send every one delivered and decoded
+    return c.observations == profile.observations && c.reports && c.unrouted == 0 &&
+           (!profile.send || (c.sendDrops == 0 && c.datagrams == c.reports && result.received == c.datagrams &&
+                              result.decodeErrors == 0));
+}
+
+std::string DtelBench::ToJson(const DtelProfile &profile, const DtelBenchResult &result)
+{
+    const DtelCounters &c = result.counters;
+    std::stringstream json;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"observations\": " << profile.observations
+         << ", \"rate\": " << profile.rate
+         << ", \"flows\": " << profile.flows
+         << ", \"watch_percent\": " << profile.watch
+         << ", \"ports\": " << profile.ports
+         << ", \"queues\": " << profile.queues
+         << ", \"threshold\": " << profile.threshold
+         << ", \"quota\": " << profile.quota
+         << ", \"sensitivity\": " << profile.sensitivity
+         << ", \"clear_s\": " << profile.clear
+         << ", \"drops_ppm\": " << profile.drops
+         << ", \"collectors\": " << profile.collectors
+         << ", \"batch\": " << profile.batch
+         << ", \"send\": " << profile.send << "},\n";
+    json << "  \"gso\": " << (result.gso ? "true" : "false") << ",\n";
+    json << "  \"observations\": " << c.observations << ",\n";
+    json << "  \"reports\": {\"total\": " << c.reports
+         << ", \"flow\": " << c.flowReports
+         << ", \"queue\": " << c.queueReports
+         << ", \"drop\": " << c.dropReports << "},\n";
+    json << "  \"suppressed\": {\"flow_state\": " << c.flowSuppressed
+         << ", \"drop_state\": " << c.dropSuppressed
+         << ", \"quota\": " << c.quotaSuppressed << "},\n";
+    json << "  \"clears\": " << c.clears << ",\n";
+    json << "  \"unrouted\": " << c.unrouted << ",\n";
+    json << "  \"datagrams\": " << c.datagrams << ",\n";
+    json << "  \"send_drops\": " << c.sendDrops << ",\n";
+    json << "  \"received\": " << result.received << ",\n";
+    json << "  \"decode_errors\": " << result.decodeErrors << ",\n";
+    json << "  \"cpu_seconds\": " << result.cpuSeconds << ",\n";
+    json << "  \"observations_per_sec\": " << result.observationsPerSec << ",\n";
+    json << "  \"ns_per_observation\": " << result.nsPerObservation << ",\n";
+    json << "  \"reports_per_observation\": " << result.reportsPerObservation << ",\n";
+    json << "  \"traffic_seconds\": " << result.trafficSeconds << ",\n";
+    json << "  \"reports_per_sec\": " << result.reportsPerSec << ",\n";
+    json << "  \"report_mbps\": " << result.reportMbps << "\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void DtelBench::Show(const DtelBenchResult &result)
+{
+    const DtelCounters &c = result.counters;
+
+    printf("\t--- --- --- --- --- --- --- DTEL --- --- --- --- --- --- ---\n");
+    printf("\t%llu observations, %llu reports (%llu flow, %llu queue, %llu drop), %llu unrouted\n",
+           (unsigned long long)c.observations, (unsigned long long)c.reports,
+           (unsigned long long)c.flowReports, (unsigned long long)c.queueReports,
+           (unsigned long long)c.dropReports, (unsigned long long)c.unrouted);
+    printf("\tsuppressed %llu by flow state, %llu by drop state, %llu by quota; %llu clear cycles\n",
+           (unsigned long long)c.flowSuppressed, (unsigned long long)c.dropSuppressed,
+           (unsigned long long)c.quotaSuppressed, (unsigned long long)c.clears);
+    printf("\t%llu datagrams (%s), %llu dropped on send, collector %llu received, %llu decode errors\n",
+           (unsigned long long)c.datagrams, result.gso ? "gso" : "no gso", (unsigned long long)c.sendDrops,
+           (unsigned long long)result.received, (unsigned long long)result.decodeErrors);
+    printf("\t%.0f observations/s per core (%.1f ns each), %.4f reports per observation\n",
+           result.observationsPerSec, result.nsPerObservation, result.reportsPerObservation);
+    printf("\tat the profile rate the collectors absorb %.0f reports/s, %.1f Mbps\n",
+           result.reportsPerSec, result.reportMbps);
+    printf("\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- ---\n");
+}
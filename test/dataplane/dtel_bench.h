@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "dtel.h"
+
+// DTEL profile, parsed from "key=value,..." (see DtelProfile::Parse):
+//   observations   packets run through the engine
+//   rate           packets per second of switch traffic they stand for
+//   flows          distinct 5-tuples, a fifth of them carry 80% of packets
+//   watch          percent of flows on the flow watchlist
+//   ports          egress ports
+//   queues         queues per port, each with a queue report
+//   threshold      SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD, bytes
+//   quota          SAI_DTEL_QUEUE_REPORT_ATTR_BREACH_QUOTA
+//   sensitivity    SAI_DTEL_ATTR_LATENCY_SENSITIVITY
+//   clear          SAI_DTEL_ATTR_FLOW_STATE_CLEAR_CYCLE, seconds
+//   drops          pipeline drops per million packets
+//   collectors     SAI_DTEL_REPORT_SESSION_ATTR_DST_IP_LIST addresses
+//   batch          observations per Process() call
+//   send           1 sends the reports to a loopback collector
+struct DtelProfile
+{
+    uint32_t observations;
+    uint32_t rate;
+    uint32_t flows;
+    uint32_t watch;
+    uint32_t ports;
+    uint32_t queues;
+    uint32_t threshold;
+    uint32_t quota;
+    uint32_t sensitivity;
+    uint32_t clear;
+    uint32_t drops;
+    uint32_t collectors;
+    uint32_t batch;
+    uint32_t send;
+
+    DtelProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+};
+
+struct DtelBenchResult
+{
+    bool gso;
+    DtelCounters counters;
+
+    // at the collector
+    uint64_t received;
+    uint64_t decodeErrors;
+
+    double cpuSeconds;              // of the processing thread, in Process()
+    double observationsPerSec;      // per core
+    double nsPerObservation;
+    double reportsPerObservation;
+    double trafficSeconds;          // the observations at the profile rate
+    double reportsPerSec;           // what the collectors absorb at that rate
+    double reportMbps;              // the same with IPv4 and UDP headers
+};
+
+class DtelBench
+{
+    DtelEngine* m_engine;
+
+public:
+    // the engine's flow state capacity sizes the tables against the
+    // profile's flows; Run() opens it on the loopback when sending
+    explicit DtelBench(DtelEngine* engine);
+
+    // leaves the objects in place
+    bool Run(const DtelProfile &profile, DtelBenchResult &result);
+
+    static std::string ToJson(const DtelProfile &profile, const DtelBenchResult &result);
+    static void Show(const DtelBenchResult &result);
+};
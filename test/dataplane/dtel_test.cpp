@@ -0,0 +1,562 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <vector>
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "dtel.h"
+#include "dtel_bench.h"
+
+#define NS_PER_SEC          1000000000ULL
+#define NS_PER_MS           1000000ULL
+#define SWITCH_ID           7
+#define EGRESS_PORT         3
+#define QUEUE               2
+#define DSCP                10
+
+// the DTEL object, a report session to port and a queue report on
+// EGRESS_PORT/QUEUE
+struct DtelSetup
+{
+    sai_object_id_t dtel;
+    sai_object_id_t session;
+    sai_object_id_t queue;
+    sai_object_id_t queueReport;
+};
+
+static void setup(DtelEngine &engine, DtelSetup &s, uint16_t port, uint16_t truncateSize, uint32_t depthThreshold,
+                  uint32_t breachQuota)
+{
+    sai_attribute_t attrs[6];
+    sai_ip_address_t ip;
+
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(INADDR_LOOPBACK);
+
+    attrs[0].id = SAI_DTEL_ATTR_POSTCARD_ENABLE;
+    attrs[0].value.booldata = true;
+    attrs[1].id = SAI_DTEL_ATTR_QUEUE_REPORT_ENABLE;
+    attrs[1].value.booldata = true;
+    attrs[2].id = SAI_DTEL_ATTR_DROP_REPORT_ENABLE;
+    attrs[2].value.booldata = true;
+    attrs[3].id = SAI_DTEL_ATTR_SWITCH_ID;
+    attrs[3].value.u32 = SWITCH_ID;
+    attrs[4].id = SAI_DTEL_ATTR_FLOW_STATE_CLEAR_CYCLE;
+    attrs[4].value.u16 = 1;
+    attrs[5].id = SAI_DTEL_ATTR_LATENCY_SENSITIVITY;
+    attrs[5].value.u8 = 10;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_DTEL, s.dtel, 6, attrs));
+
+    attrs[0].id = SAI_DTEL_REPORT_SESSION_ATTR_DST_IP_LIST;
+    attrs[0].value.ipaddrlist.count = 1;
+    attrs[0].value.ipaddrlist.list = &ip;
+    attrs[1].id = SAI_DTEL_REPORT_SESSION_ATTR_UDP_DST_PORT;
+    attrs[1].value.u16 = port;
+    attrs[2].id = SAI_DTEL_REPORT_SESSION_ATTR_TRUNCATE_SIZE;
+    attrs[2].value.u16 = truncateSize;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, s.session, 3, attrs));
+
+    s.queue = dtel_oid(SAI_OBJECT_TYPE_QUEUE, 0);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.AddQueue(s.queue, EGRESS_PORT, QUEUE));
+
+    attrs[0].id = SAI_DTEL_QUEUE_REPORT_ATTR_QUEUE_ID;
+    attrs[0].value.oid = s.queue;
+    attrs[1].id = SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD;
+    attrs[1].value.u32 = depthThreshold;
+    attrs[2].id = SAI_DTEL_QUEUE_REPORT_ATTR_BREACH_QUOTA;
+    attrs[2].value.u32 = breachQuota;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, s.queueReport, 3, attrs));
+}
+
+static sai_status_t create_event(DtelEngine &engine, sai_object_id_t &oid, sai_dtel_event_type_t type,
+                                 sai_object_id_t session)
+{
+    sai_attribute_t attrs[3];
+
+    attrs[0].id = SAI_DTEL_EVENT_ATTR_TYPE;
+    attrs[0].value.s32 = type;
+    attrs[1].id = SAI_DTEL_EVENT_ATTR_REPORT_SESSION;
+    attrs[1].value.oid = session;
+    attrs[2].id = SAI_DTEL_EVENT_ATTR_DSCP_VALUE;
+    attrs[2].value.u8 = DSCP;
+
+    return engine.Create(SAI_OBJECT_TYPE_DTEL_EVENT, oid, 3, attrs);
+}
+
+// a watched packet of flow f through EGRESS_PORT/QUEUE with an empty queue
+static DtelObservation observation(uint32_t f, uint64_t timestampNs)
+{
+    DtelObservation o;
+
+    memset(&o, 0, sizeof(o));
+    o.timestampNs = timestampNs;
+    o.srcIp = 0x0A000001 + f;
+    o.dstIp = 0x0A010001;
+    o.srcPort = (uint16_t)(1000 + f);
+    o.dstPort = 80;
+    o.protocol = IPPROTO_TCP;
+    o.ingressPort = 1;
+    o.egressPort = EGRESS_PORT;
+    o.queue = QUEUE;
+    o.latencyNs = 100;
+    o.flags = DTEL_OBS_FLOW_WATCH;
+
+    return o;
+}
+
+TEST(dtel, attributes)
+{
+    DtelEngine engine(16);
+    DtelSetup s;
+    sai_object_id_t oid;
+    sai_attribute_t attr;
+
+    setup(engine, s, 9, 0, 1000, 0);
+
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.Create(SAI_OBJECT_TYPE_DTEL, oid, 0, NULL));
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.AddQueue(s.queue, 4, 0));
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.AddQueue(dtel_oid(SAI_OBJECT_TYPE_QUEUE, 1), EGRESS_PORT, QUEUE));
+    ASSERT_EQ(SAI_STATUS_INVALID_PARAMETER, engine.AddQueue(dtel_oid(SAI_OBJECT_TYPE_QUEUE, 1), 0,
+                                                            DTEL_QUEUES_PER_PORT));
+
+    attr.id = SAI_DTEL_ATTR_LATENCY_SENSITIVITY;
+    attr.value.u8 = 32;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, engine.Set(s.dtel, &attr));
+    attr.id = SAI_DTEL_ATTR_END;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(s.dtel, &attr));
+
+    // one queue report a queue, QUEUE_ID is create only
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD;
+    attr.value.u32 = 10;
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, 1, &attr));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.queueReport, &attr));
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_QUEUE_ID;
+    attr.value.oid = s.queue;
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.Create(SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, 1, &attr));
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(s.queueReport, &attr));
+    attr.value.oid = dtel_oid(SAI_OBJECT_TYPE_QUEUE, 9);
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, engine.Create(SAI_OBJECT_TYPE_DTEL_QUEUE_REPORT, oid, 1, &attr));
+
+    sai_ip_address_t ip;
+
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV6;
+    attr.id = SAI_DTEL_REPORT_SESSION_ATTR_DST_IP_LIST;
+    attr.value.ipaddrlist.count = 1;
+    attr.value.ipaddrlist.list = &ip;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(SAI_OBJECT_TYPE_DTEL_REPORT_SESSION, oid, 1, &attr));
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Set(s.session, &attr));
+
+    // an event a type, TYPE is create only and checked
+    sai_object_id_t event;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, event, SAI_DTEL_EVENT_TYPE_FLOW_STATE, s.session));
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, create_event(engine, oid, SAI_DTEL_EVENT_TYPE_FLOW_STATE, s.session));
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, create_event(engine, oid, SAI_DTEL_EVENT_TYPE_MAX, s.session));
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 1, create_event(engine, oid, SAI_DTEL_EVENT_TYPE_DROP_REPORT,
+                                                                s.queueReport));
+    attr.id = SAI_DTEL_EVENT_ATTR_TYPE;
+    attr.value.s32 = SAI_DTEL_EVENT_TYPE_DROP_REPORT;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(event, &attr));
+    attr.id = SAI_DTEL_EVENT_ATTR_DSCP_VALUE;
+    attr.value.u8 = 64;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, engine.Set(event, &attr));
+    attr.id = SAI_DTEL_EVENT_ATTR_REPORT_SESSION;
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(SAI_OBJECT_TYPE_DTEL_EVENT, oid, 0, NULL));
+
+    // INT sessions are held for their oid
+    sai_object_id_t intSession;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_DTEL_INT_SESSION, intSession, 0, NULL));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(intSession));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(intSession));
+
+    // the session stays while an event reports to it
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.session));
+    attr.value.oid = SAI_NULL_OBJECT_ID;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(event, &attr));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.session));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(event));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(event));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.queueReport));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.dtel));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(s.dtel));
+    ASSERT_EQ(SAI_STATUS_INVALID_OBJECT_TYPE, engine.Remove(s.queue));
+}
+
+TEST(dtel, report_format)
+{
+    DtelReport report = DtelReport();
+    DtelReport decoded;
+    uint8_t buf[DTEL_REPORT_MAX_LEN + 1];
+
+    report.nextProto = DTEL_NEXT_PROTO_SWITCH_LOCAL;
+    report.flags = DTEL_REPORT_QUEUE | DTEL_REPORT_FLOW;
+    report.hwId = 5;
+    report.sequence = 0x01020304;
+    report.ingressTimestamp = 0xA0B0C0D0;
+    report.switchId = SWITCH_ID;
+    report.ingressPort = 1;
+    report.egressPort = 2;
+    report.queue = 3;
+    report.queueOccupancy = 0x1FFFFFF;
+    report.egressTimestamp = 0xA0B0C1D0;
+    report.packetLen = DTEL_PACKET_LEN;
+    report.srcIp = 0x0A000001;
+    report.dstIp = 0x0A000002;
+    report.srcPort = 1234;
+    report.dstPort = 80;
+    report.protocol = IPPROTO_UDP;
+
+    ASSERT_EQ((size_t)DTEL_REPORT_MAX_LEN, dtel_report_encode(report, buf));
+    ASSERT_EQ(0x02, buf[0]);
+    ASSERT_EQ(DTEL_REPORT_QUEUE | DTEL_REPORT_FLOW, buf[1]);
+    ASSERT_TRUE(dtel_report_decode(buf, DTEL_REPORT_MAX_LEN, decoded));
+    ASSERT_EQ(report.flags, decoded.flags);
+    ASSERT_EQ(report.hwId, decoded.hwId);
+    ASSERT_EQ(report.sequence, decoded.sequence);
+    ASSERT_EQ(report.ingressTimestamp, decoded.ingressTimestamp);
+    ASSERT_EQ(report.switchId, decoded.switchId);
+    ASSERT_EQ(report.egressPort, decoded.egressPort);
+    ASSERT_EQ(report.queue, decoded.queue);
+    ASSERT_EQ((uint32_t)DTEL_QUEUE_OCCUPANCY_MAX, decoded.queueOccupancy);
+    ASSERT_EQ(report.egressTimestamp, decoded.egressTimestamp);
+    ASSERT_EQ(report.srcIp, decoded.srcIp);
+    ASSERT_EQ(report.dstPort, decoded.dstPort);
+    ASSERT_EQ(report.protocol, decoded.protocol);
+
+    // a drop report cut to the Ethernet header
+    report.nextProto = DTEL_NEXT_PROTO_DROP;
+    report.flags = DTEL_REPORT_DROP;
+    report.dropReason = 42;
+    report.packetLen = 14;
+
+    size_t len = dtel_report_encode(report, buf);
+
+    ASSERT_EQ((size_t)(DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN + 14), len);
+    ASSERT_TRUE(dtel_report_decode(buf, len, decoded));
+    ASSERT_EQ(DTEL_NEXT_PROTO_DROP, decoded.nextProto);
+    ASSERT_EQ(42, decoded.dropReason);
+    ASSERT_EQ(14, decoded.packetLen);
+    ASSERT_EQ(0u, decoded.srcIp);
+
+    ASSERT_FALSE(dtel_report_decode(buf, DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN - 1, decoded));
+    ASSERT_FALSE(dtel_report_decode(buf, DTEL_REPORT_MAX_LEN + 1, decoded));
+    buf[0] = 0x12;
+    ASSERT_FALSE(dtel_report_decode(buf, len, decoded));
+}
+
+// a full bucket evicts, and an evicted flow is reported again rather
+// than lost
+TEST(dtel, flow_state_table)
+{
+    DtelFlowStateTable table(2);
+
+    ASSERT_EQ(2u, table.Capacity());
+    ASSERT_TRUE(table.Update(1ULL << 32, 1));
+    ASSERT_FALSE(table.Update(1ULL << 32, 1));
+    ASSERT_TRUE(table.Update(1ULL << 32, 2));
+    ASSERT_TRUE(table.Update(2ULL << 32, 1));
+    ASSERT_FALSE(table.Update(1ULL << 32, 2));
+    ASSERT_TRUE(table.Update(3ULL << 32, 1));
+    ASSERT_FALSE(table.Update(2ULL << 32, 1));
+    ASSERT_TRUE(table.Update(1ULL << 32, 2));
+
+    table.Clear();
+    ASSERT_TRUE(table.Update(1ULL << 32, 2));
+    ASSERT_FALSE(table.Update(1ULL << 32, 2));
+}
+
+TEST(dtel, flow_state)
+{
+    DtelEngine engine(1024);
+    DtelSetup s;
+    sai_object_id_t event;
+    sai_attribute_t attr;
+
+    setup(engine, s, 9, 0, 0, 0);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, event, SAI_DTEL_EVENT_TYPE_FLOW_STATE, s.session));
+
+    // new flows report, repeats within the latency sensitivity don't
+    DtelObservation obs[4] = { observation(0, 0), observation(1, 1), observation(0, 2), observation(1, 3) };
+
+    obs[2].latencyNs = 1000;
+    ASSERT_EQ(2u, engine.Process(obs, 4));
+    ASSERT_EQ(2u, engine.GetCounters().flowSuppressed);
+
+    // a latency past it or a new path reports
+    obs[0].latencyNs = 1024;
+    obs[1].egressPort = EGRESS_PORT + 1;
+    obs[2].flags = 0;
+    obs[3].egressPort = EGRESS_PORT + 1;
+    obs[3].latencyNs = 1023;
+    ASSERT_EQ(2u, engine.Process(obs, 4));
+
+    // the cycle clears the table
+    for (int i = 0; i < 4; i++)
+    {
+        obs[i].timestampNs = NS_PER_SEC + i;
+    }
+
+    ASSERT_EQ(2u, engine.Process(obs, 4));
+    ASSERT_EQ(1u, engine.GetCounters().clears);
+
+    // neither postcard nor INT endpoint, no flow reports
+    attr.id = SAI_DTEL_ATTR_POSTCARD_ENABLE;
+    attr.value.booldata = false;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.dtel, &attr));
+    obs[0].latencyNs = 1 << 20;
+    ASSERT_EQ(0u, engine.Process(obs, 1));
+    attr.id = SAI_DTEL_ATTR_INT_ENDPOINT_ENABLE;
+    attr.value.booldata = true;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.dtel, &attr));
+    ASSERT_EQ(1u, engine.Process(obs, 1));
+
+    // report all packets and TCP flags go around the table
+    sai_object_id_t all;
+    sai_object_id_t tcp;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, all, SAI_DTEL_EVENT_TYPE_FLOW_REPORT_ALL_PACKETS, s.session));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, tcp, SAI_DTEL_EVENT_TYPE_FLOW_TCPFLAG, s.session));
+    obs[0].flags |= DTEL_OBS_REPORT_ALL;
+    obs[1].tcpFlags = DTEL_TCP_FIN;
+    ASSERT_EQ(2u, engine.Process(obs, 2));
+    ASSERT_EQ(2u, engine.Process(obs, 2));
+
+    const DtelCounters &c = engine.GetCounters();
+
+    ASSERT_EQ(c.reports, c.flowReports);
+    ASSERT_EQ(0u, c.queueReports + c.dropReports + c.unrouted);
+}
+
+TEST(dtel, queue_reports)
+{
+    DtelEngine engine(1024);
+    DtelSetup s;
+    sai_object_id_t breach;
+    sai_object_id_t tail;
+    sai_object_id_t drop;
+    sai_attribute_t attr;
+
+    setup(engine, s, 9, 0, 1000, 3);
+    ASSERT_EQ(SAI_STATUS_SUCCESS,
+              create_event(engine, breach, SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_THRESHOLD_BREACH, s.session));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, tail, SAI_DTEL_EVENT_TYPE_QUEUE_REPORT_TAIL_DROP, s.session));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, drop, SAI_DTEL_EVENT_TYPE_DROP_REPORT, s.session));
+
+    // a breach reports up to the quota and rearms under the threshold
+    std::vector<DtelObservation> obs;
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        obs.push_back(observation(i, i));
+        obs.back().queueDepth = i == 5 ? 1000 : 1001;
+    }
+
+    ASSERT_EQ(6u, engine.Process(obs.data(), (uint32_t)obs.size()));
+    ASSERT_EQ(3u, engine.GetCounters().quotaSuppressed);
+
+    // the latency threshold breaches as well, a quota of 0 has no limit
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_DEPTH_THRESHOLD;
+    attr.value.u32 = 0;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.queueReport, &attr));
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_LATENCY_THRESHOLD;
+    attr.value.u32 = 99;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.queueReport, &attr));
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_BREACH_QUOTA;
+    attr.value.u32 = 0;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.queueReport, &attr));
+    ASSERT_EQ(10u, engine.Process(obs.data(), (uint32_t)obs.size()));
+
+    // tail drops report once the queue asks for them
+    obs.resize(2);
+    obs[0].flags |= DTEL_OBS_TAIL_DROP;
+    obs[1].flags |= DTEL_OBS_TAIL_DROP;
+    ASSERT_EQ(0u, engine.Process(obs.data(), 2));
+    attr.id = SAI_DTEL_QUEUE_REPORT_ATTR_TAIL_DROP;
+    attr.value.booldata = true;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.queueReport, &attr));
+    ASSERT_EQ(2u, engine.Process(obs.data(), 2));
+
+    // pipeline drops of the drop watchlist, once per flow and reason
+    obs[0] = observation(0, 10);
+    obs[0].dropReason = 1;
+    obs[0].flags = DTEL_OBS_DROP_WATCH;
+    obs[1] = obs[0];
+    ASSERT_EQ(1u, engine.Process(obs.data(), 2));
+    obs[1].dropReason = 2;
+    ASSERT_EQ(1u, engine.Process(obs.data(), 2));
+    ASSERT_EQ(2u, engine.GetCounters().dropSuppressed);
+
+    attr.id = SAI_DTEL_ATTR_DROP_REPORT_ENABLE;
+    attr.value.booldata = false;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(s.dtel, &attr));
+    obs[1].dropReason = 3;
+    ASSERT_EQ(0u, engine.Process(obs.data(), 2));
+
+    const DtelCounters &c = engine.GetCounters();
+
+    ASSERT_EQ(6u + 10 + 2, c.queueReports);
+    ASSERT_EQ(2u + 2, c.dropReports);
+    ASSERT_EQ(0u, c.flowReports);
+}
+
+// reports on the wire: one per reported packet, truncated, in sequence
+// and with the event's DSCP
+TEST(dtel, export)
+{
+    struct sockaddr_in sin;
+    socklen_t sinLen = sizeof(sin);
+    struct timeval tv = { 1, 0 };
+    int size = 4 * 1024 * 1024;
+    int on = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    ASSERT_GE(fd, 0);
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(fd, (struct sockaddr*)&sin, sizeof(sin)));
+    ASSERT_EQ(0, getsockname(fd, (struct sockaddr*)&sin, &sinLen));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(fd, IPPROTO_IP, IP_RECVTOS, &on, sizeof(on));
+
+    const uint32_t flows = 600;
+    const uint16_t truncateSize = 34;
+    DtelEngine engine(4096);
+    DtelSetup s;
+    sai_object_id_t event;
+    std::vector<DtelObservation> obs;
+
+    ASSERT_TRUE(engine.Open("127.0.0.1", 0));
+    setup(engine, s, ntohs(sin.sin_port), truncateSize, 0, 0);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_event(engine, event, SAI_DTEL_EVENT_TYPE_FLOW_STATE, s.session));
+
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        obs.push_back(observation(f, f * NS_PER_MS));
+        obs.back().queueDepth = f;
+    }
+
+    ASSERT_EQ(flows, engine.Process(obs.data(), flows));
+    ASSERT_EQ(flows, engine.GetCounters().datagrams);
+    ASSERT_EQ(0u, engine.GetCounters().sendDrops);
+
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        uint8_t buf[DTEL_REPORT_MAX_LEN + 1];
+        uint8_t control[64];
+        struct iovec iov = { buf, sizeof(buf) };
+        struct msghdr msg;
+        DtelReport report;
+        int tos = -1;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t len = recvmsg(fd, &msg, 0);
+
+        ASSERT_EQ(DTEL_REPORT_HEADER_LEN + DTEL_LOCAL_HEADER_LEN + truncateSize, len);
+        ASSERT_TRUE(dtel_report_decode(buf, (size_t)len, report));
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS)
+            {
+                tos = *(uint8_t*)CMSG_DATA(cmsg);
+            }
+        }
+
+        ASSERT_EQ(DSCP << 2, tos);
+        ASSERT_EQ(DTEL_NEXT_PROTO_SWITCH_LOCAL, report.nextProto);
+        ASSERT_EQ(DTEL_REPORT_FLOW, report.flags);
+        ASSERT_EQ(f, report.sequence);
+        ASSERT_EQ((uint32_t)(f * NS_PER_MS), report.ingressTimestamp);
+        ASSERT_EQ((uint32_t)(f * NS_PER_MS + 100), report.egressTimestamp);
+        ASSERT_EQ((uint32_t)SWITCH_ID, report.switchId);
+        ASSERT_EQ(EGRESS_PORT, report.egressPort);
+        ASSERT_EQ(QUEUE, report.queue);
+        ASSERT_EQ(f, report.queueOccupancy);
+        ASSERT_EQ(truncateSize, report.packetLen);
+    }
+
+    // an event without a session has nowhere to send
+    sai_attribute_t attr;
+
+    attr.id = SAI_DTEL_EVENT_ATTR_REPORT_SESSION;
+    attr.value.oid = SAI_NULL_OBJECT_ID;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(event, &attr));
+    obs[0].latencyNs = 1 << 20;
+    ASSERT_EQ(1u, engine.Process(obs.data(), 1));
+    ASSERT_EQ(1u, engine.GetCounters().unrouted);
+    ASSERT_EQ(flows, engine.GetCounters().datagrams);
+
+    close(fd);
+}
+
+// profile from DATAPLANE_DTEL_BENCH ("observations=..,flows=..,clear=.."),
+// the JSON report goes to DATAPLANE_DTEL_BENCH_JSON when it is set
+TEST(dtel, bench)
+{
+    DtelProfile profile;
+    DtelBenchResult result;
+    const char *env = getenv("DATAPLANE_DTEL_BENCH");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    // twice the flows keeps evictions rare
+    DtelEngine engine(profile.flows * 2);
+    DtelBench bench(&engine);
+
+    bool ok = bench.Run(profile, result);
+    DtelBench::Show(result);
+
+    std::string json = DtelBench::ToJson(profile, result);
+    const char *jsonPath = getenv("DATAPLANE_DTEL_BENCH_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+}
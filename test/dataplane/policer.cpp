@@ -0,0 +1,554 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include <string.h>
+
+#include "policer.h"
+
+PolicerConfig::PolicerConfig()
+{
+    meterType = SAI_METER_TYPE_PACKETS;
+    mode = SAI_POLICER_MODE_SR_TCM;
+    colorSource = SAI_POLICER_COLOR_SOURCE_AWARE;
+    cbs = 0;
+    cir = 0;
+    pbs = 0;
+    pir = 0;
+    action[SAI_PACKET_COLOR_GREEN] = SAI_PACKET_ACTION_FORWARD;
+    action[SAI_PACKET_COLOR_YELLOW] = SAI_PACKET_ACTION_FORWARD;
+    action[SAI_PACKET_COLOR_RED] = SAI_PACKET_ACTION_FORWARD;
+}
+
+static bool valid_packet_action(int32_t action)
+{
+    return action >= SAI_PACKET_ACTION_DROP && action <= SAI_PACKET_ACTION_DONOTDROP;
+}
+
+static sai_status_t parse_attrs(PolicerConfig &config,
+                                uint32_t attr_count,
+                                const sai_attribute_t *attr_list,
+                                bool create)
+{
+    bool hasMeterType = false;
+    bool hasMode = false;
+    uint32_t rateIndex = 0;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_POLICER_ATTR_METER_TYPE:
+            case SAI_POLICER_ATTR_MODE:
+            case SAI_POLICER_ATTR_COLOR_SOURCE:
+            case SAI_POLICER_ATTR_OBJECT_STAGE:
+                if (!create)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+
+        switch (attr.id)
+        {
+            case SAI_POLICER_ATTR_METER_TYPE:
+                if (attr.value.s32 != SAI_METER_TYPE_PACKETS && attr.value.s32 != SAI_METER_TYPE_BYTES)
+                {
+                    return badValue;
+                }
+                config.meterType = (sai_meter_type_t)attr.value.s32;
+                hasMeterType = true;
+                break;
+
+            case SAI_POLICER_ATTR_MODE:
+                if (attr.value.s32 < SAI_POLICER_MODE_SR_TCM || attr.value.s32 > SAI_POLICER_MODE_STORM_CONTROL)
+                {
+                    return badValue;
+                }
+                config.mode = (sai_policer_mode_t)attr.value.s32;
+                hasMode = true;
+                break;
+
+            case SAI_POLICER_ATTR_COLOR_SOURCE:
+                if (attr.value.s32 != SAI_POLICER_COLOR_SOURCE_BLIND && attr.value.s32 != SAI_POLICER_COLOR_SOURCE_AWARE)
+                {
+                    return badValue;
+                }
+                config.colorSource = (sai_policer_color_source_t)attr.value.s32;
+                break;
+
+            case SAI_POLICER_ATTR_CBS:
+                config.cbs = attr.value.u64;
+                break;
+
+            case SAI_POLICER_ATTR_CIR:
+                config.cir = attr.value.u64;
+                rateIndex = i;
+                break;
+
+            case SAI_POLICER_ATTR_PBS:
+                config.pbs = attr.value.u64;
+                break;
+
+            case SAI_POLICER_ATTR_PIR:
+                config.pir = attr.value.u64;
+                rateIndex = i;
+                break;
+
+            case SAI_POLICER_ATTR_GREEN_PACKET_ACTION:
+            case SAI_POLICER_ATTR_YELLOW_PACKET_ACTION:
+            case SAI_POLICER_ATTR_RED_PACKET_ACTION:
+                if (!valid_packet_action(attr.value.s32))
+                {
+                    return badValue;
+                }
+                config.action[attr.id - SAI_POLICER_ATTR_GREEN_PACKET_ACTION] = (sai_packet_action_t)attr.value.s32;
+                break;
+
+            case SAI_POLICER_ATTR_ENABLE_COUNTER_PACKET_ACTION_LIST:
+                if (attr.value.s32list.count && attr.value.s32list.list == NULL)
+                {
+                    return badValue;
+                }
+
+                config.counterActions.clear();
+
+                for (uint32_t j = 0; j < attr.value.s32list.count; j++)
+                {
+                    if (!valid_packet_action(attr.value.s32list.list[j]))
+                    {
+                        return badValue;
+                    }
+                    config.counterActions.push_back((sai_packet_action_t)attr.value.s32list.list[j]);
+                }
+                break;
+
+            case SAI_POLICER_ATTR_OBJECT_STAGE:
+                if (attr.value.s32 < SAI_OBJECT_STAGE_BOTH || attr.value.s32 > SAI_OBJECT_STAGE_EGRESS)
+                {
+                    return badValue;
+                }
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    if (create && (!hasMeterType || !hasMode))
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    // RFC 2698 requires PIR >= CIR, blame whichever rate came last
+    if (config.mode == SAI_POLICER_MODE_TR_TCM && config.pir < config.cir)
+    {
+        return SAI_STATUS_INVALID_ATTR_VALUE_0 + rateIndex;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+PolicerEngine::PolicerEngine(uint32_t capacity) :
+    m_capacity(capacity),
+    m_count(0),
+    m_lastRefillNs(0),
+    m_cir(capacity),
+    m_pir(capacity),
+    m_overflow(capacity),
+    m_cbs(capacity),
+    m_pbs(capacity),
+    m_tc(capacity),
+    m_te(capacity),
+    m_info(capacity),
+    m_counters(capacity),
+    m_config(capacity)
+{
+    m_free.reserve(capacity);
+
+    // lowest index first
+    for (uint32_t i = capacity; i > 0; i--)
+    {
+        m_free.push_back(i - 1);
+    }
+}
+
+void PolicerEngine::Store(uint32_t index, const PolicerConfig &config, bool create)
+{
+    MeterInfo &info = m_info[index];
+
+    m_config[index] = config;
+
+    info.mode = (uint8_t)config.mode;
+    info.bytes = config.meterType == SAI_METER_TYPE_BYTES;
+    info.aware = config.colorSource == SAI_POLICER_COLOR_SOURCE_AWARE &&
+                 config.mode != SAI_POLICER_MODE_STORM_CONTROL;
+
+    m_cir[index] = (double)config.cir;
+    m_cbs[index] = (double)config.cbs;
+
+    // storm control has no second bucket, SR_TCM fills E from C only
+    m_pir[index] = config.mode == SAI_POLICER_MODE_TR_TCM ? (double)config.pir : 0;
+    m_pbs[index] = config.mode == SAI_POLICER_MODE_STORM_CONTROL ? 0 : (double)config.pbs;
+    m_overflow[index] = config.mode == SAI_POLICER_MODE_SR_TCM ? 1 : 0;
+
+    m_tc[index] = create ? m_cbs[index] : std::min(m_tc[index], m_cbs[index]);
+    m_te[index] = create ? m_pbs[index] : std::min(m_te[index], m_pbs[index]);
+
+    info.countMask = 0;
+
+    for (uint32_t color = SAI_PACKET_COLOR_GREEN; color <= SAI_PACKET_COLOR_RED; color++)
+    {
+        info.action[color] = (uint8_t)config.action[color];
+
+        if (std::find(config.counterActions.begin(), config.counterActions.end(), config.action[color]) !=
+            config.counterActions.end())
+        {
+            info.countMask |= (uint8_t)(1 << color);
+        }
+    }
+}
+
+sai_status_t PolicerEngine::Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (m_free.empty())
+    {
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    PolicerConfig config;
+    sai_status_t status = parse_attrs(config, attr_count, attr_list, true);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    index = m_free.back();
+    m_free.pop_back();
+    m_count++;
+
+    Store(index, config, true);
+    memset(&m_counters[index], 0, sizeof(PolicerCounters));
+    m_info[index].used = 1;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t PolicerEngine::Remove(uint32_t index)
+{
+    if (index >= m_capacity || !m_info[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    // zero rates and sizes keep the slot out of the refill pass results
+    Store(index, PolicerConfig(), true);
+    m_info[index].used = 0;
+    m_free.push_back(index);
+    m_count--;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t PolicerEngine::Set(uint32_t index, const sai_attribute_t *attr)
+{
+    if (index >= m_capacity || !m_info[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    PolicerConfig config = m_config[index];
+    sai_status_t status = parse_attrs(config, 1, attr, false);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    Store(index, config, false);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t PolicerEngine::GetStats(uint32_t index,
+                                     uint32_t number_of_counters,
+                                     const sai_stat_id_t *counter_ids,
+                                     sai_stats_mode_t mode,
+                                     uint64_t *counters)
+{
+    if (index >= m_capacity || !m_info[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if ((number_of_counters && (counter_ids == NULL || counters == NULL)) ||
+        (mode != SAI_STATS_MODE_READ && mode != SAI_STATS_MODE_READ_AND_CLEAR))
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        if (counter_ids[i] >= POLICER_STAT_COUNT)
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    uint64_t *stat = m_counters[index].stat;
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        if (mode == SAI_STATS_MODE_READ_AND_CLEAR)
+        {
+            counters[i] = __atomic_exchange_n(&stat[counter_ids[i]], 0, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            counters[i] = __atomic_load_n(&stat[counter_ids[i]], __ATOMIC_RELAXED);
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t PolicerEngine::ClearStats(uint32_t index,
+                                       uint32_t number_of_counters,
+                                       const sai_stat_id_t *counter_ids)
+{
+    if (index >= m_capacity || !m_info[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (number_of_counters && counter_ids == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        if (counter_ids[i] >= POLICER_STAT_COUNT)
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        __atomic_store_n(&m_counters[index].stat[counter_ids[i]], 0, __ATOMIC_RELAXED);
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+// branch free so the loop vectorizes: TR_TCM fills P at PIR, SR_TCM fills
+// E with what overflows C, storm control has PIR and PBS at 0
+static void refill_buckets(uint32_t count,
+                           double seconds,
+                           const double *__restrict cir,
+                           const double *__restrict pir,
+                           const double *__restrict overflow,
+                           const double *__restrict cbs,
+                           const double *__restrict pbs,
+                           double *__restrict tc,
+                           double *__restrict te)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double c = tc[i] + cir[i] * seconds;
+        double cNew = c < cbs[i] ? c : cbs[i];
+        double e = te[i] + pir[i] * seconds + overflow[i] * (c - cNew);
+
+        tc[i] = cNew;
+        te[i] = e < pbs[i] ? e : pbs[i];
+    }
+}
+
+void PolicerEngine::Refill(uint64_t nowNs)
+{
+    if (nowNs <= m_lastRefillNs)
+    {
+        return;
+    }
+
+    double seconds = (double)(nowNs - m_lastRefillNs) / 1e9;
+
+    m_lastRefillNs = nowNs;
+
+    refill_buckets(m_capacity, seconds,
+                   m_cir.data(), m_pir.data(), m_overflow.data(), m_cbs.data(), m_pbs.data(),
+                   m_tc.data(), m_te.data());
+}
+
+// lock free, concurrent Meter() calls may take from the same bucket
+static inline bool take_tokens(double *bucket, double cost)
+{
+    double cur;
+
+    __atomic_load(bucket, &cur, __ATOMIC_RELAXED);
+
+    while (cur >= cost)
+    {
+        double next = cur - cost;
+
+        if (__atomic_compare_exchange(bucket, &cur, &next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PolicerEngine::Meter(const PolicerPacket *packets, uint32_t count, PolicerResult *results)
+{
+    // policers of a batch are scattered over the tables, get their lines
+    // in flight before the first one is needed
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t p = packets[i].policer;
+
+        if (p < m_capacity)
+        {
+            __builtin_prefetch(&m_info[p]);
+            __builtin_prefetch(&m_tc[p], 1);
+            __builtin_prefetch(&m_te[p], 1);
+            __builtin_prefetch(&m_counters[p], 1);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const PolicerPacket &pkt = packets[i];
+        uint32_t p = pkt.policer;
+
+        if (p >= m_capacity || !m_info[p].used)
+        {
+            results[i].color = SAI_PACKET_COLOR_GREEN;
+            results[i].action = SAI_PACKET_ACTION_FORWARD;
+            continue;
+        }
+
+        const MeterInfo &info = m_info[p];
+        double cost = info.bytes ? (double)pkt.length : 1.0;
+        sai_packet_color_t in = info.aware ? pkt.color : SAI_PACKET_COLOR_GREEN;
+        sai_packet_color_t color;
+
+        switch (info.mode)
+        {
+            case SAI_POLICER_MODE_SR_TCM:
+                // RFC 2697: C for green, then E for green or yellow
+                if (in == SAI_PACKET_COLOR_GREEN && take_tokens(&m_tc[p], cost))
+                {
+                    color = SAI_PACKET_COLOR_GREEN;
+                }
+                else if (in != SAI_PACKET_COLOR_RED && take_tokens(&m_te[p], cost))
+                {
+                    color = SAI_PACKET_COLOR_YELLOW;
+                }
+                else
+                {
+                    color = SAI_PACKET_COLOR_RED;
+                }
+                break;
+
+            case SAI_POLICER_MODE_TR_TCM:
+                // RFC 2698: P first, C only for green, P stays taken if C fails
+                if (in == SAI_PACKET_COLOR_RED || !take_tokens(&m_te[p], cost))
+                {
+                    color = SAI_PACKET_COLOR_RED;
+                }
+                else if (in == SAI_PACKET_COLOR_GREEN && take_tokens(&m_tc[p], cost))
+                {
+                    color = SAI_PACKET_COLOR_GREEN;
+                }
+                else
+                {
+                    color = SAI_PACKET_COLOR_YELLOW;
+                }
+                break;
+
+            default:
+                color = take_tokens(&m_tc[p], cost) ? SAI_PACKET_COLOR_GREEN : SAI_PACKET_COLOR_RED;
+                break;
+        }
+
+        results[i].color = color;
+        results[i].action = (sai_packet_action_t)info.action[color];
+
+        uint64_t *stat = m_counters[p].stat;
+
+        __atomic_fetch_add(&stat[SAI_POLICER_STAT_PACKETS], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stat[SAI_POLICER_STAT_ATTR_BYTES], pkt.length, __ATOMIC_RELAXED);
+
+        if (info.countMask & (1 << color))
+        {
+            __atomic_fetch_add(&stat[SAI_POLICER_STAT_GREEN_PACKETS + 2 * color], 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&stat[SAI_POLICER_STAT_GREEN_BYTES + 2 * color], pkt.length, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+uint32_t PolicerEngine::Size() const
+{
+    return m_count;
+}
+
+uint32_t PolicerEngine::Capacity() const
+{
+    return m_capacity;
+}
+
+const PolicerConfig* PolicerEngine::GetConfig(uint32_t index) const
+{
+    if (index >= m_capacity || !m_info[index].used)
+    {
+        return NULL;
+    }
+
+    return &m_config[index];
+}
+
+double PolicerEngine::GetCommittedTokens(uint32_t index) const
+{
+    return index < m_capacity ? m_tc[index] : 0;
+}
+
+double PolicerEngine::GetExcessTokens(uint32_t index) const
+{
+    return index < m_capacity ? m_te[index] : 0;
+}
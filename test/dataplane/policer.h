@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+#define POLICER_STAT_COUNT      (SAI_POLICER_STAT_RED_BYTES + 1)
+
+// one metered packet; color is the incoming color, only looked at by
+// color aware policers
+struct PolicerPacket
+{
+    uint32_t policer;
+    uint32_t length;
+    sai_packet_color_t color;
+};
+
+struct PolicerResult
+{
+    sai_packet_color_t color;
+    sai_packet_action_t action;
+};
+
+// SAI_POLICER_ATTR_* of one policer
+struct PolicerConfig
+{
+    sai_meter_type_t meterType;
+    sai_policer_mode_t mode;
+    sai_policer_color_source_t colorSource;
+    uint64_t cbs;
+    uint64_t cir;
+    uint64_t pbs;
+    uint64_t pir;
+    sai_packet_action_t action[SAI_PACKET_COLOR_RED + 1];
+    std::vector<sai_packet_action_t> counterActions;
+
+    PolicerConfig();
+};
+
+// indexed by sai_policer_stat_t, one cache line per policer
+struct PolicerCounters
+{
+    uint64_t stat[POLICER_STAT_COUNT];
+} __attribute__((aligned(64)));
+
+// Software model of saipolicer.h:
+//   SR_TCM         RFC 2697, C bucket (CIR/CBS) overflowing into E (PBS)
+//   TR_TCM         RFC 2698, C bucket (CIR/CBS) and P bucket (PIR/PBS)
+//   STORM_CONTROL  single C bucket, non-conforming packets are red
+//
+// CIR/PIR are bytes or packets per second and CBS/PBS bytes or packets,
+// following SAI_POLICER_ATTR_METER_TYPE. Buckets start full.
+//
+// Bucket levels are kept as arrays across all policers and are refilled
+// by Refill() in one pass, like the periodic meter refresh of a switch
+// ASIC, so the pass vectorizes over policers. Meter() only takes tokens,
+// with a compare-and-swap per bucket, and may run on any number of threads
+// at once. Create(), Remove(), Set() and Refill() must not run concurrently
+// with each other or with Meter().
+class PolicerEngine
+{
+    uint32_t m_capacity;
+    uint32_t m_count;
+    uint64_t m_lastRefillNs;
+
+    std::vector<uint32_t> m_free;
+
+    // refill pass, one entry per policer
+    std::vector<double> m_cir;
+    std::vector<double> m_pir;      // 0 unless TR_TCM
+    std::vector<double> m_overflow; // 1 for SR_TCM, C bucket overflows into E
+    std::vector<double> m_cbs;
+    std::vector<double> m_pbs;
+    std::vector<double> m_tc;
+    std::vector<double> m_te;       // E bucket for SR_TCM, P bucket for TR_TCM
+
+    // metering, the per packet lookups of a policer share one word
+    struct MeterInfo
+    {
+        uint8_t used;
+        uint8_t mode;
+        uint8_t bytes;
+        uint8_t aware;
+        uint8_t countMask;          // colors counted by the color stats
+        uint8_t action[SAI_PACKET_COLOR_RED + 1];
+    };
+
+    std::vector<MeterInfo> m_info;
+    std::vector<PolicerCounters> m_counters;
+
+    std::vector<PolicerConfig> m_config;
+
+    void Store(uint32_t index, const PolicerConfig &config, bool create);
+
+public:
+    explicit PolicerEngine(uint32_t capacity);
+
+    // attributes as passed to create_policer()/set_policer_attribute(),
+    // failures are reported with the SAI status codes
+    sai_status_t Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t Remove(uint32_t index);
+    sai_status_t Set(uint32_t index, const sai_attribute_t *attr);
+
+    sai_status_t GetStats(uint32_t index,
+                          uint32_t number_of_counters,
+                          const sai_stat_id_t *counter_ids,
+                          sai_stats_mode_t mode,
+                          uint64_t *counters);
+    sai_status_t ClearStats(uint32_t index,
+                            uint32_t number_of_counters,
+                            const sai_stat_id_t *counter_ids);
+
+    // adds the tokens accumulated since the previous call
+    void Refill(uint64_t nowNs);
+
+    // packets of unused policers come back green and forwarded
+    void Meter(const PolicerPacket *packets, uint32_t count, PolicerResult *results);
+
+    uint32_t Size() const;
+    uint32_t Capacity() const;
+
+    const PolicerConfig* GetConfig(uint32_t index) const;
+
+    // current bucket levels, for tests
+    double GetCommittedTokens(uint32_t index) const;
+    double GetExcessTokens(uint32_t index) const;
+};
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <stdio.h>
+
+#include "bench_util.h"
+#include "policer_bench.h"
+
+PolicerProfile::PolicerProfile()
+{
+    policers = 100000;
+    packets = 200000;
+    rounds = 100;
+    refreshUs = 100;
+    threads = 1;
+    batch = 64;
+    aware = 0;
+    seed = 1;
+}
+
+void PolicerProfile::Parse(const std::string &profile)
+{
+    BenchProfileItems items = bench_profile_split(profile);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const std::string &key = items[i].first;
+        uint32_t value = bench_parse_uint(key, items[i].second);
+
+        if (key == "policers")
+        {
+            policers = value;
+        }
+        else if (key == "packets")
+        {
+            packets = value;
+        }
+        else if (key == "rounds")
+        {
+            rounds = value;
+        }
+        else if (key == "refresh")
+        {
+            refreshUs = value;
+        }
+        else if (key == "threads")
+        {
+            threads = value;
+        }
+        else if (key == "batch")
+        {
+            batch = value;
+        }
+        else if (key == "aware")
+        {
+            aware = value;
+        }
+        else if (key == "seed")
+        {
+            seed = value;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown policer profile key " + key);
+        }
+    }
+
+    if (policers == 0 || threads == 0 || batch == 0)
+    {
+        throw std::invalid_argument("policers, threads and batch must be non zero");
+    }
+}
+
+PolicerBench::PolicerBench(PolicerEngine* engine) :
+    m_engine(engine)
+{
+}
+
+static sai_status_t create_policer(PolicerEngine *engine, uint32_t &index, sai_policer_mode_t mode,
+                                   bool aware, uint64_t cir, uint64_t burst)
+{
+    static const int32_t countAll[] = { SAI_PACKET_ACTION_FORWARD, SAI_PACKET_ACTION_DROP };
+    sai_attribute_t attrs[9];
+    uint32_t count = 0;
+
+    attrs[count].id = SAI_POLICER_ATTR_METER_TYPE;
+    attrs[count++].value.s32 = SAI_METER_TYPE_BYTES;
+    attrs[count].id = SAI_POLICER_ATTR_MODE;
+    attrs[count++].value.s32 = mode;
+    attrs[count].id = SAI_POLICER_ATTR_COLOR_SOURCE;
+    attrs[count++].value.s32 = aware ? SAI_POLICER_COLOR_SOURCE_AWARE : SAI_POLICER_COLOR_SOURCE_BLIND;
+    attrs[count].id = SAI_POLICER_ATTR_CIR;
+    attrs[count++].value.u64 = cir;
+    attrs[count].id = SAI_POLICER_ATTR_CBS;
+    attrs[count++].value.u64 = burst;
+    attrs[count].id = SAI_POLICER_ATTR_PIR;
+    attrs[count++].value.u64 = 2 * cir;
+    attrs[count].id = SAI_POLICER_ATTR_PBS;
+    attrs[count++].value.u64 = 2 * burst;
+    attrs[count].id = SAI_POLICER_ATTR_RED_PACKET_ACTION;
+    attrs[count++].value.s32 = SAI_PACKET_ACTION_DROP;
+    attrs[count].id = SAI_POLICER_ATTR_ENABLE_COUNTER_PACKET_ACTION_LIST;
+    attrs[count].value.s32list.count = 2;
+    attrs[count++].value.s32list.list = (int32_t*)countAll;
+
+    return engine->Create(index, count, attrs);
+}
+
+// green and green plus yellow bytes against what the buckets allow
+static bool policer_conforms(const PolicerConfig &config, const uint64_t *stat, double seconds)
+{
+    double green = (double)stat[SAI_POLICER_STAT_GREEN_BYTES];
+    double passed = green + (double)stat[SAI_POLICER_STAT_YELLOW_BYTES];
+    double committed = config.cbs + config.cir * seconds;
+    double slack = 1e-6 * committed + 1;
+
+    switch (config.mode)
+    {
+        case SAI_POLICER_MODE_SR_TCM:
+            return green <= committed + slack && passed <= committed + config.pbs + slack;
+
+        case SAI_POLICER_MODE_TR_TCM:
+            return green <= committed + slack && passed <= config.pbs + config.pir * seconds + slack;
+
+        default:
+            return passed <= committed + slack;
+    }
+}
+
+bool PolicerBench::Run(const PolicerProfile &profile, PolicerBenchResult &result)
+{
+    std::mt19937 rng(profile.seed);
+    std::vector<uint32_t> policers(profile.policers);
+    std::vector<PolicerPacket> packets(profile.packets);
+    uint64_t start;
+
+    result = PolicerBenchResult();
+
+    // CIR between a quarter and 1.25 times the offered load (packets of
+    // 782 bytes on average) so all three colors show up
+    double offeredPerPolicer = (double)profile.packets / profile.policers * 782 * 1e6 / profile.refreshUs;
+
+    start = bench_now_ns();
+
+    for (uint32_t i = 0; i < profile.policers; i++)
+    {
+        static const sai_policer_mode_t modes[] =
+            { SAI_POLICER_MODE_SR_TCM, SAI_POLICER_MODE_TR_TCM, SAI_POLICER_MODE_STORM_CONTROL };
+        uint64_t cir = (uint64_t)(offeredPerPolicer * (0.25 + (rng() % 100) / 100.0));
+
+        if (create_policer(m_engine, policers[i], modes[i % 3], profile.aware != 0, cir, 1500 + rng() % 8192) !=
+            SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "failed to create policer %u of %u\n", i, profile.policers);
+            return false;
+        }
+    }
+
+    result.createSeconds = (double)(bench_now_ns() - start) / 1e9;
+
+    for (uint32_t i = 0; i < profile.packets; i++)
+    {
+        packets[i].policer = policers[rng() % profile.policers];
+        packets[i].length = 64 + rng() % 1437;
+        packets[i].color = profile.aware ? (sai_packet_color_t)(rng() % 3) : SAI_PACKET_COLOR_GREEN;
+    }
+
+    BenchBarrier barrier(profile.threads + 1);
+    std::vector<std::thread> workers;
+    std::vector<std::vector<uint64_t> > colors(profile.threads, std::vector<uint64_t>(SAI_PACKET_COLOR_RED + 1));
+    uint64_t simNs = 0;
+    uint64_t refillNs = 0;
+    uint64_t meterNs = 0;
+
+    m_engine->Refill(simNs);
+
+    for (uint32_t t = 0; t < profile.threads; t++)
+    {
+        workers.push_back(std::thread([&, t]() {
+            uint32_t first = (uint32_t)((uint64_t)profile.packets * t / profile.threads);
+            uint32_t last = (uint32_t)((uint64_t)profile.packets * (t + 1) / profile.threads);
+            std::vector<PolicerResult> results(profile.batch);
+
+            for (uint32_t round = 0; round < profile.rounds; round++)
+            {
+                barrier.Wait();
+
+                for (uint32_t i = first; i < last; i += profile.batch)
+                {
+                    uint32_t count = std::min(profile.batch, last - i);
+
+                    m_engine->Meter(&packets[i], count, results.data());
+
+                    for (uint32_t j = 0; j < count; j++)
+                    {
+                        colors[t][results[j].color]++;
+                    }
+                }
+
+                barrier.Wait();
+            }
+        }));
+    }
+
+    for (uint32_t round = 0; round < profile.rounds; round++)
+    {
+        simNs += (uint64_t)profile.refreshUs * 1000;
+
+        start = bench_now_ns();
+        m_engine->Refill(simNs);
+        refillNs += bench_now_ns() - start;
+
+        start = bench_now_ns();
+        barrier.Wait();
+        barrier.Wait();
+        meterNs += bench_now_ns() - start;
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        workers[t].join();
+
+        for (uint32_t color = SAI_PACKET_COLOR_GREEN; color <= SAI_PACKET_COLOR_RED; color++)
+        {
+            result.colors[color] += colors[t][color];
+        }
+    }
+
+    uint64_t metered = (uint64_t)profile.packets * profile.rounds;
+
+    result.meterSeconds = (double)meterNs / 1e9;
+    result.packetsPerSecond = meterNs ? metered * 1e9 / meterNs : 0;
+    result.nsPerPacket = metered ? (double)meterNs / metered : 0;
+    result.refillUs = profile.rounds ? (double)refillNs / profile.rounds / 1e3 : 0;
+    result.refillNsPerPolicer = profile.rounds ? (double)refillNs / profile.rounds / m_engine->Capacity() : 0;
+
+    // the buckets started full at 0, tokens were added up to simNs
+    static const sai_stat_id_t ids[] = {
+        SAI_POLICER_STAT_PACKETS, SAI_POLICER_STAT_ATTR_BYTES,
+        SAI_POLICER_STAT_GREEN_PACKETS, SAI_POLICER_STAT_GREEN_BYTES,
+        SAI_POLICER_STAT_YELLOW_PACKETS, SAI_POLICER_STAT_YELLOW_BYTES,
+        SAI_POLICER_STAT_RED_PACKETS, SAI_POLICER_STAT_RED_BYTES };
+    uint64_t stat[POLICER_STAT_COUNT];
+    uint64_t counted = 0;
+
+    for (uint32_t i = 0; i < profile.policers; i++)
+    {
+        if (m_engine->GetStats(policers[i], POLICER_STAT_COUNT, ids, SAI_STATS_MODE_READ, stat) != SAI_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        counted += stat[SAI_POLICER_STAT_PACKETS];
+
+        if (stat[SAI_POLICER_STAT_PACKETS] != stat[SAI_POLICER_STAT_GREEN_PACKETS] +
+            stat[SAI_POLICER_STAT_YELLOW_PACKETS] + stat[SAI_POLICER_STAT_RED_PACKETS] ||
+            !policer_conforms(*m_engine->GetConfig(policers[i]), stat, (double)simNs / 1e9))
+        {
+            result.violations++;
+        }
+    }
+
+    return counted == metered && result.violations == 0;
+}
+
+std::string PolicerBench::ToJson(const PolicerProfile &profile, const PolicerBenchResult &result)
+{
+    std::stringstream json;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"policers\": " << profile.policers
+         << ", \"packets\": " << profile.packets
+         << ", \"rounds\": " << profile.rounds
+         << ", \"refresh_us\": " << profile.refreshUs
+         << ", \"threads\": " << profile.threads
+         << ", \"batch\": " << profile.batch
+         << ", \"aware\": " << profile.aware
+         << ", \"seed\": " << profile.seed << "},\n";
+    json << "  \"create_seconds\": " << result.createSeconds << ",\n";
+    json << "  \"meter_seconds\": " << result.meterSeconds << ",\n";
+    json << "  \"packets_per_second\": " << result.packetsPerSecond << ",\n";
+    json << "  \"ns_per_packet\": " << result.nsPerPacket << ",\n";
+    json << "  \"refill_us\": " << result.refillUs << ",\n";
+    json << "  \"refill_ns_per_policer\": " << result.refillNsPerPolicer << ",\n";
+    json << "  \"colors\": {\"green\": " << result.colors[SAI_PACKET_COLOR_GREEN]
+         << ", \"yellow\": " << result.colors[SAI_PACKET_COLOR_YELLOW]
+         << ", \"red\": " << result.colors[SAI_PACKET_COLOR_RED] << "},\n";
+    json << "  \"violations\": " << result.violations << "\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void PolicerBench::Show(const PolicerBenchResult &result)
+{
+    printf("\t--- --- --- --- --- --- Policer --- --- --- --- --- --- ---\n");
+    printf("\tcreate %.3f s, meter %.3f s, %.0f packets/s, %.1f ns/packet\n",
+           result.createSeconds, result.meterSeconds, result.packetsPerSecond, result.nsPerPacket);
+    printf("\trefill %.1f us/pass, %.2f ns/policer\n", result.refillUs, result.refillNsPerPolicer);
+    printf("\tgreen %llu, yellow %llu, red %llu, %u policers over their rates\n",
+           (unsigned long long)result.colors[SAI_PACKET_COLOR_GREEN],
+           (unsigned long long)result.colors[SAI_PACKET_COLOR_YELLOW],
+           (unsigned long long)result.colors[SAI_PACKET_COLOR_RED],
+           result.violations);
+    printf("\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- ---\n");
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "policer.h"
+
+// Policer profile, parsed from "key=value,..." (see PolicerProfile::Parse):
+//   policers   policers created, spread evenly over SR_TCM, TR_TCM and
+//              STORM_CONTROL, byte metered
+//   packets    packets metered per refill round
+//   rounds     refill rounds
+//   refresh    simulated microseconds between refills
+//   threads    metering threads, the round's packets are split among them
+//   batch      packets per Meter() call
+//   aware      1 for color aware policers and precolored packets
+//   seed       random seed
+struct PolicerProfile
+{
+    uint32_t policers;
+    uint32_t packets;
+    uint32_t rounds;
+    uint32_t refreshUs;
+    uint32_t threads;
+    uint32_t batch;
+    uint32_t aware;
+    uint32_t seed;
+
+    PolicerProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+};
+
+struct PolicerBenchResult
+{
+    double createSeconds;
+    double meterSeconds;
+    double packetsPerSecond;
+    double nsPerPacket;
+    double refillUs;                // mean per refill pass
+    double refillNsPerPolicer;
+    uint64_t colors[SAI_PACKET_COLOR_RED + 1];
+
+    // no policer let more green (and green plus yellow) through than its
+    // buckets and rates allow over the simulated time
+    uint32_t violations;
+};
+
+class PolicerBench
+{
+    PolicerEngine* m_engine;
+
+public:
+    explicit PolicerBench(PolicerEngine* engine);
+
+    // leaves the policers in place
+    bool Run(const PolicerProfile &profile, PolicerBenchResult &result);
+
+    static std::string ToJson(const PolicerProfile &profile, const PolicerBenchResult &result);
+    static void Show(const PolicerBenchResult &result);
+};
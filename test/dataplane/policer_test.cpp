@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+#include "policer.h"
+#include "policer_bench.h"
+
+#define NS_PER_SEC      1000000000ULL
+
+static sai_status_t policer_create(PolicerEngine &engine, uint32_t &index,
+                                   sai_meter_type_t meterType, sai_policer_mode_t mode,
+                                   sai_policer_color_source_t colorSource,
+                                   uint64_t cir, uint64_t cbs, uint64_t pir, uint64_t pbs)
+{
+    static const int32_t countAll[] = { SAI_PACKET_ACTION_FORWARD, SAI_PACKET_ACTION_DROP };
+    sai_attribute_t attrs[9];
+
+    attrs[0].id = SAI_POLICER_ATTR_METER_TYPE;
+    attrs[0].value.s32 = meterType;
+    attrs[1].id = SAI_POLICER_ATTR_MODE;
+    attrs[1].value.s32 = mode;
+    attrs[2].id = SAI_POLICER_ATTR_COLOR_SOURCE;
+    attrs[2].value.s32 = colorSource;
+    attrs[3].id = SAI_POLICER_ATTR_CIR;
+    attrs[3].value.u64 = cir;
+    attrs[4].id = SAI_POLICER_ATTR_CBS;
+    attrs[4].value.u64 = cbs;
+    attrs[5].id = SAI_POLICER_ATTR_PIR;
+    attrs[5].value.u64 = pir;
+    attrs[6].id = SAI_POLICER_ATTR_PBS;
+    attrs[6].value.u64 = pbs;
+    attrs[7].id = SAI_POLICER_ATTR_RED_PACKET_ACTION;
+    attrs[7].value.s32 = SAI_PACKET_ACTION_DROP;
+    attrs[8].id = SAI_POLICER_ATTR_ENABLE_COUNTER_PACKET_ACTION_LIST;
+    attrs[8].value.s32list.count = 2;
+    attrs[8].value.s32list.list = (int32_t*)countAll;
+
+    return engine.Create(index, 9, attrs);
+}
+
+static sai_packet_color_t meter_one(PolicerEngine &engine, uint32_t index, uint32_t length,
+                                    sai_packet_color_t color = SAI_PACKET_COLOR_GREEN)
+{
+    PolicerPacket pkt;
+    PolicerResult res;
+
+    pkt.policer = index;
+    pkt.length = length;
+    pkt.color = color;
+
+    engine.Meter(&pkt, 1, &res);
+
+    return res.color;
+}
+
+TEST(policer, sr_tcm_color_blind)
+{
+    PolicerEngine engine(4);
+    uint32_t p;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 1000, 1000, 0, 1000));
+    engine.Refill(0);
+
+    // color blind ignores the incoming red
+    ASSERT_EQ(SAI_PACKET_COLOR_GREEN, meter_one(engine, p, 600, SAI_PACKET_COLOR_RED));
+    ASSERT_EQ(SAI_PACKET_COLOR_YELLOW, meter_one(engine, p, 600));
+    ASSERT_EQ(SAI_PACKET_COLOR_RED, meter_one(engine, p, 600));
+    ASSERT_DOUBLE_EQ(400, engine.GetCommittedTokens(p));
+    ASSERT_DOUBLE_EQ(400, engine.GetExcessTokens(p));
+
+    // C fills to CBS, the other 400 bytes overflow into E
+    engine.Refill(NS_PER_SEC);
+    ASSERT_DOUBLE_EQ(1000, engine.GetCommittedTokens(p));
+    ASSERT_DOUBLE_EQ(800, engine.GetExcessTokens(p));
+
+    // E does not fill while C is below CBS
+    ASSERT_EQ(SAI_PACKET_COLOR_GREEN, meter_one(engine, p, 1000));
+    engine.Refill(NS_PER_SEC + NS_PER_SEC / 2);
+    ASSERT_DOUBLE_EQ(500, engine.GetCommittedTokens(p));
+    ASSERT_DOUBLE_EQ(800, engine.GetExcessTokens(p));
+}
+
+TEST(policer, sr_tcm_color_aware)
+{
+    PolicerEngine engine(4);
+    uint32_t p;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_AWARE, 1000, 1000, 0, 1000));
+
+    // yellow only takes from E, red takes nothing
+    ASSERT_EQ(SAI_PACKET_COLOR_YELLOW, meter_one(engine, p, 600, SAI_PACKET_COLOR_YELLOW));
+    ASSERT_EQ(SAI_PACKET_COLOR_RED, meter_one(engine, p, 100, SAI_PACKET_COLOR_RED));
+    ASSERT_EQ(SAI_PACKET_COLOR_RED, meter_one(engine, p, 600, SAI_PACKET_COLOR_YELLOW));
+    ASSERT_EQ(SAI_PACKET_COLOR_GREEN, meter_one(engine, p, 1000));
+    ASSERT_DOUBLE_EQ(0, engine.GetCommittedTokens(p));
+    ASSERT_DOUBLE_EQ(400, engine.GetExcessTokens(p));
+}
+
+TEST(policer, tr_tcm)
+{
+    PolicerEngine engine(4);
+    uint32_t blind;
+    uint32_t aware;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, blind, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_TR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 1000, 1000, 2000, 2000));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, aware, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_TR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_AWARE, 1000, 1000, 2000, 2000));
+    engine.Refill(0);
+
+    // green takes from P and C, yellow keeps what it took from P
+    ASSERT_EQ(SAI_PACKET_COLOR_GREEN, meter_one(engine, blind, 800));
+    ASSERT_EQ(SAI_PACKET_COLOR_YELLOW, meter_one(engine, blind, 800));
+    ASSERT_EQ(SAI_PACKET_COLOR_RED, meter_one(engine, blind, 800));
+    ASSERT_DOUBLE_EQ(200, engine.GetCommittedTokens(blind));
+    ASSERT_DOUBLE_EQ(400, engine.GetExcessTokens(blind));
+
+    // both buckets fill on their own rate
+    engine.Refill(NS_PER_SEC / 2);
+    ASSERT_DOUBLE_EQ(700, engine.GetCommittedTokens(blind));
+    ASSERT_DOUBLE_EQ(1400, engine.GetExcessTokens(blind));
+
+    ASSERT_EQ(SAI_PACKET_COLOR_RED, meter_one(engine, aware, 100, SAI_PACKET_COLOR_RED));
+    ASSERT_EQ(SAI_PACKET_COLOR_YELLOW, meter_one(engine, aware, 900, SAI_PACKET_COLOR_YELLOW));
+    ASSERT_DOUBLE_EQ(1000, engine.GetCommittedTokens(aware));
+    ASSERT_DOUBLE_EQ(1100, engine.GetExcessTokens(aware));
+}
+
+TEST(policer, storm_control_packets)
+{
+    PolicerEngine engine(4);
+    uint32_t p;
+    uint32_t red = 0;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_PACKETS, SAI_POLICER_MODE_STORM_CONTROL,
+                                                 SAI_POLICER_COLOR_SOURCE_AWARE, 100, 10, 0, 0));
+    engine.Refill(0);
+
+    // 10 packets of burst whatever their size or color, then 100 per second
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        red += meter_one(engine, p, 9000, SAI_PACKET_COLOR_YELLOW) == SAI_PACKET_COLOR_RED;
+    }
+
+    ASSERT_EQ(10u, red);
+
+    engine.Refill(NS_PER_SEC / 20);
+    ASSERT_DOUBLE_EQ(5, engine.GetCommittedTokens(p));
+    ASSERT_DOUBLE_EQ(0, engine.GetExcessTokens(p));
+}
+
+TEST(policer, actions_and_counters)
+{
+    PolicerEngine engine(4);
+    uint32_t p;
+    PolicerPacket pkts[3];
+    PolicerResult res[3];
+    sai_attribute_t attr;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 0, 100, 0, 100));
+
+    attr.id = SAI_POLICER_ATTR_YELLOW_PACKET_ACTION;
+    attr.value.s32 = SAI_PACKET_ACTION_TRAP;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(p, &attr));
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        pkts[i].policer = p;
+        pkts[i].length = 100;
+        pkts[i].color = SAI_PACKET_COLOR_GREEN;
+    }
+
+    engine.Meter(pkts, 3, res);
+    ASSERT_EQ(SAI_PACKET_ACTION_FORWARD, res[0].action);
+    ASSERT_EQ(SAI_PACKET_ACTION_TRAP, res[1].action);
+    ASSERT_EQ(SAI_PACKET_ACTION_DROP, res[2].action);
+
+    // yellow is trapped now, which is not on the counter list
+    sai_stat_id_t ids[POLICER_STAT_COUNT];
+    uint64_t stat[POLICER_STAT_COUNT];
+
+    for (uint32_t i = 0; i < POLICER_STAT_COUNT; i++)
+    {
+        ids[i] = i;
+    }
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(p, POLICER_STAT_COUNT, ids, SAI_STATS_MODE_READ_AND_CLEAR, stat));
+    ASSERT_EQ(3u, stat[SAI_POLICER_STAT_PACKETS]);
+    ASSERT_EQ(300u, stat[SAI_POLICER_STAT_ATTR_BYTES]);
+    ASSERT_EQ(1u, stat[SAI_POLICER_STAT_GREEN_PACKETS]);
+    ASSERT_EQ(100u, stat[SAI_POLICER_STAT_GREEN_BYTES]);
+    ASSERT_EQ(0u, stat[SAI_POLICER_STAT_YELLOW_PACKETS]);
+    ASSERT_EQ(1u, stat[SAI_POLICER_STAT_RED_PACKETS]);
+    ASSERT_EQ(100u, stat[SAI_POLICER_STAT_RED_BYTES]);
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(p, POLICER_STAT_COUNT, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_EQ(0u, stat[SAI_POLICER_STAT_PACKETS]);
+
+    // counters are disabled by default
+    attr.id = SAI_POLICER_ATTR_ENABLE_COUNTER_PACKET_ACTION_LIST;
+    attr.value.s32list.count = 0;
+    attr.value.s32list.list = NULL;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(p, &attr));
+    engine.Meter(pkts, 1, res);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(p, POLICER_STAT_COUNT, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_EQ(1u, stat[SAI_POLICER_STAT_PACKETS]);
+    ASSERT_EQ(0u, stat[SAI_POLICER_STAT_RED_PACKETS]);
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.ClearStats(p, 1, ids));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(p, 1, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_EQ(0u, stat[0]);
+
+    ids[0] = SAI_POLICER_STAT_CUSTOM_RANGE_BASE;
+    ASSERT_EQ(SAI_STATUS_INVALID_PARAMETER, engine.GetStats(p, 1, ids, SAI_STATS_MODE_READ, stat));
+}
+
+TEST(policer, config_validation)
+{
+    PolicerEngine engine(2);
+    uint32_t p;
+    uint32_t q;
+    sai_attribute_t attrs[2];
+
+    attrs[0].id = SAI_POLICER_ATTR_METER_TYPE;
+    attrs[0].value.s32 = SAI_METER_TYPE_BYTES;
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(p, 1, attrs));
+
+    attrs[1].id = SAI_POLICER_ATTR_MODE;
+    attrs[1].value.s32 = SAI_POLICER_MODE_CUSTOM_RANGE_BASE;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 1, engine.Create(p, 2, attrs));
+
+    attrs[1].id = SAI_POLICER_ATTR_END;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0 + 1, engine.Create(p, 2, attrs));
+
+    // PIR below CIR
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 5, policer_create(engine, p, SAI_METER_TYPE_BYTES,
+              SAI_POLICER_MODE_TR_TCM, SAI_POLICER_COLOR_SOURCE_BLIND, 2000, 1000, 1000, 1000));
+
+    // PIR only matters for TR_TCM
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 2000, 1000, 1000, 1000));
+    ASSERT_EQ(SAI_POLICER_MODE_SR_TCM, engine.GetConfig(p)->mode);
+
+    attrs[0].id = SAI_POLICER_ATTR_MODE;
+    attrs[0].value.s32 = SAI_POLICER_MODE_TR_TCM;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(p, &attrs[0]));
+
+    attrs[0].id = SAI_POLICER_ATTR_GREEN_PACKET_ACTION;
+    attrs[0].value.s32 = -1;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, engine.Set(p, &attrs[0]));
+
+    // shrinking CBS drops the tokens above it
+    attrs[0].id = SAI_POLICER_ATTR_CBS;
+    attrs[0].value.u64 = 10;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(p, &attrs[0]));
+    ASSERT_DOUBLE_EQ(10, engine.GetCommittedTokens(p));
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, q, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 0, 0, 0, 0));
+    ASSERT_EQ(SAI_STATUS_TABLE_FULL, policer_create(engine, q, SAI_METER_TYPE_BYTES, SAI_POLICER_MODE_SR_TCM,
+                                                    SAI_POLICER_COLOR_SOURCE_BLIND, 0, 0, 0, 0));
+    ASSERT_EQ(2u, engine.Size());
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(p));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(p));
+    ASSERT_EQ(SAI_PACKET_COLOR_GREEN, meter_one(engine, p, 100));
+    ASSERT_EQ(1u, engine.Size());
+}
+
+// every token is handed out once whatever the number of threads
+TEST(policer, concurrent_meter)
+{
+    const uint32_t threads = 4;
+    const uint32_t perThread = 10000;
+    PolicerEngine engine(1);
+    uint32_t p;
+    std::vector<std::thread> workers;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, policer_create(engine, p, SAI_METER_TYPE_PACKETS, SAI_POLICER_MODE_TR_TCM,
+                                                 SAI_POLICER_COLOR_SOURCE_BLIND, 0, 5000, 0, 12000));
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&engine, p]() {
+            std::vector<PolicerPacket> pkts(perThread);
+            std::vector<PolicerResult> res(perThread);
+
+            for (uint32_t i = 0; i < perThread; i++)
+            {
+                pkts[i].policer = p;
+                pkts[i].length = 64;
+                pkts[i].color = SAI_PACKET_COLOR_GREEN;
+            }
+
+            for (uint32_t i = 0; i < perThread; i += 32)
+            {
+                engine.Meter(&pkts[i], std::min(32u, perThread - i), &res[i]);
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        workers[t].join();
+    }
+
+    sai_stat_id_t ids[] = { SAI_POLICER_STAT_GREEN_PACKETS, SAI_POLICER_STAT_YELLOW_PACKETS, SAI_POLICER_STAT_RED_PACKETS };
+    uint64_t stat[3];
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetStats(p, 3, ids, SAI_STATS_MODE_READ, stat));
+    ASSERT_EQ(5000u, stat[0]);
+    ASSERT_EQ(7000u, stat[1]);
+    ASSERT_EQ(threads * perThread - 12000u, stat[2]);
+}
+
+// profile from DATAPLANE_POLICER_BENCH ("policers=..,packets=..,threads=.."),
+// the JSON report goes to DATAPLANE_POLICER_BENCH_JSON when it is set
+TEST(policer, bench)
+{
+    PolicerProfile profile;
+    PolicerBenchResult result;
+    const char *env = getenv("DATAPLANE_POLICER_BENCH");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    PolicerEngine engine(profile.policers);
+    PolicerBench bench(&engine);
+
+    bool ok = bench.Run(profile, result);
+    PolicerBench::Show(result);
+
+    std::string json = PolicerBench::ToJson(profile, result);
+    const char *jsonPath = getenv("DATAPLANE_POLICER_BENCH_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(profile.policers, engine.Size());
+}
@@ -0,0 +1,1546 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tam.h"
+
+#define TAM_BATCH                   64
+#define TAM_GSO_MAX_SEGMENTS        64
+#define TAM_GSO_MAX_BYTES           65000       // below the IPv4 UDP payload limit
+#define TAM_CONTROL_LEN             64
+#define TAM_SOCKET_BUFFER           (4 * 1024 * 1024)
+
+#define NS_PER_SEC                  1000000000ULL
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                 103
+#endif
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    v = htons(v);
+    memcpy(p, &v, 2);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    put32(p, (uint32_t)(v >> 32));
+    put32(p + 4, (uint32_t)v);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    uint16_t v;
+
+    memcpy(&v, p, 2);
+
+    return ntohs(v);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+
+    return ntohl(v);
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    return ((uint64_t)get32(p) << 32) | get32(p + 4);
+}
+
+bool tam_ipfix_decode(const uint8_t *buf, size_t len, TamIpfixMessage &msg)
+{
+    if (len < TAM_IPFIX_MESSAGE_HEADER_LEN || get16(buf) != TAM_IPFIX_VERSION)
+    {
+        return false;
+    }
+
+    msg.length = get16(buf + 2);
+    msg.exportTime = get32(buf + 4);
+    msg.sequence = get32(buf + 8);
+    msg.domain = get32(buf + 12);
+    msg.templates = 0;
+
+    if (msg.length < TAM_IPFIX_MESSAGE_HEADER_LEN || msg.length > len)
+    {
+        return false;
+    }
+
+    for (size_t off = TAM_IPFIX_MESSAGE_HEADER_LEN; off < msg.length;)
+    {
+        if (msg.length - off < TAM_IPFIX_SET_HEADER_LEN)
+        {
+            return false;
+        }
+
+        const uint8_t *set = buf + off;
+        uint16_t id = get16(set);
+        uint16_t setLen = get16(set + 2);
+
+        if (setLen < TAM_IPFIX_SET_HEADER_LEN || setLen > msg.length - off)
+        {
+            return false;
+        }
+
+        size_t recordLen = id == TAM_IPFIX_TEMPLATE_SET_ID ? TAM_IPFIX_TEMPLATE_RECORD_LEN : TAM_IPFIX_RECORD_LEN;
+
+        if (id != TAM_IPFIX_TEMPLATE_SET_ID && id < TAM_IPFIX_TEMPLATE_ID_BASE)
+        {
+            return false;
+        }
+
+        if ((setLen - TAM_IPFIX_SET_HEADER_LEN) % recordLen)
+        {
+            return false;
+        }
+
+        for (const uint8_t *p = set + TAM_IPFIX_SET_HEADER_LEN; p < set + setLen; p += recordLen)
+        {
+            if (id != TAM_IPFIX_TEMPLATE_SET_ID)
+            {
+                TamIpfixRecord record;
+
+                record.templateId = id;
+                record.label = get64(p);
+                record.counter = get64(p + 8);
+                msg.records.push_back(record);
+                continue;
+            }
+
+            if (get16(p) < TAM_IPFIX_TEMPLATE_ID_BASE || get16(p + 2) != 2 ||
+                get16(p + 4) != TAM_IPFIX_IE_OBSERVATION_POINT_ID || get16(p + 6) != 8 ||
+                get16(p + 8) != (TAM_IPFIX_ENTERPRISE_BIT | TAM_IPFIX_IE_COUNTER) || get16(p + 10) != 8)
+            {
+                return false;
+            }
+
+            msg.enterpriseNumber = get32(p + 12);
+            msg.templates++;
+        }
+
+        off += setLen;
+    }
+
+    return true;
+}
+
+static uint64_t realtime_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// first unused slot, the tables only hold a handful of objects
+template <typename T>
+static uint32_t alloc_slot(std::vector<T> &table)
+{
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        if (!table[i].used)
+        {
+            return i;
+        }
+    }
+
+    table.push_back(T());
+
+    return (uint32_t)table.size() - 1;
+}
+
+template <typename T>
+static bool find_slot(const std::vector<T> &table, sai_object_type_t type, sai_object_id_t oid, uint32_t &index)
+{
+    if (tam_oid_type(oid) != type)
+    {
+        return false;
+    }
+
+    index = tam_oid_index(oid);
+
+    return index < table.size() && table[index].used;
+}
+
+// IPFIX messages into buf, or with buf NULL only their size: sets open and
+// messages close as the records stop fitting, so both passes agree on
+// every byte
+struct IpfixWriter
+{
+    uint8_t *buf;
+    size_t len;
+    size_t maxMessage;
+    size_t message;                 // start of the open message
+    size_t set;                     // start of the open set
+    bool messageOpen;
+    bool setOpen;
+    uint16_t setId;
+    uint32_t domain;
+    uint32_t exportTime;
+    uint32_t sequence;
+    uint32_t records;               // data records in the open message
+    std::vector<uint32_t> *messages;
+
+    size_t Room() const
+    {
+        return maxMessage - (len - message);
+    }
+
+    void Begin()
+    {
+        if (buf)
+        {
+            put16(buf + len, TAM_IPFIX_VERSION);
+            put16(buf + len + 2, 0);
+            put32(buf + len + 4, exportTime);
+            put32(buf + len + 8, sequence);
+            put32(buf + len + 12, domain);
+        }
+
+        message = len;
+        len += TAM_IPFIX_MESSAGE_HEADER_LEN;
+        messageOpen = true;
+        records = 0;
+    }
+
+    void CloseSet()
+    {
+        if (setOpen && buf)
+        {
+            put16(buf + set + 2, (uint16_t)(len - set));
+        }
+
+        setOpen = false;
+    }
+
+    void End()
+    {
+        CloseSet();
+
+        if (!messageOpen)
+        {
+            return;
+        }
+
+        if (buf)
+        {
+            put16(buf + message + 2, (uint16_t)(len - message));
+        }
+
+        if (messages)
+        {
+            messages->push_back((uint32_t)(len - message));
+        }
+
+        // RFC 7011 3.1: data records sent before this message
+        sequence += records;
+        messageOpen = false;
+    }
+
+    // room for n more bytes in a set with id
+    void Need(uint16_t id, size_t n)
+    {
+        if (setOpen && setId == id && Room() >= n)
+        {
+            return;
+        }
+
+        CloseSet();
+
+        if (!messageOpen || Room() < TAM_IPFIX_SET_HEADER_LEN + n)
+        {
+            End();
+            Begin();
+        }
+
+        if (buf)
+        {
+            put16(buf + len, id);
+            put16(buf + len + 2, 0);
+        }
+
+        set = len;
+        len += TAM_IPFIX_SET_HEADER_LEN;
+        setOpen = true;
+        setId = id;
+    }
+};
+
+static sai_status_t parse_report(TamReport &report, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    bool type = false;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_TAM_REPORT_ATTR_TYPE:
+                if (attr.value.s32 < SAI_TAM_REPORT_TYPE_SFLOW || attr.value.s32 > SAI_TAM_REPORT_TYPE_GENETLINK)
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                if (attr.value.s32 != SAI_TAM_REPORT_TYPE_IPFIX)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                type = true;
+                break;
+
+            case SAI_TAM_REPORT_ATTR_ENTERPRISE_NUMBER:
+                report.enterpriseNumber = attr.value.u32;
+                break;
+
+            case SAI_TAM_REPORT_ATTR_TEMPLATE_REPORT_INTERVAL:
+                report.templateIntervalMin = attr.value.u32;
+                break;
+
+            default:
+                // histogram, quota and bulk mode shape event reports
+                if (attr.id >= SAI_TAM_REPORT_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    return type ? SAI_STATUS_SUCCESS : SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+}
+
+static sai_status_t parse_transport(TamTransport &transport, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    bool type = false;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_TAM_TRANSPORT_ATTR_TRANSPORT_TYPE:
+                if (attr.value.s32 < SAI_TAM_TRANSPORT_TYPE_NONE || attr.value.s32 > SAI_TAM_TRANSPORT_TYPE_MIRROR)
+                {
+                    return badValue;
+                }
+                if (attr.value.s32 != SAI_TAM_TRANSPORT_TYPE_NONE && attr.value.s32 != SAI_TAM_TRANSPORT_TYPE_UDP)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                transport.type = (sai_tam_transport_type_t)attr.value.s32;
+                type = true;
+                break;
+
+            case SAI_TAM_TRANSPORT_ATTR_SRC_PORT:
+                // -1 asks for an ephemeral port
+                if (attr.value.u32 > 0xFFFF && attr.value.u32 != 0xFFFFFFFF)
+                {
+                    return badValue;
+                }
+                transport.srcPort = (uint16_t)attr.value.u32;
+                break;
+
+            case SAI_TAM_TRANSPORT_ATTR_DST_PORT:
+                if (attr.value.u32 == 0 || attr.value.u32 > 0xFFFF)
+                {
+                    return badValue;
+                }
+                transport.dstPort = (uint16_t)attr.value.u32;
+                break;
+
+            case SAI_TAM_TRANSPORT_ATTR_TRANSPORT_AUTH_TYPE:
+                if (attr.value.s32 < SAI_TAM_TRANSPORT_AUTH_TYPE_NONE ||
+                    attr.value.s32 > SAI_TAM_TRANSPORT_AUTH_TYPE_TLS)
+                {
+                    return badValue;
+                }
+                if (attr.value.s32 != SAI_TAM_TRANSPORT_AUTH_TYPE_NONE)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                break;
+
+            case SAI_TAM_TRANSPORT_ATTR_MTU:
+                if (attr.value.u32 < TAM_MIN_MTU || attr.value.u32 > 0xFFFF)
+                {
+                    return badValue;
+                }
+                transport.mtu = attr.value.u32;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return type ? SAI_STATUS_SUCCESS : SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+}
+
+TamEngine::TamEngine(uint32_t subscriptionCapacity) :
+    m_fd(-1),
+    m_gso(false),
+    m_subscriptions(subscriptionCapacity),
+    m_subscriptionCount(0),
+    m_planDirty(false),
+    m_txControl(TAM_BATCH * TAM_CONTROL_LEN),
+    m_exports(0),
+    m_datagrams(0),
+    m_sendDrops(0)
+{
+    m_freeSubscriptions.reserve(subscriptionCapacity);
+
+    for (uint32_t i = subscriptionCapacity; i > 0; i--)
+    {
+        m_freeSubscriptions.push_back(i - 1);
+    }
+
+    for (uint32_t i = 0; i < subscriptionCapacity; i++)
+    {
+        m_subscriptions[i].used = false;
+    }
+}
+
+TamEngine::~TamEngine()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+bool TamEngine::Open(const char *addr, uint16_t port)
+{
+    struct sockaddr_in sin;
+    int size = TAM_SOCKET_BUFFER;
+    int off = 0;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1)
+    {
+        return false;
+    }
+
+    m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    // best effort, capped by net.core.wmem_max
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    m_gso = setsockopt(m_fd, SOL_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0;
+
+    if (bind(m_fd, (struct sockaddr*)&sin, sizeof(sin)) < 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+sai_status_t TamEngine::AddCounterObject(sai_object_id_t objectId, uint32_t statCount)
+{
+    if (objectId == SAI_NULL_OBJECT_ID || statCount == 0)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (m_objects.find(objectId) != m_objects.end())
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    m_objects[objectId] = std::make_pair((uint32_t)m_counters.size(), statCount);
+    m_counters.resize(m_counters.size() + statCount, 0);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+uint64_t* TamEngine::GetCounters(sai_object_id_t objectId)
+{
+    std::unordered_map<sai_object_id_t, std::pair<uint32_t, uint32_t> >::const_iterator it = m_objects.find(objectId);
+
+    return it == m_objects.end() ? NULL : &m_counters[it->second.first];
+}
+
+sai_status_t TamEngine::CreateReport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    TamReport report = TamReport();
+
+    report.templateIntervalMin = 15;
+
+    sai_status_t status = parse_report(report, attr_count, attr_list);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    index = alloc_slot(m_reports);
+    m_reports[index] = report;
+    m_reports[index].used = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::CreateTransport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    TamTransport transport = TamTransport();
+
+    transport.srcPort = 31337;
+    transport.dstPort = 31337;
+    transport.mtu = 1500;
+
+    sai_status_t status = parse_transport(transport, attr_count, attr_list);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    index = alloc_slot(m_transports);
+    m_transports[index] = transport;
+    m_transports[index].used = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::CreateCollector(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    TamCollector collector = TamCollector();
+    uint32_t mandatory = 0;
+
+    collector.dst.sin_family = AF_INET;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_TAM_COLLECTOR_ATTR_SRC_IP:
+            case SAI_TAM_COLLECTOR_ATTR_DST_IP:
+                if (attr.value.ipaddr.addr_family == SAI_IP_ADDR_FAMILY_IPV6)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                if (attr.value.ipaddr.addr_family != SAI_IP_ADDR_FAMILY_IPV4)
+                {
+                    return badValue;
+                }
+                if (attr.id == SAI_TAM_COLLECTOR_ATTR_DST_IP)
+                {
+                    collector.dst.sin_addr.s_addr = attr.value.ipaddr.addr.ip4;
+                    mandatory |= 1 << 1;
+                }
+                else
+                {
+                    mandatory |= 1 << 0;
+                }
+                break;
+
+            case SAI_TAM_COLLECTOR_ATTR_TRANSPORT:
+                if (!find_slot(m_transports, SAI_OBJECT_TYPE_TAM_TRANSPORT, attr.value.oid, collector.transport))
+                {
+                    return badValue;
+                }
+                mandatory |= 1 << 2;
+                break;
+
+            case SAI_TAM_COLLECTOR_ATTR_DSCP_VALUE:
+                if (attr.value.u8 > 63)
+                {
+                    return badValue;
+                }
+                collector.dscp = attr.value.u8;
+                mandatory |= 1 << 3;
+                break;
+
+            default:
+                // local host delivery, virtual router and truncation
+                if (attr.id >= SAI_TAM_COLLECTOR_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    if (mandatory != (1 << 4) - 1)
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    collector.dst.sin_port = htons(m_transports[collector.transport].dstPort);
+    m_transports[collector.transport].refs++;
+
+    index = alloc_slot(m_collectors);
+    m_collectors[index] = collector;
+    m_collectors[index].used = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::CreateTelType(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    uint32_t report = 0;
+    uint32_t mandatory = 0;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_TAM_TEL_TYPE_ATTR_TAM_TELEMETRY_TYPE:
+                if (attr.value.s32 < SAI_TAM_TELEMETRY_TYPE_NE ||
+                    attr.value.s32 > SAI_TAM_TELEMETRY_TYPE_COUNTER_SUBSCRIPTION)
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                if (attr.value.s32 != SAI_TAM_TELEMETRY_TYPE_COUNTER_SUBSCRIPTION)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                mandatory |= 1 << 0;
+                break;
+
+            case SAI_TAM_TEL_TYPE_ATTR_REPORT_ID:
+                if (!find_slot(m_reports, SAI_OBJECT_TYPE_TAM_REPORT, attr.value.oid, report))
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                mandatory |= 1 << 1;
+                break;
+
+            case SAI_TAM_TEL_TYPE_ATTR_COUNTER_SUBSCRIPTION_LIST:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+
+            default:
+                // the switch, INT and math function knobs have no effect on
+                // counter subscriptions
+                if (attr.id >= SAI_TAM_TEL_TYPE_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    if (mandatory != (1 << 2) - 1)
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    // template ids are 16 bit from 256 on
+    index = alloc_slot(m_telTypes);
+
+    if (index > 0xFFFF - TAM_IPFIX_TEMPLATE_ID_BASE)
+    {
+        m_telTypes.pop_back();
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    TamTelType &telType = m_telTypes[index];
+
+    telType = TamTelType();
+    telType.used = true;
+    telType.report = report;
+    m_reports[report].refs++;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::CreateTelemetry(uint32_t &index,
+                                        uint32_t attr_count,
+                                        const sai_attribute_t *attr_list,
+                                        uint64_t nowNs)
+{
+    std::vector<uint32_t> telTypes;
+    std::vector<uint32_t> collectors;
+    uint64_t unitNs = NS_PER_SEC;
+    uint32_t interval = 1;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_TAM_TELEMETRY_ATTR_TAM_TYPE_LIST:
+            case SAI_TAM_TELEMETRY_ATTR_COLLECTOR_LIST:
+            {
+                bool types = attr.id == SAI_TAM_TELEMETRY_ATTR_TAM_TYPE_LIST;
+                std::vector<uint32_t> &list = types ? telTypes : collectors;
+
+                if (attr.value.objlist.count && attr.value.objlist.list == NULL)
+                {
+                    return badValue;
+                }
+
+                list.resize(attr.value.objlist.count);
+
+                for (uint32_t j = 0; j < attr.value.objlist.count; j++)
+                {
+                    bool found = types ? find_slot(m_telTypes, SAI_OBJECT_TYPE_TAM_TEL_TYPE,
+                                                   attr.value.objlist.list[j], list[j])
+                                       : find_slot(m_collectors, SAI_OBJECT_TYPE_TAM_COLLECTOR,
+                                                   attr.value.objlist.list[j], list[j]);
+
+                    if (!found)
+                    {
+                        return badValue;
+                    }
+                }
+
+                if (!types && list.empty())
+                {
+                    return badValue;
+                }
+                break;
+            }
+
+            case SAI_TAM_TELEMETRY_ATTR_TAM_REPORTING_UNIT:
+                switch (attr.value.s32)
+                {
+                    case SAI_TAM_REPORTING_UNIT_SEC:
+                        unitNs = NS_PER_SEC;
+                        break;
+                    case SAI_TAM_REPORTING_UNIT_MINUTE:
+                        unitNs = 60 * NS_PER_SEC;
+                        break;
+                    case SAI_TAM_REPORTING_UNIT_HOUR:
+                        unitNs = 3600 * NS_PER_SEC;
+                        break;
+                    case SAI_TAM_REPORTING_UNIT_DAY:
+                        unitNs = 86400 * NS_PER_SEC;
+                        break;
+                    default:
+                        return badValue;
+                }
+                break;
+
+            case SAI_TAM_TELEMETRY_ATTR_REPORTING_INTERVAL:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                interval = attr.value.u32;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    if (collectors.empty())
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    index = alloc_slot(m_telemetry);
+
+    TamTelemetry &telemetry = m_telemetry[index];
+    bool udp = false;
+
+    telemetry = TamTelemetry();
+    telemetry.used = true;
+    telemetry.telTypes.swap(telTypes);
+    telemetry.collectors.swap(collectors);
+    telemetry.intervalNs = interval * unitNs;
+
+    for (size_t i = 0; i < telemetry.telTypes.size(); i++)
+    {
+        m_telTypes[telemetry.telTypes[i]].refs++;
+    }
+
+    for (size_t i = 0; i < telemetry.collectors.size(); i++)
+    {
+        m_collectors[telemetry.collectors[i]].refs++;
+        udp |= m_transports[m_collectors[telemetry.collectors[i]].transport].type == SAI_TAM_TRANSPORT_TYPE_UDP;
+    }
+
+    // local host collectors pull with sai_tam_telemetry_get_data()
+    telemetry.nextExportNs = udp ? nowNs + telemetry.intervalNs : UINT64_MAX;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::CreateSubscription(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    TamSubscription subscription = TamSubscription();
+    uint32_t mandatory = 0;
+    uint32_t statAttr = 0;
+
+    if (m_freeSubscriptions.empty())
+    {
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        switch (attr.id)
+        {
+            case SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_TEL_TYPE:
+                if (!find_slot(m_telTypes, SAI_OBJECT_TYPE_TAM_TEL_TYPE, attr.value.oid, subscription.telType))
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                mandatory |= 1 << 0;
+                break;
+
+            case SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_OBJECT_ID:
+                if (m_objects.find(attr.value.oid) == m_objects.end())
+                {
+                    return SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+                }
+                subscription.objectId = attr.value.oid;
+                mandatory |= 1 << 1;
+                break;
+
+            case SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_STAT_ID:
+                subscription.statId = attr.value.u32;
+                statAttr = i;
+                mandatory |= 1 << 2;
+                break;
+
+            case SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_LABEL:
+                subscription.label = attr.value.u64;
+                break;
+
+            default:
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    if (mandatory != (1 << 3) - 1)
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    // the object's counter block decides which stats exist
+    if (subscription.statId >= m_objects[subscription.objectId].second)
+    {
+        return SAI_STATUS_INVALID_ATTR_VALUE_0 + statAttr;
+    }
+
+    std::vector<uint32_t> &list = m_telTypes[subscription.telType].subscriptions;
+
+    index = m_freeSubscriptions.back();
+    m_freeSubscriptions.pop_back();
+    subscription.used = true;
+    subscription.position = (uint32_t)list.size();
+    m_subscriptions[index] = subscription;
+    list.push_back(index);
+    m_subscriptionCount++;
+    m_planDirty = true;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::Create(sai_object_type_t type,
+                               sai_object_id_t &oid,
+                               uint32_t attr_count,
+                               const sai_attribute_t *attr_list,
+                               uint64_t nowNs)
+{
+    uint32_t index = 0;
+    sai_status_t status;
+
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    switch (type)
+    {
+        case SAI_OBJECT_TYPE_TAM_REPORT:
+            status = CreateReport(index, attr_count, attr_list);
+            break;
+        case SAI_OBJECT_TYPE_TAM_TRANSPORT:
+            status = CreateTransport(index, attr_count, attr_list);
+            break;
+        case SAI_OBJECT_TYPE_TAM_COLLECTOR:
+            status = CreateCollector(index, attr_count, attr_list);
+            break;
+        case SAI_OBJECT_TYPE_TAM_TEL_TYPE:
+            status = CreateTelType(index, attr_count, attr_list);
+            break;
+        case SAI_OBJECT_TYPE_TAM_TELEMETRY:
+            status = CreateTelemetry(index, attr_count, attr_list, nowNs);
+            break;
+        case SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION:
+            status = CreateSubscription(index, attr_count, attr_list);
+            break;
+        default:
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+    }
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        oid = tam_oid(type, index);
+    }
+
+    return status;
+}
+
+sai_status_t TamEngine::Remove(sai_object_id_t oid)
+{
+    uint32_t index;
+
+    switch (tam_oid_type(oid))
+    {
+        case SAI_OBJECT_TYPE_TAM_REPORT:
+            if (!find_slot(m_reports, SAI_OBJECT_TYPE_TAM_REPORT, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_reports[index].refs)
+            {
+                return SAI_STATUS_OBJECT_IN_USE;
+            }
+            m_reports[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_TAM_TRANSPORT:
+            if (!find_slot(m_transports, SAI_OBJECT_TYPE_TAM_TRANSPORT, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_transports[index].refs)
+            {
+                return SAI_STATUS_OBJECT_IN_USE;
+            }
+            m_transports[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_TAM_COLLECTOR:
+            if (!find_slot(m_collectors, SAI_OBJECT_TYPE_TAM_COLLECTOR, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_collectors[index].refs)
+            {
+                return SAI_STATUS_OBJECT_IN_USE;
+            }
+            m_transports[m_collectors[index].transport].refs--;
+            m_collectors[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_TAM_TEL_TYPE:
+            if (!find_slot(m_telTypes, SAI_OBJECT_TYPE_TAM_TEL_TYPE, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+            if (m_telTypes[index].refs || !m_telTypes[index].subscriptions.empty())
+            {
+                return SAI_STATUS_OBJECT_IN_USE;
+            }
+            m_reports[m_telTypes[index].report].refs--;
+            m_telTypes[index].used = false;
+            break;
+
+        case SAI_OBJECT_TYPE_TAM_TELEMETRY:
+        {
+            if (!find_slot(m_telemetry, SAI_OBJECT_TYPE_TAM_TELEMETRY, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            TamTelemetry &telemetry = m_telemetry[index];
+
+            for (size_t i = 0; i < telemetry.telTypes.size(); i++)
+            {
+                m_telTypes[telemetry.telTypes[i]].refs--;
+            }
+
+            for (size_t i = 0; i < telemetry.collectors.size(); i++)
+            {
+                m_collectors[telemetry.collectors[i]].refs--;
+            }
+
+            telemetry = TamTelemetry();
+            break;
+        }
+
+        case SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION:
+        {
+            if (!find_slot(m_subscriptions, SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION, oid, index))
+            {
+                return SAI_STATUS_ITEM_NOT_FOUND;
+            }
+
+            TamSubscription &subscription = m_subscriptions[index];
+            std::vector<uint32_t> &list = m_telTypes[subscription.telType].subscriptions;
+
+            // the last one takes its place
+            list[subscription.position] = list.back();
+            m_subscriptions[list.back()].position = subscription.position;
+            list.pop_back();
+
+            subscription.used = false;
+            m_freeSubscriptions.push_back(index);
+            m_subscriptionCount--;
+            m_planDirty = true;
+            break;
+        }
+
+        default:
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TamEngine::Get(sai_object_id_t oid, uint32_t attr_count, sai_attribute_t *attr_list) const
+{
+    uint32_t index;
+
+    if (tam_oid_type(oid) != SAI_OBJECT_TYPE_TAM_TEL_TYPE)
+    {
+        return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (!find_slot(m_telTypes, SAI_OBJECT_TYPE_TAM_TEL_TYPE, oid, index))
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    const std::vector<uint32_t> &list = m_telTypes[index].subscriptions;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        sai_object_list_t &objlist = attr_list[i].value.objlist;
+
+        if (attr_list[i].id != SAI_TAM_TEL_TYPE_ATTR_COUNTER_SUBSCRIPTION_LIST)
+        {
+            return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+        }
+
+        if (objlist.count < list.size() || objlist.list == NULL)
+        {
+            objlist.count = (uint32_t)list.size();
+            return SAI_STATUS_BUFFER_OVERFLOW;
+        }
+
+        for (size_t j = 0; j < list.size(); j++)
+        {
+            objlist.list[j] = tam_oid(SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION, list[j]);
+        }
+
+        objlist.count = (uint32_t)list.size();
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void TamEngine::CompilePlan()
+{
+    std::vector<std::pair<uint32_t, uint64_t> > entries;
+
+    m_plan.offset.clear();
+    m_plan.label.clear();
+    m_plan.offset.reserve(m_subscriptionCount);
+    m_plan.label.reserve(m_subscriptionCount);
+
+    for (size_t t = 0; t < m_telTypes.size(); t++)
+    {
+        TamTelType &telType = m_telTypes[t];
+
+        telType.planBegin = (uint32_t)m_plan.offset.size();
+
+        if (telType.used)
+        {
+            entries.clear();
+
+            for (size_t i = 0; i < telType.subscriptions.size(); i++)
+            {
+                const TamSubscription &subscription = m_subscriptions[telType.subscriptions[i]];
+
+                entries.push_back(std::make_pair(m_objects[subscription.objectId].first + subscription.statId,
+                                                 subscription.label));
+            }
+
+            // ascending loads, the snapshot streams through the counters
+            std::sort(entries.begin(), entries.end());
+
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                m_plan.offset.push_back(entries[i].first);
+                m_plan.label.push_back(entries[i].second);
+            }
+        }
+
+        telType.planEnd = (uint32_t)m_plan.offset.size();
+    }
+
+    m_snapshot.resize(m_plan.offset.size());
+    m_planDirty = false;
+}
+
+void TamEngine::Snapshot(const TamTelemetry &telemetry, bool clear)
+{
+    const uint32_t *offset = m_plan.offset.data();
+    const uint64_t *counters = m_counters.data();
+    uint64_t *snapshot = m_snapshot.data();
+
+    for (size_t t = 0; t < telemetry.telTypes.size(); t++)
+    {
+        const TamTelType &telType = m_telTypes[telemetry.telTypes[t]];
+
+        for (uint32_t i = telType.planBegin; i < telType.planEnd; i++)
+        {
+            snapshot[i] = counters[offset[i]];
+        }
+    }
+
+    if (!clear)
+    {
+        return;
+    }
+
+    for (size_t t = 0; t < telemetry.telTypes.size(); t++)
+    {
+        const TamTelType &telType = m_telTypes[telemetry.telTypes[t]];
+
+        for (uint32_t i = telType.planBegin; i < telType.planEnd; i++)
+        {
+            m_counters[offset[i]] = 0;
+        }
+    }
+}
+
+uint32_t TamEngine::MaxMessage(const TamTelemetry &telemetry) const
+{
+    uint32_t mtu = 0xFFFF;
+
+    for (size_t i = 0; i < telemetry.collectors.size(); i++)
+    {
+        mtu = std::min(mtu, m_transports[m_collectors[telemetry.collectors[i]].transport].mtu);
+    }
+
+    return mtu - TAM_EXPORT_HEADROOM;
+}
+
+size_t TamEngine::Encode(uint32_t index,
+                         bool templates,
+                         uint32_t &sequence,
+                         uint32_t exportTime,
+                         uint8_t *buf,
+                         std::vector<uint32_t> *messages) const
+{
+    const TamTelemetry &telemetry = m_telemetry[index];
+    IpfixWriter w;
+
+    w.buf = buf;
+    w.len = 0;
+    w.maxMessage = MaxMessage(telemetry);
+    w.message = 0;
+    w.set = 0;
+    w.messageOpen = false;
+    w.setOpen = false;
+    w.setId = 0;
+    w.domain = index + 1;
+    w.exportTime = exportTime;
+    w.sequence = sequence;
+    w.records = 0;
+    w.messages = messages;
+
+    for (size_t t = 0; templates && t < telemetry.telTypes.size(); t++)
+    {
+        const TamReport &report = m_reports[m_telTypes[telemetry.telTypes[t]].report];
+
+        w.Need(TAM_IPFIX_TEMPLATE_SET_ID, TAM_IPFIX_TEMPLATE_RECORD_LEN);
+
+        if (buf)
+        {
+            uint8_t *p = buf + w.len;
+
+            put16(p, (uint16_t)(TAM_IPFIX_TEMPLATE_ID_BASE + telemetry.telTypes[t]));
+            put16(p + 2, 2);
+            put16(p + 4, TAM_IPFIX_IE_OBSERVATION_POINT_ID);
+            put16(p + 6, 8);
+            put16(p + 8, TAM_IPFIX_ENTERPRISE_BIT | TAM_IPFIX_IE_COUNTER);
+            put16(p + 10, 8);
+            put32(p + 12, report.enterpriseNumber);
+        }
+
+        w.len += TAM_IPFIX_TEMPLATE_RECORD_LEN;
+    }
+
+    for (size_t t = 0; t < telemetry.telTypes.size(); t++)
+    {
+        const TamTelType &telType = m_telTypes[telemetry.telTypes[t]];
+        uint16_t templateId = (uint16_t)(TAM_IPFIX_TEMPLATE_ID_BASE + telemetry.telTypes[t]);
+
+        for (uint32_t i = telType.planBegin; i < telType.planEnd;)
+        {
+            w.Need(templateId, TAM_IPFIX_RECORD_LEN);
+
+            uint32_t n = (uint32_t)std::min<size_t>(telType.planEnd - i, w.Room() / TAM_IPFIX_RECORD_LEN);
+
+            if (buf)
+            {
+                uint8_t *p = buf + w.len;
+
+                for (uint32_t j = 0; j < n; j++, p += TAM_IPFIX_RECORD_LEN)
+                {
+                    put64(p, m_plan.label[i + j]);
+                    put64(p + 8, m_snapshot[i + j]);
+                }
+            }
+
+            w.len += (size_t)n * TAM_IPFIX_RECORD_LEN;
+            w.records += n;
+            i += n;
+        }
+    }
+
+    w.End();
+    sequence = w.sequence;
+
+    return w.len;
+}
+
+sai_status_t TamEngine::GetTelemetryData(sai_object_list_t obj_list,
+                                         bool clear_on_read,
+                                         sai_size_t *buffer_size,
+                                         void *buffer)
+{
+    std::vector<uint32_t> indexes(obj_list.count);
+    size_t required = 0;
+
+    if (buffer_size == NULL || (obj_list.count && obj_list.list == NULL))
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < obj_list.count; i++)
+    {
+        if (tam_oid_type(obj_list.list[i]) != SAI_OBJECT_TYPE_TAM_TELEMETRY)
+        {
+            return SAI_STATUS_INVALID_OBJECT_TYPE;
+        }
+
+        if (!find_slot(m_telemetry, SAI_OBJECT_TYPE_TAM_TELEMETRY, obj_list.list[i], indexes[i]))
+        {
+            return SAI_STATUS_INVALID_OBJECT_ID;
+        }
+    }
+
+    if (m_planDirty)
+    {
+        CompilePlan();
+    }
+
+    // sizing walks messages, not records
+    for (uint32_t i = 0; i < obj_list.count; i++)
+    {
+        uint32_t sequence = m_telemetry[indexes[i]].pullSequence;
+
+        required += Encode(indexes[i], true, sequence, 0, NULL, NULL);
+    }
+
+    if (buffer == NULL || *buffer_size < required)
+    {
+        *buffer_size = required;
+        return SAI_STATUS_BUFFER_OVERFLOW;
+    }
+
+    uint32_t exportTime = (uint32_t)(realtime_ns() / NS_PER_SEC);
+    uint8_t *p = (uint8_t*)buffer;
+
+    for (uint32_t i = 0; i < obj_list.count; i++)
+    {
+        TamTelemetry &telemetry = m_telemetry[indexes[i]];
+
+        Snapshot(telemetry, clear_on_read);
+        p += Encode(indexes[i], true, telemetry.pullSequence, exportTime, p, NULL);
+    }
+
+    *buffer_size = required;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static socklen_t put_tx_control(uint8_t *control, int tos, uint16_t segment)
+{
+    struct cmsghdr *cmsg = (struct cmsghdr*)control;
+
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_TOS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &tos, sizeof(int));
+
+    if (segment == 0)
+    {
+        return (socklen_t)CMSG_SPACE(sizeof(int));
+    }
+
+    cmsg = (struct cmsghdr*)(control + CMSG_SPACE(sizeof(int)));
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(uint16_t));
+
+    return (socklen_t)(CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint16_t)));
+}
+
+// the encoded messages sit back to back in m_txBuf, so a run of equal
+// sized ones is a single iovec and, with GSO, a single send
+void TamEngine::Send(const TamTelemetry &telemetry)
+{
+    struct mmsghdr msgs[TAM_BATCH];
+    struct iovec iov[TAM_BATCH];
+    uint32_t segments[TAM_BATCH];
+
+    for (size_t c = 0; c < telemetry.collectors.size(); c++)
+    {
+        const TamCollector &collector = m_collectors[telemetry.collectors[c]];
+        size_t offset = 0;
+        size_t m = 0;
+
+        if (m_transports[collector.transport].type != SAI_TAM_TRANSPORT_TYPE_UDP)
+        {
+            continue;
+        }
+
+        while (m < m_txMessages.size())
+        {
+            uint32_t count = 0;
+
+            for (; count < TAM_BATCH && m < m_txMessages.size(); count++)
+            {
+                uint32_t len = m_txMessages[m];
+                uint32_t run = 1;
+
+                while (m_gso && m + run < m_txMessages.size() && m_txMessages[m + run] == len &&
+                       run < TAM_GSO_MAX_SEGMENTS && (run + 1) * len <= TAM_GSO_MAX_BYTES)
+                {
+                    run++;
+                }
+
+                struct msghdr &msg = msgs[count].msg_hdr;
+
+                iov[count].iov_base = &m_txBuf[offset];
+                iov[count].iov_len = (size_t)run * len;
+                memset(&msgs[count], 0, sizeof(msgs[count]));
+                msg.msg_name = (void*)&collector.dst;
+                msg.msg_namelen = sizeof(struct sockaddr_in);
+                msg.msg_iov = &iov[count];
+                msg.msg_iovlen = 1;
+                msg.msg_control = &m_txControl[count * TAM_CONTROL_LEN];
+                msg.msg_controllen = put_tx_control((uint8_t*)msg.msg_control, collector.dscp << 2,
+                                                    (uint16_t)(run > 1 ? len : 0));
+                segments[count] = run;
+                offset += (size_t)run * len;
+                m += run;
+            }
+
+            uint32_t sent = 0;
+
+            while (sent < count && m_fd >= 0)
+            {
+                int n = sendmmsg(m_fd, &msgs[sent], count - sent, 0);
+
+                if (n <= 0)
+                {
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    break;
+                }
+
+                sent += (uint32_t)n;
+            }
+
+            // a full socket buffer loses the rest of the batch
+            for (uint32_t i = 0; i < count; i++)
+            {
+                (i < sent ? m_datagrams : m_sendDrops) += segments[i];
+            }
+        }
+    }
+}
+
+void TamEngine::Export(uint32_t index, uint64_t nowNs)
+{
+    TamTelemetry &telemetry = m_telemetry[index];
+
+    // a changed plan compiles outside the timed export
+    if (m_planDirty)
+    {
+        CompilePlan();
+    }
+
+    uint64_t start = bench_now_ns();
+
+    Snapshot(telemetry, false);
+
+    uint64_t gathered = bench_now_ns();
+    bool templates = nowNs >= telemetry.templatesDueNs;
+    uint32_t sequence = telemetry.sequence;
+    size_t len = Encode(index, templates, sequence, 0, NULL, NULL);
+
+    if (m_txBuf.size() < len)
+    {
+        m_txBuf.resize(len);
+    }
+
+    m_txMessages.clear();
+    Encode(index, templates, telemetry.sequence, (uint32_t)(realtime_ns() / NS_PER_SEC), m_txBuf.data(),
+           &m_txMessages);
+
+    if (templates)
+    {
+        uint64_t intervalMin = UINT64_MAX;
+
+        for (size_t t = 0; t < telemetry.telTypes.size(); t++)
+        {
+            intervalMin = std::min(intervalMin,
+                                   (uint64_t)m_reports[m_telTypes[telemetry.telTypes[t]].report].templateIntervalMin);
+        }
+
+        telemetry.templatesDueNs = intervalMin == UINT64_MAX ? 0 : nowNs + intervalMin * 60 * NS_PER_SEC;
+    }
+
+    Send(telemetry);
+
+    m_exports++;
+    m_gatherTime.Add((double)(gathered - start) / 1000);
+    m_exportTime.Add((double)(bench_now_ns() - start) / 1000);
+}
+
+uint32_t TamEngine::Poll(uint64_t nowNs)
+{
+    uint32_t exported = 0;
+
+    for (uint32_t i = 0; i < m_telemetry.size(); i++)
+    {
+        TamTelemetry &telemetry = m_telemetry[i];
+
+        if (!telemetry.used || telemetry.nextExportNs > nowNs)
+        {
+            continue;
+        }
+
+        Export(i, nowNs);
+        exported++;
+
+        // keep the cadence, but don't export twice to catch up
+        telemetry.nextExportNs += telemetry.intervalNs;
+
+        if (telemetry.nextExportNs <= nowNs)
+        {
+            telemetry.nextExportNs = nowNs + telemetry.intervalNs;
+        }
+    }
+
+    return exported;
+}
+
+uint64_t TamEngine::NextExportNs() const
+{
+    uint64_t next = UINT64_MAX;
+
+    for (size_t i = 0; i < m_telemetry.size(); i++)
+    {
+        if (m_telemetry[i].used)
+        {
+            next = std::min(next, m_telemetry[i].nextExportNs);
+        }
+    }
+
+    return next;
+}
+
+bool TamEngine::Gso() const
+{
+    return m_gso;
+}
+
+uint32_t TamEngine::Size() const
+{
+    return m_subscriptionCount;
+}
+
+uint64_t TamEngine::Exports() const
+{
+    return m_exports;
+}
+
+uint64_t TamEngine::Datagrams() const
+{
+    return m_datagrams;
+}
+
+uint64_t TamEngine::SendDrops() const
+{
+    return m_sendDrops;
+}
+
+BenchLatency TamEngine::GetGatherTime() const
+{
+    return m_gatherTime.Summarize();
+}
+
+BenchLatency TamEngine::GetExportTime() const
+{
+    return m_exportTime.Summarize();
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+#include "bench_util.h"
+
+// RFC 7011 IPFIX message layout
+#define TAM_IPFIX_VERSION                   10
+#define TAM_IPFIX_MESSAGE_HEADER_LEN        16
+#define TAM_IPFIX_SET_HEADER_LEN            4
+#define TAM_IPFIX_TEMPLATE_SET_ID           2
+#define TAM_IPFIX_TEMPLATE_ID_BASE          256
+#define TAM_IPFIX_ENTERPRISE_BIT            0x8000
+
+// a counter subscription record: its label as observationPointId and the
+// counter as element 1 of the report's enterprise number, 8 bytes each
+#define TAM_IPFIX_IE_OBSERVATION_POINT_ID   138
+#define TAM_IPFIX_IE_COUNTER                1
+#define TAM_IPFIX_TEMPLATE_RECORD_LEN       16
+#define TAM_IPFIX_RECORD_LEN                16
+
+// IPv4 and UDP headers, a message fills the transport MTU less these
+#define TAM_EXPORT_HEADROOM                 28
+#define TAM_MIN_MTU                         68
+
+// the engine's object ids carry the object type above the index, like
+// the ones a SAI implementation hands out
+inline sai_object_id_t tam_oid(sai_object_type_t type, uint32_t index)
+{
+    return ((uint64_t)type << 48) | ((uint64_t)index + 1);
+}
+
+inline sai_object_type_t tam_oid_type(sai_object_id_t oid)
+{
+    return (sai_object_type_t)(oid >> 48);
+}
+
+inline uint32_t tam_oid_index(sai_object_id_t oid)
+{
+    return (uint32_t)(oid & 0xFFFFFFFFFFFFULL) - 1;
+}
+
+// a data record of a counter subscription template
+struct TamIpfixRecord
+{
+    uint16_t templateId;
+    uint64_t label;
+    uint64_t counter;
+};
+
+struct TamIpfixMessage
+{
+    uint16_t length;
+    uint32_t exportTime;
+    uint32_t sequence;
+    uint32_t domain;
+    uint32_t templates;             // template records
+    uint32_t enterpriseNumber;      // of the last template record
+    std::vector<TamIpfixRecord> records;
+};
+
+// one message at buf, false when it is malformed, runs past len or holds
+// a template other than the engine's; the records are appended
+bool tam_ipfix_decode(const uint8_t *buf, size_t len, TamIpfixMessage &msg);
+
+// SAI_TAM_REPORT_ATTR_*, only IPFIX reports are encoded
+struct TamReport
+{
+    bool used;
+    uint32_t refs;                  // tel types reporting with it
+    uint32_t enterpriseNumber;
+    uint32_t templateIntervalMin;   // 0 sends the templates with every export
+};
+
+// SAI_TAM_TRANSPORT_ATTR_*, UDP or NONE (the local host) without auth
+struct TamTransport
+{
+    bool used;
+    uint32_t refs;
+    sai_tam_transport_type_t type;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint32_t mtu;
+};
+
+// SAI_TAM_COLLECTOR_ATTR_*, IPv4 only
+struct TamCollector
+{
+    bool used;
+    uint32_t refs;
+    struct sockaddr_in dst;         // DST_IP and the transport's DST_PORT
+    uint32_t transport;
+    uint8_t dscp;
+};
+
+// a COUNTER_SUBSCRIPTION tel type; its subscriptions are the plan entries
+// [planBegin, planEnd) once the plan is compiled
+struct TamTelType
+{
+    bool used;
+    uint32_t refs;                  // telemetry objects reporting it
+    uint32_t report;
+    std::vector<uint32_t> subscriptions;
+    uint32_t planBegin;
+    uint32_t planEnd;
+};
+
+struct TamTelemetry
+{
+    bool used;
+    std::vector<uint32_t> telTypes;
+    std::vector<uint32_t> collectors;
+    uint64_t intervalNs;            // REPORTING_INTERVAL in REPORTING_UNIT
+    uint64_t nextExportNs;
+    uint64_t templatesDueNs;        // 0 until the first export
+    uint32_t sequence;              // data records exported, RFC 7011 3.1
+    uint32_t pullSequence;          // the same over sai_tam_telemetry_get_data
+};
+
+struct TamSubscription
+{
+    bool used;
+    uint32_t telType;
+    uint32_t position;              // in the tel type's subscriptions
+    sai_object_id_t objectId;
+    uint32_t statId;
+    uint64_t label;
+};
+
+// subscriptions flattened into counter memory offsets, grouped by tel type
+// and ascending within each group
+struct TamGatherPlan
+{
+    std::vector<uint32_t> offset;
+    std::vector<uint64_t> label;
+};
+
+// Software TAM counter subscription telemetry.
+//
+// The engine keeps the counter memory the subscriptions read: a block of
+// counters per object (port, queue, ...) indexed by stat id, which the
+// datapath model bumps through GetCounters(). TAM report, transport,
+// collector, tel type, telemetry and counter subscription objects are
+// created with their SAI attributes; the counter subscriptions compile
+// into a flat gather plan (rebuilt on the next read after a change) so a
+// snapshot is one tight pass of loads over ascending offsets, taken
+// before any encoding so the counters are read close together in time.
+//
+// Reports are IPFIX (RFC 7011): one template per tel type (template id
+// 256 + tel type index) with a record per subscription, the counter
+// subscription label and the counter value; a message never exceeds the
+// smallest transport MTU of the telemetry's collectors less the IPv4 and
+// UDP headers. The observation domain is the telemetry index + 1, the
+// export time the wall clock.
+//
+// GetTelemetryData() is sai_tam_telemetry_get_data(): it sizes the reply
+// up front, fails with SAI_STATUS_BUFFER_OVERFLOW and the exact size when
+// the caller's buffer is short (nothing is read or cleared then), and
+// otherwise encodes the messages, templates first, straight into the
+// caller's buffer. Poll() exports the due telemetry objects to their UDP
+// collectors from one socket, equal sized messages in UDP GSO trains
+// where the kernel has UDP_SEGMENT; templates go again every
+// TEMPLATE_REPORT_INTERVAL minutes. Transport source ports, virtual
+// routers and truncation are not modelled. The engine is not thread safe.
+class TamEngine
+{
+    int m_fd;
+    bool m_gso;
+
+    std::vector<uint64_t> m_counters;
+    std::unordered_map<sai_object_id_t, std::pair<uint32_t, uint32_t> > m_objects;   // base, stat count
+
+    std::vector<TamReport> m_reports;
+    std::vector<TamTransport> m_transports;
+    std::vector<TamCollector> m_collectors;
+    std::vector<TamTelType> m_telTypes;
+    std::vector<TamTelemetry> m_telemetry;
+    std::vector<TamSubscription> m_subscriptions;
+    std::vector<uint32_t> m_freeSubscriptions;
+    uint32_t m_subscriptionCount;
+
+    TamGatherPlan m_plan;
+    bool m_planDirty;
+    std::vector<uint64_t> m_snapshot;
+
+    std::vector<uint8_t> m_txBuf;
+    std::vector<uint32_t> m_txMessages;
+    std::vector<uint8_t> m_txControl;
+
+    uint64_t m_exports;
+    uint64_t m_datagrams;
+    uint64_t m_sendDrops;
+    BenchHistogram m_gatherTime;
+    BenchHistogram m_exportTime;
+
+    void CompilePlan();
+    void Snapshot(const TamTelemetry &telemetry, bool clear);
+    uint32_t MaxMessage(const TamTelemetry &telemetry) const;
+    size_t Encode(uint32_t index, bool templates, uint32_t &sequence, uint32_t exportTime, uint8_t *buf,
+                  std::vector<uint32_t> *messages) const;
+    void Export(uint32_t index, uint64_t nowNs);
+    void Send(const TamTelemetry &telemetry);
+
+    sai_status_t CreateReport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateTransport(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateCollector(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateTelType(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+    sai_status_t CreateTelemetry(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list,
+                                 uint64_t nowNs);
+    sai_status_t CreateSubscription(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list);
+
+public:
+    explicit TamEngine(uint32_t subscriptionCapacity);
+    ~TamEngine();
+
+    // export socket, port 0 picks a free one
+    bool Open(const char *addr, uint16_t port);
+
+    // a block of statCount counters for objectId, zeroed; pointers from
+    // GetCounters() stay valid until the next AddCounterObject()
+    sai_status_t AddCounterObject(sai_object_id_t objectId, uint32_t statCount);
+    uint64_t* GetCounters(sai_object_id_t objectId);
+
+    // SAI_OBJECT_TYPE_TAM_REPORT, _TRANSPORT, _COLLECTOR, _TEL_TYPE,
+    // _TELEMETRY and _COUNTER_SUBSCRIPTION
+    sai_status_t Create(sai_object_type_t type,
+                        sai_object_id_t &oid,
+                        uint32_t attr_count,
+                        const sai_attribute_t *attr_list,
+                        uint64_t nowNs);
+    sai_status_t Remove(sai_object_id_t oid);
+
+    // SAI_TAM_TEL_TYPE_ATTR_COUNTER_SUBSCRIPTION_LIST
+    sai_status_t Get(sai_object_id_t oid, uint32_t attr_count, sai_attribute_t *attr_list) const;
+
+    // sai_tam_telemetry_get_data() over SAI_OBJECT_TYPE_TAM_TELEMETRY
+    // objects, each one's messages after the previous one's
+    sai_status_t GetTelemetryData(sai_object_list_t obj_list,
+                                  bool clear_on_read,
+                                  sai_size_t *buffer_size,
+                                  void *buffer);
+
+    // exports the due telemetry objects, returns how many
+    uint32_t Poll(uint64_t nowNs);
+
+    // when the next export is due, UINT64_MAX without telemetry
+    uint64_t NextExportNs() const;
+
+    bool Gso() const;
+    uint32_t Size() const;
+    uint64_t Exports() const;
+    uint64_t Datagrams() const;
+    uint64_t SendDrops() const;
+
+    // snapshot and whole export (snapshot, encode, send) times
+    BenchLatency GetGatherTime() const;
+    BenchLatency GetExportTime() const;
+};
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "tam_bench.h"
+
+#define TAM_BENCH_ADDR              "127.0.0.1"
+#define TAM_BENCH_ENTERPRISE        4242
+#define TAM_BENCH_SOCKET_BUFFER     (4 * 1024 * 1024)
+#define TAM_BENCH_DRAIN_MS          1000
+
+TamProfile::TamProfile()
+{
+    subscriptions = 100000;
+    objects = 1000;
+    types = 4;
+    interval = 1;
+    seconds = 3;
+    mtu = 1500;
+}
+
+void TamProfile::Parse(const std::string &profile)
+{
+    BenchProfileItems items = bench_profile_split(profile);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const std::string &key = items[i].first;
+        uint32_t value = bench_parse_uint(key, items[i].second);
+
+        if (key == "subscriptions")
+        {
+            subscriptions = value;
+        }
+        else if (key == "objects")
+        {
+            objects = value;
+        }
+        else if (key == "types")
+        {
+            types = value;
+        }
+        else if (key == "interval")
+        {
+            interval = value;
+        }
+        else if (key == "seconds")
+        {
+            seconds = value;
+        }
+        else if (key == "mtu")
+        {
+            mtu = value;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown tam profile key " + key);
+        }
+    }
+
+    if (subscriptions == 0 || objects == 0 || objects > subscriptions || types == 0 || types > subscriptions ||
+        interval == 0 || seconds < interval || mtu < TAM_MIN_MTU || mtu > 0xFFFF)
+    {
+        throw std::invalid_argument("subscriptions, objects, types and interval must be non zero, objects and "
+                                    "types at most subscriptions, seconds at least interval, mtu between 68 "
+                                    "and 65535");
+    }
+}
+
+TamBench::TamBench(TamEngine* engine) :
+    m_engine(engine)
+{
+}
+
+// receives the exports; every counter is bumped once before each export,
+// so a record's counter is the number of the export it belongs to
+struct TamCollectorWorker
+{
+    int fd;
+    uint32_t subscriptions;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> received;
+    uint64_t messages;
+    uint64_t sequenceErrors;
+    uint64_t valueErrors;
+
+    TamCollectorWorker(int sock, uint32_t count) :
+        fd(sock), subscriptions(count), stop(false), received(0), messages(0), sequenceErrors(0), valueErrors(0)
+    {
+    }
+
+    void Run()
+    {
+        std::vector<uint8_t> buf(0x10000);
+        TamIpfixMessage msg;
+        uint64_t expectSequence = 0;
+
+        while (!stop.load())
+        {
+            ssize_t len = recv(fd, buf.data(), buf.size(), 0);
+
+            if (len <= 0)
+            {
+                continue;
+            }
+
+            msg.records.clear();
+
+            if (!tam_ipfix_decode(buf.data(), (size_t)len, msg))
+            {
+                valueErrors++;
+                continue;
+            }
+
+            if (msg.sequence != expectSequence)
+            {
+                sequenceErrors++;
+            }
+
+            uint64_t before = received.load();
+
+            for (size_t i = 0; i < msg.records.size(); i++)
+            {
+                if (msg.records[i].counter != (before + i) / subscriptions + 1)
+                {
+                    valueErrors++;
+                }
+            }
+
+            expectSequence = msg.sequence + (uint32_t)msg.records.size();
+            messages++;
+            received.store(before + msg.records.size());
+        }
+    }
+};
+
+static int open_collector(uint16_t &port)
+{
+    struct sockaddr_in sin;
+    socklen_t sinLen = sizeof(sin);
+    struct timeval tv = { 0, 100000 };
+    int size = TAM_BENCH_SOCKET_BUFFER;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    inet_pton(AF_INET, TAM_BENCH_ADDR, &sin.sin_addr);
+
+    // an export is a burst of datagrams the collector reads afterwards
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    if (bind(fd, (struct sockaddr*)&sin, sizeof(sin)) < 0 ||
+        getsockname(fd, (struct sockaddr*)&sin, &sinLen) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    port = ntohs(sin.sin_port);
+
+    return fd;
+}
+
+static bool create(TamEngine *engine, sai_object_type_t type, sai_object_id_t &oid, uint32_t count,
+                   const sai_attribute_t *attrs)
+{
+    if (engine->Create(type, oid, count, attrs, bench_now_ns()) != SAI_STATUS_SUCCESS)
+    {
+        printf("failed to create tam object type %d\n", type);
+        return false;
+    }
+
+    return true;
+}
+
+bool TamBench::Run(const TamProfile &profile, TamBenchResult &result)
+{
+    uint16_t port = 0;
+    int fd = open_collector(port);
+
+    result = TamBenchResult();
+
+    if (fd < 0 || !m_engine->Open(TAM_BENCH_ADDR, 0))
+    {
+        printf("failed to open tam sockets on %s\n", TAM_BENCH_ADDR);
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    result.gso = m_engine->Gso();
+
+    uint32_t stats = (profile.subscriptions + profile.objects - 1) / profile.objects;
+    std::vector<sai_object_id_t> objects(profile.objects);
+
+    for (uint32_t i = 0; i < profile.objects; i++)
+    {
+        objects[i] = tam_oid(SAI_OBJECT_TYPE_PORT, i);
+        m_engine->AddCounterObject(objects[i], stats);
+    }
+
+    sai_attribute_t attrs[4];
+    sai_object_id_t report;
+    sai_object_id_t transport;
+    sai_object_id_t collector;
+    sai_object_id_t telemetry;
+    std::vector<sai_object_id_t> telTypes(profile.types);
+    sai_ip_address_t ip;
+
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(INADDR_LOOPBACK);
+
+    attrs[0].id = SAI_TAM_REPORT_ATTR_TYPE;
+    attrs[0].value.s32 = SAI_TAM_REPORT_TYPE_IPFIX;
+    attrs[1].id = SAI_TAM_REPORT_ATTR_ENTERPRISE_NUMBER;
+    attrs[1].value.u32 = TAM_BENCH_ENTERPRISE;
+
+    if (!create(m_engine, SAI_OBJECT_TYPE_TAM_REPORT, report, 2, attrs))
+    {
+        close(fd);
+        return false;
+    }
+
+    attrs[0].id = SAI_TAM_TRANSPORT_ATTR_TRANSPORT_TYPE;
+    attrs[0].value.s32 = SAI_TAM_TRANSPORT_TYPE_UDP;
+    attrs[1].id = SAI_TAM_TRANSPORT_ATTR_DST_PORT;
+    attrs[1].value.u32 = port;
+    attrs[2].id = SAI_TAM_TRANSPORT_ATTR_MTU;
+    attrs[2].value.u32 = profile.mtu;
+
+    if (!create(m_engine, SAI_OBJECT_TYPE_TAM_TRANSPORT, transport, 3, attrs))
+    {
+        close(fd);
+        return false;
+    }
+
+    attrs[0].id = SAI_TAM_COLLECTOR_ATTR_SRC_IP;
+    attrs[0].value.ipaddr = ip;
+    attrs[1].id = SAI_TAM_COLLECTOR_ATTR_DST_IP;
+    attrs[1].value.ipaddr = ip;
+    attrs[2].id = SAI_TAM_COLLECTOR_ATTR_TRANSPORT;
+    attrs[2].value.oid = transport;
+    attrs[3].id = SAI_TAM_COLLECTOR_ATTR_DSCP_VALUE;
+    attrs[3].value.u8 = 0;
+
+    if (!create(m_engine, SAI_OBJECT_TYPE_TAM_COLLECTOR, collector, 4, attrs))
+    {
+        close(fd);
+        return false;
+    }
+
+    attrs[0].id = SAI_TAM_TEL_TYPE_ATTR_TAM_TELEMETRY_TYPE;
+    attrs[0].value.s32 = SAI_TAM_TELEMETRY_TYPE_COUNTER_SUBSCRIPTION;
+    attrs[1].id = SAI_TAM_TEL_TYPE_ATTR_REPORT_ID;
+    attrs[1].value.oid = report;
+
+    for (uint32_t t = 0; t < profile.types; t++)
+    {
+        if (!create(m_engine, SAI_OBJECT_TYPE_TAM_TEL_TYPE, telTypes[t], 2, attrs))
+        {
+            close(fd);
+            return false;
+        }
+    }
+
+    // consecutive subscriptions land on different objects and tel types
+    for (uint32_t s = 0; s < profile.subscriptions; s++)
+    {
+        sai_object_id_t subscription;
+
+        attrs[0].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_TEL_TYPE;
+        attrs[0].value.oid = telTypes[s % profile.types];
+        attrs[1].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_OBJECT_ID;
+        attrs[1].value.oid = objects[s % profile.objects];
+        attrs[2].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_STAT_ID;
+        attrs[2].value.u32 = s / profile.objects;
+        attrs[3].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_LABEL;
+        attrs[3].value.u64 = s;
+
+        if (!create(m_engine, SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION, subscription, 4, attrs))
+        {
+            close(fd);
+            return false;
+        }
+    }
+
+    attrs[0].id = SAI_TAM_TELEMETRY_ATTR_TAM_TYPE_LIST;
+    attrs[0].value.objlist.count = profile.types;
+    attrs[0].value.objlist.list = telTypes.data();
+    attrs[1].id = SAI_TAM_TELEMETRY_ATTR_COLLECTOR_LIST;
+    attrs[1].value.objlist.count = 1;
+    attrs[1].value.objlist.list = &collector;
+    attrs[2].id = SAI_TAM_TELEMETRY_ATTR_REPORTING_INTERVAL;
+    attrs[2].value.u32 = profile.interval;
+
+    if (!create(m_engine, SAI_OBJECT_TYPE_TAM_TELEMETRY, telemetry, 3, attrs))
+    {
+        close(fd);
+        return false;
+    }
+
+    TamCollectorWorker worker(fd, profile.subscriptions);
+    std::thread collectorThread(&TamCollectorWorker::Run, &worker);
+    uint32_t exports = profile.seconds / profile.interval;
+    uint64_t cpuNs = 0;
+
+    for (uint32_t e = 0; e < exports; e++)
+    {
+        // the datapath moves every counter once per export
+        for (uint32_t i = 0; i < profile.objects; i++)
+        {
+            uint64_t *counters = m_engine->GetCounters(objects[i]);
+
+            for (uint32_t s = 0; s < stats; s++)
+            {
+                counters[s]++;
+            }
+        }
+
+        uint64_t due = m_engine->NextExportNs();
+
+        bench_sleep_until(due);
+
+        uint64_t now = bench_now_ns();
+        uint64_t cpu = bench_thread_cpu_ns();
+
+        m_engine->Poll(now);
+        cpuNs += bench_thread_cpu_ns() - cpu;
+        result.exportLatenessMaxUs = std::max(result.exportLatenessMaxUs, (double)(now - due) / 1000);
+    }
+
+    uint64_t expected = (uint64_t)exports * profile.subscriptions;
+    uint64_t deadline = bench_now_ns() + TAM_BENCH_DRAIN_MS * 1000000ULL;
+
+    while (worker.received.load() < expected && bench_now_ns() < deadline)
+    {
+        std::this_thread::yield();
+    }
+
+    worker.stop.store(true);
+    collectorThread.join();
+    close(fd);
+
+    // a pull of the same data, sized first and then filled in place
+    sai_object_list_t list;
+    sai_size_t size = 0;
+
+    list.count = 1;
+    list.list = &telemetry;
+
+    bool pulled = m_engine->GetTelemetryData(list, false, &size, NULL) == SAI_STATUS_BUFFER_OVERFLOW;
+    std::vector<uint8_t> buf(size);
+    sai_size_t filled = size;
+    uint64_t start = bench_now_ns();
+
+    pulled = pulled && m_engine->GetTelemetryData(list, false, &filled, buf.data()) == SAI_STATUS_SUCCESS;
+    result.getDataUs = (double)(bench_now_ns() - start) / 1000;
+    result.getDataBytes = filled;
+
+    uint64_t pulledRecords = 0;
+
+    for (size_t off = 0; pulled && off < filled;)
+    {
+        TamIpfixMessage msg;
+
+        pulled = tam_ipfix_decode(&buf[off], filled - off, msg);
+        pulledRecords += msg.records.size();
+        off += pulled ? msg.length : 0;
+    }
+
+    result.exports = m_engine->Exports();
+    result.records = result.exports * profile.subscriptions;
+    result.datagrams = m_engine->Datagrams();
+    result.sendDrops = m_engine->SendDrops();
+    result.received = worker.received.load();
+    result.messages = worker.messages;
+    result.sequenceErrors = worker.sequenceErrors;
+    result.valueErrors = worker.valueErrors;
+    result.gatherTime = m_engine->GetGatherTime();
+    result.exportTime = m_engine->GetExportTime();
+    result.cpuPercent = (double)cpuNs / 1e9 / profile.seconds * 100;
+    result.recordsPerSec = result.exportTime.meanUs > 0 ? profile.subscriptions / result.exportTime.meanUs * 1e6 : 0;
+
+    // every export arrived whole and in order, the pull sized exactly
+    return result.exports == exports && result.sendDrops == 0 && result.received == expected &&
+           result.sequenceErrors == 0 && result.valueErrors == 0 && pulled && filled == size &&
+           pulledRecords == profile.subscriptions;
+}
+
+std::string TamBench::ToJson(const TamProfile &profile, const TamBenchResult &result)
+{
+    const BenchLatency *lats[] = { &result.gatherTime, &result.exportTime };
+    const char *names[] = { "gather_time", "export_time" };
+    std::stringstream json;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"subscriptions\": " << profile.subscriptions
+         << ", \"objects\": " << profile.objects
+         << ", \"types\": " << profile.types
+         << ", \"interval_s\": " << profile.interval
+         << ", \"seconds\": " << profile.seconds
+         << ", \"mtu\": " << profile.mtu << "},\n";
+    json << "  \"gso\": " << (result.gso ? "true" : "false") << ",\n";
+    json << "  \"exports\": " << result.exports << ",\n";
+    json << "  \"records\": " << result.records << ",\n";
+    json << "  \"datagrams\": " << result.datagrams << ",\n";
+    json << "  \"send_drops\": " << result.sendDrops << ",\n";
+    json << "  \"received\": " << result.received << ",\n";
+    json << "  \"messages\": " << result.messages << ",\n";
+    json << "  \"sequence_errors\": " << result.sequenceErrors << ",\n";
+    json << "  \"value_errors\": " << result.valueErrors << ",\n";
+
+    for (int i = 0; i < 2; i++)
+    {
+        json << "  \"" << names[i] << "\": {\"count\": " << lats[i]->count
+             << ", \"mean_us\": " << lats[i]->meanUs
+             << ", \"p50_us\": " << lats[i]->p50Us
+             << ", \"p99_us\": " << lats[i]->p99Us
+             << ", \"max_us\": " << lats[i]->maxUs << "},\n";
+    }
+
+    json << "  \"export_lateness_max_us\": " << result.exportLatenessMaxUs << ",\n";
+    json << "  \"cpu_percent\": " << result.cpuPercent << ",\n";
+    json << "  \"records_per_sec\": " << result.recordsPerSec << ",\n";
+    json << "  \"get_data_bytes\": " << result.getDataBytes << ",\n";
+    json << "  \"get_data_us\": " << result.getDataUs << "\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void TamBench::Show(const TamBenchResult &result)
+{
+    printf("\t--- --- --- --- --- --- --- TAM --- --- --- --- --- --- ---\n");
+    printf("\t%llu exports, %llu records in %llu datagrams (%s), %llu dropped on send\n",
+           (unsigned long long)result.exports, (unsigned long long)result.records,
+           (unsigned long long)result.datagrams, result.gso ? "gso" : "no gso",
+           (unsigned long long)result.sendDrops);
+    printf("\tcollector %llu records in %llu messages, %llu sequence errors, %llu value errors\n",
+           (unsigned long long)result.received, (unsigned long long)result.messages,
+           (unsigned long long)result.sequenceErrors, (unsigned long long)result.valueErrors);
+    printf("\tgather mean %.1f us, max %.1f us; export mean %.1f us, max %.1f us, late by at most %.1f us\n",
+           result.gatherTime.meanUs, result.gatherTime.maxUs, result.exportTime.meanUs,
+           result.exportTime.maxUs, result.exportLatenessMaxUs);
+    printf("\texporter cpu %.2f%%, %.0f records/s per core, get_data %llu bytes in %.1f us\n",
+           result.cpuPercent, result.recordsPerSec, (unsigned long long)result.getDataBytes, result.getDataUs);
+    printf("\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- ---\n");
+}
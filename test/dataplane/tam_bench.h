@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "tam.h"
+
+// TAM profile, parsed from "key=value,..." (see TamProfile::Parse):
+//   subscriptions  counter subscriptions, spread over the objects' stats
+//   objects        counter objects (ports) they subscribe to
+//   types          tel types the subscriptions are dealt across
+//   interval       SAI_TAM_TELEMETRY_ATTR_REPORTING_INTERVAL, seconds
+//   seconds        how long the exports run
+//   mtu            SAI_TAM_TRANSPORT_ATTR_MTU
+struct TamProfile
+{
+    uint32_t subscriptions;
+    uint32_t objects;
+    uint32_t types;
+    uint32_t interval;
+    uint32_t seconds;
+    uint32_t mtu;
+
+    TamProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+};
+
+struct TamBenchResult
+{
+    bool gso;
+    uint64_t exports;
+    uint64_t records;               // exported
+    uint64_t datagrams;
+    uint64_t sendDrops;
+
+    // at the collector
+    uint64_t received;
+    uint64_t messages;
+    uint64_t sequenceErrors;        // RFC 7011 sequence gaps
+    uint64_t valueErrors;           // counters other than the export number
+
+    BenchLatency gatherTime;        // the snapshot of all subscriptions
+    BenchLatency exportTime;        // snapshot, encode and send
+    double exportLatenessMaxUs;     // against the reporting cadence
+    double cpuPercent;              // of the exporting thread
+    double recordsPerSec;           // subscriptions over the mean export time
+
+    // one sai_tam_telemetry_get_data() over the telemetry object
+    uint64_t getDataBytes;
+    double getDataUs;
+};
+
+class TamBench
+{
+    TamEngine* m_engine;
+
+public:
+    // the engine needs the profile's subscription count as capacity,
+    // Run() opens it on the loopback
+    explicit TamBench(TamEngine* engine);
+
+    // leaves the objects in place
+    bool Run(const TamProfile &profile, TamBenchResult &result);
+
+    static std::string ToJson(const TamProfile &profile, const TamBenchResult &result);
+    static void Show(const TamBenchResult &result);
+};
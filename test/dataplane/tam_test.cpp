@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "tam.h"
+#include "tam_bench.h"
+
+#define NS_PER_SEC          1000000000ULL
+#define ENTERPRISE          4242
+#define PORTS               4
+#define PORT_STATS          8
+
+// report, transport, collector and two tel types; the ports have
+// PORT_STATS counters each
+struct TamSetup
+{
+    sai_object_id_t report;
+    sai_object_id_t transport;
+    sai_object_id_t collector;
+    sai_object_id_t telTypes[2];
+    sai_object_id_t ports[PORTS];
+};
+
+static void setup(TamEngine &engine, TamSetup &s, sai_tam_transport_type_t type, uint32_t mtu, uint16_t dstPort,
+                  uint32_t templateIntervalMin)
+{
+    sai_attribute_t attrs[4];
+    sai_ip_address_t ip;
+
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(INADDR_LOOPBACK);
+
+    for (uint32_t i = 0; i < PORTS; i++)
+    {
+        s.ports[i] = tam_oid(SAI_OBJECT_TYPE_PORT, i);
+        ASSERT_EQ(SAI_STATUS_SUCCESS, engine.AddCounterObject(s.ports[i], PORT_STATS));
+    }
+
+    attrs[0].id = SAI_TAM_REPORT_ATTR_TYPE;
+    attrs[0].value.s32 = SAI_TAM_REPORT_TYPE_IPFIX;
+    attrs[1].id = SAI_TAM_REPORT_ATTR_ENTERPRISE_NUMBER;
+    attrs[1].value.u32 = ENTERPRISE;
+    attrs[2].id = SAI_TAM_REPORT_ATTR_TEMPLATE_REPORT_INTERVAL;
+    attrs[2].value.u32 = templateIntervalMin;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_TAM_REPORT, s.report, 3, attrs, 0));
+
+    attrs[0].id = SAI_TAM_TRANSPORT_ATTR_TRANSPORT_TYPE;
+    attrs[0].value.s32 = type;
+    attrs[1].id = SAI_TAM_TRANSPORT_ATTR_MTU;
+    attrs[1].value.u32 = mtu;
+    attrs[2].id = SAI_TAM_TRANSPORT_ATTR_DST_PORT;
+    attrs[2].value.u32 = dstPort;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_TAM_TRANSPORT, s.transport, 3, attrs, 0));
+
+    attrs[0].id = SAI_TAM_COLLECTOR_ATTR_SRC_IP;
+    attrs[0].value.ipaddr = ip;
+    attrs[1].id = SAI_TAM_COLLECTOR_ATTR_DST_IP;
+    attrs[1].value.ipaddr = ip;
+    attrs[2].id = SAI_TAM_COLLECTOR_ATTR_TRANSPORT;
+    attrs[2].value.oid = s.transport;
+    attrs[3].id = SAI_TAM_COLLECTOR_ATTR_DSCP_VALUE;
+    attrs[3].value.u8 = 8;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_TAM_COLLECTOR, s.collector, 4, attrs, 0));
+
+    attrs[0].id = SAI_TAM_TEL_TYPE_ATTR_TAM_TELEMETRY_TYPE;
+    attrs[0].value.s32 = SAI_TAM_TELEMETRY_TYPE_COUNTER_SUBSCRIPTION;
+    attrs[1].id = SAI_TAM_TEL_TYPE_ATTR_REPORT_ID;
+    attrs[1].value.oid = s.report;
+
+    for (int t = 0; t < 2; t++)
+    {
+        ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(SAI_OBJECT_TYPE_TAM_TEL_TYPE, s.telTypes[t], 2, attrs, 0));
+    }
+}
+
+static sai_status_t subscribe(TamEngine &engine, sai_object_id_t &oid, sai_object_id_t telType,
+                              sai_object_id_t object, uint32_t stat, uint64_t label)
+{
+    sai_attribute_t attrs[4];
+
+    attrs[0].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_TEL_TYPE;
+    attrs[0].value.oid = telType;
+    attrs[1].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_OBJECT_ID;
+    attrs[1].value.oid = object;
+    attrs[2].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_STAT_ID;
+    attrs[2].value.u32 = stat;
+    attrs[3].id = SAI_TAM_COUNTER_SUBSCRIPTION_ATTR_LABEL;
+    attrs[3].value.u64 = label;
+
+    return engine.Create(SAI_OBJECT_TYPE_TAM_COUNTER_SUBSCRIPTION, oid, 4, attrs, 0);
+}
+
+static sai_status_t create_telemetry(TamEngine &engine, sai_object_id_t &oid, const TamSetup &s, uint64_t nowNs)
+{
+    sai_attribute_t attrs[2];
+
+    attrs[0].id = SAI_TAM_TELEMETRY_ATTR_TAM_TYPE_LIST;
+    attrs[0].value.objlist.count = 2;
+    attrs[0].value.objlist.list = (sai_object_id_t*)s.telTypes;
+    attrs[1].id = SAI_TAM_TELEMETRY_ATTR_COLLECTOR_LIST;
+    attrs[1].value.objlist.count = 1;
+    attrs[1].value.objlist.list = (sai_object_id_t*)&s.collector;
+
+    return engine.Create(SAI_OBJECT_TYPE_TAM_TELEMETRY, oid, 2, attrs, nowNs);
+}
+
+// the messages back to back in buf
+static bool decode_all(const uint8_t *buf, size_t len, std::vector<TamIpfixMessage> &msgs)
+{
+    for (size_t off = 0; off < len;)
+    {
+        TamIpfixMessage msg;
+
+        if (!tam_ipfix_decode(buf + off, len - off, msg))
+        {
+            return false;
+        }
+
+        msgs.push_back(msg);
+        off += msg.length;
+    }
+
+    return true;
+}
+
+TEST(tam, attributes)
+{
+    TamEngine engine(4);
+    TamSetup s;
+    sai_object_id_t oid;
+    sai_attribute_t attr;
+
+    setup(engine, s, SAI_TAM_TRANSPORT_TYPE_NONE, 1500, 31337, 15);
+
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.AddCounterObject(s.ports[0], PORT_STATS));
+
+    attr.id = SAI_TAM_REPORT_ATTR_TYPE;
+    attr.value.s32 = SAI_TAM_REPORT_TYPE_SFLOW;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(SAI_OBJECT_TYPE_TAM_REPORT, oid, 1, &attr, 0));
+    attr.id = SAI_TAM_REPORT_ATTR_ENTERPRISE_NUMBER;
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(SAI_OBJECT_TYPE_TAM_REPORT, oid, 1, &attr, 0));
+
+    attr.id = SAI_TAM_TRANSPORT_ATTR_TRANSPORT_TYPE;
+    attr.value.s32 = SAI_TAM_TRANSPORT_TYPE_TCP;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(SAI_OBJECT_TYPE_TAM_TRANSPORT, oid, 1, &attr, 0));
+
+    sai_attribute_t attrs[2];
+
+    attrs[0].id = SAI_TAM_TRANSPORT_ATTR_TRANSPORT_TYPE;
+    attrs[0].value.s32 = SAI_TAM_TRANSPORT_TYPE_UDP;
+    attrs[1].id = SAI_TAM_TRANSPORT_ATTR_MTU;
+    attrs[1].value.u32 = TAM_MIN_MTU - 1;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 1, engine.Create(SAI_OBJECT_TYPE_TAM_TRANSPORT, oid, 2, attrs, 0));
+
+    attrs[0].id = SAI_TAM_TEL_TYPE_ATTR_TAM_TELEMETRY_TYPE;
+    attrs[0].value.s32 = SAI_TAM_TELEMETRY_TYPE_INT;
+    attrs[1].id = SAI_TAM_TEL_TYPE_ATTR_REPORT_ID;
+    attrs[1].value.oid = s.report;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(SAI_OBJECT_TYPE_TAM_TEL_TYPE, oid, 2, attrs, 0));
+    attrs[0].value.s32 = SAI_TAM_TELEMETRY_TYPE_COUNTER_SUBSCRIPTION;
+    attrs[1].value.oid = s.collector;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 1, engine.Create(SAI_OBJECT_TYPE_TAM_TEL_TYPE, oid, 2, attrs, 0));
+
+    // counter objects and their stat ids are checked
+    sai_object_id_t subs[5];
+
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 1,
+              subscribe(engine, subs[0], s.telTypes[0], tam_oid(SAI_OBJECT_TYPE_QUEUE, 0), 0, 1));
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + 2, subscribe(engine, subs[0], s.telTypes[0], s.ports[0], PORT_STATS, 1));
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(SAI_STATUS_SUCCESS, subscribe(engine, subs[i], s.telTypes[0], s.ports[i], i, 100 + i));
+    }
+
+    ASSERT_EQ(SAI_STATUS_TABLE_FULL, subscribe(engine, subs[4], s.telTypes[0], s.ports[0], 0, 1));
+    ASSERT_EQ(4u, engine.Size());
+
+    // the read only subscription list follows removals
+    sai_object_id_t list[4];
+
+    attr.id = SAI_TAM_TEL_TYPE_ATTR_COUNTER_SUBSCRIPTION_LIST;
+    attr.value.objlist.count = 2;
+    attr.value.objlist.list = list;
+    ASSERT_EQ(SAI_STATUS_BUFFER_OVERFLOW, engine.Get(s.telTypes[0], 1, &attr));
+    ASSERT_EQ(4u, attr.value.objlist.count);
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(subs[1]));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(subs[1]));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Get(s.telTypes[0], 1, &attr));
+    ASSERT_EQ(3u, attr.value.objlist.count);
+    ASSERT_EQ(subs[0], list[0]);
+    ASSERT_EQ(subs[3], list[1]);
+    ASSERT_EQ(subs[2], list[2]);
+
+    // referenced objects stay
+    sai_object_id_t telemetry;
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_telemetry(engine, telemetry, s, 0));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.telTypes[0]));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.telTypes[1]));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.collector));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.transport));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.report));
+
+    // a local host collector is pulled, never exported to
+    ASSERT_EQ(UINT64_MAX, engine.NextExportNs());
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(telemetry));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.telTypes[1]));
+    ASSERT_EQ(SAI_STATUS_OBJECT_IN_USE, engine.Remove(s.telTypes[0]));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.collector));
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(s.transport));
+    ASSERT_EQ(SAI_STATUS_INVALID_OBJECT_TYPE, engine.Remove(s.ports[0]));
+}
+
+// sai_tam_telemetry_get_data(): size negotiation, the IPFIX messages and
+// clear on read
+TEST(tam, get_data)
+{
+    const uint32_t mtu = 128;
+    TamEngine engine(PORTS * PORT_STATS);
+    TamSetup s;
+    sai_object_id_t telemetry;
+    std::map<uint64_t, uint64_t> expect;
+
+    setup(engine, s, SAI_TAM_TRANSPORT_TYPE_NONE, mtu, 31337, 15);
+
+    // labels name the counter, the tel types alternate
+    for (uint32_t p = 0; p < PORTS; p++)
+    {
+        uint64_t *counters = engine.GetCounters(s.ports[p]);
+
+        for (uint32_t i = 0; i < PORT_STATS; i++)
+        {
+            sai_object_id_t oid;
+            uint64_t label = p * 100 + i;
+
+            counters[i] = 1000000 * (p + 1) + i;
+            expect[label] = counters[i];
+            ASSERT_EQ(SAI_STATUS_SUCCESS, subscribe(engine, oid, s.telTypes[(p + i) % 2], s.ports[p], i, label));
+        }
+    }
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_telemetry(engine, telemetry, s, 0));
+
+    sai_object_list_t list;
+    sai_size_t size = 0;
+
+    list.count = 1;
+    list.list = &telemetry;
+
+    ASSERT_EQ(SAI_STATUS_BUFFER_OVERFLOW, engine.GetTelemetryData(list, false, &size, NULL));
+    ASSERT_GT(size, 0u);
+
+    std::vector<uint8_t> buf(size + 64, 0xEE);
+    sai_size_t shortSize = size - 1;
+
+    // a short buffer is left alone
+    ASSERT_EQ(SAI_STATUS_BUFFER_OVERFLOW, engine.GetTelemetryData(list, true, &shortSize, buf.data()));
+    ASSERT_EQ(size, shortSize);
+    ASSERT_EQ(0xEE, buf[0]);
+    ASSERT_EQ(1000000u, engine.GetCounters(s.ports[0])[0]);
+
+    sai_size_t filled = buf.size();
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetTelemetryData(list, false, &filled, buf.data()));
+    ASSERT_EQ(size, filled);
+    ASSERT_EQ(0xEE, buf[size]);
+
+    std::vector<TamIpfixMessage> msgs;
+
+    ASSERT_TRUE(decode_all(buf.data(), filled, msgs));
+    ASSERT_GT(msgs.size(), 1u);
+
+    // templates first, the sequence counts the data records before
+    uint32_t sequence = 0;
+    std::map<uint64_t, uint64_t> got;
+
+    ASSERT_EQ(2u, msgs[0].templates);
+    ASSERT_EQ((uint32_t)ENTERPRISE, msgs[0].enterpriseNumber);
+
+    for (size_t m = 0; m < msgs.size(); m++)
+    {
+        ASSERT_LE(msgs[m].length, mtu - TAM_EXPORT_HEADROOM);
+        ASSERT_EQ(sequence, msgs[m].sequence);
+        ASSERT_EQ(tam_oid_index(telemetry) + 1, msgs[m].domain);
+        ASSERT_GT(msgs[m].exportTime, 1600000000u);
+
+        if (m)
+        {
+            ASSERT_EQ(0u, msgs[m].templates);
+        }
+
+        for (size_t r = 0; r < msgs[m].records.size(); r++)
+        {
+            const TamIpfixRecord &record = msgs[m].records[r];
+            uint64_t port = record.label / 100;
+            uint64_t stat = record.label % 100;
+
+            ASSERT_EQ(TAM_IPFIX_TEMPLATE_ID_BASE + tam_oid_index(s.telTypes[(port + stat) % 2]), record.templateId);
+            got[record.label] = record.counter;
+        }
+
+        sequence += (uint32_t)msgs[m].records.size();
+    }
+
+    ASSERT_EQ(expect, got);
+
+    // clear on read: this read still has the values, the next one zeros,
+    // and the sequence goes on
+    filled = size;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetTelemetryData(list, true, &filled, buf.data()));
+    ASSERT_EQ(0u, engine.GetCounters(s.ports[1])[3]);
+
+    msgs.clear();
+    ASSERT_TRUE(decode_all(buf.data(), filled, msgs));
+    ASSERT_EQ(sequence, msgs[0].sequence);
+
+    filled = size;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.GetTelemetryData(list, false, &filled, buf.data()));
+
+    msgs.clear();
+    ASSERT_TRUE(decode_all(buf.data(), filled, msgs));
+    ASSERT_EQ(2 * sequence, msgs[0].sequence);
+
+    for (size_t m = 0; m < msgs.size(); m++)
+    {
+        for (size_t r = 0; r < msgs[m].records.size(); r++)
+        {
+            ASSERT_EQ(0u, msgs[m].records[r].counter);
+        }
+    }
+
+    // bad object lists
+    list.list = &s.collector;
+    ASSERT_EQ(SAI_STATUS_INVALID_OBJECT_TYPE, engine.GetTelemetryData(list, false, &filled, buf.data()));
+    ASSERT_EQ(SAI_STATUS_INVALID_PARAMETER, engine.GetTelemetryData(list, false, NULL, buf.data()));
+
+    sai_object_id_t missing = tam_oid(SAI_OBJECT_TYPE_TAM_TELEMETRY, 7);
+
+    list.list = &missing;
+    ASSERT_EQ(SAI_STATUS_INVALID_OBJECT_ID, engine.GetTelemetryData(list, false, &filled, buf.data()));
+}
+
+// exports to a UDP collector on the loopback at the reporting interval,
+// templates only when due
+TEST(tam, export)
+{
+    struct sockaddr_in sin;
+    socklen_t sinLen = sizeof(sin);
+    struct timeval tv = { 1, 0 };
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    ASSERT_GE(fd, 0);
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(fd, (struct sockaddr*)&sin, sizeof(sin)));
+    ASSERT_EQ(0, getsockname(fd, (struct sockaddr*)&sin, &sinLen));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    TamEngine engine(PORTS * PORT_STATS);
+    TamSetup s;
+    sai_object_id_t telemetry;
+    uint64_t now = 5 * NS_PER_SEC;
+
+    ASSERT_TRUE(engine.Open("127.0.0.1", 0));
+    setup(engine, s, SAI_TAM_TRANSPORT_TYPE_UDP, 200, ntohs(sin.sin_port), 1);
+
+    for (uint32_t p = 0; p < PORTS; p++)
+    {
+        for (uint32_t i = 0; i < PORT_STATS; i++)
+        {
+            sai_object_id_t oid;
+
+            ASSERT_EQ(SAI_STATUS_SUCCESS, subscribe(engine, oid, s.telTypes[i % 2], s.ports[p], i, p * 100 + i));
+        }
+    }
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, create_telemetry(engine, telemetry, s, now));
+    ASSERT_EQ(now + NS_PER_SEC, engine.NextExportNs());
+    ASSERT_EQ(0u, engine.Poll(now + NS_PER_SEC - 1));
+
+    // the first export has the templates, the next ones within the
+    // minute don't, then they are due again
+    uint64_t at[] = { 1, 2, 61 };
+    uint32_t templates[] = { 2, 0, 2 };
+    uint32_t sequence = 0;
+
+    for (int e = 0; e < 3; e++)
+    {
+        uint64_t before = engine.Datagrams();
+
+        engine.GetCounters(s.ports[2])[5] = 77 + e;
+        ASSERT_EQ(1u, engine.Poll(now + at[e] * NS_PER_SEC));
+        ASSERT_EQ(now + (at[e] + 1) * NS_PER_SEC, engine.NextExportNs());
+
+        uint64_t datagrams = engine.Datagrams() - before;
+        uint32_t seen = 0;
+        uint32_t records = 0;
+        bool found = false;
+
+        ASSERT_GT(datagrams, 1u);
+
+        for (uint64_t d = 0; d < datagrams; d++)
+        {
+            uint8_t buf[256];
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            TamIpfixMessage msg;
+
+            ASSERT_GT(len, 0);
+            ASSERT_LE(len, 200 - TAM_EXPORT_HEADROOM);
+            ASSERT_TRUE(tam_ipfix_decode(buf, (size_t)len, msg));
+            ASSERT_EQ(len, msg.length);
+            ASSERT_EQ(sequence + records, msg.sequence);
+
+            seen += msg.templates;
+            records += (uint32_t)msg.records.size();
+
+            for (size_t r = 0; r < msg.records.size(); r++)
+            {
+                if (msg.records[r].label == 205)
+                {
+                    ASSERT_EQ(77u + e, msg.records[r].counter);
+                    found = true;
+                }
+            }
+        }
+
+        ASSERT_EQ(templates[e], seen);
+        ASSERT_EQ((uint32_t)(PORTS * PORT_STATS), records);
+        ASSERT_TRUE(found);
+        sequence += records;
+    }
+
+    // a late poll does not export twice
+    ASSERT_EQ(1u, engine.Poll(now + 70 * NS_PER_SEC));
+    ASSERT_EQ(now + 71 * NS_PER_SEC, engine.NextExportNs());
+    ASSERT_EQ(4u, engine.Exports());
+    ASSERT_EQ(0u, engine.SendDrops());
+
+    close(fd);
+}
+
+// profile from DATAPLANE_TAM_BENCH ("subscriptions=..,interval=..,seconds=.."),
+// the JSON report goes to DATAPLANE_TAM_BENCH_JSON when it is set
+TEST(tam, bench)
+{
+    TamProfile profile;
+    TamBenchResult result;
+    const char *env = getenv("DATAPLANE_TAM_BENCH");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    TamEngine engine(profile.subscriptions);
+    TamBench bench(&engine);
+
+    bool ok = bench.Run(profile, result);
+    TamBench::Show(result);
+
+    std::string json = TamBench::ToJson(profile, result);
+    const char *jsonPath = getenv("DATAPLANE_TAM_BENCH_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(profile.subscriptions, engine.Size());
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include "timer_wheel.h"
+
+#define SLOT_MASK   (TIMER_WHEEL_SLOTS - 1)
+
+TimerWheel::TimerWheel(uint32_t timers, uint64_t tickNs, uint64_t nowNs) :
+    m_tickNs(tickNs ? tickNs : 1),
+    m_tick(nowNs / m_tickNs + 1),
+    m_pending(0),
+    m_nodes(timers),
+    m_heads(TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS, TIMER_WHEEL_NONE)
+{
+    for (uint32_t i = 0; i < timers; i++)
+    {
+        m_nodes[i].slot = TIMER_WHEEL_NONE;
+    }
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        m_levelCount[level] = 0;
+    }
+}
+
+void TimerWheel::Link(uint32_t id)
+{
+    Node &node = m_nodes[id];
+    // overdue fires with the next tick, farther than the wheel reaches
+    // waits in the farthest slot of the top level
+    uint64_t tick = std::max(node.expiresTick, m_tick);
+    uint64_t delta = std::min<uint64_t>(tick - m_tick, (1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1);
+    uint32_t level = 0;
+
+    tick = m_tick + delta;
+
+    // delta >= 256^level puts the slot past the level's current one
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    uint32_t index = (uint32_t)(tick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+
+    node.slot = level * TIMER_WHEEL_SLOTS + index;
+    m_levelCount[level]++;
+    node.prev = TIMER_WHEEL_NONE;
+    node.next = m_heads[node.slot];
+
+    if (node.next != TIMER_WHEEL_NONE)
+    {
+        m_nodes[node.next].prev = id;
+    }
+
+    m_heads[node.slot] = id;
+}
+
+void TimerWheel::Unlink(uint32_t id)
+{
+    Node &node = m_nodes[id];
+
+    if (node.prev != TIMER_WHEEL_NONE)
+    {
+        m_nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        m_heads[node.slot] = node.next;
+    }
+
+    if (node.next != TIMER_WHEEL_NONE)
+    {
+        m_nodes[node.next].prev = node.prev;
+    }
+
+    m_levelCount[node.slot / TIMER_WHEEL_SLOTS]--;
+    node.slot = TIMER_WHEEL_NONE;
+}
+
+void TimerWheel::Schedule(uint32_t id, uint64_t expiresNs)
+{
+    if (id >= m_nodes.size())
+    {
+        return;
+    }
+
+    if (m_nodes[id].slot != TIMER_WHEEL_NONE)
+    {
+        Unlink(id);
+    }
+    else
+    {
+        m_pending++;
+    }
+
+    m_nodes[id].expiresTick = (expiresNs + m_tickNs - 1) / m_tickNs;
+
+    Link(id);
+}
+
+void TimerWheel::Cancel(uint32_t id)
+{
+    if (id < m_nodes.size() && m_nodes[id].slot != TIMER_WHEEL_NONE)
+    {
+        Unlink(id);
+        m_pending--;
+    }
+}
+
+bool TimerWheel::IsPending(uint32_t id) const
+{
+    return id < m_nodes.size() && m_nodes[id].slot != TIMER_WHEEL_NONE;
+}
+
+// moves the timers of the level's current slot one level down (or to
+// where they now belong)
+void TimerWheel::Cascade(uint32_t level)
+{
+    uint32_t slot = level * TIMER_WHEEL_SLOTS +
+                    ((uint32_t)(m_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    uint32_t id = m_heads[slot];
+
+    m_heads[slot] = TIMER_WHEEL_NONE;
+
+    while (id != TIMER_WHEEL_NONE)
+    {
+        uint32_t next = m_nodes[id].next;
+
+        m_levelCount[level]--;
+        Link(id);
+        id = next;
+    }
+}
+
+void TimerWheel::Advance(uint64_t nowNs, std::vector<uint32_t> &expired)
+{
+    uint64_t target = nowNs / m_tickNs;
+
+    while (m_tick <= target)
+    {
+        // nothing pending, nothing to cascade
+        if (m_pending == 0)
+        {
+            m_tick = target + 1;
+            break;
+        }
+
+        // with the lower levels empty nothing happens before the lowest
+        // non empty level cascades its next slot
+        uint32_t lowest = 0;
+
+        while (lowest < TIMER_WHEEL_LEVELS - 1 && m_levelCount[lowest] == 0)
+        {
+            lowest++;
+        }
+
+        if (lowest > 0)
+        {
+            uint64_t span = 1ULL << (TIMER_WHEEL_SLOT_BITS * lowest);
+            uint64_t boundary = (m_tick + span - 1) & ~(span - 1);
+
+            if (boundary > target)
+            {
+                m_tick = target + 1;
+                break;
+            }
+
+            m_tick = boundary;
+        }
+
+        for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            if (m_tick & ((1ULL << (TIMER_WHEEL_SLOT_BITS * level)) - 1))
+            {
+                break;
+            }
+
+            Cascade(level);
+        }
+
+        uint32_t slot = (uint32_t)m_tick & SLOT_MASK;
+        uint32_t id = m_heads[slot];
+
+        m_heads[slot] = TIMER_WHEEL_NONE;
+
+        while (id != TIMER_WHEEL_NONE)
+        {
+            Node &node = m_nodes[id];
+            uint32_t next = node.next;
+
+            m_levelCount[0]--;
+            node.slot = TIMER_WHEEL_NONE;
+
+            // parked in a far slot, not due yet
+            if (node.expiresTick > m_tick)
+            {
+                Link(id);
+            }
+            else
+            {
+                m_pending--;
+                expired.push_back(id);
+            }
+
+            id = next;
+        }
+
+        m_tick++;
+    }
+}
+
+uint32_t TimerWheel::Pending() const
+{
+    return m_pending;
+}
+
+uint64_t TimerWheel::TickNs() const
+{
+    return m_tickNs;
+}
+
+uint64_t TimerWheel::NowNs() const
+{
+    return (m_tick - 1) * m_tickNs;
+}
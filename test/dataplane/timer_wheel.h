@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#define TIMER_WHEEL_LEVELS      4
+#define TIMER_WHEEL_SLOT_BITS   8
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_NONE        0xFFFFFFFFu
+
+// Hierarchical timer wheel over a fixed set of timer ids 0..timers-1.
+//
+// Level 0 has one slot per tick, level N one slot per 256^N ticks; timers
+// move down a level when the level below wraps, so scheduling, cancelling
+// and firing are O(1) whatever the number of pending timers. Expiry times
+// are rounded up to the next tick, a timer never fires early. Timers past
+// the last level are parked in its farthest slot and cascade again. Empty
+// stretches are skipped up to the next slot of the lowest non empty level.
+class TimerWheel
+{
+    struct Node
+    {
+        uint64_t expiresTick;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t slot;              // level * TIMER_WHEEL_SLOTS + index, or TIMER_WHEEL_NONE
+    };
+
+    uint64_t m_tickNs;
+    uint64_t m_tick;                // next tick to fire, earlier ones are done
+    uint32_t m_pending;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_heads;
+    uint32_t m_levelCount[TIMER_WHEEL_LEVELS];
+
+    void Link(uint32_t id);
+    void Unlink(uint32_t id);
+    void Cascade(uint32_t level);
+
+public:
+    TimerWheel(uint32_t timers, uint64_t tickNs, uint64_t nowNs);
+
+    // (re)schedules id to fire at expiresNs
+    void Schedule(uint32_t id, uint64_t expiresNs);
+    void Cancel(uint32_t id);
+    bool IsPending(uint32_t id) const;
+
+    // appends the ids due up to nowNs in expiry tick order
+    void Advance(uint64_t nowNs, std::vector<uint32_t> &expired);
+
+    uint32_t Pending() const;
+    uint64_t TickNs() const;
+    uint64_t NowNs() const;
+};
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <map>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "timer_wheel.h"
+
+TEST(timer_wheel, fires_in_order_and_never_early)
+{
+    TimerWheel wheel(8, 1000, 0);
+    std::vector<uint32_t> expired;
+
+    wheel.Schedule(0, 5500);
+    wheel.Schedule(1, 2000);
+    wheel.Schedule(2, 300000);      // level 1
+    wheel.Schedule(3, 1000);
+    ASSERT_EQ(4u, wheel.Pending());
+
+    wheel.Advance(1999, expired);
+    ASSERT_EQ(1u, expired.size());
+    ASSERT_EQ(3u, expired[0]);
+
+    // 5500 rounds up to the 6000 tick
+    wheel.Advance(5999, expired);
+    ASSERT_EQ(2u, expired.size());
+    ASSERT_EQ(1u, expired[1]);
+
+    wheel.Advance(6000, expired);
+    ASSERT_EQ(3u, expired.size());
+    ASSERT_EQ(0u, expired[2]);
+
+    // rescheduling moves, cancelling drops
+    wheel.Schedule(1, 7000);
+    wheel.Schedule(1, 8000);
+    wheel.Cancel(2);
+    ASSERT_FALSE(wheel.IsPending(2));
+
+    expired.clear();
+    wheel.Advance(1000000, expired);
+    ASSERT_EQ(1u, expired.size());
+    ASSERT_EQ(1u, expired[0]);
+    ASSERT_EQ(0u, wheel.Pending());
+}
+
+// random schedules against a sorted reference, across all levels
+TEST(timer_wheel, matches_reference)
+{
+    const uint32_t timers = 4096;
+    const uint64_t tickNs = 50000;
+    std::mt19937_64 rng(7);
+    TimerWheel wheel(timers, tickNs, 0);
+    std::vector<uint64_t> due(timers, 0);   // 0 once fired
+    std::vector<uint32_t> expired;
+    uint64_t now = 0;
+
+    for (uint32_t id = 0; id < timers; id++)
+    {
+        // up to beyond the top level (256^4 ticks)
+        uint64_t span = 1ULL << (10 + rng() % 44);
+
+        due[id] = now + 1 + rng() % span;
+        wheel.Schedule(id, due[id]);
+    }
+
+    while (wheel.Pending())
+    {
+        uint64_t before = now;
+        uint64_t last = 0;
+
+        now += tickNs * (1 + rng() % 1000000);
+        expired.clear();
+        wheel.Advance(now, expired);
+
+        for (size_t i = 0; i < expired.size(); i++)
+        {
+            uint32_t id = expired[i];
+            uint64_t tick = (due[id] + tickNs - 1) / tickNs;
+
+            // due in this step, not before it, and in tick order
+            ASSERT_NE(0u, due[id]);
+            ASSERT_LE(due[id], now);
+            ASSERT_GT(tick * tickNs, before) << "timer " << id << " fired late";
+            ASSERT_LE(last, tick);
+            last = tick;
+            due[id] = 0;
+
+            // some come back
+            if (rng() % 4 == 0)
+            {
+                due[id] = now + 1 + rng() % (tickNs * 300000);
+                wheel.Schedule(id, due[id]);
+            }
+        }
+    }
+
+    for (uint32_t id = 0; id < timers; id++)
+    {
+        ASSERT_EQ(0u, due[id]);
+    }
+}
@@ -0,0 +1,1430 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "twamp.h"
+
+#define TWAMP_BATCH                 64
+#define TWAMP_RX_BATCHES_PER_POLL   64
+#define TWAMP_RX_SLOT_LEN           65536       // room for a GRO train
+#define TWAMP_GSO_MAX_BYTES         65000       // below the IPv4 UDP payload limit
+#define TWAMP_CONTROL_LEN           128
+#define TWAMP_SOCKET_BUFFER         (4 * 1024 * 1024)
+#define TWAMP_DEFAULT_TTL           255
+
+// seconds from 1900 (NTP era 0) to 1970
+#define NTP_UNIX_OFFSET             2208988800ULL
+#define NS_PER_SEC                  1000000000ULL
+#define NS_PER_MS                   1000000ULL
+
+#define SIDE_SENDER                 0
+#define SIDE_REFLECTOR              1
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO                     104
+#endif
+
+#define TIMER_TX(index)             ((index) * 3)
+#define TIMER_STATS(index)          ((index) * 3 + 1)
+#define TIMER_TIMEOUT(index)        ((index) * 3 + 2)
+
+static sai_twamp_session_stat_t s_statIds[TWAMP_SESSION_STAT_COUNT] = {
+    SAI_TWAMP_SESSION_STAT_RX_PACKETS,
+    SAI_TWAMP_SESSION_STAT_RX_BYTE,
+    SAI_TWAMP_SESSION_STAT_TX_PACKETS,
+    SAI_TWAMP_SESSION_STAT_TX_BYTE,
+    SAI_TWAMP_SESSION_STAT_DROP_PACKETS,
+    SAI_TWAMP_SESSION_STAT_MAX_LATENCY,
+    SAI_TWAMP_SESSION_STAT_MIN_LATENCY,
+    SAI_TWAMP_SESSION_STAT_AVG_LATENCY,
+    SAI_TWAMP_SESSION_STAT_MAX_JITTER,
+    SAI_TWAMP_SESSION_STAT_MIN_JITTER,
+    SAI_TWAMP_SESSION_STAT_AVG_JITTER,
+    SAI_TWAMP_SESSION_STAT_FIRST_TS,
+    SAI_TWAMP_SESSION_STAT_LAST_TS,
+    SAI_TWAMP_SESSION_STAT_DURATION_TS,
+};
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    v = htons(v);
+    memcpy(p, &v, 2);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    uint16_t v;
+
+    memcpy(&v, p, 2);
+
+    return ntohs(v);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+
+    return ntohl(v);
+}
+
+// NTP: seconds since 1900 and a binary fraction, PTP: seconds since 1970
+// and nanoseconds
+static void put_timestamp(uint8_t *p, uint64_t ns, uint16_t errorEstimate)
+{
+    uint64_t sec = ns / NS_PER_SEC;
+    uint64_t frac = ns % NS_PER_SEC;
+
+    if (errorEstimate & TWAMP_ERROR_Z)
+    {
+        put32(p, (uint32_t)sec);
+        put32(p + 4, (uint32_t)frac);
+    }
+    else
+    {
+        put32(p, (uint32_t)(sec + NTP_UNIX_OFFSET));
+        put32(p + 4, (uint32_t)((frac << 32) / NS_PER_SEC));
+    }
+}
+
+static uint64_t get_timestamp(const uint8_t *p, uint16_t errorEstimate)
+{
+    uint64_t sec = get32(p);
+    uint64_t frac = get32(p + 4);
+
+    if (errorEstimate & TWAMP_ERROR_Z)
+    {
+        return sec * NS_PER_SEC + frac;
+    }
+
+    // era 0 runs out in 2036, later values are the next era
+    sec = (uint32_t)(sec - NTP_UNIX_OFFSET);
+
+    return sec * NS_PER_SEC + ((frac * NS_PER_SEC + (1ULL << 31)) >> 32);
+}
+
+size_t twamp_encode_sender(const TwampTestPacket &pkt, uint8_t *buf, size_t len)
+{
+    if (len < TWAMP_SENDER_PACKET_LEN || len > TWAMP_MAX_PACKET_LEN)
+    {
+        return 0;
+    }
+
+    put32(buf, pkt.seq);
+    put_timestamp(buf + 4, pkt.timestampNs, pkt.errorEstimate);
+    put16(buf + 12, pkt.errorEstimate);
+    put16(buf + 14, pkt.ssid);
+    memset(buf + TWAMP_SENDER_PACKET_LEN, 0, len - TWAMP_SENDER_PACKET_LEN);
+
+    return len;
+}
+
+size_t twamp_encode_reflected(const TwampTestPacket &pkt, uint8_t *buf, size_t len)
+{
+    if (len < TWAMP_REFLECTED_PACKET_LEN || len > TWAMP_MAX_PACKET_LEN)
+    {
+        return 0;
+    }
+
+    put32(buf, pkt.seq);
+    put_timestamp(buf + 4, pkt.timestampNs, pkt.errorEstimate);
+    put16(buf + 12, pkt.errorEstimate);
+    put16(buf + 14, pkt.ssid);
+    put_timestamp(buf + 16, pkt.receiveTimestampNs, pkt.errorEstimate);
+    put32(buf + 24, pkt.senderSeq);
+    put_timestamp(buf + 28, pkt.senderTimestampNs, pkt.senderErrorEstimate);
+    put16(buf + 36, pkt.senderErrorEstimate);
+    put16(buf + 38, 0);
+    buf[40] = pkt.senderTtl;
+    memset(buf + TWAMP_REFLECTED_PACKET_LEN, 0, len - TWAMP_REFLECTED_PACKET_LEN);
+
+    return len;
+}
+
+bool twamp_decode_sender(const uint8_t *buf, size_t len, TwampTestPacket &pkt)
+{
+    if (len < TWAMP_SENDER_PACKET_LEN)
+    {
+        return false;
+    }
+
+    pkt.seq = get32(buf);
+    pkt.errorEstimate = get16(buf + 12);
+    pkt.timestampNs = get_timestamp(buf + 4, pkt.errorEstimate);
+    pkt.ssid = get16(buf + 14);
+
+    return true;
+}
+
+bool twamp_decode_reflected(const uint8_t *buf, size_t len, TwampTestPacket &pkt)
+{
+    if (len < TWAMP_REFLECTED_PACKET_LEN)
+    {
+        return false;
+    }
+
+    twamp_decode_sender(buf, len, pkt);
+    pkt.receiveTimestampNs = get_timestamp(buf + 16, pkt.errorEstimate);
+    pkt.senderSeq = get32(buf + 24);
+    pkt.senderErrorEstimate = get16(buf + 36);
+    pkt.senderTimestampNs = get_timestamp(buf + 28, pkt.senderErrorEstimate);
+    pkt.senderTtl = buf[40];
+
+    return true;
+}
+
+TwampSessionConfig::TwampSessionConfig()
+{
+    role = SAI_TWAMP_SESSION_ROLE_SENDER;
+    timestampFormat = SAI_TWAMP_TIMESTAMP_FORMAT_NTP;
+    txMode = SAI_TWAMP_PKT_TX_MODE_CONTINUOUS;
+    enableTransmit = false;
+    packetLength = 256;
+    udpSrcPort = 0;
+    udpDstPort = 0;
+    dscp = 0;
+    ttl = TWAMP_DEFAULT_TTL;
+    txPacketCount = 0;
+    txPeriodMs = 0;
+    txIntervalMs = 1000;
+    timeoutSec = 3;
+    statisticsIntervalMs = 10000;
+}
+
+static sai_status_t parse_attrs(TwampSessionConfig &config,
+                                uint32_t attr_count,
+                                const sai_attribute_t *attr_list,
+                                bool create)
+{
+    uint32_t mandatory = 0;
+    uint32_t lookupMandatory = 0;
+    bool hwLookup = true;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+        sai_status_t badValue = SAI_STATUS_INVALID_ATTR_VALUE_0 + i;
+
+        switch (attr.id)
+        {
+            case SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT:
+            case SAI_TWAMP_SESSION_ATTR_TRANSMIT_PORT:
+            case SAI_TWAMP_SESSION_ATTR_RECEIVE_PORT:
+            case SAI_TWAMP_SESSION_ATTR_VIRTUAL_ROUTER:
+            case SAI_TWAMP_SESSION_ATTR_SRC_MAC:
+            case SAI_TWAMP_SESSION_ATTR_DST_MAC:
+            case SAI_TWAMP_SESSION_ATTR_VLAN_PRI:
+            case SAI_TWAMP_SESSION_ATTR_VLAN_CFI:
+            case SAI_TWAMP_SESSION_ATTR_DSCP:
+            case SAI_TWAMP_SESSION_ATTR_TTL:
+                break;
+
+            default:
+                if (!create)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+
+        switch (attr.id)
+        {
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_MODE:
+                if (attr.value.s32 == SAI_TWAMP_MODE_FULL)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                if (attr.value.s32 != SAI_TWAMP_MODE_LIGHT)
+                {
+                    return badValue;
+                }
+                mandatory |= 1 << 0;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_SESSION_ROLE:
+                if (attr.value.s32 != SAI_TWAMP_SESSION_ROLE_SENDER &&
+                    attr.value.s32 != SAI_TWAMP_SESSION_ROLE_REFLECTOR)
+                {
+                    return badValue;
+                }
+                config.role = (sai_twamp_session_role_t)attr.value.s32;
+                mandatory |= 1 << 1;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_AUTH_MODE:
+                if (attr.value.s32 == SAI_TWAMP_SESSION_AUTH_MODE_AUTHENTICATED ||
+                    attr.value.s32 == SAI_TWAMP_SESSION_AUTH_MODE_ENCRYPTED)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                if (attr.value.s32 != SAI_TWAMP_SESSION_AUTH_MODE_UNAUTHENTICATED)
+                {
+                    return badValue;
+                }
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_HW_LOOKUP_VALID:
+                hwLookup = attr.value.booldata;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TRANSMIT_PORT:
+                lookupMandatory |= 1 << 0;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_SRC_MAC:
+                lookupMandatory |= 1 << 1;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_DST_MAC:
+                lookupMandatory |= 1 << 2;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_SRC_IP:
+                mandatory |= 1 << 2;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_DST_IP:
+                mandatory |= 1 << 3;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_UDP_SRC_PORT:
+                if (attr.value.u32 == 0 || attr.value.u32 > 0xFFFF)
+                {
+                    return badValue;
+                }
+                config.udpSrcPort = (uint16_t)attr.value.u32;
+                mandatory |= 1 << 4;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_UDP_DST_PORT:
+                if (attr.value.u32 == 0 || attr.value.u32 > 0xFFFF)
+                {
+                    return badValue;
+                }
+                config.udpDstPort = (uint16_t)attr.value.u32;
+                mandatory |= 1 << 5;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_DSCP:
+                if (attr.value.u8 > 63)
+                {
+                    return badValue;
+                }
+                config.dscp = attr.value.u8;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TTL:
+                if (attr.value.u8 == 0)
+                {
+                    return badValue;
+                }
+                config.ttl = attr.value.u8;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_ENCAPSULATION_TYPE:
+                if (attr.value.s32 != SAI_TWAMP_ENCAPSULATION_TYPE_IP)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_TIMESTAMP_FORMAT:
+                if (attr.value.s32 != SAI_TWAMP_TIMESTAMP_FORMAT_NTP &&
+                    attr.value.s32 != SAI_TWAMP_TIMESTAMP_FORMAT_PTP)
+                {
+                    return badValue;
+                }
+                config.timestampFormat = (sai_twamp_timestamp_format_t)attr.value.s32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT:
+                config.enableTransmit = attr.value.booldata;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH:
+                // reflected packets keep the sender's size (RFC 6038)
+                if (attr.value.u32 < TWAMP_REFLECTED_PACKET_LEN || attr.value.u32 > TWAMP_MAX_PACKET_LEN)
+                {
+                    return badValue;
+                }
+                config.packetLength = attr.value.u32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_PKT_TX_MODE:
+                if (attr.value.s32 < SAI_TWAMP_PKT_TX_MODE_CONTINUOUS ||
+                    attr.value.s32 > SAI_TWAMP_PKT_TX_MODE_PERIOD)
+                {
+                    return badValue;
+                }
+                config.txMode = (sai_twamp_pkt_tx_mode_t)attr.value.s32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TX_PKT_CNT:
+                config.txPacketCount = attr.value.u32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TX_PKT_PERIOD:
+                config.txPeriodMs = attr.value.u32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TX_INTERVAL:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.txIntervalMs = attr.value.u32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_TIMEOUT:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.timeoutSec = attr.value.u32;
+                break;
+
+            case SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL:
+                if (attr.value.u32 == 0)
+                {
+                    return badValue;
+                }
+                config.statisticsIntervalMs = attr.value.u32;
+                break;
+
+            default:
+                // addressing and tunnel, the engine has its own sockets
+                if (attr.id >= SAI_TWAMP_SESSION_ATTR_END)
+                {
+                    return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+                }
+                break;
+        }
+    }
+
+    if (create && (mandatory != (1 << 6) - 1 || (!hwLookup && lookupMandatory != (1 << 3) - 1)))
+    {
+        return SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static uint64_t realtime_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// S: the clock is synchronized, the error is 1 * 2^0 seconds
+static uint16_t error_estimate(const TwampSessionConfig &config)
+{
+    return (uint16_t)(TWAMP_ERROR_S | 1 |
+                      (config.timestampFormat == SAI_TWAMP_TIMESTAMP_FORMAT_PTP ? TWAMP_ERROR_Z : 0));
+}
+
+TwampEngine::TwampEngine(uint32_t capacity, uint64_t tickNs, uint64_t nowNs) :
+    m_capacity(capacity),
+    m_count(0),
+    m_senderFd(-1),
+    m_reflectorFd(-1),
+    m_timestamping(false),
+    m_gso(false),
+    m_sessions(capacity),
+    m_unknownDrops(0),
+    m_wheel(capacity * 3, tickNs, nowNs),
+    m_txAddr(TWAMP_BATCH),
+    m_rxBuf(TWAMP_BATCH * TWAMP_RX_SLOT_LEN),
+    m_rxControl(TWAMP_BATCH * TWAMP_CONTROL_LEN),
+    m_rxAddr(TWAMP_BATCH),
+    m_notify(NULL),
+    m_notifyCalls(0)
+{
+    memset(&m_peer, 0, sizeof(m_peer));
+
+    for (int side = 0; side < 2; side++)
+    {
+        m_txBuf[side].resize(TWAMP_BATCH * TWAMP_MAX_PACKET_LEN);
+        m_txControl[side].resize(TWAMP_BATCH * TWAMP_CONTROL_LEN);
+        m_txIndex[side].resize(TWAMP_BATCH);
+        m_txLen[side].resize(TWAMP_BATCH);
+        m_txCount[side] = 0;
+    }
+
+    m_free.reserve(capacity);
+
+    for (uint32_t i = capacity; i > 0; i--)
+    {
+        m_free.push_back(i - 1);
+    }
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        m_sessions[i].used = false;
+    }
+}
+
+TwampEngine::~TwampEngine()
+{
+    if (m_senderFd >= 0)
+    {
+        close(m_senderFd);
+    }
+
+    if (m_reflectorFd >= 0)
+    {
+        close(m_reflectorFd);
+    }
+}
+
+static int open_socket(const struct sockaddr_in &sin, bool &timestamping, bool &gso)
+{
+    int size = TWAMP_SOCKET_BUFFER;
+    int on = 1;
+    int off = 0;
+    int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // best effort, capped by net.core.[rw]mem_max
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    setsockopt(fd, IPPROTO_IP, IP_RECVTTL, &on, sizeof(on));
+
+    timestamping = setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+
+    // trains of equal sized packets go out as one GSO send and, where the
+    // path keeps them together (as the loopback does), come in as one
+    gso = setsockopt(fd, SOL_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0;
+    setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on));
+
+    if (bind(fd, (const struct sockaddr*)&sin, sizeof(sin)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool TwampEngine::Open(const char *addr, uint16_t senderPort, uint16_t reflectorPort)
+{
+    struct sockaddr_in sin;
+    bool senderStamps = false;
+    bool reflectorStamps = false;
+    bool senderGso = false;
+    bool reflectorGso = false;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+
+    if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1)
+    {
+        return false;
+    }
+
+    sin.sin_port = htons(senderPort);
+    m_senderFd = open_socket(sin, senderStamps, senderGso);
+
+    sin.sin_port = htons(reflectorPort);
+    m_reflectorFd = open_socket(sin, reflectorStamps, reflectorGso);
+
+    m_timestamping = senderStamps && reflectorStamps;
+    m_gso = senderGso && reflectorGso;
+
+    return m_senderFd >= 0 && m_reflectorFd >= 0;
+}
+
+static uint16_t socket_port(int fd)
+{
+    struct sockaddr_in sin;
+    socklen_t len = sizeof(sin);
+
+    if (fd < 0 || getsockname(fd, (struct sockaddr*)&sin, &len) < 0)
+    {
+        return 0;
+    }
+
+    return ntohs(sin.sin_port);
+}
+
+uint16_t TwampEngine::GetSenderPort() const
+{
+    return socket_port(m_senderFd);
+}
+
+uint16_t TwampEngine::GetReflectorPort() const
+{
+    return socket_port(m_reflectorFd);
+}
+
+bool TwampEngine::SetPeer(const char *addr, uint16_t port)
+{
+    m_peer.sin_family = AF_INET;
+    m_peer.sin_port = htons(port);
+
+    return inet_pton(AF_INET, addr, &m_peer.sin_addr) == 1;
+}
+
+void TwampEngine::SetNotification(sai_twamp_session_event_notification_fn notify)
+{
+    m_notify = notify;
+}
+
+// spreads the sessions over their first interval so they don't go out in
+// lockstep
+void TwampEngine::StartTx(uint32_t index, uint64_t nowNs)
+{
+    TwampSession &session = m_sessions[index];
+    uint64_t intervalNs = (uint64_t)session.config.txIntervalMs * NS_PER_MS;
+
+    session.sent = 0;
+    session.txStartNs = nowNs;
+    session.txDueNs = nowNs + (intervalNs * ((index * 40503u) & 0xFFFF) >> 16);
+    m_wheel.Schedule(TIMER_TX(index), session.txDueNs);
+}
+
+void TwampEngine::SetState(uint32_t index, sai_twamp_session_state_t state)
+{
+    TwampSession &session = m_sessions[index];
+    sai_twamp_session_event_notification_data_t data;
+
+    session.state = state;
+
+    data.twamp_session_id = index;
+    data.session_state = state;
+    data.session_stats.index = index;
+    data.session_stats.number_of_counters = TWAMP_SESSION_STAT_COUNT;
+    data.session_stats.counters_ids = s_statIds;
+    data.session_stats.counters = session.stat;
+    m_notifications.push_back(data);
+}
+
+// the interval's latency, jitter and timestamps become the session's
+// counters, an interval without replies reports zeros; only an active
+// session notifies, an inactive one has said so already
+void TwampEngine::Publish(uint32_t index)
+{
+    TwampSession &session = m_sessions[index];
+    TwampIntervalStats &iv = session.interval;
+    uint64_t *stat = session.stat;
+
+    stat[SAI_TWAMP_SESSION_STAT_MAX_LATENCY] = iv.latencyMax;
+    stat[SAI_TWAMP_SESSION_STAT_MIN_LATENCY] = iv.replies ? iv.latencyMin : 0;
+    stat[SAI_TWAMP_SESSION_STAT_AVG_LATENCY] = iv.replies ? iv.latencySum / iv.replies : 0;
+    stat[SAI_TWAMP_SESSION_STAT_MAX_JITTER] = iv.jitterMax;
+    stat[SAI_TWAMP_SESSION_STAT_MIN_JITTER] = iv.jitters ? iv.jitterMin : 0;
+    stat[SAI_TWAMP_SESSION_STAT_AVG_JITTER] = iv.jitters ? iv.jitterSum / iv.jitters : 0;
+    stat[SAI_TWAMP_SESSION_STAT_FIRST_TS] = iv.firstNs;
+    stat[SAI_TWAMP_SESSION_STAT_LAST_TS] = iv.lastNs;
+    stat[SAI_TWAMP_SESSION_STAT_DURATION_TS] = iv.lastNs - iv.firstNs;
+
+    memset(&iv, 0, sizeof(iv));
+
+    if (session.state == SAI_TWAMP_SESSION_STATE_ACTIVE)
+    {
+        SetState(index, session.state);
+    }
+}
+
+sai_status_t TwampEngine::Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list, uint64_t nowNs)
+{
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (m_free.empty())
+    {
+        return SAI_STATUS_TABLE_FULL;
+    }
+
+    TwampSessionConfig config;
+    sai_status_t status = parse_attrs(config, attr_count, attr_list, true);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    bool sender = config.role == SAI_TWAMP_SESSION_ROLE_SENDER;
+    std::unordered_map<uint16_t, uint32_t> &byKey = sender ? m_senders : m_reflectors;
+    uint16_t key = sender ? config.udpSrcPort : config.udpDstPort;
+
+    if (byKey.find(key) != byKey.end())
+    {
+        return SAI_STATUS_ITEM_ALREADY_EXISTS;
+    }
+
+    index = m_free.back();
+    m_free.pop_back();
+    m_count++;
+
+    TwampSession &session = m_sessions[index];
+
+    session = TwampSession();
+    session.config = config;
+    session.used = true;
+    session.state = SAI_TWAMP_SESSION_STATE_INACTIVE;
+    session.lastLatency = -1;
+
+    byKey[key] = index;
+
+    if (sender)
+    {
+        m_wheel.Schedule(TIMER_STATS(index), nowNs + (uint64_t)config.statisticsIntervalMs * NS_PER_MS);
+
+        if (config.enableTransmit)
+        {
+            StartTx(index, nowNs);
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TwampEngine::Remove(uint32_t index)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    TwampSession &session = m_sessions[index];
+
+    m_wheel.Cancel(TIMER_TX(index));
+    m_wheel.Cancel(TIMER_STATS(index));
+    m_wheel.Cancel(TIMER_TIMEOUT(index));
+
+    if (session.config.role == SAI_TWAMP_SESSION_ROLE_SENDER)
+    {
+        m_senders.erase(session.config.udpSrcPort);
+    }
+    else
+    {
+        m_reflectors.erase(session.config.udpDstPort);
+    }
+
+    // a reflection still in the TX batch is sent but not counted
+    session.used = false;
+    m_free.push_back(index);
+    m_count--;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TwampEngine::Set(uint32_t index, const sai_attribute_t *attr, uint64_t nowNs)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    TwampSession &session = m_sessions[index];
+    TwampSessionConfig config = session.config;
+    sai_status_t status = parse_attrs(config, 1, attr, false);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    bool start = config.enableTransmit && !session.config.enableTransmit;
+
+    session.config = config;
+
+    if (config.role != SAI_TWAMP_SESSION_ROLE_SENDER)
+    {
+        return SAI_STATUS_SUCCESS;
+    }
+
+    if (start)
+    {
+        StartTx(index, nowNs);
+    }
+    else if (!config.enableTransmit)
+    {
+        m_wheel.Cancel(TIMER_TX(index));
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TwampEngine::Get(uint32_t index, uint32_t attr_count, sai_attribute_t *attr_list) const
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (attr_count && attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    const TwampSessionConfig &config = m_sessions[index].config;
+
+    for (uint32_t i = 0; i < attr_count; i++)
+    {
+        sai_attribute_value_t &value = attr_list[i].value;
+
+        switch (attr_list[i].id)
+        {
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_MODE:
+                value.s32 = SAI_TWAMP_MODE_LIGHT;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_SESSION_ROLE:
+                value.s32 = config.role;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_AUTH_MODE:
+                value.s32 = SAI_TWAMP_SESSION_AUTH_MODE_UNAUTHENTICATED;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_UDP_SRC_PORT:
+                value.u32 = config.udpSrcPort;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_UDP_DST_PORT:
+                value.u32 = config.udpDstPort;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_DSCP:
+                value.u8 = config.dscp;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TTL:
+                value.u8 = config.ttl;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_ENCAPSULATION_TYPE:
+                value.s32 = SAI_TWAMP_ENCAPSULATION_TYPE_IP;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_TIMESTAMP_FORMAT:
+                value.s32 = config.timestampFormat;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT:
+                value.booldata = config.enableTransmit;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH:
+                value.u32 = config.packetLength;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TWAMP_PKT_TX_MODE:
+                value.s32 = config.txMode;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TX_PKT_CNT:
+                value.u32 = config.txPacketCount;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TX_PKT_PERIOD:
+                value.u32 = config.txPeriodMs;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TX_INTERVAL:
+                value.u32 = config.txIntervalMs;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_TIMEOUT:
+                value.u32 = config.timeoutSec;
+                break;
+            case SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL:
+                value.u32 = config.statisticsIntervalMs;
+                break;
+            default:
+                if (attr_list[i].id < SAI_TWAMP_SESSION_ATTR_END)
+                {
+                    return SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + i;
+                }
+                return SAI_STATUS_INVALID_ATTRIBUTE_0 + i;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t TwampEngine::GetStats(uint32_t index,
+                                   uint32_t number_of_counters,
+                                   const sai_stat_id_t *counter_ids,
+                                   sai_stats_mode_t mode,
+                                   uint64_t *counters)
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if ((number_of_counters && (counter_ids == NULL || counters == NULL)) ||
+        (mode != SAI_STATS_MODE_READ && mode != SAI_STATS_MODE_READ_AND_CLEAR))
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        if (counter_ids[i] >= TWAMP_SESSION_STAT_COUNT)
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    uint64_t *stat = m_sessions[index].stat;
+
+    for (uint32_t i = 0; i < number_of_counters; i++)
+    {
+        counters[i] = stat[counter_ids[i]];
+
+        if (mode == SAI_STATS_MODE_READ_AND_CLEAR)
+        {
+            stat[counter_ids[i]] = 0;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+// IP_TOS and IP_TTL, the sessions share the socket, and the GSO segment
+// size of a train
+static socklen_t put_tx_control(uint8_t *control, int tos, int ttl, uint16_t segment)
+{
+    struct cmsghdr *cmsg = (struct cmsghdr*)control;
+
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_TOS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &tos, sizeof(int));
+
+    cmsg = (struct cmsghdr*)(control + CMSG_SPACE(sizeof(int)));
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_TTL;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &ttl, sizeof(int));
+
+    if (segment == 0)
+    {
+        return (socklen_t)(2 * CMSG_SPACE(sizeof(int)));
+    }
+
+    cmsg = (struct cmsghdr*)(control + 2 * CMSG_SPACE(sizeof(int)));
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(uint16_t));
+
+    return (socklen_t)(2 * CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint16_t)));
+}
+
+void TwampEngine::Transmit(uint32_t index)
+{
+    const TwampSession &session = m_sessions[index];
+    TwampTestPacket pkt;
+
+    if (m_txCount[SIDE_SENDER] == TWAMP_BATCH)
+    {
+        FlushTx(SIDE_SENDER);
+    }
+
+    uint32_t slot = m_txCount[SIDE_SENDER]++;
+
+    pkt.seq = m_sessions[index].nextSeq;
+    pkt.errorEstimate = error_estimate(session.config);
+    pkt.ssid = session.config.udpSrcPort;
+    pkt.timestampNs = realtime_ns();
+
+    m_sessions[index].nextSeq++;
+    m_txIndex[SIDE_SENDER][slot] = index;
+    m_txLen[SIDE_SENDER][slot] = (uint32_t)twamp_encode_sender(pkt, &m_txBuf[SIDE_SENDER][slot * TWAMP_MAX_PACKET_LEN],
+                                                               session.config.packetLength);
+}
+
+// the reply keeps the sender's size, but carries at least the reflected
+// fields
+void TwampEngine::Reflect(uint32_t index, const TwampTestPacket &pkt, uint32_t len, uint64_t rxNs, uint8_t ttl,
+                          const struct sockaddr_in &from)
+{
+    TwampSession &session = m_sessions[index];
+    TwampTestPacket out;
+
+    if (m_txCount[SIDE_REFLECTOR] == TWAMP_BATCH)
+    {
+        FlushTx(SIDE_REFLECTOR);
+    }
+
+    uint32_t slot = m_txCount[SIDE_REFLECTOR]++;
+
+    out.seq = session.nextSeq++;
+    out.errorEstimate = error_estimate(session.config);
+    out.ssid = pkt.ssid;
+    out.receiveTimestampNs = rxNs;
+    out.senderSeq = pkt.seq;
+    out.senderTimestampNs = pkt.timestampNs;
+    out.senderErrorEstimate = pkt.errorEstimate;
+    out.senderTtl = ttl;
+    out.timestampNs = realtime_ns();
+
+    m_txAddr[slot] = from;
+    m_txIndex[SIDE_REFLECTOR][slot] = index;
+    m_txLen[SIDE_REFLECTOR][slot] = (uint32_t)twamp_encode_reflected(out, &m_txBuf[SIDE_REFLECTOR][slot * TWAMP_MAX_PACKET_LEN],
+                                                                     std::max<uint32_t>(len, TWAMP_REFLECTED_PACKET_LEN));
+}
+
+static bool same_addr(const struct sockaddr_in &a, const struct sockaddr_in &b)
+{
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+void TwampEngine::FlushTx(int side)
+{
+    struct mmsghdr msgs[TWAMP_BATCH];
+    struct iovec iov[TWAMP_BATCH];
+    uint32_t first[TWAMP_BATCH + 1];
+    int fd = side == SIDE_SENDER ? m_senderFd : m_reflectorFd;
+    uint32_t count = m_txCount[side];
+    uint32_t msgCount = 0;
+    uint32_t sent = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        iov[i].iov_base = &m_txBuf[side][i * TWAMP_MAX_PACKET_LEN];
+        iov[i].iov_len = m_txLen[side][i];
+    }
+
+    // consecutive packets of the same size, DSCP, TTL and destination make
+    // one GSO train, each packet its own message without GSO
+    for (uint32_t i = 0; i < count; msgCount++)
+    {
+        const TwampSessionConfig &config = m_sessions[m_txIndex[side][i]].config;
+        const struct sockaddr_in &to = side == SIDE_SENDER ? m_peer : m_txAddr[i];
+        uint32_t len = m_txLen[side][i];
+        uint8_t ttl = side == SIDE_SENDER ? config.ttl : TWAMP_DEFAULT_TTL;
+        uint32_t end = i + 1;
+
+        while (m_gso && end < count && (end - i + 1) * len <= TWAMP_GSO_MAX_BYTES && m_txLen[side][end] == len)
+        {
+            const TwampSessionConfig &next = m_sessions[m_txIndex[side][end]].config;
+
+            if (next.dscp != config.dscp || (side == SIDE_SENDER ? next.ttl != ttl : !same_addr(m_txAddr[end], to)))
+            {
+                break;
+            }
+
+            end++;
+        }
+
+        struct msghdr &msg = msgs[msgCount].msg_hdr;
+
+        memset(&msgs[msgCount], 0, sizeof(msgs[msgCount]));
+        msg.msg_name = (void*)&to;
+        msg.msg_namelen = sizeof(struct sockaddr_in);
+        msg.msg_iov = &iov[i];
+        msg.msg_iovlen = end - i;
+        msg.msg_control = &m_txControl[side][msgCount * TWAMP_CONTROL_LEN];
+        msg.msg_controllen = put_tx_control((uint8_t*)msg.msg_control, config.dscp << 2, ttl,
+                                            (uint16_t)(end - i > 1 ? len : 0));
+        first[msgCount] = i;
+        i = end;
+    }
+
+    first[msgCount] = count;
+
+    // a full socket buffer loses the rest of the batch, as a full TX
+    // queue would
+    while (sent < msgCount && fd >= 0)
+    {
+        int n = sendmmsg(fd, &msgs[sent], msgCount - sent, 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        sent += (uint32_t)n;
+    }
+
+    for (uint32_t i = 0; i < first[sent]; i++)
+    {
+        TwampSession &session = m_sessions[m_txIndex[side][i]];
+
+        if (session.used)
+        {
+            session.stat[SAI_TWAMP_SESSION_STAT_TX_PACKETS]++;
+            session.stat[SAI_TWAMP_SESSION_STAT_TX_BYTE] += m_txLen[side][i];
+        }
+    }
+
+    m_txCount[side] = 0;
+}
+
+// RFC 5357 section 4.2.1 round trip, reflector processing time excluded
+void TwampEngine::Receive(const TwampTestPacket &pkt, uint64_t rxNs, uint32_t len, uint64_t nowNs)
+{
+    std::unordered_map<uint16_t, uint32_t>::const_iterator it = m_senders.find(pkt.ssid);
+
+    if (it == m_senders.end())
+    {
+        m_unknownDrops++;
+        return;
+    }
+
+    uint32_t index = it->second;
+    TwampSession &session = m_sessions[index];
+    TwampIntervalStats &iv = session.interval;
+
+    session.stat[SAI_TWAMP_SESSION_STAT_RX_PACKETS]++;
+    session.stat[SAI_TWAMP_SESSION_STAT_RX_BYTE] += len;
+
+    // losses from the sequence gaps, a late packet takes one back
+    if ((int32_t)(pkt.senderSeq - session.expectedSeq) >= 0)
+    {
+        session.stat[SAI_TWAMP_SESSION_STAT_DROP_PACKETS] += pkt.senderSeq - session.expectedSeq;
+        session.expectedSeq = pkt.senderSeq + 1;
+    }
+    else if (session.stat[SAI_TWAMP_SESSION_STAT_DROP_PACKETS])
+    {
+        session.stat[SAI_TWAMP_SESSION_STAT_DROP_PACKETS]--;
+    }
+
+    int64_t latency = (int64_t)(rxNs - pkt.senderTimestampNs) - (int64_t)(pkt.timestampNs - pkt.receiveTimestampNs);
+
+    latency = std::max<int64_t>(latency, 0);
+
+    if (iv.replies == 0)
+    {
+        iv.latencyMin = (uint64_t)latency;
+        iv.firstNs = pkt.senderTimestampNs;
+    }
+
+    iv.replies++;
+    iv.latencySum += (uint64_t)latency;
+    iv.latencyMin = std::min(iv.latencyMin, (uint64_t)latency);
+    iv.latencyMax = std::max(iv.latencyMax, (uint64_t)latency);
+    iv.lastNs = pkt.senderTimestampNs;
+
+    if (session.lastLatency >= 0)
+    {
+        uint64_t jitter = (uint64_t)(latency > session.lastLatency ? latency - session.lastLatency
+                                                                   : session.lastLatency - latency);
+
+        if (iv.jitters == 0)
+        {
+            iv.jitterMin = jitter;
+        }
+
+        iv.jitters++;
+        iv.jitterSum += jitter;
+        iv.jitterMin = std::min(iv.jitterMin, jitter);
+        iv.jitterMax = std::max(iv.jitterMax, jitter);
+    }
+
+    session.lastLatency = latency;
+    session.lastReplyNs = nowNs;
+
+    if (session.state == SAI_TWAMP_SESSION_STATE_INACTIVE)
+    {
+        SetState(index, SAI_TWAMP_SESSION_STATE_ACTIVE);
+        m_wheel.Schedule(TIMER_TIMEOUT(index), nowNs + (uint64_t)session.config.timeoutSec * NS_PER_SEC);
+    }
+}
+
+// a GRO train shares the stamp of its first packet
+static uint64_t rx_timestamp(struct msghdr &msg, uint64_t fallbackNs, uint8_t &ttl, uint32_t &segment)
+{
+    uint64_t ns = fallbackNs;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+        {
+            struct scm_timestamping stamps;
+
+            memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+
+            // raw hardware stamp when the NIC gave one, else software
+            const struct timespec &ts = stamps.ts[2].tv_sec || stamps.ts[2].tv_nsec ? stamps.ts[2] : stamps.ts[0];
+
+            if (ts.tv_sec || ts.tv_nsec)
+            {
+                ns = (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+            }
+        }
+        else if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TTL)
+        {
+            int value;
+
+            memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+            ttl = (uint8_t)value;
+        }
+        else if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+        {
+            int value;
+
+            memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+            segment = (uint32_t)value;
+        }
+    }
+
+    return ns;
+}
+
+void TwampEngine::ReceivePacket(int side, const uint8_t *buf, uint32_t len, uint64_t rxNs, uint8_t ttl,
+                                const struct sockaddr_in &from, uint64_t nowNs)
+{
+    TwampTestPacket pkt;
+
+    if (side == SIDE_SENDER)
+    {
+        if (twamp_decode_reflected(buf, len, pkt))
+        {
+            Receive(pkt, rxNs, len, nowNs);
+            return;
+        }
+    }
+    else if (twamp_decode_sender(buf, len, pkt))
+    {
+        std::unordered_map<uint16_t, uint32_t>::const_iterator it = m_reflectors.find(pkt.ssid);
+
+        if (it != m_reflectors.end())
+        {
+            TwampSession &session = m_sessions[it->second];
+
+            session.stat[SAI_TWAMP_SESSION_STAT_RX_PACKETS]++;
+            session.stat[SAI_TWAMP_SESSION_STAT_RX_BYTE] += len;
+
+            Reflect(it->second, pkt, len, rxNs, ttl, from);
+            return;
+        }
+    }
+
+    m_unknownDrops++;
+}
+
+// messages read, packets counts the packets in them
+uint32_t TwampEngine::ReceiveBatch(int side, uint64_t nowNs, uint32_t &packets)
+{
+    struct mmsghdr msgs[TWAMP_BATCH];
+    struct iovec iov[TWAMP_BATCH];
+    int fd = side == SIDE_SENDER ? m_senderFd : m_reflectorFd;
+
+    for (uint32_t i = 0; i < TWAMP_BATCH; i++)
+    {
+        iov[i].iov_base = &m_rxBuf[i * TWAMP_RX_SLOT_LEN];
+        iov[i].iov_len = TWAMP_RX_SLOT_LEN;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &m_rxAddr[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = &m_rxControl[i * TWAMP_CONTROL_LEN];
+        msgs[i].msg_hdr.msg_controllen = TWAMP_CONTROL_LEN;
+    }
+
+    int n = fd >= 0 ? recvmmsg(fd, msgs, TWAMP_BATCH, MSG_DONTWAIT, NULL) : -1;
+
+    // without kernel stamps the batch shares the time it was read
+    uint64_t readNs = n > 0 ? realtime_ns() : 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        const uint8_t *buf = &m_rxBuf[i * TWAMP_RX_SLOT_LEN];
+        uint32_t len = msgs[i].msg_len;
+        uint32_t segment = len;
+        uint8_t ttl = 0;
+        uint64_t rxNs = rx_timestamp(msgs[i].msg_hdr, readNs, ttl, segment);
+
+        for (uint32_t offset = 0; offset < len && segment; offset += segment)
+        {
+            ReceivePacket(side, buf + offset, std::min(segment, len - offset), rxNs, ttl, m_rxAddr[i], nowNs);
+            packets++;
+        }
+    }
+
+    return n > 0 ? (uint32_t)n : 0;
+}
+
+uint32_t TwampEngine::Poll(uint64_t nowNs)
+{
+    uint32_t handled = 0;
+
+    // reflect first, the replies go out with the least delay
+    for (int side = SIDE_REFLECTOR; side >= SIDE_SENDER; side--)
+    {
+        for (uint32_t batch = 0; batch < TWAMP_RX_BATCHES_PER_POLL; batch++)
+        {
+            if (ReceiveBatch(side, nowNs, handled) < TWAMP_BATCH)
+            {
+                break;
+            }
+        }
+
+        if (m_txCount[side])
+        {
+            handled += m_txCount[side];
+            FlushTx(side);
+        }
+    }
+
+    m_expired.clear();
+    m_wheel.Advance(nowNs, m_expired);
+
+    for (size_t i = 0; i < m_expired.size(); i++)
+    {
+        uint32_t index = m_expired[i] / 3;
+        TwampSession &session = m_sessions[index];
+
+        if (!session.used)
+        {
+            continue;
+        }
+
+        if (m_expired[i] == TIMER_TX(index))
+        {
+            uint64_t intervalNs = (uint64_t)session.config.txIntervalMs * NS_PER_MS;
+
+            m_txLateness.Add((double)(nowNs - std::min(nowNs, session.txDueNs)) / 1000);
+            Transmit(index);
+            session.sent++;
+            handled++;
+
+            bool done = (session.config.txMode == SAI_TWAMP_PKT_TX_MODE_PACKET_COUNT &&
+                         session.sent >= session.config.txPacketCount) ||
+                        (session.config.txMode == SAI_TWAMP_PKT_TX_MODE_PERIOD &&
+                         nowNs - session.txStartNs >= (uint64_t)session.config.txPeriodMs * NS_PER_MS);
+
+            if (!done)
+            {
+                // keep the rate, but don't burst to catch up after a stall
+                session.txDueNs = std::max(session.txDueNs + intervalNs, nowNs + intervalNs / 2);
+                m_wheel.Schedule(TIMER_TX(index), session.txDueNs);
+            }
+        }
+        else if (m_expired[i] == TIMER_STATS(index))
+        {
+            Publish(index);
+            m_wheel.Schedule(TIMER_STATS(index), nowNs + (uint64_t)session.config.statisticsIntervalMs * NS_PER_MS);
+        }
+        else if (session.state == SAI_TWAMP_SESSION_STATE_ACTIVE)
+        {
+            uint64_t timeoutNs = (uint64_t)session.config.timeoutSec * NS_PER_SEC;
+
+            // replies only move lastReplyNs, the timer catches up here
+            if (session.lastReplyNs + timeoutNs <= nowNs)
+            {
+                SetState(index, SAI_TWAMP_SESSION_STATE_INACTIVE);
+                session.lastLatency = -1;
+            }
+            else
+            {
+                m_wheel.Schedule(TIMER_TIMEOUT(index), session.lastReplyNs + timeoutNs);
+            }
+        }
+    }
+
+    if (m_txCount[SIDE_SENDER])
+    {
+        FlushTx(SIDE_SENDER);
+    }
+
+    if (!m_notifications.empty())
+    {
+        if (m_notify)
+        {
+            m_notify((uint32_t)m_notifications.size(), m_notifications.data());
+        }
+
+        m_notifyCalls++;
+        m_notifications.clear();
+    }
+
+    return handled;
+}
+
+bool TwampEngine::Timestamping() const
+{
+    return m_timestamping;
+}
+
+bool TwampEngine::Gso() const
+{
+    return m_gso;
+}
+
+BenchLatency TwampEngine::GetTxLateness() const
+{
+    return m_txLateness.Summarize();
+}
+
+void TwampEngine::ClearTxLateness()
+{
+    m_txLateness.Clear();
+}
+
+uint32_t TwampEngine::Size() const
+{
+    return m_count;
+}
+
+uint64_t TwampEngine::UnknownDrops() const
+{
+    return m_unknownDrops;
+}
+
+uint64_t TwampEngine::NotifyCalls() const
+{
+    return m_notifyCalls;
+}
+
+const TwampSession* TwampEngine::GetSession(uint32_t index) const
+{
+    if (index >= m_capacity || !m_sessions[index].used)
+    {
+        return NULL;
+    }
+
+    return &m_sessions[index];
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+#include "bench_util.h"
+#include "timer_wheel.h"
+
+// RFC 5357 unauthenticated TWAMP-Test packets, the sender one with the
+// RFC 8972 SSID after its 14 bytes
+#define TWAMP_SENDER_PACKET_LEN             16
+#define TWAMP_REFLECTED_PACKET_LEN          41
+#define TWAMP_MAX_PACKET_LEN                1472
+
+// error estimate, RFC 5357 section 4.1.2 and RFC 8186 (Z, PTP timestamp)
+#define TWAMP_ERROR_S                       0x8000
+#define TWAMP_ERROR_Z                       0x4000
+
+#define TWAMP_SESSION_STAT_COUNT            (SAI_TWAMP_SESSION_STAT_DURATION_TS + 1)
+
+// both packet kinds; the sender one only uses seq, timestampNs,
+// errorEstimate and ssid. Timestamps are nanoseconds since the Unix epoch,
+// the wire carries them in NTP or PTP format (the Z bit tells which).
+// ssid is the RFC 8972 STAMP session identifier, sent in the first MBZ
+// field, which TWAMP Light reflectors copy back.
+struct TwampTestPacket
+{
+    uint32_t seq;
+    uint64_t timestampNs;
+    uint16_t errorEstimate;
+    uint16_t ssid;
+    uint64_t receiveTimestampNs;
+    uint32_t senderSeq;
+    uint64_t senderTimestampNs;
+    uint16_t senderErrorEstimate;
+    uint8_t senderTtl;
+};
+
+// padded with zeros to len, 0 when len is below the packet kind's minimum;
+// each timestamp goes out in the format the Z bit of its error estimate
+// names
+size_t twamp_encode_sender(const TwampTestPacket &pkt, uint8_t *buf, size_t len);
+size_t twamp_encode_reflected(const TwampTestPacket &pkt, uint8_t *buf, size_t len);
+
+// false on a short packet
+bool twamp_decode_sender(const uint8_t *buf, size_t len, TwampTestPacket &pkt);
+bool twamp_decode_reflected(const uint8_t *buf, size_t len, TwampTestPacket &pkt);
+
+// SAI_TWAMP_SESSION_ATTR_* the engine runs on, the addressing and tunnel
+// attributes are accepted and ignored, only IP encapsulation is supported
+struct TwampSessionConfig
+{
+    sai_twamp_session_role_t role;
+    sai_twamp_timestamp_format_t timestampFormat;
+    sai_twamp_pkt_tx_mode_t txMode;
+    bool enableTransmit;
+    uint32_t packetLength;          // UDP payload
+    uint16_t udpSrcPort;
+    uint16_t udpDstPort;
+    uint8_t dscp;
+    uint8_t ttl;
+    uint32_t txPacketCount;
+    uint32_t txPeriodMs;
+    uint32_t txIntervalMs;
+    uint32_t timeoutSec;
+    uint32_t statisticsIntervalMs;
+
+    TwampSessionConfig();
+};
+
+// latency and jitter over one statistics interval, nanoseconds
+struct TwampIntervalStats
+{
+    uint64_t replies;
+    uint64_t latencySum;
+    uint64_t latencyMin;
+    uint64_t latencyMax;
+    uint64_t jitters;
+    uint64_t jitterSum;
+    uint64_t jitterMin;
+    uint64_t jitterMax;
+    uint64_t firstNs;
+    uint64_t lastNs;
+};
+
+struct TwampSession
+{
+    TwampSessionConfig config;
+    bool used;
+    sai_twamp_session_state_t state;
+    uint32_t nextSeq;               // next one to send (or reflect)
+    uint32_t expectedSeq;           // next reflected sender sequence
+    uint32_t sent;                  // since transmit was enabled
+    uint64_t txStartNs;
+    uint64_t txDueNs;
+    uint64_t lastReplyNs;           // engine clock
+    int64_t lastLatency;            // -1 until the first reply
+    TwampIntervalStats interval;
+    uint64_t stat[TWAMP_SESSION_STAT_COUNT];
+};
+
+// Software TWAMP Light (RFC 5357 appendix I) session-sender and
+// session-reflector.
+//
+// An engine has a sender and a reflector UDP socket. Sender sessions run
+// their TX, statistics and timeout timers on a hierarchical timer wheel;
+// Poll() reflects what the reflector socket received, takes in the
+// reflected packets, fires the due timers and sends both TX batches with
+// sendmmsg(), packets of the same size and destination as UDP GSO trains
+// where the kernel has UDP_SEGMENT (UDP_GRO keeps them together on the
+// receive side when the path does). Receive timestamps come from
+// SO_TIMESTAMPING (hardware when the NIC stamps, else the kernel's software
+// stamp) so the time a packet sat in the socket does not count as network
+// latency; the packets of a GRO train share the stamp of the first. The
+// sender and reflector stamps are taken when the packet is built.
+//
+// Sessions are keyed on the sender's UDP port: a sender session sends it as
+// STAMP SSID, a reflector session answers the SSID equal to its destination
+// port. Round trip latency is (T4 - T1) - (T3 - T2), jitter the difference
+// between consecutive round trips, both in nanoseconds. At the end of each
+// STATISTICS_INTERVAL the latency, jitter and timestamp counters of the
+// interval are published and, while the session is active, reported through
+// sai_twamp_session_event_notification_fn along with session state changes
+// (a sender turns ACTIVE on its first reply and INACTIVE after TIMEOUT
+// seconds without one), one call per Poll(); twamp_session_id carries the
+// session index. Packet and byte counters are cumulative.
+//
+// TWAMP full mode and authentication are not modelled. The engine is not
+// thread safe.
+class TwampEngine
+{
+    uint32_t m_capacity;
+    uint32_t m_count;
+    int m_senderFd;
+    int m_reflectorFd;
+    bool m_timestamping;
+    bool m_gso;
+    struct sockaddr_in m_peer;
+
+    std::vector<TwampSession> m_sessions;
+    std::vector<uint32_t> m_free;
+    std::unordered_map<uint16_t, uint32_t> m_senders;
+    std::unordered_map<uint16_t, uint32_t> m_reflectors;
+    uint64_t m_unknownDrops;
+
+    TimerWheel m_wheel;
+    std::vector<uint32_t> m_expired;
+
+    // TX batches, one per socket
+    std::vector<uint8_t> m_txBuf[2];
+    std::vector<uint8_t> m_txControl[2];
+    std::vector<struct sockaddr_in> m_txAddr;
+    std::vector<uint32_t> m_txIndex[2];
+    std::vector<uint32_t> m_txLen[2];
+    uint32_t m_txCount[2];
+
+    std::vector<uint8_t> m_rxBuf;
+    std::vector<uint8_t> m_rxControl;
+    std::vector<struct sockaddr_in> m_rxAddr;
+
+    std::vector<sai_twamp_session_event_notification_data_t> m_notifications;
+    sai_twamp_session_event_notification_fn m_notify;
+    uint64_t m_notifyCalls;
+
+    BenchHistogram m_txLateness;
+
+    void StartTx(uint32_t index, uint64_t nowNs);
+    void SetState(uint32_t index, sai_twamp_session_state_t state);
+    void Publish(uint32_t index);
+    void Transmit(uint32_t index);
+    void Reflect(uint32_t index, const TwampTestPacket &pkt, uint32_t len, uint64_t rxNs, uint8_t ttl,
+                 const struct sockaddr_in &from);
+    void Receive(const TwampTestPacket &pkt, uint64_t rxNs, uint32_t len, uint64_t nowNs);
+    void ReceivePacket(int side, const uint8_t *buf, uint32_t len, uint64_t rxNs, uint8_t ttl,
+                       const struct sockaddr_in &from, uint64_t nowNs);
+    uint32_t ReceiveBatch(int side, uint64_t nowNs, uint32_t &packets);
+    void FlushTx(int side);
+
+public:
+    TwampEngine(uint32_t capacity, uint64_t tickNs, uint64_t nowNs);
+    ~TwampEngine();
+
+    // binds both sockets, port 0 picks a free one
+    bool Open(const char *addr, uint16_t senderPort, uint16_t reflectorPort);
+    uint16_t GetSenderPort() const;
+    uint16_t GetReflectorPort() const;
+
+    // reflector the sender sessions send to
+    bool SetPeer(const char *addr, uint16_t port);
+
+    void SetNotification(sai_twamp_session_event_notification_fn notify);
+
+    sai_status_t Create(uint32_t &index, uint32_t attr_count, const sai_attribute_t *attr_list, uint64_t nowNs);
+    sai_status_t Remove(uint32_t index);
+    sai_status_t Set(uint32_t index, const sai_attribute_t *attr, uint64_t nowNs);
+    sai_status_t Get(uint32_t index, uint32_t attr_count, sai_attribute_t *attr_list) const;
+    sai_status_t GetStats(uint32_t index,
+                          uint32_t number_of_counters,
+                          const sai_stat_id_t *counter_ids,
+                          sai_stats_mode_t mode,
+                          uint64_t *counters);
+
+    // packets received and sent in this call
+    uint32_t Poll(uint64_t nowNs);
+
+    // receive timestamps come from the kernel
+    bool Timestamping() const;
+
+    // equal sized packets go out in UDP GSO trains
+    bool Gso() const;
+
+    // how late TX timers fired against their due time
+    BenchLatency GetTxLateness() const;
+    void ClearTxLateness();
+
+    uint32_t Size() const;
+    uint64_t UnknownDrops() const;
+    uint64_t NotifyCalls() const;
+    const TwampSession* GetSession(uint32_t index) const;
+};
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <stdio.h>
+
+#include "bench_util.h"
+#include "twamp_bench.h"
+
+#define TWAMP_BENCH_ADDR        "127.0.0.1"
+#define TWAMP_BENCH_PORT_BASE   1024
+#define TWAMP_BENCH_DRAIN_MS    100
+
+TwampProfile::TwampProfile()
+{
+    sessions = 1000;
+    intervalMs = 1;
+    seconds = 3;
+    statsMs = 1000;
+    length = 128;
+    tickUs = 100;
+}
+
+void TwampProfile::Parse(const std::string &profile)
+{
+    BenchProfileItems items = bench_profile_split(profile);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const std::string &key = items[i].first;
+        uint32_t value = bench_parse_uint(key, items[i].second);
+
+        if (key == "sessions")
+        {
+            sessions = value;
+        }
+        else if (key == "interval")
+        {
+            intervalMs = value;
+        }
+        else if (key == "seconds")
+        {
+            seconds = value;
+        }
+        else if (key == "stats")
+        {
+            statsMs = value;
+        }
+        else if (key == "length")
+        {
+            length = value;
+        }
+        else if (key == "tick")
+        {
+            tickUs = value;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown twamp profile key " + key);
+        }
+    }
+
+    // the SSIDs are UDP ports from TWAMP_BENCH_PORT_BASE on
+    if (sessions == 0 || sessions > 0x10000 - TWAMP_BENCH_PORT_BASE || intervalMs == 0 || seconds == 0 ||
+        statsMs == 0 || tickUs == 0 || length < TWAMP_REFLECTED_PACKET_LEN || length > TWAMP_MAX_PACKET_LEN)
+    {
+        throw std::invalid_argument("sessions, interval, seconds, stats and tick must be non zero, "
+                                    "sessions at most 64512, length between 41 and 1472");
+    }
+}
+
+TwampBench::TwampBench(TwampEngine* sender, TwampEngine* reflector) :
+    m_sender(sender),
+    m_reflector(reflector)
+{
+}
+
+// the notification callback carries no context, so a single Run() at a
+// time keeps its state here
+static uint64_t s_intervals;
+static uint64_t s_latencyMin;
+static uint64_t s_latencyMax;
+static double s_latencyAvgSum;
+static double s_jitterAvgSum;
+
+static void on_sender_event(uint32_t count, const sai_twamp_session_event_notification_data_t *data)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint64_t *stat = data[i].session_stats.counters;
+
+        // state changes repeat the last interval, only count fresh ones
+        if (data[i].session_stats.number_of_counters < TWAMP_SESSION_STAT_COUNT ||
+            stat[SAI_TWAMP_SESSION_STAT_FIRST_TS] == 0 ||
+            data[i].session_state != SAI_TWAMP_SESSION_STATE_ACTIVE)
+        {
+            continue;
+        }
+
+        s_latencyMin = s_intervals ? std::min(s_latencyMin, stat[SAI_TWAMP_SESSION_STAT_MIN_LATENCY])
+                                   : stat[SAI_TWAMP_SESSION_STAT_MIN_LATENCY];
+        s_latencyMax = std::max(s_latencyMax, stat[SAI_TWAMP_SESSION_STAT_MAX_LATENCY]);
+        s_latencyAvgSum += (double)stat[SAI_TWAMP_SESSION_STAT_AVG_LATENCY];
+        s_jitterAvgSum += (double)stat[SAI_TWAMP_SESSION_STAT_AVG_JITTER];
+        s_intervals++;
+    }
+}
+
+// polls one engine every tick
+struct TwampWorker
+{
+    TwampEngine* engine;
+    uint64_t tickNs;
+    uint32_t sessions;              // sender sessions to stop on quiesce, or 0
+    std::atomic<bool> stop;
+    std::atomic<bool> quiesce;
+    uint64_t cpuNs;
+
+    TwampWorker(TwampEngine* e, uint64_t tick, uint32_t senders) :
+        engine(e), tickNs(tick), sessions(senders), stop(false), quiesce(false), cpuNs(0)
+    {
+    }
+
+    void Run()
+    {
+        uint64_t next = bench_now_ns();
+        bool quiet = false;
+
+        while (!stop.load())
+        {
+            uint64_t cpu = bench_thread_cpu_ns();
+
+            if (quiesce.load() && !quiet)
+            {
+                sai_attribute_t attr;
+
+                attr.id = SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT;
+                attr.value.booldata = false;
+
+                for (uint32_t i = 0; i < sessions; i++)
+                {
+                    engine->Set(i, &attr, bench_now_ns());
+                }
+
+                quiet = true;
+            }
+
+            engine->Poll(bench_now_ns());
+            cpuNs += bench_thread_cpu_ns() - cpu;
+
+            // a late wakeup does not make up the lost ticks
+            next = std::max(next + tickNs, bench_now_ns());
+            bench_sleep_until(next);
+        }
+    }
+};
+
+bool TwampBench::Run(const TwampProfile &profile, TwampBenchResult &result)
+{
+    uint64_t tickNs = (uint64_t)profile.tickUs * 1000;
+
+    result = TwampBenchResult();
+
+    if (!m_sender->Open(TWAMP_BENCH_ADDR, 0, 0) || !m_reflector->Open(TWAMP_BENCH_ADDR, 0, 0) ||
+        !m_sender->SetPeer(TWAMP_BENCH_ADDR, m_reflector->GetReflectorPort()))
+    {
+        printf("failed to open twamp sockets on %s\n", TWAMP_BENCH_ADDR);
+        return false;
+    }
+
+    result.timestamping = m_sender->Timestamping() && m_reflector->Timestamping();
+
+    s_intervals = 0;
+    s_latencyMin = 0;
+    s_latencyMax = 0;
+    s_latencyAvgSum = 0;
+    s_jitterAvgSum = 0;
+
+    m_sender->SetNotification(on_sender_event);
+
+    sai_attribute_t attrs[12];
+    sai_ip_address_t ip;
+
+    ip.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    ip.addr.ip4 = htonl(INADDR_LOOPBACK);
+
+    for (uint32_t i = 0; i < profile.sessions; i++)
+    {
+        uint32_t senderPort = TWAMP_BENCH_PORT_BASE + i;
+        uint32_t index;
+        uint32_t count = 0;
+
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_TWAMP_MODE;
+        attrs[count++].value.s32 = SAI_TWAMP_MODE_LIGHT;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_SESSION_ROLE;
+        attrs[count++].value.s32 = SAI_TWAMP_SESSION_ROLE_REFLECTOR;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_SRC_IP;
+        attrs[count++].value.ipaddr = ip;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_DST_IP;
+        attrs[count++].value.ipaddr = ip;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_UDP_SRC_PORT;
+        attrs[count++].value.u32 = 862;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_UDP_DST_PORT;
+        attrs[count++].value.u32 = senderPort;
+
+        if (m_reflector->Create(index, count, attrs, bench_now_ns()) != SAI_STATUS_SUCCESS)
+        {
+            printf("failed to create twamp reflector session %u\n", i);
+            return false;
+        }
+
+        attrs[1].value.s32 = SAI_TWAMP_SESSION_ROLE_SENDER;
+        attrs[4].value.u32 = senderPort;
+        attrs[5].value.u32 = 862;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_TX_INTERVAL;
+        attrs[count++].value.u32 = profile.intervalMs;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL;
+        attrs[count++].value.u32 = profile.statsMs;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH;
+        attrs[count++].value.u32 = profile.length;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT;
+        attrs[count++].value.booldata = true;
+
+        // the bench stops the senders by index
+        if (m_sender->Create(index, count, attrs, bench_now_ns()) != SAI_STATUS_SUCCESS || index != i)
+        {
+            printf("failed to create twamp sender session %u\n", i);
+            return false;
+        }
+    }
+
+    TwampWorker sender(m_sender, tickNs, profile.sessions);
+    TwampWorker reflector(m_reflector, tickNs, 0);
+    uint64_t start = bench_now_ns();
+    std::thread senderThread(&TwampWorker::Run, &sender);
+    std::thread reflectorThread(&TwampWorker::Run, &reflector);
+
+    std::this_thread::sleep_for(std::chrono::seconds(profile.seconds));
+
+    sender.quiesce.store(true);
+    result.seconds = (double)(bench_now_ns() - start) / 1e9;
+
+    // the last replies come back
+    std::this_thread::sleep_for(std::chrono::milliseconds(TWAMP_BENCH_DRAIN_MS));
+
+    sender.stop.store(true);
+    reflector.stop.store(true);
+    senderThread.join();
+    reflectorThread.join();
+
+    sai_stat_id_t ids[] = { SAI_TWAMP_SESSION_STAT_TX_PACKETS, SAI_TWAMP_SESSION_STAT_RX_PACKETS };
+
+    for (uint32_t i = 0; i < profile.sessions; i++)
+    {
+        uint64_t counters[2];
+
+        m_sender->GetStats(i, 2, ids, SAI_STATS_MODE_READ, counters);
+        result.sent += counters[0];
+        result.replies += counters[1];
+    }
+
+    result.lost = result.sent - std::min(result.sent, result.replies);
+    result.offeredPps = (double)profile.sessions * 1000 / profile.intervalMs;
+    result.replyPps = (double)result.replies / result.seconds;
+    result.cpuPercent[0] = (double)sender.cpuNs / 1e9 / result.seconds * 100;
+    result.cpuPercent[1] = (double)reflector.cpuNs / 1e9 / result.seconds * 100;
+    result.txLateness = m_sender->GetTxLateness();
+    result.intervals = s_intervals;
+    result.latencyMinUs = (double)s_latencyMin / 1000;
+    result.latencyMaxUs = (double)s_latencyMax / 1000;
+    result.latencyAvgUs = s_intervals ? s_latencyAvgSum / s_intervals / 1000 : 0;
+    result.jitterAvgUs = s_intervals ? s_jitterAvgSum / s_intervals / 1000 : 0;
+    result.notifyCalls = m_sender->NotifyCalls();
+
+    m_sender->SetNotification(NULL);
+
+    // every session published its full intervals, under 1% went missing
+    uint64_t fullIntervals = (uint64_t)profile.sessions * (profile.seconds * 1000 / profile.statsMs);
+
+    return result.sent > 0 && result.lost * 100 <= result.sent && result.intervals >= fullIntervals;
+}
+
+std::string TwampBench::ToJson(const TwampProfile &profile, const TwampBenchResult &result)
+{
+    const BenchLatency &lat = result.txLateness;
+    std::stringstream json;
+
+    json.setf(std::ios::fixed);
+    json.precision(3);
+
+    json << "{\n";
+    json << "  \"profile\": {\"sessions\": " << profile.sessions
+         << ", \"interval_ms\": " << profile.intervalMs
+         << ", \"seconds\": " << profile.seconds
+         << ", \"stats_ms\": " << profile.statsMs
+         << ", \"length\": " << profile.length
+         << ", \"tick_us\": " << profile.tickUs << "},\n";
+    json << "  \"timestamping\": " << (result.timestamping ? "true" : "false") << ",\n";
+    json << "  \"seconds\": " << result.seconds << ",\n";
+    json << "  \"offered_pps\": " << result.offeredPps << ",\n";
+    json << "  \"reply_pps\": " << result.replyPps << ",\n";
+    json << "  \"sent\": " << result.sent << ",\n";
+    json << "  \"replies\": " << result.replies << ",\n";
+    json << "  \"lost\": " << result.lost << ",\n";
+    json << "  \"sender_cpu_percent\": " << result.cpuPercent[0] << ",\n";
+    json << "  \"reflector_cpu_percent\": " << result.cpuPercent[1] << ",\n";
+    json << "  \"tx_lateness\": {\"count\": " << lat.count
+         << ", \"mean_us\": " << lat.meanUs
+         << ", \"p50_us\": " << lat.p50Us
+         << ", \"p99_us\": " << lat.p99Us
+         << ", \"p999_us\": " << lat.p999Us
+         << ", \"max_us\": " << lat.maxUs << "},\n";
+    json << "  \"intervals\": " << result.intervals << ",\n";
+    json << "  \"latency_us\": {\"min\": " << result.latencyMinUs
+         << ", \"avg\": " << result.latencyAvgUs
+         << ", \"max\": " << result.latencyMaxUs << "},\n";
+    json << "  \"jitter_avg_us\": " << result.jitterAvgUs << ",\n";
+    json << "  \"notify_calls\": " << result.notifyCalls << "\n";
+    json << "}\n";
+
+    return json.str();
+}
+
+void TwampBench::Show(const TwampBenchResult &result)
+{
+    const BenchLatency &lat = result.txLateness;
+
+    printf("\t--- --- --- --- --- --- -- TWAMP -- --- --- --- --- --- ---\n");
+    printf("\t%.3f s, offered %.0f packets/s, reflected %.0f packets/s, %llu of %llu lost\n",
+           result.seconds, result.offeredPps, result.replyPps,
+           (unsigned long long)result.lost, (unsigned long long)result.sent);
+    printf("\tsender cpu %.2f%%, reflector cpu %.2f%%, %s receive timestamps\n",
+           result.cpuPercent[0], result.cpuPercent[1], result.timestamping ? "kernel" : "user space");
+    printf("\ttx lateness mean %.1f us, p50 %.0f us, p99 %.0f us, p99.9 %.0f us, max %.1f us\n",
+           lat.meanUs, lat.p50Us, lat.p99Us, lat.p999Us, lat.maxUs);
+    printf("\t%llu intervals, latency min %.1f us, avg %.1f us, max %.1f us, jitter avg %.1f us\n",
+           (unsigned long long)result.intervals, result.latencyMinUs, result.latencyAvgUs,
+           result.latencyMaxUs, result.jitterAvgUs);
+    printf("\t--- --- --- --- --- --- --- --- --- --- --- --- --- --- ---\n");
+}
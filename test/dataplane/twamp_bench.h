@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "twamp.h"
+
+// TWAMP profile, parsed from "key=value,..." (see TwampProfile::Parse):
+//   sessions   sender sessions, each with its reflector session
+//   interval   SAI_TWAMP_SESSION_ATTR_TX_INTERVAL, milliseconds
+//   seconds    how long the senders transmit
+//   stats      SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL, milliseconds
+//   length     SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH
+//   tick       timer wheel tick and poll period, microseconds
+struct TwampProfile
+{
+    uint32_t sessions;
+    uint32_t intervalMs;
+    uint32_t seconds;
+    uint32_t statsMs;
+    uint32_t length;
+    uint32_t tickUs;
+
+    TwampProfile();
+
+    // throws std::invalid_argument on an unknown key or a bad value
+    void Parse(const std::string &profile);
+};
+
+struct TwampBenchResult
+{
+    bool timestamping;              // kernel receive timestamps
+    double seconds;
+    double offeredPps;
+    double replyPps;
+    uint64_t sent;
+    uint64_t replies;
+    uint64_t lost;                  // sent and never reflected back
+
+    // per engine thread: sender, reflector
+    double cpuPercent[2];
+    BenchLatency txLateness;        // sender TX timers against their due time
+
+    // over the published statistics intervals with replies
+    uint64_t intervals;
+    double latencyMinUs;
+    double latencyAvgUs;            // mean of the interval averages
+    double latencyMaxUs;
+    double jitterAvgUs;
+    uint64_t notifyCalls;
+};
+
+class TwampBench
+{
+    TwampEngine* m_sender;
+    TwampEngine* m_reflector;
+
+public:
+    // both engines need the profile's session count as capacity and its
+    // tick, Run() opens them on the loopback
+    TwampBench(TwampEngine* sender, TwampEngine* reflector);
+
+    // leaves the sessions in place, transmit disabled
+    bool Run(const TwampProfile &profile, TwampBenchResult &result);
+
+    static std::string ToJson(const TwampProfile &profile, const TwampBenchResult &result);
+    static void Show(const TwampBenchResult &result);
+};
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2015 Microsoft Open Technologies, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+ *    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ *    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ *    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *    See the Apache Version 2.0 License for specific language governing
+ *    permissions and limitations under the License.
+ *
+ *    Microsoft would like to thank the following companies for their review and
+ *    assistance with these files: Intel Corporation, Mellanox Technologies Ltd,
+ *    Dell Products, L.P., Facebook, Inc
+ *
+ *
+ */
+#include <map>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "twamp.h"
+#include "twamp_bench.h"
+
+#define NS_PER_MS           1000000ULL
+#define SENDER_PORT_BASE    20000
+
+static std::vector<sai_twamp_session_event_notification_data_t> s_events;
+static std::vector<std::vector<uint64_t> > s_eventStats;
+
+static void collect(uint32_t count, const sai_twamp_session_event_notification_data_t *data)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const sai_twamp_session_stats_data_t &stats = data[i].session_stats;
+
+        ASSERT_EQ((uint32_t)TWAMP_SESSION_STAT_COUNT, stats.number_of_counters);
+        ASSERT_EQ(SAI_TWAMP_SESSION_STAT_AVG_LATENCY, stats.counters_ids[SAI_TWAMP_SESSION_STAT_AVG_LATENCY]);
+
+        s_events.push_back(data[i]);
+        s_eventStats.push_back(std::vector<uint64_t>(stats.counters, stats.counters + stats.number_of_counters));
+    }
+}
+
+static uint32_t fill_attrs(sai_attribute_t *attrs, sai_twamp_session_role_t role, uint16_t srcPort, uint16_t dstPort)
+{
+    uint32_t count = 0;
+
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_TWAMP_MODE;
+    attrs[count++].value.s32 = SAI_TWAMP_MODE_LIGHT;
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_SESSION_ROLE;
+    attrs[count++].value.s32 = role;
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_SRC_IP;
+    attrs[count].value.ipaddr.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    attrs[count++].value.ipaddr.addr.ip4 = htonl(0x7F000001);
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_DST_IP;
+    attrs[count].value.ipaddr.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    attrs[count++].value.ipaddr.addr.ip4 = htonl(0x7F000001);
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_UDP_SRC_PORT;
+    attrs[count++].value.u32 = srcPort;
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_UDP_DST_PORT;
+    attrs[count++].value.u32 = dstPort;
+
+    return count;
+}
+
+static void add_u32(sai_attribute_t *attrs, uint32_t &count, sai_attr_id_t id, uint32_t value)
+{
+    attrs[count].id = id;
+    attrs[count++].value.u32 = value;
+}
+
+// polls on the 250us wheel tick of the engines below
+static void run(TwampEngine &a, TwampEngine *b, uint64_t &now, uint64_t untilNs)
+{
+    while (now < untilNs)
+    {
+        now += NS_PER_MS / 4;
+        a.Poll(now);
+
+        if (b)
+        {
+            b->Poll(now);
+        }
+    }
+}
+
+TEST(twamp, codec)
+{
+    TwampTestPacket pkt;
+    TwampTestPacket out;
+    uint8_t buf[TWAMP_MAX_PACKET_LEN];
+    uint64_t ns = 1700000000ULL * 1000000000ULL + 123456789;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.seq = 7;
+    pkt.timestampNs = ns;
+    pkt.errorEstimate = TWAMP_ERROR_S | 1;
+    pkt.ssid = 862;
+
+    ASSERT_EQ(0u, twamp_encode_sender(pkt, buf, TWAMP_SENDER_PACKET_LEN - 1));
+    ASSERT_EQ(128u, twamp_encode_sender(pkt, buf, 128));
+
+    // NTP seconds since 1900 on the wire
+    ASSERT_EQ(0, buf[3] - 7);
+    ASSERT_EQ(0xE8, buf[4]);
+    ASSERT_EQ(0x80, buf[12]);
+    ASSERT_EQ(0, buf[127]);
+
+    ASSERT_TRUE(twamp_decode_sender(buf, 128, out));
+    ASSERT_EQ(7u, out.seq);
+    ASSERT_EQ(862, out.ssid);
+    ASSERT_LE(ns - 1, out.timestampNs);
+    ASSERT_GE(ns + 1, out.timestampNs);
+
+    // PTP keeps the nanoseconds exactly
+    pkt.errorEstimate |= TWAMP_ERROR_Z;
+    twamp_encode_sender(pkt, buf, 64);
+    ASSERT_TRUE(twamp_decode_sender(buf, 64, out));
+    ASSERT_EQ(ns, out.timestampNs);
+
+    // reflected, the sender timestamp keeps the sender's format
+    pkt.receiveTimestampNs = ns + 1000;
+    pkt.timestampNs = ns + 5000;
+    pkt.senderSeq = 41;
+    pkt.senderTimestampNs = ns;
+    pkt.senderErrorEstimate = TWAMP_ERROR_S | 1;
+    pkt.senderTtl = 254;
+
+    ASSERT_EQ(0u, twamp_encode_reflected(pkt, buf, TWAMP_REFLECTED_PACKET_LEN - 1));
+    ASSERT_EQ((size_t)TWAMP_REFLECTED_PACKET_LEN, twamp_encode_reflected(pkt, buf, TWAMP_REFLECTED_PACKET_LEN));
+    ASSERT_FALSE(twamp_decode_reflected(buf, TWAMP_REFLECTED_PACKET_LEN - 1, out));
+    ASSERT_TRUE(twamp_decode_reflected(buf, TWAMP_REFLECTED_PACKET_LEN, out));
+    ASSERT_EQ(ns + 1000, out.receiveTimestampNs);
+    ASSERT_EQ(ns + 5000, out.timestampNs);
+    ASSERT_EQ(41u, out.senderSeq);
+    ASSERT_LE(ns - 1, out.senderTimestampNs);
+    ASSERT_GE(ns + 1, out.senderTimestampNs);
+    ASSERT_EQ(254, out.senderTtl);
+    ASSERT_EQ(862, out.ssid);
+}
+
+TEST(twamp, attributes)
+{
+    TwampEngine engine(4, NS_PER_MS, 0);
+    sai_attribute_t attrs[12];
+    uint32_t index;
+    uint32_t count = fill_attrs(attrs, SAI_TWAMP_SESSION_ROLE_SENDER, SENDER_PORT_BASE, 862);
+
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(index, count - 1, attrs, 0));
+
+    attrs[0].value.s32 = SAI_TWAMP_MODE_FULL;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0, engine.Create(index, count, attrs, 0));
+    attrs[0].value.s32 = SAI_TWAMP_MODE_LIGHT;
+
+    uint32_t extra = count;
+
+    add_u32(attrs, extra, SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH, TWAMP_REFLECTED_PACKET_LEN - 1);
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + count, engine.Create(index, extra, attrs, 0));
+
+    extra = count;
+    add_u32(attrs, extra, SAI_TWAMP_SESSION_ATTR_UDP_SRC_PORT, 0x10000);
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0 + count, engine.Create(index, extra, attrs, 0));
+
+    extra = count;
+    attrs[extra].id = SAI_TWAMP_SESSION_ATTR_TWAMP_ENCAPSULATION_TYPE;
+    attrs[extra++].value.s32 = SAI_TWAMP_ENCAPSULATION_TYPE_VXLAN;
+    ASSERT_EQ(SAI_STATUS_ATTR_NOT_IMPLEMENTED_0 + count, engine.Create(index, extra, attrs, 0));
+
+    // without hardware lookup the egress port and MACs are mandatory
+    extra = count;
+    attrs[extra].id = SAI_TWAMP_SESSION_ATTR_HW_LOOKUP_VALID;
+    attrs[extra++].value.booldata = false;
+    ASSERT_EQ(SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING, engine.Create(index, extra, attrs, 0));
+
+    extra = count;
+    add_u32(attrs, extra, SAI_TWAMP_SESSION_ATTR_TX_INTERVAL, 10);
+    add_u32(attrs, extra, SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL, 500);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(index, extra, attrs, 0));
+
+    uint32_t other;
+
+    ASSERT_EQ(SAI_STATUS_ITEM_ALREADY_EXISTS, engine.Create(other, count, attrs, 0));
+
+    // a reflector is keyed on the sender's port, its destination
+    count = fill_attrs(attrs, SAI_TWAMP_SESSION_ROLE_REFLECTOR, 862, SENDER_PORT_BASE);
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Create(other, count, attrs, 0));
+
+    sai_attribute_t get[4];
+
+    get[0].id = SAI_TWAMP_SESSION_ATTR_TX_INTERVAL;
+    get[1].id = SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL;
+    get[2].id = SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH;
+    get[3].id = SAI_TWAMP_SESSION_ATTR_TIMEOUT;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Get(index, 4, get));
+    ASSERT_EQ(10u, get[0].value.u32);
+    ASSERT_EQ(500u, get[1].value.u32);
+    ASSERT_EQ(256u, get[2].value.u32);
+    ASSERT_EQ(3u, get[3].value.u32);
+
+    sai_attribute_t attr;
+
+    attr.id = SAI_TWAMP_SESSION_ATTR_DSCP;
+    attr.value.u8 = 46;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Set(index, &attr, 0));
+
+    attr.value.u8 = 64;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTR_VALUE_0, engine.Set(index, &attr, 0));
+
+    attr.id = SAI_TWAMP_SESSION_ATTR_TX_INTERVAL;
+    attr.value.u32 = 1;
+    ASSERT_EQ(SAI_STATUS_INVALID_ATTRIBUTE_0, engine.Set(index, &attr, 0));
+
+    attr.id = SAI_TWAMP_SESSION_ATTR_DSCP;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Get(index, 1, &attr));
+    ASSERT_EQ(46, attr.value.u8);
+
+    sai_stat_id_t id = SAI_TWAMP_SESSION_STAT_DURATION_TS + 1;
+    uint64_t value;
+
+    ASSERT_EQ(SAI_STATUS_INVALID_PARAMETER, engine.GetStats(index, 1, &id, SAI_STATS_MODE_READ, &value));
+
+    ASSERT_EQ(2u, engine.Size());
+    ASSERT_EQ(SAI_STATUS_SUCCESS, engine.Remove(index));
+    ASSERT_EQ(SAI_STATUS_ITEM_NOT_FOUND, engine.Remove(index));
+    ASSERT_EQ(1u, engine.Size());
+}
+
+// sender and reflector engines over the loopback at 1k packets/s per
+// session: statistics intervals, the active/inactive events and the
+// packet count mode
+TEST(twamp, sender_reflector)
+{
+    const uint32_t sessions = 16;
+    TwampEngine sender(sessions + 1, NS_PER_MS / 4, 0);
+    TwampEngine reflector(sessions + 1, NS_PER_MS / 4, 0);
+    std::vector<uint32_t> senders(sessions);
+    std::vector<uint32_t> reflectors(sessions);
+    sai_attribute_t attrs[12];
+    uint64_t now = 0;
+
+    ASSERT_TRUE(sender.Open("127.0.0.1", 0, 0));
+    ASSERT_TRUE(reflector.Open("127.0.0.1", 0, 0));
+    ASSERT_TRUE(sender.SetPeer("127.0.0.1", reflector.GetReflectorPort()));
+
+    s_events.clear();
+    s_eventStats.clear();
+    sender.SetNotification(collect);
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        uint32_t count = fill_attrs(attrs, SAI_TWAMP_SESSION_ROLE_SENDER, (uint16_t)(SENDER_PORT_BASE + i), 862);
+
+        add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_TX_INTERVAL, 1);
+        add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_STATISTICS_INTERVAL, 100);
+        add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_TIMEOUT, 1);
+        add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_PACKET_LENGTH, 128);
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_TWAMP_TIMESTAMP_FORMAT;
+        attrs[count++].value.s32 = i % 2 ? SAI_TWAMP_TIMESTAMP_FORMAT_PTP : SAI_TWAMP_TIMESTAMP_FORMAT_NTP;
+        attrs[count].id = SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT;
+        attrs[count++].value.booldata = true;
+        ASSERT_EQ(SAI_STATUS_SUCCESS, sender.Create(senders[i], count, attrs, now));
+
+        count = fill_attrs(attrs, SAI_TWAMP_SESSION_ROLE_REFLECTOR, 862, (uint16_t)(SENDER_PORT_BASE + i));
+        ASSERT_EQ(SAI_STATUS_SUCCESS, reflector.Create(reflectors[i], count, attrs, now));
+    }
+
+    run(sender, &reflector, now, 350 * NS_PER_MS);
+
+    ASSERT_EQ(0u, sender.UnknownDrops());
+    ASSERT_EQ(0u, reflector.UnknownDrops());
+
+    // one ACTIVE event and three statistics intervals per session
+    std::map<uint64_t, int> active;
+    std::map<uint64_t, int> intervals;
+
+    for (size_t e = 0; e < s_events.size(); e++)
+    {
+        const std::vector<uint64_t> &stat = s_eventStats[e];
+
+        ASSERT_EQ(SAI_TWAMP_SESSION_STATE_ACTIVE, s_events[e].session_state);
+
+        if (stat[SAI_TWAMP_SESSION_STAT_FIRST_TS] == 0)
+        {
+            active[s_events[e].twamp_session_id]++;
+            continue;
+        }
+
+        intervals[s_events[e].twamp_session_id]++;
+
+        ASSERT_GT(stat[SAI_TWAMP_SESSION_STAT_MIN_LATENCY], 0u);
+        ASSERT_LE(stat[SAI_TWAMP_SESSION_STAT_MIN_LATENCY], stat[SAI_TWAMP_SESSION_STAT_AVG_LATENCY]);
+        ASSERT_LE(stat[SAI_TWAMP_SESSION_STAT_AVG_LATENCY], stat[SAI_TWAMP_SESSION_STAT_MAX_LATENCY]);
+        ASSERT_LT(stat[SAI_TWAMP_SESSION_STAT_MAX_LATENCY], 1000 * NS_PER_MS);
+        ASSERT_LE(stat[SAI_TWAMP_SESSION_STAT_MIN_JITTER], stat[SAI_TWAMP_SESSION_STAT_AVG_JITTER]);
+        ASSERT_LE(stat[SAI_TWAMP_SESSION_STAT_AVG_JITTER], stat[SAI_TWAMP_SESSION_STAT_MAX_JITTER]);
+        ASSERT_EQ(stat[SAI_TWAMP_SESSION_STAT_LAST_TS] - stat[SAI_TWAMP_SESSION_STAT_FIRST_TS],
+                  stat[SAI_TWAMP_SESSION_STAT_DURATION_TS]);
+        ASSERT_GT(stat[SAI_TWAMP_SESSION_STAT_DURATION_TS], 0u);
+    }
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(1, active[senders[i]]);
+        ASSERT_EQ(3, intervals[senders[i]]);
+    }
+
+    sai_stat_id_t ids[] = {
+        SAI_TWAMP_SESSION_STAT_TX_PACKETS,
+        SAI_TWAMP_SESSION_STAT_RX_PACKETS,
+        SAI_TWAMP_SESSION_STAT_DROP_PACKETS,
+        SAI_TWAMP_SESSION_STAT_RX_BYTE,
+    };
+    uint64_t sent[4];
+    uint64_t reflected[4];
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(SAI_STATUS_SUCCESS, sender.GetStats(senders[i], 4, ids, SAI_STATS_MODE_READ, sent));
+        ASSERT_EQ(SAI_STATUS_SUCCESS, reflector.GetStats(reflectors[i], 4, ids, SAI_STATS_MODE_READ, reflected));
+
+        // 1 packet per ms, the last one may still be in flight
+        ASSERT_GE(sent[0], 348u);
+        ASSERT_LE(sent[0], 351u);
+        ASSERT_EQ(sent[0], reflected[1]);
+        ASSERT_EQ(reflected[0], reflected[1]);
+        ASSERT_LE(sent[1], reflected[0]);
+        ASSERT_GE(sent[1] + 1, reflected[0]);
+        ASSERT_EQ(0u, sent[2]);
+        ASSERT_EQ(128 * sent[1], sent[3]);
+    }
+
+    BenchLatency lateness = sender.GetTxLateness();
+
+    ASSERT_LE(lateness.maxUs, 250.0);
+
+    // the reflector goes away, the senders time out after a second
+    s_events.clear();
+    s_eventStats.clear();
+    run(sender, NULL, now, now + 1100 * NS_PER_MS);
+
+    std::map<uint64_t, int> inactive;
+
+    for (size_t e = 0; e < s_events.size(); e++)
+    {
+        if (s_events[e].session_state == SAI_TWAMP_SESSION_STATE_INACTIVE)
+        {
+            inactive[s_events[e].twamp_session_id]++;
+        }
+    }
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(1, inactive[senders[i]]);
+    }
+
+    // drain what the reflector missed and send a fixed number of packets
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        ASSERT_EQ(SAI_STATUS_SUCCESS, sender.Remove(senders[i]));
+    }
+
+    run(sender, &reflector, now, now + 10 * NS_PER_MS);
+
+    uint32_t count = fill_attrs(attrs, SAI_TWAMP_SESSION_ROLE_SENDER, SENDER_PORT_BASE, 862);
+
+    add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_TX_INTERVAL, 1);
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_TWAMP_PKT_TX_MODE;
+    attrs[count++].value.s32 = SAI_TWAMP_PKT_TX_MODE_PACKET_COUNT;
+    add_u32(attrs, count, SAI_TWAMP_SESSION_ATTR_TX_PKT_CNT, 25);
+    attrs[count].id = SAI_TWAMP_SESSION_ATTR_SESSION_ENABLE_TRANSMIT;
+    attrs[count++].value.booldata = true;
+    ASSERT_EQ(SAI_STATUS_SUCCESS, sender.Create(senders[0], count, attrs, now));
+
+    run(sender, &reflector, now, now + 100 * NS_PER_MS);
+
+    ASSERT_EQ(SAI_STATUS_SUCCESS, sender.GetStats(senders[0], 4, ids, SAI_STATS_MODE_READ, sent));
+    ASSERT_EQ(25u, sent[0]);
+    ASSERT_EQ(25u, sent[1]);
+    ASSERT_EQ(0u, sent[2]);
+}
+
+// profile from DATAPLANE_TWAMP_BENCH ("sessions=..,interval=..,seconds=.."),
+// the JSON report goes to DATAPLANE_TWAMP_BENCH_JSON when it is set
+TEST(twamp, bench)
+{
+    TwampProfile profile;
+    TwampBenchResult result;
+    const char *env = getenv("DATAPLANE_TWAMP_BENCH");
+
+    if (env)
+    {
+        ASSERT_NO_THROW(profile.Parse(env));
+    }
+
+    uint64_t tickNs = (uint64_t)profile.tickUs * 1000;
+    TwampEngine sender(profile.sessions, tickNs, bench_now_ns());
+    TwampEngine reflector(profile.sessions, tickNs, bench_now_ns());
+    TwampBench bench(&sender, &reflector);
+
+    bool ok = bench.Run(profile, result);
+    TwampBench::Show(result);
+
+    std::string json = TwampBench::ToJson(profile, result);
+    const char *jsonPath = getenv("DATAPLANE_TWAMP_BENCH_JSON");
+
+    if (jsonPath)
+    {
+        FILE *fp = fopen(jsonPath, "w");
+        ASSERT_TRUE(fp != NULL);
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(profile.sessions, sender.Size());
+}
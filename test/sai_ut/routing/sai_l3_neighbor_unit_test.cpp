@@ -812,6 +812,281 @@ TEST_F (saiL3NeighborTest, create_and_remove_with_no_host_route)
     sai_neighbor_verify_after_removal (port_rif_id, ip_af, p_ip_addr_str);
 }
 
+/*
+ * Creates a batch of Neighbors with the bulk API in each error mode,
+ * verifies the per neighbor statuses and attributes, and removes the batch
+ * with the bulk API.
+ */
+TEST_F (saiL3NeighborTest, bulk_create_and_remove)
+{
+    sai_status_t          status;
+    sai_ip_addr_family_t  ip_af = SAI_IP_ADDR_FAMILY_IPV4;
+    sai_ip_addr_family_t  ip6_af = SAI_IP_ADDR_FAMILY_IPV6;
+    const char           *p_mac_str = "00:a1:a2:a3:a4:a5";
+    unsigned int          idx;
+    const sai_bulk_op_error_mode_t modes [] = {
+        SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR
+    };
+
+    if (!sai_test_neighbor_bulk_supported ()) {
+
+        printf ("Neighbor bulk APIs are not supported, skipping test.\n");
+
+        return;
+    }
+
+    for (idx = 0; idx < (sizeof (modes) / sizeof (modes [0])); idx++) {
+
+        sai_test_neighbor_batch_t batch;
+        sai_test_neighbor_batch_t created;
+
+        sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                     ip_af, "11.0.1.1",
+                                     default_neighbor_attr_count,
+                                     SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                     p_mac_str);
+        sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                     ip_af, "11.0.1.2",
+                                     (default_neighbor_attr_count + 1),
+                                     SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                     p_mac_str,
+                                     SAI_NEIGHBOR_ENTRY_ATTR_PACKET_ACTION,
+                                     SAI_PACKET_ACTION_LOG);
+        sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                     ip6_af, "2001:db8:85a3::8a2e:370:1",
+                                     default_neighbor_attr_count,
+                                     SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                     p_mac_str);
+
+        status = sai_test_neighbor_bulk_create (&batch, modes [idx]);
+
+        sai_test_bulk_statuses_verify (modes [idx], status, batch.expected,
+                                       batch.statuses);
+
+        sai_neighbor_verify_after_creation (port_rif_id, ip_af, "11.0.1.1",
+                                            p_mac_str, default_pkt_action);
+
+        sai_neighbor_verify_after_creation (port_rif_id, ip_af, "11.0.1.2",
+                                            p_mac_str, SAI_PACKET_ACTION_LOG);
+
+        sai_neighbor_verify_after_creation (port_rif_id, ip6_af,
+                                            "2001:db8:85a3::8a2e:370:1",
+                                            p_mac_str, default_pkt_action);
+
+        sai_test_neighbor_batch_created_get (&batch, &created);
+
+        status = sai_test_neighbor_bulk_remove (&created, modes [idx]);
+
+        sai_test_bulk_statuses_verify (modes [idx], status, created.expected,
+                                       created.statuses);
+
+        sai_neighbor_verify_after_removal (port_rif_id, ip_af, "11.0.1.1");
+        sai_neighbor_verify_after_removal (port_rif_id, ip_af, "11.0.1.2");
+        sai_neighbor_verify_after_removal (port_rif_id, ip6_af,
+                                           "2001:db8:85a3::8a2e:370:1");
+    }
+}
+
+/*
+ * Check if the Neighbor bulk create API in stop on error mode creates the
+ * Neighbors before the first invalid one, returns appropriate error status
+ * for it and doesn't execute the rest of the batch.
+ */
+TEST_F (saiL3NeighborTest, bulk_create_mixed_stop_on_error)
+{
+    sai_status_t              status;
+    sai_ip_addr_family_t      ip_af = SAI_IP_ADDR_FAMILY_IPV4;
+    const char               *p_mac_str = "00:a1:a2:a3:a4:a5";
+    sai_test_neighbor_batch_t batch;
+    sai_test_neighbor_batch_t created;
+
+    if (!sai_test_neighbor_bulk_supported ()) {
+
+        printf ("Neighbor bulk APIs are not supported, skipping test.\n");
+
+        return;
+    }
+
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.2.1", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_MANDATORY_ATTRIBUTE_MISSING,
+                                 port_rif_id, ip_af, "11.0.2.2",
+                                 default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_PACKET_ACTION,
+                                 SAI_PACKET_ACTION_LOG);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.2.3", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+
+    status = sai_test_neighbor_bulk_create (&batch,
+                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   status, batch.expected, batch.statuses);
+
+    /* Neighbor after the failed one is not created */
+    sai_neighbor_verify_after_removal (port_rif_id, ip_af, "11.0.2.3");
+
+    sai_test_neighbor_batch_created_get (&batch, &created);
+
+    EXPECT_EQ (1u, created.entries.size ());
+
+    status = sai_test_neighbor_bulk_remove (&created,
+                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   status, created.expected, created.statuses);
+}
+
+/*
+ * Check if the Neighbor bulk create API in ignore error mode creates all
+ * valid Neighbors and returns appropriate error status for each invalid one.
+ */
+TEST_F (saiL3NeighborTest, bulk_create_mixed_ignore_error)
+{
+    sai_status_t              status;
+    sai_ip_addr_family_t      ip_af = SAI_IP_ADDR_FAMILY_IPV4;
+    const char               *p_mac_str = "00:a1:a2:a3:a4:a5";
+    sai_object_id_t           invalid_rif_id = 0;
+    sai_int32_t               invalid_pkt_action = -1;
+    unsigned int              invalid_attr_index = 1;
+    sai_test_neighbor_batch_t batch;
+    sai_test_neighbor_batch_t created;
+
+    if (!sai_test_neighbor_bulk_supported ()) {
+
+        printf ("Neighbor bulk APIs are not supported, skipping test.\n");
+
+        return;
+    }
+
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.3.1", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_INVALID_OBJECT_ID,
+                                 invalid_rif_id, ip_af, "11.0.3.2",
+                                 default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.3.3", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch,
+                                 sai_test_invalid_attr_status_code (
+                                 SAI_STATUS_INVALID_ATTR_VALUE_0,
+                                 invalid_attr_index),
+                                 port_rif_id, ip_af, "11.0.3.4",
+                                 (default_neighbor_attr_count + 1),
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_PACKET_ACTION,
+                                 invalid_pkt_action);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_FAILURE, port_rif_id,
+                                 ip_af, "0.0.0.0", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.3.6", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+
+    status = sai_test_neighbor_bulk_create (&batch,
+                                            SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   status, batch.expected, batch.statuses);
+
+    sai_neighbor_verify_after_creation (port_rif_id, ip_af, "11.0.3.6",
+                                        p_mac_str, default_pkt_action);
+
+    sai_test_neighbor_batch_created_get (&batch, &created);
+
+    EXPECT_EQ (3u, created.entries.size ());
+
+    status = sai_test_neighbor_bulk_remove (&created,
+                                            SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   status, created.expected, created.statuses);
+}
+
+/*
+ * Check if the Neighbor bulk remove API returns appropriate error status for
+ * non existing Neighbors mixed with existing ones, in both error modes.
+ */
+TEST_F (saiL3NeighborTest, bulk_remove_mixed_error_modes)
+{
+    sai_status_t              status;
+    sai_ip_addr_family_t      ip_af = SAI_IP_ADDR_FAMILY_IPV4;
+    const char               *p_mac_str = "00:a1:a2:a3:a4:a5";
+    sai_test_neighbor_batch_t batch;
+    sai_test_neighbor_batch_t stop_batch;
+    sai_test_neighbor_batch_t ignore_batch;
+
+    if (!sai_test_neighbor_bulk_supported ()) {
+
+        printf ("Neighbor bulk APIs are not supported, skipping test.\n");
+
+        return;
+    }
+
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.4.1", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.4.2", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+    sai_test_neighbor_batch_add (&batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.4.3", default_neighbor_attr_count,
+                                 SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                 p_mac_str);
+
+    status = sai_test_neighbor_bulk_create (&batch,
+                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, status);
+
+    /* Remove stops at the non existing Neighbor */
+    sai_test_neighbor_batch_add (&stop_batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.4.1", 0);
+    sai_test_neighbor_batch_add (&stop_batch, SAI_STATUS_ITEM_NOT_FOUND,
+                                 port_rif_id, ip_af, "11.0.4.9", 0);
+    sai_test_neighbor_batch_add (&stop_batch, SAI_STATUS_SUCCESS, port_rif_id,
+                                 ip_af, "11.0.4.2", 0);
+
+    status = sai_test_neighbor_bulk_remove (&stop_batch,
+                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   status, stop_batch.expected,
+                                   stop_batch.statuses);
+
+    /* Remove continues after the non existing Neighbor */
+    sai_test_neighbor_batch_add (&ignore_batch, SAI_STATUS_ITEM_NOT_FOUND,
+                                 port_rif_id, ip_af, "11.0.4.1", 0);
+    sai_test_neighbor_batch_add (&ignore_batch, SAI_STATUS_SUCCESS,
+                                 port_rif_id, ip_af, "11.0.4.2", 0);
+    sai_test_neighbor_batch_add (&ignore_batch, SAI_STATUS_ITEM_NOT_FOUND,
+                                 port_rif_id, ip_af, "11.0.4.9", 0);
+    sai_test_neighbor_batch_add (&ignore_batch, SAI_STATUS_SUCCESS,
+                                 port_rif_id, ip_af, "11.0.4.3", 0);
+
+    status = sai_test_neighbor_bulk_remove (&ignore_batch,
+                                            SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   status, ignore_batch.expected,
+                                   ignore_batch.statuses);
+}
+
 int main (int argc, char **argv)
 {
     ::testing::InitGoogleTest (&argc, argv);
@@ -49,6 +49,10 @@ class saiL3RouteTest : public saiL3Test {
                     const char *prefix_str, unsigned int prefix_len,
                     unsigned int nh_type, sai_object_id_t fwd_obj_id,
                     sai_packet_action_t pkt_action, unsigned int trap_prio);
+        static void sai_test_route_nh_attr_verify (
+                    sai_object_id_t vr_id, sai_ip_addr_family_t family,
+                    const char *prefix_str, unsigned int prefix_len,
+                    sai_object_id_t nh_id);
         static void sai_test_route_remove_and_verify (
                     sai_object_id_t vr_id, sai_ip_addr_family_t family,
                     const char *prefix_str, unsigned int prefix_len);
@@ -339,6 +343,29 @@ unsigned int trap_prio)
     }
 }
 
+/*
+ * Helper function to verify the packet action and next hop of a Route
+ * created with the SAI_ROUTE_ENTRY_ATTR_* ids.
+ */
+void saiL3RouteTest ::sai_test_route_nh_attr_verify (
+sai_object_id_t vr_id, sai_ip_addr_family_t family,
+const char *prefix_str, unsigned int prefix_len, sai_object_id_t nh_id)
+{
+    sai_status_t    sai_rc = SAI_STATUS_SUCCESS;
+    sai_attribute_t attr_list [2];
+    unsigned int    attr_count = 2;
+
+    sai_rc = sai_test_route_attr_get (vr_id, family, prefix_str, prefix_len,
+                                      &attr_list [0], attr_count,
+                                      SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION,
+                                      SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    ASSERT_EQ (SAI_TEST_ROUTE_DFLT_PKT_ACTION, attr_list [0].value.s32);
+    ASSERT_EQ (nh_id, attr_list [1].value.oid);
+}
+
 /*
  * Helper function to remove the route.
  */
@@ -1112,6 +1139,256 @@ TEST_F (saiL3RouteTest, route_next_hop_with_no_host_route_attr)
     EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
 }
 
+/*
+ * Creates a batch of Routes with the bulk API in each error mode, verifies
+ * the per route statuses and attributes, and removes the batch with the
+ * bulk API. Checks if duplicate bulk remove returns appropriate per route
+ * status.
+ */
+TEST_F (saiL3RouteTest, route_bulk_create_and_remove)
+{
+    sai_status_t              sai_rc = SAI_STATUS_SUCCESS;
+    sai_ip_addr_family_t      family = SAI_IP_ADDR_FAMILY_IPV4;
+    sai_ip_addr_family_t      family6 = SAI_IP_ADDR_FAMILY_IPV6;
+    unsigned int              idx = 0;
+    unsigned int              entry = 0;
+    const sai_bulk_op_error_mode_t modes [] = {
+        SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR
+    };
+
+    if (!sai_test_route_bulk_supported ()) {
+        printf ("Route bulk APIs are not supported, skipping test.\r\n");
+        return;
+    }
+
+    for (idx = 0; idx < (sizeof (modes) / sizeof (modes [0])); idx++) {
+        sai_test_route_batch_t  batch;
+        sai_test_route_batch_t  created;
+
+        sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                                  "10.1.2.0", 24, 1,
+                                  SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+        sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                                  "10.1.3.0", 24, 1,
+                                  SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID,
+                                  nh_grp_id_1);
+        sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                                  "10.1.4.0", 24, 1,
+                                  SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION,
+                                  SAI_PACKET_ACTION_DROP);
+        sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family6,
+                                  "2001:db8:1::", 64, 1,
+                                  SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh6_id_1);
+
+        sai_rc = sai_test_route_bulk_create (&batch, modes [idx]);
+
+        sai_test_bulk_statuses_verify (modes [idx], sai_rc, batch.expected,
+                                       batch.statuses);
+
+        sai_test_route_nh_attr_verify (vr_id, family, "10.1.2.0", 24, nh_id_1);
+
+        sai_test_route_nh_attr_verify (vr_id, family, "10.1.3.0", 24,
+                                       nh_grp_id_1);
+
+        sai_test_route_nh_attr_verify (vr_id, family6, "2001:db8:1::", 64,
+                                       nh6_id_1);
+
+        sai_test_route_batch_created_get (&batch, &created);
+
+        sai_rc = sai_test_route_bulk_remove (&created, modes [idx]);
+
+        sai_test_bulk_statuses_verify (modes [idx], sai_rc, created.expected,
+                                       created.statuses);
+
+        /* Duplicate Remove will return SAI_STATUS_ITEM_NOT_FOUND status */
+        sai_rc = sai_test_route_bulk_remove (&created,
+                                             SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+        EXPECT_NE (SAI_STATUS_SUCCESS, sai_rc);
+
+        for (entry = 0; entry < created.statuses.size (); entry++) {
+            EXPECT_EQ (SAI_STATUS_ITEM_NOT_FOUND, created.statuses [entry]);
+        }
+    }
+}
+
+/*
+ * Check if the Route bulk create API in stop on error mode creates the
+ * Routes before the first invalid one, returns appropriate error status for
+ * it and doesn't execute the rest of the batch.
+ */
+TEST_F (saiL3RouteTest, route_bulk_create_mixed_stop_on_error)
+{
+    sai_status_t              sai_rc = SAI_STATUS_SUCCESS;
+    sai_ip_addr_family_t      family = SAI_IP_ADDR_FAMILY_IPV4;
+    sai_object_id_t           invalid_nh_id = 0;
+    sai_test_route_batch_t    batch;
+    sai_test_route_batch_t    created;
+
+    if (!sai_test_route_bulk_supported ()) {
+        printf ("Route bulk APIs are not supported, skipping test.\r\n");
+        return;
+    }
+
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.2.1.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.2.2.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_2);
+    sai_test_route_batch_add (&batch, SAI_STATUS_INVALID_ATTR_VALUE_0, vr_id,
+                              family, "10.2.3.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, invalid_nh_id);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.2.4.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+
+    sai_rc = sai_test_route_bulk_create (&batch,
+                                         SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   sai_rc, batch.expected, batch.statuses);
+
+    /* Route after the failed one is not created */
+    sai_rc = sai_test_route_remove (vr_id, family, "10.2.4.0", 24);
+
+    EXPECT_EQ (SAI_STATUS_ITEM_NOT_FOUND, sai_rc);
+
+    sai_test_route_batch_created_get (&batch, &created);
+
+    EXPECT_EQ (2u, created.entries.size ());
+
+    sai_rc = sai_test_route_bulk_remove (&created,
+                                         SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   sai_rc, created.expected, created.statuses);
+}
+
+/*
+ * Check if the Route bulk create API in ignore error mode creates all valid
+ * Routes and returns appropriate error status for each invalid one.
+ */
+TEST_F (saiL3RouteTest, route_bulk_create_mixed_ignore_error)
+{
+    sai_status_t              sai_rc = SAI_STATUS_SUCCESS;
+    sai_ip_addr_family_t      family = SAI_IP_ADDR_FAMILY_IPV4;
+    sai_object_id_t           invalid_nh_id = 0;
+    unsigned int              invalid_pkt_action = 0xff;
+    unsigned int              invalid_attr_id = 0xFF;
+    sai_test_route_batch_t    batch;
+    sai_test_route_batch_t    created;
+
+    if (!sai_test_route_bulk_supported ()) {
+        printf ("Route bulk APIs are not supported, skipping test.\r\n");
+        return;
+    }
+
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.3.1.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_INVALID_ATTR_VALUE_0, vr_id,
+                              family, "10.3.2.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, invalid_nh_id);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.3.3.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_grp_id_1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_INVALID_ATTR_VALUE_0, vr_id,
+                              family, "10.3.4.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION,
+                              invalid_pkt_action);
+    sai_test_route_batch_add (&batch, SAI_STATUS_UNKNOWN_ATTRIBUTE_0, vr_id,
+                              family, "10.3.5.0", 24, 1,
+                              invalid_attr_id, 1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.3.6.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_2);
+
+    sai_rc = sai_test_route_bulk_create (&batch,
+                                         SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   sai_rc, batch.expected, batch.statuses);
+
+    sai_test_route_nh_attr_verify (vr_id, family, "10.3.6.0", 24, nh_id_2);
+
+    sai_test_route_batch_created_get (&batch, &created);
+
+    EXPECT_EQ (3u, created.entries.size ());
+
+    sai_rc = sai_test_route_bulk_remove (&created,
+                                         SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   sai_rc, created.expected, created.statuses);
+}
+
+/*
+ * Check if the Route bulk remove API returns appropriate error status for
+ * non existing Routes mixed with existing ones, in both error modes.
+ */
+TEST_F (saiL3RouteTest, route_bulk_remove_mixed_error_modes)
+{
+    sai_status_t              sai_rc = SAI_STATUS_SUCCESS;
+    sai_ip_addr_family_t      family = SAI_IP_ADDR_FAMILY_IPV4;
+    sai_test_route_batch_t    batch;
+    sai_test_route_batch_t    stop_batch;
+    sai_test_route_batch_t    ignore_batch;
+
+    if (!sai_test_route_bulk_supported ()) {
+        printf ("Route bulk APIs are not supported, skipping test.\r\n");
+        return;
+    }
+
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.4.1.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.4.2.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+    sai_test_route_batch_add (&batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.4.3.0", 24, 1,
+                              SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID, nh_id_1);
+
+    sai_rc = sai_test_route_bulk_create (&batch,
+                                         SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    /* Remove stops at the non existing Route */
+    sai_test_route_batch_add (&stop_batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.4.1.0", 24, 0);
+    sai_test_route_batch_add (&stop_batch, SAI_STATUS_ITEM_NOT_FOUND, vr_id,
+                              family, "10.4.9.0", 24, 0);
+    sai_test_route_batch_add (&stop_batch, SAI_STATUS_SUCCESS, vr_id, family,
+                              "10.4.2.0", 24, 0);
+
+    sai_rc = sai_test_route_bulk_remove (&stop_batch,
+                                         SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                   sai_rc, stop_batch.expected,
+                                   stop_batch.statuses);
+
+    /* Remove continues after the non existing Route */
+    sai_test_route_batch_add (&ignore_batch, SAI_STATUS_ITEM_NOT_FOUND, vr_id,
+                              family, "10.4.1.0", 24, 0);
+    sai_test_route_batch_add (&ignore_batch, SAI_STATUS_SUCCESS, vr_id,
+                              family, "10.4.2.0", 24, 0);
+    sai_test_route_batch_add (&ignore_batch, SAI_STATUS_ITEM_NOT_FOUND, vr_id,
+                              family, "10.4.9.0", 24, 0);
+    sai_test_route_batch_add (&ignore_batch, SAI_STATUS_SUCCESS, vr_id,
+                              family, "10.4.3.0", 24, 0);
+
+    sai_rc = sai_test_route_bulk_remove (&ignore_batch,
+                                         SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR);
+
+    sai_test_bulk_statuses_verify (SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+                                   sai_rc, ignore_batch.expected,
+                                   ignore_batch.statuses);
+}
+
 int main (int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
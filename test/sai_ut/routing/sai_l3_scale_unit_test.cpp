@@ -0,0 +1,1005 @@
+/************************************************************************
+* Copyright (c) 2015 Dell Inc.
+*
+*    Licensed under the Apache License, Version 2.0 (the "License"); you may
+*    not use this file except in compliance with the License. You may obtain
+*    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+*
+*    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+*    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+*    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+*    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+*
+*    See the Apache Version 2.0 License for specific language governing
+*    permissions and limitations under the License.
+*
+*
+* Module Name:
+*
+*    sai_l3_scale_unit_test.cpp
+*
+* Abstract:
+*
+*    SAI L3 SCALE UNIT TEST :- Covers create, set and remove of routes,
+*    neighbors and next-hop group members at scale. Bulk APIs are used when
+*    the SAI library provides them, per object APIs otherwise.
+*
+*    For every operation the throughput, per object latency percentiles and
+*    the process memory delta are printed and recorded as gtest properties,
+*    so running with --gtest_output=xml:<file> gives results CI can graph.
+*
+*************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include "sai_l3_unit_test_utils.h"
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "saistatus.h"
+#include "saitypes.h"
+#include "sairoute.h"
+#include "saineighbor.h"
+#include "sainexthopgroup.h"
+#include "sai.h"
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+}
+
+/*
+ * Latency, throughput and memory statistics for single operation.
+ *
+ * For bulk calls one sample is taken per call, with the call duration
+ * divided by the number of objects in the call.
+ */
+class saiL3ScaleStats {
+    public:
+        saiL3ScaleStats (const char *op, const char *object_name)
+            : name (std::string (op) + "_" + object_name),
+              objects (0), total_ns (0), rss_start_kb (0), rss_delta_kb (0) {}
+
+        void start (void)
+        {
+            rss_start_kb = rss_kb_get ();
+        }
+
+        void sample (uint64_t ns, unsigned int count)
+        {
+            samples.push_back (ns / (count ? count : 1));
+
+            total_ns += ns;
+            objects  += count;
+        }
+
+        void stop (void)
+        {
+            rss_delta_kb = rss_kb_get () - rss_start_kb;
+        }
+
+        void record (bool bulk);
+
+        static uint64_t now_ns (void)
+        {
+            struct timespec ts;
+
+            clock_gettime (CLOCK_MONOTONIC, &ts);
+
+            return ((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+        }
+
+    private:
+        uint64_t percentile (unsigned int pct);
+
+        static long rss_kb_get (void);
+
+        std::string           name;
+        std::vector<uint64_t> samples;
+        unsigned int          objects;
+        uint64_t              total_ns;
+        long                  rss_start_kb;
+        long                  rss_delta_kb;
+};
+
+uint64_t saiL3ScaleStats ::percentile (unsigned int pct)
+{
+    if (samples.empty ()) {
+        return 0;
+    }
+
+    size_t idx = ((samples.size () - 1) * pct) / 100;
+
+    std::nth_element (samples.begin (), samples.begin () + idx, samples.end ());
+
+    return samples [idx];
+}
+
+long saiL3ScaleStats ::rss_kb_get (void)
+{
+    FILE *fp = fopen ("/proc/self/status", "r");
+    char  line [256];
+    long  rss_kb = 0;
+
+    if (!fp) {
+        return 0;
+    }
+
+    while (fgets (line, sizeof (line), fp)) {
+        if (sscanf (line, "VmRSS: %ld kB", &rss_kb) == 1) {
+            break;
+        }
+    }
+
+    fclose (fp);
+
+    return rss_kb;
+}
+
+void saiL3ScaleStats ::record (bool bulk)
+{
+    char     value [32];
+    uint64_t ops_per_sec = total_ns ? (objects * 1000000000ULL) / total_ns : 0;
+    uint64_t p50 = percentile (50);
+    uint64_t p90 = percentile (90);
+    uint64_t p99 = percentile (99);
+    uint64_t max = percentile (100);
+
+    printf ("%-32s %s %8u objects %10" PRIu64 " ops/s  p50 %8" PRIu64
+            " ns  p90 %8" PRIu64 " ns  p99 %8" PRIu64 " ns  max %8" PRIu64
+            " ns  rss %+ld kB\r\n", name.c_str (), bulk ? "bulk" : "single",
+            objects, ops_per_sec, p50, p90, p99, max, rss_delta_kb);
+
+    /* 64 bit values are recorded as strings, gtest int properties are 32 bit */
+    ::testing::Test::RecordProperty (name + "_objects", objects);
+    ::testing::Test::RecordProperty (name + "_bulk", bulk ? 1 : 0);
+
+    snprintf (value, sizeof (value), "%" PRIu64, ops_per_sec);
+    ::testing::Test::RecordProperty (name + "_ops_per_sec", value);
+
+    snprintf (value, sizeof (value), "%" PRIu64, p50);
+    ::testing::Test::RecordProperty (name + "_p50_ns", value);
+
+    snprintf (value, sizeof (value), "%" PRIu64, p90);
+    ::testing::Test::RecordProperty (name + "_p90_ns", value);
+
+    snprintf (value, sizeof (value), "%" PRIu64, p99);
+    ::testing::Test::RecordProperty (name + "_p99_ns", value);
+
+    snprintf (value, sizeof (value), "%" PRIu64, max);
+    ::testing::Test::RecordProperty (name + "_max_ns", value);
+
+    snprintf (value, sizeof (value), "%ld", rss_delta_kb);
+    ::testing::Test::RecordProperty (name + "_rss_delta_kb", value);
+}
+
+/* Next-hop group scale, number of groups and members per group */
+struct sai_test_nh_group_scale_t {
+    unsigned int groups;
+    unsigned int members;
+};
+
+::std::ostream& operator<< (::std::ostream& os,
+                            const sai_test_nh_group_scale_t& scale)
+{
+    return os << scale.groups << "x" << scale.members;
+}
+
+class saiL3ScaleTest : public saiL3Test {
+    public:
+        static void SetUpTestCase (void);
+        static void TearDownTestCase (void);
+
+        static bool sai_test_is_bulk_status (sai_status_t status)
+        {
+            return (status != SAI_STATUS_NOT_IMPLEMENTED &&
+                    status != SAI_STATUS_NOT_SUPPORTED);
+        }
+
+        static void sai_test_route_entry_get (unsigned int index,
+                                              sai_route_entry_t *p_entry);
+        static void sai_test_neighbor_entry_get (unsigned int index,
+                                                 sai_neighbor_entry_t *p_entry);
+        static void sai_test_nh_neighbor_entry_get (unsigned int index,
+                                                    sai_neighbor_entry_t *p_entry);
+
+        static const unsigned int test_port = 0;
+        static const unsigned int bulk_size = 1024;
+        static const unsigned int max_nh_count = 128;
+
+        /* Test harness initializes the switch without switch object id */
+        static const sai_object_id_t switch_id = SAI_NULL_OBJECT_ID;
+
+        /*
+         * Route prefixes 10.0.0.0/32 + index, neighbors 20.0.0.0 + index,
+         * next-hops and their neighbors 30.0.0.0 + index
+         */
+        static const uint32_t route_base_ip = 0x0a000000;
+        static const uint32_t neighbor_base_ip = 0x14000000;
+        static const uint32_t nh_base_ip = 0x1e000000;
+
+        static sai_object_id_t vr_id;
+        static sai_object_id_t rif_id;
+        static sai_object_id_t nh_id_list [max_nh_count];
+};
+
+const unsigned int saiL3ScaleTest ::bulk_size;
+const unsigned int saiL3ScaleTest ::max_nh_count;
+
+sai_object_id_t saiL3ScaleTest ::vr_id = 0;
+sai_object_id_t saiL3ScaleTest ::rif_id = 0;
+sai_object_id_t saiL3ScaleTest ::nh_id_list [max_nh_count] = {0};
+
+void saiL3ScaleTest ::SetUpTestCase (void)
+{
+    sai_neighbor_api_t   *p_nbr_api = NULL;
+    sai_next_hop_api_t   *p_nh_api = NULL;
+    sai_neighbor_entry_t  nbr_entry;
+    sai_attribute_t       nbr_attr;
+    sai_attribute_t       nh_attr [default_nh_attr_count];
+    sai_status_t          sai_rc = SAI_STATUS_SUCCESS;
+    unsigned int          id = 0;
+
+    /* Base SetUpTestCase for SAI initialization */
+    saiL3Test ::SetUpTestCase ();
+
+    sai_rc = sai_test_router_mac_init (router_mac);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = sai_test_vrf_create (&vr_id, 0);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = sai_test_rif_create (&rif_id, default_rif_attr_count,
+                                  SAI_ROUTER_INTERFACE_ATTR_VIRTUAL_ROUTER_ID,
+                                  vr_id,
+                                  SAI_ROUTER_INTERFACE_ATTR_TYPE,
+                                  SAI_ROUTER_INTERFACE_TYPE_PORT,
+                                  SAI_ROUTER_INTERFACE_ATTR_PORT_ID,
+                                  sai_l3_port_id_get (test_port));
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    p_nbr_api = neighbor_api_tbl_get ();
+    p_nh_api  = nh_api_tbl_get ();
+
+    /* Next-hops used by routes and next-hop group members */
+    for (id = 0; id < max_nh_count; id++) {
+        sai_test_nh_neighbor_entry_get (id, &nbr_entry);
+
+        memset (&nbr_attr, 0, sizeof (nbr_attr));
+
+        nbr_attr.id = SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS;
+        nbr_attr.value.mac [1] = 0x33;
+        nbr_attr.value.mac [4] = (uint8_t) (id / 256);
+        nbr_attr.value.mac [5] = (uint8_t) (id % 256);
+
+        sai_rc = p_nbr_api->create_neighbor_entry (&nbr_entry,
+                                                   default_neighbor_attr_count,
+                                                   &nbr_attr);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+        memset (nh_attr, 0, sizeof (nh_attr));
+
+        nh_attr [0].id           = SAI_NEXT_HOP_ATTR_TYPE;
+        nh_attr [0].value.s32    = SAI_NEXT_HOP_TYPE_IP;
+
+        nh_attr [1].id           = SAI_NEXT_HOP_ATTR_IP;
+        nh_attr [1].value.ipaddr = nbr_entry.ip_address;
+
+        nh_attr [2].id           = SAI_NEXT_HOP_ATTR_ROUTER_INTERFACE_ID;
+        nh_attr [2].value.oid    = rif_id;
+
+        sai_rc = p_nh_api->create_next_hop (&nh_id_list [id], switch_id,
+                                            default_nh_attr_count, nh_attr);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+}
+
+void saiL3ScaleTest ::TearDownTestCase (void)
+{
+    sai_neighbor_api_t   *p_nbr_api = neighbor_api_tbl_get ();
+    sai_next_hop_api_t   *p_nh_api = nh_api_tbl_get ();
+    sai_neighbor_entry_t  nbr_entry;
+    sai_status_t          sai_rc = SAI_STATUS_SUCCESS;
+    unsigned int          id = 0;
+
+    for (id = 0; id < max_nh_count; id++) {
+        sai_rc = p_nh_api->remove_next_hop (nh_id_list [id]);
+
+        EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+        sai_test_nh_neighbor_entry_get (id, &nbr_entry);
+
+        sai_rc = p_nbr_api->remove_neighbor_entry (&nbr_entry);
+
+        EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+
+    sai_rc = sai_test_rif_remove (rif_id);
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = sai_test_vrf_remove (vr_id);
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+}
+
+void saiL3ScaleTest ::sai_test_route_entry_get (unsigned int index,
+                                                sai_route_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_route_entry_t));
+
+    p_entry->switch_id = switch_id;
+    p_entry->vr_id     = vr_id;
+    p_entry->destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    p_entry->destination.addr.ip4    = htonl (route_base_ip + index);
+    p_entry->destination.mask.ip4    = 0xffffffff;
+}
+
+void saiL3ScaleTest ::sai_test_neighbor_entry_get (unsigned int index,
+                                                   sai_neighbor_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_neighbor_entry_t));
+
+    p_entry->switch_id = switch_id;
+    p_entry->rif_id    = rif_id;
+    p_entry->ip_address.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    p_entry->ip_address.addr.ip4    = htonl (neighbor_base_ip + index);
+}
+
+void saiL3ScaleTest ::sai_test_nh_neighbor_entry_get (unsigned int index,
+                                                      sai_neighbor_entry_t *p_entry)
+{
+    sai_test_neighbor_entry_get (0, p_entry);
+
+    p_entry->ip_address.addr.ip4 = htonl (nh_base_ip + index);
+}
+
+/*
+ * Route scale, parameter is the number of routes.
+ */
+class saiL3RouteScaleTest : public saiL3ScaleTest,
+                            public ::testing::WithParamInterface<unsigned int> {
+    public:
+        static void sai_test_route_scale_create (unsigned int count,
+                                                 sai_object_id_t nh_id,
+                                                 saiL3ScaleStats *p_stats,
+                                                 bool *p_bulk);
+        static void sai_test_route_scale_set (unsigned int count,
+                                              sai_object_id_t nh_id,
+                                              saiL3ScaleStats *p_stats,
+                                              bool *p_bulk);
+        static void sai_test_route_scale_remove (unsigned int count,
+                                                 saiL3ScaleStats *p_stats,
+                                                 bool *p_bulk);
+};
+
+void saiL3RouteScaleTest ::sai_test_route_scale_create (unsigned int count,
+                                                        sai_object_id_t nh_id,
+                                                        saiL3ScaleStats *p_stats,
+                                                        bool *p_bulk)
+{
+    sai_route_api_t                *p_api = route_api_tbl_get ();
+    std::vector<sai_route_entry_t>  entries (bulk_size);
+    std::vector<sai_attribute_t>    attrs (bulk_size);
+    std::vector<uint32_t>           attr_counts (bulk_size, 1);
+    std::vector<const sai_attribute_t *> attr_lists (bulk_size);
+    std::vector<sai_status_t>       statuses (bulk_size);
+    unsigned int                    base = 0;
+    unsigned int                    idx = 0;
+    sai_status_t                    sai_rc = SAI_STATUS_SUCCESS;
+
+    *p_bulk = (p_api->create_route_entries != NULL);
+
+    p_stats->start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        for (idx = 0; idx < n; idx++) {
+            sai_test_route_entry_get (base + idx, &entries [idx]);
+
+            attrs [idx].id        = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+            attrs [idx].value.oid = nh_id;
+            attr_lists [idx]      = &attrs [idx];
+        }
+
+        uint64_t start = saiL3ScaleStats ::now_ns ();
+
+        if (*p_bulk) {
+            sai_rc = p_api->create_route_entries (n, &entries [0],
+                                                  &attr_counts [0],
+                                                  &attr_lists [0],
+                                                  SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                  &statuses [0]);
+
+            if (!sai_test_is_bulk_status (sai_rc) && base == 0) {
+                *p_bulk = false;
+            } else {
+                p_stats->sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                for (idx = 0; idx < n; idx++) {
+                    ASSERT_EQ (SAI_STATUS_SUCCESS, statuses [idx]);
+                }
+
+                continue;
+            }
+        }
+
+        for (idx = 0; idx < n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->create_route_entry (&entries [idx], 1,
+                                                &attrs [idx]);
+
+            p_stats->sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    p_stats->stop ();
+}
+
+void saiL3RouteScaleTest ::sai_test_route_scale_set (unsigned int count,
+                                                     sai_object_id_t nh_id,
+                                                     saiL3ScaleStats *p_stats,
+                                                     bool *p_bulk)
+{
+    sai_route_api_t                *p_api = route_api_tbl_get ();
+    std::vector<sai_route_entry_t>  entries (bulk_size);
+    std::vector<sai_attribute_t>    attrs (bulk_size);
+    std::vector<sai_status_t>       statuses (bulk_size);
+    unsigned int                    base = 0;
+    unsigned int                    idx = 0;
+    sai_status_t                    sai_rc = SAI_STATUS_SUCCESS;
+
+    *p_bulk = (p_api->set_route_entries_attribute != NULL);
+
+    p_stats->start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        for (idx = 0; idx < n; idx++) {
+            sai_test_route_entry_get (base + idx, &entries [idx]);
+
+            attrs [idx].id        = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+            attrs [idx].value.oid = nh_id;
+        }
+
+        uint64_t start = saiL3ScaleStats ::now_ns ();
+
+        if (*p_bulk) {
+            sai_rc = p_api->set_route_entries_attribute (n, &entries [0],
+                                                         &attrs [0],
+                                                         SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                         &statuses [0]);
+
+            if (!sai_test_is_bulk_status (sai_rc) && base == 0) {
+                *p_bulk = false;
+            } else {
+                p_stats->sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                for (idx = 0; idx < n; idx++) {
+                    ASSERT_EQ (SAI_STATUS_SUCCESS, statuses [idx]);
+                }
+
+                continue;
+            }
+        }
+
+        for (idx = 0; idx < n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->set_route_entry_attribute (&entries [idx],
+                                                       &attrs [idx]);
+
+            p_stats->sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    p_stats->stop ();
+}
+
+void saiL3RouteScaleTest ::sai_test_route_scale_remove (unsigned int count,
+                                                        saiL3ScaleStats *p_stats,
+                                                        bool *p_bulk)
+{
+    sai_route_api_t                *p_api = route_api_tbl_get ();
+    std::vector<sai_route_entry_t>  entries (bulk_size);
+    std::vector<sai_status_t>       statuses (bulk_size);
+    unsigned int                    base = 0;
+    unsigned int                    idx = 0;
+    sai_status_t                    sai_rc = SAI_STATUS_SUCCESS;
+
+    *p_bulk = (p_api->remove_route_entries != NULL);
+
+    p_stats->start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        for (idx = 0; idx < n; idx++) {
+            sai_test_route_entry_get (base + idx, &entries [idx]);
+        }
+
+        uint64_t start = saiL3ScaleStats ::now_ns ();
+
+        if (*p_bulk) {
+            sai_rc = p_api->remove_route_entries (n, &entries [0],
+                                                  SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                  &statuses [0]);
+
+            if (!sai_test_is_bulk_status (sai_rc) && base == 0) {
+                *p_bulk = false;
+            } else {
+                p_stats->sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                for (idx = 0; idx < n; idx++) {
+                    ASSERT_EQ (SAI_STATUS_SUCCESS, statuses [idx]);
+                }
+
+                continue;
+            }
+        }
+
+        for (idx = 0; idx < n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->remove_route_entry (&entries [idx]);
+
+            p_stats->sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    p_stats->stop ();
+}
+
+TEST_P (saiL3RouteScaleTest, create_set_remove)
+{
+    const unsigned int  count = GetParam ();
+    saiL3ScaleStats     create_stats ("create", "route");
+    saiL3ScaleStats     set_stats ("set", "route");
+    saiL3ScaleStats     remove_stats ("remove", "route");
+    bool                bulk = false;
+
+    ASSERT_NO_FATAL_FAILURE (sai_test_route_scale_create (count,
+                                                          nh_id_list [0],
+                                                          &create_stats,
+                                                          &bulk));
+    create_stats.record (bulk);
+
+    ASSERT_NO_FATAL_FAILURE (sai_test_route_scale_set (count, nh_id_list [1],
+                                                       &set_stats, &bulk));
+    set_stats.record (bulk);
+
+    ASSERT_NO_FATAL_FAILURE (sai_test_route_scale_remove (count,
+                                                          &remove_stats,
+                                                          &bulk));
+    remove_stats.record (bulk);
+}
+
+INSTANTIATE_TEST_CASE_P (routes, saiL3RouteScaleTest,
+                         ::testing::Values (1024u, 16384u, 131072u, 1048576u));
+
+/*
+ * Neighbor scale, parameter is the number of neighbors.
+ */
+class saiL3NeighborScaleTest : public saiL3ScaleTest,
+                               public ::testing::WithParamInterface<unsigned int> {
+    public:
+        static void sai_test_neighbor_mac_get (unsigned int index,
+                                               unsigned int gen,
+                                               sai_attribute_t *p_attr)
+        {
+            p_attr->id = SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS;
+            p_attr->value.mac [0] = 0x00;
+            p_attr->value.mac [1] = 0x44;
+            p_attr->value.mac [2] = (uint8_t) gen;
+            p_attr->value.mac [3] = (uint8_t) (index >> 16);
+            p_attr->value.mac [4] = (uint8_t) (index >> 8);
+            p_attr->value.mac [5] = (uint8_t) index;
+        }
+};
+
+TEST_P (saiL3NeighborScaleTest, create_set_remove)
+{
+    sai_neighbor_api_t                *p_api = neighbor_api_tbl_get ();
+    const unsigned int                 count = GetParam ();
+    std::vector<sai_neighbor_entry_t>  entries (count);
+    std::vector<sai_attribute_t>       attrs (count);
+    std::vector<uint32_t>              attr_counts (count, 1);
+    std::vector<const sai_attribute_t *> attr_lists (count);
+    std::vector<sai_status_t>          statuses (count);
+    saiL3ScaleStats                    create_stats ("create", "neighbor");
+    saiL3ScaleStats                    set_stats ("set", "neighbor");
+    saiL3ScaleStats                    remove_stats ("remove", "neighbor");
+    unsigned int                       base = 0;
+    unsigned int                       idx = 0;
+    sai_status_t                       sai_rc = SAI_STATUS_SUCCESS;
+    uint64_t                           start = 0;
+    bool                               bulk = false;
+
+    for (idx = 0; idx < count; idx++) {
+        sai_test_neighbor_entry_get (idx, &entries [idx]);
+        sai_test_neighbor_mac_get (idx, 0, &attrs [idx]);
+
+        attr_lists [idx] = &attrs [idx];
+    }
+
+    /* Create */
+    bulk = (p_api->create_neighbor_entries != NULL);
+
+    create_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->create_neighbor_entries (n, &entries [base],
+                                                     &attr_counts [base],
+                                                     &attr_lists [base],
+                                                     SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                     &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                create_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->create_neighbor_entry (&entries [idx], 1,
+                                                   &attrs [idx]);
+
+            create_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    create_stats.stop ();
+    create_stats.record (bulk);
+
+    /* Set */
+    for (idx = 0; idx < count; idx++) {
+        sai_test_neighbor_mac_get (idx, 1, &attrs [idx]);
+    }
+
+    bulk = (p_api->set_neighbor_entries_attribute != NULL);
+
+    set_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->set_neighbor_entries_attribute (n, &entries [base],
+                                                            &attrs [base],
+                                                            SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                            &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                set_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->set_neighbor_entry_attribute (&entries [idx],
+                                                          &attrs [idx]);
+
+            set_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    set_stats.stop ();
+    set_stats.record (bulk);
+
+    /* Remove */
+    bulk = (p_api->remove_neighbor_entries != NULL);
+
+    remove_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->remove_neighbor_entries (n, &entries [base],
+                                                     SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                     &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                remove_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->remove_neighbor_entry (&entries [idx]);
+
+            remove_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    remove_stats.stop ();
+    remove_stats.record (bulk);
+}
+
+INSTANTIATE_TEST_CASE_P (neighbors, saiL3NeighborScaleTest,
+                         ::testing::Values (1024u, 8192u, 65536u));
+
+/*
+ * Next-hop group scale, parameter is the number of groups and the number
+ * of members in each group. Members are spread over the test next-hops.
+ */
+class saiL3NextHopGroupScaleTest : public saiL3ScaleTest,
+                                   public ::testing::WithParamInterface<sai_test_nh_group_scale_t> {
+};
+
+TEST_P (saiL3NextHopGroupScaleTest, create_set_remove)
+{
+    sai_next_hop_group_api_t          *p_api = nh_group_api_tbl_get ();
+    const sai_test_nh_group_scale_t    scale = GetParam ();
+    const unsigned int                 count = scale.groups * scale.members;
+    std::vector<sai_object_id_t>       group_ids (scale.groups);
+    std::vector<sai_object_id_t>       member_ids (count);
+    std::vector<sai_attribute_t>       attrs (2 * count);
+    std::vector<uint32_t>              attr_counts (count, 2);
+    std::vector<const sai_attribute_t *> attr_lists (count);
+    std::vector<sai_status_t>          statuses (count);
+    saiL3ScaleStats                    group_create_stats ("create", "next_hop_group");
+    saiL3ScaleStats                    group_remove_stats ("remove", "next_hop_group");
+    saiL3ScaleStats                    create_stats ("create", "next_hop_group_member");
+    saiL3ScaleStats                    set_stats ("set", "next_hop_group_member");
+    saiL3ScaleStats                    remove_stats ("remove", "next_hop_group_member");
+    sai_attribute_t                    attr;
+    unsigned int                       base = 0;
+    unsigned int                       idx = 0;
+    sai_status_t                       sai_rc = SAI_STATUS_SUCCESS;
+    uint64_t                           start = 0;
+    bool                               bulk = false;
+
+    /* Groups have no bulk API */
+    attr.id       = SAI_NEXT_HOP_GROUP_ATTR_TYPE;
+    attr.value.s32 = SAI_NEXT_HOP_GROUP_TYPE_DYNAMIC_UNORDERED_ECMP;
+
+    group_create_stats.start ();
+
+    for (idx = 0; idx < scale.groups; idx++) {
+        start = saiL3ScaleStats ::now_ns ();
+
+        sai_rc = p_api->create_next_hop_group (&group_ids [idx], switch_id,
+                                               1, &attr);
+
+        group_create_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+
+    group_create_stats.stop ();
+    group_create_stats.record (false);
+
+    for (idx = 0; idx < count; idx++) {
+        attrs [2 * idx].id = SAI_NEXT_HOP_GROUP_MEMBER_ATTR_NEXT_HOP_GROUP_ID;
+        attrs [2 * idx].value.oid = group_ids [idx / scale.members];
+        attrs [2 * idx + 1].id = SAI_NEXT_HOP_GROUP_MEMBER_ATTR_NEXT_HOP_ID;
+        attrs [2 * idx + 1].value.oid = nh_id_list [idx % max_nh_count];
+
+        attr_lists [idx] = &attrs [2 * idx];
+    }
+
+    /* Create members */
+    bulk = (p_api->create_next_hop_group_members != NULL);
+
+    create_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->create_next_hop_group_members (switch_id, n,
+                                                           &attr_counts [base],
+                                                           &attr_lists [base],
+                                                           SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                           &member_ids [base],
+                                                           &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                create_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->create_next_hop_group_member (&member_ids [idx],
+                                                          switch_id, 2,
+                                                          attr_lists [idx]);
+
+            create_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    create_stats.stop ();
+    create_stats.record (bulk);
+
+    /* Set member weights */
+    for (idx = 0; idx < count; idx++) {
+        attrs [idx].id = SAI_NEXT_HOP_GROUP_MEMBER_ATTR_WEIGHT;
+        attrs [idx].value.u32 = 1 + (idx % 4);
+    }
+
+    bulk = (p_api->set_next_hop_group_members_attribute != NULL);
+
+    set_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->set_next_hop_group_members_attribute (n,
+                                                                  &member_ids [base],
+                                                                  &attrs [base],
+                                                                  SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                                  &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                set_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->set_next_hop_group_member_attribute (member_ids [idx],
+                                                                 &attrs [idx]);
+
+            set_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    set_stats.stop ();
+    set_stats.record (bulk);
+
+    /* Remove members */
+    bulk = (p_api->remove_next_hop_group_members != NULL);
+
+    remove_stats.start ();
+
+    for (base = 0; base < count; base += bulk_size) {
+        unsigned int n = std::min (bulk_size, count - base);
+
+        start = saiL3ScaleStats ::now_ns ();
+
+        if (bulk) {
+            sai_rc = p_api->remove_next_hop_group_members (n, &member_ids [base],
+                                                           SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR,
+                                                           &statuses [base]);
+
+            if (sai_test_is_bulk_status (sai_rc) || base != 0) {
+                remove_stats.sample (saiL3ScaleStats ::now_ns () - start, n);
+
+                ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+                continue;
+            }
+
+            bulk = false;
+        }
+
+        for (idx = base; idx < base + n; idx++) {
+            start = saiL3ScaleStats ::now_ns ();
+
+            sai_rc = p_api->remove_next_hop_group_member (member_ids [idx]);
+
+            remove_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+            ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+        }
+    }
+
+    remove_stats.stop ();
+    remove_stats.record (bulk);
+
+    group_remove_stats.start ();
+
+    for (idx = 0; idx < scale.groups; idx++) {
+        start = saiL3ScaleStats ::now_ns ();
+
+        sai_rc = p_api->remove_next_hop_group (group_ids [idx]);
+
+        group_remove_stats.sample (saiL3ScaleStats ::now_ns () - start, 1);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+
+    group_remove_stats.stop ();
+    group_remove_stats.record (false);
+}
+
+static const sai_test_nh_group_scale_t nh_group_scales [] = {
+    {   64,  16 },
+    { 1024,  64 },
+    { 4096, 128 },
+};
+
+INSTANTIATE_TEST_CASE_P (nh_groups, saiL3NextHopGroupScaleTest,
+                         ::testing::ValuesIn (nh_group_scales));
+
+int main (int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -34,8 +34,8 @@ extern "C" {
 #include "saitypes.h"
 #include "saistatus.h"
 #include "saiswitch.h"
-#include "sairouter.h"
-#include "sairouterintf.h"
+#include "saivirtualrouter.h"
+#include "sairouterinterface.h"
 #include "saineighbor.h"
 #include "sainexthop.h"
 #include "sainexthopgroup.h"
@@ -1052,11 +1052,11 @@ unsigned int rt_prefix_len, sai_unicast_route_entry_t *p_uc_route)
 
 static const char* sai_test_route_attr_id_to_name_get (unsigned int attr_id)
 {
-    if (SAI_ROUTE_ATTR_PACKET_ACTION == attr_id) {
+    if (SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION == attr_id) {
         return "ROUTE PACKET ACTION";
-    } else if (SAI_ROUTE_ATTR_TRAP_PRIORITY == attr_id) {
-        return "ROUTE TRAP PRIORITY";
-    } else if (SAI_ROUTE_ATTR_NEXT_HOP_ID == attr_id) {
+    } else if (SAI_ROUTE_ENTRY_ATTR_USER_TRAP_ID == attr_id) {
+        return "ROUTE USER TRAP ID OBJECT";
+    } else if (SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID == attr_id) {
         return "ROUTE NEXT-HOP ID OBJECT";
     } else {
         return "INVALID/UNKNOWN";
@@ -1067,19 +1067,14 @@ static void sai_test_route_attr_value_fill (sai_attribute_t *p_attr,
                                             unsigned long attr_val)
 {
     switch (p_attr->id) {
-        case SAI_ROUTE_ATTR_PACKET_ACTION:
+        case SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION:
             p_attr->value.s32 = attr_val;
 
             printf ("Value: %d\r\n", p_attr->value.s32);
             break;
 
-        case SAI_ROUTE_ATTR_TRAP_PRIORITY:
-            p_attr->value.u8 = attr_val;
-
-            printf ("Value: %d\r\n", p_attr->value.u8);
-            break;
-
-        case SAI_ROUTE_ATTR_NEXT_HOP_ID:
+        case SAI_ROUTE_ENTRY_ATTR_USER_TRAP_ID:
+        case SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID:
             p_attr->value.oid = attr_val;
 
             printf ("Value: 0x%"PRIx64"\r\n", p_attr->value.oid);
@@ -1096,15 +1091,15 @@ static void sai_test_route_attr_value_fill (sai_attribute_t *p_attr,
 static void sai_test_route_attr_value_print (sai_attribute_t *p_attr)
 {
     switch (p_attr->id) {
-        case SAI_ROUTE_ATTR_PACKET_ACTION:
+        case SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION:
             printf ("Packet action: %d\r\n", p_attr->value.s32);
             break;
 
-        case SAI_ROUTE_ATTR_TRAP_PRIORITY:
-            printf ("Trap priority: %d\r\n", p_attr->value.u8);
+        case SAI_ROUTE_ENTRY_ATTR_USER_TRAP_ID:
+            printf ("User trap object ID: 0x%"PRIx64"\r\n", p_attr->value.oid);
             break;
 
-        case SAI_ROUTE_ATTR_NEXT_HOP_ID:
+        case SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID:
             printf ("Next Hop object ID: 0x%"PRIx64"\r\n", p_attr->value.oid);
             break;
 
@@ -1336,6 +1331,225 @@ sai_status_t saiL3Test ::sai_test_route_attr_get (sai_object_id_t vrf,
     return sai_rc;
 }
 
+static void sai_test_bulk_route_entry_fill (sai_object_id_t vrf_id,
+                                            unsigned int rt_af,
+                                            const char *ip_str,
+                                            unsigned int rt_prefix_len,
+                                            sai_route_entry_t *p_route)
+{
+    const unsigned int IPV6_ADDR_BYTE_LEN = 16;
+
+    memset (p_route, 0, sizeof (sai_route_entry_t));
+
+    /* Test switch is initialized without switch object id */
+    p_route->switch_id = SAI_NULL_OBJECT_ID;
+    p_route->vr_id = vrf_id;
+    p_route->destination.addr_family = (sai_ip_addr_family_t) rt_af;
+
+    if (rt_af == SAI_IP_ADDR_FAMILY_IPV4) {
+        inet_pton (AF_INET, ip_str, (void *)&p_route->destination.addr.ip4);
+
+        p_route->destination.mask.ip4 =
+            sai_test_ip_v4_prefix_len_to_mask (rt_prefix_len);
+    } else if (rt_af == SAI_IP_ADDR_FAMILY_IPV6) {
+        inet_pton (AF_INET6, ip_str, (void *)p_route->destination.addr.ip6);
+
+        sai_test_ip_v6_prefix_len_to_mask (p_route->destination.mask.ip6,
+                                           IPV6_ADDR_BYTE_LEN, rt_prefix_len);
+    }
+}
+
+bool saiL3Test ::sai_test_route_bulk_supported (void)
+{
+    return ((p_sai_route_api_tbl->create_route_entries != NULL) &&
+            (p_sai_route_api_tbl->remove_route_entries != NULL));
+}
+
+/*
+ * p_batch         - [inout] batch the route entry is appended to.
+ * expected_status - [in] expected status of the route entry create.
+ * vrf             - [in] VRF ID.
+ * ip_family       - [in] Ipv4/v6 address family.
+ * ip_str          - [in] ip prefix string.
+ * prefix_len      - [in] prefix length.
+ * attr_count      - [in] number of attributes passed.
+ *                   For each attribute, {id, value} is passed.
+ *
+ * For attr_count = 2,
+ * sai_test_route_batch_add (p_batch, expected_status, vrf, ip_family, ip_str,
+ *                           prefix_len, 2, id_0, val_0, id_1, val_1)
+ */
+sai_status_t saiL3Test ::sai_test_route_batch_add (
+                                             sai_test_route_batch_t *p_batch,
+                                             sai_status_t expected_status,
+                                             sai_object_id_t vrf,
+                                             unsigned int ip_family,
+                                             const char *ip_str,
+                                             unsigned int prefix_len,
+                                             unsigned int attr_count, ...)
+{
+    va_list            ap;
+    unsigned int       ap_idx = 0;
+    size_t             attr_base = p_batch->attrs.size ();
+    sai_route_entry_t  route_entry;
+    sai_attribute_t    attr;
+    unsigned long      val = 0;
+
+    if (attr_count > SAI_TEST_BULK_MAX_ATTR_COUNT) {
+        printf ("Route batch supports up to %d attributes per entry.\r\n",
+                SAI_TEST_BULK_MAX_ATTR_COUNT);
+
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    sai_test_bulk_route_entry_fill (vrf, ip_family, ip_str, prefix_len,
+                                    &route_entry);
+
+    printf ("Adding ROUTE %s/%d to batch index: %d with attribute count: "
+            "%d\r\n", ip_str, prefix_len, (int) p_batch->entries.size (),
+            attr_count);
+
+    memset (&attr, 0, sizeof (attr));
+
+    p_batch->attrs.resize (attr_base + SAI_TEST_BULK_MAX_ATTR_COUNT, attr);
+
+    va_start (ap, attr_count);
+
+    for (ap_idx = 0; ap_idx < attr_count; ap_idx++) {
+        p_batch->attrs [attr_base + ap_idx].id = va_arg (ap, unsigned int);
+
+        val = va_arg (ap, unsigned long);
+
+        sai_test_route_attr_value_fill (&p_batch->attrs [attr_base + ap_idx],
+                                        val);
+    }
+
+    va_end (ap);
+
+    p_batch->entries.push_back (route_entry);
+    p_batch->attr_counts.push_back (attr_count);
+    p_batch->expected.push_back (expected_status);
+    p_batch->statuses.push_back (SAI_STATUS_NOT_EXECUTED);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/*
+ * Copies route entries which were created by the last bulk call on p_batch
+ * to p_created, expecting them to be removed successfully.
+ */
+void saiL3Test ::sai_test_route_batch_created_get (
+                                          const sai_test_route_batch_t *p_batch,
+                                          sai_test_route_batch_t *p_created)
+{
+    sai_attribute_t  attr;
+    size_t           idx = 0;
+
+    memset (&attr, 0, sizeof (attr));
+
+    for (idx = 0; idx < p_batch->entries.size (); idx++) {
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+            continue;
+        }
+
+        p_created->entries.push_back (p_batch->entries [idx]);
+        p_created->attrs.resize (p_created->attrs.size () +
+                                 SAI_TEST_BULK_MAX_ATTR_COUNT, attr);
+        p_created->attr_counts.push_back (0);
+        p_created->expected.push_back (SAI_STATUS_SUCCESS);
+        p_created->statuses.push_back (SAI_STATUS_NOT_EXECUTED);
+    }
+}
+
+sai_status_t saiL3Test ::sai_test_route_bulk_create (
+                                                sai_test_route_batch_t *p_batch,
+                                                sai_bulk_op_error_mode_t mode)
+{
+    sai_status_t                          sai_rc = SAI_STATUS_SUCCESS;
+    uint32_t                              count = p_batch->entries.size ();
+    std::vector<const sai_attribute_t *>  attr_lists (count);
+    uint32_t                              idx = 0;
+
+    if (p_sai_route_api_tbl->create_route_entries == NULL) {
+        printf ("SAI ROUTE bulk create API is not implemented.\r\n");
+
+        return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        attr_lists [idx] = &p_batch->attrs [idx * SAI_TEST_BULK_MAX_ATTR_COUNT];
+        p_batch->statuses [idx] = SAI_STATUS_NOT_EXECUTED;
+    }
+
+    printf ("Testing ROUTE bulk create API with %d entries, error mode: "
+            "%d\r\n", count, mode);
+
+    sai_rc = p_sai_route_api_tbl->create_route_entries (
+                                      count,
+                                      count ? &p_batch->entries [0] : NULL,
+                                      count ? &p_batch->attr_counts [0] : NULL,
+                                      count ? &attr_lists [0] : NULL, mode,
+                                      count ? &p_batch->statuses [0] : NULL);
+
+    for (idx = 0; idx < count; idx++) {
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+            printf ("Route batch index: %d create status: %d\r\n", idx,
+                    p_batch->statuses [idx]);
+        }
+    }
+
+    if (sai_rc != SAI_STATUS_SUCCESS) {
+        printf ("SAI ROUTE bulk create failed with error: %d\r\n", sai_rc);
+    } else {
+        printf ("SAI ROUTE bulk create success.\r\n");
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiL3Test ::sai_test_route_bulk_remove (
+                                                sai_test_route_batch_t *p_batch,
+                                                sai_bulk_op_error_mode_t mode)
+{
+    sai_status_t  sai_rc = SAI_STATUS_SUCCESS;
+    uint32_t      count = p_batch->entries.size ();
+    uint32_t      idx = 0;
+
+    if (p_sai_route_api_tbl->remove_route_entries == NULL) {
+        printf ("SAI ROUTE bulk remove API is not implemented.\r\n");
+
+        return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        p_batch->statuses [idx] = SAI_STATUS_NOT_EXECUTED;
+    }
+
+    printf ("Testing ROUTE bulk remove API with %d entries, error mode: "
+            "%d\r\n", count, mode);
+
+    sai_rc = p_sai_route_api_tbl->remove_route_entries (
+                                      count,
+                                      count ? &p_batch->entries [0] : NULL,
+                                      mode,
+                                      count ? &p_batch->statuses [0] : NULL);
+
+    for (idx = 0; idx < count; idx++) {
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+            printf ("Route batch index: %d remove status: %d\r\n", idx,
+                    p_batch->statuses [idx]);
+        }
+    }
+
+    if (sai_rc != SAI_STATUS_SUCCESS) {
+        printf ("SAI ROUTE bulk remove failed with error: %d\r\n", sai_rc);
+    } else {
+        printf ("SAI ROUTE bulk remove success.\r\n");
+    }
+
+    return sai_rc;
+}
+
 const char* saiL3Test::sai_test_ip_addr_to_str (const sai_ip_address_t *p_ip_addr,
                                                 char *p_buf, size_t len)
 {
@@ -1567,19 +1781,19 @@ static void sai_test_neighbor_attr_value_pair_fill (sai_attribute_t *p_attr,
 
     switch (p_attr->id) {
 
-        case SAI_NEIGHBOR_ATTR_DST_MAC_ADDRESS:
+        case SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS:
             saiL3Test::sai_test_router_mac_str_to_bytes_get (attr_value_str,
                                                              sai_mac);
 
             memcpy (p_attr->value.mac, sai_mac, sizeof (sai_mac_t));
             break;
 
-        case SAI_NEIGHBOR_ATTR_PACKET_ACTION:
+        case SAI_NEIGHBOR_ENTRY_ATTR_PACKET_ACTION:
             p_attr->value.s32 = attr_value_int;
             printf ("Set Neighbor Pkt action value: %d.\n", p_attr->value.s32);
             break;
 
-        case SAI_NEIGHBOR_ATTR_NO_HOST_ROUTE:
+        case SAI_NEIGHBOR_ENTRY_ATTR_NO_HOST_ROUTE:
             p_attr->value.booldata = attr_value_int;
             printf ("Set Neighbor No Host Route value: %d.\n",
                     p_attr->value.booldata);
@@ -1654,7 +1868,7 @@ sai_status_t saiL3Test::sai_test_neighbor_create (
 
         p_attr->id = va_arg (varg_list, unsigned int);
 
-        if (p_attr->id == SAI_NEIGHBOR_ATTR_DST_MAC_ADDRESS) {
+        if (p_attr->id == SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS) {
 
             p_mac_str = va_arg (varg_list, const char *);
 
@@ -1781,7 +1995,7 @@ static void sai_test_neighbor_attr_list_print (unsigned int attr_count,
 
         switch (p_attr->id) {
 
-            case SAI_NEIGHBOR_ATTR_DST_MAC_ADDRESS:
+            case SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS:
                 printf ("Index: %d, Neighbor DST MAC: ", attr_index);
 
                 for (idx = 0; idx < 6; idx++) {
@@ -1793,12 +2007,12 @@ static void sai_test_neighbor_attr_list_print (unsigned int attr_count,
                 }
                 break;
 
-            case SAI_NEIGHBOR_ATTR_PACKET_ACTION:
+            case SAI_NEIGHBOR_ENTRY_ATTR_PACKET_ACTION:
                 printf ("Index: %d, Neighbor Pkt action: %d.\n",
                         attr_index, p_attr->value.s32);
                 break;
 
-            case SAI_NEIGHBOR_ATTR_NO_HOST_ROUTE:
+            case SAI_NEIGHBOR_ENTRY_ATTR_NO_HOST_ROUTE:
                 printf ("Index: %d, Neighbor No Host Route: %d.\n",
                         attr_index, p_attr->value.booldata);
                 break;
@@ -1874,6 +2088,249 @@ sai_status_t saiL3Test::sai_test_neighbor_attr_get (
     return sai_rc;
 }
 
+static void sai_test_bulk_neighbor_entry_fill (sai_object_id_t rif_id,
+                                               sai_ip_addr_family_t addr_family,
+                                               const char *ip_str,
+                                               sai_neighbor_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_neighbor_entry_t));
+
+    /* Test switch is initialized without switch object id */
+    p_entry->switch_id              = SAI_NULL_OBJECT_ID;
+    p_entry->rif_id                 = rif_id;
+    p_entry->ip_address.addr_family = addr_family;
+
+    if (addr_family == SAI_IP_ADDR_FAMILY_IPV4) {
+
+        inet_pton (AF_INET, ip_str, (void *) &p_entry->ip_address.addr.ip4);
+
+    } else {
+
+        inet_pton (AF_INET6, ip_str, (void *) &p_entry->ip_address.addr.ip6);
+    }
+}
+
+bool saiL3Test::sai_test_neighbor_bulk_supported (void)
+{
+    return ((p_sai_nbr_api_tbl->create_neighbor_entries != NULL) &&
+            (p_sai_nbr_api_tbl->remove_neighbor_entries != NULL));
+}
+
+/*
+ * p_batch         - [inout] batch the neighbor entry is appended to.
+ * expected_status - [in] expected status of the neighbor entry create.
+ * rif_id          - [in] RIF ID.
+ * addr_family     - [in] Ipv4/v6 address family.
+ * ip_str          - [in] ip addr string.
+ * attr_count      - [in] number of attributes passed.
+ *                   For each attribute, {id, value} is passed.
+ *
+ * For attr_count = 2,
+ * sai_test_neighbor_batch_add (p_batch, expected_status, rif_id, ip_family,
+ *                              ip_str, 2, id_0, val_0, id_1, val_1)
+ */
+sai_status_t saiL3Test::sai_test_neighbor_batch_add (
+                                          sai_test_neighbor_batch_t *p_batch,
+                                          sai_status_t expected_status,
+                                          sai_object_id_t rif_id,
+                                          sai_ip_addr_family_t addr_family,
+                                          const char *ip_str,
+                                          unsigned int attr_count, ...)
+{
+    va_list              varg_list;
+    unsigned int         index;
+    size_t               attr_base = p_batch->attrs.size ();
+    sai_neighbor_entry_t neighbor_entry;
+    sai_attribute_t      attr;
+    sai_attribute_t     *p_attr = NULL;
+    const char          *p_mac_str;
+    unsigned int         attr_val;
+
+    if (attr_count > SAI_TEST_BULK_MAX_ATTR_COUNT) {
+
+        printf ("Neighbor batch supports up to %d attributes per entry.\n",
+                SAI_TEST_BULK_MAX_ATTR_COUNT);
+
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    sai_test_bulk_neighbor_entry_fill (rif_id, addr_family, ip_str,
+                                       &neighbor_entry);
+
+    printf ("Adding Neighbor entry to batch index: %d, RIF Id: 0x%"PRIx64", "
+            "IP addr: %s.\n", (int) p_batch->entries.size (), rif_id, ip_str);
+
+    memset (&attr, 0, sizeof (attr));
+
+    p_batch->attrs.resize (attr_base + SAI_TEST_BULK_MAX_ATTR_COUNT, attr);
+
+    va_start (varg_list, attr_count);
+
+    for (index = 0; index < attr_count; index++) {
+
+        p_mac_str = NULL;
+        attr_val  = 0;
+
+        p_attr = &p_batch->attrs [attr_base + index];
+
+        p_attr->id = va_arg (varg_list, unsigned int);
+
+        if (p_attr->id == SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS) {
+
+            p_mac_str = va_arg (varg_list, const char *);
+
+        } else {
+
+            attr_val = va_arg (varg_list, unsigned int);
+        }
+
+        printf ("Attr Index: %d, ", index);
+
+        sai_test_neighbor_attr_value_pair_fill (p_attr, p_attr->id, attr_val,
+                                                p_mac_str);
+    }
+
+    va_end (varg_list);
+
+    p_batch->entries.push_back (neighbor_entry);
+    p_batch->attr_counts.push_back (attr_count);
+    p_batch->expected.push_back (expected_status);
+    p_batch->statuses.push_back (SAI_STATUS_NOT_EXECUTED);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/*
+ * Copies neighbor entries which were created by the last bulk call on
+ * p_batch to p_created, expecting them to be removed successfully.
+ */
+void saiL3Test::sai_test_neighbor_batch_created_get (
+                                       const sai_test_neighbor_batch_t *p_batch,
+                                       sai_test_neighbor_batch_t *p_created)
+{
+    sai_attribute_t  attr;
+    size_t           idx = 0;
+
+    memset (&attr, 0, sizeof (attr));
+
+    for (idx = 0; idx < p_batch->entries.size (); idx++) {
+
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+            continue;
+        }
+
+        p_created->entries.push_back (p_batch->entries [idx]);
+        p_created->attrs.resize (p_created->attrs.size () +
+                                 SAI_TEST_BULK_MAX_ATTR_COUNT, attr);
+        p_created->attr_counts.push_back (0);
+        p_created->expected.push_back (SAI_STATUS_SUCCESS);
+        p_created->statuses.push_back (SAI_STATUS_NOT_EXECUTED);
+    }
+}
+
+sai_status_t saiL3Test::sai_test_neighbor_bulk_create (
+                                             sai_test_neighbor_batch_t *p_batch,
+                                             sai_bulk_op_error_mode_t mode)
+{
+    sai_status_t                          sai_rc;
+    uint32_t                              count = p_batch->entries.size ();
+    std::vector<const sai_attribute_t *>  attr_lists (count);
+    uint32_t                              idx;
+
+    if (p_sai_nbr_api_tbl->create_neighbor_entries == NULL) {
+
+        printf ("SAI Neighbor bulk create API is not implemented.\n");
+
+        return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+
+        attr_lists [idx] = &p_batch->attrs [idx * SAI_TEST_BULK_MAX_ATTR_COUNT];
+        p_batch->statuses [idx] = SAI_STATUS_NOT_EXECUTED;
+    }
+
+    printf ("Testing Neighbor bulk create API with %d entries, error mode: "
+            "%d.\n", count, mode);
+
+    sai_rc = p_sai_nbr_api_tbl->create_neighbor_entries (
+                                      count,
+                                      count ? &p_batch->entries [0] : NULL,
+                                      count ? &p_batch->attr_counts [0] : NULL,
+                                      count ? &attr_lists [0] : NULL, mode,
+                                      count ? &p_batch->statuses [0] : NULL);
+
+    for (idx = 0; idx < count; idx++) {
+
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+
+            printf ("Neighbor batch index: %d create status: %d.\n", idx,
+                    p_batch->statuses [idx]);
+        }
+    }
+
+    if (sai_rc != SAI_STATUS_SUCCESS) {
+
+        printf ("SAI Neighbor bulk create failed with error: %d.\n", sai_rc);
+
+    } else {
+
+        printf ("SAI Neighbor bulk create success.\n");
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiL3Test::sai_test_neighbor_bulk_remove (
+                                             sai_test_neighbor_batch_t *p_batch,
+                                             sai_bulk_op_error_mode_t mode)
+{
+    sai_status_t  sai_rc;
+    uint32_t      count = p_batch->entries.size ();
+    uint32_t      idx;
+
+    if (p_sai_nbr_api_tbl->remove_neighbor_entries == NULL) {
+
+        printf ("SAI Neighbor bulk remove API is not implemented.\n");
+
+        return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+
+        p_batch->statuses [idx] = SAI_STATUS_NOT_EXECUTED;
+    }
+
+    printf ("Testing Neighbor bulk remove API with %d entries, error mode: "
+            "%d.\n", count, mode);
+
+    sai_rc = p_sai_nbr_api_tbl->remove_neighbor_entries (
+                                      count,
+                                      count ? &p_batch->entries [0] : NULL,
+                                      mode,
+                                      count ? &p_batch->statuses [0] : NULL);
+
+    for (idx = 0; idx < count; idx++) {
+
+        if (p_batch->statuses [idx] != SAI_STATUS_SUCCESS) {
+
+            printf ("Neighbor batch index: %d remove status: %d.\n", idx,
+                    p_batch->statuses [idx]);
+        }
+    }
+
+    if (sai_rc != SAI_STATUS_SUCCESS) {
+
+        printf ("SAI Neighbor bulk remove failed with error: %d.\n", sai_rc);
+
+    } else {
+
+        printf ("SAI Neighbor bulk remove success.\n");
+    }
+
+    return sai_rc;
+}
+
 /*
  * p_group_id  - [out] pointer to Next Hop Group ID generated by the SAI API.
  * p_nh_list   - [in]  pointer to the next hop list.
@@ -2203,3 +2660,69 @@ sai_status_t saiL3Test::sai_test_neighbor_fdb_entry_remove (
     return status;
 }
 
+/*
+ * mode     - [in] error mode the bulk API was called with.
+ * sai_rc   - [in] status returned by the bulk API.
+ * expected - [in] expected status of each object. SAI_STATUS_SUCCESS for
+ *            objects expected to succeed, any other value for objects
+ *            expected to fail. SAI_STATUS_FAILURE matches any failure,
+ *            other values must match exactly.
+ * statuses - [in] per object statuses returned by the bulk API.
+ *
+ * With SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR objects after the first failed
+ * one must not be executed, with SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR every
+ * object must have its expected status. The bulk API must return success
+ * only when all objects succeed.
+ */
+void saiL3Test::sai_test_bulk_statuses_verify (
+                                     sai_bulk_op_error_mode_t mode,
+                                     sai_status_t sai_rc,
+                                     const std::vector<sai_status_t> &expected,
+                                     const std::vector<sai_status_t> &statuses)
+{
+    size_t  idx;
+    bool    failed = false;
+
+    ASSERT_EQ (expected.size (), statuses.size ());
+
+    for (idx = 0; idx < expected.size (); idx++) {
+
+        if (failed && (mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR)) {
+
+            EXPECT_EQ (SAI_STATUS_NOT_EXECUTED, statuses [idx])
+                << "object index " << idx;
+
+            continue;
+        }
+
+        if (expected [idx] == SAI_STATUS_SUCCESS) {
+
+            EXPECT_EQ (SAI_STATUS_SUCCESS, statuses [idx])
+                << "object index " << idx;
+
+            continue;
+        }
+
+        failed = true;
+
+        if (expected [idx] == SAI_STATUS_FAILURE) {
+
+            EXPECT_NE (SAI_STATUS_SUCCESS, statuses [idx])
+                << "object index " << idx;
+
+        } else {
+
+            EXPECT_EQ (expected [idx], statuses [idx])
+                << "object index " << idx;
+        }
+    }
+
+    if (failed) {
+
+        EXPECT_NE (SAI_STATUS_SUCCESS, sai_rc);
+
+    } else {
+
+        EXPECT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+}
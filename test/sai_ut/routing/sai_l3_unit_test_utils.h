@@ -30,19 +30,51 @@
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 extern "C" {
 #include "saitypes.h"
 #include "saistatus.h"
 #include "saiswitch.h"
 #include "saivlan.h"
-#include "sairouter.h"
-#include "sairouterintf.h"
+#include "saivirtualrouter.h"
+#include "sairouterinterface.h"
 #include "saineighbor.h"
 #include "sainexthop.h"
 #include "sainexthopgroup.h"
 #include "sairoute.h"
+#include "saifdb.h"
 }
 
+/* Maximum number of attributes per object in bulk test batches */
+#define SAI_TEST_BULK_MAX_ATTR_COUNT 4
+
+/*
+ * Batch of route entries for bulk route SAI API testing. Entries and
+ * attributes are kept in contiguous arrays, in the layout expected by the
+ * bulk APIs. Each entry has SAI_TEST_BULK_MAX_ATTR_COUNT slots in attrs,
+ * of which attr_counts [idx] are used.
+ */
+typedef struct _sai_test_route_batch_t {
+    std::vector<sai_route_entry_t> entries;
+    std::vector<sai_attribute_t>   attrs;
+    std::vector<uint32_t>          attr_counts;
+    std::vector<sai_status_t>      expected;
+    std::vector<sai_status_t>      statuses;
+} sai_test_route_batch_t;
+
+/*
+ * Batch of neighbor entries for bulk neighbor SAI API testing, laid out
+ * the same way as sai_test_route_batch_t.
+ */
+typedef struct _sai_test_neighbor_batch_t {
+    std::vector<sai_neighbor_entry_t> entries;
+    std::vector<sai_attribute_t>      attrs;
+    std::vector<uint32_t>             attr_counts;
+    std::vector<sai_status_t>         expected;
+    std::vector<sai_status_t>         statuses;
+} sai_test_neighbor_batch_t;
+
 class saiL3Test : public ::testing::Test
 {
     public:
@@ -96,6 +128,24 @@ class saiL3Test : public ::testing::Test
                             sai_attribute_t *p_attr_list,
                             unsigned int attr_count, ...);
 
+        /* Methods for bulk ROUTE functionality SAI API testing. */
+        static bool sai_test_route_bulk_supported (void);
+        static sai_status_t sai_test_route_batch_add (
+                            sai_test_route_batch_t *p_batch,
+                            sai_status_t expected_status, sai_object_id_t vrf,
+                            unsigned int ip_family, const char *ip_str,
+                            unsigned int prefix_len, unsigned int attr_count,
+                            ...);
+        static void sai_test_route_batch_created_get (
+                            const sai_test_route_batch_t *p_batch,
+                            sai_test_route_batch_t *p_created);
+        static sai_status_t sai_test_route_bulk_create (
+                            sai_test_route_batch_t *p_batch,
+                            sai_bulk_op_error_mode_t mode);
+        static sai_status_t sai_test_route_bulk_remove (
+                            sai_test_route_batch_t *p_batch,
+                            sai_bulk_op_error_mode_t mode);
+
         /* Methods for NEXT-HOP functionality SAI API testing. */
         static sai_status_t sai_test_nexthop_create (sai_object_id_t *p_nh_id,
                                                      unsigned int attr_count,
@@ -133,6 +183,30 @@ class saiL3Test : public ::testing::Test
                             sai_attribute_t *p_attr_list,
                             unsigned int attr_count, ...);
 
+        /* Methods for bulk NEIGHBOR functionality SAI API testing. */
+        static bool sai_test_neighbor_bulk_supported (void);
+        static sai_status_t sai_test_neighbor_batch_add (
+                            sai_test_neighbor_batch_t *p_batch,
+                            sai_status_t expected_status,
+                            sai_object_id_t rif_id,
+                            sai_ip_addr_family_t ip_family, const char *ip_str,
+                            unsigned int attr_count, ...);
+        static void sai_test_neighbor_batch_created_get (
+                            const sai_test_neighbor_batch_t *p_batch,
+                            sai_test_neighbor_batch_t *p_created);
+        static sai_status_t sai_test_neighbor_bulk_create (
+                            sai_test_neighbor_batch_t *p_batch,
+                            sai_bulk_op_error_mode_t mode);
+        static sai_status_t sai_test_neighbor_bulk_remove (
+                            sai_test_neighbor_batch_t *p_batch,
+                            sai_bulk_op_error_mode_t mode);
+
+        /* Method for verifying per object statuses of bulk SAI API call */
+        static void sai_test_bulk_statuses_verify (
+                            sai_bulk_op_error_mode_t mode, sai_status_t sai_rc,
+                            const std::vector<sai_status_t> &expected,
+                            const std::vector<sai_status_t> &statuses);
+
         /* Methods for NEXT-HOP-GROUP functionality SAI API testing. */
         static sai_status_t sai_test_nh_group_create (
                                            sai_object_id_t *p_group_id,
@@ -191,6 +265,27 @@ class saiL3Test : public ::testing::Test
             return p_sai_switch_api_tbl;
         }
 
+        /* Methods for retrieving L3 API table pointers for scale tests */
+        static inline sai_route_api_t* route_api_tbl_get (void)
+        {
+            return p_sai_route_api_tbl;
+        }
+
+        static inline sai_neighbor_api_t* neighbor_api_tbl_get (void)
+        {
+            return p_sai_nbr_api_tbl;
+        }
+
+        static inline sai_next_hop_api_t* nh_api_tbl_get (void)
+        {
+            return p_sai_nh_api_tbl;
+        }
+
+        static inline sai_next_hop_group_api_t* nh_group_api_tbl_get (void)
+        {
+            return p_sai_nh_grp_api_tbl;
+        }
+
         static const unsigned int default_rif_attr_count      = 3;
         static const unsigned int default_nh_attr_count       = 3;
         static const unsigned int default_neighbor_attr_count = 1;
@@ -0,0 +1,1068 @@
+/************************************************************************
+* Copyright (c) 2015 Dell Inc.
+*
+*    Licensed under the Apache License, Version 2.0 (the "License"); you may
+*    not use this file except in compliance with the License. You may obtain
+*    a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+*
+*    THIS CODE IS PROVIDED ON AN  *AS IS* BASIS, WITHOUT WARRANTIES OR
+*    CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+*    LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+*    FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+*
+*    See the Apache Version 2.0 License for specific language governing
+*    permissions and limitations under the License.
+*
+*
+* Module Name:
+*
+*    sai_stress_unit_test.cpp
+*
+* Abstract:
+*
+*    SAI CONCURRENCY STRESS UNIT TEST :- Covers concurrent create, set, get
+*    and remove of routes, FDB entries, LAG members and VLAN members from
+*    multiple threads against shared parent objects (virtual router and
+*    next-hops, VLAN, LAG).
+*
+*    Every thread works on its own set of keys, so all calls are expected to
+*    succeed. After each phase the object counts returned by
+*    sai_get_object_count are checked against the number of objects the
+*    threads created. Each object kind is run with 1 up to 32 threads and
+*    the throughput at every thread count is printed and recorded as gtest
+*    properties.
+*
+*    Build with "make SANITIZE=thread" (or address,undefined) to run the
+*    suite under sanitizers, see README.
+*
+*************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include "routing/sai_l3_unit_test_utils.h"
+
+#include <string>
+
+extern "C" {
+#include "saistatus.h"
+#include "saitypes.h"
+#include "sairoute.h"
+#include "saifdb.h"
+#include "sailag.h"
+#include "saivlan.h"
+#include "saibridge.h"
+#include "saiobject.h"
+#include "sai.h"
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+}
+
+typedef enum _sai_stress_phase_t {
+    SAI_STRESS_PHASE_CREATE,
+    SAI_STRESS_PHASE_SET_GET,
+    SAI_STRESS_PHASE_REMOVE,
+    SAI_STRESS_PHASE_CHURN,
+} sai_stress_phase_t;
+
+/*
+ * Operations on single object kind run by the stress threads. Objects are
+ * identified by key in range [0, key_count). Keys are spread round robin
+ * over the threads working on the kind, so no two threads ever touch the
+ * same object.
+ */
+typedef struct _sai_stress_ops_t {
+    const char        *name;
+    sai_object_type_t  object_type;
+    unsigned int     (*key_count_get) (unsigned int thread_count);
+    sai_status_t     (*create) (unsigned int key);
+    sai_status_t     (*set) (unsigned int key, unsigned int gen);
+    sai_status_t     (*get) (unsigned int key);
+    sai_status_t     (*remove) (unsigned int key);
+} sai_stress_ops_t;
+
+/* State of single stress thread */
+typedef struct _sai_stress_thread_t {
+    pthread_t               thread;
+    const sai_stress_ops_t *p_ops;
+    sai_stress_phase_t      phase;
+    unsigned int            thread_idx;
+    unsigned int            thread_count;
+    unsigned int            key_count;
+    unsigned long           op_count;
+    unsigned long           fail_count;
+    sai_status_t            first_fail_status;
+    unsigned int            first_fail_key;
+} sai_stress_thread_t;
+
+class saiStressTest : public saiL3Test {
+    public:
+        static void SetUpTestCase (void);
+        static void TearDownTestCase (void);
+
+        static void sai_stress_run (const sai_stress_ops_t **p_ops_list,
+                                    unsigned int ops_count,
+                                    unsigned int thread_count,
+                                    unsigned long *p_op_count,
+                                    uint64_t *p_elapsed_ns);
+        static void sai_stress_scale (const sai_stress_ops_t *p_ops);
+
+        /* Route operations, keys are 10.x.y.0/24 prefixes */
+        static unsigned int sai_stress_route_key_count (unsigned int thread_count);
+        static sai_status_t sai_stress_route_create (unsigned int key);
+        static sai_status_t sai_stress_route_set (unsigned int key,
+                                                  unsigned int gen);
+        static sai_status_t sai_stress_route_get (unsigned int key);
+        static sai_status_t sai_stress_route_remove (unsigned int key);
+
+        /* FDB operations, keys are MAC addresses in the test VLAN */
+        static unsigned int sai_stress_fdb_key_count (unsigned int thread_count);
+        static sai_status_t sai_stress_fdb_create (unsigned int key);
+        static sai_status_t sai_stress_fdb_set (unsigned int key,
+                                                unsigned int gen);
+        static sai_status_t sai_stress_fdb_get (unsigned int key);
+        static sai_status_t sai_stress_fdb_remove (unsigned int key);
+
+        /* LAG member operations, keys are ports of the LAG port pool */
+        static unsigned int sai_stress_lag_member_key_count (
+                                                   unsigned int thread_count);
+        static sai_status_t sai_stress_lag_member_create (unsigned int key);
+        static sai_status_t sai_stress_lag_member_set (unsigned int key,
+                                                       unsigned int gen);
+        static sai_status_t sai_stress_lag_member_get (unsigned int key);
+        static sai_status_t sai_stress_lag_member_remove (unsigned int key);
+
+        /* VLAN member operations, keys are bridge ports of VLAN port pool */
+        static unsigned int sai_stress_vlan_member_key_count (
+                                                   unsigned int thread_count);
+        static sai_status_t sai_stress_vlan_member_create (unsigned int key);
+        static sai_status_t sai_stress_vlan_member_set (unsigned int key,
+                                                        unsigned int gen);
+        static sai_status_t sai_stress_vlan_member_get (unsigned int key);
+        static sai_status_t sai_stress_vlan_member_remove (unsigned int key);
+
+        static const sai_stress_ops_t route_ops;
+        static const sai_stress_ops_t fdb_ops;
+        static const sai_stress_ops_t lag_member_ops;
+        static const sai_stress_ops_t vlan_member_ops;
+
+        static const unsigned int max_threads = 32;
+        static const unsigned int keys_per_thread = 256;
+        static const unsigned int churn_iterations = 4;
+        static const unsigned int test_vlan_id = 100;
+
+        /* Test harness initializes the switch without switch object id */
+        static const sai_object_id_t switch_id = SAI_NULL_OBJECT_ID;
+
+        static sai_route_api_t    *p_route_api;
+        static sai_neighbor_api_t *p_nbr_api;
+        static sai_next_hop_api_t *p_nh_api;
+        static sai_fdb_api_t      *p_fdb_api;
+        static sai_lag_api_t      *p_lag_api;
+        static sai_vlan_api_t     *p_vlan_api;
+        static sai_bridge_api_t   *p_bridge_api;
+
+        static sai_object_id_t   vr_id;
+        static sai_object_id_t   rif_id;
+        static sai_object_id_t   nh_id_list [2];
+        static sai_object_id_t   lag_id;
+        static sai_object_id_t   vlan_oid;
+        static sai_object_id_t   fdb_vlan_member_id;
+        static sai_object_id_t   fdb_bridge_port_id;
+
+        static unsigned int      lag_port_count;
+        static sai_object_id_t   lag_port_list [SAI_TEST_MAX_PORTS];
+        static sai_object_id_t   lag_member_list [SAI_TEST_MAX_PORTS];
+
+        static unsigned int      vlan_port_count;
+        static sai_object_id_t   vlan_bridge_port_list [SAI_TEST_MAX_PORTS];
+        static sai_object_id_t   vlan_member_list [SAI_TEST_MAX_PORTS];
+};
+
+const unsigned int saiStressTest ::max_threads;
+const unsigned int saiStressTest ::keys_per_thread;
+const unsigned int saiStressTest ::churn_iterations;
+
+sai_route_api_t* saiStressTest ::p_route_api = NULL;
+sai_neighbor_api_t* saiStressTest ::p_nbr_api = NULL;
+sai_next_hop_api_t* saiStressTest ::p_nh_api = NULL;
+sai_fdb_api_t* saiStressTest ::p_fdb_api = NULL;
+sai_lag_api_t* saiStressTest ::p_lag_api = NULL;
+sai_vlan_api_t* saiStressTest ::p_vlan_api = NULL;
+sai_bridge_api_t* saiStressTest ::p_bridge_api = NULL;
+
+sai_object_id_t saiStressTest ::vr_id = 0;
+sai_object_id_t saiStressTest ::rif_id = 0;
+sai_object_id_t saiStressTest ::nh_id_list [2] = {0};
+sai_object_id_t saiStressTest ::lag_id = 0;
+sai_object_id_t saiStressTest ::vlan_oid = 0;
+sai_object_id_t saiStressTest ::fdb_vlan_member_id = 0;
+sai_object_id_t saiStressTest ::fdb_bridge_port_id = 0;
+
+unsigned int saiStressTest ::lag_port_count = 0;
+sai_object_id_t saiStressTest ::lag_port_list [SAI_TEST_MAX_PORTS] = {0};
+sai_object_id_t saiStressTest ::lag_member_list [SAI_TEST_MAX_PORTS] = {0};
+
+unsigned int saiStressTest ::vlan_port_count = 0;
+sai_object_id_t saiStressTest ::vlan_bridge_port_list [SAI_TEST_MAX_PORTS] = {0};
+sai_object_id_t saiStressTest ::vlan_member_list [SAI_TEST_MAX_PORTS] = {0};
+
+const sai_stress_ops_t saiStressTest ::route_ops = {
+    "route", SAI_OBJECT_TYPE_ROUTE_ENTRY,
+    saiStressTest ::sai_stress_route_key_count,
+    saiStressTest ::sai_stress_route_create,
+    saiStressTest ::sai_stress_route_set,
+    saiStressTest ::sai_stress_route_get,
+    saiStressTest ::sai_stress_route_remove,
+};
+
+const sai_stress_ops_t saiStressTest ::fdb_ops = {
+    "fdb", SAI_OBJECT_TYPE_FDB_ENTRY,
+    saiStressTest ::sai_stress_fdb_key_count,
+    saiStressTest ::sai_stress_fdb_create,
+    saiStressTest ::sai_stress_fdb_set,
+    saiStressTest ::sai_stress_fdb_get,
+    saiStressTest ::sai_stress_fdb_remove,
+};
+
+const sai_stress_ops_t saiStressTest ::lag_member_ops = {
+    "lag_member", SAI_OBJECT_TYPE_LAG_MEMBER,
+    saiStressTest ::sai_stress_lag_member_key_count,
+    saiStressTest ::sai_stress_lag_member_create,
+    saiStressTest ::sai_stress_lag_member_set,
+    saiStressTest ::sai_stress_lag_member_get,
+    saiStressTest ::sai_stress_lag_member_remove,
+};
+
+const sai_stress_ops_t saiStressTest ::vlan_member_ops = {
+    "vlan_member", SAI_OBJECT_TYPE_VLAN_MEMBER,
+    saiStressTest ::sai_stress_vlan_member_key_count,
+    saiStressTest ::sai_stress_vlan_member_create,
+    saiStressTest ::sai_stress_vlan_member_set,
+    saiStressTest ::sai_stress_vlan_member_get,
+    saiStressTest ::sai_stress_vlan_member_remove,
+};
+
+static uint64_t sai_stress_now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+static sai_object_id_t sai_stress_bridge_port_get (sai_bridge_api_t *p_api,
+                                                   sai_object_id_t bridge_port,
+                                                   sai_object_id_t port_id)
+{
+    sai_attribute_t attr_list [2];
+
+    memset (attr_list, 0, sizeof (attr_list));
+
+    attr_list [0].id = SAI_BRIDGE_PORT_ATTR_TYPE;
+    attr_list [1].id = SAI_BRIDGE_PORT_ATTR_PORT_ID;
+
+    if (p_api->get_bridge_port_attribute (bridge_port, 1, &attr_list [0])
+        != SAI_STATUS_SUCCESS ||
+        attr_list [0].value.s32 != SAI_BRIDGE_PORT_TYPE_PORT) {
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    if (p_api->get_bridge_port_attribute (bridge_port, 1, &attr_list [1])
+        != SAI_STATUS_SUCCESS || attr_list [1].value.oid != port_id) {
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    return bridge_port;
+}
+
+/* Neighbors of the route next-hops, 30.0.0.1 + index */
+static void sai_stress_nh_neighbor_entry_get (sai_object_id_t switch_id,
+                                              sai_object_id_t rif_id,
+                                              unsigned int index,
+                                              sai_neighbor_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_neighbor_entry_t));
+
+    p_entry->switch_id = switch_id;
+    p_entry->rif_id    = rif_id;
+    p_entry->ip_address.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    p_entry->ip_address.addr.ip4    = htonl (0x1e000001 + index);
+}
+
+/*
+ * Shared parents are set up once: port 0 is used by the router interface,
+ * first half of the remaining ports by VLAN members and FDB entries, and
+ * second half by members of single LAG.
+ */
+void saiStressTest ::SetUpTestCase (void)
+{
+    sai_status_t      sai_rc = SAI_STATUS_SUCCESS;
+    sai_attribute_t   attr_list [3];
+    sai_neighbor_entry_t nbr_entry;
+    unsigned int      nh_idx = 0;
+    sai_object_id_t   bridge_id = SAI_NULL_OBJECT_ID;
+    sai_object_id_t   bridge_port_list [2 * SAI_TEST_MAX_PORTS];
+    uint32_t          bridge_port_count = 0;
+    unsigned int      port_total = 0;
+    unsigned int      port_idx = 0;
+    unsigned int      bp_idx = 0;
+    sai_object_id_t   bridge_port = SAI_NULL_OBJECT_ID;
+
+    /* Base SetUpTestCase for SAI initialization */
+    saiL3Test ::SetUpTestCase ();
+
+    p_route_api = route_api_tbl_get ();
+    p_nbr_api   = neighbor_api_tbl_get ();
+    p_nh_api    = nh_api_tbl_get ();
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_api_query
+               (SAI_API_FDB, (static_cast<void**>
+                              (static_cast<void*> (&p_fdb_api)))));
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_api_query
+               (SAI_API_LAG, (static_cast<void**>
+                              (static_cast<void*> (&p_lag_api)))));
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_api_query
+               (SAI_API_VLAN, (static_cast<void**>
+                               (static_cast<void*> (&p_vlan_api)))));
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_api_query
+               (SAI_API_BRIDGE, (static_cast<void**>
+                                 (static_cast<void*> (&p_bridge_api)))));
+
+    ASSERT_TRUE (p_route_api != NULL);
+    ASSERT_TRUE (p_nbr_api != NULL);
+    ASSERT_TRUE (p_nh_api != NULL);
+    ASSERT_TRUE (p_fdb_api != NULL);
+    ASSERT_TRUE (p_lag_api != NULL);
+    ASSERT_TRUE (p_vlan_api != NULL);
+    ASSERT_TRUE (p_bridge_api != NULL);
+
+    /* Route parents */
+    sai_rc = sai_test_router_mac_init (router_mac);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = sai_test_vrf_create (&vr_id, 0);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = sai_test_rif_create (&rif_id, default_rif_attr_count,
+                                  SAI_ROUTER_INTERFACE_ATTR_VIRTUAL_ROUTER_ID,
+                                  vr_id,
+                                  SAI_ROUTER_INTERFACE_ATTR_TYPE,
+                                  SAI_ROUTER_INTERFACE_TYPE_PORT,
+                                  SAI_ROUTER_INTERFACE_ATTR_PORT_ID,
+                                  sai_l3_port_id_get (0));
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    /* Next-hops 30.0.0.1 and 30.0.0.2 the routes are moved between */
+    for (nh_idx = 0; nh_idx < 2; nh_idx++) {
+        sai_stress_nh_neighbor_entry_get (switch_id, rif_id, nh_idx,
+                                          &nbr_entry);
+
+        memset (attr_list, 0, sizeof (attr_list));
+
+        attr_list [0].id = SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS;
+        attr_list [0].value.mac [1] = 0x33;
+        attr_list [0].value.mac [5] = (uint8_t) (nh_idx + 1);
+
+        sai_rc = p_nbr_api->create_neighbor_entry (&nbr_entry,
+                                                   default_neighbor_attr_count,
+                                                   attr_list);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+        memset (attr_list, 0, sizeof (attr_list));
+
+        attr_list [0].id           = SAI_NEXT_HOP_ATTR_TYPE;
+        attr_list [0].value.s32    = SAI_NEXT_HOP_TYPE_IP;
+
+        attr_list [1].id           = SAI_NEXT_HOP_ATTR_IP;
+        attr_list [1].value.ipaddr = nbr_entry.ip_address;
+
+        attr_list [2].id           = SAI_NEXT_HOP_ATTR_ROUTER_INTERFACE_ID;
+        attr_list [2].value.oid    = rif_id;
+
+        sai_rc = p_nh_api->create_next_hop (&nh_id_list [nh_idx], switch_id,
+                                            default_nh_attr_count, attr_list);
+
+        ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+    }
+
+    /* Ports of the default 1Q bridge for VLAN members and FDB entries */
+    while (port_total < SAI_TEST_MAX_PORTS &&
+           sai_l3_port_id_get (port_total) != 0) {
+        port_total++;
+    }
+
+    ASSERT_TRUE (port_total >= 4);
+
+    memset (attr_list, 0, sizeof (attr_list));
+
+    attr_list [0].id = SAI_SWITCH_ATTR_DEFAULT_1Q_BRIDGE_ID;
+
+    sai_rc = switch_api_tbl_get ()->get_switch_attribute (switch_id, 1,
+                                                          attr_list);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    bridge_id = attr_list [0].value.oid;
+
+    attr_list [0].id = SAI_BRIDGE_ATTR_PORT_LIST;
+    attr_list [0].value.objlist.count = 2 * SAI_TEST_MAX_PORTS;
+    attr_list [0].value.objlist.list = bridge_port_list;
+
+    sai_rc = p_bridge_api->get_bridge_attribute (bridge_id, 1, attr_list);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    bridge_port_count = attr_list [0].value.objlist.count;
+
+    for (port_idx = 1; port_idx < (1 + port_total) / 2; port_idx++) {
+        for (bp_idx = 0; bp_idx < bridge_port_count; bp_idx++) {
+            bridge_port = sai_stress_bridge_port_get (p_bridge_api,
+                                                      bridge_port_list [bp_idx],
+                                                      sai_l3_port_id_get (port_idx));
+
+            if (bridge_port != SAI_NULL_OBJECT_ID) {
+                vlan_bridge_port_list [vlan_port_count++] = bridge_port;
+                break;
+            }
+        }
+    }
+
+    ASSERT_TRUE (vlan_port_count >= 2);
+
+    /* First VLAN bridge port is kept for FDB entries */
+    fdb_bridge_port_id = vlan_bridge_port_list [--vlan_port_count];
+
+    for (port_idx = (1 + port_total) / 2; port_idx < port_total; port_idx++) {
+        lag_port_list [lag_port_count++] = sai_l3_port_id_get (port_idx);
+    }
+
+    printf ("Stress port pools: %u VLAN bridge ports, %u LAG ports.\r\n",
+            vlan_port_count, lag_port_count);
+
+    /* VLAN and LAG parents */
+    attr_list [0].id = SAI_VLAN_ATTR_VLAN_ID;
+    attr_list [0].value.u16 = test_vlan_id;
+
+    sai_rc = p_vlan_api->create_vlan (&vlan_oid, switch_id, 1, attr_list);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    attr_list [0].id = SAI_VLAN_MEMBER_ATTR_VLAN_ID;
+    attr_list [0].value.oid = vlan_oid;
+    attr_list [1].id = SAI_VLAN_MEMBER_ATTR_BRIDGE_PORT_ID;
+    attr_list [1].value.oid = fdb_bridge_port_id;
+
+    sai_rc = p_vlan_api->create_vlan_member (&fdb_vlan_member_id, switch_id,
+                                             2, attr_list);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    sai_rc = p_lag_api->create_lag (&lag_id, switch_id, 0, NULL);
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+}
+
+void saiStressTest ::TearDownTestCase (void)
+{
+    sai_neighbor_entry_t nbr_entry;
+    unsigned int         nh_idx = 0;
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, p_lag_api->remove_lag (lag_id));
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS,
+               p_vlan_api->remove_vlan_member (fdb_vlan_member_id));
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, p_vlan_api->remove_vlan (vlan_oid));
+
+    for (nh_idx = 0; nh_idx < 2; nh_idx++) {
+        EXPECT_EQ (SAI_STATUS_SUCCESS,
+                   p_nh_api->remove_next_hop (nh_id_list [nh_idx]));
+
+        sai_stress_nh_neighbor_entry_get (switch_id, rif_id, nh_idx,
+                                          &nbr_entry);
+
+        EXPECT_EQ (SAI_STATUS_SUCCESS,
+                   p_nbr_api->remove_neighbor_entry (&nbr_entry));
+    }
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_test_rif_remove (rif_id));
+
+    EXPECT_EQ (SAI_STATUS_SUCCESS, sai_test_vrf_remove (vr_id));
+}
+
+/* Route operations */
+
+static void sai_stress_route_entry_get (sai_object_id_t switch_id,
+                                        sai_object_id_t vr_id,
+                                        unsigned int key,
+                                        sai_route_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_route_entry_t));
+
+    p_entry->switch_id = switch_id;
+    p_entry->vr_id     = vr_id;
+    p_entry->destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    p_entry->destination.addr.ip4    = htonl (0x0a000000 + (key << 8));
+    p_entry->destination.mask.ip4    = htonl (0xffffff00);
+}
+
+unsigned int saiStressTest ::sai_stress_route_key_count (
+                                                    unsigned int thread_count)
+{
+    return (thread_count * keys_per_thread);
+}
+
+sai_status_t saiStressTest ::sai_stress_route_create (unsigned int key)
+{
+    sai_route_entry_t route_entry;
+    sai_attribute_t   attr;
+
+    sai_stress_route_entry_get (switch_id, vr_id, key, &route_entry);
+
+    attr.id        = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+    attr.value.oid = nh_id_list [0];
+
+    return p_route_api->create_route_entry (&route_entry, 1, &attr);
+}
+
+sai_status_t saiStressTest ::sai_stress_route_set (unsigned int key,
+                                                   unsigned int gen)
+{
+    sai_route_entry_t route_entry;
+    sai_attribute_t   attr;
+
+    sai_stress_route_entry_get (switch_id, vr_id, key, &route_entry);
+
+    attr.id        = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+    attr.value.oid = nh_id_list [gen % 2];
+
+    return p_route_api->set_route_entry_attribute (&route_entry, &attr);
+}
+
+sai_status_t saiStressTest ::sai_stress_route_get (unsigned int key)
+{
+    sai_route_entry_t route_entry;
+    sai_attribute_t   attr;
+    sai_status_t      sai_rc;
+
+    sai_stress_route_entry_get (switch_id, vr_id, key, &route_entry);
+
+    attr.id = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+
+    sai_rc = p_route_api->get_route_entry_attribute (&route_entry, 1, &attr);
+
+    if (sai_rc == SAI_STATUS_SUCCESS && attr.value.oid != nh_id_list [0] &&
+        attr.value.oid != nh_id_list [1]) {
+        return SAI_STATUS_FAILURE;
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiStressTest ::sai_stress_route_remove (unsigned int key)
+{
+    sai_route_entry_t route_entry;
+
+    sai_stress_route_entry_get (switch_id, vr_id, key, &route_entry);
+
+    return p_route_api->remove_route_entry (&route_entry);
+}
+
+/* FDB operations */
+
+static void sai_stress_fdb_entry_get (sai_object_id_t switch_id,
+                                      sai_object_id_t bv_id,
+                                      unsigned int key,
+                                      sai_fdb_entry_t *p_entry)
+{
+    memset (p_entry, 0, sizeof (sai_fdb_entry_t));
+
+    p_entry->switch_id = switch_id;
+    p_entry->bv_id     = bv_id;
+    p_entry->mac_address [0] = 0x00;
+    p_entry->mac_address [1] = 0x55;
+    p_entry->mac_address [2] = 0x00;
+    p_entry->mac_address [3] = (uint8_t) (key >> 16);
+    p_entry->mac_address [4] = (uint8_t) (key >> 8);
+    p_entry->mac_address [5] = (uint8_t) key;
+}
+
+unsigned int saiStressTest ::sai_stress_fdb_key_count (
+                                                    unsigned int thread_count)
+{
+    return (thread_count * keys_per_thread);
+}
+
+sai_status_t saiStressTest ::sai_stress_fdb_create (unsigned int key)
+{
+    sai_fdb_entry_t fdb_entry;
+    sai_attribute_t attr_list [3];
+
+    sai_stress_fdb_entry_get (switch_id, vlan_oid, key, &fdb_entry);
+
+    memset (attr_list, 0, sizeof (attr_list));
+
+    attr_list [0].id = SAI_FDB_ENTRY_ATTR_TYPE;
+    attr_list [0].value.s32 = SAI_FDB_ENTRY_TYPE_STATIC;
+    attr_list [1].id = SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID;
+    attr_list [1].value.oid = fdb_bridge_port_id;
+    attr_list [2].id = SAI_FDB_ENTRY_ATTR_PACKET_ACTION;
+    attr_list [2].value.s32 = SAI_PACKET_ACTION_FORWARD;
+
+    return p_fdb_api->create_fdb_entry (&fdb_entry, 3, attr_list);
+}
+
+sai_status_t saiStressTest ::sai_stress_fdb_set (unsigned int key,
+                                                 unsigned int gen)
+{
+    sai_fdb_entry_t fdb_entry;
+    sai_attribute_t attr;
+
+    sai_stress_fdb_entry_get (switch_id, vlan_oid, key, &fdb_entry);
+
+    attr.id = SAI_FDB_ENTRY_ATTR_PACKET_ACTION;
+    attr.value.s32 = (gen % 2) ? SAI_PACKET_ACTION_DROP :
+                                 SAI_PACKET_ACTION_FORWARD;
+
+    return p_fdb_api->set_fdb_entry_attribute (&fdb_entry, &attr);
+}
+
+sai_status_t saiStressTest ::sai_stress_fdb_get (unsigned int key)
+{
+    sai_fdb_entry_t fdb_entry;
+    sai_attribute_t attr;
+    sai_status_t    sai_rc;
+
+    sai_stress_fdb_entry_get (switch_id, vlan_oid, key, &fdb_entry);
+
+    attr.id = SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID;
+
+    sai_rc = p_fdb_api->get_fdb_entry_attribute (&fdb_entry, 1, &attr);
+
+    if (sai_rc == SAI_STATUS_SUCCESS && attr.value.oid != fdb_bridge_port_id) {
+        return SAI_STATUS_FAILURE;
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiStressTest ::sai_stress_fdb_remove (unsigned int key)
+{
+    sai_fdb_entry_t fdb_entry;
+
+    sai_stress_fdb_entry_get (switch_id, vlan_oid, key, &fdb_entry);
+
+    return p_fdb_api->remove_fdb_entry (&fdb_entry);
+}
+
+/* LAG member operations */
+
+unsigned int saiStressTest ::sai_stress_lag_member_key_count (
+                                                    unsigned int)
+{
+    return lag_port_count;
+}
+
+sai_status_t saiStressTest ::sai_stress_lag_member_create (unsigned int key)
+{
+    sai_attribute_t attr_list [2];
+
+    memset (attr_list, 0, sizeof (attr_list));
+
+    attr_list [0].id = SAI_LAG_MEMBER_ATTR_LAG_ID;
+    attr_list [0].value.oid = lag_id;
+    attr_list [1].id = SAI_LAG_MEMBER_ATTR_PORT_ID;
+    attr_list [1].value.oid = lag_port_list [key];
+
+    return p_lag_api->create_lag_member (&lag_member_list [key], switch_id,
+                                         2, attr_list);
+}
+
+sai_status_t saiStressTest ::sai_stress_lag_member_set (unsigned int key,
+                                                        unsigned int gen)
+{
+    sai_attribute_t attr;
+
+    attr.id = SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE;
+    attr.value.booldata = (gen % 2) ? true : false;
+
+    return p_lag_api->set_lag_member_attribute (lag_member_list [key], &attr);
+}
+
+sai_status_t saiStressTest ::sai_stress_lag_member_get (unsigned int key)
+{
+    sai_attribute_t attr;
+    sai_status_t    sai_rc;
+
+    attr.id = SAI_LAG_MEMBER_ATTR_LAG_ID;
+
+    sai_rc = p_lag_api->get_lag_member_attribute (lag_member_list [key], 1,
+                                                  &attr);
+
+    if (sai_rc == SAI_STATUS_SUCCESS && attr.value.oid != lag_id) {
+        return SAI_STATUS_FAILURE;
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiStressTest ::sai_stress_lag_member_remove (unsigned int key)
+{
+    sai_status_t sai_rc;
+
+    sai_rc = p_lag_api->remove_lag_member (lag_member_list [key]);
+
+    if (sai_rc == SAI_STATUS_SUCCESS) {
+        lag_member_list [key] = SAI_NULL_OBJECT_ID;
+    }
+
+    return sai_rc;
+}
+
+/* VLAN member operations */
+
+unsigned int saiStressTest ::sai_stress_vlan_member_key_count (
+                                                    unsigned int)
+{
+    return vlan_port_count;
+}
+
+sai_status_t saiStressTest ::sai_stress_vlan_member_create (unsigned int key)
+{
+    sai_attribute_t attr_list [3];
+
+    memset (attr_list, 0, sizeof (attr_list));
+
+    attr_list [0].id = SAI_VLAN_MEMBER_ATTR_VLAN_ID;
+    attr_list [0].value.oid = vlan_oid;
+    attr_list [1].id = SAI_VLAN_MEMBER_ATTR_BRIDGE_PORT_ID;
+    attr_list [1].value.oid = vlan_bridge_port_list [key];
+    attr_list [2].id = SAI_VLAN_MEMBER_ATTR_VLAN_TAGGING_MODE;
+    attr_list [2].value.s32 = SAI_VLAN_TAGGING_MODE_TAGGED;
+
+    return p_vlan_api->create_vlan_member (&vlan_member_list [key], switch_id,
+                                           3, attr_list);
+}
+
+sai_status_t saiStressTest ::sai_stress_vlan_member_set (unsigned int key,
+                                                         unsigned int gen)
+{
+    sai_attribute_t attr;
+
+    attr.id = SAI_VLAN_MEMBER_ATTR_VLAN_TAGGING_MODE;
+    attr.value.s32 = (gen % 2) ? SAI_VLAN_TAGGING_MODE_UNTAGGED :
+                                 SAI_VLAN_TAGGING_MODE_TAGGED;
+
+    return p_vlan_api->set_vlan_member_attribute (vlan_member_list [key],
+                                                  &attr);
+}
+
+sai_status_t saiStressTest ::sai_stress_vlan_member_get (unsigned int key)
+{
+    sai_attribute_t attr;
+    sai_status_t    sai_rc;
+
+    attr.id = SAI_VLAN_MEMBER_ATTR_VLAN_ID;
+
+    sai_rc = p_vlan_api->get_vlan_member_attribute (vlan_member_list [key], 1,
+                                                    &attr);
+
+    if (sai_rc == SAI_STATUS_SUCCESS && attr.value.oid != vlan_oid) {
+        return SAI_STATUS_FAILURE;
+    }
+
+    return sai_rc;
+}
+
+sai_status_t saiStressTest ::sai_stress_vlan_member_remove (unsigned int key)
+{
+    sai_status_t sai_rc;
+
+    sai_rc = p_vlan_api->remove_vlan_member (vlan_member_list [key]);
+
+    if (sai_rc == SAI_STATUS_SUCCESS) {
+        vlan_member_list [key] = SAI_NULL_OBJECT_ID;
+    }
+
+    return sai_rc;
+}
+
+/* Stress thread */
+
+static void sai_stress_op_result (sai_stress_thread_t *p_thread,
+                                  unsigned int key, sai_status_t sai_rc)
+{
+    p_thread->op_count++;
+
+    if (sai_rc == SAI_STATUS_SUCCESS) {
+        return;
+    }
+
+    if (p_thread->fail_count == 0) {
+        p_thread->first_fail_status = sai_rc;
+        p_thread->first_fail_key = key;
+    }
+
+    p_thread->fail_count++;
+}
+
+static void *sai_stress_thread_main (void *arg)
+{
+    sai_stress_thread_t    *p_thread = (sai_stress_thread_t *) arg;
+    const sai_stress_ops_t *p_ops = p_thread->p_ops;
+    unsigned int            key = 0;
+    unsigned int            iter = 0;
+
+    for (key = p_thread->thread_idx; key < p_thread->key_count;
+         key += p_thread->thread_count) {
+        switch (p_thread->phase) {
+            case SAI_STRESS_PHASE_CREATE:
+                sai_stress_op_result (p_thread, key, p_ops->create (key));
+                break;
+
+            case SAI_STRESS_PHASE_SET_GET:
+                sai_stress_op_result (p_thread, key, p_ops->set (key, 1));
+                sai_stress_op_result (p_thread, key, p_ops->get (key));
+                sai_stress_op_result (p_thread, key, p_ops->set (key, 0));
+                sai_stress_op_result (p_thread, key, p_ops->get (key));
+                break;
+
+            case SAI_STRESS_PHASE_REMOVE:
+                sai_stress_op_result (p_thread, key, p_ops->remove (key));
+                break;
+
+            case SAI_STRESS_PHASE_CHURN:
+                for (iter = 0; iter < saiStressTest ::churn_iterations;
+                     iter++) {
+                    sai_stress_op_result (p_thread, key, p_ops->create (key));
+                    sai_stress_op_result (p_thread, key, p_ops->set (key, iter));
+                    sai_stress_op_result (p_thread, key, p_ops->get (key));
+                    sai_stress_op_result (p_thread, key, p_ops->remove (key));
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+static void sai_stress_object_count_verify (const sai_stress_ops_t *p_ops,
+                                            uint32_t expected_count)
+{
+    uint32_t     count = 0;
+    sai_status_t sai_rc;
+
+    sai_rc = sai_get_object_count (saiStressTest ::switch_id,
+                                   p_ops->object_type, &count);
+
+    if (sai_rc == SAI_STATUS_NOT_IMPLEMENTED ||
+        sai_rc == SAI_STATUS_NOT_SUPPORTED) {
+        return;
+    }
+
+    ASSERT_EQ (SAI_STATUS_SUCCESS, sai_rc);
+
+    EXPECT_EQ (expected_count, count) << p_ops->name << " object count";
+}
+
+/*
+ * p_ops_list   - [in] object kinds to run concurrently.
+ * ops_count    - [in] number of object kinds.
+ * thread_count - [in] number of threads per object kind.
+ * p_op_count   - [out] number of SAI API calls made.
+ * p_elapsed_ns - [out] time spent in all phases.
+ *
+ * Runs create, set/get, remove and churn phases. Object counts are checked
+ * after each phase against the counts taken before the run.
+ */
+void saiStressTest ::sai_stress_run (const sai_stress_ops_t **p_ops_list,
+                                     unsigned int ops_count,
+                                     unsigned int thread_count,
+                                     unsigned long *p_op_count,
+                                     uint64_t *p_elapsed_ns)
+{
+    const sai_stress_phase_t phases [] = {
+        SAI_STRESS_PHASE_CREATE,
+        SAI_STRESS_PHASE_SET_GET,
+        SAI_STRESS_PHASE_REMOVE,
+        SAI_STRESS_PHASE_CHURN,
+    };
+    const unsigned int   phase_count = sizeof (phases) / sizeof (phases [0]);
+    const unsigned int   total_threads = ops_count * thread_count;
+    sai_stress_thread_t  threads [4 * max_threads];
+    uint32_t             base_count [4];
+    unsigned int         phase = 0;
+    unsigned int         idx = 0;
+    uint64_t             start = 0;
+    int                  rc = 0;
+
+    ASSERT_LE (ops_count, 4u);
+    ASSERT_LE (thread_count, max_threads);
+
+    *p_op_count = 0;
+    *p_elapsed_ns = 0;
+
+    for (idx = 0; idx < ops_count; idx++) {
+        base_count [idx] = 0;
+
+        sai_get_object_count (switch_id, p_ops_list [idx]->object_type,
+                              &base_count [idx]);
+    }
+
+    for (phase = 0; phase < phase_count; phase++) {
+        memset (threads, 0, sizeof (threads));
+
+        start = sai_stress_now_ns ();
+
+        for (idx = 0; idx < total_threads; idx++) {
+            threads [idx].p_ops        = p_ops_list [idx % ops_count];
+            threads [idx].phase        = phases [phase];
+            threads [idx].thread_idx   = idx / ops_count;
+            threads [idx].thread_count = thread_count;
+            threads [idx].key_count    =
+                threads [idx].p_ops->key_count_get (thread_count);
+
+            rc = pthread_create (&threads [idx].thread, NULL,
+                                 sai_stress_thread_main, &threads [idx]);
+
+            ASSERT_EQ (0, rc);
+        }
+
+        for (idx = 0; idx < total_threads; idx++) {
+            pthread_join (threads [idx].thread, NULL);
+        }
+
+        *p_elapsed_ns += sai_stress_now_ns () - start;
+
+        for (idx = 0; idx < total_threads; idx++) {
+            *p_op_count += threads [idx].op_count;
+
+            EXPECT_EQ (0u, threads [idx].fail_count)
+                << threads [idx].p_ops->name << " thread " << idx
+                << " phase " << phase << ": first failure at key "
+                << threads [idx].first_fail_key << " with status "
+                << threads [idx].first_fail_status;
+        }
+
+        for (idx = 0; idx < ops_count; idx++) {
+            sai_stress_object_count_verify (p_ops_list [idx],
+                    base_count [idx] +
+                    ((phases [phase] == SAI_STRESS_PHASE_CREATE ||
+                      phases [phase] == SAI_STRESS_PHASE_SET_GET) ?
+                     p_ops_list [idx]->key_count_get (thread_count) : 0));
+        }
+
+        /* Don't go on with objects left behind by failed phase */
+        ASSERT_FALSE (HasFailure ());
+    }
+}
+
+/*
+ * Runs single object kind with 1 up to max_threads threads and reports
+ * throughput and scaling relative to single thread.
+ */
+void saiStressTest ::sai_stress_scale (const sai_stress_ops_t *p_ops)
+{
+    unsigned int    thread_count = 0;
+    unsigned long   op_count = 0;
+    uint64_t        elapsed_ns = 0;
+    uint64_t        ops_per_sec = 0;
+    uint64_t        base_ops_per_sec = 0;
+    char            value [32];
+    std::string     name;
+
+    for (thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        ASSERT_NO_FATAL_FAILURE (sai_stress_run (&p_ops, 1, thread_count,
+                                                 &op_count, &elapsed_ns));
+
+        ops_per_sec = elapsed_ns ? (op_count * 1000000000ULL) / elapsed_ns : 0;
+
+        if (thread_count == 1) {
+            base_ops_per_sec = ops_per_sec;
+        }
+
+        printf ("%-12s %2u threads %8lu ops %10" PRIu64 " ops/s  "
+                "scaling %5.2fx\r\n", p_ops->name, thread_count, op_count,
+                ops_per_sec, base_ops_per_sec ?
+                ((double) ops_per_sec / base_ops_per_sec) : 0.0);
+
+        snprintf (value, sizeof (value), "%u", thread_count);
+        name = std::string (p_ops->name) + "_threads_" + value;
+
+        snprintf (value, sizeof (value), "%" PRIu64, ops_per_sec);
+        RecordProperty (name + "_ops_per_sec", value);
+    }
+}
+
+/*
+ * Concurrent create, set, get and remove of routes sharing virtual router
+ * and next-hops.
+ */
+TEST_F (saiStressTest, route_threads_scaling)
+{
+    sai_stress_scale (&route_ops);
+}
+
+/*
+ * Concurrent create, set, get and remove of FDB entries sharing VLAN and
+ * bridge port.
+ */
+TEST_F (saiStressTest, fdb_threads_scaling)
+{
+    sai_stress_scale (&fdb_ops);
+}
+
+/*
+ * Concurrent create, set, get and remove of members of single LAG.
+ */
+TEST_F (saiStressTest, lag_member_threads_scaling)
+{
+    sai_stress_scale (&lag_member_ops);
+}
+
+/*
+ * Concurrent create, set, get and remove of members of single VLAN.
+ */
+TEST_F (saiStressTest, vlan_member_threads_scaling)
+{
+    sai_stress_scale (&vlan_member_ops);
+}
+
+/*
+ * All object kinds at once, the way separate routing, FDB and port
+ * management daemons call SAI, with max_threads threads per kind.
+ */
+TEST_F (saiStressTest, all_objects_mixed)
+{
+    const sai_stress_ops_t *ops_list [] = {
+        &route_ops, &fdb_ops, &lag_member_ops, &vlan_member_ops,
+    };
+    unsigned long   op_count = 0;
+    uint64_t        elapsed_ns = 0;
+
+    sai_stress_run (ops_list, sizeof (ops_list) / sizeof (ops_list [0]),
+                    max_threads, &op_count, &elapsed_ns);
+
+    printf ("%-12s %2u threads %8lu ops %10" PRIu64 " ops/s\r\n", "mixed",
+            (unsigned int) (4 * max_threads), op_count,
+            (uint64_t) (elapsed_ns ? (op_count * 1000000000ULL) / elapsed_ns :
+                        0));
+}
+
+int main (int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
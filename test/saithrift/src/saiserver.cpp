@@ -21,7 +21,6 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "switch_sai_rpc.h"
-#include "switch_sai_rpc_server.h"
 
 #define UNREFERENCED_PARAMETER(P)   (P)
 
@@ -30,6 +29,9 @@ extern "C" {
 #include "saistatus.h"
 }
 
+#include "switch_sai_rpc_server.h"
+#include "switch_sai_fdb_shadow.h"
+
 
 #define SWITCH_SAI_THRIFT_RPC_SERVER_PORT 9092
 
@@ -38,7 +40,6 @@ sai_switch_api_t* sai_switch_api;
 std::map<std::string, std::string> gProfileMap;
 std::map<std::set<int>, std::string> gPortMap;
 
-extern std::vector<std::pair<sai_fdb_entry_t, sai_object_id_t>> gFdbMap;
 
 sai_object_id_t gSwitchId; ///< SAI switch global object ID.
 
@@ -50,83 +51,8 @@ void on_switch_state_change(_In_ sai_object_id_t switch_id,
 void on_fdb_event(_In_ uint32_t count,
                   _In_ sai_fdb_event_notification_data_t *data)
 {
-    sai_fdb_event_t event_type;
-    sai_fdb_entry_t fdb_entry;
-    uint32_t attr_count;
-    sai_attribute_t *attr;
-    sai_object_id_t bv_id;
-    sai_object_id_t bport_id;
-    
-    attr = data->attr;
-    event_type = data->event_type;
-    fdb_entry = data->fdb_entry;
-    bv_id = fdb_entry.bv_id;
-    attr_count = data ->attr_count;
-    
-    for (uint32_t i = 0; i < attr_count; i++)
-    {
-        if (attr[i].id == SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID)
-            bport_id = attr[i].value.oid;
-    }
-           
-    sai_fdb_entry_t fdb_m;
-    sai_object_id_t b_id;
-      
-    switch (event_type)
-    {   
-        case SAI_FDB_EVENT_LEARNED:
-            gFdbMap.emplace_back(std::pair<sai_fdb_entry_t, sai_object_id_t>(fdb_entry,bport_id));
-            break;
-        case SAI_FDB_EVENT_FLUSHED: 
-            if (bv_id == 0 && bport_id == 0)
-                gFdbMap.clear();
-            else
-            {
-                for (auto it = gFdbMap.begin(); it != gFdbMap.end(); )
-                {
-                    fdb_m = it->first;
-                    b_id = it->second; 				
-	            
-                    if (bport_id == 0 && bv_id == fdb_m.bv_id)
-                        it = gFdbMap.erase(it);
-                    else if (bv_id == 0 && bport_id == b_id)
-                        it = gFdbMap.erase(it);
-                    else if (bv_id == fdb_m.bv_id && bport_id == b_id)
-                        it = gFdbMap.erase(it);
-                    else
-                        it++;
-                }
-            }
-            break;
-        case SAI_FDB_EVENT_MOVE:
-            for (auto it = gFdbMap.begin(); it != gFdbMap.end(); it++)
-            {
-                fdb_m = it->first;
-                b_id = it->second; 
-                int n = memcmp ( fdb_entry.mac_address, fdb_m.mac_address, 6);
-		    
-                if (n == 0 && bv_id == fdb_m.bv_id)
-                    it->second = bport_id;
-            }
-            break;  
-        case SAI_FDB_EVENT_AGED:
-            for (auto it = gFdbMap.begin(); it != gFdbMap.end(); )
-            {
-                fdb_m = it->first;
-                b_id = it->second; 
-                int n = memcmp ( fdb_entry.mac_address, fdb_m.mac_address, 6);  
-                
-                if (n == 0 && bv_id == fdb_m.bv_id)
-                    it = gFdbMap.erase(it);   
-                else
-                    it++; 	
-            }
-            break;
-        default:
-            printf("unknown event");
-            break;
-    }
-}     
+    gFdbShadow.apply(count, data);
+}
 
 void on_port_state_change(_In_ uint32_t count,
                           _In_ sai_port_oper_status_notification_t *data)
@@ -138,11 +64,12 @@ void on_shutdown_request(_In_ sai_object_id_t switch_id)//
 }
 
 void on_packet_event(_In_ sai_object_id_t switch_id,
-                     _In_ const void *buffer,
                      _In_ sai_size_t buffer_size,
+                     _In_ const void *buffer,
                      _In_ uint32_t attr_count,
                      _In_ const sai_attribute_t *attr_list)
 {
+    sai_thrift_hostif_packet_event(switch_id, buffer_size, buffer, attr_count, attr_list);
 }
 
 // Profile services
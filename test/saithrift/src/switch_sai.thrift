@@ -218,6 +218,44 @@ struct sai_thrift_result_t {
     2: sai_thrift_status_t status;
 }
 
+struct sai_thrift_hostif_packet_t {
+    1: binary data;
+    2: list<sai_thrift_attribute_t> attr_list;
+}
+
+struct sai_thrift_hostif_packet_stats_t {
+    1: i64 rx_queued;
+    2: i64 rx_dropped;
+    3: i64 rx_packets;
+    4: i64 rx_bytes;
+    5: i64 tx_packets;
+    6: i64 tx_bytes;
+    7: i64 tx_errors;
+    8: i32 rx_pending;
+    9: i32 rx_capacity;
+    10: double rx_pps;
+    11: double tx_pps;
+    12: double interval;
+}
+
+struct sai_thrift_rpc_stats_t {
+    1: string name;
+    2: i64 calls;
+    3: i64 errors;
+    4: i64 sai_calls;
+    5: i64 total_ns;
+    6: i64 sai_ns;
+    7: i64 p50_ns;
+    8: i64 p90_ns;
+    9: i64 p99_ns;
+    10: i64 p999_ns;
+    11: i64 max_ns;
+    12: i64 sai_p50_ns;
+    13: i64 sai_p99_ns;
+    14: i64 conversion_p50_ns;
+    15: i64 conversion_p99_ns;
+}
+
 service switch_sai_rpc {
     //port API
     sai_thrift_status_t sai_thrift_set_port_attribute(1: sai_thrift_object_id_t port_id, 2: sai_thrift_attribute_t thrift_attr);
@@ -233,6 +271,11 @@ service switch_sai_rpc {
     sai_thrift_status_t sai_thrift_delete_fdb_entry(1: sai_thrift_fdb_entry_t thrift_fdb_entry);
     sai_thrift_status_t sai_thrift_flush_fdb_entries(1: list <sai_thrift_attribute_t> thrift_attr_list);
     sai_thrift_attribute_list_t sai_thrift_get_fdb_entries();
+    list<sai_thrift_status_t> sai_thrift_create_fdb_entries(1: list<sai_thrift_fdb_entry_t> thrift_fdb_entries,
+                                                            2: list<list<sai_thrift_attribute_t>> thrift_attr_lists,
+                                                            3: i32 mode);
+    list<sai_thrift_status_t> sai_thrift_remove_fdb_entries(1: list<sai_thrift_fdb_entry_t> thrift_fdb_entries,
+                                                            2: i32 mode);
 
     //vlan API
     sai_thrift_object_id_t sai_thrift_create_vlan(1: list<sai_thrift_attribute_t> thrift_attr_list);
@@ -256,6 +299,11 @@ service switch_sai_rpc {
     //route API
     sai_thrift_status_t sai_thrift_create_route(1: sai_thrift_route_entry_t thrift_route_entry, 2: list<sai_thrift_attribute_t> thrift_attr_list);
     sai_thrift_status_t sai_thrift_remove_route(1: sai_thrift_route_entry_t thrift_route_entry);
+    list<sai_thrift_status_t> sai_thrift_create_routes(1: list<sai_thrift_route_entry_t> thrift_route_entries,
+                                                       2: list<list<sai_thrift_attribute_t>> thrift_attr_lists,
+                                                       3: i32 mode);
+    list<sai_thrift_status_t> sai_thrift_remove_routes(1: list<sai_thrift_route_entry_t> thrift_route_entries,
+                                                       2: i32 mode);
 
     //router interface API
     sai_thrift_object_id_t sai_thrift_create_router_interface(1: list<sai_thrift_attribute_t> thrift_attr_list);
@@ -291,6 +339,11 @@ service switch_sai_rpc {
     sai_thrift_status_t sai_thrift_create_neighbor_entry(1: sai_thrift_neighbor_entry_t thrift_neighbor_entry, 2: list<sai_thrift_attribute_t> thrift_attr_list);
     sai_thrift_status_t sai_thrift_remove_neighbor_entry(1: sai_thrift_neighbor_entry_t thrift_neighbor_entry);
     sai_thrift_status_t sai_thrift_set_neighbor_entry_attribute(1: sai_thrift_neighbor_entry_t thrift_neighbor_entry, 2: list<sai_thrift_attribute_t> thrift_attr);
+    list<sai_thrift_status_t> sai_thrift_create_neighbor_entries(1: list<sai_thrift_neighbor_entry_t> thrift_neighbor_entries,
+                                                                 2: list<list<sai_thrift_attribute_t>> thrift_attr_lists,
+                                                                 3: i32 mode);
+    list<sai_thrift_status_t> sai_thrift_remove_neighbor_entries(1: list<sai_thrift_neighbor_entry_t> thrift_neighbor_entries,
+                                                                 2: i32 mode);
 
     //switch API
     sai_thrift_attribute_list_t sai_thrift_get_switch_attribute();
@@ -425,4 +478,15 @@ service switch_sai_rpc {
     // VOQ API
     sai_thrift_object_id_t sai_thrift_get_sys_port_obj_id_by_port_id(1: i32 sys_port_id);
     sai_thrift_attribute_list_t sai_thrift_get_system_port_attribute(1: sai_thrift_object_id_t sys_port_object_id);
+
+    // Hostif packet API
+    list<sai_thrift_status_t> sai_thrift_send_hostif_packets(1: sai_thrift_object_id_t thrift_hif_id,
+                                                             2: list<sai_thrift_hostif_packet_t> thrift_packets);
+    list<sai_thrift_hostif_packet_t> sai_thrift_recv_hostif_packets(1: i32 max_packets);
+    sai_thrift_hostif_packet_stats_t sai_thrift_get_hostif_packet_stats();
+
+    // RPC statistics API
+    list<sai_thrift_rpc_stats_t> sai_thrift_get_rpc_stats(1: bool clear);
+    string sai_thrift_dump_rpc_stats();
+    void sai_thrift_set_rpc_stats_config(1: bool trace, 2: i32 dump_interval);
 }
@@ -0,0 +1,298 @@
+#ifndef __SWITCH_SAI_FDB_SHADOW_H_
+#define __SWITCH_SAI_FDB_SHADOW_H_
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include "sai.h"
+}
+
+// Shadow copy of the FDB learned through FDB event notifications.
+//
+// Entries are hashed by (MAC, bv_id) and additionally indexed by bridge port
+// and by bv_id, so flush by port/vlan only touches the matching entries.
+// Notification batches are applied under a single lock. Readers get an
+// immutable snapshot which is rebuilt lazily after the table changes, so
+// RPC threads can iterate without holding the lock.
+class switch_sai_fdb_shadow
+{
+public:
+    struct entry_t
+    {
+        sai_fdb_entry_t fdb_entry;
+        sai_object_id_t bport_id;
+    };
+
+    typedef std::shared_ptr<const std::vector<entry_t>> snapshot_t;
+
+    switch_sai_fdb_shadow() : m_dirty(true) {}
+
+    // Apply whole notification batch
+    void apply(uint32_t count, const sai_fdb_event_notification_data_t *data)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            apply_event(data[i]);
+        }
+    }
+
+    snapshot_t snapshot()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_dirty)
+        {
+            auto entries = std::make_shared<std::vector<entry_t>>();
+
+            entries->reserve(m_entries.size());
+
+            for (const auto &kvp : m_entries)
+            {
+                entries->push_back(kvp.second);
+            }
+
+            m_snapshot = entries;
+            m_dirty = false;
+        }
+
+        return m_snapshot;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return m_entries.size();
+    }
+
+private:
+    struct key_t
+    {
+        sai_mac_t mac;
+        sai_object_id_t bv_id;
+
+        bool operator==(const key_t &other) const
+        {
+            return bv_id == other.bv_id && std::memcmp(mac, other.mac, sizeof(sai_mac_t)) == 0;
+        }
+    };
+
+    struct key_hash_t
+    {
+        size_t operator()(const key_t &key) const
+        {
+            uint64_t mac = 0;
+
+            std::memcpy(&mac, key.mac, sizeof(sai_mac_t));
+
+            return std::hash<uint64_t>()(mac ^ (key.bv_id * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    typedef std::unordered_set<key_t, key_hash_t> key_set_t;
+
+    static key_t make_key(const sai_fdb_entry_t &fdb_entry)
+    {
+        key_t key;
+
+        std::memcpy(key.mac, fdb_entry.mac_address, sizeof(sai_mac_t));
+        key.bv_id = fdb_entry.bv_id;
+
+        return key;
+    }
+
+    void apply_event(const sai_fdb_event_notification_data_t &data)
+    {
+        sai_object_id_t bport_id = SAI_NULL_OBJECT_ID;
+
+        for (uint32_t i = 0; i < data.attr_count; i++)
+        {
+            if (data.attr[i].id == SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID)
+            {
+                bport_id = data.attr[i].value.oid;
+            }
+        }
+
+        const auto key = make_key(data.fdb_entry);
+
+        switch (data.event_type)
+        {
+            case SAI_FDB_EVENT_LEARNED:
+            case SAI_FDB_EVENT_MOVE:
+                insert(key, data.fdb_entry, bport_id);
+                break;
+            case SAI_FDB_EVENT_AGED:
+                erase(key);
+                break;
+            case SAI_FDB_EVENT_FLUSHED:
+                flush(data.fdb_entry.bv_id, bport_id);
+                break;
+            default:
+                printf("unknown event");
+                break;
+        }
+    }
+
+    void insert(const key_t &key, const sai_fdb_entry_t &fdb_entry, sai_object_id_t bport_id)
+    {
+        auto it = m_entries.find(key);
+
+        if (it != m_entries.end())
+        {
+            if (it->second.bport_id == bport_id)
+            {
+                return;
+            }
+
+            unindex_port(key, it->second.bport_id);
+            it->second.bport_id = bport_id;
+        }
+        else
+        {
+            m_entries[key] = entry_t{fdb_entry, bport_id};
+            m_by_bv[key.bv_id].insert(key);
+        }
+
+        m_by_port[bport_id].insert(key);
+        m_dirty = true;
+    }
+
+    void erase(const key_t &key)
+    {
+        auto it = m_entries.find(key);
+
+        if (it == m_entries.end())
+        {
+            return;
+        }
+
+        unindex_port(key, it->second.bport_id);
+        unindex_bv(key);
+
+        m_entries.erase(it);
+        m_dirty = true;
+    }
+
+    void flush(sai_object_id_t bv_id, sai_object_id_t bport_id)
+    {
+        if (bv_id == SAI_NULL_OBJECT_ID && bport_id == SAI_NULL_OBJECT_ID)
+        {
+            m_entries.clear();
+            m_by_port.clear();
+            m_by_bv.clear();
+            m_dirty = true;
+            return;
+        }
+
+        // walk the smaller of the matching index buckets
+
+        const key_set_t *keys = nullptr;
+
+        if (bv_id != SAI_NULL_OBJECT_ID)
+        {
+            auto it = m_by_bv.find(bv_id);
+
+            if (it == m_by_bv.end())
+            {
+                return;
+            }
+
+            keys = &it->second;
+        }
+
+        if (bport_id != SAI_NULL_OBJECT_ID)
+        {
+            auto it = m_by_port.find(bport_id);
+
+            if (it == m_by_port.end())
+            {
+                return;
+            }
+
+            if (keys == nullptr || it->second.size() < keys->size())
+            {
+                keys = &it->second;
+            }
+        }
+
+        std::vector<key_t> victims;
+
+        for (const auto &key : *keys)
+        {
+            if (bv_id != SAI_NULL_OBJECT_ID && key.bv_id != bv_id)
+            {
+                continue;
+            }
+
+            if (bport_id != SAI_NULL_OBJECT_ID && m_entries.find(key)->second.bport_id != bport_id)
+            {
+                continue;
+            }
+
+            victims.push_back(key);
+        }
+
+        for (const auto &key : victims)
+        {
+            erase(key);
+        }
+    }
+
+    void unindex_port(const key_t &key, sai_object_id_t bport_id)
+    {
+        auto it = m_by_port.find(bport_id);
+
+        if (it == m_by_port.end())
+        {
+            return;
+        }
+
+        it->second.erase(key);
+
+        if (it->second.empty())
+        {
+            m_by_port.erase(it);
+        }
+    }
+
+    void unindex_bv(const key_t &key)
+    {
+        auto it = m_by_bv.find(key.bv_id);
+
+        if (it == m_by_bv.end())
+        {
+            return;
+        }
+
+        it->second.erase(key);
+
+        if (it->second.empty())
+        {
+            m_by_bv.erase(it);
+        }
+    }
+
+    std::mutex m_mutex;
+
+    std::unordered_map<key_t, entry_t, key_hash_t> m_entries;
+
+    std::unordered_map<sai_object_id_t, key_set_t> m_by_port;
+
+    std::unordered_map<sai_object_id_t, key_set_t> m_by_bv;
+
+    snapshot_t m_snapshot;
+
+    bool m_dirty;
+};
+
+extern switch_sai_fdb_shadow gFdbShadow;
+
+#endif // __SWITCH_SAI_FDB_SHADOW_H_
@@ -28,6 +28,10 @@ limitations under the License.
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
 
 #include <iomanip>
 
@@ -60,10 +64,14 @@ extern "C" {
 #include <saitunnel.h>
 #include <saisystemport.h>
 
+#include "sai_rpc_stats.h"
+#include "switch_sai_fdb_shadow.h"
+
 #include "arpa/inet.h"
 
-#define SAI_THRIFT_LOG_DBG(msg, ...) sai_thrift_timestamp_print(); \
-    printf("SAI THRIFT DEBUG: %s(): " msg "\n", __FUNCTION__, ##__VA_ARGS__);
+// Debug logs are printed only when RPC trace is enabled at runtime (see sai_rpc_stats.h)
+#define SAI_THRIFT_LOG_DBG(msg, ...) do { if (sai_rpc_stats::instance().trace()) { sai_thrift_timestamp_print(); \
+    printf("SAI THRIFT DEBUG: %s(): " msg "\n", __FUNCTION__, ##__VA_ARGS__); } } while (0)
 
 #define SAI_THRIFT_LOG_ERR(msg, ...) sai_thrift_timestamp_print(); \
     printf("SAI THRIFT ERROR: %s(): " msg "\n", __FUNCTION__, ##__VA_ARGS__);
@@ -87,7 +95,158 @@ extern sai_object_id_t gSwitchId;
 
 typedef std::vector<sai_thrift_attribute_t> std_sai_thrift_attr_vctr_t;
 
-std::vector<std::pair<sai_fdb_entry_t, sai_object_id_t>>gFdbMap;
+switch_sai_fdb_shadow gFdbShadow;
+
+#ifndef SAI_THRIFT_HOSTIF_PACKET_RING_SIZE
+#define SAI_THRIFT_HOSTIF_PACKET_RING_SIZE 4096
+#endif
+
+// Convert hostif packet attribute, returns false for attributes without Thrift representation
+static bool sai_thrift_hostif_packet_attr_to_thrift(const sai_attribute_t &attr, sai_thrift_attribute_t &thrift_attr) noexcept
+{
+    thrift_attr.id = attr.id;
+
+    switch (attr.id)
+    {
+        case SAI_HOSTIF_PACKET_ATTR_HOSTIF_TRAP_ID:
+        case SAI_HOSTIF_PACKET_ATTR_INGRESS_PORT:
+        case SAI_HOSTIF_PACKET_ATTR_INGRESS_LAG:
+        case SAI_HOSTIF_PACKET_ATTR_EGRESS_PORT_OR_LAG:
+        case SAI_HOSTIF_PACKET_ATTR_BRIDGE_ID:
+            thrift_attr.value.oid = attr.value.oid;
+            return true;
+        case SAI_HOSTIF_PACKET_ATTR_HOSTIF_TX_TYPE:
+            thrift_attr.value.s32 = attr.value.s32;
+            return true;
+        case SAI_HOSTIF_PACKET_ATTR_EGRESS_QUEUE_INDEX:
+            thrift_attr.value.u8 = attr.value.u8;
+            return true;
+        case SAI_HOSTIF_PACKET_ATTR_ZERO_COPY_TX:
+            thrift_attr.value.booldata = attr.value.booldata;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bounded ring filled by packet event notification and drained in batches by RPC clients.
+// Slots are reused, when the ring is full new packets are dropped and counted.
+class sai_thrift_hostif_packet_ring {
+public:
+    sai_thrift_hostif_packet_ring(size_t size) noexcept :
+        slots(size), head(0), count(0), rx_queued(0), rx_dropped(0),
+        rx_packets(0), rx_bytes(0), tx_packets(0), tx_bytes(0), tx_errors(0),
+        last_rx_packets(0), last_tx_packets(0), last_time(std::chrono::steady_clock::now())
+    {}
+
+    void push(sai_size_t buffer_size, const void *buffer, uint32_t attr_count, const sai_attribute_t *attr_list) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (count == slots.size())
+        { rx_dropped++; return; }
+
+        auto &slot = slots[(head + count) % slots.size()];
+        const auto data = static_cast<const uint8_t*>(buffer);
+
+        slot.data.assign(data, data + buffer_size);
+        slot.attrs.assign(attr_list, attr_list + attr_count);
+
+        count++;
+        rx_queued++;
+    }
+
+    void drain(std::vector<sai_thrift_hostif_packet_t> &thrift_packets, size_t max_packets) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto n = std::min(max_packets, count);
+        thrift_packets.reserve(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            auto &slot = slots[head];
+            sai_thrift_hostif_packet_t thrift_packet;
+
+            thrift_packet.data.assign(slot.data.begin(), slot.data.end());
+
+            for (const auto &attr : slot.attrs)
+            {
+                sai_thrift_attribute_t thrift_attr;
+
+                if (sai_thrift_hostif_packet_attr_to_thrift(attr, thrift_attr))
+                { thrift_packet.attr_list.push_back(thrift_attr); }
+            }
+
+            rx_packets++;
+            rx_bytes += slot.data.size();
+
+            thrift_packets.push_back(std::move(thrift_packet));
+
+            head = (head + 1) % slots.size();
+            count--;
+        }
+    }
+
+    void tx_account(sai_status_t status, size_t buffer_size) noexcept
+    {
+        if (status != SAI_STATUS_SUCCESS)
+        { tx_errors++; return; }
+
+        tx_packets++;
+        tx_bytes += buffer_size;
+    }
+
+    // Rates are computed over the interval since the previous call
+    void stats(sai_thrift_hostif_packet_stats_t &thrift_stats) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto now = std::chrono::steady_clock::now();
+        const double interval = std::chrono::duration<double>(now - last_time).count();
+        const uint64_t tx = tx_packets;
+
+        thrift_stats.rx_queued = rx_queued;
+        thrift_stats.rx_dropped = rx_dropped;
+        thrift_stats.rx_packets = rx_packets;
+        thrift_stats.rx_bytes = rx_bytes;
+        thrift_stats.tx_packets = tx;
+        thrift_stats.tx_bytes = tx_bytes;
+        thrift_stats.tx_errors = tx_errors;
+        thrift_stats.rx_pending = count;
+        thrift_stats.rx_capacity = slots.size();
+        thrift_stats.interval = interval;
+        thrift_stats.rx_pps = interval > 0 ? (rx_packets - last_rx_packets) / interval : 0;
+        thrift_stats.tx_pps = interval > 0 ? (tx - last_tx_packets) / interval : 0;
+
+        last_rx_packets = rx_packets;
+        last_tx_packets = tx;
+        last_time = now;
+    }
+
+private:
+    struct slot_t {
+        std::vector<uint8_t> data;
+        std::vector<sai_attribute_t> attrs;
+    };
+
+    std::mutex mutex;
+    std::vector<slot_t> slots;
+    size_t head;
+    size_t count;
+    uint64_t rx_queued;
+    uint64_t rx_dropped;
+    uint64_t rx_packets;
+    uint64_t rx_bytes;
+    std::atomic<uint64_t> tx_packets;
+    std::atomic<uint64_t> tx_bytes;
+    std::atomic<uint64_t> tx_errors;
+    uint64_t last_rx_packets;
+    uint64_t last_tx_packets;
+    std::chrono::steady_clock::time_point last_time;
+};
+
+static sai_thrift_hostif_packet_ring gHostifPacketRing(SAI_THRIFT_HOSTIF_PACKET_RING_SIZE);
 
 class switch_sai_rpcHandler : virtual public switch_sai_rpcIf {
 public:
@@ -230,6 +389,7 @@ public:
   }
 
   void sai_thrift_parse_fdb_entry(const sai_thrift_fdb_entry_t &thrift_fdb_entry, sai_fdb_entry_t *fdb_entry) {
+      fdb_entry->switch_id = gSwitchId;
       fdb_entry->bv_id = (sai_object_id_t) thrift_fdb_entry.bv_id;
       sai_thrift_string_to_mac(thrift_fdb_entry.mac_address, fdb_entry->mac_address);
   }
@@ -246,6 +406,49 @@ public:
       sai_thrift_parse_ip_address(thrift_neighbor_entry.ip_address, &neighbor_entry->ip_address);
   }
 
+  // Flatten per-object thrift attribute lists into one contiguous attribute
+  // buffer plus the count/pointer arrays expected by the SAI bulk APIs.
+  template <typename parse_fn_t>
+  void sai_thrift_parse_bulk_attributes(const std::vector<std::vector<sai_thrift_attribute_t>> &thrift_attr_lists,
+                                        parse_fn_t parse_fn,
+                                        std::vector<sai_attribute_t> &attr_list,
+                                        std::vector<uint32_t> &attr_count,
+                                        std::vector<const sai_attribute_t *> &attr_ptr) {
+      size_t total = 0;
+      for (const auto &thrift_attr_list : thrift_attr_lists) {
+          total += thrift_attr_list.size();
+      }
+      attr_list.resize(total);
+      attr_count.resize(thrift_attr_lists.size());
+      attr_ptr.resize(thrift_attr_lists.size());
+      size_t offset = 0;
+      for (size_t i = 0; i < thrift_attr_lists.size(); i++) {
+          attr_count[i] = (uint32_t) thrift_attr_lists[i].size();
+          attr_ptr[i] = attr_list.data() + offset;
+          parse_fn(thrift_attr_lists[i], attr_list.data() + offset);
+          offset += thrift_attr_lists[i].size();
+      }
+  }
+
+  // Per-object emulation of a bulk call, used when the SAI implementation
+  // does not provide the bulk entry point.
+  template <typename object_fn_t>
+  sai_status_t sai_thrift_bulk_fallback(uint32_t object_count, sai_bulk_op_error_mode_t mode,
+                                        sai_status_t *object_statuses, object_fn_t object_fn) {
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      for (uint32_t i = 0; i < object_count; i++) {
+          if (status != SAI_STATUS_SUCCESS && mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+              object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+              continue;
+          }
+          object_statuses[i] = object_fn(i);
+          if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+              status = SAI_STATUS_FAILURE;
+          }
+      }
+      return status;
+  }
+
   void sai_thrift_parse_port_attributes(const std::vector<sai_thrift_attribute_t> &thrift_attr_list, sai_attribute_t *attr_list, sai_object_id_t **buffer_profile_list) {
       std::vector<sai_thrift_attribute_t>::const_iterator it = thrift_attr_list.begin();
       sai_thrift_attribute_t attribute;
@@ -681,7 +884,7 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_set_port_attribute(const sai_thrift_object_id_t port_id, const sai_thrift_attribute_t &thrift_attr) {
-      printf("sai_thrift_set_port\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_port_api_t *port_api;
       status = sai_api_query(SAI_API_PORT, (void **) &port_api);
@@ -693,7 +896,7 @@ public:
       thrift_attr_list.push_back(thrift_attr);
       sai_attribute_t attr;
       sai_thrift_parse_port_attributes(thrift_attr_list, &attr, &buffer_profile_list);
-      status = port_api->set_port_attribute((sai_object_id_t)port_id, &attr);
+      status = SAI_RPC_SAI_CALL(port_api->set_port_attribute((sai_object_id_t)port_id, &attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to set port attributes.");
       }
@@ -702,7 +905,7 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_set_router_interface_attribute(const sai_thrift_object_id_t rif_id, const sai_thrift_attribute_t &thrift_attr) {
-      printf("sai_thrift_set_router_interface\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_router_interface_api_t *rif_api;
       status = sai_api_query(SAI_API_ROUTER_INTERFACE, (void **) &rif_api);
@@ -713,7 +916,7 @@ public:
       thrift_attr_list.push_back(thrift_attr);
       sai_attribute_t attr;
       sai_thrift_parse_router_interface_attributes(thrift_attr_list, &attr);
-      status = rif_api->set_router_interface_attribute((sai_object_id_t)rif_id, &attr);
+      status = SAI_RPC_SAI_CALL(rif_api->set_router_interface_attribute((sai_object_id_t)rif_id, &attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to set router interface attributes.");
       }
@@ -721,7 +924,7 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_create_fdb_entry(const sai_thrift_fdb_entry_t& thrift_fdb_entry, const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_fdb_entry\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_fdb_api_t *fdb_api;
       sai_fdb_entry_t fdb_entry;
@@ -733,13 +936,13 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_fdb_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = fdb_api->create_fdb_entry(&fdb_entry, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(fdb_api->create_fdb_entry(&fdb_entry, attr_count, attr_list));
       free(attr_list);
       return status;
   }
 
   sai_thrift_status_t sai_thrift_delete_fdb_entry(const sai_thrift_fdb_entry_t& thrift_fdb_entry) {
-      printf("sai_thrift_delete_fdb_entry\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_fdb_api_t *fdb_api;
       sai_fdb_entry_t fdb_entry;
@@ -748,12 +951,84 @@ public:
           return status;
       }
       sai_thrift_parse_fdb_entry(thrift_fdb_entry, &fdb_entry);
-      status = fdb_api->remove_fdb_entry(&fdb_entry);
+      status = SAI_RPC_SAI_CALL(fdb_api->remove_fdb_entry(&fdb_entry));
       return status;
   }
 
+  void sai_thrift_create_fdb_entries(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                     const std::vector<sai_thrift_fdb_entry_t> & thrift_fdb_entries,
+                                     const std::vector<std::vector<sai_thrift_attribute_t>> & thrift_attr_lists,
+                                     const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_fdb_api_t *fdb_api;
+      uint32_t object_count = (uint32_t) thrift_fdb_entries.size();
+      if (thrift_attr_lists.size() != thrift_fdb_entries.size()) {
+          SAI_THRIFT_LOG_ERR("FDB entry and attribute list count mismatch.");
+          thrift_status_list.assign(object_count, SAI_STATUS_INVALID_PARAMETER);
+          return;
+      }
+      status = sai_api_query(SAI_API_FDB, (void **) &fdb_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_fdb_entry_t> fdb_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_fdb_entry(thrift_fdb_entries[i], &fdb_entries[i]);
+      }
+      std::vector<sai_attribute_t> attr_list;
+      std::vector<uint32_t> attr_count;
+      std::vector<const sai_attribute_t *> attr_ptr;
+      sai_thrift_parse_bulk_attributes(thrift_attr_lists,
+              [this](const std::vector<sai_thrift_attribute_t> &l, sai_attribute_t *a) { sai_thrift_parse_fdb_attributes(l, a); },
+              attr_list, attr_count, attr_ptr);
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (fdb_api->create_fdb_entries) {
+          status = SAI_RPC_SAI_CALL(fdb_api->create_fdb_entries(object_count, fdb_entries.data(), attr_count.data(), attr_ptr.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(fdb_api->create_fdb_entry(&fdb_entries[i], attr_count[i], attr_ptr[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to create some of %u fdb entries.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
+  void sai_thrift_remove_fdb_entries(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                     const std::vector<sai_thrift_fdb_entry_t> & thrift_fdb_entries,
+                                     const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_fdb_api_t *fdb_api;
+      uint32_t object_count = (uint32_t) thrift_fdb_entries.size();
+      status = sai_api_query(SAI_API_FDB, (void **) &fdb_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_fdb_entry_t> fdb_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_fdb_entry(thrift_fdb_entries[i], &fdb_entries[i]);
+      }
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (fdb_api->remove_fdb_entries) {
+          status = SAI_RPC_SAI_CALL(fdb_api->remove_fdb_entries(object_count, fdb_entries.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(fdb_api->remove_fdb_entry(&fdb_entries[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to remove some of %u fdb entries.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
   sai_thrift_status_t sai_thrift_flush_fdb_entries(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_flush_fdb_entries\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_fdb_api_t *fdb_api;
       status = sai_api_query(SAI_API_FDB, (void **) &fdb_api);
@@ -763,28 +1038,25 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_fdb_flush_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = fdb_api->flush_fdb_entries(gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(fdb_api->flush_fdb_entries(gSwitchId, attr_count, attr_list));
       free(attr_list);
       return status;
   }
 //listing all the fdb entries from map
   void sai_thrift_get_fdb_entries (sai_thrift_attribute_list_t& thrift_attr_list){
-      sai_mac_t mac_address;
-      sai_object_id_t bv_id;
-      sai_object_id_t bport_id;
-      sai_fdb_entry_t fdb_entry;
+      SAI_RPC_STATS_SCOPE(__func__);
 
-      thrift_attr_list.attr_count = gFdbMap.size();
+      // snapshot is immutable, notifications may keep updating the shadow meanwhile
+      const auto fdb_snapshot = gFdbShadow.snapshot();
 
-      sai_fdb_entry_t fdb_m;
-      sai_object_id_t b_id;
+      thrift_attr_list.attr_count = fdb_snapshot->size();
+      thrift_attr_list.attr_list.reserve(fdb_snapshot->size());
 
-      for (auto it = gFdbMap.begin(); it != gFdbMap.end(); it++){
-          fdb_m = it->first;
-          b_id = it->second;
+      for (const auto &fdb : *fdb_snapshot){
+          sai_fdb_entry_t fdb_m = fdb.fdb_entry;
 
           sai_thrift_fdb_values_t fdb_value;
-          fdb_value.bport_id=b_id;
+          fdb_value.bport_id=fdb.bport_id;
           fdb_value.thrift_fdb_entry.bv_id=fdb_m.bv_id;
           fdb_value.thrift_fdb_entry.mac_address=mac_to_sai_thrift_string(fdb_m.mac_address);
 
@@ -885,7 +1157,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_vlan(const std_sai_thrift_attr_vctr_t &thrift_attr_list) {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_vlan_api_t *vlan_api = nullptr;
       auto status = sai_api_query(SAI_API_VLAN, reinterpret_cast<void**>(&vlan_api));
@@ -899,7 +1171,7 @@ public:
       sai_thrift_parse_vlan_attributes(thrift_attr_list, attr_list);
 
       sai_object_id_t vlanObjId = 0;
-      status = vlan_api->create_vlan(&vlanObjId, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(vlan_api->create_vlan(&vlanObjId, gSwitchId, attr_size, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS) { return vlanObjId; }
@@ -910,14 +1182,14 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_remove_vlan(const sai_thrift_object_id_t vlan_oid) {
-      printf("sai_thrift_delete_vlan\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_vlan_api_t *vlan_api;
       status = sai_api_query(SAI_API_VLAN, (void **) &vlan_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = vlan_api->remove_vlan(vlan_oid);
+      status = SAI_RPC_SAI_CALL(vlan_api->remove_vlan(vlan_oid));
       return status;
   }
 
@@ -926,7 +1198,7 @@ public:
                                    const std::vector<sai_thrift_vlan_stat_counter_t> &thrift_counter_ids,
                                    const int32_t number_of_counters)
     {
-        printf("sai_thrift_get_vlan_stats\n");
+        SAI_RPC_STATS_SCOPE(__func__);
         sai_status_t status = SAI_STATUS_SUCCESS;
         sai_vlan_api_t *vlan_api;
         status = sai_api_query(SAI_API_VLAN, (void **) &vlan_api);
@@ -940,10 +1212,10 @@ public:
         for(uint32_t i = 0; i < thrift_counter_ids.size(); i++, it++)
         { counter_ids[i] = (sai_vlan_stat_t) *it; }
 
-        status = vlan_api->get_vlan_stats((sai_vlan_id_t) vlan_id,
+        status = SAI_RPC_SAI_CALL(vlan_api->get_vlan_stats((sai_vlan_id_t) vlan_id,
                                           number_of_counters,
                                           (const sai_stat_id_t *)counter_ids,
-                                          counters);
+                                          counters));
 
         for (uint32_t i = 0; i < thrift_counter_ids.size(); i++) { thrift_counters.push_back(counters[i]); }
 
@@ -954,7 +1226,7 @@ public:
     }
 
   void sai_thrift_get_vlan_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t vlan_id) {
-      printf("sai_thrift_get_vlan_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_vlan_api_t *vlan_api;
       sai_attribute_t vlan_member_list_object_attribute;
@@ -968,7 +1240,7 @@ public:
       vlan_member_list_object_attribute.id = SAI_VLAN_ATTR_MEMBER_LIST;
       vlan_member_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * 128);
       vlan_member_list_object_attribute.value.objlist.count = 128;
-      vlan_api->get_vlan_attribute(vlan_id, 1, &vlan_member_list_object_attribute);
+      SAI_RPC_SAI_CALL(vlan_api->get_vlan_attribute(vlan_id, 1, &vlan_member_list_object_attribute));
 
       thrift_attr_list.attr_count = 1;
       std::vector<sai_thrift_attribute_t>& attr_list = thrift_attr_list.attr_list;
@@ -984,6 +1256,8 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_set_vlan_attribute(const sai_thrift_object_id_t vlan_oid, const sai_thrift_attribute_t& thrift_attr)  {
+    SAI_RPC_STATS_SCOPE(__func__);
+
     sai_status_t status;
     const std::vector<sai_thrift_attribute_t> thrift_attr_list = { thrift_attr };
     sai_vlan_api_t *vlan_api;
@@ -996,7 +1270,7 @@ public:
     sai_thrift_alloc_attr(attr_list, 1);
     sai_thrift_parse_vlan_attributes(thrift_attr_list, attr_list);
 
-    status = vlan_api->set_vlan_attribute(vlan_oid, attr_list);
+    status = SAI_RPC_SAI_CALL(vlan_api->set_vlan_attribute(vlan_oid, attr_list));
     sai_thrift_free_attr(attr_list);
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -1009,7 +1283,7 @@ public:
 
 
   sai_thrift_object_id_t sai_thrift_create_vlan_member(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_vlan_member\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_vlan_api_t *vlan_api;
       sai_object_id_t vlan_member_id = 0;
@@ -1020,7 +1294,7 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_vlan_member_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      vlan_api->create_vlan_member(&vlan_member_id, gSwitchId, attr_count, attr_list);
+      SAI_RPC_SAI_CALL(vlan_api->create_vlan_member(&vlan_member_id, gSwitchId, attr_count, attr_list));
       return vlan_member_id;
   }
 
@@ -1045,11 +1319,12 @@ public:
   }
 
   void sai_thrift_get_vlan_member_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t vlan_member_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_vlan_api_t *vlan_api;
       sai_attribute_t attr[3];
 
-      SAI_THRIFT_FUNC_LOG();
 
       thrift_attr_list.attr_count = 0;
 
@@ -1063,7 +1338,7 @@ public:
       attr[1].id = SAI_VLAN_MEMBER_ATTR_BRIDGE_PORT_ID;
       attr[2].id = SAI_VLAN_MEMBER_ATTR_VLAN_TAGGING_MODE;
 
-      status = vlan_api->get_vlan_member_attribute(vlan_member_id, 3, attr);
+      status = SAI_RPC_SAI_CALL(vlan_api->get_vlan_member_attribute(vlan_member_id, 3, attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to obtain vlan member attributes, status:%d", status);
           return;
@@ -1073,23 +1348,24 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_remove_vlan_member(const sai_thrift_object_id_t vlan_member_id) {
-      printf("sai_thrift_remove_vlan_member\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_vlan_api_t *vlan_api;
       status = sai_api_query(SAI_API_VLAN, (void **) &vlan_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = vlan_api->remove_vlan_member((sai_object_id_t) vlan_member_id);
+      status = SAI_RPC_SAI_CALL(vlan_api->remove_vlan_member((sai_object_id_t) vlan_member_id));
       return status;
   }
 
   void sai_thrift_get_vlan_id(sai_thrift_result_t &ret, sai_thrift_object_id_t vlan_id)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_attribute_t vlan_attr;
       sai_vlan_api_t *vlan_api;
 
-      SAI_THRIFT_FUNC_LOG();
 
       ret.status = sai_api_query(SAI_API_VLAN, (void **) &vlan_api);
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -1098,7 +1374,7 @@ public:
       }
 
       vlan_attr.id = SAI_VLAN_ATTR_VLAN_ID;
-      ret.status = vlan_api->get_vlan_attribute((sai_object_id_t)vlan_id, 1, &vlan_attr);
+      ret.status = SAI_RPC_SAI_CALL(vlan_api->get_vlan_attribute((sai_object_id_t)vlan_id, 1, &vlan_attr));
       if (ret.status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to get vlan ID, status:%d", ret.status);
           return;
@@ -1108,7 +1384,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_virtual_router(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_virtual_router\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_virtual_router_api_t *vr_api;
       sai_object_id_t vr_id = 0;
@@ -1119,26 +1395,26 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_vr_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      vr_api->create_virtual_router(&vr_id, gSwitchId, attr_count, attr_list);
+      SAI_RPC_SAI_CALL(vr_api->create_virtual_router(&vr_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return vr_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_virtual_router(const sai_thrift_object_id_t vr_id) {
-      printf("sai_thrift_remove_virtual_router\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_virtual_router_api_t *vr_api;
       status = sai_api_query(SAI_API_VIRTUAL_ROUTER, (void **) &vr_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = vr_api->remove_virtual_router((sai_object_id_t)vr_id);
+      status = SAI_RPC_SAI_CALL(vr_api->remove_virtual_router((sai_object_id_t)vr_id));
       return status;
   }
 
   sai_thrift_status_t sai_thrift_create_route(const sai_thrift_route_entry_t &thrift_route_entry, const std::vector<sai_thrift_attribute_t> & thrift_attr_list)
   {
-      printf("sai_thrift_create_route\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_route_api_t *route_api;
       sai_route_entry_t route_entry;
@@ -1150,14 +1426,13 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_route_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = route_api->create_route_entry(&route_entry, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(route_api->create_route_entry(&route_entry, attr_count, attr_list));
       free(attr_list);
-      SAI_THRIFT_LOG_DBG("Exit.");
       return status;
   }
 
   sai_thrift_status_t sai_thrift_remove_route(const sai_thrift_route_entry_t &thrift_route_entry) {
-      printf("sai_thrift_remove_route\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_route_api_t *route_api;
       sai_route_entry_t route_entry;
@@ -1166,12 +1441,84 @@ public:
           return status;
       }
       sai_thrift_parse_route_entry(thrift_route_entry, &route_entry);
-      status = route_api->remove_route_entry(&route_entry);
+      status = SAI_RPC_SAI_CALL(route_api->remove_route_entry(&route_entry));
       return status;
   }
 
+  void sai_thrift_create_routes(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                const std::vector<sai_thrift_route_entry_t> & thrift_route_entries,
+                                const std::vector<std::vector<sai_thrift_attribute_t>> & thrift_attr_lists,
+                                const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_route_api_t *route_api;
+      uint32_t object_count = (uint32_t) thrift_route_entries.size();
+      if (thrift_attr_lists.size() != thrift_route_entries.size()) {
+          SAI_THRIFT_LOG_ERR("Route entry and attribute list count mismatch.");
+          thrift_status_list.assign(object_count, SAI_STATUS_INVALID_PARAMETER);
+          return;
+      }
+      status = sai_api_query(SAI_API_ROUTE, (void **) &route_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_route_entry_t> route_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_route_entry(thrift_route_entries[i], &route_entries[i]);
+      }
+      std::vector<sai_attribute_t> attr_list;
+      std::vector<uint32_t> attr_count;
+      std::vector<const sai_attribute_t *> attr_ptr;
+      sai_thrift_parse_bulk_attributes(thrift_attr_lists,
+              [this](const std::vector<sai_thrift_attribute_t> &l, sai_attribute_t *a) { sai_thrift_parse_route_attributes(l, a); },
+              attr_list, attr_count, attr_ptr);
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (route_api->create_route_entries) {
+          status = SAI_RPC_SAI_CALL(route_api->create_route_entries(object_count, route_entries.data(), attr_count.data(), attr_ptr.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(route_api->create_route_entry(&route_entries[i], attr_count[i], attr_ptr[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to create some of %u routes.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
+  void sai_thrift_remove_routes(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                const std::vector<sai_thrift_route_entry_t> & thrift_route_entries,
+                                const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_route_api_t *route_api;
+      uint32_t object_count = (uint32_t) thrift_route_entries.size();
+      status = sai_api_query(SAI_API_ROUTE, (void **) &route_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_route_entry_t> route_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_route_entry(thrift_route_entries[i], &route_entries[i]);
+      }
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (route_api->remove_route_entries) {
+          status = SAI_RPC_SAI_CALL(route_api->remove_route_entries(object_count, route_entries.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(route_api->remove_route_entry(&route_entries[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to remove some of %u routes.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
   sai_thrift_object_id_t sai_thrift_create_router_interface(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_router_interface\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_router_interface_api_t *rif_api;
       sai_object_id_t rif_id = 0;
@@ -1182,25 +1529,25 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_router_interface_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = rif_api->create_router_interface(&rif_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(rif_api->create_router_interface(&rif_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return rif_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_router_interface(const sai_thrift_object_id_t rif_id) {
-      printf("sai_thrift_remove_router_interface\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_router_interface_api_t *rif_api;
       status = sai_api_query(SAI_API_ROUTER_INTERFACE, (void **) &rif_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = rif_api->remove_router_interface((sai_object_id_t)rif_id);
+      status = SAI_RPC_SAI_CALL(rif_api->remove_router_interface((sai_object_id_t)rif_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_next_hop(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_next_hop\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_next_hop_api_t *nhop_api;
       sai_object_id_t nhop_id = 0;
@@ -1211,25 +1558,25 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_next_hop_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = nhop_api->create_next_hop(&nhop_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(nhop_api->create_next_hop(&nhop_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return nhop_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_next_hop(const sai_thrift_object_id_t next_hop_id) {
-      printf("sai_thrift_remove_next_hop\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_next_hop_api_t *nhop_api;
       status = sai_api_query(SAI_API_NEXT_HOP, (void **) &nhop_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = nhop_api->remove_next_hop((sai_object_id_t)next_hop_id);
+      status = SAI_RPC_SAI_CALL(nhop_api->remove_next_hop((sai_object_id_t)next_hop_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_lag(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_lag\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_lag_api_t *lag_api;
       sai_object_id_t lag_id = 0;
@@ -1239,23 +1586,25 @@ public:
           return status;
       }
 
-      status = lag_api->create_lag(&lag_id, gSwitchId, 0, nullptr);
+      status = SAI_RPC_SAI_CALL(lag_api->create_lag(&lag_id, gSwitchId, 0, nullptr));
       return lag_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_lag(const sai_thrift_object_id_t lag_id) {
-      printf("sai_thrift_remove_lag\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_lag_api_t *lag_api;
       status = sai_api_query(SAI_API_LAG, (void **) &lag_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = lag_api->remove_lag((sai_object_id_t)lag_id);
+      status = SAI_RPC_SAI_CALL(lag_api->remove_lag((sai_object_id_t)lag_id));
       return status;
   }
 
   sai_thrift_status_t sai_thrift_set_lag_attribute(const sai_thrift_object_id_t lag_id, const sai_thrift_attribute_t& thrift_attr) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status;
       const std::vector<sai_thrift_attribute_t> thrift_attr_list = { thrift_attr };
       sai_lag_api_t *lag_api;
@@ -1269,7 +1618,7 @@ public:
       sai_thrift_alloc_attr(attr_list, 1);
       sai_thrift_parse_lag_attributes(thrift_attr_list, attr_list);
 
-      status = lag_api->set_lag_attribute(lag_id, attr_list);
+      status = SAI_RPC_SAI_CALL(lag_api->set_lag_attribute(lag_id, attr_list));
       sai_thrift_free_attr(attr_list);
       if (status != SAI_STATUS_SUCCESS)
       {
@@ -1281,7 +1630,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_lag_member(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_lag_member\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_lag_api_t *lag_api;
       sai_object_id_t lag_member_id;
@@ -1292,24 +1641,26 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_lag_member_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = lag_api->create_lag_member(&lag_member_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(lag_api->create_lag_member(&lag_member_id, gSwitchId, attr_count, attr_list));
       return lag_member_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_lag_member(const sai_thrift_object_id_t lag_member_id) {
-      printf("sai_thrift_remove_lag_member\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_lag_api_t *lag_api;
       status = sai_api_query(SAI_API_LAG, (void **) &lag_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = lag_api->remove_lag_member(lag_member_id);
+      status = SAI_RPC_SAI_CALL(lag_api->remove_lag_member(lag_member_id));
       return status;
   }
 
   void sai_thrift_get_lag_member_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t lag_member_id)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_attribute_t sai_attrs[2];
       sai_lag_api_t *lag_api;
@@ -1320,12 +1671,11 @@ public:
           return;
       }
 
-      SAI_THRIFT_FUNC_LOG();
 
       sai_attrs[0].id = SAI_LAG_MEMBER_ATTR_LAG_ID;
       sai_attrs[1].id = SAI_LAG_MEMBER_ATTR_PORT_ID;
 
-      status = lag_api->get_lag_member_attribute(lag_member_id, 2, sai_attrs);
+      status = SAI_RPC_SAI_CALL(lag_api->get_lag_member_attribute(lag_member_id, 2, sai_attrs));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to obtain lag member attributes, status:%d", status);
           return;
@@ -1335,7 +1685,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_stp_entry(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_stp\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_stp_api_t *stp_api;
       sai_vlan_id_t *vlan_list;
@@ -1347,26 +1697,26 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_stp_attributes(thrift_attr_list, attr_list, &vlan_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = (sai_object_id_t) stp_api->create_stp(&stp_id, gSwitchId, attr_count, attr_list);
+      status = (sai_object_id_t) SAI_RPC_SAI_CALL(stp_api->create_stp(&stp_id, gSwitchId, attr_count, attr_list));
       if (vlan_list) free(vlan_list);
       free(attr_list);
       return stp_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_stp_entry(const sai_thrift_object_id_t stp_id) {
-      printf("sai_thrift_remove_stp\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_stp_api_t *stp_api;
       status = sai_api_query(SAI_API_STP, (void **) &stp_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = (sai_thrift_status_t) stp_api->remove_stp(stp_id);
+      status = (sai_thrift_status_t) SAI_RPC_SAI_CALL(stp_api->remove_stp(stp_id));
       return status;
   }
 
   sai_thrift_status_t sai_thrift_set_stp_port_state(const sai_thrift_object_id_t stp_id, const sai_thrift_object_id_t port_id, const sai_thrift_port_stp_port_state_t stp_port_state) {
-    printf("sai_thrift_set_stp_port_state\n");
+    SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_stp_api_t *stp_api;
       status = sai_api_query(SAI_API_STP, (void **) &stp_api);
@@ -1377,12 +1727,12 @@ public:
       std::memset(attr, '\0', sizeof(attr));
       attr[0].id = SAI_STP_PORT_ATTR_STATE;
       attr[0].value.s32 = stp_port_state;
-      status = stp_api->set_stp_port_attribute(port_id, attr);
+      status = SAI_RPC_SAI_CALL(stp_api->set_stp_port_attribute(port_id, attr));
       return status;
   }
 
   sai_thrift_port_stp_port_state_t sai_thrift_get_stp_port_state(const sai_thrift_object_id_t stp_id, const sai_thrift_object_id_t port_id) {
-    printf("sai_thrift_get_stp_port_state\n");
+    SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_stp_api_t *stp_api;
       status = sai_api_query(SAI_API_STP, (void **) &stp_api);
@@ -1392,12 +1742,12 @@ public:
       sai_attribute_t attr[1];
       std::memset(attr, '\0', sizeof(attr));
       attr[0].id = SAI_STP_PORT_ATTR_STATE;
-      status = stp_api->get_stp_port_attribute(port_id, 1, attr);
+      status = SAI_RPC_SAI_CALL(stp_api->get_stp_port_attribute(port_id, 1, attr));
       return (sai_thrift_port_stp_port_state_t) attr[0].value.s32;
   }
 
   sai_thrift_status_t sai_thrift_create_neighbor_entry(const sai_thrift_neighbor_entry_t& thrift_neighbor_entry, const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_neighbor_entry\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_neighbor_api_t *neighbor_api;
       status = sai_api_query(SAI_API_NEIGHBOR, (void **) &neighbor_api);
@@ -1409,13 +1759,13 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_neighbor_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = neighbor_api->create_neighbor_entry(&neighbor_entry, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(neighbor_api->create_neighbor_entry(&neighbor_entry, attr_count, attr_list));
       free(attr_list);
       return status;
   }
 
   sai_thrift_status_t sai_thrift_remove_neighbor_entry(const sai_thrift_neighbor_entry_t& thrift_neighbor_entry) {
-    printf("sai_thrift_remove_neighbor_entry\n");
+    SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_neighbor_api_t *neighbor_api;
       sai_neighbor_entry_t neighbor_entry;
@@ -1424,12 +1774,84 @@ public:
           return status;
       }
       sai_thrift_parse_neighbor_entry(thrift_neighbor_entry, &neighbor_entry);
-      status = neighbor_api->remove_neighbor_entry(&neighbor_entry);
+      status = SAI_RPC_SAI_CALL(neighbor_api->remove_neighbor_entry(&neighbor_entry));
       return status;
   }
 
+  void sai_thrift_create_neighbor_entries(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                          const std::vector<sai_thrift_neighbor_entry_t> & thrift_neighbor_entries,
+                                          const std::vector<std::vector<sai_thrift_attribute_t>> & thrift_attr_lists,
+                                          const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_neighbor_api_t *neighbor_api;
+      uint32_t object_count = (uint32_t) thrift_neighbor_entries.size();
+      if (thrift_attr_lists.size() != thrift_neighbor_entries.size()) {
+          SAI_THRIFT_LOG_ERR("Neighbor entry and attribute list count mismatch.");
+          thrift_status_list.assign(object_count, SAI_STATUS_INVALID_PARAMETER);
+          return;
+      }
+      status = sai_api_query(SAI_API_NEIGHBOR, (void **) &neighbor_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_neighbor_entry_t> neighbor_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_neighbor_entry(thrift_neighbor_entries[i], &neighbor_entries[i]);
+      }
+      std::vector<sai_attribute_t> attr_list;
+      std::vector<uint32_t> attr_count;
+      std::vector<const sai_attribute_t *> attr_ptr;
+      sai_thrift_parse_bulk_attributes(thrift_attr_lists,
+              [this](const std::vector<sai_thrift_attribute_t> &l, sai_attribute_t *a) { sai_thrift_parse_neighbor_attributes(l, a); },
+              attr_list, attr_count, attr_ptr);
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (neighbor_api->create_neighbor_entries) {
+          status = SAI_RPC_SAI_CALL(neighbor_api->create_neighbor_entries(object_count, neighbor_entries.data(), attr_count.data(), attr_ptr.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(neighbor_api->create_neighbor_entry(&neighbor_entries[i], attr_count[i], attr_ptr[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to create some of %u neighbor entries.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
+  void sai_thrift_remove_neighbor_entries(std::vector<sai_thrift_status_t> & thrift_status_list,
+                                          const std::vector<sai_thrift_neighbor_entry_t> & thrift_neighbor_entries,
+                                          const int32_t mode) {
+      SAI_RPC_STATS_SCOPE(__func__);
+      sai_status_t status = SAI_STATUS_SUCCESS;
+      sai_neighbor_api_t *neighbor_api;
+      uint32_t object_count = (uint32_t) thrift_neighbor_entries.size();
+      status = sai_api_query(SAI_API_NEIGHBOR, (void **) &neighbor_api);
+      if (status != SAI_STATUS_SUCCESS) {
+          thrift_status_list.assign(object_count, status);
+          return;
+      }
+      std::vector<sai_neighbor_entry_t> neighbor_entries(object_count);
+      for (uint32_t i = 0; i < object_count; i++) {
+          sai_thrift_parse_neighbor_entry(thrift_neighbor_entries[i], &neighbor_entries[i]);
+      }
+      std::vector<sai_status_t> object_statuses(object_count, SAI_STATUS_NOT_EXECUTED);
+      if (neighbor_api->remove_neighbor_entries) {
+          status = SAI_RPC_SAI_CALL(neighbor_api->remove_neighbor_entries(object_count, neighbor_entries.data(),
+                                                   (sai_bulk_op_error_mode_t) mode, object_statuses.data()));
+      } else {
+          status = sai_thrift_bulk_fallback(object_count, (sai_bulk_op_error_mode_t) mode, object_statuses.data(),
+                  [&](uint32_t i) { return SAI_RPC_SAI_CALL(neighbor_api->remove_neighbor_entry(&neighbor_entries[i])); });
+      }
+      if (status != SAI_STATUS_SUCCESS) {
+          SAI_THRIFT_LOG_ERR("Failed to remove some of %u neighbor entries.", object_count);
+      }
+      thrift_status_list.assign(object_statuses.begin(), object_statuses.end());
+  }
+
   sai_thrift_status_t sai_thrift_set_neighbor_entry_attribute(const sai_thrift_neighbor_entry_t& thrift_neighbor_entry, const std::vector<sai_thrift_attribute_t> & thrift_attr) {
-      printf("sai_thrift_set_neighbor_entry_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_neighbor_api_t *neighbor_api;
       status = sai_api_query(SAI_API_NEIGHBOR, (void **) &neighbor_api);
@@ -1440,25 +1862,26 @@ public:
       sai_thrift_parse_neighbor_entry(thrift_neighbor_entry, &neighbor_entry);
       sai_attribute_t *attr= (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr.size());
       sai_thrift_parse_neighbor_attributes(thrift_attr, attr);
-      status = neighbor_api->set_neighbor_entry_attribute(&neighbor_entry, attr);
+      status = SAI_RPC_SAI_CALL(neighbor_api->set_neighbor_entry_attribute(&neighbor_entry, attr));
       free(attr);
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_get_cpu_port_id() {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status;
       sai_attribute_t attr;
       sai_switch_api_t *switch_api;
       sai_thrift_object_id_t cpu_port_id;
       const char* f_name = __FUNCTION__;
-      printf("%s\n", f_name);
       status = sai_api_query(SAI_API_SWITCH, (void **) &switch_api);
       if (status != SAI_STATUS_SUCCESS) {
           printf("%s failed to obtain switch_api, status:%d\n", f_name, status);
           return SAI_NULL_OBJECT_ID;
       }
       attr.id = SAI_SWITCH_ATTR_CPU_PORT;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
       if (status != SAI_STATUS_SUCCESS)
       {
           printf("%s failed, status:%d\n", f_name, status);
@@ -1469,19 +1892,20 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_get_default_router_id() {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status;
       sai_attribute_t attr;
       sai_switch_api_t *switch_api;
       sai_thrift_object_id_t default_router_id;
       const char* f_name = __FUNCTION__;
-      printf("%s\n", f_name);
       status = sai_api_query(SAI_API_SWITCH, (void **) &switch_api);
       if (status != SAI_STATUS_SUCCESS) {
           printf("%s failed to obtain switch_api, status:%d\n", f_name, status);
           return SAI_NULL_OBJECT_ID;
       }
       attr.id = SAI_SWITCH_ATTR_DEFAULT_VIRTUAL_ROUTER_ID;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
       if (status != SAI_STATUS_SUCCESS)
       {
           printf("%s. Failed to get switch virtual router ID, status %d", f_name, status);
@@ -1493,11 +1917,12 @@ public:
 
   sai_thrift_object_id_t sai_thrift_get_default_1q_bridge_id()
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_switch_api_t *switch_api;
       sai_attribute_t attr;
       sai_status_t status;
 
-      SAI_THRIFT_FUNC_LOG();
 
       status = sai_api_query(SAI_API_SWITCH, (void **) &switch_api);
       if (status != SAI_STATUS_SUCCESS) {
@@ -1506,7 +1931,7 @@ public:
       }
 
       attr.id = SAI_SWITCH_ATTR_DEFAULT_1Q_BRIDGE_ID;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
       if (status != SAI_STATUS_SUCCESS)
       {
           SAI_THRIFT_LOG_ERR("Failed to get switch virtual router ID, status %d", status);
@@ -1517,10 +1942,11 @@ public:
   }
 
   void sai_thrift_get_default_vlan_id(sai_thrift_result_t &ret) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_switch_api_t *switch_api;
       sai_attribute_t attr;
 
-      SAI_THRIFT_FUNC_LOG();
 
       ret.status = sai_api_query(SAI_API_SWITCH, (void **) &switch_api);
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -1529,7 +1955,7 @@ public:
       }
 
       attr.id = SAI_SWITCH_ATTR_DEFAULT_VLAN_ID;
-      ret.status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+      ret.status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
       if (ret.status != SAI_STATUS_SUCCESS)
       {
           SAI_THRIFT_LOG_ERR("failed to get switch default vlan ID, status:%d", ret.status);
@@ -1540,19 +1966,20 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_get_default_trap_group() {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status;
       sai_attribute_t attr;
       sai_switch_api_t *switch_api;
       sai_thrift_object_id_t default_trap_group;
       const char* f_name = __FUNCTION__;
-      printf("%s\n", f_name);
       status = sai_api_query(SAI_API_SWITCH, (void **) &switch_api);
       if (status != SAI_STATUS_SUCCESS) {
           printf("%s failed to obtain switch_api, status:%d\n", f_name, status);
           return SAI_NULL_OBJECT_ID;
       }
       attr.id = SAI_SWITCH_ATTR_DEFAULT_TRAP_GROUP;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
       if (status != SAI_STATUS_SUCCESS)
       {
           printf("%s. Failed to get switch default trap group, status %d", f_name, status);
@@ -1563,7 +1990,7 @@ public:
   }
 
   void sai_thrift_get_switch_attribute(sai_thrift_attribute_list_t& thrift_attr_list) {
-      printf("sai_thrift_get_switch_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_switch_api_t *switch_api;
       sai_attribute_t max_port_attribute;
@@ -1578,12 +2005,12 @@ public:
       }
 
       max_port_attribute.id = SAI_SWITCH_ATTR_PORT_NUMBER;
-      switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute));
       max_ports = max_port_attribute.value.u32;
       port_list_object_attribute.id = SAI_SWITCH_ATTR_PORT_LIST;
       port_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_ports);
       port_list_object_attribute.value.objlist.count = max_ports;
-      switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute));
 
       thrift_attr_list.attr_count = 1;
       std::vector<sai_thrift_attribute_t>& attr_list = thrift_attr_list.attr_list;
@@ -1599,7 +2026,7 @@ public:
 
       sai_attribute_t switch_attr;
       switch_attr.id = SAI_SWITCH_ATTR_TYPE;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &switch_attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &switch_attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("get_switch_attribute failed!!!");
           return;
@@ -1608,7 +2035,7 @@ public:
           return;
       }
       switch_attr.id = SAI_SWITCH_ATTR_CREDIT_WD;
-      status = switch_api->get_switch_attribute(gSwitchId, 1, &switch_attr);
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &switch_attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("get_switch_attribute failed!!!");
           return;
@@ -1622,7 +2049,7 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_set_switch_attribute(const sai_thrift_attribute_t& thrift_attr) {
-      printf("sai_thrift_set_switch_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_switch_api_t *switch_api;
       sai_attribute_t attr;
@@ -1635,7 +2062,7 @@ public:
       if (thrift_attr.id == SAI_SWITCH_ATTR_CREDIT_WD)
       {
           attr.id = SAI_SWITCH_ATTR_TYPE;
-          status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+          status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
           if (status != SAI_STATUS_SUCCESS) {
               SAI_THRIFT_LOG_ERR("get_switch_attribute failed!!!");
               return status;
@@ -1647,7 +2074,7 @@ public:
       }
       sai_thrift_parse_switch_attribute(thrift_attr, &attr);
 
-      status = switch_api->set_switch_attribute(gSwitchId, &attr);
+      status = SAI_RPC_SAI_CALL(switch_api->set_switch_attribute(gSwitchId, &attr));
       return status;
   }
 
@@ -1686,7 +2113,7 @@ public:
   }
 
   void sai_thrift_get_port_list_by_front_port(sai_thrift_attribute_t& thrift_attr) {
-      printf("sai_thrift_get_port_list_by_front_port\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_switch_api_t *switch_api;
       sai_port_api_t *port_api;
@@ -1712,19 +2139,19 @@ public:
       }
 
       max_port_attribute.id = SAI_SWITCH_ATTR_PORT_NUMBER;
-      switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute));
       max_ports = max_port_attribute.value.u32;
       port_list_object_attribute.id = SAI_SWITCH_ATTR_PORT_LIST;
       port_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_ports);
       port_list_object_attribute.value.objlist.count = max_ports;
-      switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute));
       std::map<int, sai_object_id_t> front_to_sai_map;
 
       for (int i=0 ; i<max_ports ; i++){
           port_lane_list_attribute.id = SAI_PORT_ATTR_HW_LANE_LIST;
           port_lane_list_attribute.value.u32list.list = (uint32_t *) malloc(sizeof(uint32_t) * 8);
           port_lane_list_attribute.value.u32list.count = 8;
-          port_api->get_port_attribute(port_list_object_attribute.value.objlist.list[i], 1, &port_lane_list_attribute);
+          SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_list_object_attribute.value.objlist.list[i], 1, &port_lane_list_attribute));
 
           uint32_t laneCnt = port_lane_list_attribute.value.u32list.count;
           uint32_t laneMatchCount = 0;
@@ -1779,7 +2206,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_get_port_id_by_front_port(const std::string& port_name) {
-      printf("sai_thrift_get_port_id_by_front_port\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_switch_api_t *switch_api;
       sai_port_api_t *port_api;
@@ -1818,18 +2245,18 @@ public:
       }
 
       max_port_attribute.id = SAI_SWITCH_ATTR_PORT_NUMBER;
-      switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &max_port_attribute));
       max_ports = max_port_attribute.value.u32;
       port_list_object_attribute.id = SAI_SWITCH_ATTR_PORT_LIST;
       port_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_ports);
       port_list_object_attribute.value.objlist.count = max_ports;
-      switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute);
+      SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &port_list_object_attribute));
 
       for (int i=0 ; i<max_ports ; i++){
           port_lane_list_attribute.id = SAI_PORT_ATTR_HW_LANE_LIST;
           port_lane_list_attribute.value.u32list.list = (uint32_t *) malloc(sizeof(uint32_t) * 8);
           port_lane_list_attribute.value.u32list.count = 8;
-          port_api->get_port_attribute(port_list_object_attribute.value.objlist.list[i], 1, &port_lane_list_attribute);
+          SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_list_object_attribute.value.objlist.list[i], 1, &port_lane_list_attribute));
 
           uint32_t laneCnt = port_lane_list_attribute.value.u32list.count;
           uint32_t laneMatchCount = 0;
@@ -1860,10 +2287,11 @@ public:
 
   void sai_thrift_create_bridge_port(sai_thrift_result_t &ret, const std::vector<sai_thrift_attribute_t> & thrift_attr_list)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_bridge_api_t *bridge_api;
       sai_attribute_t *sai_attrs = nullptr;
 
-      SAI_THRIFT_FUNC_LOG();
 
       ret.status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -1877,7 +2305,7 @@ public:
 
       sai_thrift_parse_bridge_port_attributes(thrift_attr_list, sai_attrs);
 
-      ret.status = bridge_api->create_bridge_port((sai_object_id_t *) &ret.data.oid, gSwitchId, attr_size, sai_attrs);
+      ret.status = SAI_RPC_SAI_CALL(bridge_api->create_bridge_port((sai_object_id_t *) &ret.data.oid, gSwitchId, attr_size, sai_attrs));
       if (ret.status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to create bridge port, status:%d", ret.status);
       }
@@ -1887,10 +2315,11 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_bridge_port(const sai_thrift_object_id_t bridge_port_id)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_bridge_api_t *bridge_api;
       sai_status_t status;
 
-      SAI_THRIFT_FUNC_LOG();
 
       status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (status != SAI_STATUS_SUCCESS) {
@@ -1898,17 +2327,18 @@ public:
           return status;
       }
 
-      return bridge_api->remove_bridge_port((sai_object_id_t) bridge_port_id);
+      return SAI_RPC_SAI_CALL(bridge_api->remove_bridge_port((sai_object_id_t) bridge_port_id));
   }
 
   void sai_thrift_get_bridge_port_list(sai_thrift_result_t &ret, sai_thrift_object_id_t bridge_id)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       std::vector<sai_thrift_object_id_t>& port_list = ret.data.objlist.object_id_list;
       sai_bridge_api_t *bridge_api;
       uint32_t max_ports = 128;
       sai_attribute_t attr;
 
-      SAI_THRIFT_FUNC_LOG();
 
       ret.status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -1920,13 +2350,13 @@ public:
       attr.value.objlist.list = (sai_object_id_t *) calloc(max_ports, sizeof(sai_object_id_t));
       attr.value.objlist.count = max_ports;
 
-      ret.status = bridge_api->get_bridge_attribute(bridge_id, 1, &attr);
+      ret.status = SAI_RPC_SAI_CALL(bridge_api->get_bridge_attribute(bridge_id, 1, &attr));
       if (ret.status != SAI_STATUS_SUCCESS && attr.value.objlist.count > max_ports) {
           /* retry one more time with a bigger list */
           max_ports = attr.value.objlist.count;
           attr.value.objlist.list = (sai_object_id_t *) realloc(attr.value.objlist.list, max_ports * sizeof(sai_object_id_t));
 
-          ret.status = bridge_api->get_bridge_attribute(bridge_id, 1, &attr);
+          ret.status = SAI_RPC_SAI_CALL(bridge_api->get_bridge_attribute(bridge_id, 1, &attr));
       }
 
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -1944,12 +2374,13 @@ public:
   sai_thrift_status_t sai_thrift_set_bridge_port_attribute(const sai_thrift_object_id_t bridge_port_id,
                                                            const sai_thrift_attribute_t& thrift_attr)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_bridge_api_t *bridge_api;
       sai_attribute_t attr;
       const std::vector<sai_thrift_attribute_t> thrift_attr_list = { thrift_attr };
 
-      SAI_THRIFT_FUNC_LOG();
 
       status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (status != SAI_STATUS_SUCCESS) {
@@ -1959,16 +2390,17 @@ public:
 
       sai_thrift_parse_bridge_port_attributes(thrift_attr_list, &attr);
 
-      return bridge_api->set_bridge_port_attribute(bridge_port_id, &attr);
+      return SAI_RPC_SAI_CALL(bridge_api->set_bridge_port_attribute(bridge_port_id, &attr));
   }
 
   void sai_thrift_get_bridge_port_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t bridge_port_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_bridge_api_t *bridge_api;
       uint32_t attr_count = 0;
       sai_attribute_t attr[3];
 
-      SAI_THRIFT_FUNC_LOG();
 
       thrift_attr_list.attr_count = 0;
 
@@ -1981,7 +2413,7 @@ public:
       attr[0].id = SAI_BRIDGE_PORT_ATTR_TYPE;
       attr_count = 1;
 
-      status = bridge_api->get_bridge_port_attribute(bridge_port_id, attr_count, attr);
+      status = SAI_RPC_SAI_CALL(bridge_api->get_bridge_port_attribute(bridge_port_id, attr_count, attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to obtain bridge port type, status:%d", status);
           return;
@@ -2005,7 +2437,7 @@ public:
           return;
       }
 
-      status = bridge_api->get_bridge_port_attribute(bridge_port_id, attr_count, attr);
+      status = SAI_RPC_SAI_CALL(bridge_api->get_bridge_port_attribute(bridge_port_id, attr_count, attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to obtain bridge port attributes, status:%d", status);
           return;
@@ -2016,10 +2448,11 @@ public:
 
   void sai_thrift_create_bridge(sai_thrift_result_t &ret, const std::vector<sai_thrift_attribute_t> & thrift_attr_list)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_bridge_api_t *bridge_api;
       sai_attribute_t  *sai_attrs = nullptr;
 
-      SAI_THRIFT_FUNC_LOG();
 
       ret.status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (ret.status != SAI_STATUS_SUCCESS) {
@@ -2033,7 +2466,7 @@ public:
 
       sai_thrift_parse_bridge_attributes(thrift_attr_list, sai_attrs);
 
-      ret.status = bridge_api->create_bridge((sai_object_id_t *) &ret.data.oid, gSwitchId, attr_size, sai_attrs);
+      ret.status = SAI_RPC_SAI_CALL(bridge_api->create_bridge((sai_object_id_t *) &ret.data.oid, gSwitchId, attr_size, sai_attrs));
       if (ret.status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("failed to create bridge, status:%d", ret.status);
       }
@@ -2043,10 +2476,11 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_bridge(const sai_thrift_object_id_t bridge_port_id)
   {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_bridge_api_t *bridge_api;
       sai_status_t status;
 
-      SAI_THRIFT_FUNC_LOG();
 
       status = sai_api_query(SAI_API_BRIDGE, (void **) &bridge_api);
       if (status != SAI_STATUS_SUCCESS) {
@@ -2054,12 +2488,12 @@ public:
           return status;
       }
 
-      return bridge_api->remove_bridge((sai_object_id_t) bridge_port_id);
+      return SAI_RPC_SAI_CALL(bridge_api->remove_bridge((sai_object_id_t) bridge_port_id));
   }
 
   sai_thrift_object_id_t sai_thrift_create_hostif(const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2073,11 +2507,11 @@ public:
       sai_thrift_parse_hostif_attributes(attr_list, thrift_attr_list);
 
       sai_object_id_t hif_oid = 0;
-      status = hostif_api->create_hostif(&hif_oid, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->create_hostif(&hif_oid, gSwitchId, attr_size, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return hif_oid; }
+      { return hif_oid; }
 
       SAI_THRIFT_LOG_ERR("Failed to create OID.");
 
@@ -2086,7 +2520,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_hostif(const sai_thrift_object_id_t thrift_hif_id) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2094,17 +2528,17 @@ public:
       if (status != SAI_STATUS_SUCCESS)
       { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-      status = hostif_api->remove_hostif(thrift_hif_id);
+      status = SAI_RPC_SAI_CALL(hostif_api->remove_hostif(thrift_hif_id));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to remove OID.");
   }
 
   sai_thrift_status_t sai_thrift_set_hostif_attribute(const sai_thrift_object_id_t thrift_hif_id, const sai_thrift_attribute_t &thrift_attr) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2119,11 +2553,11 @@ public:
       sai_thrift_alloc_attr(attr_list, attr_size);
       sai_thrift_parse_hostif_trap_group_attributes(attr_list, thrift_attr_list);
 
-      status = hostif_api->set_hostif_attribute(thrift_hif_id, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->set_hostif_attribute(thrift_hif_id, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to set attribute.");
 
@@ -2132,7 +2566,7 @@ public:
 
   sai_thrift_object_id_t sai_thrift_create_hostif_table_entry(const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2146,11 +2580,11 @@ public:
       sai_thrift_parse_hostif_table_entry_attributes(attr_list, thrift_attr_list);
 
       sai_object_id_t hif_table_entry_oid = 0;
-      status = hostif_api->create_hostif_table_entry(&hif_table_entry_oid, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->create_hostif_table_entry(&hif_table_entry_oid, gSwitchId, attr_size, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return hif_table_entry_oid; }
+      { return hif_table_entry_oid; }
 
       SAI_THRIFT_LOG_ERR("Failed to create OID.");
 
@@ -2159,7 +2593,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_hostif_table_entry(const sai_thrift_object_id_t thrift_hif_table_entry_id) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2167,17 +2601,17 @@ public:
       if (status != SAI_STATUS_SUCCESS)
       { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-      status = hostif_api->remove_hostif_table_entry(thrift_hif_table_entry_id);
+      status = SAI_RPC_SAI_CALL(hostif_api->remove_hostif_table_entry(thrift_hif_table_entry_id));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to remove OID.");
   }
 
   sai_thrift_status_t sai_thrift_set_hostif_table_entry_attribute(const sai_thrift_object_id_t thrift_hif_table_entry_id, const sai_thrift_attribute_t &thrift_attr) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2192,11 +2626,11 @@ public:
       sai_thrift_alloc_attr(attr_list, attr_size);
       sai_thrift_parse_hostif_trap_group_attributes(attr_list, thrift_attr_list);
 
-      status = hostif_api->set_hostif_table_entry_attribute(thrift_hif_table_entry_id, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->set_hostif_table_entry_attribute(thrift_hif_table_entry_id, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to set attribute.");
 
@@ -2205,7 +2639,7 @@ public:
 
   sai_thrift_object_id_t sai_thrift_create_hostif_trap_group(const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2219,11 +2653,11 @@ public:
       sai_thrift_parse_hostif_trap_group_attributes(attr_list, thrift_attr_list);
 
       sai_object_id_t hostif_trap_group_oid = 0;
-      status = hostif_api->create_hostif_trap_group(&hostif_trap_group_oid, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->create_hostif_trap_group(&hostif_trap_group_oid, gSwitchId, attr_size, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return hostif_trap_group_oid; }
+      { return hostif_trap_group_oid; }
 
       SAI_THRIFT_LOG_ERR("Failed to create OID.");
 
@@ -2232,7 +2666,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_hostif_trap_group(const sai_thrift_object_id_t thrift_hostif_trap_group_id) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2240,10 +2674,10 @@ public:
       if (status != SAI_STATUS_SUCCESS)
       { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-      status = hostif_api->remove_hostif_trap_group(thrift_hostif_trap_group_id);
+      status = SAI_RPC_SAI_CALL(hostif_api->remove_hostif_trap_group(thrift_hostif_trap_group_id));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to remove OID.");
 
@@ -2253,7 +2687,7 @@ public:
   sai_thrift_status_t sai_thrift_set_hostif_trap_group_attribute(const sai_thrift_object_id_t thrift_hostif_trap_group_id,
                                                                  const sai_thrift_attribute_t &thrift_attr) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2268,11 +2702,11 @@ public:
       sai_thrift_alloc_attr(attr_list, attr_size);
       sai_thrift_parse_hostif_trap_group_attributes(attr_list, thrift_attr_list);
 
-      status = hostif_api->set_hostif_trap_group_attribute(thrift_hostif_trap_group_id, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->set_hostif_trap_group_attribute(thrift_hostif_trap_group_id, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to set attribute.");
 
@@ -2281,7 +2715,7 @@ public:
 
   sai_thrift_object_id_t sai_thrift_create_hostif_trap(const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2295,11 +2729,11 @@ public:
       sai_thrift_parse_hostif_trap_attributes(attr_list, thrift_attr_list);
 
       sai_object_id_t hostif_trap_oid = 0;
-      status = hostif_api->create_hostif_trap(&hostif_trap_oid, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->create_hostif_trap(&hostif_trap_oid, gSwitchId, attr_size, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return hostif_trap_oid; }
+      { return hostif_trap_oid; }
 
       SAI_THRIFT_LOG_ERR("Failed to create OID.");
 
@@ -2308,7 +2742,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_hostif_trap(const sai_thrift_object_id_t thrift_hostif_trap_id) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2316,10 +2750,10 @@ public:
       if (status != SAI_STATUS_SUCCESS)
       { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-      status = hostif_api->remove_hostif_trap(thrift_hostif_trap_id);
+      status = SAI_RPC_SAI_CALL(hostif_api->remove_hostif_trap(thrift_hostif_trap_id));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to remove OID.");
 
@@ -2328,7 +2762,7 @@ public:
 
   sai_thrift_status_t sai_thrift_set_hostif_trap_attribute(const sai_thrift_object_id_t thrift_hostif_trap_id, const sai_thrift_attribute_t &thrift_attr)
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_hostif_api_t *hostif_api = nullptr;
       auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
@@ -2343,11 +2777,11 @@ public:
       sai_thrift_alloc_attr(attr_list, attr_size);
       sai_thrift_parse_hostif_trap_attributes(attr_list, thrift_attr_list);
 
-      status = hostif_api->set_hostif_trap_attribute(thrift_hostif_trap_id, attr_list);
+      status = SAI_RPC_SAI_CALL(hostif_api->set_hostif_trap_attribute(thrift_hostif_trap_id, attr_list));
       sai_thrift_free_attr(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to set attribute.");
 
@@ -2670,6 +3104,8 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_acl_table(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_table = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2681,23 +3117,27 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_acl_table_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = acl_api->create_acl_table(&acl_table, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->create_acl_table(&acl_table, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return acl_table;
   }
 
   sai_thrift_status_t sai_thrift_remove_acl_table(const sai_thrift_object_id_t acl_table_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_acl_api_t *acl_api;
       status = sai_api_query(SAI_API_ACL, (void **) &acl_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = acl_api->remove_acl_table(acl_table_id);
+      status = SAI_RPC_SAI_CALL(acl_api->remove_acl_table(acl_table_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_acl_entry(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_entry = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2715,7 +3155,7 @@ public:
                                             &in_ports_list, &out_ports_list,
                                             &ingress_mirror_list, &egress_mirror_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = acl_api->create_acl_entry(&acl_entry, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->create_acl_entry(&acl_entry, gSwitchId, attr_count, attr_list));
       free(attr_list);
       if (in_ports_list) free(in_ports_list);
       if (out_ports_list) free(out_ports_list);
@@ -2725,17 +3165,21 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_remove_acl_entry(const sai_thrift_object_id_t acl_entry) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_acl_api_t *acl_api;
       status = sai_api_query(SAI_API_ACL, (void **) &acl_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = acl_api->remove_acl_entry(acl_entry);
+      status = SAI_RPC_SAI_CALL(acl_api->remove_acl_entry(acl_entry));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_acl_table_group(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_table_group_id = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2747,23 +3191,27 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_acl_table_group_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = acl_api->create_acl_table_group(&acl_table_group_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->create_acl_table_group(&acl_table_group_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return acl_table_group_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_acl_table_group(const sai_thrift_object_id_t acl_table_group_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_acl_api_t *acl_api;
       status = sai_api_query(SAI_API_ACL, (void **) &acl_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = acl_api->remove_acl_table_group(acl_table_group_id);
+      status = SAI_RPC_SAI_CALL(acl_api->remove_acl_table_group(acl_table_group_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_acl_table_group_member(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_table_group_member_id = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2775,23 +3223,27 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_acl_table_group_member_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = acl_api->create_acl_table_group_member(&acl_table_group_member_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->create_acl_table_group_member(&acl_table_group_member_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return acl_table_group_member_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_acl_table_group_member(const sai_thrift_object_id_t acl_table_group_member_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_acl_api_t *acl_api;
       status = sai_api_query(SAI_API_ACL, (void **) &acl_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = acl_api->remove_acl_table_group_member(acl_table_group_member_id);
+      status = SAI_RPC_SAI_CALL(acl_api->remove_acl_table_group_member(acl_table_group_member_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_acl_counter(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_counter_id = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2802,12 +3254,14 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_convert_to_acl_counter_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      status = acl_api->create_acl_counter(&acl_counter_id, gSwitchId, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->create_acl_counter(&acl_counter_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return acl_counter_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_acl_counter(const sai_thrift_object_id_t acl_counter_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_entry = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2815,7 +3269,7 @@ public:
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = acl_api->remove_acl_counter(acl_counter_id);
+      status = SAI_RPC_SAI_CALL(acl_api->remove_acl_counter(acl_counter_id));
       return status;
   }
 
@@ -2823,6 +3277,8 @@ public:
           std::vector<sai_thrift_attribute_value_t> & thrift_attr_values,
           const sai_thrift_object_id_t acl_counter_id,
           const std::vector<int32_t> & thrift_attr_ids) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_object_id_t acl_entry = 0ULL;
       sai_acl_api_t *acl_api;
       sai_status_t status = SAI_STATUS_SUCCESS;
@@ -2835,7 +3291,7 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_ids.size());
       memset(attr_list, 0x0, sizeof(sizeof(sai_attribute_t) * thrift_attr_ids.size()));
       sai_thrift_parse_attribute_ids(thrift_attr_ids, attr_list);
-      status = acl_api->get_acl_counter_attribute(acl_counter_id, attr_count, attr_list);
+      status = SAI_RPC_SAI_CALL(acl_api->get_acl_counter_attribute(acl_counter_id, attr_count, attr_list));
       if (status != SAI_STATUS_SUCCESS) {
           return;
       }
@@ -2909,7 +3365,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_mirror_session(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_mirror_session\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_mirror_api_t *mirror_api;
       sai_object_id_t session_id = 0;
@@ -2920,24 +3376,24 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_mirror_session_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      mirror_api->create_mirror_session(&session_id, gSwitchId, attr_count, attr_list);
+      SAI_RPC_SAI_CALL(mirror_api->create_mirror_session(&session_id, gSwitchId, attr_count, attr_list));
       return session_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_mirror_session(const sai_thrift_object_id_t session_id) {
-      printf("sai_thrift_remove_mirror_session\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_mirror_api_t *mirror_api;
       status = sai_api_query(SAI_API_MIRROR, (void **) &mirror_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = mirror_api->remove_mirror_session((sai_object_id_t) session_id);
+      status = SAI_RPC_SAI_CALL(mirror_api->remove_mirror_session((sai_object_id_t) session_id));
       return status;
   }
 
   sai_thrift_status_t sai_thrift_set_mirror_session_attribute(const sai_thrift_object_id_t session_id, const sai_thrift_attribute_t &thrift_attr) {
-      printf("sai_thrift_set_mirror_session\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_mirror_api_t *mirror_api;
       status = sai_api_query(SAI_API_MIRROR, (void **) &mirror_api);
@@ -2948,7 +3404,7 @@ public:
       thrift_attr_list.push_back(thrift_attr);
       sai_attribute_t attr;
       sai_thrift_parse_mirror_session_attributes(thrift_attr_list, &attr);
-      status = mirror_api->set_mirror_session_attribute((sai_object_id_t)session_id, &attr);
+      status = SAI_RPC_SAI_CALL(mirror_api->set_mirror_session_attribute((sai_object_id_t)session_id, &attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to set mirror session attributes.");
       }
@@ -3012,7 +3468,7 @@ public:
 
   sai_thrift_object_id_t sai_thrift_create_policer(const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_policer_api_t *policer_api = nullptr;
       auto status = sai_api_query(SAI_API_POLICER, reinterpret_cast<void**>(&policer_api));
@@ -3027,11 +3483,11 @@ public:
       sai_thrift_parse_policer_attributes(attr_list, thrift_attr_list);
 
       sai_object_id_t policer_oid = 0;
-      status = policer_api->create_policer(&policer_oid, gSwitchId, attr_size, attr_list);
+      status = SAI_RPC_SAI_CALL(policer_api->create_policer(&policer_oid, gSwitchId, attr_size, attr_list));
       sai_thrift_free_array(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return policer_oid; }
+      { return policer_oid; }
 
       SAI_THRIFT_LOG_ERR("Failed to create OID.");
 
@@ -3040,7 +3496,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_policer(const sai_thrift_object_id_t thrift_policer_id) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_policer_api_t *policer_api = nullptr;
       auto status = sai_api_query(SAI_API_POLICER, reinterpret_cast<void**>(&policer_api));
@@ -3048,10 +3504,10 @@ public:
       if (status != SAI_STATUS_SUCCESS)
       { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-      status = policer_api->remove_policer(thrift_policer_id);
+      status = SAI_RPC_SAI_CALL(policer_api->remove_policer(thrift_policer_id));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to remove OID.");
 
@@ -3060,7 +3516,7 @@ public:
 
   sai_thrift_status_t sai_thrift_set_policer_attribute(const sai_thrift_object_id_t thrift_policer_id, const sai_thrift_attribute_t &thrift_attr) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_policer_api_t *policer_api = nullptr;
       auto status = sai_api_query(SAI_API_POLICER, reinterpret_cast<void**>(&policer_api));
@@ -3076,11 +3532,11 @@ public:
       sai_thrift_alloc_array(attr_list, attr_size);
       sai_thrift_parse_policer_attributes(attr_list, thrift_attr_list);
 
-      status = policer_api->set_policer_attribute(thrift_policer_id, attr_list);
+      status = SAI_RPC_SAI_CALL(policer_api->set_policer_attribute(thrift_policer_id, attr_list));
       sai_thrift_free_array(attr_list);
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to set attribute.");
 
@@ -3090,7 +3546,7 @@ public:
   void sai_thrift_get_policer_stats(std::vector<sai_thrift_uint64_t> &_return, const sai_thrift_object_id_t thrift_policer_id,
                                     const std::vector<sai_thrift_policer_stat_t> &thrift_counter_ids) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_policer_api_t *policer_api = nullptr;
       auto status = sai_api_query(SAI_API_POLICER, reinterpret_cast<void**>(&policer_api));
@@ -3107,11 +3563,10 @@ public:
 
       sai_thrift_alloc_array(counters, number_of_counters);
 
-      status = policer_api->get_policer_stats(thrift_policer_id, number_of_counters, (const sai_stat_id_t *)counter_ids, counters);
+      status = SAI_RPC_SAI_CALL(policer_api->get_policer_stats(thrift_policer_id, number_of_counters, (const sai_stat_id_t *)counter_ids, counters));
 
       if (status == SAI_STATUS_SUCCESS)
       {
-          SAI_THRIFT_LOG_DBG("Exited.");
           _return.assign(counters, counters + number_of_counters);
           sai_thrift_free_array(counters);
           return;
@@ -3124,7 +3579,7 @@ public:
   sai_thrift_status_t sai_thrift_clear_policer_stats(const sai_thrift_object_id_t thrift_policer_id,
                                                      const std::vector<sai_thrift_policer_stat_t> &thrift_counter_ids) noexcept
   {
-      SAI_THRIFT_LOG_DBG("Called.");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_policer_api_t *policer_api = nullptr;
       auto status = sai_api_query(SAI_API_POLICER, reinterpret_cast<void**>(&policer_api));
@@ -3135,10 +3590,10 @@ public:
       auto counter_ids = reinterpret_cast<const sai_policer_stat_t*>(thrift_counter_ids.data());
       sai_size_t number_of_counters = thrift_counter_ids.size();
 
-      status = policer_api->clear_policer_stats(thrift_policer_id, number_of_counters, (const sai_stat_id_t *)counter_ids);
+      status = SAI_RPC_SAI_CALL(policer_api->clear_policer_stats(thrift_policer_id, number_of_counters, (const sai_stat_id_t *)counter_ids));
 
       if (status == SAI_STATUS_SUCCESS)
-      { SAI_THRIFT_LOG_DBG("Exited."); return status; }
+      { return status; }
 
       SAI_THRIFT_LOG_ERR("Failed to clear statistics.");
 
@@ -3146,7 +3601,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_scheduler_profile(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_scheduler_profile\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_scheduler_api_t *scheduler_api;
       sai_object_id_t scheduler_id = 0;
@@ -3157,20 +3612,20 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_scheduler_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      scheduler_api->create_scheduler(&scheduler_id, gSwitchId, attr_count, attr_list);
+      SAI_RPC_SAI_CALL(scheduler_api->create_scheduler(&scheduler_id, gSwitchId, attr_count, attr_list));
 	  free (attr_list);
       return scheduler_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_scheduler_profile(const sai_thrift_object_id_t scheduler_id) {
-      printf("sai_thrift_remove_scheduler\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_scheduler_api_t *scheduler_api;
       status = sai_api_query(SAI_API_SCHEDULER, (void **) &scheduler_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = scheduler_api->remove_scheduler((sai_object_id_t) scheduler_id);
+      status = SAI_RPC_SAI_CALL(scheduler_api->remove_scheduler((sai_object_id_t) scheduler_id));
       return status;
   }
 
@@ -3207,7 +3662,7 @@ public:
                                  const sai_thrift_object_id_t port_id,
                                  const std::vector<sai_thrift_port_stat_counter_t> & thrift_counter_ids,
                                  const int32_t number_of_counters) {
-      printf("sai_thrift_get_port_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_port_api_t *port_api;
       status = sai_api_query(SAI_API_PORT, (void **) &port_api);
@@ -3221,10 +3676,10 @@ public:
           counter_ids[i] = (sai_port_stat_t) *it;
       }
 
-      status = port_api->get_port_stats((sai_object_id_t) port_id,
+      status = SAI_RPC_SAI_CALL(port_api->get_port_stats((sai_object_id_t) port_id,
                                         number_of_counters,
                                         (const sai_stat_id_t *)counter_ids,
-                                        counters);
+                                        counters));
 
       for (uint32_t i = 0; i < thrift_counter_ids.size(); i++) {
           thrift_counters.push_back(counters[i]);
@@ -3235,19 +3690,19 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_clear_port_all_stats(const sai_thrift_object_id_t port_id) {
-      printf("sai_thrift_clear_port_all_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_port_api_t *port_api;
       status = sai_api_query(SAI_API_PORT, (void **) &port_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = port_api->clear_port_all_stats( (sai_object_id_t) port_id);
+      status = SAI_RPC_SAI_CALL(port_api->clear_port_all_stats( (sai_object_id_t) port_id));
       return status;
   }
 
   void sai_thrift_get_port_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t port_id) {
-      printf("sai_thrift_get_port_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_port_api_t *port_api;
       sai_attribute_t max_queue_attribute;
@@ -3261,12 +3716,12 @@ public:
       }
 
       max_queue_attribute.id = SAI_PORT_ATTR_QOS_NUMBER_OF_QUEUES;
-      port_api->get_port_attribute(port_id, 1, &max_queue_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &max_queue_attribute));
       max_queues = max_queue_attribute.value.u32;
       queue_list_object_attribute.id = SAI_PORT_ATTR_QOS_QUEUE_LIST;
       queue_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_queues);
       queue_list_object_attribute.value.objlist.count = max_queues;
-      port_api->get_port_attribute(port_id, 1, &queue_list_object_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &queue_list_object_attribute));
 
       std::vector<sai_thrift_attribute_t>& attr_list = thrift_attr_list.attr_list;
       thrift_queue_list_attribute.id = SAI_PORT_ATTR_QOS_QUEUE_LIST;
@@ -3286,12 +3741,12 @@ public:
       int max_pg = 0;
 
       max_pg_attribute.id = SAI_PORT_ATTR_NUMBER_OF_INGRESS_PRIORITY_GROUPS;
-      port_api->get_port_attribute(port_id, 1, &max_pg_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &max_pg_attribute));
       max_pg = max_pg_attribute.value.u32;
       pg_list_object_attribute.id = SAI_PORT_ATTR_INGRESS_PRIORITY_GROUP_LIST;
       pg_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_pg);
       pg_list_object_attribute.value.objlist.count = max_pg;
-      port_api->get_port_attribute(port_id, 1, &pg_list_object_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &pg_list_object_attribute));
 
       thrift_pg_list_attribute.id = SAI_PORT_ATTR_INGRESS_PRIORITY_GROUP_LIST;
       thrift_pg_list_attribute.value.objlist.count = max_pg;
@@ -3310,7 +3765,7 @@ public:
       port_hw_lane.id = SAI_PORT_ATTR_HW_LANE_LIST;
       port_hw_lane.value.u32list.list = (uint32_t *) malloc(sizeof(uint32_t) * 8);
       port_hw_lane.value.u32list.count = 8;
-      port_api->get_port_attribute(port_id, 1, &port_hw_lane);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &port_hw_lane));
 
       thrift_port_hw_lane.id = SAI_PORT_ATTR_HW_LANE_LIST;
       thrift_port_hw_lane.value.u32list.count = port_hw_lane.value.u32list.count;
@@ -3325,7 +3780,7 @@ public:
       sai_attribute_t port_oper_status_attribute;
       sai_thrift_attribute_t thrift_port_status;
       port_oper_status_attribute.id = SAI_PORT_ATTR_OPER_STATUS;
-      port_api->get_port_attribute(port_id, 1, &port_oper_status_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &port_oper_status_attribute));
 
       thrift_port_status.id = SAI_PORT_ATTR_OPER_STATUS;
       thrift_port_status.value.s32 =  port_oper_status_attribute.value.s32;
@@ -3334,7 +3789,7 @@ public:
       sai_attribute_t port_mtu_status_attribute;
       sai_thrift_attribute_t thrift_port_mtu;
       port_mtu_status_attribute.id = SAI_PORT_ATTR_MTU;
-      port_api->get_port_attribute(port_id, 1, &port_mtu_status_attribute);
+      SAI_RPC_SAI_CALL(port_api->get_port_attribute(port_id, 1, &port_mtu_status_attribute));
 
       thrift_port_mtu.id = SAI_PORT_ATTR_MTU;
       thrift_port_mtu.value.u32 =  port_mtu_status_attribute.value.u32;
@@ -3345,7 +3800,7 @@ public:
                                   const sai_thrift_object_id_t queue_id,
                                   const std::vector<sai_thrift_queue_stat_counter_t> & thrift_counter_ids,
                                   const int32_t number_of_counters) {
-      printf("sai_thrift_get_queue_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_queue_api_t *queue_api;
       status = sai_api_query(SAI_API_QUEUE, (void **) &queue_api);
@@ -3359,11 +3814,11 @@ public:
           counter_ids[i] = (sai_queue_stat_t) *it;
       }
 
-      status = queue_api->get_queue_stats(
+      status = SAI_RPC_SAI_CALL(queue_api->get_queue_stats(
                              (sai_object_id_t) queue_id,
                              number_of_counters,
                              (const sai_stat_id_t *)counter_ids,
-                             counters);
+                             counters));
 
       for (uint32_t i = 0; i < thrift_counter_ids.size(); i++) {
           thrift_counters.push_back(counters[i]);
@@ -3375,7 +3830,7 @@ public:
 
   sai_thrift_status_t sai_thrift_set_queue_attribute(const sai_thrift_object_id_t queue_id,
                                                      const sai_thrift_attribute_t& thrift_attr) {
-      printf("sai_thrift_set_queue_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_queue_api_t *queue_api;
       status = sai_api_query(SAI_API_QUEUE, (void **) &queue_api);
@@ -3385,14 +3840,14 @@ public:
       sai_attribute_t attr;
       attr.id = thrift_attr.id;
       attr.value.oid = thrift_attr.value.oid;
-      status = queue_api->set_queue_attribute((sai_object_id_t)queue_id, &attr);
+      status = SAI_RPC_SAI_CALL(queue_api->set_queue_attribute((sai_object_id_t)queue_id, &attr));
       return status;
   }
 
   sai_thrift_status_t sai_thrift_clear_queue_stats(const sai_thrift_object_id_t queue_id,
                                                    const std::vector<sai_thrift_queue_stat_counter_t> & thrift_counter_ids,
                                                    const int32_t number_of_counters) {
-      printf("sai_thrift_clear_queue_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_queue_api_t *queue_api;
       status = sai_api_query(SAI_API_QUEUE, (void **) &queue_api);
@@ -3405,17 +3860,17 @@ public:
           counter_ids[i] = (sai_queue_stat_t) *it;
       }
 
-      status = queue_api->clear_queue_stats(
+      status = SAI_RPC_SAI_CALL(queue_api->clear_queue_stats(
                              (sai_object_id_t) queue_id,
                              number_of_counters,
-                             (const sai_stat_id_t *)counter_ids);
+                             (const sai_stat_id_t *)counter_ids));
 
       free(counter_ids);
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_buffer_profile(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-    printf("sai_thrift_create_buffer_profile\n");
+    SAI_RPC_STATS_SCOPE(__func__);
     sai_status_t status = SAI_STATUS_SUCCESS;
     sai_buffer_api_t *buffer_api;
     sai_object_id_t buffer_id = 0;
@@ -3426,7 +3881,7 @@ public:
     sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
     sai_thrift_parse_buffer_attributes(thrift_attr_list, attr_list);
     uint32_t attr_count = thrift_attr_list.size();
-    buffer_api->create_buffer_profile(&buffer_id, gSwitchId, attr_count, attr_list);
+    SAI_RPC_SAI_CALL(buffer_api->create_buffer_profile(&buffer_id, gSwitchId, attr_count, attr_list));
 
     return buffer_id;
   }
@@ -3464,7 +3919,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_pool_profile(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-    printf("sai_thrift_create_pool\n");
+    SAI_RPC_STATS_SCOPE(__func__);
     sai_status_t status = SAI_STATUS_SUCCESS;
     sai_buffer_api_t *buffer_api;
     sai_object_id_t pool_id = 0;
@@ -3475,7 +3930,7 @@ public:
     sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
     sai_thrift_parse_pool_attributes(thrift_attr_list, attr_list);
     uint32_t attr_count = thrift_attr_list.size();
-    buffer_api->create_buffer_pool(&pool_id, gSwitchId, attr_count, attr_list);
+    SAI_RPC_SAI_CALL(buffer_api->create_buffer_pool(&pool_id, gSwitchId, attr_count, attr_list));
     return pool_id;
   }
 
@@ -3502,7 +3957,7 @@ public:
   void sai_thrift_get_buffer_pool_stats(std::vector<int64_t> &thrift_counters,
                                         const sai_thrift_object_id_t buffer_pool_id,
                                         const std::vector<sai_thrift_buffer_pool_stat_counter_t> &thrift_counter_ids) {
-      printf("sai_thrift_get_buffer_pool_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_buffer_api_t *buffer_api;
@@ -3514,10 +3969,10 @@ public:
 
       thrift_counters.reserve(thrift_counter_ids.size());
       thrift_counters.resize(thrift_counter_ids.size(), 0);
-      status = buffer_api->get_buffer_pool_stats((sai_object_id_t)buffer_pool_id,
+      status = SAI_RPC_SAI_CALL(buffer_api->get_buffer_pool_stats((sai_object_id_t)buffer_pool_id,
                                                  (uint32_t)thrift_counter_ids.size(),
                                                  (const sai_stat_id_t *)thrift_counter_ids.data(),
-                                                 (uint64_t *)thrift_counters.data());
+                                                 (uint64_t *)thrift_counters.data()));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to get_buffer_pool_stats, status: %d", status);
           thrift_counters.resize(0);
@@ -3526,7 +3981,7 @@ public:
 
   sai_thrift_status_t sai_thrift_clear_buffer_pool_stats(const sai_thrift_object_id_t buffer_pool_id,
                                         const std::vector<sai_thrift_buffer_pool_stat_counter_t> &thrift_counter_ids) {
-      printf("sai_thrift_clear_buffer_pool_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_buffer_api_t *buffer_api;
@@ -3536,9 +3991,9 @@ public:
           return status;
       }
 
-      status = buffer_api->clear_buffer_pool_stats((sai_object_id_t)buffer_pool_id,
+      status = SAI_RPC_SAI_CALL(buffer_api->clear_buffer_pool_stats((sai_object_id_t)buffer_pool_id,
                                                  (uint32_t)thrift_counter_ids.size(),
-                                                 (const sai_stat_id_t *)thrift_counter_ids.data());
+                                                 (const sai_stat_id_t *)thrift_counter_ids.data()));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to clear_buffer_pool_stats, status: %d", status);
           return status;
@@ -3546,7 +4001,7 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_set_priority_group_attribute(const sai_thrift_object_id_t pg_id, const sai_thrift_attribute_t& thrift_attr) {
-      printf("sai_thrift_set_priority_group_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_buffer_api_t *buffer_api;
       status = sai_api_query(SAI_API_BUFFER, (void **) &buffer_api);
@@ -3556,7 +4011,7 @@ public:
       sai_attribute_t attr;
       attr.id = thrift_attr.id;
       attr.value.oid = thrift_attr.value.oid;
-      status = buffer_api->set_ingress_priority_group_attribute((sai_object_id_t)pg_id, &attr);
+      status = SAI_RPC_SAI_CALL(buffer_api->set_ingress_priority_group_attribute((sai_object_id_t)pg_id, &attr));
       return status;
   }
 
@@ -3564,7 +4019,7 @@ public:
                                const sai_thrift_object_id_t pg_id,
                                const std::vector<sai_thrift_pg_stat_counter_t> & thrift_counter_ids,
                                const int32_t number_of_counters) {
-      printf("sai_thrift_get_pg_stats\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_buffer_api_t *buffer_api;
       status = sai_api_query(SAI_API_BUFFER, (void **) &buffer_api);
@@ -3578,10 +4033,10 @@ public:
           counter_ids[i] = (sai_ingress_priority_group_stat_t) *it;
       }
 
-      status = buffer_api->get_ingress_priority_group_stats((sai_object_id_t) pg_id,
+      status = SAI_RPC_SAI_CALL(buffer_api->get_ingress_priority_group_stats((sai_object_id_t) pg_id,
                                                             number_of_counters,
                                                             (const sai_stat_id_t *)counter_ids,
-                                                            counters);
+                                                            counters));
 
       for (uint32_t i = 0; i < thrift_counter_ids.size(); i++) {
           thrift_counters.push_back(counters[i]);
@@ -3592,7 +4047,7 @@ public:
    }
 
   sai_thrift_object_id_t sai_thrift_create_wred_profile(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_wred_profile\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_wred_api_t *wred_api;
       sai_object_id_t wred_id = 0;
@@ -3603,7 +4058,7 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_wred_attributes(thrift_attr_list, attr_list);
       uint32_t attr_count = thrift_attr_list.size();
-      wred_api->create_wred(&wred_id, gSwitchId, attr_count, attr_list);
+      SAI_RPC_SAI_CALL(wred_api->create_wred(&wred_id, gSwitchId, attr_count, attr_list));
       free(attr_list);
       return wred_id;
   }
@@ -3662,14 +4117,14 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_remove_wred_profile(const sai_thrift_object_id_t wred_id) {
-      printf("sai_thrift_remove_wred_profile\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_wred_api_t *wred_api;
       status = sai_api_query(SAI_API_WRED, (void **) &wred_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
-      status = wred_api->remove_wred((sai_object_id_t) wred_id);
+      status = SAI_RPC_SAI_CALL(wred_api->remove_wred((sai_object_id_t) wred_id));
       return status;
   }
 
@@ -3746,7 +4201,7 @@ public:
   }
 
   sai_thrift_object_id_t sai_thrift_create_tunnel(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_tunnel\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_tunnel_api_t *tunnel_api;
 
@@ -3758,13 +4213,13 @@ public:
       sai_attribute_t *attr_list = (sai_attribute_t *) malloc(sizeof(sai_attribute_t) * thrift_attr_list.size());
       sai_thrift_parse_tunnel_attributes(thrift_attr_list,attr_list);
       uint32_t list_count = thrift_attr_list.size();
-      status = tunnel_api->create_tunnel(&tunnel_id, gSwitchId, list_count, attr_list);
+      status = SAI_RPC_SAI_CALL(tunnel_api->create_tunnel(&tunnel_id, gSwitchId, list_count, attr_list));
       free(attr_list);
       return tunnel_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_tunnel(const sai_thrift_object_id_t thrift_tunnel_id) {
-      printf("sai_thrift_remove_tunnel\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_tunnel_api_t *tunnel_api;
       status = sai_api_query(SAI_API_TUNNEL, (void **) &tunnel_api);
@@ -3772,12 +4227,12 @@ public:
           return status;
       }
       sai_object_id_t tunnel_id = (sai_object_id_t ) thrift_tunnel_id;
-      status = tunnel_api->remove_tunnel(tunnel_id);
+      status = SAI_RPC_SAI_CALL(tunnel_api->remove_tunnel(tunnel_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_tunnel_term_table_entry(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
-      printf("sai_thrift_create_tunnel_term_table_entry\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_tunnel_api_t *tunnel_api;
       status = sai_api_query(SAI_API_TUNNEL, (void **) &tunnel_api);
@@ -3788,13 +4243,13 @@ public:
       sai_object_id_t tunnel_entry_id = 0;
       sai_thrift_parse_tunnel_entry_attributes(thrift_attr_list,attr_list);
       uint32_t list_count = thrift_attr_list.size();
-      status = tunnel_api->create_tunnel_term_table_entry(&tunnel_entry_id, gSwitchId, list_count, attr_list);
+      status = SAI_RPC_SAI_CALL(tunnel_api->create_tunnel_term_table_entry(&tunnel_entry_id, gSwitchId, list_count, attr_list));
       free(attr_list);
       return tunnel_entry_id;
   }
 
   sai_thrift_status_t sai_thrift_remove_tunnel_term_table_entry(const sai_thrift_object_id_t thrift_tunnel_entry_id) {
-      printf("sai_thrift_remove_tunnel_term_table_entry\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_tunnel_api_t *tunnel_api;
       status = sai_api_query(SAI_API_TUNNEL, (void **) &tunnel_api);
@@ -3802,11 +4257,13 @@ public:
           return status;
       }
       sai_object_id_t tunnel_entry_id = (sai_object_id_t ) thrift_tunnel_entry_id;
-      status = tunnel_api->remove_tunnel_term_table_entry(tunnel_entry_id);
+      status = SAI_RPC_SAI_CALL(tunnel_api->remove_tunnel_term_table_entry(tunnel_entry_id));
       return status;
   }
 
   sai_thrift_object_id_t sai_thrift_create_qos_map(const std::vector<sai_thrift_attribute_t> & thrift_attr_list) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       std::vector<sai_thrift_attribute_t>::const_iterator it = thrift_attr_list.begin();
       sai_thrift_attribute_t attribute;
       sai_attribute_t *attr_list;
@@ -3815,7 +4272,6 @@ public:
       sai_object_id_t qos_map_id = 0;
       sai_qos_map_t *qos_map_list = NULL;
 
-      printf("sai_thrift_create_qos_map\n");
 
       status = sai_api_query(SAI_API_QOS_MAP, (void **) &qos_map_api);
       if (status != SAI_STATUS_SUCCESS) {
@@ -3849,7 +4305,7 @@ public:
           }
       }
 
-      qos_map_api->create_qos_map(&qos_map_id, gSwitchId, thrift_attr_list.size(), attr_list);
+      SAI_RPC_SAI_CALL(qos_map_api->create_qos_map(&qos_map_id, gSwitchId, thrift_attr_list.size(), attr_list));
 
       free(qos_map_list);
       free(attr_list);
@@ -3867,17 +4323,18 @@ public:
   }
 
   sai_thrift_status_t sai_thrift_remove_qos_map(const sai_thrift_object_id_t qos_map_id) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_qos_map_api_t *qos_map_api;
 
-      printf("sai_thrift_remove_qos_map\n");
 
       status = sai_api_query(SAI_API_QOS_MAP, (void **) &qos_map_api);
       if (status != SAI_STATUS_SUCCESS) {
           return status;
       }
 
-      status = qos_map_api->remove_qos_map((sai_object_id_t) qos_map_id);
+      status = SAI_RPC_SAI_CALL(qos_map_api->remove_qos_map((sai_object_id_t) qos_map_id));
       return status;
   }
 
@@ -3886,7 +4343,7 @@ public:
                                                  int32_t **in_debug_counter_ids_list,
                                                  int32_t **out_debug_counter_ids_list)
   {
-      printf("sai_thrift_parse_debug_counter_attributes\n");
+      SAI_THRIFT_FUNC_LOG();
 
       sai_thrift_attribute_t                              attribute;
       std::vector<sai_thrift_attribute_t>::const_iterator it = thrift_attr_list.begin();
@@ -3932,7 +4389,7 @@ public:
 
   sai_thrift_object_id_t sai_thrift_create_debug_counter(const std::vector<sai_thrift_attribute_t> & thrift_attr_list)
   {
-      printf("sai_thrift_create_debug_counter\n");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_debug_counter_api_t    *debug_counter_api;
       sai_status_t                status                     = SAI_STATUS_SUCCESS;
@@ -3952,10 +4409,10 @@ public:
                                                 &out_debug_counter_ids_list);
       uint32_t list_count = thrift_attr_list.size();
 
-      status = debug_counter_api->create_debug_counter(&debug_counter_id,
+      status = SAI_RPC_SAI_CALL(debug_counter_api->create_debug_counter(&debug_counter_id,
                                                         gSwitchId,
                                                         list_count,
-                                                        attr_list);
+                                                        attr_list));
 
       free(attr_list);
       free(in_debug_counter_ids_list);
@@ -3966,7 +4423,7 @@ public:
 
   sai_thrift_status_t sai_thrift_remove_debug_counter(const sai_thrift_object_id_t thrift_debug_counter_id)
   {
-      printf("sai_thrift_remove_debug_counter\n");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_debug_counter_api_t *debug_counter_api;
       sai_status_t             status = SAI_STATUS_SUCCESS;
@@ -3976,14 +4433,14 @@ public:
           return status;
       }
 
-      status = debug_counter_api->remove_debug_counter((sai_object_id_t) thrift_debug_counter_id);
+      status = SAI_RPC_SAI_CALL(debug_counter_api->remove_debug_counter((sai_object_id_t) thrift_debug_counter_id));
 
       return status;
   }
 
   sai_thrift_status_t sai_thrift_set_debug_counter_attribute(const sai_thrift_object_id_t dc_id, const sai_thrift_attribute_t &thrift_attr)
   {
-      printf("sai_thrift_set_debug_counter_attribute\n");
+      SAI_RPC_STATS_SCOPE(__func__);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_debug_counter_api_t *debug_counter_api;
       int32_t                 *in_debug_counter_ids_list  = NULL;
@@ -3999,7 +4456,7 @@ public:
       sai_attribute_t attr;
       sai_thrift_parse_debug_counter_attributes(thrift_attr_list, &attr, &in_debug_counter_ids_list, &out_debug_counter_ids_list);
 
-      status = debug_counter_api->set_debug_counter_attribute((sai_object_id_t)dc_id, &attr);
+      status = SAI_RPC_SAI_CALL(debug_counter_api->set_debug_counter_attribute((sai_object_id_t)dc_id, &attr));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("Failed to set debug counter attribute.");
       }
@@ -4014,7 +4471,7 @@ public:
                                             const sai_thrift_object_id_t             switch_id,
                                             const std::vector<sai_thrift_stat_id_t> &thrift_counter_ids)
   {
-      printf("sai_thrift_get_switch_stats\n");
+      SAI_THRIFT_FUNC_LOG();
 
       sai_switch_api_t *switch_api;
       sai_status_t      status = SAI_STATUS_SUCCESS;
@@ -4038,10 +4495,10 @@ public:
           free(counter_ids);
           return SAI_STATUS_NO_MEMORY;
       }
-      status = switch_api->get_switch_stats((sai_object_id_t) switch_id,
+      status = SAI_RPC_SAI_CALL(switch_api->get_switch_stats((sai_object_id_t) switch_id,
                                         thrift_counter_ids.size(),
                                         (const sai_stat_id_t *)counter_ids,
-                                        counters);
+                                        counters));
 
       for (uint32_t i = 0; i < thrift_counter_ids.size(); i++) {
           thrift_counters.push_back(counters[i]);
@@ -4054,7 +4511,7 @@ public:
 
   int64_t sai_thrift_get_switch_stats_by_oid(const sai_thrift_object_id_t thrift_counter_id)
   {
-      printf("sai_thrift_get_switch_stats_by_oid\n");
+      SAI_RPC_STATS_SCOPE(__func__);
 
       sai_debug_counter_api_t           *debug_counter_api;
       std::vector<sai_thrift_stat_id_t>  thrift_counter_ids;
@@ -4070,7 +4527,7 @@ public:
       }
 
       attr.id = SAI_DEBUG_COUNTER_ATTR_TYPE;
-      status = debug_counter_api->get_debug_counter_attribute((sai_object_id_t) thrift_counter_id, 1, &attr);
+      status = SAI_RPC_SAI_CALL(debug_counter_api->get_debug_counter_attribute((sai_object_id_t) thrift_counter_id, 1, &attr));
       if (SAI_STATUS_SUCCESS != status) {
           return 0;
       }
@@ -4090,7 +4547,7 @@ public:
       }
 
       attr.id = SAI_DEBUG_COUNTER_ATTR_INDEX;
-      status = debug_counter_api->get_debug_counter_attribute((sai_object_id_t) thrift_counter_id, 1, &attr);
+      status = SAI_RPC_SAI_CALL(debug_counter_api->get_debug_counter_attribute((sai_object_id_t) thrift_counter_id, 1, &attr));
       if (SAI_STATUS_SUCCESS != status) {
           return 0;
       }
@@ -4137,7 +4594,7 @@ public:
     sai_thrift_object_id_t sai_thrift_create_next_hop_group
     (const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
     {
-        SAI_THRIFT_LOG_DBG("Called.");
+        SAI_RPC_STATS_SCOPE(__func__);
 
         sai_next_hop_group_api_t *nhop_group_api = nullptr;
         auto status = sai_api_query(SAI_API_NEXT_HOP_GROUP, reinterpret_cast<void**>(&nhop_group_api));
@@ -4151,11 +4608,11 @@ public:
         sai_thrift_parse_next_hop_group_attributes(attr_list, thrift_attr_list);
 
         sai_object_id_t nhop_group_oid = 0;
-        status = nhop_group_api->create_next_hop_group(&nhop_group_oid, gSwitchId, attr_size, attr_list);
+        status = SAI_RPC_SAI_CALL(nhop_group_api->create_next_hop_group(&nhop_group_oid, gSwitchId, attr_size, attr_list));
         sai_thrift_free_attr(attr_list);
 
         if (status == SAI_STATUS_SUCCESS)
-        { SAI_THRIFT_LOG_DBG("Exited."); return nhop_group_oid; }
+        { return nhop_group_oid; }
 
         SAI_THRIFT_LOG_ERR("Failed to create group.");
 
@@ -4165,7 +4622,7 @@ public:
     sai_thrift_status_t sai_thrift_remove_next_hop_group
     (const sai_thrift_object_id_t nhop_group_oid) noexcept
     {
-        SAI_THRIFT_LOG_DBG("Called.");
+        SAI_RPC_STATS_SCOPE(__func__);
 
         sai_next_hop_group_api_t *nhop_group_api = nullptr;
         auto status = sai_api_query(SAI_API_NEXT_HOP_GROUP, reinterpret_cast<void**>(&nhop_group_api));
@@ -4173,9 +4630,8 @@ public:
         if (status != SAI_STATUS_SUCCESS)
         { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-        status = nhop_group_api->remove_next_hop_group(nhop_group_oid);
+        status = SAI_RPC_SAI_CALL(nhop_group_api->remove_next_hop_group(nhop_group_oid));
 
-        SAI_THRIFT_LOG_DBG("Exited.");
 
         return status;
     }
@@ -4213,7 +4669,7 @@ public:
     sai_thrift_object_id_t sai_thrift_create_next_hop_group_member
     (const std::vector<sai_thrift_attribute_t> &thrift_attr_list) noexcept
     {
-        SAI_THRIFT_LOG_DBG("Called.");
+        SAI_RPC_STATS_SCOPE(__func__);
 
         sai_next_hop_group_api_t *nhop_group_api = nullptr;
         auto status = sai_api_query(SAI_API_NEXT_HOP_GROUP, reinterpret_cast<void**>(&nhop_group_api));
@@ -4227,11 +4683,11 @@ public:
         sai_thrift_parse_next_hop_group_member_attributes(attr_list, thrift_attr_list);
 
         sai_object_id_t nhop_group_member_oid = 0;
-        status = nhop_group_api->create_next_hop_group_member(&nhop_group_member_oid, gSwitchId, attr_size, attr_list);
+        status = SAI_RPC_SAI_CALL(nhop_group_api->create_next_hop_group_member(&nhop_group_member_oid, gSwitchId, attr_size, attr_list));
         sai_thrift_free_attr(attr_list);
 
         if (status == SAI_STATUS_SUCCESS)
-        { SAI_THRIFT_LOG_DBG("Exited."); return nhop_group_member_oid; }
+        { return nhop_group_member_oid; }
 
         SAI_THRIFT_LOG_ERR("Failed to create group member.");
 
@@ -4241,7 +4697,7 @@ public:
     sai_thrift_status_t sai_thrift_remove_next_hop_group_member
     (const sai_thrift_object_id_t nhop_group_member_oid) noexcept
     {
-        SAI_THRIFT_LOG_DBG("Called.");
+        SAI_RPC_STATS_SCOPE(__func__);
 
         sai_next_hop_group_api_t *nhop_group_api = nullptr;
         auto status = sai_api_query(SAI_API_NEXT_HOP_GROUP, reinterpret_cast<void**>(&nhop_group_api));
@@ -4249,15 +4705,14 @@ public:
         if (status != SAI_STATUS_SUCCESS)
         { SAI_THRIFT_LOG_ERR("Failed to get API."); return status; }
 
-        status = nhop_group_api->remove_next_hop_group_member(nhop_group_member_oid);
+        status = SAI_RPC_SAI_CALL(nhop_group_api->remove_next_hop_group_member(nhop_group_member_oid));
 
-        SAI_THRIFT_LOG_DBG("Exited.");
 
         return status;
     }
     // Returns sai_object_id for a system_port_id
     sai_thrift_object_id_t sai_thrift_get_sys_port_obj_id_by_port_id(const int32_t sys_port_id) {
-        SAI_THRIFT_LOG_DBG("Called.");
+        SAI_RPC_STATS_SCOPE(__func__);
         sai_status_t status = SAI_STATUS_SUCCESS;
         sai_switch_api_t *switch_api;
         sai_system_port_api_t *sys_port_api;
@@ -4273,7 +4728,7 @@ public:
             return SAI_NULL_OBJECT_ID;
         }
         attr.id = SAI_SWITCH_ATTR_TYPE;
-        status = switch_api->get_switch_attribute(gSwitchId, 1, &attr);
+        status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &attr));
         if (status != SAI_STATUS_SUCCESS) {
             SAI_THRIFT_LOG_ERR("get_switch_attribute failed!!!");
             return SAI_NULL_OBJECT_ID;
@@ -4289,13 +4744,13 @@ public:
         }
 
         max_sys_port_attribute.id = SAI_SWITCH_ATTR_NUMBER_OF_SYSTEM_PORTS;
-        switch_api->get_switch_attribute(gSwitchId, 1, &max_sys_port_attribute);
+        SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &max_sys_port_attribute));
         max_sys_ports = max_sys_port_attribute.value.u32;
 
         sys_port_list_object_attribute.id = SAI_SWITCH_ATTR_SYSTEM_PORT_LIST;
         sys_port_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_sys_ports);
         sys_port_list_object_attribute.value.objlist.count = max_sys_ports;
-        status = switch_api->get_switch_attribute(gSwitchId, 1, &sys_port_list_object_attribute);
+        status = SAI_RPC_SAI_CALL(switch_api->get_switch_attribute(gSwitchId, 1, &sys_port_list_object_attribute));
         if (status != SAI_STATUS_SUCCESS) {
             SAI_THRIFT_LOG_ERR("get_switch_attribute failed!!!");
             free(sys_port_list_object_attribute.value.objlist.list);
@@ -4304,7 +4759,7 @@ public:
 
         for (int i=0 ; i<max_sys_ports ; i++){
            sys_port_attr.id = SAI_SYSTEM_PORT_ATTR_CONFIG_INFO;
-           status = sys_port_api->get_system_port_attribute(sys_port_list_object_attribute.value.objlist.list[i], 1, &sys_port_attr);
+           status = SAI_RPC_SAI_CALL(sys_port_api->get_system_port_attribute(sys_port_list_object_attribute.value.objlist.list[i], 1, &sys_port_attr));
            if (status != SAI_STATUS_SUCCESS) {
                SAI_THRIFT_LOG_ERR("get_system_port_attribute failed!!! for system_port 0x%lx", sys_port_list_object_attribute.value.objlist.list[i]);
                continue;
@@ -4321,6 +4776,8 @@ public:
         return SAI_NULL_OBJECT_ID;
     }
     void sai_thrift_get_system_port_attribute(sai_thrift_attribute_list_t& thrift_attr_list, const sai_thrift_object_id_t sys_port_oid) {
+      SAI_RPC_STATS_SCOPE(__func__);
+
       SAI_THRIFT_LOG_DBG("sai_thrift_get_system_port_attribute for 0x%lx", sys_port_oid);
       sai_status_t status = SAI_STATUS_SUCCESS;
       sai_system_port_api_t *sys_port_api;
@@ -4341,7 +4798,7 @@ public:
       }
 
       max_voq_attribute.id = SAI_SYSTEM_PORT_ATTR_QOS_NUMBER_OF_VOQS;
-      status = sys_port_api->get_system_port_attribute(sys_port_oid, 1, &max_voq_attribute);
+      status = SAI_RPC_SAI_CALL(sys_port_api->get_system_port_attribute(sys_port_oid, 1, &max_voq_attribute));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("sai_api_query failed!!!");
           return;
@@ -4351,7 +4808,7 @@ public:
       voq_list_object_attribute.id = SAI_SYSTEM_PORT_ATTR_QOS_VOQ_LIST;
       voq_list_object_attribute.value.objlist.list = (sai_object_id_t *) malloc(sizeof(sai_object_id_t) * max_voqs);
       voq_list_object_attribute.value.objlist.count = max_voqs;
-      status = sys_port_api->get_system_port_attribute(sys_port_oid, 1, &voq_list_object_attribute);
+      status = SAI_RPC_SAI_CALL(sys_port_api->get_system_port_attribute(sys_port_oid, 1, &voq_list_object_attribute));
       if (status != SAI_STATUS_SUCCESS) {
           SAI_THRIFT_LOG_ERR("sai_api_query failed!!!");
           return;
@@ -4367,8 +4824,115 @@ public:
       }
       attr_list.push_back(thrift_voq_list_attribute);
       free(voq_list_object_attribute.value.objlist.list);
-      SAI_THRIFT_LOG_DBG("Exited.");
     }
+
+  void sai_thrift_send_hostif_packets(std::vector<sai_thrift_status_t> &thrift_status_list,
+                                      const sai_thrift_object_id_t thrift_hif_id,
+                                      const std::vector<sai_thrift_hostif_packet_t> &thrift_packets) noexcept
+  {
+      SAI_RPC_STATS_SCOPE(__func__);
+
+      sai_hostif_api_t *hostif_api = nullptr;
+      auto status = sai_api_query(SAI_API_HOSTIF, reinterpret_cast<void**>(&hostif_api));
+
+      if (status != SAI_STATUS_SUCCESS)
+      { SAI_THRIFT_LOG_ERR("Failed to get API."); return; }
+
+      thrift_status_list.reserve(thrift_packets.size());
+
+      std::vector<sai_attribute_t> attr_list;
+
+      for (const auto &thrift_packet : thrift_packets)
+      {
+          attr_list.resize(thrift_packet.attr_list.size());
+
+          for (size_t i = 0; i < thrift_packet.attr_list.size(); i++)
+          {
+              const auto &thrift_attr = thrift_packet.attr_list[i];
+
+              attr_list[i].id = thrift_attr.id;
+
+              switch (thrift_attr.id)
+              {
+                  case SAI_HOSTIF_PACKET_ATTR_HOSTIF_TX_TYPE:
+                      attr_list[i].value.s32 = thrift_attr.value.s32;
+                      break;
+                  case SAI_HOSTIF_PACKET_ATTR_EGRESS_PORT_OR_LAG:
+                  case SAI_HOSTIF_PACKET_ATTR_BRIDGE_ID:
+                      attr_list[i].value.oid = thrift_attr.value.oid;
+                      break;
+                  case SAI_HOSTIF_PACKET_ATTR_EGRESS_QUEUE_INDEX:
+                      attr_list[i].value.u8 = thrift_attr.value.u8;
+                      break;
+                  case SAI_HOSTIF_PACKET_ATTR_ZERO_COPY_TX:
+                      attr_list[i].value.booldata = thrift_attr.value.booldata;
+                      break;
+                  default:
+                      break;
+              }
+          }
+
+          status = SAI_RPC_SAI_CALL(hostif_api->send_hostif_packet(thrift_hif_id, thrift_packet.data.size(), thrift_packet.data.data(),
+                                                  attr_list.size(), attr_list.data()));
+
+          gHostifPacketRing.tx_account(status, thrift_packet.data.size());
+          thrift_status_list.push_back(status);
+      }
+
+  }
+
+  void sai_thrift_recv_hostif_packets(std::vector<sai_thrift_hostif_packet_t> &thrift_packets,
+                                      const int32_t max_packets) noexcept
+  {
+      SAI_RPC_STATS_SCOPE(__func__);
+
+      if (max_packets > 0)
+      { gHostifPacketRing.drain(thrift_packets, max_packets); }
+  }
+
+  void sai_thrift_get_hostif_packet_stats(sai_thrift_hostif_packet_stats_t &thrift_stats) noexcept
+  {
+      SAI_RPC_STATS_SCOPE(__func__);
+
+      gHostifPacketRing.stats(thrift_stats);
+  }
+
+  void sai_thrift_get_rpc_stats(std::vector<sai_thrift_rpc_stats_t> &thrift_stats, const bool clear) noexcept
+  {
+      for (const auto &s : sai_rpc_stats::instance().snapshot(clear))
+      {
+          sai_thrift_rpc_stats_t stats;
+
+          stats.name = s.name;
+          stats.calls = s.calls;
+          stats.errors = s.errors;
+          stats.sai_calls = s.sai_calls;
+          stats.total_ns = s.total_ns;
+          stats.sai_ns = s.sai_ns;
+          stats.p50_ns = s.p50_ns;
+          stats.p90_ns = s.p90_ns;
+          stats.p99_ns = s.p99_ns;
+          stats.p999_ns = s.p999_ns;
+          stats.max_ns = s.max_ns;
+          stats.sai_p50_ns = s.sai_p50_ns;
+          stats.sai_p99_ns = s.sai_p99_ns;
+          stats.conversion_p50_ns = s.conversion_p50_ns;
+          stats.conversion_p99_ns = s.conversion_p99_ns;
+
+          thrift_stats.push_back(stats);
+      }
+  }
+
+  void sai_thrift_dump_rpc_stats(std::string &text) noexcept
+  {
+      text = sai_rpc_stats::instance().dump();
+  }
+
+  void sai_thrift_set_rpc_stats_config(const bool trace, const int32_t dump_interval) noexcept
+  {
+      sai_rpc_stats::instance().set_trace(trace);
+      sai_rpc_stats::instance().set_dump_interval(dump_interval > 0 ? dump_interval : 0);
+  }
 };
 
 static void * switch_sai_thrift_rpc_server_thread(void *arg) {
@@ -4402,4 +4966,10 @@ int start_sai_thrift_rpc_server(int port)
 
     return rc;
 }
+
+void sai_thrift_hostif_packet_event(sai_object_id_t switch_id, sai_size_t buffer_size, const void *buffer,
+                                    uint32_t attr_count, const sai_attribute_t *attr_list)
+{
+    gHostifPacketRing.push(buffer_size, buffer, attr_count, attr_list);
+}
 }
@@ -1,3 +1,5 @@
 extern "C" {
 int start_sai_thrift_rpc_server(int port);
+void sai_thrift_hostif_packet_event(sai_object_id_t switch_id, sai_size_t buffer_size, const void *buffer,
+                                    uint32_t attr_count, const sai_attribute_t *attr_list);
 }
@@ -17,6 +17,7 @@ Thrift SAI interface L3 tests
 """
 import socket
 import sys
+import time
 from struct import pack, unpack
 
 from switch import *
@@ -3925,4 +3926,95 @@ class L3LpbkSubnetTest(sai_base_test.ThriftInterfaceDataPlane):
             attr = sai_thrift_attribute_t(id=SAI_ROUTER_INTERFACE_ATTR_LOOPBACK_PACKET_ACTION, value=attr_value)
             self.client.sai_thrift_set_router_interface_attribute(rif_id1, attr)
             self.client.sai_thrift_remove_router_interface(rif_id1)
-            self.client.sai_thrift_remove_virtual_router(vr_id)
\ No newline at end of file
+            self.client.sai_thrift_remove_virtual_router(vr_id)
+
+@group('l3')
+@group('scale')
+class L3IPv4BulkRouteScaleTest(sai_base_test.ThriftInterfaceDataPlane):
+    route_count = 100000
+    chunk_size = 10000
+
+    def runTest(self):
+        print
+        print "Creating %d IPv4 /32 routes using bulk route RPCs" % self.route_count
+        switch_init(self.client)
+        port1 = port_list[0]
+        port2 = port_list[1]
+        v4_enabled = 1
+        v6_enabled = 1
+        mac = ''
+
+        vr_id = sai_thrift_create_virtual_router(self.client, v4_enabled, v6_enabled)
+
+        rif_id1 = sai_thrift_create_router_interface(self.client, vr_id, SAI_ROUTER_INTERFACE_TYPE_PORT, port1, 0, v4_enabled, v6_enabled, mac)
+        rif_id2 = sai_thrift_create_router_interface(self.client, vr_id, SAI_ROUTER_INTERFACE_TYPE_PORT, port2, 0, v4_enabled, v6_enabled, mac)
+
+        addr_family = SAI_IP_ADDR_FAMILY_IPV4
+        nhop_ip1 = '20.20.20.1'
+        dmac1 = '00:11:22:33:44:55'
+
+        neighbor_entry = sai_thrift_neighbor_entry_t(rif_id=rif_id1,
+                             ip_address=sai_thrift_ip_address_t(addr_family=addr_family, addr=sai_thrift_ip_t(ip4=nhop_ip1)))
+        neighbor_attr = sai_thrift_attribute_t(id=SAI_NEIGHBOR_ENTRY_ATTR_DST_MAC_ADDRESS,
+                                               value=sai_thrift_attribute_value_t(mac=dmac1))
+        statuses = self.client.sai_thrift_create_neighbor_entries([neighbor_entry], [[neighbor_attr]],
+                                                                  SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR)
+        assert statuses == [SAI_STATUS_SUCCESS]
+        nhop1 = sai_thrift_create_nhop(self.client, addr_family, nhop_ip1, rif_id1)
+
+        # 10.0.0.0 - 10.1.134.159
+        route_attr = sai_thrift_attribute_t(id=SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID,
+                                            value=sai_thrift_attribute_value_t(oid=nhop1))
+        mask = sai_thrift_ip_t(ip4='255.255.255.255')
+        routes = []
+        for i in range(self.route_count):
+            addr = sai_thrift_ip_t(ip4=socket.inet_ntoa(pack('!I', 0x0a000000 + i)))
+            ip_prefix = sai_thrift_ip_prefix_t(addr_family=addr_family, addr=addr, mask=mask)
+            routes.append(sai_thrift_route_entry_t(vr_id, ip_prefix))
+
+        created = 0
+        try:
+            start = time.time()
+            for i in range(0, self.route_count, self.chunk_size):
+                chunk = routes[i:i + self.chunk_size]
+                statuses = self.client.sai_thrift_create_routes(chunk, [[route_attr]] * len(chunk),
+                                                                SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR)
+                assert len(statuses) == len(chunk)
+                created += len(chunk)
+                failed = [j for j, status in enumerate(statuses) if status != SAI_STATUS_SUCCESS]
+                assert not failed, "%d routes failed, first at index %d" % (len(failed), i + failed[0])
+            elapsed = time.time() - start
+            print "Created %d routes in %.2f s (%.0f routes/s)" % (created, elapsed, created / max(elapsed, 1e-6))
+
+            # send the test packet(s) to the first and last route
+            for ip_dst in [socket.inet_ntoa(pack('!I', 0x0a000000)),
+                           socket.inet_ntoa(pack('!I', 0x0a000000 + self.route_count - 1))]:
+                pkt = simple_tcp_packet(eth_dst=router_mac,
+                                        eth_src='00:22:22:22:22:22',
+                                        ip_dst=ip_dst,
+                                        ip_src='192.168.0.1',
+                                        ip_id=105,
+                                        ip_ttl=64)
+                exp_pkt = simple_tcp_packet(
+                                        eth_dst=dmac1,
+                                        eth_src=router_mac,
+                                        ip_dst=ip_dst,
+                                        ip_src='192.168.0.1',
+                                        ip_id=105,
+                                        ip_ttl=63)
+                send_packet(self, 1, str(pkt))
+                verify_packets(self, exp_pkt, [0])
+        finally:
+            start = time.time()
+            for i in range(0, created, self.chunk_size):
+                chunk = routes[i:min(i + self.chunk_size, created)]
+                self.client.sai_thrift_remove_routes(chunk, SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR)
+            print "Removed %d routes in %.2f s" % (created, time.time() - start)
+
+            self.client.sai_thrift_remove_next_hop(nhop1)
+            self.client.sai_thrift_remove_neighbor_entries([neighbor_entry], SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR)
+
+            self.client.sai_thrift_remove_router_interface(rif_id1)
+            self.client.sai_thrift_remove_router_interface(rif_id2)
+
+            self.client.sai_thrift_remove_virtual_router(vr_id)
@@ -119,6 +119,7 @@ struct cmdOptions
     std::string profileMapFile;
     std::string portMapFile;
     std::string initScript;
+    std::string cacheFile;
 };
 
 cmdOptions handleCmdLine(int argc, char **argv)
@@ -133,12 +134,13 @@ cmdOptions handleCmdLine(int argc, char **argv)
             { "profile",          required_argument, 0, 'p' },
             { "portmap",          required_argument, 0, 'f' },
             { "init-script",      required_argument, 0, 'S' },
+            { "cache-file",       required_argument, 0, 'c' },
             { 0,                  0,                 0,  0  }
         };
 
         int option_index = 0;
 
-        int c = getopt_long(argc, argv, "p:f:S:", long_options, &option_index);
+        int c = getopt_long(argc, argv, "p:f:S:c:", long_options, &option_index);
 
         if (c == -1)
             break;
@@ -160,6 +162,11 @@ cmdOptions handleCmdLine(int argc, char **argv)
                 options.initScript = std::string(optarg);
                 break;
 
+            case 'c':
+                printf("rpc cache file: %s\n", optarg);
+                options.cacheFile = std::string(optarg);
+                break;
+
             default:
                 printf("getopt_long failure\n");
                 exit(EXIT_FAILURE);
@@ -294,6 +301,11 @@ main(int argc, char* argv[])
 
     handleInitScript(options.initScript);
 
+    if (options.cacheFile.size() && sai_thrift_rpc_cache_open(options.cacheFile.c_str()) != 0)
+    {
+        printf("Failed to open rpc cache file: %s\n", options.cacheFile.c_str());
+    }
+
     start_sai_thrift_rpc_server(SWITCH_SAI_THRIFT_RPC_SERVER_PORT);
 
     const sai_log_level_t log_level = SAI_LOG_LEVEL_NOTICE;
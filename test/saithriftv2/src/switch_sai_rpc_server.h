@@ -1,4 +1,5 @@
 extern "C" {
 int start_p4_sai_thrift_rpc_server(char *port);
 int start_sai_thrift_rpc_server(int port);
+int sai_thrift_rpc_cache_open(const char *path);
 }